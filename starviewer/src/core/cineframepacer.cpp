@@ -0,0 +1,104 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "cineframepacer.h"
+
+#include <cmath>
+
+namespace udg {
+
+CineFramePacer::CineFramePacer()
+ : m_period(1000.0), m_startTime(0), m_nextFrameNumber(1), m_presentedFrames(0), m_droppedFrames(0), m_totalLatency(0), m_maximumLatency(0)
+{
+}
+
+void CineFramePacer::start(double framesPerSecond, qint64 now)
+{
+    setFramesPerSecond(framesPerSecond, now);
+
+    m_presentedFrames = 0;
+    m_droppedFrames = 0;
+    m_totalLatency = 0;
+    m_maximumLatency = 0;
+}
+
+void CineFramePacer::setFramesPerSecond(double framesPerSecond, qint64 now)
+{
+    m_period = 1000.0 / qMax(framesPerSecond, 0.001);
+    m_startTime = now;
+    m_nextFrameNumber = 1;
+}
+
+qint64 CineFramePacer::getNextFrameTime() const
+{
+    return m_startTime + static_cast<qint64>(std::floor(m_nextFrameNumber * m_period + 0.5));
+}
+
+int CineFramePacer::getTimeUntilNextFrame(qint64 now) const
+{
+    return static_cast<int>(qMax(Q_INT64_C(0), getNextFrameTime() - now));
+}
+
+int CineFramePacer::advance(qint64 now)
+{
+    qint64 nextFrameTime = getNextFrameTime();
+    if (now < nextFrameTime)
+    {
+        return 0;
+    }
+
+    // Last frame number whose due time has already been reached
+    qint64 lastDueFrameNumber = static_cast<qint64>(std::floor((now - m_startTime) / m_period));
+    lastDueFrameNumber = qMax(lastDueFrameNumber, m_nextFrameNumber);
+
+    int framesToAdvance = static_cast<int>(lastDueFrameNumber - m_nextFrameNumber + 1);
+    qint64 latency = now - (m_startTime + static_cast<qint64>(std::floor(lastDueFrameNumber * m_period + 0.5)));
+    latency = qMax(Q_INT64_C(0), latency);
+
+    m_presentedFrames++;
+    m_droppedFrames += framesToAdvance - 1;
+    m_totalLatency += latency;
+    m_maximumLatency = qMax(m_maximumLatency, latency);
+
+    m_nextFrameNumber = lastDueFrameNumber + 1;
+
+    return framesToAdvance;
+}
+
+int CineFramePacer::getNumberOfPresentedFrames() const
+{
+    return m_presentedFrames;
+}
+
+int CineFramePacer::getNumberOfDroppedFrames() const
+{
+    return m_droppedFrames;
+}
+
+double CineFramePacer::getMeanLatency() const
+{
+    if (m_presentedFrames == 0)
+    {
+        return 0.0;
+    }
+
+    return static_cast<double>(m_totalLatency) / m_presentedFrames;
+}
+
+qint64 CineFramePacer::getMaximumLatency() const
+{
+    return m_maximumLatency;
+}
+
+}
@@ -0,0 +1,75 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGCINEFRAMEPACER_H
+#define UDGCINEFRAMEPACER_H
+
+#include <QtGlobal>
+
+namespace udg {
+
+/**
+    Paces the presentation of CINE frames against a monotonic clock.
+
+    Frames are scheduled at a fixed rate from the moment playback starts instead of from the moment the previous frame was presented, so the time spent
+    rendering a frame doesn't accumulate as drift. When presentation falls behind, advance() returns the number of frames that should be advanced at once
+    to get back on schedule, and the skipped ones are counted as dropped. It also keeps latency statistics, where latency is the time between the moment
+    a frame was due and the moment it was presented.
+
+    Times are given in milliseconds by the caller, so that the class can be used with any clock (normally a QElapsedTimer) and tested deterministically.
+ */
+class CineFramePacer {
+public:
+    CineFramePacer();
+
+    /// Starts pacing at the given number of frames per second, taking the given time as the presentation time of the current frame.
+    /// Resets the statistics.
+    void start(double framesPerSecond, qint64 now);
+
+    /// Changes the frame rate keeping the statistics. The next frame is scheduled one period after the given time.
+    void setFramesPerSecond(double framesPerSecond, qint64 now);
+
+    /// Returns the time at which the next frame is due.
+    qint64 getNextFrameTime() const;
+    /// Returns the time remaining until the next frame is due at the given time, or 0 if it's already due.
+    int getTimeUntilNextFrame(qint64 now) const;
+
+    /// Called when the playback timer fires at the given time. Returns the number of frames the playback must advance (0 if no frame is due yet), and
+    /// counts the presented and dropped frames and the latency of the presented one.
+    int advance(qint64 now);
+
+    /// Statistics since the last start().
+    int getNumberOfPresentedFrames() const;
+    int getNumberOfDroppedFrames() const;
+    double getMeanLatency() const;
+    qint64 getMaximumLatency() const;
+
+private:
+    /// Period between frames in milliseconds.
+    double m_period;
+
+    /// Time at which playback started and number of frame periods elapsed since then until the next due frame.
+    qint64 m_startTime;
+    qint64 m_nextFrameNumber;
+
+    /// Statistics.
+    int m_presentedFrames;
+    int m_droppedFrames;
+    qint64 m_totalLatency;
+    qint64 m_maximumLatency;
+};
+
+}
+
+#endif // UDGCINEFRAMEPACER_H
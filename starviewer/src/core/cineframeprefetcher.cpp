@@ -0,0 +1,264 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "cineframeprefetcher.h"
+
+#include "imagepipeline.h"
+
+#include <QMutexLocker>
+#include <QScopedPointer>
+#include <QtConcurrentRun>
+
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+namespace udg {
+
+CineFramePrefetcher::PipelineSettings::PipelineSettings()
+ : slabThickness(1), slabStride(1), slabProjectionMode(AccumulatorFactory::Maximum)
+{
+}
+
+CineFramePrefetcher::Frame::Frame()
+ : imageIndex(-1)
+{
+}
+
+CineFramePrefetcher::CineFramePrefetcher(int capacity)
+ : m_capacity(qMax(1, capacity)), m_hasPipelineSettings(false), m_generation(0), m_computing(false)
+{
+}
+
+CineFramePrefetcher::~CineFramePrefetcher()
+{
+    invalidate();
+    m_future.waitForFinished();
+}
+
+int CineFramePrefetcher::getCapacity() const
+{
+    return m_capacity;
+}
+
+void CineFramePrefetcher::setPipelineSettings(const PipelineSettings &settings)
+{
+    invalidate();
+
+    // The pipeline of the worker gets its own data object, so that it doesn't share the pipeline information with the pipeline of the GUI thread
+    vtkSmartPointer<vtkImageData> input;
+    if (settings.input)
+    {
+        input = vtkSmartPointer<vtkImageData>::New();
+        input->ShallowCopy(settings.input);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_pipelineSettings = settings;
+    m_pipelineSettings.input = input;
+    m_hasPipelineSettings = input != 0;
+}
+
+bool CineFramePrefetcher::hasPipelineSettings() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hasPipelineSettings;
+}
+
+void CineFramePrefetcher::prefetch(const QList<int> &imageIndices)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_hasPipelineSettings)
+    {
+        return;
+    }
+
+    m_requestedImageIndices = imageIndices.mid(0, m_capacity);
+
+    if (!m_computing && getNextImageIndexToCompute() >= 0)
+    {
+        // The previous worker has already given up the mutex and is just returning
+        m_future.waitForFinished();
+        m_computing = true;
+        m_future = QtConcurrent::run(this, &CineFramePrefetcher::computeFrames);
+    }
+}
+
+CineFramePrefetcher::Frame CineFramePrefetcher::getFrame(int imageIndex) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    foreach (const Frame &frame, m_frames)
+    {
+        if (frame.imageIndex == imageIndex)
+        {
+            return frame;
+        }
+    }
+
+    return Frame();
+}
+
+void CineFramePrefetcher::invalidate()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_generation++;
+    m_frames.clear();
+    m_requestedImageIndices.clear();
+    m_pipelineSettings = PipelineSettings();
+    m_hasPipelineSettings = false;
+}
+
+void CineFramePrefetcher::waitForFrames()
+{
+    m_future.waitForFinished();
+}
+
+void CineFramePrefetcher::computeFrames()
+{
+    // The pipeline is kept between frames and set up again only when the settings change
+    QScopedPointer<ImagePipeline> pipeline;
+    int pipelineGeneration = -1;
+
+    forever
+    {
+        int imageIndex;
+        int generation;
+        PipelineSettings settings;
+        {
+            QMutexLocker locker(&m_mutex);
+
+            imageIndex = getNextImageIndexToCompute();
+            if (imageIndex < 0)
+            {
+                m_computing = false;
+                return;
+            }
+
+            generation = m_generation;
+            if (generation != pipelineGeneration)
+            {
+                settings = m_pipelineSettings;
+            }
+        }
+
+        if (generation != pipelineGeneration)
+        {
+            pipeline.reset(createPipeline(settings));
+            pipelineGeneration = generation;
+        }
+
+        Frame frame = computeFrame(pipeline.data(), imageIndex);
+
+        QMutexLocker locker(&m_mutex);
+        if (generation == m_generation)
+        {
+            insertFrame(frame);
+        }
+    }
+}
+
+int CineFramePrefetcher::getNextImageIndexToCompute() const
+{
+    foreach (int imageIndex, m_requestedImageIndices)
+    {
+        bool found = false;
+        foreach (const Frame &frame, m_frames)
+        {
+            if (frame.imageIndex == imageIndex)
+            {
+                found = true;
+                break;
+            }
+        }
+
+        if (!found)
+        {
+            return imageIndex;
+        }
+    }
+
+    return -1;
+}
+
+void CineFramePrefetcher::insertFrame(const Frame &frame)
+{
+    if (!m_requestedImageIndices.contains(frame.imageIndex))
+    {
+        return;
+    }
+
+    if (m_frames.size() >= m_capacity)
+    {
+        // The oldest frame that is no longer requested goes away. There is always one because there are at most m_capacity requests
+        for (int i = 0; i < m_frames.size(); i++)
+        {
+            if (!m_requestedImageIndices.contains(m_frames.at(i).imageIndex))
+            {
+                m_frames.removeAt(i);
+                break;
+            }
+        }
+    }
+
+    // Frames that couldn't be computed are kept too, with a null output, so that they aren't computed again
+    m_frames.append(frame);
+}
+
+ImagePipeline* CineFramePrefetcher::createPipeline(const PipelineSettings &settings)
+{
+    ImagePipeline *pipeline = new ImagePipeline();
+    pipeline->setInput(settings.input);
+    pipeline->setProjectionAxis(settings.projectionAxis);
+    pipeline->setSlabThickness(settings.slabThickness);
+    pipeline->setSlabStride(settings.slabStride);
+    pipeline->setSlabProjectionMode(settings.slabProjectionMode);
+    // With a transfer function the LUT of the VOI LUT is ignored, as in the pipeline of the display unit
+    if (!settings.transferFunction.isEmpty())
+    {
+        pipeline->setTransferFunction(settings.transferFunction);
+    }
+    pipeline->setVoiLut(settings.voiLut);
+
+    return pipeline;
+}
+
+CineFramePrefetcher::Frame CineFramePrefetcher::computeFrame(ImagePipeline *pipeline, int imageIndex)
+{
+    Frame frame;
+    frame.imageIndex = imageIndex;
+
+    pipeline->setSlice(imageIndex);
+    pipeline->update();
+
+    vtkImageData *output = pipeline->getOutput().getVtkImageData();
+    if (output && output->GetPointData()->GetScalars())
+    {
+        frame.output = vtkSmartPointer<vtkImageData>::New();
+        frame.output->DeepCopy(output);
+    }
+
+    // Without thick slab the projection filter isn't part of the pipeline and its output is empty
+    vtkImageData *slabProjection = pipeline->getSlabProjectionOutput();
+    if (slabProjection && slabProjection->GetPointData()->GetScalars())
+    {
+        frame.slabProjection = vtkSmartPointer<vtkImageData>::New();
+        frame.slabProjection->DeepCopy(slabProjection);
+    }
+
+    return frame;
+}
+
+}
@@ -0,0 +1,144 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGCINEFRAMEPREFETCHER_H
+#define UDGCINEFRAMEPREFETCHER_H
+
+#include "accumulator.h"
+#include "orthogonalplane.h"
+#include "transferfunction.h"
+#include "voilut.h"
+
+#include <QFuture>
+#include <QList>
+#include <QMutex>
+
+#include <vtkSmartPointer.h>
+
+class vtkImageData;
+
+namespace udg {
+
+class ImagePipeline;
+
+/**
+    Computes in a worker thread the output of an ImagePipeline for the images that CINE playback is going to display next, and keeps them in a ring
+    of frames that are already projected, windowed and mapped through the LUT, so that they can be displayed without running the pipeline in the GUI
+    thread.
+
+    Frames are computed with a private ImagePipeline set up with the given PipelineSettings. When anything that changes the output of the pipeline
+    changes (e.g. the window/level or the LUT), invalidate() must be called: it discards the frames, the requests and the settings, and frames being
+    computed with the old settings are dropped when they finish.
+
+    Prefetching is meant for thick slabs, where the pipeline projects a new slab for each image. With a slab thickness of 1 the output of the pipeline
+    is the whole volume, which the pipeline of the display unit windows once for all the images, so there is nothing to gain.
+ */
+class CineFramePrefetcher {
+public:
+    /// Everything the private pipeline needs to compute the frames
+    struct PipelineSettings {
+        PipelineSettings();
+
+        /// Data of the volume. The prefetcher works on a shallow copy, so the scalars must not be modified while frames are computed
+        vtkSmartPointer<vtkImageData> input;
+        OrthogonalPlane projectionAxis;
+        int slabThickness;
+        int slabStride;
+        AccumulatorFactory::AccumulatorType slabProjectionMode;
+        /// VOI LUT as given to the pipeline (i.e. already inverted for MONOCHROME1)
+        VoiLut voiLut;
+        /// Transfer function applied instead of the LUT of the VOI LUT, empty if there is none
+        TransferFunction transferFunction;
+    };
+
+    /// A computed frame: the output of the pipeline for an image and the slab projection it has been computed from
+    struct Frame {
+        Frame();
+
+        int imageIndex;
+        vtkSmartPointer<vtkImageData> output;
+        vtkSmartPointer<vtkImageData> slabProjection;
+    };
+
+    /// Creates a prefetcher that keeps at most the given number of frames
+    explicit CineFramePrefetcher(int capacity = 8);
+    ~CineFramePrefetcher();
+
+    /// Returns the maximum number of frames that are kept
+    int getCapacity() const;
+
+    /// Sets the settings of the pipeline with which frames are computed. The current frames and requests are discarded as with invalidate()
+    void setPipelineSettings(const PipelineSettings &settings);
+    /// Returns true if pipeline settings have been set since the last invalidate()
+    bool hasPipelineSettings() const;
+
+    /// Requests the frames of the given images, in the order in which they will be displayed, and starts computing the missing ones in the
+    /// background. Only the first getCapacity() images are taken into account. Frames of images that are no longer requested are evicted as new ones
+    /// are computed. Does nothing if there are no pipeline settings
+    void prefetch(const QList<int> &imageIndices);
+
+    /// Returns the frame of the given image if it has been computed, or a frame with null output otherwise
+    Frame getFrame(int imageIndex) const;
+
+    /// Discards the frames, the requests and the pipeline settings
+    void invalidate();
+
+    /// Waits until the requested frames have been computed
+    void waitForFrames();
+
+private:
+    /// Computes the requested frames that are missing until there are no more. It's run in a worker thread
+    void computeFrames();
+
+    /// Returns the first requested image that doesn't have a frame yet, or -1 if there is none. Must be called with the mutex locked
+    int getNextImageIndexToCompute() const;
+
+    /// Keeps the given frame if its image is still requested, evicting a frame that is no longer requested if the ring is full.
+    /// Must be called with the mutex locked
+    void insertFrame(const Frame &frame);
+
+    /// Returns a pipeline set up with the given settings
+    static ImagePipeline* createPipeline(const PipelineSettings &settings);
+
+    /// Runs the pipeline for the given image and returns a copy of its output
+    static Frame computeFrame(ImagePipeline *pipeline, int imageIndex);
+
+private:
+    /// Maximum number of frames
+    int m_capacity;
+
+    /// Settings of the pipeline, valid if m_hasPipelineSettings is true
+    PipelineSettings m_pipelineSettings;
+    bool m_hasPipelineSettings;
+
+    /// Requested images in display order, at most m_capacity
+    QList<int> m_requestedImageIndices;
+
+    /// Computed frames
+    QList<Frame> m_frames;
+
+    /// Incremented every time the frames are invalidated, frames computed with an older generation are stale
+    int m_generation;
+
+    /// True while the worker is computing frames
+    bool m_computing;
+    QFuture<void> m_future;
+
+    /// Protects all the members above that are used by the worker
+    mutable QMutex m_mutex;
+};
+
+}
+
+#endif // UDGCINEFRAMEPREFETCHER_H
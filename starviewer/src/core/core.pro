@@ -37,8 +37,6 @@ HEADERS += extensionfactory.h \
     extensionmediatorfactory.h \
     extensionmediatorfactoryregister.h \
     installextension.h \
-    itkImageToVTKImageFilter.h \
-    itkVTKImageToImageFilter.h \
     mathtools.h \
     itkQtAdaptor.h \
     harddiskinformation.h \
@@ -68,6 +66,8 @@ HEADERS += extensionfactory.h \
     itkVolumeCalculatorImageFilter.h \
     vtkImageMapToWindowLevelColors3.h \
     displayshutter.h \
+    displayshuttermask.h \
+    spanmask.h \
     image.h \
     imageoverlay.h \
     imageoverlayreader.h \
@@ -126,6 +126,8 @@ HEADERS += extensionfactory.h \
     ellipticalroitool.h \
     polylinetemporalroitool.h \
     polylinetemporalroitooldata.h \
+    temporalroiengine.h \
+    referencelinesengine.h \
     distancetool.h \
     editortool.h \
     editortooldata.h \
@@ -210,10 +212,12 @@ HEADERS += extensionfactory.h \
     standardizeduptakevaluebodysurfaceareaformulacalculator.h \
     standarduptakevaluemeasurehandler.h \
     statswatcher.h \
+    startupprofiler.h \
     clippingplanestool.h \
     representationslayer.h \
     toolrepresentation.h \
     settings.h \
+    settingscache.h \
     settingsregistry.h \
     settingsparser.h \
     defaultsettings.h \
@@ -301,6 +305,13 @@ HEADERS += extensionfactory.h \
     commandlineoption.h \
     applicationversiontest.h \
     imageoverlayregionfinder.h \
+    imageoverlaycache.h \
+    regiongrowing.h \
+    obliqueresliceengine.h \
+    stringpool.h \
+    cineframepacer.h \
+    cineframeprefetcher.h \
+    queuedlogappender.h \
     systeminformation.h \
     systemrequeriments.h \
     systemrequerimentstest.h \
@@ -387,6 +398,7 @@ HEADERS += extensionfactory.h \
     secondaryvolumedisplayunit.h \
     volumedisplayunithandlerfactory.h \
     genericvolumedisplayunithandler.h \
+    fusionlayercache.h \
     singlevolumedisplayunithandler.h \
     pairedvolumedisplayunithandler.h \
     petctvolumedisplayunithandler.h \
@@ -411,6 +423,7 @@ HEADERS += extensionfactory.h \
     nmroidataprinter.h \
     nmctfusionroidataprinter.h \
     vtkcorrectimageblend.h \
+    vtkimageshuttermask.h \
     vtktextactorwithbackground.h \
     volumereaderjobfactory.h \
     relativegeometrylayout.h \
@@ -463,6 +476,8 @@ SOURCES += extensionmediator.cpp \
     itkVolumeCalculatorImageFilter.cpp \
     vtkImageMapToWindowLevelColors3.cxx \
     displayshutter.cpp \
+    displayshuttermask.cpp \
+    spanmask.cpp \
     image.cpp \
     imageoverlay.cpp \
     imageoverlayreader.cpp \
@@ -521,6 +536,8 @@ SOURCES += extensionmediator.cpp \
     ellipticalroitool.cpp \
     polylinetemporalroitool.cpp \
     polylinetemporalroitooldata.cpp \
+    temporalroiengine.cpp \
+    referencelinesengine.cpp \
     distancetool.cpp \
     qviewercinecontroller.cpp \
     qcinecontroller.cpp \
@@ -596,10 +613,12 @@ SOURCES += extensionmediator.cpp \
     standardizeduptakevaluebodysurfaceareaformulacalculator.cpp \
     standarduptakevaluemeasurehandler.cpp \
     statswatcher.cpp \
+    startupprofiler.cpp \
     clippingplanestool.cpp \
     representationslayer.cpp \
     toolrepresentation.cpp \
     settings.cpp \
+    settingscache.cpp \
     settingsregistry.cpp \
     settingsparser.cpp \
     defaultsettings.cpp \
@@ -682,6 +701,13 @@ SOURCES += extensionmediator.cpp \
     commandlineoption.cpp \
     applicationversiontest.cpp \
     imageoverlayregionfinder.cpp \
+    imageoverlaycache.cpp \
+    regiongrowing.cpp \
+    obliqueresliceengine.cpp \
+    stringpool.cpp \
+    cineframepacer.cpp \
+    cineframeprefetcher.cpp \
+    queuedlogappender.cpp \
     systeminformation.cpp \
     systemrequeriments.cpp \
     systemrequerimentstest.cpp \
@@ -764,6 +790,7 @@ SOURCES += extensionmediator.cpp \
     secondaryvolumedisplayunit.cpp \
     volumedisplayunithandlerfactory.cpp \
     genericvolumedisplayunithandler.cpp \
+    fusionlayercache.cpp \
     singlevolumedisplayunithandler.cpp \
     pairedvolumedisplayunithandler.cpp \
     petctvolumedisplayunithandler.cpp \
@@ -788,6 +815,7 @@ SOURCES += extensionmediator.cpp \
     nmroidataprinter.cpp \
     nmctfusionroidataprinter.cpp \
     vtkcorrectimageblend.cpp \
+    vtkimageshuttermask.cpp \
     vtktextactorwithbackground.cpp \
     volumereaderjobfactory.cpp \
     relativegeometrylayout.cpp \
@@ -445,7 +445,8 @@ void DICOMTagReader::logStatusForTagOperation(const DICOMTag &tag, const OFCondi
         return;
     }
 
-    if (QString::compare(status.text(), "Tag Not Found", Qt::CaseInsensitive) != 0)
+    // Es compara el codi de l'error en comptes del text per no haver de construir cap QString quan el log de debug està desactivat
+    if (status != EC_TagNotFound)
     {
         DEBUG_LOG(QString("S'ha produit el següent problema a l'intentar obtenir el tag %1 :: %2").arg(tag.getKeyAsQString()).arg(status.text()));
     }
@@ -14,8 +14,8 @@
 
 #include "displayshutter.h"
 
+#include "displayshuttermask.h"
 #include "mathtools.h"
-#include "vtkimagedatacreator.h"
 
 #include <cmath>
 
@@ -24,6 +24,8 @@
 #include <QRegExp>
 
 #include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkUnsignedCharArray.h>
 
 namespace udg {
 
@@ -31,6 +33,7 @@ DisplayShutter::DisplayShutter()
 {
     m_shape = UndefinedShape;
     m_shutterValue = 0;
+    m_circleRadius = 0;
 }
 
 DisplayShutter::~DisplayShutter()
@@ -97,6 +100,9 @@ bool DisplayShutter::setPoints(const QPoint &centre, int radius)
         return false;
     }
     
+    m_circleCentre = centre;
+    m_circleRadius = radius;
+
     m_shutterPolygon.clear();
     const int PolygonCirclePoints = 50;
     double alpha;
@@ -238,6 +244,16 @@ QPolygon DisplayShutter::getAsQPolygon() const
     return m_shutterPolygon;
 }
 
+QPoint DisplayShutter::getCircleCentre() const
+{
+    return m_circleCentre;
+}
+
+int DisplayShutter::getCircleRadius() const
+{
+    return m_circleRadius;
+}
+
 QString DisplayShutter::getPointsAsString() const
 {
     QString pointsString;
@@ -297,25 +313,10 @@ QImage DisplayShutter::getAsQImage(int width, int height) const
 
 vtkSmartPointer<vtkImageData> DisplayShutter::getAsVtkImageData(int width, int height, int slice) const
 {
-    // Create shutter mask as QImage
-    QImage shutterImage = this->getAsQImage(width, height);
-    
-    // Convert QImage to needed raw format
-    unsigned char *data = new unsigned char[width * height];
-    for (int i = 0; i < height; ++i)
-    {
-        QRgb *currentPixel = reinterpret_cast<QRgb*>(shutterImage.scanLine(i));
-        for (int j = 0; j < width; ++j)
-        {
-            data[j + i * width] = qGray(*currentPixel);
-            ++currentPixel;
-        }
-    }
-
-    VtkImageDataCreator imageDataCreator;
-    vtkSmartPointer<vtkImageData> shutterData = imageDataCreator.createVtkImageData(width, height, 1, data);
+    // The mask is rasterized only once for each geometry and size, each image gets its own vtkImageData over the same scalars
+    vtkSmartPointer<vtkImageData> shutterData = vtkSmartPointer<vtkImageData>::New();
     shutterData->SetExtent(0, width - 1, 0, height - 1, slice, slice);
-    delete[] data;
+    shutterData->GetPointData()->SetScalars(DisplayShutterMask::getMaskArray(*this, width, height));
 
     return shutterData;
 }
@@ -77,6 +77,10 @@ public:
     /// Retorna el shutter en forma de QPolygon
     QPolygon getAsQPolygon() const;
 
+    /// Retornen el centre i el radi de la forma circular. Només tenen sentit si la forma és circular
+    QPoint getCircleCentre() const;
+    int getCircleRadius() const;
+
     /// Retorna els punts del shutter en format d'string. El format serà el mateix que el de setPoints(const QString &)
     QString getPointsAsString() const;
 
@@ -84,6 +88,7 @@ public:
     QImage getAsQImage(int width, int height) const;
 
     /// Returns the shutter in vtkImageData format, with extent defined by given width, height and slice.
+    /// The scalars are shared with all the shutters with the same geometry and size (see DisplayShutterMask) and must not be modified.
     vtkSmartPointer<vtkImageData> getAsVtkImageData(int width, int height, int slice) const;
     
     /// Donada una llista de shutters, ens retorna el shutter resultant de la intersecció d'aquests. 
@@ -100,6 +105,10 @@ private:
 
     /// Polígon que defineix el shutter. Independentment de la forma que tingui definida sempre es guardarà internament com un polígon.
     QPolygon m_shutterPolygon;
+
+    /// Centre i radi de la forma circular, per poder-la rasteritzar sense l'aproximació poligonal
+    QPoint m_circleCentre;
+    int m_circleRadius;
     
     /// Valor de gris amb el que s'ha de pintar la part opaca del shutter
     unsigned short int m_shutterValue;
@@ -16,17 +16,13 @@
 
 #include "filteroutput.h"
 #include "volume.h"
-
-#include <vtkImageMask.h>
+#include "vtkimageshuttermask.h"
 
 namespace udg {
 
 DisplayShutterFilter::DisplayShutterFilter()
 {
-    m_imageMask = vtkImageMask::New();
-    m_imageMask->SetMaskAlpha(1.0);
-    m_imageMask->SetMaskedOutputValue(0);
-    m_imageMask->NotMaskOn();
+    m_imageMask = VtkImageShutterMask::New();
 }
 
 DisplayShutterFilter::~DisplayShutterFilter()
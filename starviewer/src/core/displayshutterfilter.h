@@ -18,11 +18,11 @@
 #include "filter.h"
 
 class vtkImageData;
-class vtkImageMask;
 
 namespace udg {
 
 class Volume;
+class VtkImageShutterMask;
 
 /**
     This filter applies a display shutter to the input.
@@ -51,7 +51,7 @@ private:
 
 private:
     /// Image mask that implements the filter.
-    vtkImageMask* m_imageMask;
+    VtkImageShutterMask* m_imageMask;
 
 };
 
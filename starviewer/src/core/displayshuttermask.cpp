@@ -0,0 +1,212 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "displayshuttermask.h"
+
+#include "displayshutter.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <vtkUnsignedCharArray.h>
+
+namespace udg {
+
+namespace {
+
+// Cached mask array
+struct CachedMaskArray {
+    vtkSmartPointer<vtkUnsignedCharArray> array;
+};
+
+// Maximum size of the cached masks (128 MiB), in kilobytes
+const int MaskArrayCacheSizeInKiB = 128 * 1024;
+
+QCache<QString, CachedMaskArray> maskArrayCache(MaskArrayCacheSizeInKiB);
+QMutex maskArrayCacheMutex;
+
+}
+
+DisplayShutterMask::DisplayShutterMask()
+{
+}
+
+DisplayShutterMask::DisplayShutterMask(const DisplayShutter &shutter, int width, int height)
+{
+    m_mask.reset(width, height);
+
+    switch (shutter.getShape())
+    {
+        case DisplayShutter::RectangularShape:
+            rasterizeRectangle(shutter.getAsQPolygon());
+            break;
+
+        case DisplayShutter::CircularShape:
+            rasterizeCircle(shutter.getCircleCentre(), shutter.getCircleRadius());
+            break;
+
+        case DisplayShutter::PolygonalShape:
+            // Including the pixels crossed by the outline, as the painted polygon used to do
+            m_mask.addPolygon(QPolygonF(shutter.getAsQPolygon()), true);
+            break;
+
+        case DisplayShutter::UndefinedShape:
+            break;
+    }
+}
+
+DisplayShutterMask::~DisplayShutterMask()
+{
+}
+
+int DisplayShutterMask::getWidth() const
+{
+    return m_mask.getWidth();
+}
+
+int DisplayShutterMask::getHeight() const
+{
+    return m_mask.getHeight();
+}
+
+const DisplayShutterMask::Span* DisplayShutterMask::getRowSpans(int row, int &numberOfSpans) const
+{
+    return m_mask.getRowSpans(row, numberOfSpans);
+}
+
+bool DisplayShutterMask::isVisible(int x, int y) const
+{
+    int numberOfSpans;
+    const Span *spans = getRowSpans(y, numberOfSpans);
+    for (int i = 0; i < numberOfSpans; ++i)
+    {
+        if (x >= spans[i].begin && x < spans[i].end)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int DisplayShutterMask::getNumberOfVisiblePixels() const
+{
+    return m_mask.getNumberOfPixels();
+}
+
+void DisplayShutterMask::fill(unsigned char *buffer, unsigned char maskedValue) const
+{
+    int width = getWidth();
+    for (int row = 0; row < getHeight(); ++row)
+    {
+        unsigned char *rowBuffer = buffer + static_cast<size_t>(row) * width;
+        memset(rowBuffer, maskedValue, width);
+
+        int numberOfSpans;
+        const Span *spans = getRowSpans(row, numberOfSpans);
+        for (int i = 0; i < numberOfSpans; ++i)
+        {
+            memset(rowBuffer + spans[i].begin, 0, spans[i].end - spans[i].begin);
+        }
+    }
+}
+
+vtkSmartPointer<vtkUnsignedCharArray> DisplayShutterMask::getMaskArray(const DisplayShutter &shutter, int width, int height)
+{
+    QString key = getCacheKey(shutter, width, height);
+
+    {
+        QMutexLocker locker(&maskArrayCacheMutex);
+        CachedMaskArray *cachedMaskArray = maskArrayCache.object(key);
+        if (cachedMaskArray)
+        {
+            return cachedMaskArray->array;
+        }
+    }
+
+    // The mask is computed without holding the lock so that other threads are not blocked meanwhile
+    DisplayShutterMask mask(shutter, width, height);
+    vtkSmartPointer<vtkUnsignedCharArray> maskArray = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    maskArray->SetNumberOfTuples(static_cast<vtkIdType>(mask.getWidth()) * mask.getHeight());
+    mask.fill(maskArray->GetPointer(0));
+
+    CachedMaskArray *cachedMaskArray = new CachedMaskArray();
+    cachedMaskArray->array = maskArray;
+    // At least 1 so that empty masks also count
+    int cost = qMax(1, static_cast<int>(static_cast<qint64>(mask.getWidth()) * mask.getHeight() / 1024));
+
+    QMutexLocker locker(&maskArrayCacheMutex);
+    // If the cost is greater than the maximum the entry is deleted by QCache and not inserted
+    maskArrayCache.insert(key, cachedMaskArray, cost);
+
+    return maskArray;
+}
+
+void DisplayShutterMask::clearMaskArrayCache()
+{
+    QMutexLocker locker(&maskArrayCacheMutex);
+    maskArrayCache.clear();
+}
+
+void DisplayShutterMask::rasterizeRectangle(const QPolygon &polygon)
+{
+    QRect rectangle = QRect(polygon.at(0), polygon.at(2)).normalized();
+
+    for (int row = qMax(0, rectangle.top()); row <= qMin(getHeight() - 1, rectangle.bottom()); ++row)
+    {
+        m_mask.addSpan(row, rectangle.left(), rectangle.right());
+    }
+}
+
+void DisplayShutterMask::rasterizeCircle(const QPoint &centre, int radius)
+{
+    if (radius < 0)
+    {
+        return;
+    }
+
+    qint64 squaredRadius = static_cast<qint64>(radius) * radius;
+
+    for (int row = qMax(0, centre.y() - radius); row <= qMin(getHeight() - 1, centre.y() + radius); ++row)
+    {
+        qint64 distance = row - centre.y();
+        int halfWidth = static_cast<int>(std::sqrt(static_cast<double>(squaredRadius - distance * distance)));
+        m_mask.addSpan(row, centre.x() - halfWidth, centre.x() + halfWidth);
+    }
+}
+
+QString DisplayShutterMask::getCacheKey(const DisplayShutter &shutter, int width, int height)
+{
+    QString key = QString("%1;%2;%3").arg(width).arg(height).arg(shutter.getShape());
+
+    if (shutter.getShape() == DisplayShutter::CircularShape)
+    {
+        key += QString(";%1,%2;%3").arg(shutter.getCircleCentre().x()).arg(shutter.getCircleCentre().y()).arg(shutter.getCircleRadius());
+    }
+    else
+    {
+        foreach (const QPoint &point, shutter.getAsQPolygon())
+        {
+            key += QString(";%1,%2").arg(point.x()).arg(point.y());
+        }
+    }
+
+    return key;
+}
+
+} // End namespace udg
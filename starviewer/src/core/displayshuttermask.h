@@ -0,0 +1,83 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGDISPLAYSHUTTERMASK_H
+#define UDGDISPLAYSHUTTERMASK_H
+
+#include "spanmask.h"
+
+#include <QPolygon>
+
+#include <vtkSmartPointer.h>
+
+class vtkUnsignedCharArray;
+
+namespace udg {
+
+class DisplayShutter;
+
+/**
+    Rasterization of a display shutter over an image of a given size, stored as run-length spans of visible pixels for each row.
+
+    The spans are computed directly from the geometry of the shutter: rectangles and circles analytically and polygons by scanline, including
+    the pixels crossed by the outline as the painted polygon used to do. An undefined shutter has no visible pixels.
+
+    The masks used by the viewers are obtained through getMaskArray(), which caches them by shutter geometry and image size so that all the images
+    of a stack sharing a shutter compute it once.
+ */
+class DisplayShutterMask {
+public:
+    /// Visible pixels of a row, from begin to end, end not included
+    typedef SpanMask::Span Span;
+
+    DisplayShutterMask();
+    DisplayShutterMask(const DisplayShutter &shutter, int width, int height);
+    ~DisplayShutterMask();
+
+    int getWidth() const;
+    int getHeight() const;
+
+    /// Returns the spans of the given row, sorted and without overlaps, and their number in numberOfSpans
+    const Span* getRowSpans(int row, int &numberOfSpans) const;
+
+    /// Returns true if the given pixel is visible
+    bool isVisible(int x, int y) const;
+
+    /// Returns the number of visible pixels
+    int getNumberOfVisiblePixels() const;
+
+    /// Fills the given buffer of width * height values, row by row, with 0 for visible pixels and maskedValue for the hidden ones
+    void fill(unsigned char *buffer, unsigned char maskedValue = 255) const;
+
+    /// Returns the mask of the given shutter for an image of the given size as filled by fill(). Masks are cached by shutter geometry and
+    /// image size, so the returned array is shared and must not be modified
+    static vtkSmartPointer<vtkUnsignedCharArray> getMaskArray(const DisplayShutter &shutter, int width, int height);
+
+    /// Empties the cache of getMaskArray()
+    static void clearMaskArrayCache();
+
+private:
+    void rasterizeRectangle(const QPolygon &polygon);
+    void rasterizeCircle(const QPoint &centre, int radius);
+
+    /// Returns the key that identifies the given mask in the cache
+    static QString getCacheKey(const DisplayShutter &shutter, int width, int height);
+
+private:
+    SpanMask m_mask;
+};
+
+} // End namespace udg
+
+#endif
@@ -0,0 +1,364 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "fusionlayercache.h"
+
+#include "image.h"
+#include "logging.h"
+#include "volume.h"
+
+#include <QMutexLocker>
+#include <QVector3D>
+#include <QtConcurrentRun>
+
+#include <vtkImageData.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace udg {
+
+namespace {
+
+// A slice of the primary volume is inside the secondary one if its nearest slice is less than this number of slices away, as in SliceLocator
+const double SliceProximityFactor = 1.5;
+
+// Default maximum size of the layer. Bigger layers aren't resampled, because a whole body CT with thin slices would need several times the memory of
+// the PET for a layer that only makes scrolling faster
+const qint64 DefaultMaximumLayerSize = 256 * 1024 * 1024;
+
+// Rounds integer types and just casts floating point ones
+template <typename T>
+T castValue(double value)
+{
+    if (std::numeric_limits<T>::is_integer)
+    {
+        return static_cast<T>(std::floor(value + 0.5));
+    }
+    else
+    {
+        return static_cast<T>(value);
+    }
+}
+
+// Interpolates linearly size values between the lower and upper slices
+template <typename T>
+void interpolateSlice(const T *lower, const T *upper, double weight, T *output, vtkIdType size)
+{
+    if (weight == 0.0 || lower == upper)
+    {
+        memcpy(output, lower, size * sizeof(T));
+        return;
+    }
+
+    for (vtkIdType i = 0; i < size; i++)
+    {
+        double lowerValue = static_cast<double>(lower[i]);
+        output[i] = castValue<T>(lowerValue + weight * (static_cast<double>(upper[i]) - lowerValue));
+    }
+}
+
+// Returns the position of the given image along the given normal
+double getPositionAlongNormal(const Image *image, const double normal[3])
+{
+    const double *position = image->getImagePositionPatient();
+    return position[0] * normal[0] + position[1] * normal[1] + position[2] * normal[2];
+}
+
+}
+
+FusionLayerCache::FusionLayerCache(QObject *parent)
+ : QObject(parent), m_primaryVolume(0), m_secondaryVolume(0), m_maximumLayerSize(DefaultMaximumLayerSize), m_generation(0), m_resultGeneration(-1)
+{
+}
+
+FusionLayerCache::~FusionLayerCache()
+{
+    cancel();
+}
+
+void FusionLayerCache::setVolumes(Volume *primaryVolume, Volume *secondaryVolume)
+{
+    if (primaryVolume == m_primaryVolume && secondaryVolume == m_secondaryVolume && (m_layer || m_future.isRunning()))
+    {
+        return;
+    }
+
+    cancel();
+    m_primaryVolume = primaryVolume;
+    m_secondaryVolume = secondaryVolume;
+    m_layer = 0;
+    m_nearestSlices.clear();
+
+    if (!m_primaryVolume || !m_secondaryVolume)
+    {
+        return;
+    }
+
+    ResampleParameters parameters;
+    if (!computeSamples(m_primaryVolume, m_secondaryVolume, parameters))
+    {
+        DEBUG_LOG("The secondary volume can't be resampled onto the slices of the primary one. The nearest slices will be displayed.");
+        m_nearestSlices.clear();
+        return;
+    }
+
+    int generation = m_generation.fetchAndAddOrdered(1) + 1;
+    m_future = QtConcurrent::run(this, &FusionLayerCache::resample, parameters, generation);
+}
+
+void FusionLayerCache::setMaximumLayerSize(qint64 bytes)
+{
+    m_maximumLayerSize = bytes;
+}
+
+bool FusionLayerCache::isReady() const
+{
+    return m_layer.GetPointer() != 0;
+}
+
+vtkImageData* FusionLayerCache::getLayer() const
+{
+    return m_layer;
+}
+
+int FusionLayerCache::getNearestSlice(int slice) const
+{
+    if (!isReady() || slice < 0 || slice >= m_nearestSlices.count())
+    {
+        return -1;
+    }
+
+    return m_nearestSlices.at(slice);
+}
+
+void FusionLayerCache::waitForResampling()
+{
+    m_future.waitForFinished();
+    publishResult();
+}
+
+bool FusionLayerCache::computeSamples(Volume *primaryVolume, Volume *secondaryVolume, ResampleParameters &parameters)
+{
+    if (!primaryVolume->isPixelDataLoaded() || !secondaryVolume->isPixelDataLoaded())
+    {
+        return false;
+    }
+
+    if (primaryVolume->getNumberOfPhases() != 1 || secondaryVolume->getNumberOfPhases() != 1)
+    {
+        return false;
+    }
+
+    vtkImageData *primaryData = primaryVolume->getVtkData();
+    vtkImageData *secondaryData = secondaryVolume->getVtkData();
+    int numberOfPrimarySlices = primaryData->GetDimensions()[2];
+    int numberOfSecondarySlices = secondaryData->GetDimensions()[2];
+
+    if (secondaryData->GetNumberOfScalarComponents() != 1 || numberOfPrimarySlices != primaryVolume->getNumberOfFrames()
+        || numberOfSecondarySlices != secondaryVolume->getNumberOfFrames())
+    {
+        return false;
+    }
+
+    qint64 layerSize = static_cast<qint64>(secondaryData->GetDimensions()[0]) * secondaryData->GetDimensions()[1] * numberOfPrimarySlices
+                       * secondaryData->GetScalarSize();
+    if (layerSize > m_maximumLayerSize)
+    {
+        INFO_LOG(QString("The fusion layer would need %1 bytes, more than the maximum of %2").arg(layerSize).arg(m_maximumLayerSize));
+        return false;
+    }
+
+    Image *primaryImage = primaryVolume->getImage(0);
+    Image *secondaryImage = secondaryVolume->getImage(0);
+    if (!primaryImage || !secondaryImage || !(primaryImage->getImageOrientationPatient() == secondaryImage->getImageOrientationPatient()))
+    {
+        return false;
+    }
+
+    QVector3D normalVector = primaryImage->getImageOrientationPatient().getNormalVector();
+    double normal[3] = { normalVector.x(), normalVector.y(), normalVector.z() };
+
+    // Positions of the slices of the secondary volume in ascending order, they must be strictly monotonic
+    QVector<double> secondaryPositions(numberOfSecondarySlices);
+    for (int i = 0; i < numberOfSecondarySlices; i++)
+    {
+        Image *image = secondaryVolume->getImage(i);
+        if (!image)
+        {
+            return false;
+        }
+        secondaryPositions[i] = getPositionAlongNormal(image, normal);
+    }
+
+    bool descending = numberOfSecondarySlices > 1 && secondaryPositions.last() < secondaryPositions.first();
+    if (descending)
+    {
+        std::reverse(secondaryPositions.begin(), secondaryPositions.end());
+    }
+
+    for (int i = 1; i < numberOfSecondarySlices; i++)
+    {
+        if (secondaryPositions.at(i) <= secondaryPositions.at(i - 1))
+        {
+            return false;
+        }
+    }
+
+    double maximumDistance = secondaryVolume->getSpacing()[2] * SliceProximityFactor;
+    parameters.samples.resize(numberOfPrimarySlices);
+    m_nearestSlices.resize(numberOfPrimarySlices);
+
+    for (int i = 0; i < numberOfPrimarySlices; i++)
+    {
+        Image *image = primaryVolume->getImage(i);
+        if (!image)
+        {
+            return false;
+        }
+
+        double position = getPositionAlongNormal(image, normal);
+        int next = std::lower_bound(secondaryPositions.constBegin(), secondaryPositions.constEnd(), position) - secondaryPositions.constBegin();
+
+        SliceSample sample;
+        double distance;
+        if (next == 0)
+        {
+            sample.lower = sample.upper = 0;
+            sample.weight = 0.0;
+            distance = secondaryPositions.first() - position;
+        }
+        else if (next == numberOfSecondarySlices)
+        {
+            sample.lower = sample.upper = numberOfSecondarySlices - 1;
+            sample.weight = 0.0;
+            distance = position - secondaryPositions.last();
+        }
+        else
+        {
+            sample.lower = next - 1;
+            sample.upper = next;
+            sample.weight = (position - secondaryPositions.at(next - 1)) / (secondaryPositions.at(next) - secondaryPositions.at(next - 1));
+            distance = qMin(position - secondaryPositions.at(next - 1), secondaryPositions.at(next) - position);
+        }
+
+        if (descending)
+        {
+            sample.lower = numberOfSecondarySlices - 1 - sample.lower;
+            sample.upper = numberOfSecondarySlices - 1 - sample.upper;
+        }
+
+        parameters.samples[i] = sample;
+
+        if (distance < maximumDistance)
+        {
+            m_nearestSlices[i] = sample.weight < 0.5 ? sample.lower : sample.upper;
+        }
+        else
+        {
+            m_nearestSlices[i] = -1;
+        }
+    }
+
+    // The layer has the in-plane geometry of the secondary volume and the slices of the primary one
+    m_input = secondaryData;
+    parameters.input = static_cast<const char*>(secondaryData->GetScalarPointer());
+    parameters.scalarType = secondaryData->GetScalarType();
+    parameters.scalarSize = secondaryData->GetScalarSize();
+    secondaryData->GetExtent(parameters.extent);
+    secondaryData->GetOrigin(parameters.origin);
+    secondaryData->GetSpacing(parameters.spacing);
+    parameters.origin[2] = primaryData->GetOrigin()[2];
+    parameters.spacing[2] = primaryData->GetSpacing()[2];
+
+    return true;
+}
+
+void FusionLayerCache::resample(ResampleParameters parameters, int generation)
+{
+    const int *extent = parameters.extent;
+
+    vtkSmartPointer<vtkImageData> layer = vtkSmartPointer<vtkImageData>::New();
+    layer->SetOrigin(parameters.origin);
+    layer->SetSpacing(parameters.spacing);
+    layer->SetExtent(extent[0], extent[1], extent[2], extent[3], 0, parameters.samples.count() - 1);
+    layer->AllocateScalars(parameters.scalarType, 1);
+
+    vtkIdType sliceSize = static_cast<vtkIdType>(extent[1] - extent[0] + 1) * (extent[3] - extent[2] + 1);
+    char *output = static_cast<char*>(layer->GetScalarPointer());
+
+    for (int i = 0; i < parameters.samples.count(); i++)
+    {
+        if (generation != m_generation.load())
+        {
+            return;
+        }
+
+        const SliceSample &sample = parameters.samples.at(i);
+        const char *lowerSlice = parameters.input + sample.lower * sliceSize * parameters.scalarSize;
+        const char *upperSlice = parameters.input + sample.upper * sliceSize * parameters.scalarSize;
+        char *outputSlice = output + i * sliceSize * parameters.scalarSize;
+
+        switch (parameters.scalarType)
+        {
+            vtkTemplateMacro(interpolateSlice(reinterpret_cast<const VTK_TT*>(lowerSlice), reinterpret_cast<const VTK_TT*>(upperSlice), sample.weight,
+                                              reinterpret_cast<VTK_TT*>(outputSlice), sliceSize));
+        }
+    }
+
+    {
+        QMutexLocker locker(&m_resultMutex);
+        if (generation != m_generation.load())
+        {
+            return;
+        }
+        m_result = layer;
+        m_resultGeneration = generation;
+    }
+
+    // The reference of this thread is released before publishing, the layer is only used from the thread of the cache from now on
+    layer = 0;
+    QMetaObject::invokeMethod(this, "publishResult", Qt::QueuedConnection);
+}
+
+void FusionLayerCache::cancel()
+{
+    m_generation.fetchAndAddOrdered(1);
+    m_future.waitForFinished();
+    m_input = 0;
+
+    QMutexLocker locker(&m_resultMutex);
+    m_result = 0;
+}
+
+void FusionLayerCache::publishResult()
+{
+    {
+        QMutexLocker locker(&m_resultMutex);
+        if (m_resultGeneration != m_generation.load() || !m_result)
+        {
+            return;
+        }
+        m_layer = m_result;
+        m_result = 0;
+    }
+
+    m_input = 0;
+
+    emit layerReady();
+}
+
+}
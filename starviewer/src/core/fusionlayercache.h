@@ -0,0 +1,142 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGFUSIONLAYERCACHE_H
+#define UDGFUSIONLAYERCACHE_H
+
+#include <QObject>
+
+#include <QAtomicInt>
+#include <QFuture>
+#include <QMutex>
+#include <QVector>
+
+#include <vtkSmartPointer.h>
+
+class vtkImageData;
+
+namespace udg {
+
+class Volume;
+
+/**
+    Keeps the secondary volume of a fusion (e.g. the PET of a PET-CT) resampled onto the slice grid of the primary one, so that each slice of the primary
+    volume in the acquisition plane has a slice of the secondary volume at exactly the same position.
+
+    Slices are linearly interpolated between the two nearest slices of the secondary volume along the acquisition axis, and keep the in-plane grid of the
+    secondary volume. A slice of the primary volume is considered to be inside the secondary volume if the nearest slice of the secondary is less than 1.5
+    slices away, as SliceLocator does.
+
+    The resampling is done once in a worker thread when the volumes are set, and layerReady() is emitted in the thread of the cache when it's done.
+    Only volumes with pixel data, one phase, one slice per image and the same image orientation are resampled, and only if the layer isn't bigger than
+    the maximum layer size. For the rest isReady() is always false and the viewer displays the nearest slices of the secondary volume.
+
+    The layer is only used to display the secondary volume. The values read by the tools come from the acquired slice given by getNearestSlice(), so
+    that measurements such as the SUV max aren't lowered by the interpolation.
+ */
+class FusionLayerCache : public QObject {
+Q_OBJECT
+public:
+    FusionLayerCache(QObject *parent = 0);
+    ~FusionLayerCache();
+
+    /// Sets the volumes of the fusion and starts resampling the secondary one in the background. Nothing is done if they are the ones already set.
+    /// Null volumes clear the layer
+    void setVolumes(Volume *primaryVolume, Volume *secondaryVolume);
+
+    /// Sets the maximum size in bytes of the layer. It applies to the volumes set afterwards
+    void setMaximumLayerSize(qint64 bytes);
+
+    /// Returns true if the resampled layer is available
+    bool isReady() const;
+
+    /// Returns the secondary volume resampled onto the slices of the primary one, or null if it isn't ready. It has the same scalar type as the secondary
+    /// volume, its in-plane geometry and the slice origin and spacing of the primary one, so slice i of the layer goes with slice i of the primary volume
+    vtkImageData* getLayer() const;
+
+    /// Returns the slice of the secondary volume nearest to the given slice of the primary one, or -1 if the layer isn't ready or the slice isn't near
+    /// enough to the secondary volume to be displayed
+    int getNearestSlice(int slice) const;
+
+    /// Waits for the resampling in progress and, if it has finished, makes the layer available without waiting for the event loop
+    void waitForResampling();
+
+signals:
+    /// Emitted when the resampled layer becomes available
+    void layerReady();
+
+private:
+    /// Slices of the secondary volume used to compute a slice of the layer, as upper * weight + lower * (1 - weight)
+    struct SliceSample {
+        int lower;
+        int upper;
+        double weight;
+    };
+
+    /// Everything needed by the worker to compute the layer. A copy is made for the worker, so that it doesn't access members that can change
+    struct ResampleParameters {
+        const char *input;
+        int scalarType;
+        int scalarSize;
+        int extent[6];
+        double origin[3];
+        double spacing[3];
+        QVector<SliceSample> samples;
+    };
+
+    /// Computes the slice samples and the nearest slices. Returns false if the volumes can't be resampled
+    bool computeSamples(Volume *primaryVolume, Volume *secondaryVolume, ResampleParameters &parameters);
+
+    /// Computes the layer of the given parameters and keeps it to be published if it hasn't been cancelled. It's run in a worker thread
+    void resample(ResampleParameters parameters, int generation);
+
+    /// Cancels the resampling in progress and waits for it
+    void cancel();
+
+private slots:
+    /// Makes the layer computed by the last resampling available if it hasn't been cancelled
+    void publishResult();
+
+private:
+    /// Volumes of the current layer
+    Volume *m_primaryVolume;
+    Volume *m_secondaryVolume;
+
+    /// Layers bigger than this number of bytes aren't resampled
+    qint64 m_maximumLayerSize;
+
+    /// Pixel data of the secondary volume being resampled, kept alive until the resampling finishes
+    vtkSmartPointer<vtkImageData> m_input;
+
+    /// The resampled layer, null until it's ready
+    vtkSmartPointer<vtkImageData> m_layer;
+
+    /// For each slice of the primary volume, the nearest slice of the secondary volume or -1 if it isn't near enough
+    QVector<int> m_nearestSlices;
+
+    /// Incremented every time a resampling is started or cancelled, resamplings with an older generation are stale
+    QAtomicInt m_generation;
+
+    /// Resampling in progress
+    QFuture<void> m_future;
+
+    /// Layer computed by the last resampling, waiting to be published in the thread of the cache
+    vtkSmartPointer<vtkImageData> m_result;
+    int m_resultGeneration;
+    QMutex m_resultMutex;
+};
+
+}
+
+#endif
@@ -17,7 +17,6 @@
 #include "hangingprotocolimagesetrestriction.h"
 #include "logging.h"
 
-#include <QJSEngine>
 #include <QRegularExpression>
 #include <QSet>
 
@@ -26,6 +25,7 @@ namespace udg {
 HangingProtocolImageSetRestrictionExpression::HangingProtocolImageSetRestrictionExpression()
     : m_expression("true")
 {
+    compile();
 }
 
 HangingProtocolImageSetRestrictionExpression::HangingProtocolImageSetRestrictionExpression(const QString &expression,
@@ -35,6 +35,7 @@ HangingProtocolImageSetRestrictionExpression::HangingProtocolImageSetRestriction
     sanitize();
     filterUsedRestrictions();
     prepareForEvaluation();
+    compile();
 }
 
 HangingProtocolImageSetRestrictionExpression::~HangingProtocolImageSetRestrictionExpression()
@@ -43,26 +44,22 @@ HangingProtocolImageSetRestrictionExpression::~HangingProtocolImageSetRestrictio
 
 bool HangingProtocolImageSetRestrictionExpression::test(const Series *series) const
 {
-    QList<bool> results;
-
-    foreach (const HangingProtocolImageSetRestriction &restriction, m_restrictions)
+    if (m_nodes.isEmpty())
     {
-        results.append(restriction.test(series));
+        return true;
     }
 
-    return evaluate(results);
+    return evaluate(m_nodes.size() - 1, series);
 }
 
 bool HangingProtocolImageSetRestrictionExpression::test(const Image *image) const
 {
-    QList<bool> results;
-
-    foreach (const HangingProtocolImageSetRestriction &restriction, m_restrictions)
+    if (m_nodes.isEmpty())
     {
-        results.append(restriction.test(image));
+        return true;
     }
 
-    return evaluate(results);
+    return evaluate(m_nodes.size() - 1, image);
 }
 
 void HangingProtocolImageSetRestrictionExpression::sanitize()
@@ -101,27 +98,156 @@ void HangingProtocolImageSetRestrictionExpression::prepareForEvaluation()
     m_expression.replace("and", "&").replace("or", "|").replace("not", "!").replace(QRegularExpression("(\\d+)"), "%\\1");
 }
 
-bool HangingProtocolImageSetRestrictionExpression::evaluate(const QList<bool> &results) const
+void HangingProtocolImageSetRestrictionExpression::compile()
 {
-    QString expression = m_expression;
+    m_nodes.clear();
+
+    int position = 0;
+    int root = parseOr(position);
 
-    foreach (bool result, results)
+    if (root < 0 || position != m_expression.size())
     {
-        expression = expression.arg(result);
+        m_nodes.clear();
+        DEBUG_LOG(QString("Error while parsing expression \"%1\" at position %2. It will always evaluate to true.").arg(m_expression).arg(position));
+        ERROR_LOG(QString("Error while parsing expression \"%1\" at position %2. It will always evaluate to true.").arg(m_expression).arg(position));
     }
+}
 
-    QJSEngine scriptEngine;
-    QJSValue result = scriptEngine.evaluate(expression);
+int HangingProtocolImageSetRestrictionExpression::parseOr(int &position)
+{
+    int left = parseAnd(position);
 
-    if (!result.isError())
+    while (left >= 0 && position < m_expression.size() && m_expression.at(position) == '|')
     {
-        return result.toBool();
+        // "||" is accepted as well, as it was by the previous script based evaluation
+        while (position < m_expression.size() && m_expression.at(position) == '|')
+        {
+            ++position;
+        }
+
+        int right = parseAnd(position);
+        left = right >= 0 ? addNode(Or, 0, left, right) : -1;
     }
-    else
+
+    return left;
+}
+
+int HangingProtocolImageSetRestrictionExpression::parseAnd(int &position)
+{
+    int left = parseNot(position);
+
+    while (left >= 0 && position < m_expression.size() && m_expression.at(position) == '&')
     {
-        DEBUG_LOG(QString("Error while evaluating expression \"%1\": %2").arg(expression).arg(result.toString()));
-        ERROR_LOG(QString("Error while evaluating expression \"%1\": %2").arg(expression).arg(result.toString()));
-        return true;
+        while (position < m_expression.size() && m_expression.at(position) == '&')
+        {
+            ++position;
+        }
+
+        int right = parseNot(position);
+        left = right >= 0 ? addNode(And, 0, left, right) : -1;
+    }
+
+    return left;
+}
+
+int HangingProtocolImageSetRestrictionExpression::parseNot(int &position)
+{
+    if (position < m_expression.size() && m_expression.at(position) == '!')
+    {
+        ++position;
+        int operand = parseNot(position);
+        return operand >= 0 ? addNode(Not, 0, operand) : -1;
+    }
+
+    return parsePrimary(position);
+}
+
+int HangingProtocolImageSetRestrictionExpression::parsePrimary(int &position)
+{
+    if (position >= m_expression.size())
+    {
+        return -1;
+    }
+
+    if (m_expression.at(position) == '(')
+    {
+        ++position;
+        int subexpression = parseOr(position);
+
+        if (subexpression < 0 || position >= m_expression.size() || m_expression.at(position) != ')')
+        {
+            return -1;
+        }
+
+        ++position;
+        return subexpression;
+    }
+
+    if (m_expression.midRef(position).startsWith("true"))
+    {
+        position += 4;
+        return addNode(Constant, true);
+    }
+
+    if (m_expression.at(position) == '%')
+    {
+        int start = ++position;
+        while (position < m_expression.size() && m_expression.at(position).isDigit())
+        {
+            ++position;
+        }
+
+        bool ok;
+        int identifier = m_expression.mid(start, position - start).toInt(&ok);
+
+        // Restrictions not defined are an error, as it was with the previous script based evaluation
+        if (!ok || !m_restrictions.contains(identifier))
+        {
+            return -1;
+        }
+
+        return addNode(Restriction, identifier);
+    }
+
+    return -1;
+}
+
+int HangingProtocolImageSetRestrictionExpression::addNode(int type, int value, int left, int right)
+{
+    Node node;
+    node.type = type;
+    node.value = value;
+    node.left = left;
+    node.right = right;
+    m_nodes.append(node);
+
+    return m_nodes.size() - 1;
+}
+
+template <class T>
+bool HangingProtocolImageSetRestrictionExpression::evaluate(int nodeIndex, const T *object) const
+{
+    const Node &node = m_nodes.at(nodeIndex);
+
+    switch (node.type)
+    {
+        case Constant:
+            return node.value;
+
+        case Restriction:
+            return m_restrictions.constFind(node.value).value().test(object);
+
+        case Not:
+            return !evaluate(node.left, object);
+
+        case And:
+            return evaluate(node.left, object) && evaluate(node.right, object);
+
+        case Or:
+            return evaluate(node.left, object) || evaluate(node.right, object);
+
+        default:
+            return true;
     }
 }
 
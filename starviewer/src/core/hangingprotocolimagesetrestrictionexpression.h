@@ -19,6 +19,7 @@
 
 #include <QMap>
 #include <QString>
+#include <QVector>
 
 namespace udg {
 
@@ -28,6 +29,9 @@ class Series;
 /**
  * @brief The HangingProtocolImageSetRestrictionExpression class represents a boolean expression involving several restrictions of type
  * HangingProtocolImageSetRestriction. The expression is evaluated by evaluating all the restrictions and combining their results according to the expression.
+ *
+ * The expression is parsed only once, when it is created, into a syntax tree that is evaluated natively on each test. Restrictions are evaluated lazily,
+ * with short-circuit of "and" and "or". Evaluation doesn't modify the object, so the same expression can be tested from several threads at the same time.
  */
 class HangingProtocolImageSetRestrictionExpression
 {
@@ -49,14 +53,41 @@ private:
     void filterUsedRestrictions();
     /// Transforms the expression to prepare it for evaluation.
     void prepareForEvaluation();
-    /// Evaluates the expression with the given results for each restriction.
-    bool evaluate(const QList<bool> &results) const;
+    /// Parses the prepared expression into the syntax tree. If the expression is not valid the tree is left empty.
+    void compile();
+
+    /// Parsing functions for each precedence level: or, and, not, and operands or parenthesized subexpressions.
+    /// They return the index of the created node or -1 if there is a syntax error.
+    int parseOr(int &position);
+    int parseAnd(int &position);
+    int parseNot(int &position);
+    int parsePrimary(int &position);
+    /// Appends a node to the syntax tree and returns its index.
+    int addNode(int type, int value, int left = -1, int right = -1);
+
+    /// Evaluates the given node of the syntax tree for the given series or image.
+    template <class T>
+    bool evaluate(int nodeIndex, const T *object) const;
 
 private:
+    /// Node types of the syntax tree.
+    enum NodeType { Constant, Restriction, Not, And, Or };
+
+    /// Node of the syntax tree. Value is the boolean value for constants and the restriction identifier for restrictions.
+    struct Node
+    {
+        int type;
+        int value;
+        int left;
+        int right;
+    };
+
     /// Boolean expression that is evaluated.
     QString m_expression;
     /// Restrictions used in the expression.
     QMap<int, HangingProtocolImageSetRestriction> m_restrictions;
+    /// Syntax tree of the expression. The root is the last node. It's empty if the expression is not valid.
+    QVector<Node> m_nodes;
 
 };
 
@@ -34,6 +34,8 @@
 // Necessari per poder anar a buscar prèvies
 #include "../inputoutput/relatedstudiesmanager.h"
 
+#include <QtConcurrentRun>
+
 namespace udg {
 
 HangingProtocolManager::HangingProtocolManager(QObject *parent)
@@ -79,54 +81,34 @@ QList<HangingProtocol*> HangingProtocolManager::searchHangingProtocols(Study *st
 {
     QList<HangingProtocol*> outputHangingProtocolList;
 
+    // Les modalitats i institucions de l'estudi es calculen un sol cop per descartar ràpidament els protocols incompatibles abans de copiar-los
+    QSet<QString> studyModalities = study->getModalities().toSet();
+    QSet<QString> studyInstitutions;
+    foreach (Series *series, study->getSeries())
+    {
+        studyInstitutions << series->getInstitutionName();
+    }
+
     // Buscar el hangingProtocol que s'ajusta millor a l'estudi del pacient
     // Aprofitem per assignar ja les series, per millorar el rendiment
+    // Cada candidat s'omple en paral·lel sobre una còpia independent, només es llegeixen els estudis
+    QList<QFuture<HangingProtocol*> > candidates;
     foreach (HangingProtocol *hangingProtocolBase, m_availableHangingProtocols)
     {
-        HangingProtocol *hangingProtocol = new HangingProtocol(*hangingProtocolBase);
-        if (isModalityCompatible(hangingProtocol, study) && isInstitutionCompatible(hangingProtocol, study) && hangingProtocol->getNumberOfPriors() <= previousStudies.size())
+        if (hangingProtocolBase->getNumberOfPriors() <= previousStudies.size() && isModalityCompatible(hangingProtocolBase, studyModalities) &&
+            isInstitutionCompatible(hangingProtocolBase, studyInstitutions))
         {
-            HangingProtocolFiller hangingProtocolFiller;
-            hangingProtocolFiller.fill(hangingProtocol, study, previousStudies);
-
-            int numberOfFilledImageSets = hangingProtocol->countFilledImageSets();
-
-            bool isValidHangingProtocol = false;
-
-            if (hangingProtocol->isStrict())
-            {
-                if (numberOfFilledImageSets == hangingProtocol->getNumberOfImageSets())
-                {
-                    isValidHangingProtocol = true;
-                }
-            }
-            else
-            {
-                if (numberOfFilledImageSets > 0)
-                {
-                    if (hangingProtocol->getNumberOfPriors() > 0)
-                    {
-                        int filledImageSetsWithPriors = hangingProtocol->countFilledImageSetsWithPriors();
-                        if (filledImageSetsWithPriors == 0 || numberOfFilledImageSets == filledImageSetsWithPriors)
-                        {
-                            isValidHangingProtocol = false;
-                        }
-                        else
-                        {
-                            isValidHangingProtocol = true;
-                        }
-                    }
-                    else
-                    {
-                        isValidHangingProtocol = true;
-                    }
-                }
-            }
+            candidates << QtConcurrent::run(&HangingProtocolManager::fillHangingProtocol, hangingProtocolBase, study, previousStudies);
+        }
+    }
 
-            if (isValidHangingProtocol)
-            {
-                outputHangingProtocolList << hangingProtocol;
-            }
+    // Es recullen els resultats en l'ordre dels protocols disponibles
+    for (int i = 0; i < candidates.size(); ++i)
+    {
+        HangingProtocol *hangingProtocol = candidates[i].result();
+        if (hangingProtocol)
+        {
+            outputHangingProtocolList << hangingProtocol;
         }
     }
 
@@ -234,29 +216,74 @@ void HangingProtocolManager::applyHangingProtocol(HangingProtocol *hangingProtoc
     INFO_LOG(QString("Hanging protocol aplicat: %1").arg(hangingProtocol->getName()));
 }
 
-bool HangingProtocolManager::isModalityCompatible(HangingProtocol *protocol, Study *study)
+HangingProtocol* HangingProtocolManager::fillHangingProtocol(HangingProtocol *hangingProtocolBase, Study *study, const QList<Study*> &previousStudies)
 {
-    foreach (const QString &modality, study->getModalities())
+    HangingProtocol *hangingProtocol = new HangingProtocol(*hangingProtocolBase);
+
+    HangingProtocolFiller hangingProtocolFiller;
+    hangingProtocolFiller.fill(hangingProtocol, study, previousStudies);
+
+    int numberOfFilledImageSets = hangingProtocol->countFilledImageSets();
+
+    bool isValidHangingProtocol = false;
+
+    if (hangingProtocol->isStrict())
     {
-        if (isModalityCompatible(protocol, modality))
+        if (numberOfFilledImageSets == hangingProtocol->getNumberOfImageSets())
         {
-            return true;
+            isValidHangingProtocol = true;
+        }
+    }
+    else
+    {
+        if (numberOfFilledImageSets > 0)
+        {
+            if (hangingProtocol->getNumberOfPriors() > 0)
+            {
+                int filledImageSetsWithPriors = hangingProtocol->countFilledImageSetsWithPriors();
+                if (filledImageSetsWithPriors == 0 || numberOfFilledImageSets == filledImageSetsWithPriors)
+                {
+                    isValidHangingProtocol = false;
+                }
+                else
+                {
+                    isValidHangingProtocol = true;
+                }
+            }
+            else
+            {
+                isValidHangingProtocol = true;
+            }
         }
     }
 
-    return false;
+    if (!isValidHangingProtocol)
+    {
+        delete hangingProtocol;
+        return 0;
+    }
+
+    return hangingProtocol;
 }
 
-bool HangingProtocolManager::isModalityCompatible(HangingProtocol *protocol, const QString &modality)
+bool HangingProtocolManager::isModalityCompatible(HangingProtocol *protocol, const QSet<QString> &modalities)
 {
-    return protocol->getHangingProtocolMask()->getProtocolList().contains(modality);
+    foreach (const QString &modality, protocol->getHangingProtocolMask()->getProtocolList())
+    {
+        if (modalities.contains(modality))
+        {
+            return true;
+        }
+    }
+
+    return false;
 }
 
-bool HangingProtocolManager::isInstitutionCompatible(HangingProtocol *protocol, Study *study)
+bool HangingProtocolManager::isInstitutionCompatible(HangingProtocol *protocol, const QSet<QString> &institutionNames)
 {
-    foreach(Series *series, study->getSeries())
+    foreach (const QString &institutionName, institutionNames)
     {
-        if (isValidInstitution(protocol, series->getInstitutionName()))
+        if (isValidInstitution(protocol, institutionName))
         {
             return true;
         }
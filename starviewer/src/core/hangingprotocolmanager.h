@@ -20,6 +20,7 @@
 #include <QMultiHash>
 #include <QPointer>
 #include <QProgressDialog>
+#include <QSet>
 
 namespace udg {
 
@@ -77,17 +78,18 @@ private slots:
     void errorDownloadingPreviousStudies(const QString &studyUID);
 
 private:
-    /// Mira si el protocol es pot aplicar al pacient
-    bool isModalityCompatible(HangingProtocol *protocol, Study *study);
+    /// Fa una còpia del protocol donat i l'omple amb les sèries de l'estudi i els previs. Retorna la còpia si el protocol és aplicable
+    /// i null altrament. És thread-safe, per poder omplir els candidats en paral·lel.
+    static HangingProtocol* fillHangingProtocol(HangingProtocol *hangingProtocolBase, Study *study, const QList<Study*> &previousStudies);
 
-    /// Mira si la modalitat és compatible amb el protocol
-    bool isModalityCompatible(HangingProtocol *protocol, const QString &modality);
+    /// Mira si alguna de les modalitats donades és compatible amb el protocol
+    static bool isModalityCompatible(HangingProtocol *protocol, const QSet<QString> &modalities);
 
-    /// Mira si la institució és compatible amb el protocol
-    bool isInstitutionCompatible(HangingProtocol *protocol, Study *study);
+    /// Mira si alguna de les institucions donades és compatible amb el protocol
+    static bool isInstitutionCompatible(HangingProtocol *protocol, const QSet<QString> &institutionNames);
 
     /// Comprova si el protocol és aplicable a la institució. Si el protocol no té expressió regular per institució és aplicable
-    bool isValidInstitution(HangingProtocol *protocol, const QString &institutionName);
+    static bool isValidInstitution(HangingProtocol *protocol, const QString &institutionName);
 
     /// Mètode encarregat d'assignar l'input al viewer a partir de les especificacions del displaySet+imageSet.
     void setInputToViewer(Q2DViewerWidget *viewerWidget, HangingProtocolDisplaySet *displaySet);
@@ -19,7 +19,9 @@
 #include "thumbnailcreator.h"
 #include "mathtools.h"
 #include "imageoverlayreader.h"
+#include "imageoverlaycache.h"
 #include "preferredpixelspacingselector.h"
+#include "stringpool.h"
 
 #include <QFileInfo>
 
@@ -326,7 +328,7 @@ QTime Image::getRetrievedTime()
 
 void Image::setImageType(const QString &imageType)
 {
-    m_imageType = imageType;
+    m_imageType = StringPool::instance()->intern(imageType);
 }
 
 QString Image::getImageType() const
@@ -336,7 +338,7 @@ QString Image::getImageType() const
 
 void Image::setViewPosition(const QString &viewPosition)
 {
-    m_viewPosition = viewPosition;
+    m_viewPosition = StringPool::instance()->intern(viewPosition);
 }
 
 QString Image::getViewPosition() const
@@ -356,7 +358,7 @@ QChar Image::getImageLaterality() const
 
 void Image::setViewCodeMeaning(const QString &viewCodeMeaning)
 {
-    m_viewCodeMeaning = viewCodeMeaning;
+    m_viewCodeMeaning = StringPool::instance()->intern(viewCodeMeaning);
 }
 
 QString Image::getViewCodeMeaning() const
@@ -439,7 +441,7 @@ QString Image::getFormattedImageTime() const
 
 void Image::setTransferSyntaxUID(const QString &transferSyntaxUID)
 {
-    m_transferSyntaxUID = transferSyntaxUID;
+    m_transferSyntaxUID = StringPool::instance()->intern(transferSyntaxUID);
 }
 
 const QString& Image::getTransferSyntaxUID() const
@@ -692,29 +694,17 @@ QStringList Image::getSupportedModalities()
 
 bool Image::readOverlays(bool splitOverlays)
 {
+    if (splitOverlays)
+    {
+        return ImageOverlayCache::readSplitOverlays(this->getPath(), m_overlaysSplit);
+    }
+
     ImageOverlayReader reader;
     reader.setFilename(this->getPath());
     if (reader.read())
     {
-        if (splitOverlays)
-        {
-            bool mergeOk;
-            ImageOverlay mergedOverlay = ImageOverlay::mergeOverlays(reader.getOverlays(), mergeOk);
-            if (!mergeOk)
-            {
-                ERROR_LOG("Ha fallat el merge d'overlays! Possible causa: falta de memòria");
-                DEBUG_LOG("Ha fallat el merge d'overlays! Possible causa: falta de memòria");
-                return false;
-            }
-
-            m_overlaysSplit = mergedOverlay.split();
-            return true;
-        }
-        else
-        {
-            m_overlaysList = reader.getOverlays();
-            return true;
-        }
+        m_overlaysList = reader.getOverlays();
+        return true;
     }
     else
     {
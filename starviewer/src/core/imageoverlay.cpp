@@ -19,6 +19,8 @@
 #include "imageoverlayregionfinder.h"
 #include "mathtools.h"
 
+#include <cstring>
+
 #include <QRect>
 #include <QRegExp>
 #include <QStringList>
@@ -27,6 +29,30 @@
 
 namespace udg {
 
+namespace {
+
+// Fa l'OR dels length bytes de source sobre destination, de 8 en 8 bytes i la resta d'un en un
+void orBytes(unsigned char *destination, const unsigned char *source, size_t length)
+{
+    size_t index = 0;
+    for (; index + sizeof(quint64) <= length; index += sizeof(quint64))
+    {
+        quint64 destinationWord;
+        quint64 sourceWord;
+        memcpy(&destinationWord, destination + index, sizeof(quint64));
+        memcpy(&sourceWord, source + index, sizeof(quint64));
+        destinationWord |= sourceWord;
+        memcpy(destination + index, &destinationWord, sizeof(quint64));
+    }
+
+    for (; index < length; ++index)
+    {
+        destination[index] |= source[index];
+    }
+}
+
+}
+
 ImageOverlay::ImageOverlay()
 {
     m_rows = 0;
@@ -254,31 +280,17 @@ ImageOverlay ImageOverlay::mergeOverlays(const QList<ImageOverlay> &overlaysList
     // Hem pogut allotjar les dades, procedim a omplir-les amb les dades dels overlays
     memset(data, 0, sizeof(unsigned char) * outColumns * outRows);
         
-    int subDataIndex;
-    int subDataXIndex;
-    int subDataYIndex;
-    int outDataIndex;
-    unsigned char outValue = 0;
-    for (int outYIndex = 0; outYIndex < outRows; ++outYIndex)
+    // Cada overlay queda sencer dins del buffer fusionat, per tant n'afegim cada fila a la posició que li correspon fent l'OR de 8 bytes de cop
+    foreach (const ImageOverlay &overlay, validOverlaysList)
     {
-        for (int outXIndex = 0; outXIndex < outColumns; ++outXIndex)
+        int xOffset = overlay.getXOrigin() - outOriginX;
+        int yOffset = overlay.getYOrigin() - outOriginY;
+        const unsigned char *overlayData = overlay.getData();
+
+        for (int row = 0; row < overlay.getRows(); ++row)
         {
-            outValue = 0;
-            
-            foreach (const ImageOverlay &overlay, validOverlaysList)
-            {
-                subDataXIndex = outOriginX - overlay.getXOrigin() + outXIndex;
-                subDataYIndex = outOriginY - overlay.getYOrigin() + outYIndex;
-
-                if (subDataXIndex >= 0 && subDataYIndex >=0 && subDataXIndex < overlay.getColumns() && subDataYIndex < overlay.getRows())
-                {
-                    subDataIndex = subDataXIndex + subDataYIndex * overlay.getColumns();
-                    outValue |= overlay.getData()[subDataIndex];
-                }
-            }
-
-            outDataIndex = outXIndex + outYIndex * outColumns;
-            data[outDataIndex] = outValue;
+            orBytes(data + static_cast<size_t>(row + yOffset) * outColumns + xOffset, overlayData + static_cast<size_t>(row) * overlay.getColumns(),
+                    overlay.getColumns());
         }
     }
     
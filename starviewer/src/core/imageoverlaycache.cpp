@@ -0,0 +1,187 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "imageoverlaycache.h"
+
+#include "image.h"
+#include "imageoverlayreader.h"
+#include "logging.h"
+
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QtConcurrentRun>
+
+namespace udg {
+
+const int ImageOverlayCache::DefaultMaximumSizeInKiB = 128 * 1024;
+
+ImageOverlayCache::ImageOverlayCache(int maximumSizeInKiB)
+ : m_cache(maximumSizeInKiB), m_prefetchCancelled(0)
+{
+}
+
+ImageOverlayCache::~ImageOverlayCache()
+{
+    cancelPrefetch();
+}
+
+QList<ImageOverlay> ImageOverlayCache::getOverlays(const Image *image)
+{
+    if (!image || !image->hasOverlays())
+    {
+        return QList<ImageOverlay>();
+    }
+
+    QString path = image->getPath();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        QList<ImageOverlay> *cachedOverlays = m_cache.object(path);
+        if (cachedOverlays)
+        {
+            return *cachedOverlays;
+        }
+    }
+
+    // The file is read without holding the lock so that the prefetch thread is not blocked meanwhile
+    QList<ImageOverlay> splitOverlays;
+    if (readSplitOverlays(path, splitOverlays))
+    {
+        insert(path, splitOverlays, false);
+    }
+
+    return splitOverlays;
+}
+
+bool ImageOverlayCache::contains(const QString &path) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.contains(path);
+}
+
+void ImageOverlayCache::prefetch(const QStringList &paths)
+{
+    cancelPrefetch();
+
+    if (paths.isEmpty())
+    {
+        return;
+    }
+
+    m_prefetchCancelled.storeRelease(0);
+    m_prefetchFuture = QtConcurrent::run(this, &ImageOverlayCache::prefetchPaths, paths);
+}
+
+void ImageOverlayCache::cancelPrefetch()
+{
+    m_prefetchCancelled.storeRelease(1);
+    m_prefetchFuture.waitForFinished();
+}
+
+void ImageOverlayCache::clear()
+{
+    cancelPrefetch();
+
+    QMutexLocker locker(&m_mutex);
+    m_cache.clear();
+}
+
+bool ImageOverlayCache::readSplitOverlays(const QString &path, QList<ImageOverlay> &splitOverlays)
+{
+    // ImageOverlayReader returns no overlays instead of failing when the file can't be read, but they must not be cached as if it didn't have any
+    if (!QFileInfo(path).isReadable())
+    {
+        ERROR_LOG("No es pot llegir el fitxer de la imatge amb path: " + path);
+        DEBUG_LOG("No es pot llegir el fitxer de la imatge amb path: " + path);
+        return false;
+    }
+
+    ImageOverlayReader reader;
+    reader.setFilename(path);
+    if (!reader.read())
+    {
+        ERROR_LOG("Ha fallat la lectura de l'overlay de la imatge amb path: " + path);
+        DEBUG_LOG("Ha fallat la lectura de l'overlay de la imatge amb path: " + path);
+        return false;
+    }
+
+    bool mergeOk;
+    ImageOverlay mergedOverlay = ImageOverlay::mergeOverlays(reader.getOverlays(), mergeOk);
+    if (!mergeOk)
+    {
+        ERROR_LOG("Ha fallat el merge d'overlays! Possible causa: falta de memòria");
+        DEBUG_LOG("Ha fallat el merge d'overlays! Possible causa: falta de memòria");
+        return false;
+    }
+
+    splitOverlays = mergedOverlay.split();
+    return true;
+}
+
+bool ImageOverlayCache::insert(const QString &path, const QList<ImageOverlay> &overlays, bool mustNotEvict)
+{
+    int cost = computeCost(overlays);
+
+    QMutexLocker locker(&m_mutex);
+
+    if (mustNotEvict && m_cache.totalCost() + cost > m_cache.maxCost())
+    {
+        return false;
+    }
+
+    // If the cost is greater than the maximum the list is deleted by QCache and not inserted, it will be read again the next time
+    m_cache.insert(path, new QList<ImageOverlay>(overlays), cost);
+    return true;
+}
+
+void ImageOverlayCache::prefetchPaths(const QStringList &paths)
+{
+    foreach (const QString &path, paths)
+    {
+        if (m_prefetchCancelled.loadAcquire())
+        {
+            return;
+        }
+
+        if (contains(path))
+        {
+            continue;
+        }
+
+        QList<ImageOverlay> splitOverlays;
+        if (readSplitOverlays(path, splitOverlays))
+        {
+            // The prefetch must not evict overlays that have been requested, so it stops when the cache is full
+            if (!insert(path, splitOverlays, true))
+            {
+                DEBUG_LOG("Overlays cache is full, prefetch stopped");
+                return;
+            }
+        }
+    }
+}
+
+int ImageOverlayCache::computeCost(const QList<ImageOverlay> &overlays)
+{
+    qint64 bytes = 0;
+    foreach (const ImageOverlay &overlay, overlays)
+    {
+        bytes += static_cast<qint64>(overlay.getRows()) * overlay.getColumns();
+    }
+
+    // At least 1 so that empty lists also count
+    return qMax(1, static_cast<int>(bytes / 1024));
+}
+
+}
@@ -0,0 +1,92 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGIMAGEOVERLAYCACHE_H
+#define UDGIMAGEOVERLAYCACHE_H
+
+#include "imageoverlay.h"
+
+#include <QAtomicInt>
+#include <QCache>
+#include <QFuture>
+#include <QMutex>
+#include <QStringList>
+
+namespace udg {
+
+class Image;
+
+/**
+    Bounded cache of split overlays (as returned by Image::getOverlaysSplit()) keyed by file path.
+
+    Overlays are decoded on demand with getOverlays(). Besides that, prefetch() decodes the given files in a background thread, in the given order, until
+    the cache is full or the prefetch is cancelled. The cost of each entry is the memory used by its overlay data, in kilobytes.
+ */
+class ImageOverlayCache {
+
+public:
+    /// Creates a cache that will hold at most maximumSizeInKiB kilobytes of overlay data.
+    explicit ImageOverlayCache(int maximumSizeInKiB = DefaultMaximumSizeInKiB);
+    ~ImageOverlayCache();
+
+    /// Returns the split overlays of the given image, reading them from file if they are not cached yet.
+    /// Returns an empty list if the image is null, doesn't have overlays or they can't be read.
+    QList<ImageOverlay> getOverlays(const Image *image);
+
+    /// Returns true if the overlays of the given file are in the cache.
+    bool contains(const QString &path) const;
+
+    /// Starts decoding in background the overlays of the given files, in the given order. Any prefetch in progress is cancelled first.
+    void prefetch(const QStringList &paths);
+    /// Cancels the prefetch in progress, if any, and waits until it has stopped.
+    void cancelPrefetch();
+
+    /// Cancels the prefetch in progress and removes all the cached overlays.
+    void clear();
+
+    /// Reads the overlays of the given file, merges them and splits the result in optimal regions.
+    /// Returns true if the file has been read successfully and false if it doesn't exist, can't be read or the overlays can't be merged.
+    static bool readSplitOverlays(const QString &path, QList<ImageOverlay> &splitOverlays);
+
+private:
+    /// Inserts the given overlays in the cache. Returns false if they have not been inserted because the cache is full and mustNotEvict is true.
+    bool insert(const QString &path, const QList<ImageOverlay> &overlays, bool mustNotEvict);
+
+    /// Method run in the background thread by prefetch().
+    void prefetchPaths(const QStringList &paths);
+
+    /// Returns the cost of the given overlays in kilobytes.
+    static int computeCost(const QList<ImageOverlay> &overlays);
+
+private:
+    /// Default maximum size of the cached overlays data (128 MiB).
+    static const int DefaultMaximumSizeInKiB;
+
+    /// Cached split overlays by path.
+    QCache<QString, QList<ImageOverlay> > m_cache;
+
+    /// Protects the cache from concurrent access from the prefetch thread.
+    mutable QMutex m_mutex;
+
+    /// Future of the prefetch in progress.
+    QFuture<void> m_prefetchFuture;
+
+    /// Set to non-zero to ask the prefetch thread to stop.
+    QAtomicInt m_prefetchCancelled;
+
+};
+
+}
+
+#endif // UDGIMAGEOVERLAYCACHE_H
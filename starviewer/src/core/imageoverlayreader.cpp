@@ -16,11 +16,27 @@
 
 #include "logging.h"
 
+#include <cstring>
+#include <vector>
+
+#include <gdcmAttribute.h>
 #include <gdcmImageReader.h>
 #include <gdcmOverlay.h>
+#include <gdcmReader.h>
 
 namespace udg {
 
+namespace {
+
+const gdcm::Tag PixelDataTag(0x7fe0, 0x0010);
+
+// Grups dels overlays: de 0x6000 a 0x601E, només els parells
+const unsigned short FirstOverlayGroup = 0x6000;
+const unsigned short LastOverlayGroup = 0x601E;
+const unsigned short OverlayDataElement = 0x3000;
+
+}
+
 ImageOverlayReader::ImageOverlayReader()
 {
 }
@@ -54,6 +70,149 @@ QList<ImageOverlay> ImageOverlayReader::getOverlays() const
 }
 
 gdcm::Image ImageOverlayReader::getGDCMImageFromFile(const QString &filename)
+{
+    // Els overlays són als grups 60xx, que van abans del Pixel Data. Per tant llegim només fins al Pixel Data, sense llegir-lo ni descodificar-lo
+    gdcm::Reader reader;
+    reader.SetFileName(qPrintable(filename));
+    if (!reader.ReadUpToTag(PixelDataTag))
+    {
+        ERROR_LOG("Ha fallat la lectura del fitxer: " + filename + " [ImageOverlayReader]");
+        DEBUG_LOG("Ha fallat la lectura del fitxer: " + filename);
+        return gdcm::Image();
+    }
+
+    const gdcm::DataSet &dataSet = reader.GetFile().GetDataSet();
+    std::vector<gdcm::Overlay> overlays;
+    std::vector<bool> overlaysInPixelData;
+
+    for (unsigned short group = FirstOverlayGroup; group <= LastOverlayGroup; group += 2)
+    {
+        gdcm::Overlay overlay;
+        overlay.SetGroup(group);
+        bool found = false;
+
+        gdcm::DataSet::ConstIterator it = dataSet.GetDES().lower_bound(gdcm::DataElement(gdcm::Tag(group, 0x0000)));
+        for (; it != dataSet.GetDES().end() && it->GetTag().GetGroup() == group; ++it)
+        {
+            overlay.Update(*it);
+            found = true;
+        }
+
+        if (found)
+        {
+            overlays.push_back(overlay);
+            overlaysInPixelData.push_back(!dataSet.FindDataElement(gdcm::Tag(group, OverlayDataElement)));
+        }
+    }
+
+    for (size_t i = 0; i < overlays.size(); ++i)
+    {
+        if (overlaysInPixelData[i])
+        {
+            // Hi ha overlays dins dels bits no usats del Pixel Data: cal llegir-lo, però no cal descodificar-lo si no està encapsulat
+            if (!readOverlaysFromPixelData(filename, overlays, overlaysInPixelData))
+            {
+                return getGDCMImageFromFileDecodingPixelData(filename);
+            }
+            break;
+        }
+    }
+
+    gdcm::Image image;
+    image.SetNumberOfOverlays(overlays.size());
+    for (size_t i = 0; i < overlays.size(); ++i)
+    {
+        image.GetOverlay(i) = overlays[i];
+    }
+
+    return image;
+}
+
+bool ImageOverlayReader::readOverlaysFromPixelData(const QString &filename, std::vector<gdcm::Overlay> &overlays, const std::vector<bool> &overlaysInPixelData)
+{
+    gdcm::Reader reader;
+    reader.SetFileName(qPrintable(filename));
+    if (!reader.Read())
+    {
+        return false;
+    }
+
+    // Només sabem extreure els bits de les dades natives en little endian, la resta les deixem per gdcm::ImageReader
+    const gdcm::TransferSyntax &transferSyntax = reader.GetFile().GetHeader().GetDataSetTransferSyntax();
+    if (transferSyntax.IsEncapsulated() || transferSyntax.GetSwapCode() == gdcm::SwapCode::BigEndian)
+    {
+        return false;
+    }
+
+    const gdcm::DataSet &dataSet = reader.GetFile().GetDataSet();
+    if (!dataSet.FindDataElement(PixelDataTag))
+    {
+        return false;
+    }
+
+    const gdcm::ByteValue *pixelData = dataSet.GetDataElement(PixelDataTag).GetByteValue();
+    if (!pixelData)
+    {
+        return false;
+    }
+
+    gdcm::Attribute<0x0028, 0x0100> bitsAllocated;
+    bitsAllocated.SetFromDataSet(dataSet);
+
+    for (size_t i = 0; i < overlays.size(); ++i)
+    {
+        if (overlaysInPixelData[i])
+        {
+            std::vector<char> packedBits;
+            if (!packOverlayBits(pixelData->GetPointer(), pixelData->GetLength(), bitsAllocated.GetValue(), overlays[i].GetBitPosition(),
+                                 static_cast<size_t>(overlays[i].GetRows()) * overlays[i].GetColumns(), packedBits))
+            {
+                return false;
+            }
+
+            overlays[i].SetOverlay(&packedBits[0], packedBits.size());
+        }
+    }
+
+    return true;
+}
+
+bool ImageOverlayReader::packOverlayBits(const char *pixelData, size_t pixelDataLength, unsigned short bitsAllocated, unsigned short bitPosition,
+                                         size_t numberOfPixels, std::vector<char> &packedBits)
+{
+    if ((bitsAllocated != 8 && bitsAllocated != 16) || bitPosition >= bitsAllocated || numberOfPixels == 0
+        || numberOfPixels * (bitsAllocated / 8) > pixelDataLength)
+    {
+        return false;
+    }
+
+    // Cada byte empaquetat conté el bit de l'overlay de 8 píxels consecutius, el primer píxel al bit menys significatiu
+    packedBits.assign((numberOfPixels + 7) / 8, 0);
+
+    for (size_t pixel = 0; pixel < numberOfPixels; ++pixel)
+    {
+        unsigned short word;
+        if (bitsAllocated == 16)
+        {
+            quint16 value;
+            memcpy(&value, pixelData + pixel * 2, sizeof(quint16));
+            word = value;
+        }
+        else
+        {
+            word = static_cast<unsigned char>(pixelData[pixel]);
+        }
+
+        if ((word >> bitPosition) & 1)
+        {
+            packedBits[pixel / 8] |= static_cast<char>(1 << (pixel % 8));
+        }
+    }
+
+    return true;
+}
+
+gdcm::Image ImageOverlayReader::getGDCMImageFromFileDecodingPixelData(const QString &filename)
 {
     gdcm::ImageReader imageReader;
     imageReader.SetFileName(qPrintable(filename));
@@ -17,10 +17,13 @@
 
 #include <QList>
 
+#include <vector>
+
 #include "imageoverlay.h"
 
 namespace gdcm {
 class Image;
+class Overlay;
 }
 
 namespace udg {
@@ -30,6 +33,9 @@ class ImageOverlay;
 /**
     Classe per llegir overlays a través d'un arxiu. Per llegir els overlays caldrà assignar primer el nom de l'arxiu
     del que volem llegir els overlays i després fer-ne la lectura. Un cop feta la lectura podrem obtenir els overlays amb getOverlays()
+
+    Només es llegeixen els grups 60xx de l'arxiu, sense llegir ni descodificar el Pixel Data. Només cal llegir-lo quan hi ha overlays
+    incrustats als bits no usats dels píxels, i en aquest cas se n'extreu el bit de l'overlay de les dades natives sense descodificar-les.
     
     Exemple:
     \code
@@ -56,9 +62,21 @@ public:
     QList<ImageOverlay> getOverlays() const;
 
 private:
-    /// Ens retorna una gdcm::Image a partir del nom de fitxer especificat. Retornarà nul en cas d'error
+    /// Ens retorna una gdcm::Image amb els overlays del fitxer especificat, però sense les dades dels píxels. Retornarà nul en cas d'error
     virtual gdcm::Image getGDCMImageFromFile(const QString &filename);
 
+    /// Omple les dades dels overlays indicats per overlaysInPixelData amb els bits corresponents del Pixel Data del fitxer.
+    /// Retorna fals si no es poden extreure directament, per exemple si el Pixel Data està encapsulat
+    bool readOverlaysFromPixelData(const QString &filename, std::vector<gdcm::Overlay> &overlays, const std::vector<bool> &overlaysInPixelData);
+
+    /// Empaqueta a packedBits el bit bitPosition dels primers numberOfPixels píxels de pixelData, en little endian, tal com es guarden
+    /// a l'Overlay Data. Retorna fals si els paràmetres no són vàlids
+    static bool packOverlayBits(const char *pixelData, size_t pixelDataLength, unsigned short bitsAllocated, unsigned short bitPosition,
+                                size_t numberOfPixels, std::vector<char> &packedBits);
+
+    /// Ens retorna la gdcm::Image del fitxer especificat descodificant-ne el Pixel Data. Retornarà nul en cas d'error
+    gdcm::Image getGDCMImageFromFileDecodingPixelData(const QString &filename);
+
 private:
     /// Nom de l'arxiu del que hem de llegir els overlays
     QString m_filename;
@@ -27,6 +27,34 @@
 #include <log4cxx/propertyconfigurator.h>
 #include <log4cxx/helpers/exception.h>
 
+namespace udg {
+
+namespace logging {
+
+/// Loggers used by the macros. They are looked up only once because Logger::getLogger() takes a lock and transcodes the name on every call.
+/// The macros of log4cxx already check the level before evaluating the message, so messages of disabled levels are never formatted.
+inline const log4cxx::LoggerPtr& developmentLogger()
+{
+    static const log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("development"));
+    return logger;
+}
+
+inline const log4cxx::LoggerPtr& infoLogger()
+{
+    static const log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("info.release"));
+    return logger;
+}
+
+inline const log4cxx::LoggerPtr& errorsLogger()
+{
+    static const log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("errors.release"));
+    return logger;
+}
+
+}
+
+}
+
 /// Macro per a inicialitzar els logger
 /// Definim la variable d'entorn que indica la localització
 /// dels fitxers de log i llavors llegim la configuració dels logs
@@ -36,6 +64,10 @@
         QByteArray logFilePathValue = (QDir::toNativeSeparators(udg::UserLogsFile)).toLatin1(); \
         qputenv("logFilePath", logFilePathValue); \
         log4cxx::PropertyConfigurator::configure(file); \
+        /* Els loggers s'obtenen aquí per primer cop perquè la inicialització no es faci des de diferents threads */ \
+        udg::logging::developmentLogger(); \
+        udg::logging::infoLogger(); \
+        udg::logging::errorsLogger(); \
     } else (void)0
 
 /// Macro per a missatges de debug. \TODO de moment fem servir aquesta variable de qmake i funciona bé, però podria ser més adequat troba la forma d'afegir
@@ -46,7 +78,7 @@
 #define DEBUG_LOG(msg) \
     if (true) \
     { \
-        LOG4CXX_DEBUG(log4cxx::Logger::getLogger("development"), qPrintable(QString(msg))) \
+        LOG4CXX_DEBUG(udg::logging::developmentLogger(), qPrintable(QString(msg))) \
     } else (void)0
 
 #endif
@@ -55,28 +87,28 @@
 #define INFO_LOG(msg) \
     if (true) \
     { \
-        LOG4CXX_INFO(log4cxx::Logger::getLogger("info.release"), QString(msg).toUtf8().constData()) \
+        LOG4CXX_INFO(udg::logging::infoLogger(), QString(msg).toUtf8().constData()) \
     } else (void)0
 
 /// Macro per a missatges de warning
 #define WARN_LOG(msg) \
     if (true) \
     { \
-        LOG4CXX_WARN(log4cxx::Logger::getLogger("info.release"), QString(msg).toUtf8().constData()) \
+        LOG4CXX_WARN(udg::logging::infoLogger(), QString(msg).toUtf8().constData()) \
     } else (void)0
 
 /// Macro per a missatges d'error
 #define ERROR_LOG(msg) \
     if (true) \
     { \
-        LOG4CXX_ERROR(log4cxx::Logger::getLogger("errors.release"), QString(msg).toUtf8().constData()) \
+        LOG4CXX_ERROR(udg::logging::errorsLogger(), QString(msg).toUtf8().constData()) \
     } else (void)0
 
 /// Macro per a missatges d'error fatals/crítics
 #define FATAL_LOG(msg) \
     if (true) \
     { \
-        LOG4CXX_FATAL(log4cxx::Logger::getLogger("errors.release"), QString(msg).toUtf8().constData()) \
+        LOG4CXX_FATAL(udg::logging::errorsLogger(), QString(msg).toUtf8().constData()) \
     } else (void)0
 
 #endif
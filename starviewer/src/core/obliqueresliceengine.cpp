@@ -0,0 +1,588 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "obliqueresliceengine.h"
+
+#include "logging.h"
+
+#include <QMutexLocker>
+#include <QThread>
+#include <QtConcurrentRun>
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace udg {
+
+namespace {
+
+// Number of rows of samples computed at once by a thread. Requests are cancelled between tiles
+const int TileSampleRows = 8;
+
+// Value of the output pixels that fall out of the input
+const double BackgroundValue = 0.0;
+
+// Returns true if the given scalar type is one of the types that the reslice is instantiated for
+bool isSupportedScalarType(int scalarType)
+{
+    switch (scalarType)
+    {
+        vtkTemplateMacro(return true);
+    }
+
+    return false;
+}
+
+// Converts an interpolated value to the given scalar type. Integer values are rounded and clamped to the range of the type
+template <class T>
+inline T convertToScalarType(double value)
+{
+    if (std::numeric_limits<T>::is_integer)
+    {
+        value = qBound<double>(std::numeric_limits<T>::min(), std::floor(value + 0.5), std::numeric_limits<T>::max());
+    }
+
+    return static_cast<T>(value);
+}
+
+}
+
+ObliqueResliceEngine::ObliqueResliceEngine(QObject *parent)
+ : QObject(parent), m_previewInterpolation(Linear), m_previewDecimation(2), m_geometryModified(false), m_refinementNeeded(false), m_generation(0),
+   m_resultGeneration(-1)
+{
+    m_output = vtkSmartPointer<vtkImageData>::New();
+
+    for (int i = 0; i < 16; i++)
+    {
+        m_resliceAxes[i] = i % 5 == 0 ? 1.0 : 0.0;
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        m_outputSpacing[i] = 1.0;
+        m_outputDimensions[i] = 1;
+    }
+}
+
+ObliqueResliceEngine::~ObliqueResliceEngine()
+{
+    cancel();
+    waitForRequests();
+}
+
+void ObliqueResliceEngine::setInput(vtkImageData *input)
+{
+    // Els workers llegeixen directament les dades de l'input anterior
+    cancel();
+    waitForRequests();
+
+    if (input && !isSupportedScalarType(input->GetScalarType()))
+    {
+        ERROR_LOG(QString("L'input del reslice és de tipus %1, que no es pot reconstruir").arg(input->GetScalarTypeAsString()));
+        m_input = 0;
+    }
+    else
+    {
+        m_input = input;
+    }
+
+    m_geometryModified = true;
+}
+
+vtkImageData* ObliqueResliceEngine::getOutput() const
+{
+    return m_output;
+}
+
+void ObliqueResliceEngine::setResliceAxes(vtkMatrix4x4 *resliceAxes)
+{
+    double elements[16];
+    for (int row = 0; row < 4; row++)
+    {
+        for (int column = 0; column < 4; column++)
+        {
+            elements[row * 4 + column] = resliceAxes->GetElement(row, column);
+        }
+    }
+
+    if (memcmp(elements, m_resliceAxes, sizeof(elements)) != 0)
+    {
+        memcpy(m_resliceAxes, elements, sizeof(elements));
+        m_geometryModified = true;
+    }
+}
+
+void ObliqueResliceEngine::setOutputSpacing(double x, double y, double z)
+{
+    if (m_outputSpacing[0] != x || m_outputSpacing[1] != y || m_outputSpacing[2] != z)
+    {
+        m_outputSpacing[0] = x;
+        m_outputSpacing[1] = y;
+        m_outputSpacing[2] = z;
+        m_geometryModified = true;
+    }
+}
+
+void ObliqueResliceEngine::setOutputDimensions(int x, int y, int z)
+{
+    x = qMax(x, 1);
+    y = qMax(y, 1);
+    z = qMax(z, 1);
+
+    if (m_outputDimensions[0] != x || m_outputDimensions[1] != y || m_outputDimensions[2] != z)
+    {
+        m_outputDimensions[0] = x;
+        m_outputDimensions[1] = y;
+        m_outputDimensions[2] = z;
+        m_geometryModified = true;
+    }
+}
+
+void ObliqueResliceEngine::setPreviewInterpolation(Interpolation interpolation)
+{
+    m_previewInterpolation = interpolation;
+}
+
+ObliqueResliceEngine::Interpolation ObliqueResliceEngine::getPreviewInterpolation() const
+{
+    return m_previewInterpolation;
+}
+
+void ObliqueResliceEngine::setPreviewDecimation(int decimation)
+{
+    m_previewDecimation = qMax(decimation, 1);
+}
+
+int ObliqueResliceEngine::getPreviewDecimation() const
+{
+    return m_previewDecimation;
+}
+
+void ObliqueResliceEngine::update(Quality quality)
+{
+    if (quality == FullQuality && !m_geometryModified && !m_refinementNeeded)
+    {
+        return;
+    }
+
+    cancel();
+    int generation = m_generation.load();
+
+    ResliceParameters parameters = getParameters(quality);
+    resizeOutput(parameters);
+    computeReslice(parameters, m_output->GetScalarPointer(), generation);
+    m_output->Modified();
+
+    m_geometryModified = false;
+    m_refinementNeeded = quality != FullQuality;
+}
+
+void ObliqueResliceEngine::requestPreview()
+{
+    if (!m_geometryModified)
+    {
+        return;
+    }
+
+    m_geometryModified = false;
+    m_refinementNeeded = true;
+    startRequest(getParameters(PreviewQuality));
+}
+
+void ObliqueResliceEngine::requestRefinement()
+{
+    if (!m_geometryModified && !m_refinementNeeded)
+    {
+        return;
+    }
+
+    m_geometryModified = false;
+    m_refinementNeeded = false;
+    startRequest(getParameters(FullQuality));
+}
+
+void ObliqueResliceEngine::cancel()
+{
+    m_generation.ref();
+}
+
+ObliqueResliceEngine::ResliceParameters ObliqueResliceEngine::getParameters(Quality quality) const
+{
+    ResliceParameters parameters;
+
+    parameters.input = NULL;
+    if (m_input)
+    {
+        parameters.input = m_input->GetScalarPointer();
+    }
+
+    if (parameters.input)
+    {
+        parameters.scalarType = m_input->GetScalarType();
+        parameters.numberOfComponents = m_input->GetNumberOfScalarComponents();
+        int extent[6];
+        m_input->GetExtent(extent);
+        m_input->GetDimensions(parameters.inputDimensions);
+        m_input->GetIncrements(parameters.inputIncrements);
+        m_input->GetSpacing(parameters.inputSpacing);
+        m_input->GetOrigin(parameters.inputOrigin);
+
+        // El punter apunta al primer vòxel de l'extent, que no té per què ser 0
+        for (int i = 0; i < 3; i++)
+        {
+            parameters.inputOrigin[i] += extent[2 * i] * parameters.inputSpacing[i];
+        }
+    }
+    else
+    {
+        parameters.scalarType = VTK_SHORT;
+        parameters.numberOfComponents = 1;
+        for (int i = 0; i < 3; i++)
+        {
+            parameters.inputDimensions[i] = 0;
+            parameters.inputIncrements[i] = 0;
+            parameters.inputSpacing[i] = 1.0;
+            parameters.inputOrigin[i] = 0.0;
+        }
+    }
+
+    memcpy(parameters.resliceAxes, m_resliceAxes, sizeof(m_resliceAxes));
+    for (int i = 0; i < 3; i++)
+    {
+        parameters.outputDimensions[i] = m_outputDimensions[i];
+        parameters.outputSpacing[i] = m_outputSpacing[i];
+    }
+
+    if (quality == FullQuality)
+    {
+        parameters.interpolation = Cubic;
+        parameters.decimation = 1;
+    }
+    else
+    {
+        parameters.interpolation = m_previewInterpolation;
+        parameters.decimation = m_previewDecimation;
+    }
+
+    return parameters;
+}
+
+void ObliqueResliceEngine::startRequest(const ResliceParameters &parameters)
+{
+    // Les peticions anteriors queden obsoletes i s'aturaran al final de la tessel·la que estiguin calculant
+    int generation = m_generation.fetchAndAddOrdered(1) + 1;
+
+    QList<QFuture<void> >::iterator iterator = m_requests.begin();
+    while (iterator != m_requests.end())
+    {
+        if (iterator->isFinished())
+        {
+            iterator = m_requests.erase(iterator);
+        }
+        else
+        {
+            ++iterator;
+        }
+    }
+
+    m_requests << QtConcurrent::run(this, &ObliqueResliceEngine::runRequest, parameters, generation);
+}
+
+void ObliqueResliceEngine::runRequest(ResliceParameters parameters, int generation)
+{
+    QByteArray result(static_cast<int>(getOutputSize(parameters)), Qt::Uninitialized);
+    if (!computeReslice(parameters, result.data(), generation))
+    {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_resultMutex);
+        if (generation != m_generation.load())
+        {
+            return;
+        }
+        m_result = result;
+        m_resultParameters = parameters;
+        m_resultGeneration = generation;
+    }
+
+    // La sortida només es pot modificar des del thread de l'engine, ja que els visors la poden estar fent servir
+    QMetaObject::invokeMethod(this, "publishResult", Qt::QueuedConnection);
+}
+
+void ObliqueResliceEngine::publishResult()
+{
+    QByteArray result;
+    ResliceParameters parameters;
+    {
+        QMutexLocker locker(&m_resultMutex);
+        if (m_resultGeneration != m_generation.load() || m_result.isEmpty())
+        {
+            return;
+        }
+        result = m_result;
+        parameters = m_resultParameters;
+        m_result.clear();
+    }
+
+    resizeOutput(parameters);
+    memcpy(m_output->GetScalarPointer(), result.constData(), result.size());
+    m_output->Modified();
+
+    emit outputUpdated();
+}
+
+bool ObliqueResliceEngine::computeReslice(const ResliceParameters &parameters, void *output, int generation)
+{
+    int decimation = parameters.decimation;
+    int sampleRowsPerSlice = (parameters.outputDimensions[1] + decimation - 1) / decimation;
+    int numberOfSampleRows = sampleRowsPerSlice * parameters.outputDimensions[2];
+
+    ResliceJob job;
+    job.parameters = parameters;
+    job.output = output;
+    job.generation = generation;
+    job.numberOfTiles = (numberOfSampleRows + TileSampleRows - 1) / TileSampleRows;
+    job.nextTile = 0;
+
+    // El thread actual també calcula tessel·les
+    int numberOfThreads = qBound(1, QThread::idealThreadCount(), job.numberOfTiles);
+    QList<QFuture<void> > workers;
+    for (int i = 1; i < numberOfThreads; i++)
+    {
+        workers << QtConcurrent::run(this, &ObliqueResliceEngine::computeTiles, &job);
+    }
+    computeTiles(&job);
+
+    foreach (QFuture<void> worker, workers)
+    {
+        worker.waitForFinished();
+    }
+
+    return generation == m_generation.load();
+}
+
+void ObliqueResliceEngine::computeTiles(ResliceJob *job)
+{
+    int decimation = job->parameters.decimation;
+    int sampleRowsPerSlice = (job->parameters.outputDimensions[1] + decimation - 1) / decimation;
+    int numberOfSampleRows = sampleRowsPerSlice * job->parameters.outputDimensions[2];
+
+    int tile;
+    while ((tile = job->nextTile.fetchAndAddRelaxed(1)) < job->numberOfTiles)
+    {
+        if (job->generation != m_generation.load())
+        {
+            return;
+        }
+
+        int firstSampleRow = tile * TileSampleRows;
+        int lastSampleRow = qMin(firstSampleRow + TileSampleRows, numberOfSampleRows) - 1;
+        switch (job->parameters.scalarType)
+        {
+            vtkTemplateMacro(resliceRows(job->parameters, static_cast<VTK_TT*>(job->output), firstSampleRow, lastSampleRow));
+        }
+    }
+}
+
+void ObliqueResliceEngine::resizeOutput(const ResliceParameters &parameters)
+{
+    const int *dimensions = parameters.outputDimensions;
+
+    int extent[6];
+    m_output->GetExtent(extent);
+    if (extent[0] != 0 || extent[1] != dimensions[0] - 1 || extent[2] != 0 || extent[3] != dimensions[1] - 1 || extent[4] != 0 ||
+        extent[5] != dimensions[2] - 1 || !m_output->GetScalarPointer() || m_output->GetScalarType() != parameters.scalarType ||
+        m_output->GetNumberOfScalarComponents() != parameters.numberOfComponents)
+    {
+        m_output->SetExtent(0, dimensions[0] - 1, 0, dimensions[1] - 1, 0, dimensions[2] - 1);
+        m_output->AllocateScalars(parameters.scalarType, parameters.numberOfComponents);
+    }
+
+    m_output->SetOrigin(0.0, 0.0, 0.0);
+    m_output->SetSpacing(parameters.outputSpacing[0], parameters.outputSpacing[1], parameters.outputSpacing[2]);
+}
+
+void ObliqueResliceEngine::waitForRequests()
+{
+    foreach (QFuture<void> request, m_requests)
+    {
+        request.waitForFinished();
+    }
+    m_requests.clear();
+}
+
+qint64 ObliqueResliceEngine::getOutputSize(const ResliceParameters &parameters)
+{
+    return static_cast<qint64>(parameters.outputDimensions[0]) * parameters.outputDimensions[1] * parameters.outputDimensions[2] *
+           parameters.numberOfComponents * vtkDataArray::GetDataTypeSize(parameters.scalarType);
+}
+
+template <class T>
+void ObliqueResliceEngine::resliceRows(const ResliceParameters &parameters, T *output, int firstSampleRow, int lastSampleRow)
+{
+    const int *dimensions = parameters.outputDimensions;
+    int numberOfComponents = parameters.numberOfComponents;
+    int decimation = parameters.decimation;
+    int sampleRowsPerSlice = (dimensions[1] + decimation - 1) / decimation;
+
+    // L'índex continu a l'input del punt (x, y, z) de l'output és (resliceAxes * (x, y, z, 1) - inputOrigin) / inputSpacing.
+    // Com que és lineal, calculem l'índex del vòxel (0, 0, 0) i l'increment per cada pas en cada eix de l'output
+    const double *axes = parameters.resliceAxes;
+    double originIndex[3];
+    double increment[3][3];
+    for (int i = 0; i < 3; i++)
+    {
+        originIndex[i] = (axes[i * 4 + 3] - parameters.inputOrigin[i]) / parameters.inputSpacing[i];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            increment[axis][i] = axes[i * 4 + axis] * parameters.outputSpacing[axis] / parameters.inputSpacing[i];
+        }
+    }
+
+    for (int sampleRow = firstSampleRow; sampleRow <= lastSampleRow; sampleRow++)
+    {
+        int z = sampleRow / sampleRowsPerSlice;
+        int y = (sampleRow % sampleRowsPerSlice) * decimation;
+        T *row = output + ((static_cast<qint64>(z) * dimensions[1] + y) * dimensions[0]) * numberOfComponents;
+
+        double rowIndex[3];
+        for (int i = 0; i < 3; i++)
+        {
+            rowIndex[i] = originIndex[i] + y * increment[1][i] + z * increment[2][i];
+        }
+
+        for (int x = 0; x < dimensions[0]; x += decimation)
+        {
+            double index[3] = { rowIndex[0] + x * increment[0][0], rowIndex[1] + x * increment[0][1], rowIndex[2] + x * increment[0][2] };
+            T *value = row + x * numberOfComponents;
+            if (parameters.input)
+            {
+                sample(parameters, index, value);
+            }
+            else
+            {
+                for (int component = 0; component < numberOfComponents; component++)
+                {
+                    value[component] = static_cast<T>(BackgroundValue);
+                }
+            }
+
+            int columns = qMin(decimation, dimensions[0] - x);
+            for (int column = 1; column < columns; column++)
+            {
+                memcpy(value + column * numberOfComponents, value, numberOfComponents * sizeof(T));
+            }
+        }
+
+        // La resta de files que comparteixen mostra són una còpia d'aquesta
+        int rows = qMin(decimation, dimensions[1] - y);
+        for (int i = 1; i < rows; i++)
+        {
+            memcpy(row + i * dimensions[0] * numberOfComponents, row, dimensions[0] * numberOfComponents * sizeof(T));
+        }
+    }
+}
+
+template <class T>
+void ObliqueResliceEngine::sample(const ResliceParameters &parameters, const double index[3], T *value)
+{
+    const T *input = static_cast<const T*>(parameters.input);
+    const int *dimensions = parameters.inputDimensions;
+    const vtkIdType *increments = parameters.inputIncrements;
+    int numberOfComponents = parameters.numberOfComponents;
+
+    // Els punts a més de mig vòxel fora de l'input tenen el valor de fons
+    for (int i = 0; i < 3; i++)
+    {
+        if (index[i] < -0.5 || index[i] > dimensions[i] - 0.5)
+        {
+            for (int component = 0; component < numberOfComponents; component++)
+            {
+                value[component] = static_cast<T>(BackgroundValue);
+            }
+            return;
+        }
+    }
+
+    if (parameters.interpolation == NearestNeighbor)
+    {
+        vtkIdType offset = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            offset += qBound(0, static_cast<int>(std::floor(index[i] + 0.5)), dimensions[i] - 1) * increments[i];
+        }
+        memcpy(value, input + offset, numberOfComponents * sizeof(T));
+        return;
+    }
+
+    // Índexs i pesos dels vòxels veïns a cada eix. Els veïns de fora de l'input es substitueixen pel de la vora
+    int numberOfTaps = parameters.interpolation == Linear ? 2 : 4;
+    vtkIdType offsets[3][4];
+    double weights[3][4];
+    for (int i = 0; i < 3; i++)
+    {
+        double position = qBound(0.0, index[i], dimensions[i] - 1.0);
+        int base = static_cast<int>(std::floor(position));
+        double t = position - base;
+
+        if (parameters.interpolation == Linear)
+        {
+            weights[i][0] = 1.0 - t;
+            weights[i][1] = t;
+        }
+        else
+        {
+            // Catmull-Rom
+            base -= 1;
+            weights[i][0] = ((-0.5 * t + 1.0) * t - 0.5) * t;
+            weights[i][1] = (1.5 * t - 2.5) * t * t + 1.0;
+            weights[i][2] = ((-1.5 * t + 2.0) * t + 0.5) * t;
+            weights[i][3] = (0.5 * t - 0.5) * t * t;
+        }
+
+        for (int tap = 0; tap < numberOfTaps; tap++)
+        {
+            offsets[i][tap] = qBound(0, base + tap, dimensions[i] - 1) * increments[i];
+        }
+    }
+
+    // Els increments de l'input compten tots els components, per tant cada component es llegeix desplaçant el punter al seu
+    for (int component = 0; component < numberOfComponents; component++)
+    {
+        double sum = 0.0;
+        for (int k = 0; k < numberOfTaps; k++)
+        {
+            for (int j = 0; j < numberOfTaps; j++)
+            {
+                double weightJK = weights[1][j] * weights[2][k];
+                const T *row = input + offsets[1][j] + offsets[2][k] + component;
+                for (int i = 0; i < numberOfTaps; i++)
+                {
+                    sum += weights[0][i] * weightJK * row[offsets[0][i]];
+                }
+            }
+        }
+
+        value[component] = convertToScalarType<T>(sum);
+    }
+}
+
+}
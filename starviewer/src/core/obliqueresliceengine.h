@@ -0,0 +1,191 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGOBLIQUERESLICEENGINE_H
+#define UDGOBLIQUERESLICEENGINE_H
+
+#include <QObject>
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QFuture>
+#include <QList>
+#include <QMutex>
+
+#include <vtkSmartPointer.h>
+
+class vtkImageData;
+class vtkMatrix4x4;
+
+namespace udg {
+
+/**
+    Reslices a volume along an oblique plane, like vtkImageReslice, but split in tiles that are computed by several threads and with support for
+    asynchronous requests, so that the plane can be dragged without blocking the GUI thread.
+
+    The geometry is given as in vtkImageReslice: the reslice axes map output coordinates to input coordinates. The output origin is always 0 and its
+    extent always starts at 0. The output image returned by getOutput() is always the same object, so it can be given to a viewer once.
+
+    update() computes the full quality reslice (cubic interpolation at every pixel) synchronously. requestPreview() and requestRefinement() compute it
+    in the background and replace the output and emit outputUpdated() in the thread of the engine when they finish. The preview only samples one pixel
+    out of every getPreviewDecimation() in each direction, with nearest neighbour or linear interpolation, and replicates it to the skipped ones.
+    Each new request or call to update() cancels the previous ones, that stop at the end of the tile they are computing and are never published.
+
+    The input is resliced with its own scalar type and all its components, without copying it, so several engines can share the same input.
+    Interpolated values of integer types are rounded and clamped to the range of the type.
+ */
+class ObliqueResliceEngine : public QObject {
+Q_OBJECT
+public:
+    enum Interpolation { NearestNeighbor, Linear, Cubic };
+    enum Quality { PreviewQuality, FullQuality };
+
+    ObliqueResliceEngine(QObject *parent = 0);
+    ~ObliqueResliceEngine();
+
+    /// Sets the image to reslice. Waits for the requests in progress to finish. Images with a scalar type that isn't numeric are ignored
+    void setInput(vtkImageData *input);
+
+    /// Returns the resliced image
+    vtkImageData* getOutput() const;
+
+    /// Sets the geometry of the output, as in vtkImageReslice
+    void setResliceAxes(vtkMatrix4x4 *resliceAxes);
+    void setOutputSpacing(double x, double y, double z);
+    void setOutputDimensions(int x, int y, int z);
+
+    /// Interpolation used by previews. It's Linear by default
+    void setPreviewInterpolation(Interpolation interpolation);
+    Interpolation getPreviewInterpolation() const;
+
+    /// Number of pixels in each direction that share the same sample in previews. It's 2 by default
+    void setPreviewDecimation(int decimation);
+    int getPreviewDecimation() const;
+
+    /// Computes the reslice with the given quality in the current thread (using all the threads for the tiles) and updates the output.
+    /// With FullQuality nothing is done if the output already has full quality for the current geometry
+    void update(Quality quality = FullQuality);
+
+    /// Starts computing a preview for the current geometry in the background. Nothing is done if the geometry hasn't changed since the last request
+    void requestPreview();
+
+    /// Starts computing the full quality reslice in the background if the output or the last request don't have full quality for the current geometry
+    void requestRefinement();
+
+    /// Cancels the requests in progress. Their results are never published
+    void cancel();
+
+signals:
+    /// Emitted when the output has been updated by a request
+    void outputUpdated();
+
+private:
+    /// Everything needed to compute a reslice. A copy is made for each request, so that workers don't access members that can change
+    struct ResliceParameters {
+        const void *input;
+        int scalarType;
+        int numberOfComponents;
+        int inputDimensions[3];
+        vtkIdType inputIncrements[3];
+        double inputOrigin[3];
+        double inputSpacing[3];
+        double resliceAxes[16];
+        int outputDimensions[3];
+        double outputSpacing[3];
+        Interpolation interpolation;
+        int decimation;
+    };
+
+    /// Reslice being computed by several threads
+    struct ResliceJob {
+        ResliceParameters parameters;
+        void *output;
+        int generation;
+        int numberOfTiles;
+        QAtomicInt nextTile;
+    };
+
+    /// Returns the parameters to compute the current geometry with the given quality
+    ResliceParameters getParameters(Quality quality) const;
+
+    /// Starts computing the given parameters in the background
+    void startRequest(const ResliceParameters &parameters);
+
+    /// Computes the given parameters and publishes the result if it hasn't been cancelled. It's run in a worker thread
+    void runRequest(ResliceParameters parameters, int generation);
+
+    /// Computes the reslice of the given parameters into output with several threads. Returns false if it has been cancelled
+    bool computeReslice(const ResliceParameters &parameters, void *output, int generation);
+
+    /// Computes tiles of the given job until there are no more or the job is cancelled
+    void computeTiles(ResliceJob *job);
+
+    /// Reallocates the output image if its dimensions are not the ones of the given parameters and sets its spacing
+    void resizeOutput(const ResliceParameters &parameters);
+
+    /// Waits for the requests in progress
+    void waitForRequests();
+
+    /// Returns the size in bytes of the output of the given parameters
+    static qint64 getOutputSize(const ResliceParameters &parameters);
+
+    /// Computes the given rows of samples. Rows are numbered across all the output slices, and each row of samples fills decimation rows of the
+    /// output. T is the scalar type of the input and the output
+    template <class T>
+    static void resliceRows(const ResliceParameters &parameters, T *output, int firstSampleRow, int lastSampleRow);
+
+    /// Writes in value the interpolated components of the input at the given continuous index
+    template <class T>
+    static void sample(const ResliceParameters &parameters, const double index[3], T *value);
+
+private slots:
+    /// Publishes the result of the last request if it hasn't been superseded
+    void publishResult();
+
+private:
+    /// Input image
+    vtkSmartPointer<vtkImageData> m_input;
+
+    /// Output image
+    vtkSmartPointer<vtkImageData> m_output;
+
+    /// Output geometry
+    double m_resliceAxes[16];
+    double m_outputSpacing[3];
+    int m_outputDimensions[3];
+
+    Interpolation m_previewInterpolation;
+    int m_previewDecimation;
+
+    /// True if the geometry has changed since the last request
+    bool m_geometryModified;
+    /// True if the output, or the last request, doesn't have full quality for the current geometry
+    bool m_refinementNeeded;
+
+    /// Incremented every time a request is started or cancelled, requests with an older generation are stale
+    QAtomicInt m_generation;
+
+    /// Requests started in the background
+    QList<QFuture<void> > m_requests;
+
+    /// Result of the last finished request, waiting to be published in the thread of the engine
+    QByteArray m_result;
+    ResliceParameters m_resultParameters;
+    int m_resultGeneration;
+    QMutex m_resultMutex;
+};
+
+}
+
+#endif // UDGOBLIQUERESLICEENGINE_H
@@ -103,6 +103,14 @@ Patient::~Patient()
     m_studiesList.clear();
 }
 
+Patient* Patient::copyWithoutStudies() const
+{
+    Patient *copy = new Patient(*this);
+    copy->m_studiesList.clear();
+
+    return copy;
+}
+
 void Patient::setFullName(const QString &name)
 {
     m_fullName = name;
@@ -38,6 +38,9 @@ public:
     Patient(const Patient &patient, QObject *parent = 0);
     ~Patient();
 
+    /// Retorna una còpia del pacient amb tota la seva informació però sense els estudis. Qui la demana se n'ha d'encarregar d'esborrar-la
+    Patient* copyWithoutStudies() const;
+
     /// Assigna/Obté el nom complet del pacient
     void setFullName(const QString &name);
     QString getFullName() const;
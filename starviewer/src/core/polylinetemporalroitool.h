@@ -47,12 +47,9 @@ private slots:
     void start();
 
 private:
-    /// Metode per calcular la mitjana temporal de la regio del polyline
+    /// Metode per calcular la mitjana i la resta d'estadístiques temporals de la regio del polyline
     double computeTemporalMean();
 
-    /// Metode que retorna la serie temporal de mida size en una determinada coordenada
-    QVector<double> getGraySerie(double *coords, int size);
-
 private:
     /// Dades específiques de la tool
     PolylineTemporalROIToolData *m_myData;
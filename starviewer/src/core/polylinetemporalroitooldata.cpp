@@ -22,6 +22,7 @@ PolylineTemporalROIToolData::PolylineTemporalROIToolData(QObject *parent)
 {
     m_temporalImage = 0;
     m_temporalImageHasBeenDefined = false;
+    m_statistics.numberOfVoxels = 0;
 }
 
 PolylineTemporalROIToolData::~PolylineTemporalROIToolData()
@@ -34,4 +35,10 @@ void PolylineTemporalROIToolData::setMeanVector(QVector<double> m)
     emit dataChanged();
 }
 
+void PolylineTemporalROIToolData::setStatistics(const TemporalROIEngine::Statistics &statistics)
+{
+    m_statistics = statistics;
+    setMeanVector(statistics.mean);
+}
+
 }
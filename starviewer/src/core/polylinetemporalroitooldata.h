@@ -16,6 +16,7 @@
 #define UDGPOLYLINETEMPORALROITOOLDATA_H
 
 #include "tooldata.h"
+#include "temporalroiengine.h"
 
 #include <itkImage.h>
 
@@ -55,6 +56,13 @@ public:
         return m_mean;
     }
 
+    /// Assigna les estadístiques temporals de la ROI, la mitjana inclosa
+    void setStatistics(const TemporalROIEngine::Statistics &statistics);
+    TemporalROIEngine::Statistics getStatistics() const
+    {
+        return m_statistics;
+    }
+
 signals:
     /// S'emet quan s'assigna un nou vector de dades
     void dataChanged();
@@ -63,6 +71,9 @@ private:
     /// Vector on hi desarem la mitjana temporal
     QVector<double> m_mean;
 
+    /// Estadístiques temporals de la ROI: mitjana, desviació estàndard, mínim, màxim i temps fins al pic per a cada fase
+    TemporalROIEngine::Statistics m_statistics;
+
     /// Imatge amb les dades temporals
     TemporalImageType::Pointer m_temporalImage;
     bool m_temporalImageHasBeenDefined;
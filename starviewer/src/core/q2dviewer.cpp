@@ -27,6 +27,8 @@
 #include "qviewerworkinprogresswidget.h"
 #include "patientorientation.h"
 #include "imageoverlay.h"
+#include "imageoverlaycache.h"
+#include "fusionlayercache.h"
 #include "drawerbitmap.h"
 #include "filteroutput.h"
 #include "blendfilter.h"
@@ -36,6 +38,7 @@
 #include "renderqviewercommand.h"
 #include "mammographyimagehelper.h"
 #include "volumedisplayunit.h"
+#include "secondaryvolumedisplayunit.h"
 #include "slicelocator.h"
 #include "q2dviewerannotationhandler.h"
 #include "volumedisplayunithandlerfactory.h"
@@ -89,6 +92,16 @@ Q2DViewer::Q2DViewer(QWidget *parent)
     // Inicialitzem el filtre de shutter
     m_showDisplayShutters = true;
     m_overlaysAreEnabled = true;
+
+    // Els overlays es creen a mesura que les llesques es fan visibles
+    m_overlaysCache = new ImageOverlayCache();
+    m_overlaysVolume = 0;
+    connect(this, SIGNAL(sliceChanged(int)), SLOT(loadOverlaysForCurrentSlice()));
+    connect(this, SIGNAL(viewChanged(int)), SLOT(loadOverlaysForCurrentSlice()));
+
+    // The secondary volume of a fusion is resampled in the background and displayed when it's ready
+    m_fusionLayerCache = new FusionLayerCache(this);
+    connect(m_fusionLayerCache, SIGNAL(layerReady()), SLOT(updateFusionLayer()));
 }
 
 Q2DViewer::~Q2DViewer()
@@ -107,6 +120,7 @@ Q2DViewer::~Q2DViewer()
     // HACK Imposem que s'esborri primer el drawer
     delete m_drawer;
     delete m_imageOrientationOperationsMapper;
+    delete m_overlaysCache;
 
     deleteInputFinishedCommand();
 }
@@ -596,6 +610,15 @@ void Q2DViewer::setNewVolumes(const QList<Volume*> &volumes, bool setViewerStatu
 
     addImageActors();
 
+    if (getNumberOfInputs() == 2)
+    {
+        m_fusionLayerCache->setVolumes(getDisplayUnit(0)->getVolume(), getDisplayUnit(1)->getVolume());
+    }
+    else
+    {
+        m_fusionLayerCache->setVolumes(0, 0);
+    }
+
     setCurrentViewPlane(OrthogonalPlane::XYPlane);
     m_alignPosition = Q2DViewer::AlignCenter;
 
@@ -625,6 +648,11 @@ void Q2DViewer::setNewVolumes(const QList<Volume*> &volumes, bool setViewerStatu
 
 void Q2DViewer::removeViewerBitmaps()
 {
+    // Aturem la precàrrega i buidem la cache dels overlays del volum anterior
+    m_overlaysCache->clear();
+    m_overlaysVolume = 0;
+    m_slicesWithLoadedOverlays.clear();
+
     // Eliminem els bitmaps que teníem fins ara
     foreach (DrawerBitmap *bitmap, m_viewerBitmaps)
     {
@@ -646,53 +674,102 @@ void Q2DViewer::loadOverlays(Volume *volume)
         return;
     }
 
-    double volumeSpacing[3];
-    volume->getSpacing(volumeSpacing);
-    double volumeOrigin[3];
-    volume->getOrigin(volumeOrigin);
-    
+    // If it's the same volume, the slices already loaded are kept
+    m_overlaysVolume = volume;
+
+    // Only the overlays of the visible slice are created now, the rest are created when their slice becomes visible
+    loadOverlaysForCurrentSlice();
+
+    // The remaining overlays are decoded in background, starting from the slices closest to the current one
+    QStringList pathsToPrefetch;
     int numberOfSlices = volume->getNumberOfSlicesPerPhase();
     int numberOfPhases = volume->getNumberOfPhases();
-    for (int sliceIndex = 0; sliceIndex < numberOfSlices; ++sliceIndex)
+    int currentSlice = qBound(0, getCurrentSlice(), numberOfSlices - 1);
+    for (int distance = 1; distance < numberOfSlices; ++distance)
     {
-        for (int phaseIndex = 0; phaseIndex < numberOfPhases; ++ phaseIndex)
+        int slices[2] = { currentSlice + distance, currentSlice - distance };
+        for (int i = 0; i < 2; ++i)
         {
-            Image *image = volume->getImage(sliceIndex, phaseIndex);
-            if (!image)
+            int sliceIndex = slices[i];
+            if (sliceIndex < 0 || sliceIndex >= numberOfSlices || m_slicesWithLoadedOverlays.contains(sliceIndex))
             {
-                ERROR_LOG(QString("Error inesperat intentant accedir a la imatge amb índexs: %1(slice), %2(phase) del volum actual")
-                    .arg(sliceIndex).arg(phaseIndex));
-                DEBUG_LOG(QString("Error inesperat intentant accedir a la imatge amb índexs: %1(slice), %2(phase) del volum actual")
-                    .arg(sliceIndex).arg(phaseIndex));
+                continue;
             }
-            else
+
+            for (int phaseIndex = 0; phaseIndex < numberOfPhases; ++phaseIndex)
             {
-                if (image->hasOverlays())
+                Image *image = volume->getImage(sliceIndex, phaseIndex);
+                if (image && image->hasOverlays() && !pathsToPrefetch.contains(image->getPath()))
                 {
-                    // Calculem l'origen del bitmap corresponent a aquesta imatge
-                    double imageOrigin[3];
-                    imageOrigin[0] = volumeOrigin[0];
-                    imageOrigin[1] = volumeOrigin[1];
-                    imageOrigin[2] = volumeOrigin[2] + sliceIndex * volumeSpacing[2];
-                    // Creem els bitmaps
-                    foreach(const ImageOverlay &overlay, image->getOverlaysSplit())
-                    {
-                        DrawerBitmap *overlayBitmap = overlay.getAsDrawerBitmap(imageOrigin, volumeSpacing);
-                        // Inicialment no serà, segons la llesca en que ens trobem el Drawer decidirà sobre la seva visibilitat
-                        overlayBitmap->setVisibility(false);
-                        // La primitiva no es podrà esborrar amb les tools
-                        overlayBitmap->setErasable(false);
-                        overlayBitmap->increaseReferenceCount();
-                        getDrawer()->draw(overlayBitmap, OrthogonalPlane::XYPlane, sliceIndex);
-                        getDrawer()->addToGroup(overlayBitmap, OverlaysDrawerGroup);
-                        m_viewerBitmaps << overlayBitmap;
-                    }
+                    pathsToPrefetch << image->getPath();
                 }
             }
         }
     }
 
-    if (!m_overlaysAreEnabled)
+    m_overlaysCache->prefetch(pathsToPrefetch);
+}
+
+void Q2DViewer::loadOverlaysForCurrentSlice()
+{
+    if (!m_overlaysVolume || getView() != OrthogonalPlane::XYPlane)
+    {
+        return;
+    }
+
+    int sliceIndex = getCurrentSlice();
+    if (m_slicesWithLoadedOverlays.contains(sliceIndex) || sliceIndex < 0 || sliceIndex >= m_overlaysVolume->getNumberOfSlicesPerPhase())
+    {
+        return;
+    }
+
+    m_slicesWithLoadedOverlays.insert(sliceIndex);
+
+    double volumeSpacing[3];
+    m_overlaysVolume->getSpacing(volumeSpacing);
+    double volumeOrigin[3];
+    m_overlaysVolume->getOrigin(volumeOrigin);
+
+    bool bitmapsAdded = false;
+    int numberOfPhases = m_overlaysVolume->getNumberOfPhases();
+    for (int phaseIndex = 0; phaseIndex < numberOfPhases; ++phaseIndex)
+    {
+        Image *image = m_overlaysVolume->getImage(sliceIndex, phaseIndex);
+        if (!image)
+        {
+            ERROR_LOG(QString("Error inesperat intentant accedir a la imatge amb índexs: %1(slice), %2(phase) del volum actual")
+                .arg(sliceIndex).arg(phaseIndex));
+            DEBUG_LOG(QString("Error inesperat intentant accedir a la imatge amb índexs: %1(slice), %2(phase) del volum actual")
+                .arg(sliceIndex).arg(phaseIndex));
+        }
+        else
+        {
+            if (image->hasOverlays())
+            {
+                // Calculem l'origen del bitmap corresponent a aquesta imatge
+                double imageOrigin[3];
+                imageOrigin[0] = volumeOrigin[0];
+                imageOrigin[1] = volumeOrigin[1];
+                imageOrigin[2] = volumeOrigin[2] + sliceIndex * volumeSpacing[2];
+                // Creem els bitmaps
+                foreach (const ImageOverlay &overlay, m_overlaysCache->getOverlays(image))
+                {
+                    DrawerBitmap *overlayBitmap = overlay.getAsDrawerBitmap(imageOrigin, volumeSpacing);
+                    // El Drawer decidirà sobre la seva visibilitat segons la llesca en que ens trobem
+                    overlayBitmap->setVisibility(false);
+                    // La primitiva no es podrà esborrar amb les tools
+                    overlayBitmap->setErasable(false);
+                    overlayBitmap->increaseReferenceCount();
+                    getDrawer()->draw(overlayBitmap, OrthogonalPlane::XYPlane, sliceIndex);
+                    getDrawer()->addToGroup(overlayBitmap, OverlaysDrawerGroup);
+                    m_viewerBitmaps << overlayBitmap;
+                    bitmapsAdded = true;
+                }
+            }
+        }
+    }
+
+    if (bitmapsAdded && !m_overlaysAreEnabled)
     {
         showImageOverlays(m_overlaysAreEnabled);
     }
@@ -1042,6 +1119,23 @@ void Q2DViewer::updateSecondaryVolumesSlices()
 
     for (int i = 1; i < getNumberOfInputs(); i++)
     {
+        SecondaryVolumeDisplayUnit *secondaryDisplayUnit = dynamic_cast<SecondaryVolumeDisplayUnit*>(getDisplayUnit(i));
+        if (secondaryDisplayUnit)
+        {
+            if (i == 1 && canUseFusionLayer())
+            {
+                // The fusion layer has a slice at the position of each slice of the main volume, so there's no need to look for the nearest one
+                int nearestSlice = m_fusionLayerCache->getNearestSlice(getCurrentSlice());
+                secondaryDisplayUnit->setFusionLayer(m_fusionLayerCache->getLayer());
+                secondaryDisplayUnit->setFusionLayerSlice(getCurrentSlice());
+                secondaryDisplayUnit->getImageSlice()->SetVisibility(nearestSlice >= 0);
+                secondaryDisplayUnit->setSlice(qMax(0, nearestSlice));
+                continue;
+            }
+
+            secondaryDisplayUnit->setFusionLayer(0);
+        }
+
         sliceLocator.setVolume(getDisplayUnit(i)->getVolume());
         int nearestSlice = sliceLocator.getNearestSlice(getCurrentImagePlane());
 
@@ -1058,6 +1152,24 @@ void Q2DViewer::updateSecondaryVolumesSlices()
     }
 }
 
+bool Q2DViewer::canUseFusionLayer() const
+{
+    return m_fusionLayerCache->isReady() && getCurrentViewPlane() == OrthogonalPlane::XYPlane && getMainDisplayUnit()->getSlabThickness() == 1
+        && getDisplayUnit(1)->getSlabThickness() == 1;
+}
+
+void Q2DViewer::updateFusionLayer()
+{
+    if (!hasInput())
+    {
+        return;
+    }
+
+    updateSecondaryVolumesSlices();
+    updateImageSlices();
+    render();
+}
+
 void Q2DViewer::setOverlapMethod(OverlapMethod method)
 {
     m_overlapMethod = method;
@@ -1543,6 +1655,7 @@ void Q2DViewer::setSlabThickness(int thickness)
         getDrawer()->removeAllPrimitives();
 
         mainDisplayUnit->setSlabThickness(thickness);
+        updateSecondaryVolumesSlices();
         updateImageSlices();
 
         updateCurrentImageDefaultPresetsInAllInputsOnOriginalAcquisitionPlane();
@@ -1572,6 +1685,8 @@ void Q2DViewer::setSlabThicknessInVolume(int index, int thickness)
     }
 
     unit->setSlabThickness(thickness);
+    // The fusion layer can't be used with a thick slab
+    this->updateSecondaryVolumesSlices();
     this->updateImageSlices();
     this->render();
 }
@@ -1581,6 +1696,16 @@ int Q2DViewer::getSlabThickness() const
     return getMainDisplayUnit()->getSlabThickness();
 }
 
+void Q2DViewer::prefetchFrames(const QList<int> &imageIndices)
+{
+    getMainDisplayUnit()->prefetchFrames(imageIndices);
+}
+
+void Q2DViewer::clearPrefetchedFrames()
+{
+    getMainDisplayUnit()->clearPrefetchedFrames();
+}
+
 void Q2DViewer::disableThickSlab()
 {
     setSlabThickness(1);
@@ -20,6 +20,7 @@
 #include "anatomicalplane.h"
 
 #include <QPointer>
+#include <QSet>
 
 // Fordward declarations
 // Vtk
@@ -32,6 +33,8 @@ namespace udg {
 // Fordward declarations
 class Image;
 class ImageOverlay;
+class ImageOverlayCache;
+class FusionLayerCache;
 class Drawer;
 class DrawerBitmap;
 class ImagePlane;
@@ -284,6 +287,12 @@ public:
     /// Moves the camera based on the absolute motion vector
     void absolutePan(double motionVector[3]);
 
+    /// Starts computing in the background the frames of the main volume for the given images (as given by Volume::getImageIndex()), in the order in
+    /// which they will be displayed. Used by CINE playback, see VolumeDisplayUnit::prefetchFrames().
+    void prefetchFrames(const QList<int> &imageIndices);
+    /// Discards the prefetched frames of the main volume.
+    void clearPrefetchedFrames();
+
 public slots:
     virtual void setInput(Volume *volume);
 
@@ -496,7 +505,8 @@ private:
     /// Elimina els bitmaps que s'hagin creat per aquest viewer
     void removeViewerBitmaps();
     
-    /// Carrega en memòria els ImageOverlays del volum passat per paràmetre (sempre que no sigui un dummy) i els afegeix al Drawer
+    /// Prepara la càrrega dels ImageOverlays del volum passat per paràmetre (sempre que no sigui un dummy). Només es creen els de la llesca actual,
+    /// la resta es descodifiquen en segon pla i s'afegeixen al Drawer quan la seva llesca es fa visible.
     void loadOverlays(Volume *volume);
 
     /// Enum to define the different dimensions an image slice could be associated to
@@ -505,8 +515,13 @@ private:
     void updateSliceToDisplay(int value, SliceDimension dimension);
 
     /// Updates the slice to display in the secondary volumes to the closest one in the main volume.
+    /// If the fusion layer can be used, the secondary volume displays its slice at the position of the main one.
     void updateSecondaryVolumesSlices();
 
+    /// Returns true if the secondary volume can be displayed through the fusion layer: it has to be ready, the view plane has to be the acquisition
+    /// plane and there can't be thick slabs.
+    bool canUseFusionLayer() const;
+
     /// Returns the VolumeDisplayUnit of the given index. Returns null if there's no display unit or index is out of range
     VolumeDisplayUnit* getDisplayUnit(int index) const;
     VolumeDisplayUnit* getMainDisplayUnit() const;
@@ -530,6 +545,12 @@ private slots:
 
     void volumeReaderJobFinished();
 
+    /// Afegeix al Drawer els ImageOverlays de la llesca actual si encara no s'han afegit
+    void loadOverlaysForCurrentSlice();
+
+    /// Displays the fusion layer once it has been resampled
+    void updateFusionLayer();
+
 protected:
     /// Aquest és el segon volum afegit a solapar
     Volume *m_overlayVolume;
@@ -579,6 +600,16 @@ private:
     /// Llistat d'overlays
     QList<DrawerBitmap*> m_viewerBitmaps;
 
+    /// Cache dels overlays descodificats del volum actual
+    ImageOverlayCache *m_overlaysCache;
+
+    /// Volum del qual es carreguen els overlays i llesques de les quals ja s'han creat els bitmaps
+    Volume *m_overlaysVolume;
+    QSet<int> m_slicesWithLoadedOverlays;
+
+    /// Secondary volume of a fusion resampled onto the slices of the main volume
+    FusionLayerCache *m_fusionLayerCache;
+
     /// Controla si els overlays estan habilitats o no
     bool m_overlaysAreEnabled;
     
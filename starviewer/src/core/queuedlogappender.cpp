@@ -0,0 +1,243 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "queuedlogappender.h"
+
+#include <log4cxx/level.h>
+#include <log4cxx/logger.h>
+#include <log4cxx/logmanager.h>
+#include <log4cxx/helpers/pool.h>
+
+#include <QMutexLocker>
+
+using namespace log4cxx;
+
+namespace udg {
+
+IMPLEMENT_LOG4CXX_OBJECT(QueuedLogAppender)
+
+const int QueuedLogAppender::DefaultCapacity = 4096;
+
+QQueue<QueuedLogAppender::QueuedEvent> QueuedLogAppender::s_queue;
+int QueuedLogAppender::s_capacity = QueuedLogAppender::DefaultCapacity;
+QMutex QueuedLogAppender::s_queueMutex;
+QWaitCondition QueuedLogAppender::s_eventsAvailable;
+bool QueuedLogAppender::s_stopping = false;
+QMutex QueuedLogAppender::s_writeMutex;
+QueuedLogAppender::WriterThread* QueuedLogAppender::s_writerThread = 0;
+QAtomicInt QueuedLogAppender::s_numberOfDroppedRecords(0);
+std::vector<AppenderPtr> QueuedLogAppender::s_installedAppenders;
+
+QueuedLogAppender::QueuedLogAppender()
+{
+}
+
+QueuedLogAppender::~QueuedLogAppender()
+{
+    // Queued events keep a reference to their appender, so none of them is pending at this point
+    if (!closed)
+    {
+        closeAppenders();
+    }
+}
+
+void QueuedLogAppender::addAppender(const AppenderPtr &appender)
+{
+    m_appenders.push_back(appender);
+}
+
+void QueuedLogAppender::close()
+{
+    if (closed)
+    {
+        return;
+    }
+    closed = true;
+
+    flush();
+    closeAppenders();
+}
+
+bool QueuedLogAppender::requiresLayout() const
+{
+    return false;
+}
+
+void QueuedLogAppender::install(int capacity)
+{
+    LoggerList loggers = LogManager::getCurrentLoggers();
+    loggers.push_back(Logger::getRootLogger());
+
+    for (LoggerList::iterator it = loggers.begin(); it != loggers.end(); ++it)
+    {
+        LoggerPtr logger = *it;
+        AppenderList appenders = logger->getAllAppenders();
+        if (appenders.empty())
+        {
+            continue;
+        }
+
+        QueuedLogAppender *queuedAppender = new QueuedLogAppender();
+        AppenderPtr queuedAppenderPointer(queuedAppender);
+        for (AppenderList::iterator appender = appenders.begin(); appender != appenders.end(); ++appender)
+        {
+            queuedAppender->addAppender(*appender);
+        }
+
+        logger->removeAllAppenders();
+        logger->addAppender(queuedAppenderPointer);
+        s_installedAppenders.push_back(queuedAppenderPointer);
+    }
+
+    {
+        QMutexLocker locker(&s_queueMutex);
+        s_capacity = qMax(1, capacity);
+        s_stopping = false;
+    }
+
+    if (!s_writerThread)
+    {
+        s_writerThread = new WriterThread();
+        s_writerThread->start(QThread::LowPriority);
+    }
+}
+
+void QueuedLogAppender::shutdown()
+{
+    if (s_writerThread)
+    {
+        {
+            QMutexLocker locker(&s_queueMutex);
+            s_stopping = true;
+            s_eventsAvailable.wakeAll();
+        }
+
+        // The writer thread empties the queue before finishing
+        s_writerThread->wait();
+        delete s_writerThread;
+        s_writerThread = 0;
+    }
+
+    for (std::vector<AppenderPtr>::iterator it = s_installedAppenders.begin(); it != s_installedAppenders.end(); ++it)
+    {
+        (*it)->close();
+    }
+    s_installedAppenders.clear();
+}
+
+void QueuedLogAppender::flush()
+{
+    QMutexLocker writeLocker(&s_writeMutex);
+    writeQueuedEvents();
+}
+
+int QueuedLogAppender::getNumberOfQueuedRecords()
+{
+    QMutexLocker locker(&s_queueMutex);
+    return s_queue.size();
+}
+
+int QueuedLogAppender::getNumberOfDroppedRecords()
+{
+    return s_numberOfDroppedRecords.loadAcquire();
+}
+
+void QueuedLogAppender::append(const spi::LoggingEventPtr &event, helpers::Pool &pool)
+{
+    if (event->getLevel()->isGreaterOrEqual(Level::getWarn()))
+    {
+        // Written before returning, after the events logged before it, so that it isn't lost if the application crashes
+        QMutexLocker writeLocker(&s_writeMutex);
+        writeQueuedEvents();
+        write(event, pool);
+        return;
+    }
+
+    QMutexLocker locker(&s_queueMutex);
+
+    if (s_queue.size() >= s_capacity)
+    {
+        s_numberOfDroppedRecords.fetchAndAddOrdered(1);
+        return;
+    }
+
+    QueuedEvent queuedEvent;
+    queuedEvent.appender = this;
+    queuedEvent.event = event;
+    s_queue.enqueue(queuedEvent);
+    s_eventsAvailable.wakeOne();
+}
+
+void QueuedLogAppender::write(const spi::LoggingEventPtr &event, helpers::Pool &pool)
+{
+    for (std::vector<AppenderPtr>::iterator it = m_appenders.begin(); it != m_appenders.end(); ++it)
+    {
+        (*it)->doAppend(event, pool);
+    }
+}
+
+void QueuedLogAppender::closeAppenders()
+{
+    for (std::vector<AppenderPtr>::iterator it = m_appenders.begin(); it != m_appenders.end(); ++it)
+    {
+        (*it)->close();
+    }
+}
+
+void QueuedLogAppender::writeQueuedEvents()
+{
+    // Events are taken in batches so that the queue isn't locked while writing
+    QQueue<QueuedEvent> events;
+    {
+        QMutexLocker locker(&s_queueMutex);
+        events.swap(s_queue);
+    }
+
+    helpers::Pool pool;
+    while (!events.isEmpty())
+    {
+        QueuedEvent queuedEvent = events.dequeue();
+        queuedEvent.appender->write(queuedEvent.event, pool);
+    }
+}
+
+void QueuedLogAppender::runWriterThread()
+{
+    forever
+    {
+        {
+            QMutexLocker locker(&s_queueMutex);
+            while (s_queue.isEmpty() && !s_stopping)
+            {
+                s_eventsAvailable.wait(&s_queueMutex);
+            }
+
+            if (s_queue.isEmpty())
+            {
+                // Stopping and nothing left to write
+                return;
+            }
+        }
+
+        QMutexLocker writeLocker(&s_writeMutex);
+        writeQueuedEvents();
+    }
+}
+
+void QueuedLogAppender::WriterThread::run()
+{
+    QueuedLogAppender::runWriterThread();
+}
+
+}
@@ -0,0 +1,136 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGQUEUEDLOGAPPENDER_H
+#define UDGQUEUEDLOGAPPENDER_H
+
+#include <log4cxx/appenderskeleton.h>
+#include <log4cxx/spi/loggingevent.h>
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <vector>
+
+namespace udg {
+
+/**
+    log4cxx appender that hands the logging events to a bounded queue and writes them to the wrapped appenders from a background thread.
+
+    All the installed appenders share a single queue and a single writer thread, so events are written in the order they were logged even when several
+    loggers write to the same file. The calling thread only pays the level check and the creation of the event for DEBUG and INFO events; the layout
+    formatting and the file I/O of the wrapped appenders are done by the writer thread. When the queue is full, these events are dropped and counted.
+
+    WARN, ERROR and FATAL events are not queued: the calling thread writes the pending events and then the event itself before returning, so they are
+    on disk even if the application crashes right after.
+
+    install() wraps the appenders of all the configured loggers once log4cxx has been configured and starts the writer thread, and shutdown() writes
+    the pending events, stops the writer thread and closes the installed appenders. Both must be called from the main thread.
+ */
+class QueuedLogAppender : public log4cxx::AppenderSkeleton {
+public:
+    DECLARE_LOG4CXX_OBJECT(QueuedLogAppender)
+    BEGIN_LOG4CXX_CAST_MAP()
+        LOG4CXX_CAST_ENTRY(QueuedLogAppender)
+        LOG4CXX_CAST_ENTRY_CHAIN(log4cxx::AppenderSkeleton)
+    END_LOG4CXX_CAST_MAP()
+
+    QueuedLogAppender();
+    virtual ~QueuedLogAppender();
+
+    /// Adds an appender to which the queued events will be written. It must be called before any event is appended.
+    void addAppender(const log4cxx::AppenderPtr &appender);
+
+    /// Writes the pending events and closes the wrapped appenders.
+    virtual void close();
+
+    /// This appender doesn't format events, the wrapped ones do.
+    virtual bool requiresLayout() const;
+
+    /// Replaces the appenders of every logger of the current configuration, including the root logger, by a QueuedLogAppender that wraps them, and
+    /// starts the writer thread with a queue of the given capacity.
+    static void install(int capacity = DefaultCapacity);
+    /// Writes the pending events, stops the writer thread and closes all the installed QueuedLogAppenders.
+    static void shutdown();
+    /// Writes the pending events of all the appenders from the calling thread.
+    static void flush();
+
+    /// Returns the number of events that are waiting to be written.
+    static int getNumberOfQueuedRecords();
+    /// Returns the number of events that have been dropped because the queue was full since the application started.
+    static int getNumberOfDroppedRecords();
+
+protected:
+    /// Queues DEBUG and INFO events to be written by the writer thread, and writes the pending events and the given one for higher levels.
+    virtual void append(const log4cxx::spi::LoggingEventPtr &event, log4cxx::helpers::Pool &pool);
+
+private:
+    /// Thread that writes the queued events.
+    class WriterThread : public QThread {
+    protected:
+        virtual void run();
+    };
+
+    /// Queued event together with the appender that received it.
+    struct QueuedEvent {
+        log4cxx::helpers::ObjectPtrT<QueuedLogAppender> appender;
+        log4cxx::spi::LoggingEventPtr event;
+    };
+
+    /// Writes the event to the wrapped appenders.
+    void write(const log4cxx::spi::LoggingEventPtr &event, log4cxx::helpers::Pool &pool);
+
+    /// Closes the wrapped appenders.
+    void closeAppenders();
+
+    /// Takes all the queued events and writes them. s_writeMutex must be locked by the caller.
+    static void writeQueuedEvents();
+
+    /// Loop run by the writer thread until it is stopped and the queue is empty.
+    static void runWriterThread();
+
+private:
+    /// Default maximum number of queued events.
+    static const int DefaultCapacity;
+
+    /// Appenders to which the events are written.
+    std::vector<log4cxx::AppenderPtr> m_appenders;
+
+    /// Events waiting to be written, in the order they were logged, and maximum number of them.
+    static QQueue<QueuedEvent> s_queue;
+    static int s_capacity;
+
+    /// Protects the queue and the stopping state.
+    static QMutex s_queueMutex;
+    static QWaitCondition s_eventsAvailable;
+    static bool s_stopping;
+
+    /// Held while writing events so that the writer thread and the threads that log warnings or errors don't write at the same time or out of order.
+    /// When both are needed, it is locked before s_queueMutex.
+    static QMutex s_writeMutex;
+
+    static WriterThread *s_writerThread;
+
+    static QAtomicInt s_numberOfDroppedRecords;
+
+    /// Installed appenders, kept alive until shutdown().
+    static std::vector<log4cxx::AppenderPtr> s_installedAppenders;
+};
+
+}
+
+#endif // UDGQUEUEDLOGAPPENDER_H
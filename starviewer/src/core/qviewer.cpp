@@ -795,6 +795,11 @@ void QViewer::enableRendering(bool enable)
     m_isRenderingEnabled = enable;
 }
 
+bool QViewer::isRenderingEnabled() const
+{
+    return m_isRenderingEnabled;
+}
+
 PatientBrowserMenu* QViewer::getPatientBrowserMenu() const
 {
     return m_patientBrowserMenu;
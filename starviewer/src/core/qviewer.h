@@ -147,6 +147,9 @@ public:
     /// visualització però no volem que aquestes es facin efectives fins que no ho indiquem
     void enableRendering(bool enable);
 
+    /// Retorna cert si els renderings es fan efectius
+    bool isRenderingEnabled() const;
+
     /// Ens retorna el menú de pacient amb el que s'escull l'input
     PatientBrowserMenu* getPatientBrowserMenu() const;
 
@@ -29,6 +29,13 @@
 
 namespace udg {
 
+namespace {
+
+/// Number of frames that are prefetched ahead of the current one during playback
+const int NumberOfPrefetchedFrames = 8;
+
+}
+
 QViewerCINEController::QViewerCINEController(QObject *parent)
 : QObject(parent), m_firstSliceInterval(0), m_lastSliceInterval(0), m_nextStep(1), m_velocity(1), m_2DViewer(0), m_playing(false),
   m_cineDimension(TemporalDimension), m_loopEnabled(false), m_boomerangEnabled(false)
@@ -62,6 +69,7 @@ void QViewerCINEController::setInputViewer(QViewer *viewer)
     if (m_2DViewer)
     {
         disconnect(m_2DViewer, 0, this, 0);
+        m_2DViewer->clearPrefetchedFrames();
     }
 
     m_2DViewer = Q2DViewer::castFromQViewer(viewer);
@@ -104,6 +112,11 @@ QAction *QViewerCINEController::getBoomerangAction() const
     return m_boomerangAction;
 }
 
+const CineFramePacer& QViewerCINEController::getFramePacer() const
+{
+    return m_framePacer;
+}
+
 void QViewerCINEController::play()
 {
     if (!m_playing)
@@ -112,7 +125,10 @@ void QViewerCINEController::play()
         m_playAction->setIcon(QIcon(":/images/pause.png"));
         m_playAction->setText(tr("Pause"));
         emit playing();
-        m_timer->start(1000 / m_velocity, this);
+        m_clock.start();
+        m_framePacer.start(m_velocity, m_clock.elapsed());
+        prefetchNextFrames();
+        scheduleNextFrame();
     }
     else
     {
@@ -123,6 +139,18 @@ void QViewerCINEController::play()
 void QViewerCINEController::pause()
 {
     m_timer->stop();
+    if (m_playing)
+    {
+        DEBUG_LOG(QString("CINE playback statistics: %1 frames presented, %2 dropped, mean latency %3 ms, maximum latency %4 ms")
+            .arg(m_framePacer.getNumberOfPresentedFrames()).arg(m_framePacer.getNumberOfDroppedFrames())
+            .arg(m_framePacer.getMeanLatency(), 0, 'f', 1).arg(m_framePacer.getMaximumLatency()));
+
+        // Once paused the image pipeline is displayed again, so that everything works as usual on the current image
+        if (m_2DViewer)
+        {
+            m_2DViewer->clearPrefetchedFrames();
+        }
+    }
     m_playing = false;
     m_playAction->setIcon(QIcon(":/images/play.png"));
     m_playAction->setText(tr("Play"));
@@ -135,7 +163,8 @@ void QViewerCINEController::setVelocity(int imagesPerSecond)
     emit velocityChanged(m_velocity);
     if (m_playing)
     {
-        m_timer->start(1000 / m_velocity, this);
+        m_framePacer.setFramesPerSecond(m_velocity, m_clock.elapsed());
+        scheduleNextFrame();
     }
 }
 
@@ -174,17 +203,88 @@ void QViewerCINEController::handleCINETimerEvent()
         return;
     }
 
-    int currentImageIndex;
-    int nextImageIndex;
+    // When rendering can't keep up, the pacer makes us skip the frames that are already late instead of slowing down the playback
+    int framesToAdvance = m_framePacer.advance(m_clock.elapsed());
 
-    if (m_cineDimension == TemporalDimension)
+    if (framesToAdvance > 0)
     {
-        currentImageIndex = m_2DViewer->getCurrentPhase();
+        int currentImageIndex;
+
+        if (m_cineDimension == TemporalDimension)
+        {
+            currentImageIndex = m_2DViewer->getCurrentPhase();
+        }
+        else
+        {
+            currentImageIndex = m_2DViewer->getCurrentSlice();
+        }
+
+        int nextImageIndex = currentImageIndex;
+        bool endReached = false;
+        for (int i = 0; i < framesToAdvance && !endReached; i++)
+        {
+            nextImageIndex = computeNextImageIndex(nextImageIndex, m_nextStep, endReached);
+        }
+
+        if (endReached)
+        {
+            pause();
+        }
+
+        if (m_cineDimension == TemporalDimension)
+        {
+            m_2DViewer->setPhase(nextImageIndex);
+        }
+        else
+        {
+            m_2DViewer->setSlice(nextImageIndex);
+        }
     }
-    else
+
+    if (m_playing)
     {
-        currentImageIndex = m_2DViewer->getCurrentSlice();
+        prefetchNextFrames();
+        scheduleNextFrame();
     }
+}
+
+void QViewerCINEController::prefetchNextFrames()
+{
+    Volume *volume = m_2DViewer->getMainInput();
+    if (!volume)
+    {
+        return;
+    }
+
+    int imageIndex = m_cineDimension == TemporalDimension ? m_2DViewer->getCurrentPhase() : m_2DViewer->getCurrentSlice();
+    int step = m_nextStep;
+    bool endReached = false;
+    QList<int> volumeImageIndices;
+
+    while (volumeImageIndices.size() < NumberOfPrefetchedFrames)
+    {
+        imageIndex = computeNextImageIndex(imageIndex, step, endReached);
+        if (endReached)
+        {
+            break;
+        }
+
+        if (m_cineDimension == TemporalDimension)
+        {
+            volumeImageIndices << volume->getImageIndex(m_2DViewer->getCurrentSlice(), imageIndex);
+        }
+        else
+        {
+            volumeImageIndices << volume->getImageIndex(imageIndex, m_2DViewer->getCurrentPhase());
+        }
+    }
+
+    m_2DViewer->prefetchFrames(volumeImageIndices);
+}
+
+int QViewerCINEController::computeNextImageIndex(int currentImageIndex, int &step, bool &endReached) const
+{
+    int nextImageIndex = currentImageIndex;
 
     // Si estem al final de l'interval
     if (currentImageIndex == m_lastSliceInterval)
@@ -193,8 +293,8 @@ void QViewerCINEController::handleCINETimerEvent()
         {
             if (m_boomerangEnabled)
             {
-                m_nextStep = -1;
-                nextImageIndex = currentImageIndex + m_nextStep;
+                step = -1;
+                nextImageIndex = currentImageIndex + step;
             }
             else
             {
@@ -204,13 +304,13 @@ void QViewerCINEController::handleCINETimerEvent()
         else if (m_boomerangEnabled)
         {
             // Pot ser que hagim desactivat el repeat, però no el boomerang!
-            m_nextStep = 1;
+            step = 1;
         }
         else
         {
             // Tornem a l'inici TODO potser no hauria de ser així... i deixar en la última imatge de la seqüència
             nextImageIndex = m_firstSliceInterval;
-            pause();
+            endReached = true;
         }
     }
     // Si estem a l'inici de l'interval
@@ -219,37 +319,36 @@ void QViewerCINEController::handleCINETimerEvent()
         // Si tenim algun tipus de repeat activat
         if (m_loopEnabled /*|| m_boomerangEnabled*/)
         {
-            m_nextStep = 1;
-            nextImageIndex = currentImageIndex + m_nextStep;
+            step = 1;
+            nextImageIndex = currentImageIndex + step;
         }
         else
         {
             // Fins ara reproduia endavant-endarrera
-            if (m_nextStep == -1)
+            if (step == -1)
             {
-                m_nextStep = 1;
-                pause();
+                step = 1;
+                endReached = true;
             }
             // Inici de la reproduccio
             else
             {
-                nextImageIndex = currentImageIndex + m_nextStep;
+                nextImageIndex = currentImageIndex + step;
             }
         }
     }
     else
     {
-        nextImageIndex = currentImageIndex + m_nextStep;
+        nextImageIndex = currentImageIndex + step;
     }
 
-    if (m_cineDimension == TemporalDimension)
-    {
-        m_2DViewer->setPhase(nextImageIndex);
-    }
-    else
-    {
-        m_2DViewer->setSlice(nextImageIndex);
-    }
+    return nextImageIndex;
+}
+
+void QViewerCINEController::scheduleNextFrame()
+{
+    // The timer is restarted for every frame so that it fires when the next frame is due, not a fixed period after the last one was presented
+    m_timer->start(qMax(1, m_framePacer.getTimeUntilNextFrame(m_clock.elapsed())), Qt::PreciseTimer, this);
 }
 
 void QViewerCINEController::resetCINEInformation(Volume *input)
@@ -15,6 +15,9 @@
 #ifndef UDGQVIEWERCINECONTROLLER_H
 #define UDGQVIEWERCINECONTROLLER_H
 
+#include "cineframepacer.h"
+
+#include <QElapsedTimer>
 #include <QObject>
 
 class QAction;
@@ -47,6 +50,9 @@ public:
     QAction* getLoopAction() const;
     QAction* getBoomerangAction() const;
 
+    /// Returns the frame pacer, which holds the presented and dropped frames and latency statistics of the current or last playback.
+    const CineFramePacer& getFramePacer() const;
+
 signals:
     void playing();
     void paused();
@@ -85,9 +91,19 @@ protected:
 
 private:
     /// Aquí ens ocupem de decidir cap on va el següent frame
-    /// durant la reproducció
+    /// durant la reproducció. Avança tants frames com indiqui el pacer.
     void handleCINETimerEvent();
 
+    /// Returns the index of the image that follows the given one according to the interval and the loop and boomerang modes, advancing in the
+    /// direction of the given step, which is updated when the direction changes. endReached is set to true when the playback must pause there.
+    int computeNextImageIndex(int currentImageIndex, int &step, bool &endReached) const;
+
+    /// Asks the viewer to prefetch the frames of the images that will be displayed next, so that they don't have to go through the image pipeline.
+    void prefetchNextFrames();
+
+    /// Schedules the timer for the next frame due according to the pacer.
+    void scheduleNextFrame();
+
 private:
     /// Variables de reproducció
     int m_firstSliceInterval;
@@ -101,6 +117,10 @@ private:
 
     QBasicTimer *m_timer;
 
+    /// Monotonic clock against which frames are paced
+    QElapsedTimer m_clock;
+    CineFramePacer m_framePacer;
+
     Q2DViewer *m_2DViewer;
 
     /// Indica si s'està reproduint o no
@@ -0,0 +1,313 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "referencelinesengine.h"
+
+#include <cmath>
+
+#include <vtkPlane.h>
+
+namespace udg {
+
+namespace {
+
+// Cosine of 45 degrees: the angle between the normals is between 45 and 135 degrees if the absolute value of its cosine is at most this value
+const double MaximumAbsoluteCosine = 0.70710678118654752440;
+
+void setPoint(double point[3], double x, double y, double z)
+{
+    point[0] = x;
+    point[1] = y;
+    point[2] = z;
+}
+
+}
+
+bool ReferenceLinesEngine::Line::operator==(const Line &line) const
+{
+    for (int i = 0; i < 3; i++)
+    {
+        if (firstPoint[i] != line.firstPoint[i] || secondPoint[i] != line.secondPoint[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ReferenceLinesEngine::Line::operator!=(const Line &line) const
+{
+    return !(*this == line);
+}
+
+ReferenceLinesEngine::ReferenceLinesEngine()
+ : m_hasLocalizer(false), m_localizerNormalLength(0.0), m_xIndex(0), m_yIndex(1), m_zIndex(2)
+{
+}
+
+ReferenceLinesEngine::~ReferenceLinesEngine()
+{
+}
+
+void ReferenceLinesEngine::setLocalizer(const ImagePlane &localizerPlane, const OrthogonalPlane &viewPlane, const double displayedImageOrigin[3])
+{
+    m_localizerPlane = localizerPlane;
+    m_localizerPlane.getOrigin(m_localizerOrigin);
+    m_localizerPlane.getNormalVector(m_localizerNormal);
+    m_localizerPlane.getRowDirectionVector(m_localizerRowVector);
+    m_localizerPlane.getColumnDirectionVector(m_localizerColumnVector);
+    m_localizerNormalLength = std::sqrt(m_localizerNormal[0] * m_localizerNormal[0] + m_localizerNormal[1] * m_localizerNormal[1] +
+                                        m_localizerNormal[2] * m_localizerNormal[2]);
+
+    viewPlane.getXYZIndexes(m_xIndex, m_yIndex, m_zIndex);
+    setPoint(m_displayedImageOrigin, displayedImageOrigin[0], displayedImageOrigin[1], displayedImageOrigin[2]);
+
+    m_hasLocalizer = true;
+
+    // The lines of the last projection are only valid for the previous localizer
+    m_lastReferencePlanes.clear();
+    m_lastBounds.clear();
+    m_lastResults.clear();
+    m_lastLines.clear();
+}
+
+void ReferenceLinesEngine::clearLocalizer()
+{
+    m_hasLocalizer = false;
+    m_lastReferencePlanes.clear();
+    m_lastBounds.clear();
+    m_lastResults.clear();
+    m_lastLines.clear();
+}
+
+bool ReferenceLinesEngine::hasLocalizer() const
+{
+    return m_hasLocalizer;
+}
+
+QVector<ReferenceLinesEngine::ProjectionResult> ReferenceLinesEngine::projectIntersections(const QList<ImagePlane*> &referencePlanes,
+                                                                                           const QList<int> &bounds, QVector<Line> &lines)
+{
+    QVector<ProjectionResult> results(referencePlanes.count(), NotProjected);
+
+    int numberOfLines = referencePlanes.count() * bounds.count();
+    int previousNumberOfLines = lines.count();
+    lines.resize(numberOfLines);
+    for (int i = previousNumberOfLines; i < numberOfLines; i++)
+    {
+        setPoint(lines[i].firstPoint, 0.0, 0.0, 0.0);
+        setPoint(lines[i].secondPoint, 0.0, 0.0, 0.0);
+    }
+
+    if (!m_hasLocalizer)
+    {
+        return results;
+    }
+
+    if (isLastProjection(referencePlanes, bounds))
+    {
+        for (int i = 0; i < m_lastResults.count(); i++)
+        {
+            if (m_lastResults.at(i) != NotProjected)
+            {
+                for (int j = i * bounds.count(); j < (i + 1) * bounds.count(); j++)
+                {
+                    lines[j] = m_lastLines.at(j);
+                }
+            }
+        }
+
+        return m_lastResults;
+    }
+
+    for (int i = 0; i < referencePlanes.count(); i++)
+    {
+        results[i] = projectIntersections(referencePlanes.at(i), bounds, lines.data() + i * bounds.count());
+    }
+
+    // Null planes can't be compared with the next ones, so projections with them aren't reused
+    m_lastReferencePlanes.clear();
+    if (!referencePlanes.contains(0))
+    {
+        foreach (ImagePlane *referencePlane, referencePlanes)
+        {
+            m_lastReferencePlanes << *referencePlane;
+        }
+    }
+    m_lastBounds = bounds;
+    m_lastResults = results;
+    m_lastLines = lines;
+
+    return results;
+}
+
+ReferenceLinesEngine::ProjectionResult ReferenceLinesEngine::projectIntersections(ImagePlane *referencePlane, const QList<int> &bounds, Line *lines)
+{
+    if (!referencePlane)
+    {
+        return NotProjected;
+    }
+
+    double normal[3];
+    referencePlane->getNormalVector(normal);
+    if (!meetAngleConstraint(normal) || m_localizerPlane == *referencePlane)
+    {
+        return NotProjected;
+    }
+
+    double origin[3];
+    double rowVector[3];
+    double columnVector[3];
+    referencePlane->getOrigin(origin);
+    referencePlane->getRowDirectionVector(rowVector);
+    referencePlane->getColumnDirectionVector(columnVector);
+    double rowLength = referencePlane->getRowLength();
+    double columnLength = referencePlane->getColumnLength();
+    double thickness = referencePlane->getThickness();
+
+    bool allBoundsIntersect = true;
+    for (int i = 0; i < bounds.count(); i++)
+    {
+        // Corners in the same order and computed the same way as in ImagePlane::getBounds()
+        double factor;
+        switch (bounds.at(i))
+        {
+            case LowerBounds:
+                factor = -thickness * 0.5;
+                break;
+
+            case CentralBounds:
+                factor = 0.0;
+                break;
+
+            default:
+                factor = thickness * 0.5;
+                break;
+        }
+
+        double corners[4][3];
+        for (int j = 0; j < 3; j++)
+        {
+            corners[0][j] = origin[j] + normal[j] * factor;
+            corners[1][j] = origin[j] + rowVector[j] * rowLength + normal[j] * factor;
+            corners[2][j] = origin[j] + rowVector[j] * rowLength + columnVector[j] * columnLength + normal[j] * factor;
+            corners[3][j] = origin[j] + columnVector[j] * columnLength + normal[j] * factor;
+        }
+
+        if (!intersect(corners, lines[i]))
+        {
+            setPoint(lines[i].firstPoint, 0.0, 0.0, 0.0);
+            setPoint(lines[i].secondPoint, 0.0, 0.0, 0.0);
+            allBoundsIntersect = false;
+        }
+    }
+
+    return allBoundsIntersect ? AllBoundsIntersect : NotAllBoundsIntersect;
+}
+
+bool ReferenceLinesEngine::meetAngleConstraint(const double normal[3]) const
+{
+    double normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    if (normalLength == 0.0 || m_localizerNormalLength == 0.0)
+    {
+        return false;
+    }
+
+    double cosine = (m_localizerNormal[0] * normal[0] + m_localizerNormal[1] * normal[1] + m_localizerNormal[2] * normal[2]) /
+                    (m_localizerNormalLength * normalLength);
+
+    return std::fabs(cosine) <= MaximumAbsoluteCosine;
+}
+
+bool ReferenceLinesEngine::intersect(const double corners[4][3], Line &line) const
+{
+    // vtkPlane doesn't take const arguments
+    double topLeft[3], topRight[3], bottomRight[3], bottomLeft[3], normal[3], origin[3];
+    for (int i = 0; i < 3; i++)
+    {
+        topLeft[i] = corners[0][i];
+        topRight[i] = corners[1][i];
+        bottomRight[i] = corners[2][i];
+        bottomLeft[i] = corners[3][i];
+        normal[i] = m_localizerNormal[i];
+        origin[i] = m_localizerOrigin[i];
+    }
+
+    double firstIntersectionPoint[3] = { 0.0, 0.0, 0.0 };
+    double secondIntersectionPoint[3] = { 0.0, 0.0, 0.0 };
+    double t;
+    int numberOfIntersections = 0;
+
+    // First pair of opposite edges, and the other one if the first doesn't intersect
+    numberOfIntersections += vtkPlane::IntersectWithLine(topLeft, topRight, normal, origin, t, firstIntersectionPoint);
+    numberOfIntersections += vtkPlane::IntersectWithLine(bottomRight, bottomLeft, normal, origin, t, secondIntersectionPoint);
+
+    if (numberOfIntersections == 0)
+    {
+        numberOfIntersections += vtkPlane::IntersectWithLine(topRight, bottomRight, normal, origin, t, firstIntersectionPoint);
+        numberOfIntersections += vtkPlane::IntersectWithLine(bottomLeft, topLeft, normal, origin, t, secondIntersectionPoint);
+    }
+
+    if (numberOfIntersections == 0)
+    {
+        return false;
+    }
+
+    project(firstIntersectionPoint, line.firstPoint);
+    project(secondIntersectionPoint, line.secondPoint);
+
+    return true;
+}
+
+void ReferenceLinesEngine::project(const double point[3], double projectedPoint[3]) const
+{
+    // Same as ImagePlane::projectPoint() followed by the displacement of Q2DViewer::projectDICOMPointToCurrentDisplayedImage()
+    double shiftedPoint[3];
+    for (int i = 0; i < 3; i++)
+    {
+        shiftedPoint[i] = point[i] - m_localizerOrigin[i];
+    }
+
+    double planeProjectedPoint[3];
+    planeProjectedPoint[0] = m_localizerRowVector[0] * shiftedPoint[0] + m_localizerRowVector[1] * shiftedPoint[1] +
+                             m_localizerRowVector[2] * shiftedPoint[2];
+    planeProjectedPoint[1] = m_localizerColumnVector[0] * shiftedPoint[0] + m_localizerColumnVector[1] * shiftedPoint[1] +
+                             m_localizerColumnVector[2] * shiftedPoint[2];
+    planeProjectedPoint[2] = m_localizerNormal[0] * shiftedPoint[0] + m_localizerNormal[1] * shiftedPoint[1] + m_localizerNormal[2] * shiftedPoint[2];
+
+    projectedPoint[m_xIndex] = planeProjectedPoint[0] + m_displayedImageOrigin[m_xIndex];
+    projectedPoint[m_yIndex] = planeProjectedPoint[1] + m_displayedImageOrigin[m_yIndex];
+    projectedPoint[m_zIndex] = planeProjectedPoint[2] + m_displayedImageOrigin[m_zIndex];
+}
+
+bool ReferenceLinesEngine::isLastProjection(const QList<ImagePlane*> &referencePlanes, const QList<int> &bounds)
+{
+    if (bounds != m_lastBounds || referencePlanes.count() != m_lastReferencePlanes.count() || referencePlanes.isEmpty())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < referencePlanes.count(); i++)
+    {
+        if (!referencePlanes.at(i) || m_lastReferencePlanes[i] != *referencePlanes.at(i))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,121 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGREFERENCELINESENGINE_H
+#define UDGREFERENCELINESENGINE_H
+
+#include "imageplane.h"
+#include "orthogonalplane.h"
+
+#include <QList>
+#include <QVector>
+
+namespace udg {
+
+/**
+    Computes the reference lines of a localizer: the intersections of the bounds of the reference planes with the plane of the localizer, projected
+    onto the image where the localizer is displayed. It gives the same lines as intersecting the planes with ImagePlane::getIntersections() and
+    projecting the points with Q2DViewer::projectDICOMPointToCurrentDisplayedImage().
+
+    The plane equation, direction vectors and projection of the localizer are computed once when it's set, so each reference plane only needs its
+    corners and two or four line-plane intersections. When the same reference planes are projected again on the same localizer, the previous lines
+    are returned without computing anything.
+ */
+class ReferenceLinesEngine {
+public:
+    /// Bounds of a reference plane that are intersected with the localizer, with the same values used in ImagePlane::getIntersections()
+    enum Bounds { UpperBounds = 0, LowerBounds = 1, CentralBounds = 2 };
+
+    /// Result of projecting a reference plane
+    enum ProjectionResult {
+        /// The reference plane is the localizer plane or the angle between their normals isn't between 45 and 135 degrees.
+        /// Its lines are left as they were
+        NotProjected,
+        /// Some of the bounds don't intersect the localizer. Their lines are collapsed to the origin
+        NotAllBoundsIntersect,
+        /// All the bounds intersect the localizer
+        AllBoundsIntersect
+    };
+
+    /// Line projected onto the displayed image
+    struct Line {
+        double firstPoint[3];
+        double secondPoint[3];
+
+        bool operator==(const Line &line) const;
+        bool operator!=(const Line &line) const;
+    };
+
+    ReferenceLinesEngine();
+    ~ReferenceLinesEngine();
+
+    /// Sets the plane of the localizer and how points are placed on the displayed image: each point is projected onto the localizer plane and the
+    /// projected coordinates are put along the axes of the given view plane, displaced by the given origin, as Q2DViewer does
+    void setLocalizer(const ImagePlane &localizerPlane, const OrthogonalPlane &viewPlane, const double displayedImageOrigin[3]);
+
+    /// Removes the localizer. Nothing is projected until a new one is set
+    void clearLocalizer();
+
+    /// Returns true if there is a localizer
+    bool hasLocalizer() const;
+
+    /// Projects the intersections of the given bounds of each reference plane with the localizer and returns the result of each plane.
+    /// lines is resized to the number of planes times the number of bounds, the line of bounds i of plane j being at j * bounds.count() + i.
+    /// The lines of planes that aren't projected keep the values they had. If there isn't a localizer, all the planes are not projected
+    QVector<ProjectionResult> projectIntersections(const QList<ImagePlane*> &referencePlanes, const QList<int> &bounds, QVector<Line> &lines);
+
+private:
+    /// Projects the intersections of a single reference plane, writing its lines from the given one
+    ProjectionResult projectIntersections(ImagePlane *referencePlane, const QList<int> &bounds, Line *lines);
+
+    /// Returns true if the angle between the normal of the localizer and the given one is between 45 and 135 degrees
+    bool meetAngleConstraint(const double normal[3]) const;
+
+    /// Intersects the edges of the given corners with the localizer plane as ImagePlane::getIntersections() does, and projects the intersections
+    /// into line. Returns false if there isn't any intersection
+    bool intersect(const double corners[4][3], Line &line) const;
+
+    /// Projects the given point onto the displayed image
+    void project(const double point[3], double projectedPoint[3]) const;
+
+    /// Returns true if the given planes and bounds are the ones of the last projection
+    bool isLastProjection(const QList<ImagePlane*> &referencePlanes, const QList<int> &bounds);
+
+private:
+    bool m_hasLocalizer;
+    ImagePlane m_localizerPlane;
+
+    /// Plane equation and direction vectors of the localizer
+    double m_localizerOrigin[3];
+    double m_localizerNormal[3];
+    double m_localizerRowVector[3];
+    double m_localizerColumnVector[3];
+    double m_localizerNormalLength;
+
+    /// Indices of the displayed image where the projected coordinates go, and the origin that is added to them
+    int m_xIndex;
+    int m_yIndex;
+    int m_zIndex;
+    double m_displayedImageOrigin[3];
+
+    /// Reference planes and bounds of the last projection with the current localizer, with their results and lines
+    QList<ImagePlane> m_lastReferencePlanes;
+    QList<int> m_lastBounds;
+    QVector<ProjectionResult> m_lastResults;
+    QVector<Line> m_lastLines;
+};
+
+}
+
+#endif
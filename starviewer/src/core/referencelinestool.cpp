@@ -23,19 +23,14 @@
 #include "drawer.h"
 #include "drawerpolygon.h"
 #include "drawerline.h"
-#include "mathtools.h"
-// Vtk
-#include <vtkPlane.h>
 
 namespace udg {
 
 const QString ReferenceLinesTool::ReferenceLinesDrawerGroup("ReferenceLines");
 
-const double ReferenceLinesTool::MinimumAngleConstraint = 45.0;
-const double ReferenceLinesTool::MaximumAngleConstraint = 135.0;
-
 ReferenceLinesTool::ReferenceLinesTool(QViewer *viewer, QObject *parent)
- : Tool(viewer, parent), m_projectedReferencePlane(0), m_showPlaneThickness(true), m_planesToProject(SingleImage)
+ : Tool(viewer, parent), m_projectedReferencePlane(0), m_localizerVolume(0), m_localizerSlice(-1), m_showPlaneThickness(true),
+   m_planesToProject(SingleImage)
 {
     m_toolName = "ReferenceLinesTool";
     m_hasSharedData = true;
@@ -141,15 +136,7 @@ void ReferenceLinesTool::updateProjectionLines()
             }
             else
             {
-                int drawerLineOffset = 0;
-                foreach (ImagePlane *referencePlane, planesToProject)
-                {
-                    // Aquí ja ho deixem en mans de la projecció
-                    ImagePlane *localizerPlane = m_2DViewer->getCurrentImagePlane();
-                    projectIntersection(referencePlane, localizerPlane, drawerLineOffset);
-                    delete localizerPlane;
-                    drawerLineOffset += m_showPlaneThickness ? 2 : 1;
-                }
+                projectIntersections(planesToProject);
             }
         }
         else
@@ -164,83 +151,82 @@ void ReferenceLinesTool::updateProjectionLines()
     }
 }
 
-void ReferenceLinesTool::projectIntersection(ImagePlane *referencePlane, ImagePlane *localizerPlane, int drawerLineOffset)
+void ReferenceLinesTool::projectIntersections(const QList<ImagePlane*> &referencePlanes)
 {
-    if (!(referencePlane && localizerPlane))
-    {
-        return;
-    }
+    updateLocalizer();
 
-    // Si l'angle entre plans no està dins de l'establert no s'aplicaran reference lines
-    if (!meetAngleConstraint(localizerPlane, referencePlane))
+    // Projecció de la intersecció dels plans
+    /// Llegir http://fixunix.com/dicom/51195-scanogram-lines-mr.html
+    QList<int> boundsList;
+    if (m_showPlaneThickness)
     {
-        m_2DViewer->getDrawer()->disableGroup(ReferenceLinesDrawerGroup);
-        return;
+        // Cal que intersectin els dos plans del gruix perquè es mostrin les línies
+        boundsList << ReferenceLinesEngine::UpperBounds << ReferenceLinesEngine::LowerBounds;
     }
-    
-    // Primer mirem que siguin plans diferents
-    if (*localizerPlane != *referencePlane)
+    else
     {
+        // Nomes agafem el pla "central"
+        boundsList << ReferenceLinesEngine::CentralBounds;
+    }
 
-        // Projecció de la intersecció dels plans
-        /// Llegir http://fixunix.com/dicom/51195-scanogram-lines-mr.html
+    QVector<ReferenceLinesEngine::Line> previousLines = m_projectedLines;
+    QVector<ReferenceLinesEngine::ProjectionResult> results = m_referenceLinesEngine.projectIntersections(referencePlanes, boundsList,
+                                                                                                           m_projectedLines);
 
-        QList<int> boundsList;
-        if (m_showPlaneThickness)
-        {
-            // Cal que intersectin els dos plans del gruix perquè es mostrin les línies
-            boundsList << 0 << 1;
-        }
-        else
+    // Only the lines that have moved are modified, so that the viewer isn't rendered again if none has
+    for (int i = 0; i < results.count(); i++)
+    {
+        if (results.at(i) == ReferenceLinesEngine::NotProjected)
         {
-            // Nomes agafem el pla "central"
-            boundsList << 2;
+            continue;
         }
 
-        if (computeIntersectionAndUpdateProjectionLines(localizerPlane, referencePlane, boundsList, drawerLineOffset))
-        {
-            m_2DViewer->getDrawer()->enableGroup(ReferenceLinesDrawerGroup);
-        }
-        else
+        for (int lineOffset = i * boundsList.count(); lineOffset < (i + 1) * boundsList.count(); lineOffset++)
         {
-            m_2DViewer->getDrawer()->disableGroup(ReferenceLinesDrawerGroup);
+            if (lineOffset >= previousLines.count() || previousLines.at(lineOffset) != m_projectedLines.at(lineOffset))
+            {
+                updateProjectedLine(lineOffset, m_projectedLines[lineOffset].firstPoint, m_projectedLines[lineOffset].secondPoint);
+            }
         }
     }
+
+    if (!results.isEmpty() && results.last() == ReferenceLinesEngine::AllBoundsIntersect)
+    {
+        m_2DViewer->getDrawer()->enableGroup(ReferenceLinesDrawerGroup);
+    }
     else
     {
         m_2DViewer->getDrawer()->disableGroup(ReferenceLinesDrawerGroup);
     }
 }
 
-bool ReferenceLinesTool::computeIntersectionAndUpdateProjectionLines(ImagePlane *localizerPlane, ImagePlane *referencePlane, QList<int> boundsList, int lineOffset)
+void ReferenceLinesTool::updateLocalizer()
 {
-    bool hasEnoughIntersections = true;
-    int numberOfIntersections = 0;
-    for (int i = 0; i < boundsList.size(); ++i)
+    Volume *volume = m_2DViewer->getMainInput();
+    int slice = m_2DViewer->getCurrentSlice();
+    OrthogonalPlane view = m_2DViewer->getView();
+
+    if (m_referenceLinesEngine.hasLocalizer() && volume == m_localizerVolume && slice == m_localizerSlice && view == m_localizerView)
     {
-        double firstIntersectionPoint[3], secondIntersectionPoint[3];
-        numberOfIntersections = referencePlane->getIntersections(localizerPlane, firstIntersectionPoint, secondIntersectionPoint, boundsList.at(i));
-        if (numberOfIntersections)
-        {
-            updateProjectionLinesFromIntersections(firstIntersectionPoint, secondIntersectionPoint, lineOffset + i);
-            hasEnoughIntersections = hasEnoughIntersections && true;
-        }
-        else
-        {
-            resetProjectedLine(lineOffset + i);
-            hasEnoughIntersections = hasEnoughIntersections && false;
-        }
+        return;
     }
 
-    return hasEnoughIntersections;
-}
-
-void ReferenceLinesTool::updateProjectionLinesFromIntersections(double firstIntersectionPoint[3], double secondIntersectionPoint[3], int lineOffset)
-{
-    m_2DViewer->projectDICOMPointToCurrentDisplayedImage(firstIntersectionPoint, firstIntersectionPoint);
-    m_2DViewer->projectDICOMPointToCurrentDisplayedImage(secondIntersectionPoint, secondIntersectionPoint);
+    m_localizerVolume = volume;
+    m_localizerSlice = slice;
+    m_localizerView = view;
 
-    updateProjectedLine(lineOffset, firstIntersectionPoint, secondIntersectionPoint);
+    // Els punts es projecten com ho fa Q2DViewer::projectDICOMPointToCurrentDisplayedImage()
+    ImagePlane *localizerPlane = m_2DViewer->getCurrentImagePlane();
+    Image *firstImage = volume ? volume->getImage(0) : 0;
+    if (localizerPlane && firstImage)
+    {
+        m_referenceLinesEngine.setLocalizer(*localizerPlane, view, firstImage->getImagePositionPatient());
+    }
+    else
+    {
+        m_referenceLinesEngine.clearLocalizer();
+    }
+    delete localizerPlane;
 }
 
 void ReferenceLinesTool::updateProjectedLine(int lineOffset, double firstPoint[3], double secondPoint[3])
@@ -253,13 +239,6 @@ void ReferenceLinesTool::updateProjectedLine(int lineOffset, double firstPoint[3
     m_backgroundProjectedIntersectionLines[lineOffset]->setSecondPoint(secondPoint);
 }
 
-void ReferenceLinesTool::resetProjectedLine(int lineOffset)
-{
-    double voidPoint[3] = { 0.0, 0.0, 0.0 };
-
-    updateProjectedLine(lineOffset, voidPoint, voidPoint);
-}
-
 void ReferenceLinesTool::projectPlane(ImagePlane *planeToProject)
 {
     QList<QVector<double> > planeBounds = planeToProject->getCentralBounds();
@@ -346,6 +325,9 @@ void ReferenceLinesTool::updateReferenceImagePlanesToProject()
 
 void ReferenceLinesTool::updateDataForCurrentInput()
 {
+    // El localitzador era una imatge de l'input anterior
+    m_referenceLinesEngine.clearLocalizer();
+
     // Actualitzem el frame of reference
     updateFrameOfReference();
     
@@ -408,6 +390,9 @@ void ReferenceLinesTool::checkAvailableLines()
         neededLines *= 2;
     }
 
+    // The lines that are created aren't at their projected points yet, so they have to be updated even if the projection hasn't changed
+    m_projectedLines.resize(qMin(m_projectedLines.count(), qMin(neededLines, m_projectedIntersectionLines.count())));
+
     createAndRemoveLines(neededLines, m_backgroundProjectedIntersectionLines, true);
     createAndRemoveLines(neededLines, m_projectedIntersectionLines, false);
 }
@@ -443,25 +428,4 @@ void ReferenceLinesTool::createAndRemoveLines(int neededLines, QList<DrawerLine*
     }
 }
 
-bool ReferenceLinesTool::meetAngleConstraint(ImagePlane *firstPlane, ImagePlane *secondPlane)
-{
-    if (!firstPlane || !secondPlane)
-    {
-        return false;
-    }
-
-    // Comprovem l'angle que formen els plans
-    double angle = MathTools::angleInDegrees(firstPlane->getImageOrientation().getNormalVector(), secondPlane->getImageOrientation().getNormalVector());
-    
-    if (fabs(angle) < MinimumAngleConstraint || fabs(angle) > MaximumAngleConstraint)
-    {
-        return false;
-    }
-    else
-    {
-        return true;
-    }
-
-}
-
 }
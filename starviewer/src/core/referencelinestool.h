@@ -16,6 +16,7 @@
 #define UDGREFERENCELINESTOOL_H
 
 #include "tool.h"
+#include "referencelinesengine.h"
 
 // Forward declarations
 class vtkMatrix4x4;
@@ -27,6 +28,7 @@ class Q2DViewer;
 class ImagePlane;
 class DrawerPolygon;
 class DrawerLine;
+class Volume;
 
 /**
     Tool per aplicar reference lines
@@ -73,23 +75,15 @@ private:
     /// mostrar les interseccions projectades
     void createPrimitives();
 
-    /// Projecta la intersecció del pla de referència amb el localitzador, sobre el pla de localitzador
-    /// tambe li indiquem quina es la linia a modificar
-    void projectIntersection(ImagePlane *referencePlane, ImagePlane *localizerPlane, int drawerLineOffset = 0);
-    
-    /// Computes intersection between given localizer and reference plane. boundsList shows which reference bound planes should be used to
-    /// compute intersections (upper, lower, central). If there is intersection with a bound plane, updates the correspoding lines
-    /// according to the given offset. If there is intersection with all the given bound planes returns true, false otherwise.
-    bool computeIntersectionAndUpdateProjectionLines(ImagePlane *localizerPlane, ImagePlane *referencePlane, QList<int> boundsList, int lineOffset);
-    
-    /// Projects the given intersection points and updates the corresponding lines according to lineOffset
-    void updateProjectionLinesFromIntersections(double firstIntersectionPoint[3], double secondIntersectionPoint[3], int lineOffset);
-    
+    /// Projects the intersections of the given reference planes with the current image of the viewer, the localizer, updating only the lines that
+    /// have changed. The lines are shown if the last plane intersects the localizer with all the bounds that are shown
+    void projectIntersections(const QList<ImagePlane*> &referencePlanes);
+
+    /// Sets the current image of the viewer as the localizer of the reference lines engine if it has changed
+    void updateLocalizer();
+
     /// Update the projected line according to lineOffset with the given points
     void updateProjectedLine(int lineOffset, double firstPoint[3], double secondPoint[3]);
-
-    /// Resets the projected line according to lineOffset so all points are the same and nothing can be viewed
-    void resetProjectedLine(int lineOffset);
     
     /// Projecta directament el pla donat, sobre el pla actual que s'està visualitzant al viewer
     /// Aquest mètode es fa servir per "debug"
@@ -106,18 +100,10 @@ private:
     /// El paràmetre areBackgroundLines indica si les línies a crear han de ser estil background o no
     void createAndRemoveLines(int neededLines, QList<DrawerLine*> &linesList, bool areBackgroundLines);
 
-    /// Comprova si els dos plans donats compleixen la restricció de l'angle que hi ha d'haver entre els plans de referència i localitzador
-    /// per poder aplicar reference lines
-    bool meetAngleConstraint(ImagePlane *firstPlane, ImagePlane *secondPlane);
-
 private:
     /// Nom del grup del drawer on agruparem les primitives del reference lines
     static const QString ReferenceLinesDrawerGroup;
 
-    /// Rang d'angles en el que s'han de trobar els plans que intersecten per poder aplicar el reference lines
-    static const double MinimumAngleConstraint;
-    static const double MaximumAngleConstraint;
-    
     /// Dades específiques de la tool
     ReferenceLinesToolData *m_myData;
 
@@ -135,6 +121,17 @@ private:
     QList<DrawerLine*> m_projectedIntersectionLines;
     QList<DrawerLine*> m_backgroundProjectedIntersectionLines;
 
+    /// Computes the projected lines. Its localizer is the current image of the viewer
+    ReferenceLinesEngine m_referenceLinesEngine;
+
+    /// Volume, slice and view of the localizer of the engine
+    Volume *m_localizerVolume;
+    int m_localizerSlice;
+    OrthogonalPlane m_localizerView;
+
+    /// Points of the lines currently drawn, in the same order as the lines of the lists above
+    QVector<ReferenceLinesEngine::Line> m_projectedLines;
+
     /// Aquesta variable serveix per controlar si volem mostrar el gruix de la llesca o si pel contrari
     /// amb la llesca tal qual ens conformem
     /// aquesta podria ser una variable usada en un ToolConfiguration
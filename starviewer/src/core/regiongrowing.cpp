@@ -0,0 +1,586 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "regiongrowing.h"
+
+#include "logging.h"
+
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+#include <limits>
+
+namespace udg {
+
+namespace {
+
+/// Row of voxels neighbour of the current one, displaced dy and dz. A voxel x of the current row is connected to the voxels
+/// [x - extension, x + extension] of the neighbour row
+struct NeighbourRow {
+    int dy;
+    int dz;
+    int extension;
+};
+
+/// Returns the neighbour rows of a row for the given connectivity. If onlyPrevious is true only the rows that are before the row in the buffer are returned
+QVector<NeighbourRow> getNeighbourRows(RegionGrowing::Connectivity connectivity, bool onlyPrevious)
+{
+    QVector<NeighbourRow> neighbourRows;
+
+    for (int dz = -1; dz <= 1; dz++)
+    {
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            if ((dy == 0 && dz == 0) || (onlyPrevious && (dz > 0 || (dz == 0 && dy > 0))))
+            {
+                continue;
+            }
+
+            bool isDiagonalRow = dy != 0 && dz != 0;
+            NeighbourRow row;
+            row.dy = dy;
+            row.dz = dz;
+
+            switch (connectivity)
+            {
+                case RegionGrowing::FaceConnectivity:
+                    if (isDiagonalRow)
+                    {
+                        continue;
+                    }
+                    row.extension = 0;
+                    break;
+
+                case RegionGrowing::EdgeConnectivity:
+                    row.extension = isDiagonalRow ? 0 : 1;
+                    break;
+
+                case RegionGrowing::VertexConnectivity:
+                    row.extension = 1;
+                    break;
+            }
+
+            neighbourRows.append(row);
+        }
+    }
+
+    return neighbourRows;
+}
+
+void initializeRegion(RegionGrowing::Region &region)
+{
+    region.numberOfVoxels = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        region.minimumIndex[i] = std::numeric_limits<int>::max();
+        region.maximumIndex[i] = std::numeric_limits<int>::min();
+    }
+}
+
+/// Adds the span [start, end] of row y of slice z to the region
+void addSpanToRegion(RegionGrowing::Region &region, int start, int end, int y, int z)
+{
+    region.numberOfVoxels += end - start + 1;
+    region.minimumIndex[0] = qMin(region.minimumIndex[0], start);
+    region.maximumIndex[0] = qMax(region.maximumIndex[0], end);
+    region.minimumIndex[1] = qMin(region.minimumIndex[1], y);
+    region.maximumIndex[1] = qMax(region.maximumIndex[1], y);
+    region.minimumIndex[2] = qMin(region.minimumIndex[2], z);
+    region.maximumIndex[2] = qMax(region.maximumIndex[2], z);
+}
+
+/// Seed of the span fill
+struct Seed {
+    int x;
+    int y;
+    int z;
+};
+
+/// Run of consecutive foreground voxels of a row, both ends included
+struct Run {
+    int start;
+    int end;
+};
+
+/// Runs of a slice. The runs of row y are [rowStarts[y], rowStarts[y + 1])
+struct SliceRuns {
+    QVector<Run> runs;
+    QVector<int> rowStarts;
+};
+
+/// Data shared by all the blocks of a connected component labelling
+struct LabellingContext {
+    const RegionGrowing::VoxelType *data;
+    int dimensions[3];
+    RegionGrowing::VoxelType lowerValue;
+    RegionGrowing::VoxelType upperValue;
+    QVector<NeighbourRow> previousNeighbourRows;
+
+    SliceRuns *slices;
+    /// Index of the first run of each slice in the union-find arrays
+    const int *sliceFirstRun;
+    /// Union-find parent of each run
+    int *parent;
+    /// Label of each run, only valid after all the runs have been joined
+    const int *runLabels;
+    int *labels;
+};
+
+/// Slab of consecutive slices processed by one thread
+struct Block {
+    int firstSlice;
+    int lastSlice;
+    LabellingContext *context;
+};
+
+int findRoot(int *parent, int run)
+{
+    while (parent[run] != run)
+    {
+        // Path halving
+        parent[run] = parent[parent[run]];
+        run = parent[run];
+    }
+    return run;
+}
+
+/// Joins the sets of the two runs. The root is always the run with the lowest index, so the sets of runs of a block only contain runs of the block
+/// until the blocks are joined
+void unite(int *parent, int run1, int run2)
+{
+    int root1 = findRoot(parent, run1);
+    int root2 = findRoot(parent, run2);
+
+    if (root1 < root2)
+    {
+        parent[root2] = root1;
+    }
+    else if (root2 < root1)
+    {
+        parent[root1] = root2;
+    }
+}
+
+/// Joins the runs of row y of slice z with the connected runs of the neighbour row
+void joinRows(LabellingContext *context, int z, int y, const NeighbourRow &neighbourRow)
+{
+    int neighbourY = y + neighbourRow.dy;
+    int neighbourZ = z + neighbourRow.dz;
+    if (neighbourY < 0 || neighbourY >= context->dimensions[1] || neighbourZ < 0 || neighbourZ >= context->dimensions[2])
+    {
+        return;
+    }
+
+    const SliceRuns &slice = context->slices[z];
+    const SliceRuns &neighbourSlice = context->slices[neighbourZ];
+
+    int i = slice.rowStarts[y];
+    int iEnd = slice.rowStarts[y + 1];
+    int j = neighbourSlice.rowStarts[neighbourY];
+    int jEnd = neighbourSlice.rowStarts[neighbourY + 1];
+
+    while (i < iEnd && j < jEnd)
+    {
+        const Run &run = slice.runs[i];
+        const Run &neighbourRun = neighbourSlice.runs[j];
+
+        if (neighbourRun.end + neighbourRow.extension < run.start)
+        {
+            j++;
+        }
+        else if (run.end + neighbourRow.extension < neighbourRun.start)
+        {
+            i++;
+        }
+        else
+        {
+            unite(context->parent, context->sliceFirstRun[z] + i, context->sliceFirstRun[neighbourZ] + j);
+
+            // The run that ends first can't overlap with the next run of the other row
+            if (neighbourRun.end < run.end)
+            {
+                j++;
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+}
+
+/// Finds the runs of foreground voxels of the slices of the block
+void findBlockRuns(Block &block)
+{
+    LabellingContext *context = block.context;
+    int width = context->dimensions[0];
+    int height = context->dimensions[1];
+
+    for (int z = block.firstSlice; z <= block.lastSlice; z++)
+    {
+        SliceRuns &slice = context->slices[z];
+        slice.rowStarts.resize(height + 1);
+
+        for (int y = 0; y < height; y++)
+        {
+            slice.rowStarts[y] = slice.runs.size();
+            const RegionGrowing::VoxelType *row = context->data + (static_cast<qint64>(z) * height + y) * width;
+
+            int x = 0;
+            while (x < width)
+            {
+                while (x < width && (row[x] < context->lowerValue || row[x] > context->upperValue))
+                {
+                    x++;
+                }
+
+                if (x < width)
+                {
+                    Run run;
+                    run.start = x;
+                    while (x < width && row[x] >= context->lowerValue && row[x] <= context->upperValue)
+                    {
+                        x++;
+                    }
+                    run.end = x - 1;
+                    slice.runs.append(run);
+                }
+            }
+        }
+
+        slice.rowStarts[height] = slice.runs.size();
+    }
+}
+
+/// Joins the connected runs of the block. Connections with the slice before the block are left for joinBlocks()
+void joinBlockRuns(Block &block)
+{
+    LabellingContext *context = block.context;
+
+    for (int z = block.firstSlice; z <= block.lastSlice; z++)
+    {
+        int firstRun = context->sliceFirstRun[z];
+        int lastRun = context->sliceFirstRun[z + 1];
+        for (int run = firstRun; run < lastRun; run++)
+        {
+            context->parent[run] = run;
+        }
+
+        for (int y = 0; y < context->dimensions[1]; y++)
+        {
+            foreach (const NeighbourRow &neighbourRow, context->previousNeighbourRows)
+            {
+                if (z + neighbourRow.dz >= block.firstSlice)
+                {
+                    joinRows(context, z, y, neighbourRow);
+                }
+            }
+        }
+    }
+}
+
+/// Joins the runs of the first slice of each block with the ones of the last slice of the previous block
+void joinBlocks(const QVector<Block> &blocks)
+{
+    for (int i = 1; i < blocks.size(); i++)
+    {
+        LabellingContext *context = blocks[i].context;
+        int z = blocks[i].firstSlice;
+
+        for (int y = 0; y < context->dimensions[1]; y++)
+        {
+            foreach (const NeighbourRow &neighbourRow, context->previousNeighbourRows)
+            {
+                if (neighbourRow.dz < 0)
+                {
+                    joinRows(context, z, y, neighbourRow);
+                }
+            }
+        }
+    }
+}
+
+/// Writes the label of each voxel of the block
+void writeBlockLabels(Block &block)
+{
+    LabellingContext *context = block.context;
+    int width = context->dimensions[0];
+    int height = context->dimensions[1];
+
+    for (int z = block.firstSlice; z <= block.lastSlice; z++)
+    {
+        const SliceRuns &slice = context->slices[z];
+        int *sliceLabels = context->labels + static_cast<qint64>(z) * width * height;
+        std::fill(sliceLabels, sliceLabels + width * height, 0);
+
+        for (int y = 0; y < height; y++)
+        {
+            int *rowLabels = sliceLabels + y * width;
+            for (int i = slice.rowStarts[y]; i < slice.rowStarts[y + 1]; i++)
+            {
+                const Run &run = slice.runs[i];
+                std::fill(rowLabels + run.start, rowLabels + run.end + 1, context->runLabels[context->sliceFirstRun[z] + i] + 1);
+            }
+        }
+    }
+}
+
+qint64 countVoxelsInRange(const RegionGrowing::VoxelType *data, qint64 numberOfVoxels, RegionGrowing::VoxelType lowerValue,
+                          RegionGrowing::VoxelType upperValue)
+{
+    qint64 count = 0;
+    for (qint64 i = 0; i < numberOfVoxels; i++)
+    {
+        if (data[i] >= lowerValue && data[i] <= upperValue)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+}
+
+RegionGrowing::RegionGrowing(VoxelType *data, const int dimensions[3])
+ : m_data(data), m_connectivity(FaceConnectivity), m_lowerValue(1), m_upperValue(std::numeric_limits<VoxelType>::max())
+{
+    for (int i = 0; i < 3; i++)
+    {
+        m_dimensions[i] = dimensions[i];
+    }
+}
+
+RegionGrowing::~RegionGrowing()
+{
+}
+
+void RegionGrowing::setConnectivity(Connectivity connectivity)
+{
+    m_connectivity = connectivity;
+}
+
+RegionGrowing::Connectivity RegionGrowing::getConnectivity() const
+{
+    return m_connectivity;
+}
+
+void RegionGrowing::setValueRange(VoxelType lowerValue, VoxelType upperValue)
+{
+    m_lowerValue = lowerValue;
+    m_upperValue = upperValue;
+}
+
+bool RegionGrowing::isForeground(VoxelType value) const
+{
+    return value >= m_lowerValue && value <= m_upperValue;
+}
+
+RegionGrowing::Region RegionGrowing::growFromSeed(const int seed[3], VoxelType fillValue)
+{
+    Region region;
+    initializeRegion(region);
+
+    if (isForeground(fillValue))
+    {
+        // The filled voxels must not be foreground, otherwise they would be filled again and again
+        ERROR_LOG(QString("El valor d'emplenat %1 està dins del rang de valors a emplenar [%2, %3]").arg(fillValue).arg(m_lowerValue).arg(m_upperValue));
+        return region;
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (seed[i] < 0 || seed[i] >= m_dimensions[i])
+        {
+            DEBUG_LOG(QString("La llavor [%1, %2, %3] és fora del volum").arg(seed[0]).arg(seed[1]).arg(seed[2]));
+            return region;
+        }
+    }
+
+    int width = m_dimensions[0];
+    int height = m_dimensions[1];
+    QVector<NeighbourRow> neighbourRows = getNeighbourRows(m_connectivity, false);
+
+    QVector<Seed> stack;
+    Seed firstSeed = { seed[0], seed[1], seed[2] };
+    stack.append(firstSeed);
+
+    while (!stack.isEmpty())
+    {
+        Seed current = stack.last();
+        stack.removeLast();
+
+        VoxelType *row = m_data + (static_cast<qint64>(current.z) * height + current.y) * width;
+        if (!isForeground(row[current.x]))
+        {
+            // Already filled from another seed
+            continue;
+        }
+
+        // Span of the seed
+        int start = current.x;
+        while (start > 0 && isForeground(row[start - 1]))
+        {
+            start--;
+        }
+        int end = current.x;
+        while (end < width - 1 && isForeground(row[end + 1]))
+        {
+            end++;
+        }
+
+        std::fill(row + start, row + end + 1, fillValue);
+        addSpanToRegion(region, start, end, current.y, current.z);
+
+        // One seed for each run of foreground voxels of the neighbour rows connected to the span
+        foreach (const NeighbourRow &neighbourRow, neighbourRows)
+        {
+            int y = current.y + neighbourRow.dy;
+            int z = current.z + neighbourRow.dz;
+            if (y < 0 || y >= height || z < 0 || z >= m_dimensions[2])
+            {
+                continue;
+            }
+
+            const VoxelType *neighbour = m_data + (static_cast<qint64>(z) * height + y) * width;
+            int from = qMax(0, start - neighbourRow.extension);
+            int to = qMin(width - 1, end + neighbourRow.extension);
+
+            for (int x = from; x <= to; x++)
+            {
+                if (isForeground(neighbour[x]) && (x == from || !isForeground(neighbour[x - 1])))
+                {
+                    Seed neighbourSeed = { x, y, z };
+                    stack.append(neighbourSeed);
+                }
+            }
+        }
+    }
+
+    return region;
+}
+
+QList<RegionGrowing::Region> RegionGrowing::labelConnectedComponents(int *labels) const
+{
+    QList<Region> regions;
+
+    int depth = m_dimensions[2];
+    if (m_dimensions[0] <= 0 || m_dimensions[1] <= 0 || depth <= 0)
+    {
+        return regions;
+    }
+
+    QVector<SliceRuns> slices(depth);
+
+    LabellingContext context;
+    context.data = m_data;
+    for (int i = 0; i < 3; i++)
+    {
+        context.dimensions[i] = m_dimensions[i];
+    }
+    context.lowerValue = m_lowerValue;
+    context.upperValue = m_upperValue;
+    context.previousNeighbourRows = getNeighbourRows(m_connectivity, true);
+    context.slices = slices.data();
+    context.labels = labels;
+
+    // Slabs of consecutive slices, one for each thread
+    int numberOfBlocks = qBound(1, QThread::idealThreadCount(), depth);
+    QVector<Block> blocks(numberOfBlocks);
+    for (int i = 0; i < numberOfBlocks; i++)
+    {
+        blocks[i].firstSlice = depth * i / numberOfBlocks;
+        blocks[i].lastSlice = depth * (i + 1) / numberOfBlocks - 1;
+        blocks[i].context = &context;
+    }
+
+    QtConcurrent::blockingMap(blocks, findBlockRuns);
+
+    QVector<int> sliceFirstRun(depth + 1);
+    sliceFirstRun[0] = 0;
+    for (int z = 0; z < depth; z++)
+    {
+        sliceFirstRun[z + 1] = sliceFirstRun[z] + slices[z].runs.size();
+    }
+    int numberOfRuns = sliceFirstRun[depth];
+
+    QVector<int> parent(numberOfRuns);
+    context.sliceFirstRun = sliceFirstRun.constData();
+    context.parent = parent.data();
+
+    QtConcurrent::blockingMap(blocks, joinBlockRuns);
+    joinBlocks(blocks);
+
+    // The root of each set is its first run, so the regions are created in the order of their first voxel
+    QVector<int> runLabels(numberOfRuns);
+    for (int z = 0; z < depth; z++)
+    {
+        const SliceRuns &slice = slices[z];
+        for (int y = 0; y < m_dimensions[1]; y++)
+        {
+            for (int i = slice.rowStarts[y]; i < slice.rowStarts[y + 1]; i++)
+            {
+                int run = sliceFirstRun[z] + i;
+                int root = findRoot(context.parent, run);
+
+                if (root == run)
+                {
+                    runLabels[run] = regions.size();
+                    Region region;
+                    initializeRegion(region);
+                    regions.append(region);
+                }
+                else
+                {
+                    runLabels[run] = runLabels[root];
+                }
+
+                addSpanToRegion(regions[runLabels[run]], slice.runs[i].start, slice.runs[i].end, y, z);
+            }
+        }
+    }
+
+    if (labels)
+    {
+        context.runLabels = runLabels.constData();
+        QtConcurrent::blockingMap(blocks, writeBlockLabels);
+    }
+
+    return regions;
+}
+
+qint64 RegionGrowing::countVoxels(const VoxelType *data, qint64 numberOfVoxels, VoxelType lowerValue, VoxelType upperValue)
+{
+    int numberOfChunks = static_cast<int>(qBound(static_cast<qint64>(1), static_cast<qint64>(QThread::idealThreadCount()), numberOfVoxels));
+
+    QList<QFuture<qint64> > counts;
+    for (int i = 0; i < numberOfChunks; i++)
+    {
+        qint64 begin = numberOfVoxels * i / numberOfChunks;
+        qint64 end = numberOfVoxels * (i + 1) / numberOfChunks;
+        counts << QtConcurrent::run(countVoxelsInRange, data + begin, end - begin, lowerValue, upperValue);
+    }
+
+    qint64 count = 0;
+    foreach (const QFuture<qint64> &future, counts)
+    {
+        count += future.result();
+    }
+
+    return count;
+}
+
+}
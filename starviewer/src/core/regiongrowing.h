@@ -0,0 +1,89 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGREGIONGROWING_H
+#define UDGREGIONGROWING_H
+
+#include <QList>
+
+namespace udg {
+
+/**
+    Region growing and connected component labelling on the raw scalar buffer of a volume.
+
+    The buffer is accessed directly, with x varying fastest, then y and then z, as in Volume, vtkImageData and itk::Image buffers. Voxels whose value is in
+    the range set with setValueRange() are the foreground, and two foreground voxels are connected if they are neighbours with the chosen connectivity.
+
+    growFromSeed() fills the region of the seed with an iterative span fill, so it doesn't depend on the stack size. labelConnectedComponents() finds the
+    runs of foreground voxels of each row and joins them with a union-find, slabs of slices are processed in parallel and joined at the end.
+    Both methods compute the number of voxels and the bounding box of each region while labelling, without rescanning the volume.
+ */
+class RegionGrowing {
+
+public:
+    /// Type of the voxels of the buffer, the same as Volume::ItkPixelType
+    typedef signed short VoxelType;
+
+    /// Neighbours of a voxel: the ones that share a face (6), a face or an edge (18) or a face, an edge or a vertex (26)
+    enum Connectivity { FaceConnectivity = 6, EdgeConnectivity = 18, VertexConnectivity = 26 };
+
+    /// Connected region of foreground voxels
+    struct Region {
+        /// Number of voxels of the region
+        qint64 numberOfVoxels;
+        /// Minimum and maximum voxel index of the region in each axis, both included
+        int minimumIndex[3];
+        int maximumIndex[3];
+    };
+
+    /// Creates an object to work on the given buffer, that must have dimensions[0] * dimensions[1] * dimensions[2] voxels
+    RegionGrowing(VoxelType *data, const int dimensions[3]);
+    ~RegionGrowing();
+
+    /// Sets the connectivity used to grow regions. It's FaceConnectivity by default
+    void setConnectivity(Connectivity connectivity);
+    Connectivity getConnectivity() const;
+
+    /// Sets the range of values of the foreground voxels, both included. It's [1, max] by default
+    void setValueRange(VoxelType lowerValue, VoxelType upperValue);
+
+    /// Sets fillValue to all the foreground voxels connected to the given seed and returns the filled region. fillValue must be outside the value range.
+    /// If the seed is out of the volume or is not a foreground voxel nothing is filled and the returned region has 0 voxels
+    Region growFromSeed(const int seed[3], VoxelType fillValue);
+
+    /// Finds all the connected regions of foreground voxels and returns them in the order of their first voxel in the buffer.
+    /// If labels is not null, it must have as many elements as the buffer, and it's filled with 0 for background voxels and i + 1 for the voxels
+    /// of the i-th returned region
+    QList<Region> labelConnectedComponents(int *labels = NULL) const;
+
+    /// Returns the number of voxels of the given buffer with a value between lowerValue and upperValue, both included. The buffer is split
+    /// between several threads
+    static qint64 countVoxels(const VoxelType *data, qint64 numberOfVoxels, VoxelType lowerValue, VoxelType upperValue);
+
+private:
+    /// Returns true if the given value belongs to the foreground
+    bool isForeground(VoxelType value) const;
+
+private:
+    VoxelType *m_data;
+    int m_dimensions[3];
+    Connectivity m_connectivity;
+    VoxelType m_lowerValue;
+    VoxelType m_upperValue;
+
+};
+
+}
+
+#endif // UDGREGIONGROWING_H
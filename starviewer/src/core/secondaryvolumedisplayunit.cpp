@@ -14,15 +14,18 @@
 
 #include "orthogonalplane.h"
 #include "secondaryvolumedisplayunit.h"
+#include "imagepipeline.h"
 #include "slicehandler.h"
 #include "volume.h"
 
+#include <vtkImageData.h>
 #include <vtkImageSlice.h>
 #include <vtkImageSliceMapper.h>
 
 namespace udg {
 
 SecondaryVolumeDisplayUnit::SecondaryVolumeDisplayUnit()
+ : m_fusionLayer(0), m_fusionLayerSlice(0)
 {
     m_mapper = vtkImageSliceMapper::New();
     m_imageSlice->SetMapper(m_mapper);
@@ -44,8 +47,45 @@ void SecondaryVolumeDisplayUnit::updateImageSlice(vtkCamera *camera)
 
     int zIndex = this->getViewPlane().getZIndex();
     m_mapper->SetOrientation(zIndex);
-    int imageIndex = m_volume->getImageIndex(m_sliceHandler->getCurrentSlice(), m_sliceHandler->getCurrentPhase());
-    m_mapper->SetSliceNumber(imageIndex);
+
+    if (m_fusionLayer)
+    {
+        m_mapper->SetSliceNumber(m_fusionLayerSlice);
+    }
+    else
+    {
+        int imageIndex = m_volume->getImageIndex(m_sliceHandler->getCurrentSlice(), m_sliceHandler->getCurrentPhase());
+        m_mapper->SetSliceNumber(imageIndex);
+    }
+}
+
+void SecondaryVolumeDisplayUnit::setFusionLayer(vtkImageData *fusionLayer)
+{
+    if (fusionLayer == m_fusionLayer || !m_volume)
+    {
+        return;
+    }
+
+    m_fusionLayer = fusionLayer;
+
+    if (m_fusionLayer)
+    {
+        getImagePipeline()->setInput(m_fusionLayer);
+    }
+    else
+    {
+        getImagePipeline()->setInput(m_volume->getVtkData());
+    }
+}
+
+bool SecondaryVolumeDisplayUnit::hasFusionLayer() const
+{
+    return m_fusionLayer != 0;
+}
+
+void SecondaryVolumeDisplayUnit::setFusionLayerSlice(int slice)
+{
+    m_fusionLayerSlice = slice;
 }
 
 } // namespace udg
@@ -17,6 +17,7 @@
 
 #include "volumedisplayunit.h"
 
+class vtkImageData;
 class vtkImageSliceMapper;
 
 namespace udg {
@@ -36,9 +37,22 @@ public:
     /// Updates the displayed image in the image slice.
     virtual void updateImageSlice(vtkCamera *camera);
 
+    /// Sets the volume resampled onto the slices of the primary volume (see FusionLayerCache) to be displayed instead of the slices of the volume.
+    /// A null layer displays the volume again.
+    void setFusionLayer(vtkImageData *fusionLayer);
+    /// Returns true if a fusion layer is being displayed.
+    bool hasFusionLayer() const;
+    /// Sets the slice of the fusion layer to display, which is the slice of the primary volume.
+    void setFusionLayerSlice(int slice);
+
 private:
     vtkImageSliceMapper *m_mapper;
 
+    /// Fusion layer being displayed, if any.
+    vtkImageData *m_fusionLayer;
+    /// Slice of the fusion layer to display.
+    int m_fusionLayerSlice;
+
 };
 
 } // namespace udg
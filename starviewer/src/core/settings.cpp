@@ -18,8 +18,9 @@
 #include "starviewerapplication.h"
 #include "settingsregistry.h"
 #include "settingsparser.h"
+#include "settingscache.h"
 
-#include <QTreeWidget>
+#include <QTreeView>
 // Pel restoreColumnsWidths
 #include <QHeaderView>
 // Pels saveGeometry(),restoreGeometry() de QSplitter
@@ -29,11 +30,6 @@ namespace udg {
 
 Settings::Settings()
 {
-    QSettings *userSettings = new QSettings(QSettings::UserScope, OrganizationNameString, ApplicationNameString);
-    QSettings *systemSettings = new QSettings(QSettings::SystemScope, OrganizationNameString, ApplicationNameString);
-
-    m_qsettingsObjectsMap.insert(UserLevel, userSettings);
-    m_qsettingsObjectsMap.insert(SystemLevel, systemSettings);
 }
 
 Settings::~Settings()
@@ -48,11 +44,19 @@ Settings::~Settings()
 QVariant Settings::getValue(const QString &key) const
 {
     QVariant value;
+    // Si el valor ja s'ha llegit abans el tindrem a la cache, ja resolt i parsejat
+    SettingsCache *cache = SettingsCache::instance();
+    if (cache->value(key, value))
+    {
+        return value;
+    }
+
+    // Cal obtenir la generació abans de llegir per no guardar un valor que s'hagi sobre-escrit mentre el llegíem
+    int cacheGeneration = cache->getGeneration();
+
     // Primer mirem si tenim valor als settings
     // Si estigués buit, llavors agafem el valor per defecte que tinguem al registre
-    // TODO hauríem d'obtenir l'objecte de settings amb getSettingsObject(key)
-    // però cal resoldre abans un problema de linkatge produit per projectes externs (crashreporter/sapwrapper)
-    value = m_qsettingsObjectsMap.value(SettingsRegistry::instance()->getAccessLevel(key))->value(key);
+    value = getSettingsObject(SettingsRegistry::instance()->getAccessLevel(key))->value(key);
     if (value == QVariant())
     {
         value = SettingsRegistry::instance()->getDefaultValue(key);
@@ -66,24 +70,26 @@ QVariant Settings::getValue(const QString &key) const
     {
         value = SettingsParser::instance()->parse(value.toString());
     }
+
+    cache->insert(key, value, cacheGeneration);
     return value;
 }
 
 void Settings::setValue(const QString &key, const QVariant &value)
 {
     getSettingsObject(key)->setValue(key, value);
+    invalidateCachedValue(key);
 }
 
 bool Settings::contains(const QString &key) const
 {
-    // TODO hauríem d'obtenir l'objecte de settings amb getSettingsObject(key)
-    // però cal resoldre abans un problema de linkatge produit per projectes externs (crashreporter/sapwrapper)
-    return m_qsettingsObjectsMap.value(SettingsRegistry::instance()->getAccessLevel(key))->contains(key);
+    return getSettingsObject(SettingsRegistry::instance()->getAccessLevel(key))->contains(key);
 }
 
 void Settings::remove(const QString &key)
 {
     getSettingsObject(key)->remove(key);
+    invalidateCachedValue(key);
 }
 
 QStringList Settings::getValueAsQStringList(const QString &key, const QString &separator) const
@@ -145,6 +151,7 @@ void Settings::addListItem(const QString &key, const SettingsListItemType &item)
     // Omplim
     dumpSettingsListItem(item, qsettings);
     qsettings->endArray();
+    invalidateCachedValue(key);
 }
 
 void Settings::setListItem(int index, const QString &key, const SettingsListItemType &item)
@@ -192,37 +199,38 @@ void Settings::setList(const QString &key, const SettingListType &list)
         index++;
     }
     qsettings->endArray();
+    invalidateCachedValue(key);
 }
 
-void Settings::saveColumnsWidths(const QString &key, QTreeWidget *treeWidget)
+void Settings::saveColumnsWidths(const QString &key, QTreeView *treeView)
 {
-    Q_ASSERT(treeWidget);
+    Q_ASSERT(treeView);
 
-    int columnCount = treeWidget->columnCount();
+    int columnCount = treeView->header()->count();
     QString columnKey;
     for (int column = 0; column < columnCount; column++)
     {
         columnKey = key + "/columnWidth" + QString::number(column);
-        this->setValue(columnKey, treeWidget->columnWidth(column));
+        this->setValue(columnKey, treeView->columnWidth(column));
     }
 }
 
-void Settings::restoreColumnsWidths(const QString &key, QTreeWidget *treeWidget)
+void Settings::restoreColumnsWidths(const QString &key, QTreeView *treeView)
 {
-    Q_ASSERT(treeWidget);
+    Q_ASSERT(treeView);
 
-    int columnCount = treeWidget->columnCount();
+    int columnCount = treeView->header()->count();
     QString columnKey;
     for (int column = 0; column < columnCount; column++)
     {
         columnKey = key + "/columnWidth" + QString::number(column);
         if (!this->contains(columnKey))
         {
-            treeWidget->resizeColumnToContents(column);
+            treeView->resizeColumnToContents(column);
         }
         else
         {
-            treeWidget->header()->resizeSection(column, this->getValue(columnKey).toInt());
+            treeView->header()->resizeSection(column, this->getValue(columnKey).toInt());
         }
     }
 }
@@ -277,7 +285,25 @@ void Settings::dumpSettingsListItem(const SettingsListItemType &item, QSettings
 
 QSettings *Settings::getSettingsObject(const QString &key)
 {
-    return m_qsettingsObjectsMap.value(SettingsRegistry::instance()->getAccessLevel(key));
+    return getSettingsObject(SettingsRegistry::instance()->getAccessLevel(key));
+}
+
+QSettings* Settings::getSettingsObject(AccessLevel accessLevel) const
+{
+    QSettings *qsettings = m_qsettingsObjectsMap.value(accessLevel);
+    if (!qsettings)
+    {
+        QSettings::Scope scope = accessLevel == SystemLevel ? QSettings::SystemScope : QSettings::UserScope;
+        qsettings = new QSettings(scope, OrganizationNameString, ApplicationNameString);
+        m_qsettingsObjectsMap.insert(accessLevel, qsettings);
+    }
+
+    return qsettings;
+}
+
+void Settings::invalidateCachedValue(const QString &key)
+{
+    SettingsCache::instance()->invalidate(key);
 }
 
 }  // End namespace udg
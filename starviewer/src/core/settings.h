@@ -22,7 +22,7 @@
 
 // Forward declarations
 class QString;
-class QTreeWidget;
+class QTreeView;
 class QSplitter;
 
 namespace udg {
@@ -96,10 +96,10 @@ public:
 
     /// Guarda/Restaura els amples de columna del widget dins de la clau donada.
     /// Sota la clau donada es guardaran els amples de cada columna amb nom columnWidthX on X serà el nombre de columna
-    /// L'unica implementació de moment és per QTreeWidget (i classes que n'hereden).
+    /// L'unica implementació de moment és per QTreeView (i classes que n'hereden, com QTreeWidget).
     /// Es sobrecarregarà el mètode per tants widgets com calgui.
-    void saveColumnsWidths(const QString &key, QTreeWidget *treeWidget);
-    void restoreColumnsWidths(const QString &key, QTreeWidget *treeWidget);
+    void saveColumnsWidths(const QString &key, QTreeView *treeView);
+    void restoreColumnsWidths(const QString &key, QTreeView *treeView);
 
     /// Guarda/Restaura la geometria d'un widget/splitter dins de la clau donada.
     void saveGeometry(const QString &key, QWidget *widget);
@@ -120,9 +120,16 @@ private:
     /// segons com estigui configurada la clau en qüestió
     QSettings* getSettingsObject(const QString &key);
 
+    /// Ens retorna l'objecte QSettings del nivell d'accés donat. Es crea el primer cop que es demana,
+    /// així els valors que es troben a SettingsCache no han d'obrir cap QSettings
+    QSettings* getSettingsObject(AccessLevel accessLevel) const;
+
+    /// Invalida la clau donada a SettingsCache després d'escriure-hi
+    void invalidateCachedValue(const QString &key);
+
 private:
-    /// Objectes QSettings amb el que manipularem les configuracions
-    QMap<int, QSettings*> m_qsettingsObjectsMap;
+    /// Objectes QSettings amb el que manipularem les configuracions, creats a mesura que es necessiten
+    mutable QMap<int, QSettings*> m_qsettingsObjectsMap;
 };
 } // End namespace udg
 Q_DECLARE_OPERATORS_FOR_FLAGS(udg::Settings::Properties)
@@ -0,0 +1,101 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "settingscache.h"
+
+#include <QReadLocker>
+#include <QWriteLocker>
+
+namespace udg {
+
+SettingsCache::SettingsCache()
+    : m_generation(0)
+{
+}
+
+SettingsCache::~SettingsCache()
+{
+}
+
+bool SettingsCache::value(const QString &key, QVariant &value) const
+{
+    QReadLocker locker(&m_lock);
+
+    QHash<QString, QVariant>::const_iterator iterator = m_values.constFind(key);
+    if (iterator == m_values.constEnd())
+    {
+        return false;
+    }
+
+    value = iterator.value();
+    return true;
+}
+
+int SettingsCache::getGeneration() const
+{
+    return m_generation.load();
+}
+
+void SettingsCache::insert(const QString &key, const QVariant &value, int generation)
+{
+    QWriteLocker locker(&m_lock);
+
+    // Si s'ha invalidat alguna clau des que es va llegir el valor, pot ser que el valor ja no sigui vàlid
+    if (generation == m_generation.load())
+    {
+        m_values.insert(key, value);
+    }
+}
+
+void SettingsCache::invalidate(const QString &key)
+{
+    {
+        QWriteLocker locker(&m_lock);
+
+        m_generation.ref();
+
+        QString prefix = key + "/";
+        QHash<QString, QVariant>::iterator iterator = m_values.begin();
+        while (iterator != m_values.end())
+        {
+            if (iterator.key() == key || iterator.key().startsWith(prefix))
+            {
+                iterator = m_values.erase(iterator);
+            }
+            else
+            {
+                ++iterator;
+            }
+        }
+    }
+
+    emit settingChanged(key);
+}
+
+void SettingsCache::clear()
+{
+    QWriteLocker locker(&m_lock);
+
+    m_generation.ref();
+    m_values.clear();
+}
+
+int SettingsCache::size() const
+{
+    QReadLocker locker(&m_lock);
+
+    return m_values.size();
+}
+
+}
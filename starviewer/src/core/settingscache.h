@@ -0,0 +1,82 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGSETTINGSCACHE_H
+#define UDGSETTINGSCACHE_H
+
+#include "singleton.h"
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QObject>
+#include <QReadWriteLock>
+#include <QVariant>
+
+namespace udg {
+
+/**
+    Process-wide cache of the values returned by Settings::getValue(), already resolved to their default value and parsed.
+
+    Settings::getValue() looks up the value here first and only reads QSettings, the registry and the parser when it isn't cached. All the writes made
+    through Settings invalidate the written key and the keys below it and emit settingChanged(), so the configuration screens don't need to do
+    anything to keep the cache up to date.
+
+    Methods are thread-safe: reads only take a read lock, so they don't block each other. A value read from QSettings while the same key was being
+    written is not cached: insert() is given the generation returned by getGeneration() before reading, and it's ignored if there has been an
+    invalidation since then.
+  */
+class SettingsCache : public QObject, public Singleton<SettingsCache> {
+Q_OBJECT
+public:
+    /// Returns true and sets value to the cached value of the given key if it's cached, otherwise returns false
+    bool value(const QString &key, QVariant &value) const;
+
+    /// Returns the current generation of the cache, that changes after each invalidation
+    int getGeneration() const;
+
+    /// Caches the value of the given key if there hasn't been any invalidation since getGeneration() returned the given generation
+    void insert(const QString &key, const QVariant &value, int generation);
+
+    /// Removes the given key and all the keys below it from the cache and emits settingChanged()
+    void invalidate(const QString &key);
+
+    /// Removes all the keys from the cache
+    void clear();
+
+    /// Returns the number of cached keys
+    int size() const;
+
+signals:
+    /// Emitted when the given key, or a key below it, has been written or removed. It can be emitted from any thread
+    void settingChanged(const QString &key);
+
+protected:
+    friend class Singleton<SettingsCache>;
+    SettingsCache();
+    ~SettingsCache();
+
+private:
+    /// Cached values by key
+    QHash<QString, QVariant> m_values;
+
+    /// Incremented on each invalidation
+    QAtomicInt m_generation;
+
+    /// Protects m_values
+    mutable QReadWriteLock m_lock;
+};
+
+}
+
+#endif
@@ -15,6 +15,7 @@
 #include "settingsregistry.h"
 
 #include "logging.h"
+#include "settingscache.h"
 #include "settingsaccesslevelfilereader.h"
 
 #include <QApplication>
@@ -34,6 +35,8 @@ SettingsRegistry::~SettingsRegistry()
 void SettingsRegistry::addSetting(const QString &key, const QVariant &defaultValue, Settings::Properties properties)
 {
     m_keyDefaultValueAndPropertiesMap.insert(key, qMakePair(defaultValue, properties));
+    // El valor per defecte pot haver canviat, per tant el que hi hagi a la cache ja no és vàlid
+    SettingsCache::instance()->invalidate(key);
 }
 
 QVariant SettingsRegistry::getDefaultValue(const QString &key)
@@ -75,6 +78,8 @@ void SettingsRegistry::loadAccesLevelTable()
         if (fileReader.read(filePath))
         {
             m_accessLevelTable = fileReader.getAccessLevelTable();
+            // Els valors de la cache es poden haver llegit d'un altre nivell d'accés
+            SettingsCache::instance()->clear();
         }
     }
 }
@@ -0,0 +1,199 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "spanmask.h"
+
+#include <cmath>
+
+#include <QPair>
+
+namespace udg {
+
+namespace {
+
+// Closed interval of pixels of a row
+typedef QPair<int, int> PixelInterval;
+
+}
+
+SpanMask::SpanMask()
+{
+    reset(0, 0);
+}
+
+SpanMask::~SpanMask()
+{
+}
+
+void SpanMask::reset(int width, int height)
+{
+    m_width = qMax(0, width);
+    m_height = qMax(0, height);
+    m_lastRow = -1;
+    m_spans.clear();
+    m_rowOffsets.fill(0, m_height + 1);
+}
+
+int SpanMask::getWidth() const
+{
+    return m_width;
+}
+
+int SpanMask::getHeight() const
+{
+    return m_height;
+}
+
+const SpanMask::Span* SpanMask::getRowSpans(int row, int &numberOfSpans) const
+{
+    if (row < 0 || row > m_lastRow)
+    {
+        numberOfSpans = 0;
+        return 0;
+    }
+
+    numberOfSpans = m_rowOffsets.at(row + 1) - m_rowOffsets.at(row);
+    return m_spans.constData() + m_rowOffsets.at(row);
+}
+
+bool SpanMask::isEmpty() const
+{
+    return m_spans.isEmpty();
+}
+
+int SpanMask::getNumberOfPixels() const
+{
+    int numberOfPixels = 0;
+    foreach (const Span &span, m_spans)
+    {
+        numberOfPixels += span.end - span.begin;
+    }
+
+    return numberOfPixels;
+}
+
+void SpanMask::addSpan(int row, int first, int last)
+{
+    Q_ASSERT(row >= m_lastRow);
+
+    first = qMax(0, first);
+    last = qMin(m_width - 1, last);
+    if (row < 0 || row >= m_height || first > last)
+    {
+        return;
+    }
+
+    if (row > m_lastRow)
+    {
+        // The rows between the last one with spans and this one are empty
+        for (int emptyRow = m_lastRow + 2; emptyRow <= row; ++emptyRow)
+        {
+            m_rowOffsets[emptyRow] = m_spans.count();
+        }
+        m_lastRow = row;
+    }
+    else if (first <= m_spans.last().end)
+    {
+        m_spans.last().end = qMax(m_spans.last().end, last + 1);
+        return;
+    }
+
+    Span span;
+    span.begin = first;
+    span.end = last + 1;
+    m_spans.append(span);
+    m_rowOffsets[row + 1] = m_spans.count();
+}
+
+void SpanMask::addPolygon(const QPolygonF &polygon, bool includeOutline)
+{
+    if (polygon.isEmpty())
+    {
+        return;
+    }
+
+    // The outline reaches the pixels whose centre is half a pixel away from the polygon
+    QRectF bounds = polygon.boundingRect();
+    double margin = includeOutline ? 0.5 : 0.0;
+    int firstRow = qMax(0, static_cast<int>(std::ceil(bounds.top() - margin)));
+    int lastRow = qMin(m_height - 1, static_cast<int>(std::floor(bounds.bottom() + margin)));
+
+    int numberOfVertices = polygon.count();
+    QVector<double> crossings;
+    QVector<PixelInterval> intervals;
+
+    for (int row = firstRow; row <= lastRow; ++row)
+    {
+        crossings.clear();
+        intervals.clear();
+
+        for (int i = 0; i < numberOfVertices; ++i)
+        {
+            const QPointF &start = polygon.at(i);
+            const QPointF &end = polygon.at((i + 1) % numberOfVertices);
+
+            // Crossings of the row with the edge for the even-odd fill of the interior
+            if ((start.y() > row) != (end.y() > row))
+            {
+                crossings << start.x() + (row - start.y()) * (end.x() - start.x()) / (end.y() - start.y());
+            }
+
+            if (!includeOutline)
+            {
+                continue;
+            }
+
+            // Pixels of the row crossed by the edge
+            if (start.y() == end.y())
+            {
+                if (qAbs(start.y() - row) <= 0.5)
+                {
+                    intervals << PixelInterval(qRound(qMin(start.x(), end.x())), qRound(qMax(start.x(), end.x())));
+                }
+            }
+            else
+            {
+                double top = qMax(row - 0.5, qMin(start.y(), end.y()));
+                double bottom = qMin(row + 0.5, qMax(start.y(), end.y()));
+                if (top <= bottom)
+                {
+                    double slope = (end.x() - start.x()) / (end.y() - start.y());
+                    int topX = qRound(start.x() + (top - start.y()) * slope);
+                    int bottomX = qRound(start.x() + (bottom - start.y()) * slope);
+                    intervals << PixelInterval(qMin(topX, bottomX), qMax(topX, bottomX));
+                }
+            }
+        }
+
+        qSort(crossings);
+        for (int i = 0; i + 1 < crossings.count(); i += 2)
+        {
+            int first = static_cast<int>(std::ceil(crossings.at(i)));
+            int last = static_cast<int>(std::floor(crossings.at(i + 1)));
+            if (first <= last)
+            {
+                intervals << PixelInterval(first, last);
+            }
+        }
+
+        // Sorted by their first pixel, addSpan() merges the ones that overlap
+        qSort(intervals);
+        foreach (const PixelInterval &interval, intervals)
+        {
+            addSpan(row, interval.first, interval.second);
+        }
+    }
+}
+
+} // End namespace udg
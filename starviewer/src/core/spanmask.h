@@ -0,0 +1,80 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGSPANMASK_H
+#define UDGSPANMASK_H
+
+#include <QPolygonF>
+#include <QVector>
+
+namespace udg {
+
+/**
+    Mask of a 2D image stored as run-length spans of pixels for each row, all of them in a single array.
+
+    The mask is built row by row from top to bottom, adding spans directly or rasterizing polygons by scanline. It's used by the classes that
+    rasterize a region once and then visit its pixels span by span.
+ */
+class SpanMask {
+public:
+    /// Pixels of a row inside the mask, from begin to end, end not included
+    struct Span {
+        int begin;
+        int end;
+    };
+
+    SpanMask();
+    ~SpanMask();
+
+    /// Empties the mask and sets the size of the image, to which the spans are clipped
+    void reset(int width, int height);
+
+    int getWidth() const;
+    int getHeight() const;
+
+    /// Returns the spans of the given row, sorted and without overlaps, and their number in numberOfSpans
+    const Span* getRowSpans(int row, int &numberOfSpans) const;
+
+    /// Returns true if there isn't any span
+    bool isEmpty() const;
+
+    /// Returns the number of pixels inside the mask
+    int getNumberOfPixels() const;
+
+    /// Appends a span for the given row, clipping it to the image. first and last are included. The row can't be before the last one with spans
+    /// and the span can't start before the last span of the row. If it overlaps or touches that span they are merged
+    void addSpan(int row, int first, int last);
+
+    /// Adds the pixels whose centre is inside the given polygon, following the even-odd rule. If includeOutline is true the pixels crossed by the
+    /// outline are added too. The vertices are continuous pixel coordinates, so pixel centres have integer coordinates, and the polygon is closed
+    /// implicitly. The rows of the polygon can't be before the last one with spans
+    void addPolygon(const QPolygonF &polygon, bool includeOutline);
+
+private:
+    int m_width;
+    int m_height;
+
+    /// Last row with spans, -1 if there aren't any
+    int m_lastRow;
+
+    /// Spans of all the rows, one row after another
+    QVector<Span> m_spans;
+
+    /// Index of the first span of each row in m_spans up to the last row with spans, followed by the total number of spans
+    QVector<int> m_rowOffsets;
+};
+
+} // End namespace udg
+
+#endif
@@ -0,0 +1,82 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "startupprofiler.h"
+
+#include "logging.h"
+
+#include <QElapsedTimer>
+
+namespace udg {
+
+namespace {
+
+bool Running = false;
+QElapsedTimer Timer;
+qint64 CurrentPhaseStart = 0;
+QList<QPair<QString, qint64> > Phases;
+
+}
+
+void StartupProfiler::start()
+{
+    Phases.clear();
+    CurrentPhaseStart = 0;
+    Timer.start();
+    Running = true;
+}
+
+void StartupProfiler::endPhase(const QString &phaseName)
+{
+    if (!Running)
+    {
+        return;
+    }
+
+    qint64 now = Timer.elapsed();
+    Phases << qMakePair(phaseName, now - CurrentPhaseStart);
+    CurrentPhaseStart = now;
+}
+
+void StartupProfiler::finish()
+{
+    if (!Running)
+    {
+        return;
+    }
+
+    Running = false;
+
+    QString summary;
+    qint64 phaseEnd = 0;
+    for (int i = 0; i < Phases.count(); i++)
+    {
+        phaseEnd += Phases.at(i).second;
+        summary += QString("\n    %1: %2 ms (%3 ms des de l'inici)").arg(Phases.at(i).first).arg(Phases.at(i).second).arg(phaseEnd);
+    }
+
+    INFO_LOG(QString("Temps d'inici de l'aplicació: %1 ms").arg(Timer.elapsed()) + summary);
+}
+
+bool StartupProfiler::isRunning()
+{
+    return Running;
+}
+
+QList<QPair<QString, qint64> > StartupProfiler::getPhases()
+{
+    return Phases;
+}
+
+}
@@ -0,0 +1,51 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGSTARTUPPROFILER_H
+#define UDGSTARTUPPROFILER_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+
+namespace udg {
+
+/**
+    Measures the time of each phase of the application startup and writes it to the log.
+
+    The startup is divided in consecutive phases: each call to endPhase() ends a phase that started when the previous one ended, or when start() was
+    called for the first one. finish() writes the time of each phase and the total time to the log. Calls made before start() or after finish() are
+    ignored, so the phases can be marked in code that also runs after the startup, like the creation of new windows.
+  */
+class StartupProfiler {
+public:
+    /// Starts measuring the startup
+    static void start();
+
+    /// Ends the current phase, that gets the given name
+    static void endPhase(const QString &phaseName);
+
+    /// Writes the time of each phase, the time from the start to its end, and the total time to the log and stops measuring
+    static void finish();
+
+    /// Returns true between the calls to start() and finish()
+    static bool isRunning();
+
+    /// Returns the name and the time in ms of each phase ended since the last call to start(), also after finish()
+    static QList<QPair<QString, qint64> > getPhases();
+};
+
+}
+
+#endif
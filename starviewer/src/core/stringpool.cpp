@@ -0,0 +1,78 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "stringpool.h"
+
+#include <QMutexLocker>
+
+namespace udg {
+
+StringPool::StringPool()
+{
+}
+
+StringPool::~StringPool()
+{
+}
+
+QString StringPool::intern(const QString &string)
+{
+    if (string.isEmpty())
+    {
+        // Empty strings don't allocate, no need to keep them
+        return string;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    QSet<QString>::const_iterator iterator = m_strings.constFind(string);
+    if (iterator != m_strings.constEnd())
+    {
+        return *iterator;
+    }
+
+    m_strings.insert(string);
+    return string;
+}
+
+int StringPool::purge()
+{
+    QMutexLocker locker(&m_mutex);
+
+    int numberOfRemovedStrings = 0;
+    QSet<QString>::iterator iterator = m_strings.begin();
+    while (iterator != m_strings.end())
+    {
+        // A string that isn't shared isn't held by anyone else, and new references to it can only be obtained through intern(), which is locked
+        if (iterator->isDetached())
+        {
+            iterator = m_strings.erase(iterator);
+            ++numberOfRemovedStrings;
+        }
+        else
+        {
+            ++iterator;
+        }
+    }
+
+    return numberOfRemovedStrings;
+}
+
+int StringPool::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_strings.size();
+}
+
+}
@@ -0,0 +1,62 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGSTRINGPOOL_H
+#define UDGSTRINGPOOL_H
+
+#include "singleton.h"
+
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+namespace udg {
+
+/**
+    Process-wide pool of shared strings.
+
+    Metadata of big series repeats the same values in every Image (transfer syntax, image type, directory of the file...). intern() returns a copy
+    of the pooled string equal to the given one, so that all the instances share the same implicitly shared data instead of holding a copy each.
+    Methods are thread-safe because images are filled from the patient filler threads.
+
+    The pool keeps a reference to every interned string, so purge() has to be called after big sets of images are destroyed (e.g. when the patient of
+    a window is replaced) to release the strings that no image uses anymore.
+ */
+class StringPool : public Singleton<StringPool> {
+public:
+    /// Returns a string equal to the given one that shares its data with all the other interned strings with the same value.
+    QString intern(const QString &string);
+
+    /// Removes from the pool the strings that are only referenced by the pool itself. Returns the number of removed strings.
+    int purge();
+
+    /// Returns the number of distinct strings in the pool.
+    int size() const;
+
+protected:
+    friend class Singleton<StringPool>;
+    StringPool();
+    ~StringPool();
+
+private:
+    /// Distinct interned strings.
+    QSet<QString> m_strings;
+
+    /// Protects the set from concurrent access.
+    mutable QMutex m_mutex;
+};
+
+}
+
+#endif // UDGSTRINGPOOL_H
@@ -57,6 +57,9 @@
 #include <vtkImageData.h>
 
 #include "logging.h"
+#include "regiongrowing.h"
+
+#include <algorithm>
 
 namespace udg {
 
@@ -186,6 +189,13 @@ double StrokeSegmentationMethod::applyMethodVTK()
     imageThreshold->Update();
     vtkImageData *imMask = imageThreshold->GetOutput();
 
+    if (imMask->GetScalarType() != VTK_SHORT)
+    {
+        ERROR_LOG(QString("El tipus dels vòxels de la màscara (%1) no és short").arg(imMask->GetScalarTypeAsString()));
+        imageThreshold->Delete();
+        return 0.0;
+    }
+
     m_Volume->getSpacing(spacing);
     m_Volume->getOrigin(origin);
     index[0] = (int)(((double)m_px - origin[0]) / spacing[0]);
@@ -193,9 +203,27 @@ double StrokeSegmentationMethod::applyMethodVTK()
     index[2] = (int)(((double)m_pz - origin[2]) / spacing[2]);
     DEBUG_LOG(QString("Tractant llesca %1").arg(index[2]));
 
-    applyMethodVTKRecursive(imMask, index[0], index[1], index[2], 0);
+    // La llavor ha de ser relativa al començament del buffer
+    int extent[6];
+    int dimensions[3];
+    int seed[3];
+    imMask->GetExtent(extent);
+    imMask->GetDimensions(dimensions);
+    for (int i = 0; i < 3; i++)
+    {
+        seed[i] = index[i] - extent[2 * i];
+    }
 
-    DEBUG_LOG(QString("Tractant llesca %1").arg(index[2]));
+    RegionGrowing::VoxelType *maskData = static_cast<RegionGrowing::VoxelType*>(imMask->GetScalarPointer());
+    RegionGrowing::VoxelType thresholdedValue = m_insideMaskValue - 100;
+
+    RegionGrowing regionGrowing(maskData, dimensions);
+    regionGrowing.setValueRange(thresholdedValue, thresholdedValue);
+    m_cont = regionGrowing.growFromSeed(seed, m_insideMaskValue).numberOfVoxels;
+
+    // Els vòxels dins del llindar que no estan connectats amb la llavor queden fora de la màscara
+    std::replace(maskData, maskData + static_cast<qint64>(dimensions[0]) * dimensions[1] * dimensions[2], thresholdedValue,
+                 static_cast<RegionGrowing::VoxelType>(m_outsideMaskValue));
 
     m_Mask->setData(imMask);
     imageThreshold->Delete();
@@ -203,26 +231,6 @@ double StrokeSegmentationMethod::applyMethodVTK()
     return m_cont * spacing[0] * spacing[1] * spacing[2];
 }
 
-void StrokeSegmentationMethod::applyMethodVTKRecursive(vtkImageData* imMask, int a, int b, int c, int prof)
-{
-    if ((a >= m_Volume->getExtent()[0]) && (a <= m_Volume->getExtent()[1]) && (b >= m_Volume->getExtent()[2]) && (b <=
-        m_Volume->getExtent()[3]) && (c >= m_Volume->getExtent()[4]) && (c <= m_Volume->getExtent()[5]))
-    {
-        double maskValue = imMask->GetScalarComponentAsDouble(a, b, c, 0);
-        if (maskValue == m_insideMaskValue - 100)
-        {
-            imMask->SetScalarComponentFromDouble(a, b, c, 0, m_insideMaskValue);
-            m_cont++;
-            applyMethodVTKRecursive(imMask, a, b, c + 1, prof + 1);
-            applyMethodVTKRecursive(imMask, a, b, c - 1, prof + 1);
-            applyMethodVTKRecursive(imMask, a + 1, b, c, prof + 1);
-            applyMethodVTKRecursive(imMask, a - 1, b, c, prof + 1);
-            applyMethodVTKRecursive(imMask, a, b + 1, c, prof + 1);
-            applyMethodVTKRecursive(imMask, a, b - 1, c, prof + 1);
-        }
-    }
-}
-
 double StrokeSegmentationMethod::applyCleanSkullMethod()
 {
     DEBUG_LOG("Clean Skull!!");
@@ -1448,19 +1456,8 @@ void StrokeSegmentationMethod::applyMethod2()
 
 int StrokeSegmentationMethod::computeSizeMask()
 {
-    typedef itk::ImageRegionIterator<Volume::ItkImageType> IteratorType;
-    IteratorType imIt(m_Mask->getItkData(), m_Mask->getItkData()->GetBufferedRegion());
-    int cont = 0;
-
-    imIt.GoToBegin();
-    while (!imIt.IsAtEnd())
-    {
-        if (imIt.Value() == m_insideMaskValue)
-        {
-            cont++;
-        }
-        ++imIt;
-    }
+    Volume::ItkImageType *mask = m_Mask->getItkData();
+    int cont = RegionGrowing::countVoxels(mask->GetBufferPointer(), mask->GetBufferedRegion().GetNumberOfPixels(), m_insideMaskValue, m_insideMaskValue);
     DEBUG_LOG(QString("VolumePelo = %1").arg(cont));
 
     return cont;
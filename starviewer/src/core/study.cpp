@@ -439,6 +439,28 @@ DICOMSource Study::getDICOMSource() const
     return resultDICOMSource;
 }
 
+Study* Study::copyWithoutSeries() const
+{
+    Study *copy = new Study();
+    copy->m_studyInstanceUID = m_studyInstanceUID;
+    copy->m_modalities = m_modalities;
+    copy->m_date = m_date;
+    copy->m_time = m_time;
+    copy->m_studyID = m_studyID;
+    copy->m_accessionNumber = m_accessionNumber;
+    copy->m_description = m_description;
+    copy->m_age = m_age;
+    copy->m_height = m_height;
+    copy->m_weight = m_weight;
+    copy->m_referringPhysiciansName = m_referringPhysiciansName;
+    copy->m_retrievedDate = m_retrievedDate;
+    copy->m_retrieveTime = m_retrieveTime;
+    copy->m_institutionName = m_institutionName;
+    copy->m_studyDICOMSource = getDICOMSource();
+
+    return copy;
+}
+
 QString Study::toString()
 {
     QString result;
@@ -146,6 +146,10 @@ public:
 
     QString toString();
 
+    /// Retorna una còpia de l'estudi amb tota la seva informació però sense les sèries ni el pacient. La font DICOM de la còpia inclou la de les
+    /// sèries de l'estudi. Qui la demana se n'ha d'encarregar d'esborrar-la
+    Study* copyWithoutSeries() const;
+
     /// Operadors per comparar si un estudi és més antic (operador <) o més recent (operador >).
     bool operator<(const Study &study);
     bool operator>(const Study &study);
@@ -22,14 +22,39 @@
 
 #include "q2dviewer.h"
 
+#include <QGuiApplication>
+#include <QScreen>
+#include <QTimer>
+
+#include <typeinfo>
+
 namespace udg {
 
+namespace {
+
+// Refresh rate assumed when the screen doesn't report it
+const double DefaultRefreshRate = 60.0;
+
+}
+
 SyncActionManager::SyncActionManager(SyncActionsConfiguration *configuration, QObject *parent)
  : QObject(parent)
 {
     m_masterViewer = 0;
     m_enabled = false;
     m_synchronizingAll = false;
+
+    double refreshRate = DefaultRefreshRate;
+    QScreen *screen = QGuiApplication::primaryScreen();
+    if (screen && screen->refreshRate() > 0.0)
+    {
+        refreshRate = screen->refreshRate();
+    }
+    m_frameInterval = qRound(1000.0 / refreshRate);
+
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setSingleShot(true);
+    connect(m_frameTimer, SIGNAL(timeout()), SLOT(processFrame()));
     
     setupSignalMappers();
     setupSyncActionsConfiguration(configuration);
@@ -76,12 +101,20 @@ void SyncActionManager::removeSyncedViewer(QViewer *viewer)
     }
 
     m_syncedViewersList.removeOne(viewer);
+    forgetViewer(viewer);
 }
 
 void SyncActionManager::setMasterViewer(QViewer *viewer)
 {
     if (m_syncedViewersList.contains(viewer))
     {
+        if (viewer != m_masterViewer)
+        {
+            // Pending actions and cached criteria refer to the current master viewer
+            applyPendingSyncActions();
+            m_satisfiedCriteriaCache.clear();
+        }
+
         m_masterViewer = viewer;
         updateMasterViewerMappers();
     }
@@ -90,6 +123,9 @@ void SyncActionManager::setMasterViewer(QViewer *viewer)
 void SyncActionManager::clearSyncedViewersSet()
 {
     m_syncedViewersList.clear();
+    m_pendingSyncActions.clear();
+    m_viewersPendingRender.clear();
+    m_satisfiedCriteriaCache.clear();
 }
 
 void SyncActionManager::setSyncActionsConfiguration(SyncActionsConfiguration *configuration)
@@ -157,6 +193,7 @@ void SyncActionManager::synchronizeAllViewersButSender()
 void SyncActionManager::synchronizeAllWithExceptions(QSet<QViewer*> excludedViewers)
 {
     QViewer *selectedViewer = m_masterViewer;
+    applyPendingSyncActions();
     m_syncActionsAppliedPerViewer.clear();
     m_synchronizingAll = true;
 
@@ -176,6 +213,7 @@ void SyncActionManager::synchronizeAllWithExceptions(QSet<QViewer*> excludedView
     }
 
     m_synchronizingAll = false;
+    m_satisfiedCriteriaCache.clear();
 
     this->setMasterViewer(selectedViewer);
 }
@@ -225,25 +263,134 @@ void SyncActionManager::applySyncAction(SyncAction *syncAction)
         return;
     }
 
+    if (m_synchronizingAll)
+    {
+        // Mappers reuse their SyncAction for each master viewer, so these actions can't wait for the next frame
+        if (!m_syncActionsAppliedPerViewer.contains(syncAction->getMetaData().getSettingsName(), m_masterViewer))
+        {
+            applySyncActionOnViewers(syncAction);
+        }
+        return;
+    }
+
+    // A new action of the same type replaces the pending one
+    QString syncActionName = syncAction->getMetaData().getName();
+    bool merged = false;
+    for (int i = 0; i < m_pendingSyncActions.count() && !merged; i++)
+    {
+        if (m_pendingSyncActions.at(i)->getMetaData().getName() == syncActionName)
+        {
+            m_pendingSyncActions[i] = syncAction;
+            merged = true;
+        }
+    }
+
+    if (!merged)
+    {
+        m_pendingSyncActions << syncAction;
+    }
+
+    scheduleFrame();
+}
+
+void SyncActionManager::applySyncActionOnViewers(SyncAction *syncAction)
+{
     QString syncActionName = syncAction->getMetaData().getSettingsName();
 
-    if (!m_synchronizingAll || !m_syncActionsAppliedPerViewer.contains(syncActionName, m_masterViewer))
+    foreach (QViewer *viewer, m_syncedViewersList)
     {
-        foreach (QViewer *viewer, m_syncedViewersList)
+        if (isSyncActionApplicable(syncAction, viewer))
         {
-            if (isSyncActionApplicable(syncAction, viewer))
-            {
-                syncAction->run(viewer);
+            runSyncAction(syncAction, viewer);
 
-                if (m_synchronizingAll)
-                {
-                    m_syncActionsAppliedPerViewer.insert(syncActionName, viewer);
-                }
+            if (m_synchronizingAll)
+            {
+                m_syncActionsAppliedPerViewer.insert(syncActionName, viewer);
             }
         }
     }
 }
 
+void SyncActionManager::runSyncAction(SyncAction *syncAction, QViewer *viewer)
+{
+    bool renderingEnabled = viewer->isRenderingEnabled();
+    viewer->enableRendering(false);
+    syncAction->run(viewer);
+    viewer->enableRendering(renderingEnabled);
+
+    // The action may have changed what the criteria depend on, e.g. the plane of the viewer
+    m_satisfiedCriteriaCache.remove(viewer);
+
+    if (!m_viewersPendingRender.contains(viewer))
+    {
+        m_viewersPendingRender << viewer;
+    }
+
+    scheduleFrame();
+}
+
+void SyncActionManager::applyPendingSyncActions()
+{
+    QList<SyncAction*> pendingSyncActions = m_pendingSyncActions;
+    m_pendingSyncActions.clear();
+    // The viewers may have changed since the criteria were last evaluated
+    m_satisfiedCriteriaCache.clear();
+
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    foreach (SyncAction *syncAction, pendingSyncActions)
+    {
+        applySyncActionOnViewers(syncAction);
+    }
+}
+
+void SyncActionManager::scheduleFrame()
+{
+    if (m_frameTimer->isActive())
+    {
+        return;
+    }
+
+    int timeToNextFrame = 0;
+    if (m_lastFrameTime.isValid())
+    {
+        timeToNextFrame = qMax(0, m_frameInterval - static_cast<int>(m_lastFrameTime.elapsed()));
+    }
+
+    m_frameTimer->start(timeToNextFrame);
+}
+
+void SyncActionManager::processFrame()
+{
+    m_lastFrameTime.start();
+
+    applyPendingSyncActions();
+    m_satisfiedCriteriaCache.clear();
+
+    QList<QViewer*> viewersToRender = m_viewersPendingRender;
+    m_viewersPendingRender.clear();
+
+    foreach (QViewer *viewer, viewersToRender)
+    {
+        viewer->render();
+    }
+
+    // Everything scheduled while processing this frame has already been done
+    if (m_pendingSyncActions.isEmpty() && m_viewersPendingRender.isEmpty())
+    {
+        m_frameTimer->stop();
+    }
+}
+
+void SyncActionManager::forgetViewer(QViewer *viewer)
+{
+    m_viewersPendingRender.removeAll(viewer);
+    m_satisfiedCriteriaCache.remove(viewer);
+}
+
 bool SyncActionManager::isSyncActionApplicable(SyncAction *syncAction, QViewer *viewer)
 {
     if (!viewer || !syncAction)
@@ -263,11 +410,25 @@ bool SyncActionManager::isSyncActionApplicable(SyncAction *syncAction, QViewer *
 bool SyncActionManager::areAllCriteriaSatisfied(QList<SyncCriterion*> criteria, QViewer *viewer)
 {
     bool criteriaAreSatisfied = true;
+    // Each action has its own criteria instances, so results are shared between actions by criterion class
+    QHash<QString, bool> &cachedResults = m_satisfiedCriteriaCache[viewer];
 
     int i = 0;
     while (criteriaAreSatisfied && i < criteria.count())
     {
-        criteriaAreSatisfied = criteria.at(i)->isCriterionSatisfied(m_masterViewer, viewer);
+        SyncCriterion *criterion = criteria.at(i);
+        QString criterionClass = typeid(*criterion).name();
+
+        QHash<QString, bool>::const_iterator cachedResult = cachedResults.constFind(criterionClass);
+        if (cachedResult != cachedResults.constEnd())
+        {
+            criteriaAreSatisfied = cachedResult.value();
+        }
+        else
+        {
+            criteriaAreSatisfied = criterion->isCriterionSatisfied(m_masterViewer, viewer);
+            cachedResults.insert(criterionClass, criteriaAreSatisfied);
+        }
         ++i;
     }
 
@@ -16,8 +16,13 @@
 #define UDGSYNCACTIONMANAGER_H
 
 #include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QList>
 #include <QMultiHash>
+#include <QSet>
+
+class QTimer;
 
 namespace udg {
 
@@ -33,6 +38,9 @@ class SyncActionsConfiguration;
     whose actions will be propagated to the rest of the registered viewers
     We can also configure which SyncActions will be propagated via setSyncActionsConfiguration()
     By default, if no configiration is provided, all registered SyncActions will be enabled
+
+    Mapped SyncActions are not applied right away but batched until the next display refresh. Successive actions of the same type are merged,
+    so only the last one is applied, the criteria are evaluated once per viewer pair and the viewers are rendered at most once per frame.
  */
 class SyncActionManager : public QObject {
 Q_OBJECT
@@ -92,6 +100,21 @@ private:
     /// Synchronize all viewers except the set of viewers given as parameter. The master viewer is synchronized first if it is not in the list.
     void synchronizeAllWithExceptions(QSet<QViewer*> excludedViewers);
 
+    /// Applies the given SyncAction on the registered viewers, but the master viewer, deferring their rendering to the next frame
+    void applySyncActionOnViewers(SyncAction *syncAction);
+
+    /// Runs the given SyncAction on the given viewer with rendering disabled and marks the viewer to be rendered on the next frame
+    void runSyncAction(SyncAction *syncAction, QViewer *viewer);
+
+    /// Applies the SyncActions mapped since the last frame
+    void applyPendingSyncActions();
+
+    /// Schedules the next frame, when pending actions will be applied and pending viewers rendered, if it's not already scheduled
+    void scheduleFrame();
+
+    /// Removes all the references to the given viewer kept for the next frame
+    void forgetViewer(QViewer *viewer);
+
 private slots:
     /// Applies the given SyncAction on the registered viewers, but the master viewer
     void applySyncAction(SyncAction *syncAction);
@@ -99,6 +122,9 @@ private slots:
     /// Synchronize all viewers except the sender. The master viewer is synchronized first.
     void synchronizeAllViewersButSender();
 
+    /// Applies the pending SyncActions and renders the viewers modified since the last frame
+    void processFrame();
+
 private:
     /// The list of viewers to be synced
     QList<QViewer*> m_syncedViewersList;
@@ -119,6 +145,23 @@ private:
     /// Helper attributes to avoid unnecessary syncronizations when syncronizing all viewers
     QMultiHash<QString, QViewer*> m_syncActionsAppliedPerViewer;
     bool m_synchronizingAll;
+
+    /// SyncActions mapped since the last frame, in the order they were first mapped. Only one per type is kept
+    QList<SyncAction*> m_pendingSyncActions;
+
+    /// Viewers that have to be rendered on the next frame
+    QList<QViewer*> m_viewersPendingRender;
+
+    /// Results of the criteria between the master viewer and each viewer, by criterion class. They are only valid while a batch of
+    /// actions is being applied and are discarded for a viewer once an action has been run on it
+    QHash<QViewer*, QHash<QString, bool> > m_satisfiedCriteriaCache;
+
+    /// Timer that triggers the next frame, and time since the last one
+    QTimer *m_frameTimer;
+    QElapsedTimer m_lastFrameTime;
+
+    /// Time between frames, in milliseconds, taken from the refresh rate of the screen
+    int m_frameInterval;
 };
 
 } // End namespace udg
@@ -0,0 +1,235 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "temporalroiengine.h"
+
+#include <QFuture>
+#include <QList>
+#include <QThread>
+#include <QtConcurrentRun>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace udg {
+
+struct TemporalROIEngine::Accumulator {
+    QVector<double> sum;
+    QVector<double> sumOfSquares;
+    QVector<double> minimum;
+    QVector<double> maximum;
+    QVector<int> timeToPeak;
+    int numberOfVoxels;
+};
+
+TemporalROIEngine::TemporalROIEngine()
+ : m_slice(0)
+{
+}
+
+TemporalROIEngine::~TemporalROIEngine()
+{
+}
+
+void TemporalROIEngine::setTemporalImage(TemporalImageType *image)
+{
+    m_image = image;
+    m_mask.reset(0, 0);
+}
+
+void TemporalROIEngine::setROI(const QVector<QPointF> &polygon, const OrthogonalPlane &plane, int slice)
+{
+    m_plane = plane;
+    m_slice = slice;
+    m_mask.reset(0, 0);
+
+    if (!m_image)
+    {
+        return;
+    }
+
+    int xIndex, yIndex, zIndex;
+    m_plane.getXYZIndexes(xIndex, yIndex, zIndex);
+
+    // The first dimension of the image is the phase
+    TemporalImageType::SizeType size = m_image->GetBufferedRegion().GetSize();
+    int height = static_cast<int>(size[yIndex + 1]);
+
+    if (polygon.isEmpty() || slice < 0 || slice >= static_cast<int>(size[zIndex + 1]))
+    {
+        // The mask keeps the rows of the image but without any voxel
+        m_mask.reset(0, height);
+        return;
+    }
+
+    m_mask.reset(static_cast<int>(size[xIndex + 1]), height);
+    m_mask.addPolygon(QPolygonF(polygon), false);
+}
+
+int TemporalROIEngine::getNumberOfRows() const
+{
+    return m_mask.getHeight();
+}
+
+const TemporalROIEngine::Span* TemporalROIEngine::getRowSpans(int row, int &numberOfSpans) const
+{
+    return m_mask.getRowSpans(row, numberOfSpans);
+}
+
+int TemporalROIEngine::getNumberOfVoxels() const
+{
+    return m_mask.getNumberOfPixels();
+}
+
+TemporalROIEngine::Statistics TemporalROIEngine::computeStatistics() const
+{
+    int numberOfPhases = m_image ? static_cast<int>(m_image->GetBufferedRegion().GetSize()[0]) : 0;
+
+    Statistics statistics;
+    statistics.mean.fill(0.0, numberOfPhases);
+    statistics.standardDeviation.fill(0.0, numberOfPhases);
+    statistics.minimum.fill(0.0, numberOfPhases);
+    statistics.maximum.fill(0.0, numberOfPhases);
+    statistics.timeToPeak.fill(0, numberOfPhases);
+    statistics.numberOfVoxels = 0;
+
+    int numberOfRows = getNumberOfRows();
+    if (numberOfPhases == 0 || m_mask.isEmpty())
+    {
+        return statistics;
+    }
+
+    // The series of the first voxel of the ROI is the reference of the sums
+    int firstRow = 0;
+    int numberOfSpans;
+    const Span *firstRowSpans = getRowSpans(firstRow, numberOfSpans);
+    while (numberOfSpans == 0)
+    {
+        firstRowSpans = getRowSpans(++firstRow, numberOfSpans);
+    }
+    QVector<double> reference(numberOfPhases);
+    memcpy(reference.data(), getSeries(firstRowSpans[0].begin, firstRow), numberOfPhases * sizeof(double));
+
+    // Blocks of consecutive rows, one for each thread
+    int numberOfBlocks = qBound(1, QThread::idealThreadCount(), numberOfRows);
+    QList<QFuture<Accumulator> > blocks;
+    for (int i = 1; i < numberOfBlocks; i++)
+    {
+        blocks << QtConcurrent::run(this, &TemporalROIEngine::accumulateRows, numberOfRows * i / numberOfBlocks,
+                                    numberOfRows * (i + 1) / numberOfBlocks - 1, reference);
+    }
+
+    // The current thread computes the first block
+    Accumulator total = accumulateRows(0, numberOfRows / numberOfBlocks - 1, reference);
+
+    foreach (const QFuture<Accumulator> &block, blocks)
+    {
+        const Accumulator &accumulator = block.result();
+        for (int t = 0; t < numberOfPhases; t++)
+        {
+            total.sum[t] += accumulator.sum[t];
+            total.sumOfSquares[t] += accumulator.sumOfSquares[t];
+            total.minimum[t] = qMin(total.minimum[t], accumulator.minimum[t]);
+            total.maximum[t] = qMax(total.maximum[t], accumulator.maximum[t]);
+            total.timeToPeak[t] += accumulator.timeToPeak[t];
+        }
+        total.numberOfVoxels += accumulator.numberOfVoxels;
+    }
+
+    statistics.numberOfVoxels = total.numberOfVoxels;
+    for (int t = 0; t < numberOfPhases; t++)
+    {
+        double relativeMean = total.sum[t] / total.numberOfVoxels;
+        statistics.mean[t] = reference[t] + relativeMean;
+        statistics.standardDeviation[t] = std::sqrt(qMax(0.0, total.sumOfSquares[t] / total.numberOfVoxels - relativeMean * relativeMean));
+        statistics.minimum[t] = total.minimum[t];
+        statistics.maximum[t] = total.maximum[t];
+    }
+    statistics.timeToPeak = total.timeToPeak;
+
+    return statistics;
+}
+
+TemporalROIEngine::Accumulator TemporalROIEngine::accumulateRows(int firstRow, int lastRow, QVector<double> reference) const
+{
+    int numberOfPhases = reference.count();
+
+    Accumulator accumulator;
+    accumulator.sum.fill(0.0, numberOfPhases);
+    accumulator.sumOfSquares.fill(0.0, numberOfPhases);
+    accumulator.minimum.fill(std::numeric_limits<double>::max(), numberOfPhases);
+    accumulator.maximum.fill(-std::numeric_limits<double>::max(), numberOfPhases);
+    accumulator.timeToPeak.fill(0, numberOfPhases);
+    accumulator.numberOfVoxels = 0;
+
+    double *sum = accumulator.sum.data();
+    double *sumOfSquares = accumulator.sumOfSquares.data();
+    double *minimum = accumulator.minimum.data();
+    double *maximum = accumulator.maximum.data();
+    int *timeToPeak = accumulator.timeToPeak.data();
+
+    const double *referenceSeries = reference.constData();
+
+    // The phases of a voxel are contiguous, so each voxel is a block of numberOfPhases values, separated by xStride from the next one in the row
+    TemporalImageType::OffsetValueType xStride = m_image->GetOffsetTable()[m_plane.getXIndex() + 1];
+
+    for (int row = firstRow; row <= lastRow; row++)
+    {
+        int numberOfSpans;
+        const Span *spans = getRowSpans(row, numberOfSpans);
+
+        for (int i = 0; i < numberOfSpans; i++)
+        {
+            const double *series = getSeries(spans[i].begin, row);
+            for (int x = spans[i].begin; x < spans[i].end; x++, series += xStride)
+            {
+                int peak = 0;
+                for (int t = 0; t < numberOfPhases; t++)
+                {
+                    double value = series[t];
+                    double relativeValue = value - referenceSeries[t];
+                    sum[t] += relativeValue;
+                    sumOfSquares[t] += relativeValue * relativeValue;
+                    minimum[t] = qMin(minimum[t], value);
+                    maximum[t] = qMax(maximum[t], value);
+                    if (value > series[peak])
+                    {
+                        peak = t;
+                    }
+                }
+                timeToPeak[peak]++;
+            }
+
+            accumulator.numberOfVoxels += spans[i].end - spans[i].begin;
+        }
+    }
+
+    return accumulator;
+}
+
+const double* TemporalROIEngine::getSeries(int x, int row) const
+{
+    int xIndex, yIndex, zIndex;
+    m_plane.getXYZIndexes(xIndex, yIndex, zIndex);
+
+    TemporalImageType::IndexType index = m_image->GetBufferedRegion().GetIndex();
+    index[xIndex + 1] += x;
+    index[yIndex + 1] += row;
+    index[zIndex + 1] += m_slice;
+
+    return m_image->GetBufferPointer() + m_image->ComputeOffset(index);
+}
+
+}
@@ -0,0 +1,103 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGTEMPORALROIENGINE_H
+#define UDGTEMPORALROIENGINE_H
+
+#include "orthogonalplane.h"
+#include "spanmask.h"
+
+#include <QPointF>
+#include <QVector>
+
+#include <itkImage.h>
+
+namespace udg {
+
+/**
+    Computes statistics of the time series of the voxels inside a polygonal ROI drawn on a slice of a temporal image.
+
+    The temporal image is a 4D image whose first dimension is the phase, so the time series of each voxel is stored contiguously and a span of
+    voxels along the x axis of the image is a single block of memory. The ROI is rasterized once into spans of voxels for each row, and then the
+    statistics of all the phases are computed in one pass over those spans, splitting the rows among the available threads.
+
+    A voxel is inside the ROI if its centre is inside the polygon, following the even-odd rule.
+ */
+class TemporalROIEngine {
+public:
+    typedef itk::Image<double, 4> TemporalImageType;
+
+    /// Voxels of a row inside the ROI, from begin to end, end not included
+    typedef SpanMask::Span Span;
+
+    /// Statistics of the voxels inside the ROI, with one value for each phase
+    struct Statistics {
+        QVector<double> mean;
+        /// Population standard deviation
+        QVector<double> standardDeviation;
+        QVector<double> minimum;
+        QVector<double> maximum;
+        /// Number of voxels whose time series reaches its maximum at each phase, i.e. the distribution of the time to peak. Ties go to the first phase
+        QVector<int> timeToPeak;
+        int numberOfVoxels;
+    };
+
+    TemporalROIEngine();
+    ~TemporalROIEngine();
+
+    /// Sets the temporal image whose time series are read
+    void setTemporalImage(TemporalImageType *image);
+
+    /// Rasterizes the given polygon on the given slice of the temporal image as seen from the given plane. The vertices are continuous voxel
+    /// indices along the x and y axes of the plane, so that voxel centres have integer coordinates. The polygon is closed implicitly.
+    /// The temporal image must be set before
+    void setROI(const QVector<QPointF> &polygon, const OrthogonalPlane &plane, int slice);
+
+    /// Returns the number of rows of the ROI mask, which is the size of the image along the y axis of the plane
+    int getNumberOfRows() const;
+
+    /// Returns the spans of the given row, sorted and without overlaps, and their number in numberOfSpans
+    const Span* getRowSpans(int row, int &numberOfSpans) const;
+
+    /// Returns the number of voxels inside the ROI
+    int getNumberOfVoxels() const;
+
+    /// Computes the statistics of the time series of the voxels inside the ROI. If there is no image or the ROI is empty, all the values are 0
+    Statistics computeStatistics() const;
+
+private:
+    /// Partial statistics of a block of rows
+    struct Accumulator;
+
+    /// Accumulates the time series of the rows from firstRow to lastRow, both included. Sums are made relative to the given series to keep the
+    /// precision of the standard deviation when it's small compared to the values
+    Accumulator accumulateRows(int firstRow, int lastRow, QVector<double> reference) const;
+
+    /// Returns a pointer to the time series of the given voxel of the ROI slice
+    const double* getSeries(int x, int row) const;
+
+private:
+    TemporalImageType::Pointer m_image;
+
+    /// Plane and slice of the ROI
+    OrthogonalPlane m_plane;
+    int m_slice;
+
+    /// Voxels of the ROI slice inside the ROI
+    SpanMask m_mask;
+};
+
+}
+
+#endif
@@ -46,10 +46,15 @@ VolumeDisplayUnit::VolumeDisplayUnit()
     m_imagePointPicker =  0;
     m_voiLutData = 0;
     m_currentThickSlabPixelData = 0;
+    m_slabProjectionMode = AccumulatorFactory::Maximum;
+    m_shutterData = 0;
+    m_framePrefetcher = 0;
 }
 
 VolumeDisplayUnit::~VolumeDisplayUnit()
 {
+    // Waits for the frames being computed
+    delete m_framePrefetcher;
     delete m_imagePipeline;
     m_imageSlice->Delete();
     delete m_sliceHandler;
@@ -68,6 +73,8 @@ Volume* VolumeDisplayUnit::getVolume() const
 
 void VolumeDisplayUnit::setVolume(Volume *volume)
 {
+    clearPrefetchedFrames();
+
     m_volume = volume;
     m_sliceHandler->setVolume(volume);
 
@@ -114,6 +121,7 @@ const OrthogonalPlane& VolumeDisplayUnit::getViewPlane() const
 
 void VolumeDisplayUnit::setViewPlane(const OrthogonalPlane &viewPlane)
 {
+    clearPrefetchedFrames();
     m_sliceHandler->setViewPlane(viewPlane);
     m_imagePipeline->setProjectionAxis(viewPlane);
 }
@@ -161,7 +169,14 @@ VolumePixelData* VolumeDisplayUnit::getCurrentPixelData()
         {
             m_currentThickSlabPixelData = new VolumePixelData;
             m_currentThickSlabPixelData->setNumberOfPhases(m_volume->getNumberOfPhases());
-            m_currentThickSlabPixelData->setData(getImagePipeline()->getSlabProjectionOutput());
+            if (m_displayedFrame.slabProjection)
+            {
+                m_currentThickSlabPixelData->setData(m_displayedFrame.slabProjection);
+            }
+            else
+            {
+                m_currentThickSlabPixelData->setData(getImagePipeline()->getSlabProjectionOutput());
+            }
         }
 
         return m_currentThickSlabPixelData;
@@ -212,6 +227,7 @@ void VolumeDisplayUnit::setSlice(int slice)
 {
     m_sliceHandler->setSlice(slice);
     m_imagePipeline->setSlice(m_volume->getImageIndex(getSlice(), getPhase()));
+    updateDisplayedFrame();
 }
 
 int VolumeDisplayUnit::getMinimumSlice() const
@@ -238,6 +254,7 @@ void VolumeDisplayUnit::setPhase(int phase)
 {
     m_sliceHandler->setPhase(phase);
     m_imagePipeline->setSlice(m_volume->getImageIndex(getSlice(), getPhase()));
+    updateDisplayedFrame();
 }
 
 int VolumeDisplayUnit::getNumberOfPhases() const
@@ -254,6 +271,11 @@ void VolumeDisplayUnit::setSlabThickness(int thickness)
 {
     // Make sure thickness is within valid bounds. Must be between 1 and the maximum number of slices on the curren view.
     int admittedThickness = qBound(1, thickness, getNumberOfSlices());
+
+    if (admittedThickness != getSlabThickness())
+    {
+        clearPrefetchedFrames();
+    }
     
     m_sliceHandler->setSlabThickness(admittedThickness);
     m_imagePipeline->setSlice(m_volume->getImageIndex(getSlice(), getPhase()));
@@ -311,14 +333,20 @@ void VolumeDisplayUnit::updateCurrentImageDefaultPresets()
 
 void VolumeDisplayUnit::setVoiLut(const VoiLut &voiLut)
 {
+    VoiLut pipelineVoiLut = voiLut;
     if (m_volume->getImage(0) && m_volume->getImage(0)->getPhotometricInterpretation() == PhotometricInterpretation::Monochrome1)
     {
-        m_imagePipeline->setVoiLut(voiLut.inverse());
+        pipelineVoiLut = voiLut.inverse();
     }
-    else
+
+    // The current preset is set again every time the image changes, prefetched frames are only discarded when it really changes
+    if (pipelineVoiLut != m_pipelineVoiLut)
     {
-        m_imagePipeline->setVoiLut(voiLut);
+        clearPrefetchedFrames();
+        m_pipelineVoiLut = pipelineVoiLut;
     }
+
+    m_imagePipeline->setVoiLut(m_pipelineVoiLut);
 }
 
 void VolumeDisplayUnit::setCurrentVoiLutPreset(const VoiLut &voiLut)
@@ -329,6 +357,8 @@ void VolumeDisplayUnit::setCurrentVoiLutPreset(const VoiLut &voiLut)
 
 void VolumeDisplayUnit::setTransferFunction(const TransferFunction &transferFunction)
 {
+    clearPrefetchedFrames();
+
     if (transferFunction.isEmpty())
     {
         // If an empty transfer function is received, it's interpreted as clearTransferFunction()
@@ -363,18 +393,106 @@ const TransferFunction& VolumeDisplayUnit::getTransferFunction() const
 
 void VolumeDisplayUnit::clearTransferFunction()
 {
+    clearPrefetchedFrames();
     m_transferFunction.clear();
     m_imagePipeline->clearTransferFunction();
 }
 
 void VolumeDisplayUnit::setSlabProjectionMode(AccumulatorFactory::AccumulatorType accumulatorType)
 {
+    if (accumulatorType != m_slabProjectionMode)
+    {
+        clearPrefetchedFrames();
+        m_slabProjectionMode = accumulatorType;
+    }
+
     m_imagePipeline->setSlabProjectionMode(accumulatorType);
 }
 
 void VolumeDisplayUnit::setShutterData(vtkImageData *shutterData)
 {
+    if (shutterData != m_shutterData)
+    {
+        clearPrefetchedFrames();
+        m_shutterData = shutterData;
+    }
+
     m_imagePipeline->setShutterData(shutterData);
 }
 
+void VolumeDisplayUnit::prefetchFrames(const QList<int> &imageIndices)
+{
+    // Display shutters aren't shown with thick slab, so the prefetcher doesn't have to apply them
+    if (!m_volume || !m_volume->isPixelDataLoaded() || !isThickSlabActive() || m_shutterData)
+    {
+        return;
+    }
+
+    if (!m_framePrefetcher)
+    {
+        m_framePrefetcher = new CineFramePrefetcher();
+    }
+
+    if (!m_framePrefetcher->hasPipelineSettings())
+    {
+        CineFramePrefetcher::PipelineSettings settings;
+        settings.input = m_volume->getVtkData();
+        settings.projectionAxis = getViewPlane();
+        settings.slabThickness = getSlabThickness();
+        settings.slabStride = getNumberOfPhases();
+        settings.slabProjectionMode = m_slabProjectionMode;
+        settings.voiLut = m_pipelineVoiLut;
+        settings.transferFunction = m_transferFunction;
+        m_framePrefetcher->setPipelineSettings(settings);
+    }
+
+    m_framePrefetcher->prefetch(imageIndices);
+}
+
+void VolumeDisplayUnit::clearPrefetchedFrames()
+{
+    if (m_framePrefetcher)
+    {
+        m_framePrefetcher->invalidate();
+    }
+
+    if (m_displayedFrame.output)
+    {
+        displayImagePipelineOutput();
+    }
+}
+
+void VolumeDisplayUnit::updateDisplayedFrame()
+{
+    CineFramePrefetcher::Frame frame;
+    if (m_framePrefetcher)
+    {
+        frame = m_framePrefetcher->getFrame(m_volume->getImageIndex(getSlice(), getPhase()));
+    }
+
+    if (frame.output)
+    {
+        m_imageSlice->GetMapper()->SetInputData(frame.output);
+        if (m_currentThickSlabPixelData && frame.slabProjection)
+        {
+            m_currentThickSlabPixelData->setData(frame.slabProjection);
+        }
+        m_displayedFrame = frame;
+    }
+    else if (m_displayedFrame.output)
+    {
+        displayImagePipelineOutput();
+    }
+}
+
+void VolumeDisplayUnit::displayImagePipelineOutput()
+{
+    m_imageSlice->GetMapper()->SetInputConnection(m_imagePipeline->getOutput().getVtkAlgorithmOutput());
+    if (m_currentThickSlabPixelData)
+    {
+        m_currentThickSlabPixelData->setData(m_imagePipeline->getSlabProjectionOutput());
+    }
+    m_displayedFrame = CineFramePrefetcher::Frame();
+}
+
 }
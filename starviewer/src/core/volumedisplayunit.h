@@ -16,7 +16,11 @@
 #define VOLUMEDISPLAYUNIT_H
 
 #include "accumulator.h"
+#include "cineframeprefetcher.h"
 #include "transferfunction.h"
+#include "voilut.h"
+
+#include <QList>
 
 class vtkCamera;
 class vtkImageData;
@@ -30,7 +34,6 @@ class ImagePipeline;
 class OrthogonalPlane;
 class SliceHandler;
 class Volume;
-class VoiLut;
 class VoiLutPresetsToolData;
 class VolumePixelData;
 
@@ -140,6 +143,13 @@ public:
     /// Sets the display shutter image data.
     void setShutterData(vtkImageData *shutterData);
 
+    /// Starts computing in the background the frames of the given images (as given by Volume::getImageIndex()), in the order in which they will be
+    /// displayed, so that when one of them becomes the current image it's displayed without running the image pipeline.
+    /// It's only done with thick slab, because otherwise the pipeline output already has all the images.
+    void prefetchFrames(const QList<int> &imageIndices);
+    /// Discards the prefetched frames and displays the output of the image pipeline again.
+    void clearPrefetchedFrames();
+
 protected:
     /// The volume.
     Volume *m_volume;
@@ -156,6 +166,11 @@ private:
 
     void setupPicker();
 
+    /// Displays the prefetched frame of the current image if there is one, or the output of the image pipeline otherwise.
+    void updateDisplayedFrame();
+    /// Displays the output of the image pipeline.
+    void displayImagePipelineOutput();
+
 private:
     /// The image pipeline that processes the volume.
     ImagePipeline *m_imagePipeline;
@@ -171,6 +186,16 @@ private:
 
     /// Holds the current thickslab pixel data
     VolumePixelData *m_currentThickSlabPixelData;
+
+    /// VOI LUT, slab projection mode and shutter data given to the pipeline, kept to set up the pipeline of the frame prefetcher.
+    VoiLut m_pipelineVoiLut;
+    AccumulatorFactory::AccumulatorType m_slabProjectionMode;
+    vtkImageData *m_shutterData;
+
+    /// Computes the frames of the images that will be displayed next during CINE playback. Created when frames are prefetched for the first time.
+    CineFramePrefetcher *m_framePrefetcher;
+    /// Prefetched frame currently displayed, with null output when the output of the image pipeline is displayed.
+    CineFramePrefetcher::Frame m_displayedFrame;
 };
 
 }
@@ -20,48 +20,174 @@
 
 #include <vtkImageChangeInformation.h>
 #include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationObjectBaseKey.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkShortArray.h>
 
 #include "logging.h"
 
 namespace udg {
 
+namespace {
+
+/// Contenidor de píxels d'ITK que fa servir el buffer d'un array de VTK sense copiar-lo i en manté una referència mentre existeix
+class VtkArrayImageContainer : public VolumePixelData::ItkImageType::PixelContainer {
+public:
+    typedef VtkArrayImageContainer Self;
+    typedef VolumePixelData::ItkImageType::PixelContainer Superclass;
+    typedef itk::SmartPointer<Self> Pointer;
+    typedef itk::SmartPointer<const Self> ConstPointer;
+
+    itkNewMacro(Self);
+    itkTypeMacro(VtkArrayImageContainer, ImportImageContainer);
+
+    void setArray(vtkDataArray *array)
+    {
+        m_array = array;
+        this->SetImportPointer(static_cast<VolumePixelData::ItkPixelType*>(array->GetVoidPointer(0)), array->GetNumberOfTuples(), false);
+    }
+
+    vtkDataArray* getArray() const
+    {
+        return m_array;
+    }
+
+protected:
+    VtkArrayImageContainer()
+    {
+    }
+
+    ~VtkArrayImageContainer()
+    {
+    }
+
+private:
+    vtkSmartPointer<vtkDataArray> m_array;
+};
+
+/// Manté viu el contenidor de píxels d'una imatge ITK mentre un array de VTK en fa servir el buffer. Es guarda a la informació de l'array,
+/// que es destrueix amb ell. Es guarda el contenidor i no la imatge perquè si el filtre que l'ha generada es torna a executar, la imatge
+/// allibera el buffer anterior i en reserva un de nou, mentre que el contenidor manté el buffer que fa servir l'array
+class ItkImageReference : public vtkObject {
+public:
+    static ItkImageReference* New();
+    vtkTypeMacro(ItkImageReference, vtkObject);
+
+    /// Clau amb la que es guarda a la informació de l'array
+    static vtkInformationObjectBaseKey* ITK_PIXEL_CONTAINER();
+
+    VolumePixelData::ItkImageType::PixelContainerPointer m_pixelContainer;
+
+protected:
+    ItkImageReference()
+    {
+    }
+
+    ~ItkImageReference()
+    {
+    }
+};
+
+vtkStandardNewMacro(ItkImageReference);
+vtkInformationKeyMacro(ItkImageReference, ITK_PIXEL_CONTAINER, ObjectBase);
+
+}
+
 VolumePixelData::VolumePixelData(QObject *parent) :
     QObject(parent), m_loaded(false)
 {
     setNumberOfPhases(1);
     
     m_imageDataVTK = vtkSmartPointer<vtkImageData>::New();
-
-    m_itkToVtkFilter = ItkToVtkFilterType::New();
-    m_vtkToItkFilter = VtkToItkFilterType::New();
 }
 
 VolumePixelData::ItkImageTypePointer VolumePixelData::getItkData()
 {
-    m_vtkToItkFilter->SetInput(this->getVtkData());
-    try
+    ItkImageTypePointer itkImage = ItkImageType::New();
+
+    vtkImageData *vtkImage = this->getVtkData();
+    vtkDataArray *scalars = vtkImage ? vtkImage->GetPointData()->GetScalars() : 0;
+    if (!scalars || scalars->GetDataType() != VTK_SHORT || scalars->GetNumberOfComponents() != 1)
     {
-        m_vtkToItkFilter->GetImporter()->Update();
+        WARN_LOG("Les dades VTK no són escalars signed short d'un component, no es poden passar a ITK");
+        return itkImage;
     }
-    catch (itk::ExceptionObject &excep)
+
+    int extent[6];
+    vtkImage->GetExtent(extent);
+    ItkImageType::IndexType index;
+    ItkImageType::SizeType size;
+    for (unsigned int i = 0; i < VDimension; i++)
     {
-        WARN_LOG(QString("Excepció en el filtre vtkToItk :: Volume::getItkData() -> ") + excep.GetDescription());
+        index[i] = extent[i * 2];
+        size[i] = extent[i * 2 + 1] - extent[i * 2] + 1;
     }
-    return m_vtkToItkFilter->GetImporter()->GetOutput();
+    ItkImageType::RegionType region(index, size);
+
+    itkImage->SetRegions(region);
+    itkImage->SetOrigin(vtkImage->GetOrigin());
+    itkImage->SetSpacing(vtkImage->GetSpacing());
+
+    // La imatge ITK fa servir el mateix buffer que l'array de VTK, sense còpia
+    VtkArrayImageContainer::Pointer container = VtkArrayImageContainer::New();
+    container->setArray(scalars);
+    itkImage->SetPixelContainer(container);
+
+    return itkImage;
 }
 
 void VolumePixelData::setData(ItkImageTypePointer itkImage)
 {
-    m_itkToVtkFilter->SetInput(itkImage);
-    try
+    if (itkImage.IsNull())
+    {
+        return;
+    }
+
+    ItkImageType::RegionType region = itkImage->GetBufferedRegion();
+    vtkIdType numberOfPixels = region.GetNumberOfPixels();
+    ItkPixelType *buffer = itkImage->GetBufferPointer();
+    if (!buffer && numberOfPixels > 0)
+    {
+        WARN_LOG("La imatge ITK no té el buffer reservat, no es pot passar a VTK");
+        return;
+    }
+
+    vtkSmartPointer<vtkImageData> imageData = vtkSmartPointer<vtkImageData>::New();
+    int extent[6];
+    for (unsigned int i = 0; i < VDimension; i++)
     {
-        m_itkToVtkFilter->Update();
+        extent[i * 2] = region.GetIndex()[i];
+        extent[i * 2 + 1] = region.GetIndex()[i] + region.GetSize()[i] - 1;
     }
-    catch (itk::ExceptionObject &excep)
+    imageData->SetExtent(extent);
+    imageData->SetOrigin(itkImage->GetOrigin()[0], itkImage->GetOrigin()[1], itkImage->GetOrigin()[2]);
+    imageData->SetSpacing(itkImage->GetSpacing()[0], itkImage->GetSpacing()[1], itkImage->GetSpacing()[2]);
+
+    vtkSmartPointer<vtkDataArray> scalars;
+    // Si la imatge ITK ja fa servir el buffer d'un array de VTK (p.ex. l'hem obtingut amb getItkData()), es torna a fer servir aquest array
+    VtkArrayImageContainer *container = dynamic_cast<VtkArrayImageContainer*>(itkImage->GetPixelContainer());
+    if (container && container->getArray()->GetVoidPointer(0) == buffer && container->getArray()->GetNumberOfTuples() == numberOfPixels)
     {
-        WARN_LOG(QString("Excepció en el filtre itkToVtk :: Volume::setData(ItkImageTypePointer itkImage) -> ") + excep.GetDescription());
+        scalars = container->getArray();
     }
-    this->setData(m_itkToVtkFilter->GetOutput());
+    else
+    {
+        // L'array fa servir el buffer de la imatge ITK sense alliberar-lo, i en manté viu el contenidor fins que es destrueix.
+        // Les dades es comparteixen: si s'escriu a la imatge ITK després de cridar aquest mètode, també canvien les dades VTK
+        vtkSmartPointer<vtkShortArray> array = vtkSmartPointer<vtkShortArray>::New();
+        array->SetArray(buffer, numberOfPixels, 1);
+
+        vtkSmartPointer<ItkImageReference> reference = vtkSmartPointer<ItkImageReference>::New();
+        reference->m_pixelContainer = itkImage->GetPixelContainer();
+        array->GetInformation()->Set(ItkImageReference::ITK_PIXEL_CONTAINER(), reference);
+
+        scalars = array;
+    }
+    imageData->GetPointData()->SetScalars(scalars);
+
+    this->setData(imageData);
 }
 
 vtkImageData* VolumePixelData::getVtkData()
@@ -19,15 +19,8 @@
 #include <QVector>
 
 #include <itkImage.h>
+#include <vtkImageData.h>
 #include <vtkSmartPointer.h>
-// Els filtres per passar itk<=>vtk: InsightApplications/auxiliary/vtk --> ho tenim a /tools
-
-// Converts an ITK image into a VTK image and plugs a itk data pipeline to a VTK datapipeline.
-#include "itkImageToVTKImageFilter.h"
-// Converts a VTK image into an ITK image and plugs a vtk data pipeline to an ITK datapipeline.
-#include "itkVTKImageToImageFilter.h"
-
-class vtkImageData;
 
 namespace udg {
 
@@ -37,6 +30,11 @@ class Voxel;
 /**
     Classe que té com a responsabilitat mantenir el pixel data d'un Volume.
     El pixel data d'un volume és el lloc de memòria on es guarden els diferents valors de voxel d'un Volume.
+
+    Les dades en format ITK i VTK comparteixen el mateix buffer, sense còpies: la imatge ITK retornada per getItkData() fa servir directament
+    l'array d'escalars de les dades VTK i en manté una referència, i les dades VTK creades per setData(ItkImageTypePointer) fan servir el buffer
+    de la imatge ITK i la mantenen viva mentre existeixi l'array. Per tant, el buffer s'allibera quan ja no el fa servir cap de les dues.
+    Modificar els vòxels en un format els modifica en l'altre, però si es torna a reservar el buffer d'un dels dos deixen de compartir-lo.
   */
 class VolumePixelData : public QObject {
 Q_OBJECT
@@ -51,7 +49,8 @@ public:
 
     explicit VolumePixelData(QObject *parent = 0);
 
-    /// Assignem/Retornem les dades en format ITK
+    /// Assignem/Retornem les dades en format ITK. En tots dos casos les dades ITK i VTK comparteixen el buffer.
+    /// getItkData() retorna una imatge buida si les dades no són escalars de tipus ItkPixelType d'un sol component
     void setData(ItkImageTypePointer itkImage);
     ItkImageTypePointer getItkData();
 
@@ -130,10 +129,6 @@ public:
     int getNumberOfPoints();
    
 private:
-    /// Filtres per importar/exportar
-    typedef itk::ImageToVTKImageFilter<ItkImageType> ItkToVtkFilterType;
-    typedef itk::VTKImageToImageFilter<ItkImageType> VtkToItkFilterType;
-
     /// Les dades en format vtk
     vtkSmartPointer<vtkImageData> m_imageDataVTK;
 
@@ -142,10 +137,6 @@ private:
 
     /// Number of phases of the pixel data. Its minimum value must be 1
     int m_numberOfPhases;
-    
-    /// Filtres per passar de vtk a itk
-    ItkToVtkFilterType::Pointer m_itkToVtkFilter;
-    VtkToItkFilterType::Pointer m_vtkToItkFilter;
 };
 
 }
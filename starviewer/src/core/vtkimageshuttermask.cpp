@@ -0,0 +1,136 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "vtkimageshuttermask.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+
+namespace udg {
+
+vtkStandardNewMacro(VtkImageShutterMask)
+
+VtkImageShutterMask::VtkImageShutterMask()
+{
+    this->SetNumberOfInputPorts(2);
+}
+
+VtkImageShutterMask::~VtkImageShutterMask()
+{
+}
+
+void VtkImageShutterMask::SetImageInputData(vtkDataObject *input)
+{
+    this->SetInputData(0, input);
+}
+
+void VtkImageShutterMask::SetMaskInputData(vtkDataObject *mask)
+{
+    this->SetInputData(1, mask);
+}
+
+int VtkImageShutterMask::RequestInformation(vtkInformation *vtkNotUsed(request), vtkInformationVector **inputVector, vtkInformationVector *outputVector)
+{
+    vtkInformation *imageInfo = inputVector[0]->GetInformationObject(0);
+    vtkInformation *maskInfo = inputVector[1]->GetInformationObject(0);
+    vtkInformation *outputInfo = outputVector->GetInformationObject(0);
+
+    // The output is the intersection of the image and the mask
+    int extent[6];
+    int maskExtent[6];
+    imageInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
+    maskInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), maskExtent);
+
+    for (int i = 0; i < 3; i++)
+    {
+        extent[2*i] = std::max(extent[2*i], maskExtent[2*i]);
+        extent[2*i+1] = std::min(extent[2*i+1], maskExtent[2*i+1]);
+    }
+
+    outputInfo->Set(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent, 6);
+
+    return 1;
+}
+
+void VtkImageShutterMask::ThreadedRequestData(vtkInformation *vtkNotUsed(request), vtkInformationVector **vtkNotUsed(inputVector),
+                                              vtkInformationVector *vtkNotUsed(outputVector), vtkImageData ***inputData, vtkImageData **outputData,
+                                              int outputExtent[6], int vtkNotUsed(threadId))
+{
+    vtkImageData *image = inputData[0][0];
+    vtkImageData *mask = inputData[1][0];
+    vtkImageData *output = outputData[0];
+
+    // check
+    if (!image || !mask)
+    {
+        vtkErrorMacro("Both the image and the mask are needed.");
+        return;
+    }
+
+    if (mask->GetScalarType() != VTK_UNSIGNED_CHAR || mask->GetNumberOfScalarComponents() != 1)
+    {
+        vtkErrorMacro("Only single component unsigned char masks are supported.");
+        return;
+    }
+
+    if (image->GetScalarType() != output->GetScalarType() || image->GetNumberOfScalarComponents() != output->GetNumberOfScalarComponents())
+    {
+        vtkErrorMacro("The output doesn't have the scalar type of the image.");
+        return;
+    }
+
+    size_t pixelSize = image->GetScalarSize() * image->GetNumberOfScalarComponents();
+    int rowLength = outputExtent[1] - outputExtent[0] + 1;
+
+    for (int z = outputExtent[4]; z <= outputExtent[5]; z++)
+    {
+        for (int y = outputExtent[2]; y <= outputExtent[3]; y++)
+        {
+            const unsigned char *imageRow = static_cast<unsigned char*>(image->GetScalarPointer(outputExtent[0], y, z));
+            const unsigned char *maskRow = static_cast<unsigned char*>(mask->GetScalarPointer(outputExtent[0], y, z));
+            unsigned char *outputRow = static_cast<unsigned char*>(output->GetScalarPointer(outputExtent[0], y, z));
+
+            // Copy or clear each run of visible or masked pixels at once
+            int x = 0;
+            while (x < rowLength)
+            {
+                int runStart = x;
+                bool masked = maskRow[x] != 0;
+                while (x < rowLength && (maskRow[x] != 0) == masked)
+                {
+                    x++;
+                }
+
+                size_t offset = runStart * pixelSize;
+                size_t length = (x - runStart) * pixelSize;
+                if (masked)
+                {
+                    memset(outputRow + offset, 0, length);
+                }
+                else
+                {
+                    memcpy(outputRow + offset, imageRow + offset, length);
+                }
+            }
+        }
+    }
+}
+
+} // namespace udg
@@ -0,0 +1,57 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDG_VTKIMAGESHUTTERMASK_H
+#define UDG_VTKIMAGESHUTTERMASK_H
+
+#include <vtkThreadedImageAlgorithm.h>
+
+namespace udg {
+
+/**
+ * @brief The VtkImageShutterMask class applies a display shutter mask to an image.
+ *
+ * It gives the same result as vtkImageMask with NotMask on, a masked output value of 0 and a mask alpha of 1, i.e. pixels where the mask is 0 are copied
+ * and the rest are set to 0, but instead of blending each component it splits each row of the mask in runs of visible and masked pixels and copies or
+ * clears them as a whole. The image can have any scalar type and number of components, the mask must be a single component unsigned char image.
+ */
+class VtkImageShutterMask : public vtkThreadedImageAlgorithm {
+
+public:
+    vtkTypeMacro(VtkImageShutterMask, vtkThreadedImageAlgorithm)
+
+    static VtkImageShutterMask* New();
+
+    /// Sets the image to be masked.
+    void SetImageInputData(vtkDataObject *input);
+    /// Sets the mask.
+    void SetMaskInputData(vtkDataObject *mask);
+
+protected:
+    VtkImageShutterMask();
+    virtual ~VtkImageShutterMask();
+
+    virtual int RequestInformation(vtkInformation *request, vtkInformationVector **inputVector, vtkInformationVector *outputVector);
+    virtual void ThreadedRequestData(vtkInformation *request, vtkInformationVector **inputVector, vtkInformationVector *outputVector,
+                                     vtkImageData ***inputData, vtkImageData **outputData, int outputExtent[6], int threadId);
+
+private:
+    VtkImageShutterMask(const VtkImageShutterMask&);  // Not implemented.
+    void operator=(const VtkImageShutterMask&);       // Not implemented.
+
+};
+
+} // namespace udg
+
+#endif // UDG_VTKIMAGESHUTTERMASK_H
@@ -15,6 +15,7 @@ HEADERS = qcrashreporter.h \
           crashreportersender.h \
           ../core/settingsregistry.h \
           ../core/settings.h \
+          ../core/settingscache.h \
           ../core/settingsparser.h \
           ../core/defaultsettings.h \
           ../core/coresettings.h \
@@ -26,6 +27,7 @@ SOURCES = crashreporter.cpp \
           qcrashreporter.cpp \
           ../core/settingsregistry.cpp \
           ../core/settings.cpp \
+          ../core/settingscache.cpp \
           ../core/settingsparser.cpp \
           ../core/defaultsettings.cpp \
           ../core/coresettings.cpp \
@@ -20,6 +20,7 @@
 // Per càlculs d'interseccions
 #include "mathtools.h"
 #include "mprsettings.h"
+#include "obliqueresliceengine.h"
 #include "patientbrowsermenu.h"
 #include "q3dviewer.h"
 #include "qexportertool.h"
@@ -38,7 +39,7 @@
 #include <vtkCommand.h>
 // Per portar a l'origen
 #include <vtkImageChangeInformation.h>
-#include <vtkImageReslice.h>
+#include <vtkMatrix4x4.h>
 #include <vtkPlaneSource.h>
 #include <vtkProperty2D.h>
 #include <vtkRenderWindowInteractor.h>
@@ -86,15 +87,6 @@ QMPRExtension::QMPRExtension(QWidget *parent)
 QMPRExtension::~QMPRExtension()
 {
     writeSettings();
-    // Fent això o no sembla que s'allibera la mateixa memòria gràcies als smart pointers
-    if (m_sagitalReslice)
-    {
-        m_sagitalReslice->Delete();
-    }
-    if (m_coronalReslice)
-    {
-        m_coronalReslice->Delete();
-    }
 
     m_transform->Delete();
 
@@ -119,11 +111,6 @@ QMPRExtension::~QMPRExtension()
     m_coronalPlaneSource->Delete();
     m_thickSlabPlaneSource->Delete();
 
-    if (m_pickedActorReslice)
-    {
-        m_pickedActorReslice->Delete();
-    }
-
     if (m_mipViewer)
     {
         delete m_mipViewer;
@@ -499,7 +486,7 @@ void QMPRExtension::switchToMIPLayout(bool isMIPChecked)
         Volume *mipInput = new Volume;
         // TODO Això es necessari perquè tingui la informació de la sèrie, estudis, pacient...
         mipInput->setImages(m_volume->getImages());
-        mipInput->setData(m_coronalReslice->GetOutput());
+        mipInput->setData(m_coronalReslice->getOutput());
         m_mipViewer->setInput(mipInput);
         m_mipViewer->render();
         m_mipViewer->show();
@@ -663,7 +650,6 @@ bool QMPRExtension::detectAxialViewAxisActor()
             m_pickedActorPlaneSource = m_sagitalPlaneSource;
             m_pickedActorReslice = m_sagitalReslice;
         }
-        m_pickedActorReslice->SetInterpolationModeToNearestNeighbor();
         // Desactivem les tools que puguin estar actives
         m_toolManager->disableAllToolsTemporarily();
         m_initialPickX = clickedWorldPoint[0];
@@ -720,7 +706,7 @@ void QMPRExtension::releaseAxialViewAxisActor()
 {
     if (m_pickedActorReslice)
     {
-        m_pickedActorReslice->SetInterpolationModeToCubic();
+        refinePlanes();
         // TODO No seria millor un restoreOverrideCursor?
         m_axial2DView->unsetCursor();
         if (m_pickedActorPlaneSource == m_sagitalPlaneSource)
@@ -765,7 +751,6 @@ void QMPRExtension::detectSagitalViewAxisActor()
     if (distanceToCoronal < PickingDistanceThreshold)
     {
         m_pickedActorReslice = m_coronalReslice;
-        m_pickedActorReslice->SetInterpolationModeToNearestNeighbor();
         m_pickedActorPlaneSource = m_coronalPlaneSource;
         // Desactivem les tools que puguin estar actives
         m_toolManager->disableAllToolsTemporarily();
@@ -839,7 +824,7 @@ void QMPRExtension::releaseSagitalViewAxisActor()
     if (m_pickedActorReslice)
     {
         m_sagital2DView->unsetCursor();
-        m_pickedActorReslice->SetInterpolationModeToCubic();
+        refinePlanes();
         m_coronal2DView->render();
         m_state = None;
         m_pickedActorReslice = 0;
@@ -1017,24 +1002,16 @@ void QMPRExtension::setInput(Volume *input)
 
     m_volume->getSpacing(m_axialSpacing);
 
-    if (m_sagitalReslice)
-    {
-        m_sagitalReslice->Delete();
-    }
-    m_sagitalReslice = vtkImageReslice::New();
-    // Perquè l'extent d'output sigui suficient i no es "mengi" dades
-    m_sagitalReslice->AutoCropOutputOn();
-    m_sagitalReslice->SetInterpolationModeToCubic();
-    m_sagitalReslice->SetInputData(m_volume->getVtkData());
-
-    if (m_coronalReslice)
+    if (!m_sagitalReslice)
     {
-        m_coronalReslice->Delete();
+        // Les previsualitzacions arriben quan ja s'ha retornat de l'event de moviment, per tant cal tornar a pintar en aquell moment
+        m_sagitalReslice = new ObliqueResliceEngine(this);
+        connect(m_sagitalReslice, SIGNAL(outputUpdated()), m_sagital2DView, SLOT(render()));
+        m_coronalReslice = new ObliqueResliceEngine(this);
+        connect(m_coronalReslice, SIGNAL(outputUpdated()), m_coronal2DView, SLOT(render()));
     }
-    m_coronalReslice = vtkImageReslice::New();
-    m_coronalReslice->AutoCropOutputOn();
-    m_coronalReslice->SetInterpolationModeToCubic();
-    m_coronalReslice->SetInputData(m_volume->getVtkData());
+    m_sagitalReslice->setInput(m_volume->getVtkData());
+    m_coronalReslice->setInput(m_volume->getVtkData());
 
     // Faltaria refrescar l'input dels 3 mpr
     // HACK To make universal scrolling work properly. Issue #2019. We have to disconnect and reconnect the signal to avoid infinite loops
@@ -1056,7 +1033,7 @@ void QMPRExtension::setInput(Volume *input)
     Volume *sagitalResliced = new Volume;
     // TODO Això es necessari perquè tingui la informació de la sèrie, estudis, pacient...
     sagitalResliced->setImages(m_volume->getImages());
-    sagitalResliced->setData(m_sagitalReslice->GetOutput());
+    sagitalResliced->setData(m_sagitalReslice->getOutput());
     sagitalResliced->setNumberOfPhases(1);
     sagitalResliced->setNumberOfSlicesPerPhase(1);
 
@@ -1065,7 +1042,7 @@ void QMPRExtension::setInput(Volume *input)
     Volume *coronalResliced = new Volume;
     // TODO Això es necessari perquè tingui la informació de la sèrie, estudis, pacient...
     coronalResliced->setImages(m_volume->getImages());
-    coronalResliced->setData(m_coronalReslice->GetOutput());
+    coronalResliced->setData(m_coronalReslice->getOutput());
     coronalResliced->setNumberOfPhases(1);
     coronalResliced->setNumberOfSlicesPerPhase(1);
 
@@ -1454,9 +1431,15 @@ void QMPRExtension::updatePlanes()
     updatePlane(m_coronalPlaneSource, m_coronalReslice, m_coronalExtentLength);
 }
 
-void QMPRExtension::updatePlane(vtkPlaneSource *planeSource, vtkImageReslice *reslice, int extentLength[2])
+void QMPRExtension::refinePlanes()
 {
-    if (!reslice || !(vtkImageData::SafeDownCast(reslice->GetInput())))
+    m_sagitalReslice->requestRefinement();
+    m_coronalReslice->requestRefinement();
+}
+
+void QMPRExtension::updatePlane(vtkPlaneSource *planeSource, ObliqueResliceEngine *reslice, int extentLength[2])
+{
+    if (!reslice)
     {
         return;
     }
@@ -1568,17 +1551,25 @@ void QMPRExtension::updatePlane(vtkPlaneSource *planeSource, vtkImageReslice *re
     resliceAxes->SetElement(1, 3, neworiginXYZW[1]);
     resliceAxes->SetElement(2, 3, neworiginXYZW[2]);
 
-    reslice->SetResliceAxes(resliceAxes);
+    reslice->setResliceAxes(resliceAxes);
 
     resliceAxes->Delete();
 
-    reslice->SetOutputSpacing(planeSizeX / extentLength[0], planeSizeY / extentLength[1], 1.0);
-    reslice->SetOutputOrigin(0.0, 0.0, 0.0);
+    reslice->setOutputSpacing(planeSizeX / extentLength[0], planeSizeY / extentLength[1], 1.0);
     // TODO Li passem thickSlab que és double però això només accepta int's! Buscar si aquesta és la manera adequada. Potsre si volem fer servir doubles
     // ho hauríem de combinar amb l'outputSpacing
     // Obtenim una única llesca
-    reslice->SetOutputExtent(0, extentLength[0] - 1, 0, extentLength[1] - 1, 0, static_cast<int>(m_thickSlab));
-    reslice->Update();
+    reslice->setOutputDimensions(extentLength[0], extentLength[1], static_cast<int>(m_thickSlab) + 1);
+
+    // Mentre s'arrossega un pla el reslice es calcula en segon pla a menys resolució, i en deixar-lo anar es refina
+    if (m_state == None)
+    {
+        reslice->update();
+    }
+    else
+    {
+        reslice->requestPreview();
+    }
 }
 
 void QMPRExtension::getSagitalXVector(double x[3])
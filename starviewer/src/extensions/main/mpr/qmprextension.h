@@ -21,7 +21,6 @@
 class QAction;
 class QStringList;
 class vtkAxisActor2D;
-class vtkImageReslice;
 class vtkPlaneSource;
 class vtkTransform;
 
@@ -29,6 +28,7 @@ namespace udg {
 
 // FWD declarations
 class DrawerPoint;
+class ObliqueResliceEngine;
 class ToolManager;
 class Q3DViewer;
 class Volume;
@@ -92,8 +92,11 @@ private:
     /// TODO: separar en dos mètodes diferenciats segons quin pla????
     void updatePlanes();
 
-    /// Actualitza els valors del pla donat amb el reslice associat
-    void updatePlane(vtkPlaneSource *planeSource, vtkImageReslice *reslice, int extentLength[2]);
+    /// Actualitza els valors del pla donat amb el reslice associat. Mentre s'està interactuant amb els plans només es demana una previsualització
+    void updatePlane(vtkPlaneSource *planeSource, ObliqueResliceEngine *reslice, int extentLength[2]);
+
+    /// Acaba el moviment d'un pla: es demana el reslice a qualitat completa dels plans que només tenen la previsualització
+    void refinePlanes();
 
     /// Inicialitza les orientacions dels plans de tall correctament perquè tinguin un espaiat, dimensions i límits correctes
     void initOrientation();
@@ -194,7 +197,7 @@ private:
     static const double PickingDistanceThreshold;
 
     /// El reslice de cada vista
-    vtkImageReslice *m_sagitalReslice, *m_coronalReslice;
+    ObliqueResliceEngine *m_sagitalReslice, *m_coronalReslice;
 
     /// La tranformació que apliquem
     vtkTransform *m_transform;
@@ -236,7 +239,7 @@ private:
     /// Cosetes per controlar el moviment del plans a partir de l'interacció de l'usuari
     double m_initialPickX, m_initialPickY;
     vtkPlaneSource *m_pickedActorPlaneSource;
-    vtkImageReslice *m_pickedActorReslice;
+    ObliqueResliceEngine *m_pickedActorReslice;
 
     /// Gruix del thickSlab que servirà per al MIP
     double m_thickSlab;
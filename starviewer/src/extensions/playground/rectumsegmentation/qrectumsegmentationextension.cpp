@@ -16,7 +16,7 @@
 #include "editortooldata.h"
 #include "rectumsegmentationsettings.h"
 #include "patientbrowsermenu.h"
-#include "volumepixeldataiterator.h"
+#include "regiongrowing.h"
 
 //Qt
 #include <QString>
@@ -519,26 +519,12 @@ void QRectumSegmentationExtension::updateVolumeForced()
 {
     if(m_resultsLineEdit->isEnabled())
     {
-        int ext[6];
-        int i,j,k;
-        int cont = 0;
-        m_2DView->getOverlayInput()->getExtent(ext);
-    
-        VolumePixelDataIterator it = m_2DView->getOverlayInput()->getIterator();
-        for(i=ext[0];i<=ext[1];i++)
-        {
-            for(j=ext[2];j<=ext[3];j++)
-            {
-                for(k=ext[4];k<=ext[5];k++)
-                {
-                    if (it.get<int>() == m_insideValue)
-                    {
-                        cont++;
-                    }
-                    ++it;
-                }
-            }
-        }
+        Volume *overlay = m_2DView->getOverlayInput();
+        int dimensions[3];
+        overlay->getDimensions(dimensions);
+        qint64 numberOfVoxels = static_cast<qint64>(dimensions[0]) * dimensions[1] * dimensions[2];
+        qint64 cont = RegionGrowing::countVoxels(static_cast<RegionGrowing::VoxelType*>(overlay->getScalarPointer()), numberOfVoxels,
+                                                 m_insideValue, m_insideValue);
         double spacing[3];
         m_lesionMaskVolume->getSpacing(spacing);
         double volume = 1.0;
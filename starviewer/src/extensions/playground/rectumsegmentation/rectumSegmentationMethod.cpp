@@ -44,8 +44,10 @@
 #include <vtkImageData.h>
 
 #include <QMessageBox>
+#include <QVector>
 
 #include "logging.h"
+#include "regiongrowing.h"
 
 namespace udg {
 
@@ -460,31 +462,42 @@ void rectumSegmentationMethod::applyMethodNextSlice(unsigned int slice, int step
     itk::ImageRegionIteratorWithIndex< InternalImageType > itPrevious(extracterPrevious->GetOutput(), extracterPrevious->GetOutput()->GetLargestPossibleRegion());
     itk::ImageRegionIteratorWithIndex< InternalImageType > itRegion(regionThreshold, regionThreshold->GetLargestPossibleRegion());
 
-    itRegion.GoToBegin();
-    //std::cout<<"Init Region..."<<std::endl;
-    while(!itRegion.IsAtEnd())
+    // Vòxels candidats: els de la dilatació dins la ROI. Es troben les seves components connexes i es queden les que toquen la màscara de la
+    // llesca anterior, sense recursivitat
+    InternalImageType::SizeType sliceSize = regionThreshold->GetLargestPossibleRegion().GetSize();
+    int sliceDimensions[3] = { static_cast<int>(sliceSize[0]), static_cast<int>(sliceSize[1]), 1 };
+    QVector<RegionGrowing::VoxelType> candidates(sliceDimensions[0] * sliceDimensions[1], 0);
+
+    itDilate.GoToBegin();
+    for (int k = 0; !itDilate.IsAtEnd(); ++itDilate, k++)
     {
-        itRegion.Set(m_outsideMaskValue);
-        ++itRegion;
+        InternalImageType::IndexType index = itDilate.GetIndex();
+        if (itDilate.Get() == m_insideMaskValue && index[0] >= m_minROI[0] && index[0] <= m_maxROI[0] && index[1] >= m_minROI[1] && index[1] <= m_maxROI[1])
+        {
+            candidates[k] = 1;
+        }
     }
 
-    itDilate.GoToBegin();
+    QVector<int> labels(candidates.size());
+    RegionGrowing regionGrowing(candidates.data(), sliceDimensions);
+    int numberOfRegions = regionGrowing.labelConnectedComponents(labels.data()).size();
+
+    QVector<bool> selectedRegions(numberOfRegions + 1, false);
     itPrevious.GoToBegin();
-    itRegion.GoToBegin();
-    //std::cout<<"Init Recorregut..."<<std::endl;
-    while(!itDilate.IsAtEnd())
+    for (int k = 0; !itPrevious.IsAtEnd(); ++itPrevious, k++)
     {
-        if((itDilate.Get()==m_insideMaskValue)&&(itPrevious.Get()==m_insideMaskValue)&&(itRegion.Get()!=m_insideMaskValue))
+        if (itPrevious.Get() == m_insideMaskValue)
         {
-            //std::cout<<"Crida a regionGrowingRecursive a "<<itDilate.GetIndex()[0]<<", "<<itDilate.GetIndex()[1]<<" [ "<<regionThreshold->GetLargestPossibleRegion().GetSize()<<std::endl;
-            //Primer ho desem en atributs de la classe així ja no s'ha de passar per paràmetre
-            m_maskrecursive = regionThreshold;
-            m_imrecursive = binaryDilate->GetOutput();
-            this->regionGrowingRecursive(itDilate.GetIndex()[0], itDilate.GetIndex()[1],0);
+            selectedRegions[labels[k]] = true;
         }
-        ++itDilate;
-        ++itPrevious;
-        ++itRegion;
+    }
+    // El fons no és cap regió
+    selectedRegions[0] = false;
+
+    itRegion.GoToBegin();
+    for (int k = 0; !itRegion.IsAtEnd(); ++itRegion, k++)
+    {
+        itRegion.Set(selectedRegions[labels[k]] ? m_insideMaskValue : m_outsideMaskValue);
     }
 
 
@@ -529,37 +542,6 @@ void rectumSegmentationMethod::applyMethodNextSlice(unsigned int slice, int step
     return;
 }
 
-void rectumSegmentationMethod::regionGrowingRecursive(int indexX, int indexY , int prof)
-{
-    itk::ImageRegionIteratorWithIndex< InternalImageType > itIm(m_imrecursive, m_imrecursive->GetLargestPossibleRegion());
-    itk::ImageRegionIteratorWithIndex< InternalImageType > itMask(m_maskrecursive, m_maskrecursive->GetLargestPossibleRegion());
-    InternalImageType::IndexType index;
-    index[0]=indexX;
-    index[1]=indexY;
-
-    itIm.SetIndex(index);
-    itMask.SetIndex(index);
-    //if((itIm.Get()>=m_lowerThreshold)&&(itIm.Get()<=m_upperThreshold)&&(itMask.Get()!=m_insideMaskValue))
-    //if((itIm.Get()==m_insideMaskValue)&&(itMask.Get()!=m_insideMaskValue))
-    if((itIm.Get()==m_insideMaskValue)&&(itMask.Get()!=m_insideMaskValue)&& (indexX>=m_minROI[0])&&(indexX<=m_maxROI[0])&&(indexY>=m_minROI[1])&&(indexY<=m_maxROI[1])&&prof<=2000)
-    {
-        //std::cout<<"->Set "<<std::endl;
-        itMask.Set(m_insideMaskValue);
-        if(indexX+1 < (int)m_maskrecursive->GetLargestPossibleRegion().GetSize()[0])
-            regionGrowingRecursive(indexX + 1, indexY, prof +1);
-        if(indexX > 0)
-            regionGrowingRecursive(indexX - 1, indexY, prof +1);
-        if(indexY+1 < (int)m_maskrecursive->GetLargestPossibleRegion().GetSize()[1])
-            regionGrowingRecursive(indexX, indexY + 1, prof +1);
-        if(indexY > 0)
-            regionGrowingRecursive(indexX, indexY - 1, prof +1);
-    }
-    else
-    {
-      //  std::cout<<"*"<<std::endl;
-    }
-}
-
 void rectumSegmentationMethod::applyFilter(Volume* output)
 {
     typedef   float           InternalPixelType;
@@ -30,8 +30,6 @@ public:
 
     void applyMethodNextSlice(unsigned int slice, int step);
 
-    void regionGrowingRecursive(int indexX, int indexY, int prof);
-
     void applyFilter(Volume* output);
 
     int getNumberOfVoxels() {return m_cont;}
@@ -66,9 +64,6 @@ private:
     Volume* m_Mask;
     Volume* m_filteredInputImage;
 
-    InternalImageType::Pointer m_maskrecursive;
-    InternalImageType::Pointer m_imrecursive;
-
     ///Posició de la llavor
     double m_px, m_py, m_pz;
 
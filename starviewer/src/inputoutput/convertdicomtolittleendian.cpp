@@ -21,6 +21,7 @@
 #include <dctk.h>
 #include <ofconapp.h>
 #include <QDir>
+#include <QFile>
 
 #ifdef HAVE_GUSI_H
 #include <GUSI.h>
@@ -31,15 +32,89 @@
 
 namespace udg {
 
+namespace {
+
+// Extensió del fitxer temporal on s'escriu el fitxer convertit abans de donar-li el nom definitiu
+const QString TemporaryFileSuffix(".part");
+
+}
+
 ConvertDicomToLittleEndian::ConvertDicomToLittleEndian()
 {
+    m_copyFilesInLittleEndian = false;
 }
 
 ConvertDicomToLittleEndian::~ConvertDicomToLittleEndian()
 {
 }
 
+void ConvertDicomToLittleEndian::setCopyFilesInLittleEndian(bool copyFilesInLittleEndian)
+{
+    m_copyFilesInLittleEndian = copyFilesInLittleEndian;
+}
+
+bool ConvertDicomToLittleEndian::getCopyFilesInLittleEndian() const
+{
+    return m_copyFilesInLittleEndian;
+}
+
 Status ConvertDicomToLittleEndian::convert(QString inputFile, QString outputFile)
+{
+    Status state;
+    QString temporaryFile = outputFile + TemporaryFileSuffix;
+    QFile::remove(temporaryFile);
+
+    if (m_copyFilesInLittleEndian && isInExplicitLittleEndian(inputFile))
+    {
+        // Ja està en el format que es demana, no cal descodificar-lo ni tornar-lo a escriure
+        if (!QFile::copy(inputFile, temporaryFile))
+        {
+            QString descriptionError = QString("Unable to copy file from %1 to %2").arg(inputFile, temporaryFile);
+            ERROR_LOG(descriptionError);
+            return state.setStatus(descriptionError, false, 3001);
+        }
+    }
+    else
+    {
+        state = convertToTemporaryFile(inputFile, temporaryFile);
+        if (!state.good())
+        {
+            QFile::remove(temporaryFile);
+            return state;
+        }
+    }
+
+    if (!renameTemporaryFile(temporaryFile, outputFile))
+    {
+        QString descriptionError = QString("Unable to rename file %1 to %2").arg(temporaryFile, outputFile);
+        ERROR_LOG(descriptionError);
+        QFile::remove(temporaryFile);
+        return state.setStatus(descriptionError, false, 3001);
+    }
+
+    return state.setStatus("", true, 0);
+}
+
+bool ConvertDicomToLittleEndian::isInExplicitLittleEndian(const QString &file)
+{
+    // Només es llegeix la capçalera del fitxer, on hi ha la Transfer Syntax
+    DcmFileFormat fileformat;
+    OFCondition error = fileformat.loadFile(qPrintable(QDir::toNativeSeparators(file)), EXS_Unknown, EGL_noChange, DCM_MaxReadLength, ERM_metaOnly);
+    if (error.bad())
+    {
+        return false;
+    }
+
+    OFString transferSyntaxUID;
+    if (fileformat.getMetaInfo()->findAndGetOFString(DCM_TransferSyntaxUID, transferSyntaxUID).bad())
+    {
+        return false;
+    }
+
+    return transferSyntaxUID == UID_LittleEndianExplicitTransferSyntax;
+}
+
+Status ConvertDicomToLittleEndian::convertToTemporaryFile(const QString &inputFile, const QString &temporaryFile)
 {
     DcmFileFormat fileformat;
     DcmDataset *dataset = fileformat.getDataset();
@@ -78,16 +153,27 @@ Status ConvertDicomToLittleEndian::convert(QString inputFile, QString outputFile
         return state;
     }
 
-    error = fileformat.saveFile(qPrintable(QDir::toNativeSeparators(outputFile)), opt_oxfer, opt_oenctype, opt_oglenc, opt_opadenc,
+    error = fileformat.saveFile(qPrintable(QDir::toNativeSeparators(temporaryFile)), opt_oxfer, opt_oenctype, opt_oglenc, opt_opadenc,
                                 OFstatic_cast(Uint32, opt_filepad), OFstatic_cast(Uint32, opt_itempad), writeMode);
 
     if (!error.good())
     {
         ERROR_LOG(QString("S'ha produit un error al intentar gravar la imatge %1 convertida a LittleEndian al path %2, descripcio error: %3")
-                     .arg(inputFile, outputFile, error.text()));
+                     .arg(inputFile, temporaryFile, error.text()));
     }
 
     return state.setStatus(error);
 }
 
+bool ConvertDicomToLittleEndian::renameTemporaryFile(const QString &temporaryFile, const QString &outputFile)
+{
+    // QFile::rename no sobreescriu fitxers existents
+    if (QFile::exists(outputFile) && !QFile::remove(outputFile))
+    {
+        return false;
+    }
+
+    return QFile::rename(temporaryFile, outputFile);
+}
+
 }
@@ -23,11 +23,20 @@ class Status;
 
 /**
     Converteix les imatges guardades al format littleEndian, necessari per crear els DicomDir
+
+    Each conversion has its own DCMTK file and decoding state, so several files can be converted at the same time from different threads, as long
+    as the decoders have been registered beforehand. The converted file is written to a temporary file next to the output file, which is renamed
+    when it's complete, so the output file never exists half written.
   */
 class ConvertDicomToLittleEndian {
 public:
     ConvertDicomToLittleEndian();
 
+    /// Sets/gets whether files that are already in explicit VR little endian are copied as they are, without decoding them and writing them again.
+    /// Only the meta header of the file is read to decide it. False by default
+    void setCopyFilesInLittleEndian(bool copyFilesInLittleEndian);
+    bool getCopyFilesInLittleEndian() const;
+
     /// Converteix el fitxer d'entrada dicom a format little endian i el guarda, amb el nom i directori que s'indiqui a outputfile
     /// @param inputFile  ruta completa del fitxer a convertir
     /// @param outputFile ruta completa indicant on s'ha de desar el fitxer convertit, s'hi ha d'incloure el nom del fitxer
@@ -35,6 +44,19 @@ public:
     Status convert(QString inputFile, QString outputFile);
 
     ~ConvertDicomToLittleEndian();
+
+private:
+    /// Returns true if the meta header of the given file says it's in explicit VR little endian
+    static bool isInExplicitLittleEndian(const QString &file);
+
+    /// Converts the input file and saves it to the given temporary file
+    Status convertToTemporaryFile(const QString &inputFile, const QString &temporaryFile);
+
+    /// Replaces the output file with the temporary one. Returns false if it can't be done
+    static bool renameTemporaryFile(const QString &temporaryFile, const QString &outputFile);
+
+private:
+    bool m_copyFilesInLittleEndian;
 };
 
 }
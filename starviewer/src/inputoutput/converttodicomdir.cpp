@@ -17,6 +17,9 @@
 #include <QProgressDialog>
 #include <QTextStream>
 #include <QFile>
+#include <QEventLoop>
+#include <QThread>
+#include <QtConcurrentRun>
 
 #include "logging.h"
 #include "status.h"
@@ -33,6 +36,16 @@
 
 namespace udg {
 
+namespace {
+
+// Màxim de threads que copien imatges alhora
+const int MaximumNumberOfCopyThreads = 4;
+
+// Màxim de threads que converteixen imatges a little endian alhora. Cadascun té una imatge descodificada en memòria
+const int MaximumNumberOfConversionThreads = 8;
+
+}
+
 ConvertToDicomdir::ConvertToDicomdir()
 {
     m_study = 0;
@@ -60,22 +73,12 @@ void ConvertToDicomdir::addStudy(const QString &studyUID)
     int index = 0;
     bool stop = false;
 
-    LocalDatabaseManager localDatabaseManager;
-    DicomMask studyMask;
-    studyMask.setStudyInstanceUID(studyUID);
-    QList<Patient*> patientList = localDatabaseManager.queryPatientStudy(studyMask);
-    if (localDatabaseManager.getLastError() != LocalDatabaseManager::Ok)
+    Patient *patient = queryPatientStudy(studyUID);
+    if (!patient)
     {
-        ERROR_LOG(QString("Error al afegir un study per generar un DICOMDIR; Error: %1; StudyUID: %2")
-                  .arg(localDatabaseManager.getLastError())
-                  .arg(studyUID));
         return;
     }
 
-    // \TODO Això s'ha de fer perquè queryPatientStudy retorna llista de Patients
-    // Nosaltres, en realitat només en volem un.
-    Patient *patient = patientList.first();
-
     studyToConvert.studyUID = studyUID;
     studyToConvert.patientId = patient->getID();
 
@@ -127,28 +130,15 @@ Status ConvertToDicomdir::convert(const QString &dicomdirPath, CreateDicomdir::r
         return state;
     }
 
-    DicomMask studyMask;
     QList<Study*> studyList;
 
-    LocalDatabaseManager localDatabaseManager;
-
     foreach (StudyToConvert studyToConvert, m_studiesToConvert)
     {
-        studyMask.setStudyInstanceUID(studyToConvert.studyUID);
-        Patient *patient = localDatabaseManager.retrieve(studyMask);
-        if (localDatabaseManager.getLastError() != LocalDatabaseManager::Ok)
+        Patient *patient = retrievePatientStudy(studyToConvert.studyUID, state);
+        if (!state.good())
         {
-            ERROR_LOG(QString("No s'han trobat les dades del estudi %1 a la base de dades ").arg(studyToConvert.studyUID));
-            QString error = QString("Error al fer un retrieve study per generar un DICOMDIR; Error: %1; StudyUID: %2")
-                    .arg(localDatabaseManager.getLastError())
-                    .arg(studyToConvert.studyUID);
-            state.setStatus(error, false, -1);
             break;
         }
-        else
-        {
-            state.setStatus("", true, -1);
-        }
 
         // \TODO Això de patient->getStudies().first s'ha de fer perquè queryPatientStudy retorna llista de Patients
         // Nosaltres, en realitat només en volem un sol study.
@@ -240,6 +230,46 @@ Status ConvertToDicomdir::convert(const QString &dicomdirPath, CreateDicomdir::r
     return state;
 }
 
+Patient* ConvertToDicomdir::queryPatientStudy(const QString &studyUID)
+{
+    LocalDatabaseManager localDatabaseManager;
+    DicomMask studyMask;
+    studyMask.setStudyInstanceUID(studyUID);
+    QList<Patient*> patientList = localDatabaseManager.queryPatientStudy(studyMask);
+    if (localDatabaseManager.getLastError() != LocalDatabaseManager::Ok || patientList.isEmpty())
+    {
+        ERROR_LOG(QString("Error al afegir un study per generar un DICOMDIR; Error: %1; StudyUID: %2")
+                  .arg(localDatabaseManager.getLastError())
+                  .arg(studyUID));
+        qDeleteAll(patientList);
+        return NULL;
+    }
+
+    // \TODO Això s'ha de fer perquè queryPatientStudy retorna llista de Patients
+    // Nosaltres, en realitat només en volem un.
+    return patientList.first();
+}
+
+Patient* ConvertToDicomdir::retrievePatientStudy(const QString &studyUID, Status &state)
+{
+    LocalDatabaseManager localDatabaseManager;
+    DicomMask studyMask;
+    studyMask.setStudyInstanceUID(studyUID);
+    Patient *patient = localDatabaseManager.retrieve(studyMask);
+    if (localDatabaseManager.getLastError() != LocalDatabaseManager::Ok)
+    {
+        ERROR_LOG(QString("No s'han trobat les dades del estudi %1 a la base de dades ").arg(studyUID));
+        QString error = QString("Error al fer un retrieve study per generar un DICOMDIR; Error: %1; StudyUID: %2")
+                .arg(localDatabaseManager.getLastError())
+                .arg(studyUID);
+        state.setStatus(error, false, -1);
+        return NULL;
+    }
+
+    state.setStatus("", true, -1);
+    return patient;
+}
+
 Status ConvertToDicomdir::createDicomdir(const QString &dicomdirPath, CreateDicomdir::recordDeviceDicomDir selectedDevice)
 {
     CreateDicomdir createDicomdir;
@@ -254,14 +284,21 @@ Status ConvertToDicomdir::createDicomdir(const QString &dicomdirPath, CreateDico
     createDicomdir.setCheckTransferSyntax(getConvertDicomdirImagesToLittleEndian());
 
     createDicomdir.setDevice(selectedDevice);
+    // Ja sabem quins fitxers s'han copiat, no cal tornar a recórrer el directori per trobar-los
+    QStringList files;
+    foreach (const ImageToCopy &item, m_imagesToCopy)
+    {
+        files << QDir::cleanPath(item.destinationPath).mid(QDir::cleanPath(dicomdirPath).length() + 1);
+    }
+
     // Invoquem el mètode per convertir el directori destí Dicomdir on ja s'han copiat les imatges en un dicomdir
-    state = createDicomdir.create(dicomdirPath);
+    state = createDicomdir.create(dicomdirPath, files);
     // Ha fallat crear el dicomdir, ara intentem crear-lo en mode no estricte
     if (!state.good())
     {
         WARN_LOG("Algunes de les imatges no compleixen l'estandard DICOM al 100% es provara de crear el DICOMDIR sense el mode estricte");
         createDicomdir.setStrictMode(false);
-        state = createDicomdir.create(dicomdirPath);
+        state = createDicomdir.create(dicomdirPath, files);
         if (state.good())
         {
             return stateNotDicomConformance.setStatus("Alguna de les imatges no complia l'estàndard DICOM", false, 4001);
@@ -313,7 +350,9 @@ Status ConvertToDicomdir::copyStudiesToDicomdirPath(QList<Study*> studyList)
     Study *study;
 
     m_patient = 0;
+    m_imagesToCopy.clear();
 
+    // Primer es creen els directoris i es decideix el nom de cada imatge, en el mateix ordre que abans, i després es copien totes les imatges
     // Agrupem estudis1 per pacient, com que tenim la llista ordenada per patientId
     while (!m_studiesToConvert.isEmpty())
     {
@@ -328,6 +367,7 @@ Status ConvertToDicomdir::copyStudiesToDicomdirPath(QList<Study*> studyList)
         {
             state.setStatus("La xapussa del copyStudiesToDicomdirPath no funciona, hi ha ordre diferent entre la llista studyList i m_studiesToConvert",
                             false, -1);
+            delete study;
             break;
         }
 
@@ -343,26 +383,29 @@ Status ConvertToDicomdir::copyStudiesToDicomdirPath(QList<Study*> studyList)
             m_patientDirectories.push_back(m_dicomdirPatientPath);
         }
 
-        state = copyStudyToDicomdirPath(study);
+        addStudyImagesToCopy(study);
 
         delete study;
-        if (!state.good())
-        {
-            break;
-        }
         m_OldPatientId = studyToConvert.patientId;
     }
 
+    // Alliberem els estudis que no s'han arribat a tractar
+    qDeleteAll(studyList);
+
+    if (state.good())
+    {
+        state = copyImagesToDicomdirPath();
+    }
+
     return state;
 }
 
-Status ConvertToDicomdir::copyStudyToDicomdirPath(Study *study)
+void ConvertToDicomdir::addStudyImagesToCopy(Study *study)
 {
     // Creem el directori de l'estudi on es mourà un estudi seleccionat per convertir a dicomdir
     QDir studyDir;
     QChar fillChar = '0';
     QString studyName = QString("/STU%1").arg(m_study, 5, 10, fillChar);
-    Status state;
 
     m_study++;
     m_series = 0;
@@ -376,39 +419,28 @@ Status ConvertToDicomdir::copyStudyToDicomdirPath(Study *study)
     {
         if (series->getNumberOfItems() > 0)
         {
-            state = copySeriesToDicomdirPath(series);
-
-            if (!state.good())
-            {
-                break;
-            }
+            addSeriesImagesToCopy(series);
         }
     }
-
-    return state;
 }
 
-Status ConvertToDicomdir::copySeriesToDicomdirPath(Series *series)
+void ConvertToDicomdir::addSeriesImagesToCopy(Series *series)
 {
     QDir seriesDir;
     QChar fillChar = '0';
     // Creem el nom del directori de la sèrie, el format és SERXXXXX, on XXXXX és el numero de sèrie dins l'estudi
     QString seriesName = QString("/SER%1").arg(m_series, 5, 10, fillChar);
-    Status state;
 
     m_series++;
     // Creem el directori on es guardarà la sèrie en format DicomDir
     m_dicomDirSeriesPath = m_dicomDirStudyPath + seriesName;
     seriesDir.mkdir(m_dicomDirSeriesPath);
 
-    state = copyImages(series->getImages());
-
-    return state;
+    addImagesToCopy(series->getImages());
 }
 
-Status ConvertToDicomdir::copyImages(QList<Image*> images)
+void ConvertToDicomdir::addImagesToCopy(const QList<Image*> &images)
 {
-    Status state;
     m_currentItemNumber = 0;
     // HACK per evitar els casos en que siguin imatges procedents d'un multiframe
     // que copiem més d'una vegada un arxiu
@@ -418,38 +450,108 @@ Status ConvertToDicomdir::copyImages(QList<Image*> images)
         if (lastPath != imageToCopy->getPath())
         {
             lastPath = imageToCopy->getPath();
-            
+
             m_currentItemNumber++;
-            state = copyImageToDicomdirPath(imageToCopy);
-            
-            // La barra de progrés avança
-            m_progress->setValue(m_progress->value() + 1);
-            m_progress->repaint();
-            
-            if (!state.good())
+
+            ImageToCopy item;
+            item.sourcePath = imageToCopy->getPath();
+            item.destinationPath = getCurrentItemOutputPath();
+            m_imagesToCopy.append(item);
+        }
+    }
+}
+
+Status ConvertToDicomdir::copyImagesToDicomdirPath()
+{
+    m_nextImageToCopy.store(0);
+    m_copyFailed.store(0);
+    m_copyErrorStatus.setStatus("", true, 0);
+
+    if (m_imagesToCopy.isEmpty())
+    {
+        return m_copyErrorStatus;
+    }
+
+    // La còpia està limitada pel disc, més threads només fan que competir per ell. En canvi, convertir a little endian imatges comprimides està
+    // limitat per la CPU, així que es fa servir un thread per nucli
+    int maximumNumberOfThreads = getConvertDicomdirImagesToLittleEndian() ? MaximumNumberOfConversionThreads : MaximumNumberOfCopyThreads;
+    int numberOfThreads = qBound(1, QThread::idealThreadCount(), maximumNumberOfThreads);
+    numberOfThreads = qMin(numberOfThreads, m_imagesToCopy.count());
+    m_runningCopyThreads.store(numberOfThreads);
+
+    // Els senyals arriben des dels threads de còpia, així que es processen des d'aquest event loop
+    QEventLoop eventLoop;
+    connect(this, SIGNAL(imageCopied()), SLOT(increaseProgress()));
+    connect(this, SIGNAL(imagesCopyFinished()), &eventLoop, SLOT(quit()));
+
+    QList<QFuture<void> > copyThreads;
+    for (int i = 0; i < numberOfThreads; i++)
+    {
+        copyThreads << QtConcurrent::run(this, &ConvertToDicomdir::copyImagesToDicomdirPathThread);
+    }
+
+    eventLoop.exec(QEventLoop::ExcludeUserInputEvents);
+
+    foreach (QFuture<void> copyThread, copyThreads)
+    {
+        copyThread.waitForFinished();
+    }
+
+    disconnect(this, SIGNAL(imageCopied()), this, SLOT(increaseProgress()));
+    disconnect(this, SIGNAL(imagesCopyFinished()), &eventLoop, SLOT(quit()));
+
+    return m_copyErrorStatus;
+}
+
+void ConvertToDicomdir::copyImagesToDicomdirPathThread()
+{
+    int index = m_nextImageToCopy.fetchAndAddOrdered(1);
+
+    while (index < m_imagesToCopy.count() && m_copyFailed.load() == 0)
+    {
+        const ImageToCopy &item = m_imagesToCopy.at(index);
+        Status state = copyImageToDicomdirPath(item.sourcePath, item.destinationPath);
+
+        if (!state.good())
+        {
+            QMutexLocker locker(&m_copyErrorMutex);
+            if (m_copyFailed.testAndSetOrdered(0, 1))
             {
-                break;
+                m_copyErrorStatus = state;
             }
         }
+
+        emit imageCopied();
+
+        index = m_nextImageToCopy.fetchAndAddOrdered(1);
     }
 
-    return state;
+    if (!m_runningCopyThreads.deref())
+    {
+        emit imagesCopyFinished();
+    }
+}
+
+void ConvertToDicomdir::increaseProgress()
+{
+    // La barra de progrés avança
+    m_progress->setValue(m_progress->value() + 1);
 }
 
-Status ConvertToDicomdir::copyImageToDicomdirPath(Image *image)
+Status ConvertToDicomdir::copyImageToDicomdirPath(const QString &sourceFile, const QString &destinationFile)
 {
-    // Creem el nom del fitxer de l'imatge, el format és IMGXXXXX, on XXXXX és el numero d'imatge dins la sèrie
-    QString imageOutputPath = getCurrentItemOutputPath();
     Status state;
 
     if (getConvertDicomdirImagesToLittleEndian())
     {
-        // Convertim la imatge a littleEndian, demanat per la normativa DICOM i la guardem al directori desti
-        state = ConvertDicomToLittleEndian().convert(image->getPath(), imageOutputPath);
+        // Convertim la imatge a littleEndian, demanat per la normativa DICOM i la guardem al directori desti. Les que ja hi estan es copien tal qual
+        ConvertDicomToLittleEndian convertDicomToLittleEndian;
+        convertDicomToLittleEndian.setCopyFilesInLittleEndian(true);
+        state = convertDicomToLittleEndian.convert(sourceFile, destinationFile);
 
         if (m_anonymizeDICOMDIR && state.good())
         {
-            anonymizeFile(imageOutputPath, imageOutputPath, state, true);
+            anonymizeFile(destinationFile, destinationFile, state, true);
         }
     }
     else
@@ -459,11 +561,11 @@ Status ConvertToDicomdir::copyImageToDicomdirPath(Image *image)
         // que no s'han de convertir a LittleEndian és més ràpid.
         if (m_anonymizeDICOMDIR)
         {
-            anonymizeFile(image->getPath(), imageOutputPath, state, false);
+            anonymizeFile(sourceFile, destinationFile, state, false);
         }
         else
         {
-            copyFileToDICOMDIRDestination(image->getPath(), imageOutputPath, state);
+            copyFileToDICOMDIRDestination(sourceFile, destinationFile, state);
         }
     }
 
@@ -15,10 +15,13 @@
 #ifndef UDGCONVERTTODICOMDIR_H
 #define UDGCONVERTTODICOMDIR_H
 
+#include <QAtomicInt>
+#include <QMutex>
 #include <QObject>
 #include <QStringList>
 
 #include "createdicomdir.h"
+#include "status.h"
 
 // Fordward declarations
 class QProgressDialog;
@@ -26,7 +29,7 @@ class QProgressDialog;
 namespace udg {
 
 // Fordward declarations
-class Status;
+class Patient;
 class Study;
 class Series;
 class Image;
@@ -78,7 +81,28 @@ public:
     /// Aquest mètode ens comprova que es compleixi aquest requeriment.
     bool AreValidRequirementsOfFolderContentToCopyToDICOMDIR(QString path);
 
+signals:
+    /// Emitted from the copy threads each time an image has been copied to the DICOMDIR, successfully or not
+    void imageCopied();
+
+    /// Emitted from the last copy thread that finishes
+    void imagesCopyFinished();
+
 private:
+    /// Returns the patient of the study with the given UID from the local database, without series. Returns null if it can't be queried
+    virtual Patient* queryPatientStudy(const QString &studyUID);
+
+    /// Returns the patient of the study with the given UID from the local database, with its series and images. If it can't be retrieved
+    /// returns null and sets the error in state
+    virtual Patient* retrievePatientStudy(const QString &studyUID, Status &state);
+
+    /// Image to copy to the DICOMDIR, with the path it's copied to
+    struct ImageToCopy
+    {
+        QString sourcePath;
+        QString destinationPath;
+    };
+
     /// Estructura que conté la informació d'un estudi a convertir a dicomdir.
     /// És necessari guardar el Patient ID perquè segons la normativa de l'IHE,
     /// els estudis s'han d'agrupar per id de pacient
@@ -97,23 +121,25 @@ private:
     /// Copia els estudis seleccionats per passar a dicomdir, al directori desti
     Status copyStudiesToDicomdirPath(QList<Study*> studyList);
 
-    /// Converteix un estudi al format littleendian, i la copia al directori dicomdir
-    /// @param studyUID Uid de l'estudi a convertir
-    /// @return Indica l'estat en què finalitza el mètode
-    Status copyStudyToDicomdirPath(Study *study);
+    /// Creates the directory of the study in the DICOMDIR and adds the images of its series to the list of images to copy
+    void addStudyImagesToCopy(Study *study);
 
-    /// Converteix una sèrie al format littleendian, i la copia al directori dicomdir
-    /// @param series
-    /// @return Indica l'estat en què finalitza el mètode
-    Status copySeriesToDicomdirPath(Series *series);
+    /// Creates the directory of the series in the DICOMDIR and adds its images to the list of images to copy
+    void addSeriesImagesToCopy(Series *series);
 
-    /// Does the process of copying a list of images to the corresponding DICOMDIR destination 
-    Status copyImages(QList<Image*> images);
-    
-    /// Converteix una imatge al format littleendian, i la copia al directori dicomdir
-    /// @param image
+    /// Adds the given images to the list of images to copy, with the IMGXXXXX name that corresponds to each one in the current series directory
+    void addImagesToCopy(const QList<Image*> &images);
+
+    /// Copies all the images of the list of images to copy with several threads and waits until they finish, advancing the progress bar as each image
+    /// is copied. Copies stop at the first error
+    Status copyImagesToDicomdirPath();
+
+    /// Copy thread: takes the next image of the list of images to copy until there aren't more images or a copy has failed
+    void copyImagesToDicomdirPathThread();
+
+    /// Converteix una imatge al format littleendian, si s'ha indicat, i la copia al path destí. Pot cridar-se des de diversos threads alhora
     /// @return Indica l'estat en què finalitza el mètode
-    Status copyImageToDicomdirPath(Image *image);
+    Status copyImageToDicomdirPath(const QString &sourceFile, const QString &destinationFile);
 
     /// Gets the corresponding output prefix name
     QString getDICOMDIROutputFilenamePrefix() const;
@@ -131,6 +157,10 @@ private:
     /// Starviewer té l'opció de copiar el contingut d'una carpeta al DICOMDIR. Aquest mètode copia el contingut de la carpeta al DICOMDIR
     bool copyFolderContentToDICOMDIR();
 
+private slots:
+    /// Advances the progress bar one image
+    void increaseProgress();
+
 private:
     QList<StudyToConvert> m_studiesToConvert;
     QProgressDialog *m_progress;
@@ -150,6 +180,19 @@ private:
     /// Holds the number of the item being copied
     int m_currentItemNumber;
 
+    /// Images to copy, in the order they have been added
+    QList<ImageToCopy> m_imagesToCopy;
+    /// Index of the next image to copy, shared between the copy threads
+    QAtomicInt m_nextImageToCopy;
+    /// Number of copy threads that haven't finished yet
+    QAtomicInt m_runningCopyThreads;
+    /// Set to 1 when a copy fails, so the other threads stop
+    QAtomicInt m_copyFailed;
+    /// Status of the first copy that failed
+    Status m_copyErrorStatus;
+    /// Protects m_copyErrorStatus
+    QMutex m_copyErrorMutex;
+
     /// És necessari crear-la global per mantenir la consistència dels UID dels fitxers DICOM
     DICOMAnonymizer *m_DICOMAnonymizer;
     bool m_anonymizeDICOMDIR;
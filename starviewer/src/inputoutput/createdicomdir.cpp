@@ -16,6 +16,7 @@
 
 #include <QString>
 #include <QDir>
+#include <QStringList>
 // Make sure OS specific configuration is included first
 #include <osconfig.h>
 #include <dctk.h>
@@ -116,11 +117,30 @@ void CreateDicomdir::setCheckTransferSyntax(bool checkTransferSyntax)
 
 Status CreateDicomdir::create(QString dicomdirPath)
 {
-    // Nom del fitxer dicomDir
-    QString outputDirectory = dicomdirPath + "/DICOMDIR";
     // Create list of input files
     OFList<OFString> fileNames;
     const char *opt_pattern = NULL;
+
+    // Busquem el fitxers al dicomdir. Anteriorment a la classe ConvertoToDicomdir s'han d'haver copiat els fitxers dels estudis seleccionats,
+    // al directori dicomdir destí
+    OFStandard::searchDirectoryRecursively("", fileNames, opt_pattern, qPrintable(QDir::toNativeSeparators(dicomdirPath)));
+
+    QStringList files;
+    OFListIterator(OFString) iter = fileNames.begin();
+    OFListIterator(OFString) last = fileNames.end();
+    while (iter != last)
+    {
+        files << QString((*iter).c_str());
+        iter++;
+    }
+
+    return create(dicomdirPath, files);
+}
+
+Status CreateDicomdir::create(const QString &dicomdirPath, const QStringList &files)
+{
+    // Nom del fitxer dicomDir
+    QString outputDirectory = dicomdirPath + "/DICOMDIR";
     const char *opt_fileset = DEFAULT_FILESETID;
     const char *opt_descriptor = NULL;
     const char *opt_charset = DEFAULT_DESCRIPTOR_CHARSET;
@@ -130,12 +150,8 @@ Status CreateDicomdir::create(QString dicomdirPath)
 
     Status state;
 
-    // Busquem el fitxers al dicomdir. Anteriorment a la classe ConvertoToDicomdir s'han d'haver copiat els fitxers dels estudis seleccionats,
-    // al directori dicomdir destí
-    OFStandard::searchDirectoryRecursively("", fileNames, opt_pattern, qPrintable(QDir::toNativeSeparators(dicomdirPath)));
-
     // Comprovem que el directori no estigui buit
-    if (fileNames.empty())
+    if (files.isEmpty())
     {
         ERROR_LOG(QString("El directori destí del DICOMDIR [%1] està buit o no hi tenim accés per llistar-ne el contingut. No podem crear l'arxiu de DICOMDIR.")
             .arg(dicomdirPath));
@@ -157,23 +173,22 @@ Status CreateDicomdir::create(QString dicomdirPath)
     result = m_ddir.setFilesetDescriptor(opt_descriptor, opt_charset);
     if (result.good())
     {
-        OFListIterator(OFString) iter = fileNames.begin();
-        OFListIterator(OFString) last = fileNames.end();
+        int index = 0;
 
         // Iterem sobre la llista de fitxer i els afegim al dicomdir
-        while ((iter != last) && result.good())
+        while (index < files.count() && result.good())
         {
             // Afegim els fitxers al dicomdir
-            result = m_ddir.addDicomFile(qPrintable(QString((*iter).c_str()).toUpper()), qPrintable(QDir::toNativeSeparators(dicomdirPath)));
+            result = m_ddir.addDicomFile(qPrintable(QDir::toNativeSeparators(files.at(index)).toUpper()), qPrintable(QDir::toNativeSeparators(dicomdirPath)));
             if (result.good())
             {
-                iter++;
+                index++;
             }
         }
 
         if (!result.good())
         {
-            ERROR_LOG("Error al convertir a DICOMDIR el fitxer : " + dicomdirPath + "/" + (*iter).c_str() + result.text());
+            ERROR_LOG("Error al convertir a DICOMDIR el fitxer : " + dicomdirPath + "/" + files.at(index) + result.text());
             result = EC_IllegalCall;
         }
         else
@@ -19,6 +19,7 @@
 #include "dcddirif.h"
 
 class QString;
+class QStringList;
 
 namespace udg {
 
@@ -68,6 +69,12 @@ public:
     /// @return estat de finalització del mètode
     Status create(QString dicomdirPath);
 
+    /// Crea el fitxer DicomDir amb els fitxers indicats, sense recórrer el directori per buscar-los
+    /// @param dicomdirPath directori a convertir a dicomdir
+    /// @param files paths dels fitxers DICOM relatius a dicomdirPath
+    /// @return estat de finalització del mètode
+    Status create(const QString &dicomdirPath, const QStringList &files);
+
 private:
     DicomDirInterface::E_ApplicationProfile m_optProfile;
     DicomDirInterface m_ddir;
@@ -47,6 +47,11 @@ void DatabaseConnection::open()
     // bloqueja fins a 15000ms una vegada passat aquest temps dona errora de taula o base de dades bloquejada
 
     sqlite3_busy_timeout(m_databaseConnection, 15000);
+
+    // With write-ahead logging readers don't block the writer and the writer doesn't block readers, so the UI can keep querying the database while a
+    // retrieved study is being saved. The WAL is synced only at checkpoints, which is safe against application crashes.
+    sqlite3_exec(m_databaseConnection, "PRAGMA journal_mode=WAL", 0, 0, 0);
+    sqlite3_exec(m_databaseConnection, "PRAGMA synchronous=NORMAL", 0, 0, 0);
 }
 
 void DatabaseConnection::beginTransaction()
@@ -60,10 +65,12 @@ void DatabaseConnection::beginTransaction()
     sqlite3_exec(m_databaseConnection, "BEGIN IMMEDIATE", 0, 0, 0);
 }
 
-void DatabaseConnection::commitTransaction()
+int DatabaseConnection::commitTransaction()
 {
-    sqlite3_exec(m_databaseConnection, "END", 0, 0, 0);
+    int status = sqlite3_exec(m_databaseConnection, "END", 0, 0, 0);
     m_transactionLock->release();
+
+    return status;
 }
 
 void DatabaseConnection::rollbackTransaction()
@@ -95,6 +102,29 @@ sqlite3* DatabaseConnection::getConnection()
     return m_databaseConnection;
 }
 
+sqlite3_stmt* DatabaseConnection::getPreparedStatement(const QString &sqlSentence)
+{
+    sqlite3_stmt *statement = m_preparedStatements.value(sqlSentence);
+
+    if (statement)
+    {
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+        return statement;
+    }
+
+    if (sqlite3_prepare_v2(getConnection(), sqlSentence.toUtf8().constData(), -1, &statement, 0) != SQLITE_OK)
+    {
+        ERROR_LOG(QString("No s'ha pogut preparar la sentencia sql %1: %2").arg(sqlSentence).arg(getLastErrorMessage()));
+        sqlite3_finalize(statement);
+        return NULL;
+    }
+
+    m_preparedStatements.insert(sqlSentence, statement);
+
+    return statement;
+}
+
 bool DatabaseConnection::isConnected()
 {
     return m_databaseConnection != NULL;
@@ -104,6 +134,12 @@ void DatabaseConnection::close()
 {
     if (isConnected())
     {
+        foreach (sqlite3_stmt *statement, m_preparedStatements)
+        {
+            sqlite3_finalize(statement);
+        }
+        m_preparedStatements.clear();
+
         sqlite3_close(m_databaseConnection);
         m_databaseConnection = NULL;
     }
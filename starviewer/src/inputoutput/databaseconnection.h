@@ -15,10 +15,12 @@
 #ifndef UDGDATABASECONNECTION_H
 #define UDGDATABASECONNECTION_H
 
+#include <QHash>
 #include <QString>
 
 class QSemaphore;
 struct sqlite3;
+struct sqlite3_stmt;
 
 namespace udg {
 
@@ -45,6 +47,11 @@ public:
     // @return connexio a la base de dades, si el punter és nul, és que hi hagut error alhora de connectar, o que el path no és correcte
     sqlite3* getConnection();
 
+    /// Returns a prepared statement for the given SQL sentence, ready to bind its parameters and step it. Statements are prepared only once per connection
+    /// and are reset each time they are returned, so the same sentence can be executed many times inside a transaction without parsing it again.
+    /// The statement belongs to the connection and must not be finalized by the caller. Returns null if the sentence can't be prepared.
+    sqlite3_stmt* getPreparedStatement(const QString &sqlSentence);
+
     /// Retorna l'últim missatge d'error produït a la base de dades
     QString getLastErrorMessage();
 
@@ -54,9 +61,10 @@ public:
     /// Comença/finalitza/Fa rollback una transacció a la base de dades. Només pot haver una transacció a la vegada amb
     /// la mateixa connexió, per això aquests mètodes tenen implantat un semàfor, qeu control l'accés a les transaccions. Si es fa una transacció
     /// i no s'arriba mai a invocar endTransaction() quan es tanqui la connexió amb la base de dades sqlite automàticament fa un rollback dels canvis.
+    /// commitTransaction() retorna el codi d'error de l'sqlite del commit
     // TODO: S'hauria de repassar l'ubicació ja que no semblaria gaire correcte com a responsabilitat de la connexió. Quan es faci refactoring...
     void beginTransaction();
-    void commitTransaction();
+    int commitTransaction();
     void rollbackTransaction();
 
     /// Formata l'string de forma que no contingui caràcters extranys que puguin fer
@@ -84,6 +92,9 @@ private:
     QSemaphore *m_transactionLock;
 
     QString m_databasePath;
+
+    /// Statements prepared with this connection, by SQL sentence
+    QHash<QString, sqlite3_stmt*> m_preparedStatements;
 };
 }; // End namespace
 
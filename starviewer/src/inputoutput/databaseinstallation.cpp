@@ -17,6 +17,7 @@
 #include <QDir>
 #include <QFile>
 #include <QString>
+#include <QStringList>
 #include <QMessageBox>
 #include <sqlite3.h>
 
@@ -83,6 +84,8 @@ bool DatabaseInstallation::checkStarviewerDatabase()
         return false;
     }
 
+    localDatabaseManager.createSearchIndex();
+
     INFO_LOG("Estat de la base de dades correcte ");
     INFO_LOG("Base de dades utilitzada : " + LocalDatabaseManager::getDatabaseFilePath() + " revisio " +
              QString().setNum(localDatabaseManager.getDatabaseRevision()));
@@ -190,6 +193,18 @@ bool DatabaseInstallation::reinstallDatabase()
         }
     }
 
+    // La base de dades treballa en mode WAL, si els fitxers -wal i -shm de l'anterior base de dades no s'esborren sqlite els aplicaria sobre la nova
+    foreach (const QString &suffix, QStringList() << "-wal" << "-shm")
+    {
+        QString walFilePath = LocalDatabaseManager::getDatabaseFilePath() + suffix;
+
+        if (QFile::exists(walFilePath) && !QFile::remove(walFilePath))
+        {
+            ERROR_LOG("Reinstal.lant la base de dades no s'ha pogut esborrar el fitxer " + walFilePath);
+            return false;
+        }
+    }
+
     if (!createDatabaseFile())
     {
         return false;
@@ -408,6 +423,7 @@ bool DatabaseInstallation::createDatabaseFile()
     if (status == 0)
     {
         INFO_LOG("S'ha creat correctament la base de dades");
+        LocalDatabaseManager().createSearchIndex();
         return true;
     }
     else
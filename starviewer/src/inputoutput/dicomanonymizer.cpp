@@ -20,13 +20,34 @@
 #include <gdcmWriter.h>
 #include <gdcmDefs.h>
 #include <QCoreApplication>
+#include <QDataStream>
 #include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QThread>
+#include <QtConcurrentRun>
 #include <dcuid.h>
 
 #include "logging.h"
 
 namespace udg {
 
+namespace {
+
+const gdcm::Tag PixelDataTag(0x7fe0, 0x0010);
+const quint32 UndefinedLength = 0xffffffff;
+// Mida dels blocs amb què es copia el Pixel Data
+const int CopyBufferSize = 1024 * 1024;
+// Anonimitzar un directori està limitat pel disc, més threads només fan que competir per ell
+const int MaximumNumberOfAnonymizerThreads = 4;
+
+// Protegeix els UID substituïts, que gdcmAnonymizerStarviewer guarda en variables estàtiques, i els hash de PatientID i StudyID
+QMutex AnonymizerMutex;
+
+}
+
 DICOMAnonymizer::DICOMAnonymizer()
 {
     initializeGDCM();
@@ -34,12 +55,12 @@ DICOMAnonymizer::DICOMAnonymizer()
     m_replacePatientIDInsteadOfRemove = false;
     m_replaceStudyIDInsteadOfRemove = false;
     m_removePritaveTags = true;
+    m_streamingModeEnabled = true;
     m_patientNameAnonymized = "";
 }
 
 DICOMAnonymizer::~DICOMAnonymizer()
 {
-    delete m_gdcmAnonymizer;
 }
 
 void DICOMAnonymizer::setPatientNameAnonymized(const QString &patientNameAnonymized)
@@ -83,9 +104,18 @@ bool DICOMAnonymizer::getRemovePrivateTags()
     return m_removePritaveTags;
 }
 
+void DICOMAnonymizer::setStreamingModeEnabled(bool enabled)
+{
+    m_streamingModeEnabled = enabled;
+}
+
+bool DICOMAnonymizer::isStreamingModeEnabled() const
+{
+    return m_streamingModeEnabled;
+}
+
 void DICOMAnonymizer::initializeGDCM()
 {
-    m_gdcmAnonymizer = new gdcm::gdcmAnonymizerStarviewer();
     gdcm::Global *gdcmGlobalInstance = &gdcm::Global::GetInstance();
 
     // Indiquem el directori on pot trobar el fitxer part3.xml que és un diccionari DICOM.
@@ -111,31 +141,61 @@ void DICOMAnonymizer::initializeGDCM()
 
 bool DICOMAnonymizer::anonymyzeDICOMFilesDirectory(const QString &directoryPath)
 {
-    QDir directory;
-    directory.setPath(directoryPath);
+    QStringList files;
+    QDirIterator directoryIterator(directoryPath, QDir::Files, QDirIterator::Subdirectories);
+    while (directoryIterator.hasNext())
+    {
+        files << directoryIterator.next();
+    }
+
+    QAtomicInt nextFile(0);
+    QAtomicInt failed(0);
+    int numberOfThreads = qBound(1, QThread::idealThreadCount(), MaximumNumberOfAnonymizerThreads);
+
+    QList<QFuture<void> > threads;
+    for (int i = 0; i < numberOfThreads; i++)
+    {
+        threads << QtConcurrent::run(this, &DICOMAnonymizer::anonymizeDICOMFilesThread, files, &nextFile, &failed);
+    }
+
+    foreach (QFuture<void> thread, threads)
+    {
+        thread.waitForFinished();
+    }
+
+    return failed.load() == 0;
+}
+
+void DICOMAnonymizer::anonymizeDICOMFilesThread(const QStringList &files, QAtomicInt *nextFile, QAtomicInt *failed)
+{
+    int index = nextFile->fetchAndAddOrdered(1);
 
-    foreach (const QFileInfo &entryInfo, directory.entryInfoList(QDir::NoDotAndDotDot | QDir::Dirs | QDir::Files))
+    while (index < files.count() && failed->load() == 0)
     {
-        if (entryInfo.isDir())
+        if (!anonymizeDICOMFile(files.at(index), files.at(index)))
         {
-            if (!anonymyzeDICOMFilesDirectory(entryInfo.absoluteFilePath()))
-            {
-                return false;
-            }
+            failed->store(1);
         }
-        else
+
+        index = nextFile->fetchAndAddOrdered(1);
+    }
+}
+
+bool DICOMAnonymizer::anonymizeDICOMFile(const QString &inputPathFile, const QString &outputPathFile)
+{
+    if (m_streamingModeEnabled)
+    {
+        StreamingResult result = anonymizeDICOMFileStreaming(inputPathFile, outputPathFile);
+        if (result != StreamingNotPossible)
         {
-            if (!anonymizeDICOMFile(entryInfo.absoluteFilePath(), entryInfo.absoluteFilePath()))
-            {
-                return false;
-            }
+            return result == StreamingOk;
         }
     }
 
-    return true;
+    return anonymizeDICOMFileInMemory(inputPathFile, outputPathFile);
 }
 
-bool DICOMAnonymizer::anonymizeDICOMFile(const QString &inputPathFile, const QString &outputPathFile)
+bool DICOMAnonymizer::anonymizeDICOMFileInMemory(const QString &inputPathFile, const QString &outputPathFile)
 {
     gdcm::Reader gdcmReader;
     gdcmReader.SetFileName(qPrintable(inputPathFile));
@@ -147,6 +207,63 @@ bool DICOMAnonymizer::anonymizeDICOMFile(const QString &inputPathFile, const QSt
     }
 
     gdcm::File &gdcmFile = gdcmReader.GetFile();
+    if (!anonymizeGDCMFile(gdcmFile, inputPathFile))
+    {
+        return false;
+    }
+
+    return writeGDCMFile(gdcmFile, inputPathFile, outputPathFile);
+}
+
+DICOMAnonymizer::StreamingResult DICOMAnonymizer::anonymizeDICOMFileStreaming(const QString &inputPathFile, const QString &outputPathFile)
+{
+    gdcm::Reader gdcmReader;
+    gdcmReader.SetFileName(qPrintable(inputPathFile));
+
+    // Només es llegeixen els elements anteriors al Pixel Data
+    if (!gdcmReader.ReadUpToTag(PixelDataTag))
+    {
+        ERROR_LOG("No s'ha trobat el fitxer a anonimitzar " + inputPathFile);
+        return StreamingFailed;
+    }
+
+    gdcm::File &gdcmFile = gdcmReader.GetFile();
+    qint64 pixelDataStart = gdcmReader.GetStreamCurrentPosition();
+    qint64 pixelDataEnd;
+    if (pixelDataStart < 0 || !findPixelDataEnd(inputPathFile, gdcmFile.GetHeader().GetDataSetTransferSyntax(), pixelDataStart, pixelDataEnd))
+    {
+        return StreamingNotPossible;
+    }
+
+    if (!anonymizeGDCMFile(gdcmFile, inputPathFile))
+    {
+        return StreamingFailed;
+    }
+
+    // Si el fitxer d'entrada és el de sortida s'escriu en un fitxer temporal, perquè el Pixel Data s'ha de llegir del fitxer original
+    bool overwriteInput = QFileInfo(inputPathFile) == QFileInfo(outputPathFile);
+    QString writtenPathFile = overwriteInput ? outputPathFile + ".anonymized" : outputPathFile;
+
+    if (!writeGDCMFile(gdcmFile, inputPathFile, writtenPathFile) || !appendFileBytes(inputPathFile, pixelDataStart, pixelDataEnd, writtenPathFile))
+    {
+        QFile::remove(writtenPathFile);
+        return StreamingFailed;
+    }
+
+    if (overwriteInput)
+    {
+        if (!QFile::remove(outputPathFile) || !QFile::rename(writtenPathFile, outputPathFile))
+        {
+            ERROR_LOG("No s'ha pogut substituir el fitxer " + outputPathFile + " pel fitxer anonimitzat");
+            return StreamingFailed;
+        }
+    }
+
+    return StreamingOk;
+}
+
+bool DICOMAnonymizer::anonymizeGDCMFile(gdcm::File &gdcmFile, const QString &inputPathFile)
+{
     gdcm::MediaStorage gdcmMediaStorage;
     gdcmMediaStorage.SetFromFile(gdcmFile);
     if (!gdcm::Defs::GetIODNameFromMediaStorage(gdcmMediaStorage))
@@ -158,37 +275,48 @@ bool DICOMAnonymizer::anonymizeDICOMFile(const QString &inputPathFile, const QSt
     QString originalPatientID = readTagValue(&gdcmFile, gdcm::Tag(0x0010, 0x0020));
     QString originalStudyInstanceUID = readTagValue(&gdcmFile, gdcm::Tag(0x0020, 0x000d));
 
-    m_gdcmAnonymizer->SetFile(gdcmFile);
-    if (!m_gdcmAnonymizer->BasicApplicationLevelConfidentialityProfile(true))
+    // L'anonimitzador de gdcm guarda els UID substituïts en variables estàtiques
+    QMutexLocker locker(&AnonymizerMutex);
+
+    // Es fa servir un anonimitzador per crida perquè SetFile() guarda una referència al fitxer amb un comptador que no és atòmic. Així el comptador
+    // només el modifica el thread que ha llegit el fitxer
+    gdcm::gdcmAnonymizerStarviewer gdcmAnonymizer;
+    gdcmAnonymizer.SetFile(gdcmFile);
+    if (!gdcmAnonymizer.BasicApplicationLevelConfidentialityProfile(true))
     {
         ERROR_LOG("No s'ha pogut anonimitzar el fitxer " + inputPathFile);
         return false;
     }
 
     // Estableix el mom del pacient anonimitzat
-    m_gdcmAnonymizer->Replace(gdcm::Tag(0x0010, 0x0010), qPrintable(m_patientNameAnonymized));
+    gdcmAnonymizer.Replace(gdcm::Tag(0x0010, 0x0010), qPrintable(m_patientNameAnonymized));
 
     if (getReplacePatientIDInsteadOfRemove())
     {
         // ID Pacient
-        m_gdcmAnonymizer->Replace(gdcm::Tag(0x0010, 0x0020), qPrintable(getAnonimyzedPatientID(originalPatientID)));
+        gdcmAnonymizer.Replace(gdcm::Tag(0x0010, 0x0020), qPrintable(getAnonimyzedPatientID(originalPatientID)));
     }
 
     if (getReplaceStudyIDInsteadOfRemove())
     {
         // ID Estudi
-        m_gdcmAnonymizer->Replace(gdcm::Tag(0x0020, 0x0010), qPrintable(getAnonymizedStudyID(originalStudyInstanceUID)));
+        gdcmAnonymizer.Replace(gdcm::Tag(0x0020, 0x0010), qPrintable(getAnonymizedStudyID(originalStudyInstanceUID)));
     }
 
     if (getRemovePrivateTags())
     {
-        if (!m_gdcmAnonymizer->RemovePrivateTags())
+        if (!gdcmAnonymizer.RemovePrivateTags())
         {
             ERROR_LOG("No s'ha pogut treure els tags privats del fitxer " + inputPathFile);
             return false;
         }
     }
 
+    return true;
+}
+
+bool DICOMAnonymizer::writeGDCMFile(gdcm::File &gdcmFile, const QString &inputPathFile, const QString &outputPathFile)
+{
     // Regenerem la capçalera DICOM amb el nou SOP Instance UID
     gdcm::FileMetaInformation gdcmFileMetaInformation = gdcmFile.GetHeader();
     gdcmFileMetaInformation.Clear();
@@ -205,6 +333,97 @@ bool DICOMAnonymizer::anonymizeDICOMFile(const QString &inputPathFile, const QSt
     return true;
 }
 
+bool DICOMAnonymizer::findPixelDataEnd(const QString &pathFile, const gdcm::TransferSyntax &transferSyntax, qint64 pixelDataStart,
+                                       qint64 &pixelDataEnd)
+{
+    if (transferSyntax == gdcm::TransferSyntax::DeflatedExplicitVRLittleEndian)
+    {
+        return false;
+    }
+
+    QFile file(pathFile);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(pixelDataStart))
+    {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(transferSyntax.GetSwapCode() == gdcm::SwapCode::BigEndian ? QDataStream::BigEndian : QDataStream::LittleEndian);
+
+    quint16 group, element;
+    quint32 length;
+    stream >> group >> element;
+    if (group != PixelDataTag.GetGroup() || element != PixelDataTag.GetElement())
+    {
+        return false;
+    }
+
+    if (transferSyntax.IsExplicit())
+    {
+        // VR i dos bytes reservats
+        quint16 valueRepresentation, reserved;
+        stream >> valueRepresentation >> reserved;
+    }
+    stream >> length;
+
+    if (length != UndefinedLength)
+    {
+        pixelDataEnd = file.pos() + length;
+    }
+    else
+    {
+        // Pixel Data encapsulat: ítems fins al delimitador de la seqüència, sempre en little endian
+        stream.setByteOrder(QDataStream::LittleEndian);
+        forever
+        {
+            stream >> group >> element >> length;
+            if (stream.status() != QDataStream::Ok || group != 0xfffe)
+            {
+                return false;
+            }
+
+            if (element == 0xe0dd)
+            {
+                pixelDataEnd = file.pos();
+                break;
+            }
+            else if (element != 0xe000 || length == UndefinedLength || !file.seek(file.pos() + length))
+            {
+                return false;
+            }
+        }
+    }
+
+    // Els elements posteriors al Pixel Data, com les signatures digitals, també s'han d'anonimitzar
+    return stream.status() == QDataStream::Ok && pixelDataEnd == file.size();
+}
+
+bool DICOMAnonymizer::appendFileBytes(const QString &inputPathFile, qint64 start, qint64 end, const QString &outputPathFile)
+{
+    QFile input(inputPathFile);
+    QFile output(outputPathFile);
+    if (!input.open(QIODevice::ReadOnly) || !input.seek(start) || !output.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        ERROR_LOG("No s'ha pogut copiar el Pixel Data de " + inputPathFile + " a " + outputPathFile);
+        return false;
+    }
+
+    QByteArray buffer(CopyBufferSize, 0);
+    qint64 remaining = end - start;
+    while (remaining > 0)
+    {
+        qint64 bytesRead = input.read(buffer.data(), qMin(remaining, static_cast<qint64>(buffer.size())));
+        if (bytesRead <= 0 || output.write(buffer.constData(), bytesRead) != bytesRead)
+        {
+            ERROR_LOG("No s'ha pogut copiar el Pixel Data de " + inputPathFile + " a " + outputPathFile);
+            return false;
+        }
+        remaining -= bytesRead;
+    }
+
+    return true;
+}
+
 QString DICOMAnonymizer::getAnonimyzedPatientID(const QString &originalPatientID)
 {
     if (!m_hashOriginalPatientIDToAnonimyzedPatientID.contains(originalPatientID))
@@ -15,8 +15,10 @@
 #ifndef UDGDICOMANONYMIZER_H
 #define UDGDICOMANONYMIZER_H
 
+#include <QAtomicInt>
 #include <QHash>
 #include <QString>
+#include <QStringList>
 
 #include "gdcmanonymizerstarviewer.h"
 
@@ -31,6 +33,14 @@ namespace udg {
     informació sensible del pacient, ens aconsellen que els treiem a http://groups.google.com/group/comp.protocols.dicom/browse_thread/thread/fb89f7f5d120db44
 
     Ens permet anonimitzar fitxers sols o tots els fitxers dins i subdirectoris del directori especificat.
+
+    In streaming mode, which is enabled by default, only the elements before Pixel Data are parsed and anonymized. Pixel Data is copied byte by byte
+    from the input file to the output file without being decoded. Files that can't be streamed are anonymized in memory as before:
+    - Deflated files.
+    - Files without Pixel Data.
+    - Files with elements after Pixel Data.
+    A directory is anonymized with several threads. The anonymization of each header is serialized, because gdcmAnonymizerStarviewer keeps the
+    replaced UIDs in static variables, and done with its own gdcmAnonymizerStarviewer. Bulk data is copied in parallel.
   */
 class DICOMAnonymizer {
 
@@ -38,7 +48,7 @@ public:
     DICOMAnonymizer();
     ~DICOMAnonymizer();
 
-    /// Ens anonimitza els fitxers d'un Directori
+    /// Ens anonimitza els fitxers d'un Directori. Els fitxers s'anonimitzen amb diversos threads
     bool anonymyzeDICOMFilesDirectory(const QString &directoryPath);
 
     /// Ens anonimitza un fitxer DICOM
@@ -70,7 +80,38 @@ public:
     void setRemovePrivateTags(bool removePritaveTags);
     bool getRemovePrivateTags();
 
+    /// Sets whether Pixel Data is copied from the input file without decoding it when possible. It's enabled by default
+    void setStreamingModeEnabled(bool enabled);
+    bool isStreamingModeEnabled() const;
+
+protected:
+    /// Result of anonymizing a file in streaming mode
+    enum StreamingResult { StreamingOk, StreamingFailed, StreamingNotPossible };
+
+    /// Anonymizes the elements before Pixel Data and copies Pixel Data from the input file without decoding it. StreamingNotPossible is returned,
+    /// without writing anything, if the file can't be anonymized this way
+    StreamingResult anonymizeDICOMFileStreaming(const QString &inputPathFile, const QString &outputPathFile);
+
+    /// Returns in pixelDataEnd the position just after the Pixel Data element that starts at pixelDataStart. Returns false if the element can't be
+    /// found there or if there are other elements after it
+    static bool findPixelDataEnd(const QString &pathFile, const gdcm::TransferSyntax &transferSyntax, qint64 pixelDataStart, qint64 &pixelDataEnd);
+
+    /// Copies the bytes between start and end of the input file to the end of the output file
+    static bool appendFileBytes(const QString &inputPathFile, qint64 start, qint64 end, const QString &outputPathFile);
+
 private:
+    /// Anonymizes the file loading all its elements, Pixel Data included
+    bool anonymizeDICOMFileInMemory(const QString &inputPathFile, const QString &outputPathFile);
+
+    /// Applies the anonymization rules to the dataset of the given file. It can be called from several threads at a time
+    bool anonymizeGDCMFile(gdcm::File &gdcmFile, const QString &inputPathFile);
+
+    /// Writes the given file to the given path
+    bool writeGDCMFile(gdcm::File &gdcmFile, const QString &inputPathFile, const QString &outputPathFile);
+
+    /// Anonymizes the files of the list from the one pointed by nextFile until there aren't more files or one fails. Runs in several threads
+    void anonymizeDICOMFilesThread(const QStringList &files, QAtomicInt *nextFile, QAtomicInt *failed);
+
     /// Inicialitza les variables de gdcm necessàries per anonimitzar
     void initializeGDCM();
 
@@ -90,11 +131,10 @@ private:
     bool m_replacePatientIDInsteadOfRemove;
     bool m_replaceStudyIDInsteadOfRemove;
     bool m_removePritaveTags;
+    bool m_streamingModeEnabled;
 
     QHash<QString, QString> m_hashOriginalPatientIDToAnonimyzedPatientID;
     QHash<QString, QString> m_hashOriginalStudyInstanceUIDToAnonimyzedStudyID;
-
-    gdcm::gdcmAnonymizerStarviewer *m_gdcmAnonymizer;
 };
 
 };
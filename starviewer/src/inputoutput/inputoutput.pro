@@ -40,6 +40,7 @@ HEADERS += databaseconnection.h \
     qconfigurationscreen.h \
     qpacslist.h \
     qstudytreewidget.h \
+    studytreemodel.h \
     qseriesthumbnailpreviewwidget.h \
     qcreatedicomdir.h \
     qoperationstatescreen.h \
@@ -73,6 +74,7 @@ HEADERS += databaseconnection.h \
     dicomdirburningapplication.h \
     risrequestmanager.h \
     relatedstudiesmanager.h \
+    relatedstudiescache.h \
     risrequestwrapper.h \
     qwidgetselectpacstostoredicomimage.h \
     qrelatedstudieswidget.h \
@@ -116,6 +118,7 @@ SOURCES += databaseconnection.cpp \
     qconfigurationscreen.cpp \
     qpacslist.cpp \
     qstudytreewidget.cpp \
+    studytreemodel.cpp \
     qseriesthumbnailpreviewwidget.cpp \
     qcreatedicomdir.cpp \
     qoperationstatescreen.cpp \
@@ -149,6 +152,7 @@ SOURCES += databaseconnection.cpp \
     dicomdirburningapplication.cpp \
     risrequestmanager.cpp \
     relatedstudiesmanager.cpp \
+    relatedstudiescache.cpp \
     risrequestwrapper.cpp \
     qwidgetselectpacstostoredicomimage.cpp \
     qrelatedstudieswidget.cpp \
@@ -193,4 +197,5 @@ include(../compilationtype.pri)
 include(../threadweaver.pri)
 QT += xml \
     network \
-    widgets
+    widgets \
+    concurrent
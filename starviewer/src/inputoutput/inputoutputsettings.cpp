@@ -69,6 +69,7 @@ const QString InputOutputSettings::IncomingDICOMConnectionsPort(PACSParametersBa
 const QString InputOutputSettings::LocalAETitle(PACSParametersBase + "AETitle");
 const QString InputOutputSettings::PACSConnectionTimeout(PACSParametersBase + "timeout");
 const QString InputOutputSettings::MaximumPACSConnections(PACSParametersBase + "MaxConnects");
+const QString InputOutputSettings::MaximumNumberOfStudiesPerPACSQuery(PACSParametersBase + "maximumNumberOfStudiesPerQuery");
 
 //TODO: Clau duplicada a CoreSettings
 const QString InputOutputSettings::PacsListConfigurationSectionName = "PacsList";
@@ -128,6 +129,7 @@ void InputOutputSettings::init()
     settingsRegistry->addSetting(LocalAETitle, QHostInfo::localHostName(), Settings::Parseable);
     settingsRegistry->addSetting(PACSConnectionTimeout, 20);
     settingsRegistry->addSetting(MaximumPACSConnections, 3);
+    settingsRegistry->addSetting(MaximumNumberOfStudiesPerPACSQuery, 5000);
 
     settingsRegistry->addSetting(ConvertDICOMDIRImagesToLittleEndianKey, false);
 #if defined(Q_OS_WIN)
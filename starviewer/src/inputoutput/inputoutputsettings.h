@@ -70,6 +70,8 @@ public:
     static const QString IncomingDICOMConnectionsPort;
     static const QString PACSConnectionTimeout;
     static const QString MaximumPACSConnections;
+    /// Número màxim d'estudis que es mostren de cada PACS en una consulta, 0 si no hi ha límit
+    static const QString MaximumNumberOfStudiesPerPACSQuery;
 
     /// Llista de PACS
     //TODO: Clau duplicada a CoreSettings
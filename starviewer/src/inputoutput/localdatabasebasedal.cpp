@@ -55,4 +55,18 @@ void LocalDatabaseBaseDAL::logError(const QString &sqlSentence)
     }
 }
 
+void LocalDatabaseBaseDAL::bindText(sqlite3_stmt *statement, int index, const QString &text)
+{
+    sqlite3_bind_text(statement, index, text.toUtf8().constData(), -1, SQLITE_TRANSIENT);
+}
+
+int LocalDatabaseBaseDAL::executePreparedStatement(sqlite3_stmt *statement)
+{
+    int status = sqlite3_step(statement);
+    // Reset releases the locks held by the statement, the connection keeps it to be reused
+    sqlite3_reset(statement);
+
+    return status == SQLITE_DONE ? SQLITE_OK : status;
+}
+
 }
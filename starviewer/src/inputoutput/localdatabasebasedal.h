@@ -18,6 +18,7 @@
 #define UDGLOCALDATABASEBASEDAL_H
 
 class QString;
+struct sqlite3_stmt;
 
 namespace udg {
 
@@ -40,6 +41,13 @@ protected:
     /// Ens fa un ErrorLog d'una sentència sql. No es té en compte l'error és SQL_CONSTRAINT (clau duplicada)
     void logError(const QString &sqlSentence);
 
+    /// Binds the given text to the parameter at the given index (1-based) of the statement. Null strings are bound as empty strings, as the string-built
+    /// sentences do.
+    static void bindText(sqlite3_stmt *statement, int index, const QString &text);
+
+    /// Executes a prepared statement that doesn't return rows and resets it. Returns SQLITE_OK on success and the sqlite error code otherwise.
+    static int executePreparedStatement(sqlite3_stmt *statement);
+
 protected:
     int m_lastSqliteError;
     DatabaseConnection *m_dbConnection;
@@ -35,6 +35,23 @@
 
 namespace udg {
 
+namespace {
+
+/// Sentence to insert an image. It's executed as a prepared statement that is reused for all the images saved with the same connection.
+const QString InsertSentence("Insert into Image (SOPInstanceUID, FrameNumber, StudyInstanceUID, SeriesInstanceUID, InstanceNumber,"
+                                     "ImageOrientationPatient, PatientOrientation, PixelSpacing, SliceThickness,"
+                                     "PatientPosition, SamplesPerPixel, Rows, Columns, BitsAllocated, BitsStored,"
+                                     "PixelRepresentation, RescaleSlope, WindowLevelWidth, WindowLevelCenter,"
+                                     "WindowLevelExplanations, SliceLocation,"
+                                     "RescaleIntercept, PhotometricInterpretation, ImageType, ViewPosition,"
+                                     "ImageLaterality, ViewCodeMeaning, PhaseNumber, ImageTime, VolumeNumberInSeries,"
+                                     "OrderNumberInVolume, RetrievedDate, RetrievedTime, State, NumberOfOverlays, RetrievedPACSID,"
+                                     "ImagerPixelSpacing, EstimatedRadiographicMagnificationFactor, TransferSyntaxUID) "
+                             "values (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13, ?14, ?15, ?16, ?17, ?18, ?19, ?20, "
+                                     "?21, ?22, ?23, ?24, ?25, ?26, ?27, ?28, ?29, ?30, ?31, ?32, ?33, ?34, ?35, ?36, ?37, ?38, ?39)");
+
+}
+
 LocalDatabaseImageDAL::LocalDatabaseImageDAL(DatabaseConnection *dbConnection)
  : LocalDatabaseBaseDAL(dbConnection)
 {
@@ -42,11 +59,25 @@ LocalDatabaseImageDAL::LocalDatabaseImageDAL(DatabaseConnection *dbConnection)
 
 void LocalDatabaseImageDAL::insert(Image *newImage)
 {
-    m_lastSqliteError = sqlite3_exec(m_dbConnection->getConnection(), buildSqlInsert(newImage).toUtf8().constData(), 0, 0, 0);
+    // The PACS ID is obtained first because it may need to insert the PACS in the database
+    QString retrievedPACSID = getIDPACSInDatabaseFromDICOMSource(newImage->getDICOMSource());
+
+    sqlite3_stmt *statement = m_dbConnection->getPreparedStatement(InsertSentence);
+
+    if (!statement)
+    {
+        m_lastSqliteError = m_dbConnection->getLastErrorCode();
+        logError(InsertSentence);
+        return;
+    }
+
+    bindInsertValues(statement, newImage, retrievedPACSID);
+    m_lastSqliteError = executePreparedStatement(statement);
 
     if (getLastError() != SQLITE_OK)
     {
-        logError(buildSqlInsert(newImage));
+        logError(QString("%1 (SOPInstanceUID = %2, FrameNumber = %3)").arg(InsertSentence).arg(newImage->getSOPInstanceUID())
+                                                                       .arg(newImage->getFrameNumber()));
     }
 }
 
@@ -225,69 +256,59 @@ QString LocalDatabaseImageDAL::buildSqlSelectCountImages(const DicomMask &imageM
     return selectSentence + buildWhereSentence(imageMaskToSelect);
 }
 
-QString LocalDatabaseImageDAL::buildSqlInsert(Image *newImage)
+void LocalDatabaseImageDAL::bindInsertValues(sqlite3_stmt *statement, Image *newImage, const QString &retrievedPACSID)
 {
     QString windowWidth, windowCenter, windowExplanation;
     getWindowLevelInformationAsQString(newImage, windowWidth, windowCenter, windowExplanation);
-    
-    QString insertSentence = QString("Insert into Image (SOPInstanceUID, FrameNumber, StudyInstanceUID, SeriesInstanceUID, InstanceNumber,"
-                                             "ImageOrientationPatient, PatientOrientation, PixelSpacing, SliceThickness,"
-                                             "PatientPosition, SamplesPerPixel, Rows, Columns, BitsAllocated, BitsStored,"
-                                             "PixelRepresentation, RescaleSlope, WindowLevelWidth, WindowLevelCenter,"
-                                             "WindowLevelExplanations, SliceLocation,"
-                                             "RescaleIntercept, PhotometricInterpretation, ImageType, ViewPosition,"
-                                             "ImageLaterality, ViewCodeMeaning, PhaseNumber, ImageTime, VolumeNumberInSeries,"
-                                             "OrderNumberInVolume, RetrievedDate, RetrievedTime, State, NumberOfOverlays, RetrievedPACSID,"
-                                             "ImagerPixelSpacing, EstimatedRadiographicMagnificationFactor, TransferSyntaxUID) "
-                                     "values ('%1', %2, '%3', '%4', '%5', "
-                                             "'%6', '%7', '%8', %9,"
-                                             "'%10', %11, %12, %13, %14, %15, "
-                                             "%16, %17,'%18', '%19', "
-                                             "'%20', '%21', "
-                                             "%22, '%23', '%24', '%25',"
-                                             "'%26',  '%27', %28, '%29', %30,"
-                                             "%31, '%32', '%33', %34, %35, %36, '%37', %38, '%39')")
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(newImage->getSOPInstanceUID()))
-                            .arg(newImage->getFrameNumber())
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(newImage->getParentSeries()->getParentStudy()->getInstanceUID()))
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(newImage->getParentSeries()->getInstanceUID()))
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(newImage->getInstanceNumber()))
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(newImage->getImageOrientationPatient().getDICOMFormattedImageOrientation()))
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(newImage->getPatientOrientation().getDICOMFormattedPatientOrientation()))
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(getPixelSpacingAsQString(newImage)))
-                            .arg(newImage->getSliceThickness())
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(getPatientPositionAsQString(newImage)))
-                            .arg(newImage->getSamplesPerPixel())
-                            .arg(newImage->getRows())
-                            .arg(newImage->getColumns())
-                            .arg(newImage->getBitsAllocated())
-                            .arg(newImage->getBitsStored())
-                            .arg(newImage->getPixelRepresentation())
-                            .arg(newImage->getRescaleSlope())
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(windowWidth))
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(windowCenter))
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(windowExplanation))
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(newImage->getSliceLocation()))
-                            .arg(newImage->getRescaleIntercept())
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(newImage->getPhotometricInterpretation().getAsQString()))
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(newImage->getImageType()))
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(newImage->getViewPosition()))
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(newImage->getImageLaterality()))
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(newImage->getViewCodeMeaning()))
-                            .arg(newImage->getPhaseNumber())
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(newImage->getImageTime()))
-                            .arg (newImage->getVolumeNumberInSeries())
-                            .arg(newImage->getOrderNumberInVolume())
-                            .arg(newImage->getRetrievedDate().toString("yyyyMMdd"))
-                            .arg(newImage->getRetrievedTime().toString("hhmmss"))
-                            .arg(0)
-                            .arg(newImage->getNumberOfOverlays())
-                            .arg(getIDPACSInDatabaseFromDICOMSource(newImage->getDICOMSource()))
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(getImagerPixelSpacingAsQString(newImage)))
-                            .arg(newImage->getEstimatedRadiographicMagnificationFactor())
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(newImage->getTransferSyntaxUID()));
 
-    return insertSentence;
+    bindText(statement, 1, newImage->getSOPInstanceUID());
+    sqlite3_bind_int(statement, 2, newImage->getFrameNumber());
+    bindText(statement, 3, newImage->getParentSeries()->getParentStudy()->getInstanceUID());
+    bindText(statement, 4, newImage->getParentSeries()->getInstanceUID());
+    bindText(statement, 5, newImage->getInstanceNumber());
+    bindText(statement, 6, newImage->getImageOrientationPatient().getDICOMFormattedImageOrientation());
+    bindText(statement, 7, newImage->getPatientOrientation().getDICOMFormattedPatientOrientation());
+    bindText(statement, 8, getPixelSpacingAsQString(newImage));
+    sqlite3_bind_double(statement, 9, newImage->getSliceThickness());
+    bindText(statement, 10, getPatientPositionAsQString(newImage));
+    sqlite3_bind_int(statement, 11, newImage->getSamplesPerPixel());
+    sqlite3_bind_int(statement, 12, newImage->getRows());
+    sqlite3_bind_int(statement, 13, newImage->getColumns());
+    sqlite3_bind_int(statement, 14, newImage->getBitsAllocated());
+    sqlite3_bind_int(statement, 15, newImage->getBitsStored());
+    sqlite3_bind_int(statement, 16, newImage->getPixelRepresentation());
+    sqlite3_bind_double(statement, 17, newImage->getRescaleSlope());
+    bindText(statement, 18, windowWidth);
+    bindText(statement, 19, windowCenter);
+    bindText(statement, 20, windowExplanation);
+    bindText(statement, 21, newImage->getSliceLocation());
+    sqlite3_bind_double(statement, 22, newImage->getRescaleIntercept());
+    bindText(statement, 23, newImage->getPhotometricInterpretation().getAsQString());
+    bindText(statement, 24, newImage->getImageType());
+    bindText(statement, 25, newImage->getViewPosition());
+    bindText(statement, 26, DatabaseConnection::formatTextToValidSQLSyntax(newImage->getImageLaterality()));
+    bindText(statement, 27, newImage->getViewCodeMeaning());
+    sqlite3_bind_int(statement, 28, newImage->getPhaseNumber());
+    bindText(statement, 29, newImage->getImageTime());
+    sqlite3_bind_int(statement, 30, newImage->getVolumeNumberInSeries());
+    sqlite3_bind_int(statement, 31, newImage->getOrderNumberInVolume());
+    bindText(statement, 32, newImage->getRetrievedDate().toString("yyyyMMdd"));
+    bindText(statement, 33, newImage->getRetrievedTime().toString("hhmmss"));
+    sqlite3_bind_int(statement, 34, 0);
+    sqlite3_bind_int(statement, 35, newImage->getNumberOfOverlays());
+
+    if (retrievedPACSID == "null")
+    {
+        sqlite3_bind_null(statement, 36);
+    }
+    else
+    {
+        sqlite3_bind_int64(statement, 36, retrievedPACSID.toLongLong());
+    }
+
+    bindText(statement, 37, getImagerPixelSpacingAsQString(newImage));
+    sqlite3_bind_double(statement, 38, newImage->getEstimatedRadiographicMagnificationFactor());
+    bindText(statement, 39, newImage->getTransferSyntaxUID());
 }
 
 QString LocalDatabaseImageDAL::buildSqlUpdate(Image *imageToUpdate)
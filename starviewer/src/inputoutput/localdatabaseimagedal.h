@@ -22,6 +22,8 @@
 #include "localdatabasebasedal.h"
 #include "image.h"
 
+struct sqlite3_stmt;
+
 namespace udg {
 
 class DicomMask;
@@ -76,8 +78,8 @@ private:
     /// SOPInstanceUID
     QString buildSqlSelectCountImages(const DicomMask &imageMaskToSelect);
 
-    /// Genera la sentència sql per inserir la nova imatge a la base de dades
-    QString buildSqlInsert(Image *newImage);
+    /// Binds the values of the given image to the parameters of the prepared insert statement
+    void bindInsertValues(sqlite3_stmt *statement, Image *newImage, const QString &retrievedPACSID);
 
     /// Genera la sentència sql per updatar la imatge a la base de dades
     QString buildSqlUpdate(Image *imageToUpdate);
@@ -15,6 +15,8 @@
 #include "localdatabasemanager.h"
 
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
 
 #include "patient.h"
 #include "study.h"
@@ -117,6 +119,8 @@ void LocalDatabaseManager::save(Patient *newPatient)
     {
         DatabaseConnection dbConnect;
         int status = SQLITE_OK;
+        QElapsedTimer timer;
+        timer.start();
 
         dbConnect.beginTransaction();
         /// Guardem primer els estudis
@@ -143,8 +147,22 @@ void LocalDatabaseManager::save(Patient *newPatient)
         else
         {
             dbConnect.commitTransaction();
+
+            int numberOfImages = 0;
+            foreach (Study *study, newPatient->getStudies())
+            {
+                foreach (Series *series, study->getSeries())
+                {
+                    numberOfImages += series->getImages().count();
+                }
+            }
+
+            qint64 elapsedTime = qMax(timer.elapsed(), Q_INT64_C(1));
+            INFO_LOG(QString("S'han guardat %1 imatges a la base de dades en %2 ms (%3 imatges/s)").arg(numberOfImages).arg(elapsedTime)
+                     .arg(numberOfImages * 1000 / elapsedTime));
         }
 
+        // Les miniatures es generen fora de la transacció perquè no bloquegin la base de dades
         foreach (Study *study, newPatient->getStudies())
         {
             createStudyThumbnails(study);
@@ -193,7 +211,13 @@ void LocalDatabaseManager::save(Series *seriesToSave)
         QList<Series*> seriesList;
         seriesList.append(seriesToSave);
 
-        saveSeries(&dbConnect, seriesList, currentDate, currentTime);
+        qint64 insertedBytes = 0;
+        status = saveSeries(&dbConnect, seriesList, currentDate, currentTime, insertedBytes);
+
+        if (status == SQLITE_OK)
+        {
+            status = addStudySizeInBytes(&dbConnect, studyParent, insertedBytes);
+        }
 
         if (status != SQLITE_OK)
         {
@@ -224,13 +248,15 @@ QList<Patient*> LocalDatabaseManager::queryPatient(const DicomMask &patientMaskT
     return queryResult;
 }
 
-QList<Patient*> LocalDatabaseManager::queryPatientStudy(const DicomMask &patientStudyMaskToQuery)
+QList<Patient*> LocalDatabaseManager::queryPatientStudy(const DicomMask &patientStudyMaskToQuery, int limit, int offset,
+                                                        LocalDatabaseStudyDAL::StudySortField sortField, Qt::SortOrder sortOrder)
 {
     DatabaseConnection dbConnect;
     LocalDatabaseStudyDAL studyDAL(&dbConnect);
     QList<Patient*> queryResult;
 
-    queryResult = studyDAL.queryPatientStudy(patientStudyMaskToQuery, QDate(), LocalDatabaseManager::LastAccessDateSelectedStudies);
+    queryResult = studyDAL.queryPatientStudy(patientStudyMaskToQuery, QDate(), LocalDatabaseManager::LastAccessDateSelectedStudies, limit, offset,
+                                             sortField, sortOrder);
     setLastError(studyDAL.getLastError());
 
     return queryResult;
@@ -423,12 +449,21 @@ void LocalDatabaseManager::deleteSeries(const QString &studyInstanceUID, const Q
         }
         else
         {
+            // The size of the series is subtracted from the size stored for the study
+            qint64 seriesSizeInBytes = HardDiskInformation::getDirectorySizeInBytes(getStudyPath(studyInstanceUID) + QDir::separator() + seriesInstanceUID);
             DatabaseConnection dbConnect;
 
             dbConnect.beginTransaction();
 
             int status = deleteSeriesStructureFromDatabase(&dbConnect, studyInstanceUID, seriesInstanceUID);
 
+            if (status == SQLITE_OK)
+            {
+                LocalDatabaseStudyDAL studyDAL(&dbConnect);
+                studyDAL.addSizeInBytes(studyInstanceUID, -seriesSizeInBytes);
+                status = studyDAL.getLastError();
+            }
+
             if (status != SQLITE_OK)
             {
                 setLastError(status);
@@ -467,20 +502,80 @@ void LocalDatabaseManager::deleteOldStudies()
             INFO_LOG("No hi ha estudis vells per esborrar");
         }
 
+        QStringList studyInstanceUIDsToDelete;
         foreach (Study *study, studyListToDelete)
         {
-            deleteStudy(study->getInstanceUID());
-            if (getLastError() != LocalDatabaseManager::Ok)
-            {
-                break;
-            }
-
+            studyInstanceUIDsToDelete << study->getInstanceUID();
             // Esborrem el punter a study
             delete study;
         }
+
+        deleteStudies(studyInstanceUIDsToDelete);
     }
 }
 
+void LocalDatabaseManager::deleteStudies(const QStringList &studyInstanceUIDsToDelete)
+{
+    m_lastError = Ok;
+
+    if (studyInstanceUIDsToDelete.isEmpty())
+    {
+        return;
+    }
+
+    // All the studies are deleted from the database in a single transaction, the files are deleted afterwards
+    DatabaseConnection dbConnect;
+    dbConnect.beginTransaction();
+
+    foreach (const QString &studyInstanceUID, studyInstanceUIDsToDelete)
+    {
+        INFO_LOG("S'esborrara de la base de dades l'estudi: " + studyInstanceUID);
+
+        int status = deleteStudyStructureFromDatabase(&dbConnect, studyInstanceUID);
+        if (status != SQLITE_OK)
+        {
+            dbConnect.rollbackTransaction();
+            setLastError(status);
+            return;
+        }
+    }
+
+    int status = dbConnect.commitTransaction();
+    if (status != SQLITE_OK)
+    {
+        // Si el commit falla l'sqlite desfà la transacció quan es tanca la connexió
+        setLastError(status);
+        return;
+    }
+
+    // Only notified once the studies are no longer in the database, otherwise they could be removed from the views and then stay in the cache
+    foreach (const QString &studyInstanceUID, studyInstanceUIDsToDelete)
+    {
+        emit studyWillBeDeleted(studyInstanceUID);
+    }
+
+    deleteStudiesFromHardDisk(studyInstanceUIDsToDelete);
+}
+
+QStringList LocalDatabaseManager::deleteStudiesFromHardDisk(const QStringList &studyInstanceUIDsToDelete)
+{
+    // The studies are no longer in the database, so a failure must not stop the deletion of the remaining directories. Otherwise they would be
+    // left on disk with nothing pointing to them
+    QStringList studiesNotDeleted;
+    foreach (const QString &studyInstanceUID, studyInstanceUIDsToDelete)
+    {
+        if (!deleteStudyFromHardDisk(studyInstanceUID))
+        {
+            ERROR_LOG("No s'ha pogut esborrar del disc l'estudi " + studyInstanceUID);
+            studiesNotDeleted << studyInstanceUID;
+        }
+    }
+
+    m_lastError = studiesNotDeleted.isEmpty() ? Ok : DeletingFilesError;
+
+    return studiesNotDeleted;
+}
+
 void LocalDatabaseManager::compact()
 {
     DatabaseConnection dbConnect;
@@ -490,6 +585,14 @@ void LocalDatabaseManager::compact()
     setLastError(utilDAL.getLastError());
 }
 
+void LocalDatabaseManager::createSearchIndex()
+{
+    DatabaseConnection dbConnect;
+    LocalDatabaseUtilDAL utilDAL(&dbConnect);
+
+    utilDAL.createSearchIndex();
+}
+
 int LocalDatabaseManager::getDatabaseRevision()
 {
     DatabaseConnection dbConnect;
@@ -568,6 +671,40 @@ QString LocalDatabaseManager::getStudyPath(const QString &studyInstanceUID)
     return LocalDatabaseManager::getCachePath() + studyInstanceUID;
 }
 
+void LocalDatabaseManager::freeSpaceIfCacheIsAlmostFull()
+{
+    Settings settings;
+    m_lastError = Ok;
+
+    if (!settings.getValue(InputOutputSettings::DeleteLeastRecentlyUsedStudiesNoFreeSpaceCriteria).toBool())
+    {
+        return;
+    }
+
+    quint64 freeSpaceInHardDisk = HardDiskInformation().getNumberOfFreeMBytes(LocalDatabaseManager::getCachePath());
+    quint64 minimumSpaceRequired = quint64(settings.getValue(InputOutputSettings::MinimumFreeGigaBytesForCache).toULongLong() * 1024);
+    quint64 MbytesToFreeWhenCacheIsFull = settings.getValue(InputOutputSettings::MinimumGigaBytesToFreeIfCacheIsFull).toULongLong() * 1024;
+
+    // Studies start being deleted when there are less than minimum + MbytesToFreeWhenCacheIsFull MB free, and they are deleted until there are
+    // minimum + 2 * MbytesToFreeWhenCacheIsFull MB free. This way the next retrieves find enough space and don't have to free it before starting.
+    quint64 freeSpaceToStartDeleting = minimumSpaceRequired + MbytesToFreeWhenCacheIsFull;
+    quint64 freeSpaceToReach = minimumSpaceRequired + 2 * MbytesToFreeWhenCacheIsFull;
+
+    if (freeSpaceInHardDisk < freeSpaceToStartDeleting)
+    {
+        qint64 cacheSizeInBytes;
+        {
+            DatabaseConnection dbConnect;
+            cacheSizeInBytes = LocalDatabaseStudyDAL(&dbConnect).getTotalSizeInBytes();
+        }
+
+        INFO_LOG(QString("Queden %1 MB lliures (la cache ocupa %2 MB), s'esborraran estudis vells fins tenir-ne %3 MB lliures")
+                    .arg(freeSpaceInHardDisk).arg(cacheSizeInBytes / 1024 / 1024).arg(freeSpaceToReach));
+
+        freeSpaceDeletingStudies(freeSpaceToReach - freeSpaceInHardDisk);
+    }
+}
+
 LocalDatabaseManager::LastError LocalDatabaseManager::getLastError()
 {
     return m_lastError;
@@ -646,7 +783,8 @@ int LocalDatabaseManager::saveStudies(DatabaseConnection *dbConnect, QList<Study
             .arg(studyToSave->getDateTime().toString("dd/MM/yyyy hh:mm:ss"), studyToSave->getInstanceUID()));
 
         // Primer guardem les sèries
-        status = saveSeries(dbConnect, studyToSave->getSeries(), currentDate, currentTime);
+        qint64 insertedBytes = 0;
+        status = saveSeries(dbConnect, studyToSave->getSeries(), currentDate, currentTime, insertedBytes);
 
         if (status != SQLITE_OK)
         {
@@ -670,19 +808,27 @@ int LocalDatabaseManager::saveStudies(DatabaseConnection *dbConnect, QList<Study
         {
             break;
         }
+
+        status = addStudySizeInBytes(dbConnect, studyToSave, insertedBytes);
+
+        if (status != SQLITE_OK)
+        {
+            break;
+        }
     }
 
     return status;
 }
 
-int LocalDatabaseManager::saveSeries(DatabaseConnection *dbConnect, QList<Series*> listSeriesToSave, const QDate &currentDate, const QTime &currentTime)
+int LocalDatabaseManager::saveSeries(DatabaseConnection *dbConnect, QList<Series*> listSeriesToSave, const QDate &currentDate, const QTime &currentTime,
+                                     qint64 &insertedBytes)
 {
     int status = SQLITE_OK;
 
     foreach (Series *seriesToSave, listSeriesToSave)
     {
         /// Primer guardem les imatges
-        status = saveImages(dbConnect, seriesToSave->getImages(), currentDate, currentTime);
+        status = saveImages(dbConnect, seriesToSave->getImages(), currentDate, currentTime, insertedBytes);
 
         if (status != SQLITE_OK)
         {
@@ -704,7 +850,8 @@ int LocalDatabaseManager::saveSeries(DatabaseConnection *dbConnect, QList<Series
     return status;
 }
 
-int LocalDatabaseManager::saveImages(DatabaseConnection *dbConnect, QList<Image*> listImageToSave, const QDate &currentDate, const QTime &currentTime)
+int LocalDatabaseManager::saveImages(DatabaseConnection *dbConnect, QList<Image*> listImageToSave, const QDate &currentDate, const QTime &currentTime,
+                                     qint64 &insertedBytes)
 {
     int status = SQLITE_OK;
 
@@ -713,7 +860,7 @@ int LocalDatabaseManager::saveImages(DatabaseConnection *dbConnect, QList<Image*
         imageToSave->setRetrievedDate(currentDate);
         imageToSave->setRetrievedTime(currentTime);
 
-        status = saveImage(dbConnect, imageToSave);
+        status = saveImage(dbConnect, imageToSave, insertedBytes);
 
 
         if (status != SQLITE_OK)
@@ -766,6 +913,19 @@ int LocalDatabaseManager::savePatientOfStudy(DatabaseConnection *dbConnect, Stud
     return patientDAL.getLastError();
 }
 
+int LocalDatabaseManager::addStudySizeInBytes(DatabaseConnection *dbConnect, Study *study, qint64 bytes)
+{
+    if (bytes == 0)
+    {
+        return SQLITE_OK;
+    }
+
+    LocalDatabaseStudyDAL studyDAL(dbConnect);
+    studyDAL.addSizeInBytes(study->getInstanceUID(), bytes);
+
+    return studyDAL.getLastError();
+}
+
 int LocalDatabaseManager::saveStudy(DatabaseConnection *dbConnect, Study *studyToSave)
 {
     LocalDatabaseStudyDAL studyDAL(dbConnect);
@@ -796,7 +956,7 @@ int LocalDatabaseManager::saveSeries(DatabaseConnection *dbConnect, Series *seri
     return seriesDAL.getLastError();
 }
 
-int LocalDatabaseManager::saveImage(DatabaseConnection *dbConnect, Image *imageToSave)
+int LocalDatabaseManager::saveImage(DatabaseConnection *dbConnect, Image *imageToSave, qint64 &insertedBytes)
 {
     LocalDatabaseImageDAL imageDAL(dbConnect);
 
@@ -820,6 +980,12 @@ int LocalDatabaseManager::saveImage(DatabaseConnection *dbConnect, Image *imageT
     }
     else
     {
+        // The file is only counted once, with its first frame. Replaced images don't change the size of the study.
+        if (imageDAL.getLastError() == SQLITE_OK && imageToSave->getFrameNumber() == 0)
+        {
+            insertedBytes += QFileInfo(imageToSave->getPath()).size();
+        }
+
         int status = saveDisplayShutters(dbConnect, imageToSave->getDisplayShutters(), imageToSave);
         if (status != SQLITE_OK)
         {
@@ -986,38 +1152,38 @@ int LocalDatabaseManager::deleteImageFromDatabase(DatabaseConnection *dbConnect,
 
 void LocalDatabaseManager::freeSpaceDeletingStudies(quint64 MbytesToErase)
 {
-    QList<Study*> studyListToDelete = queryStudyOrderByLastAccessDate(DicomMask());
+    DatabaseConnection dbConnect;
+    LocalDatabaseStudyDAL studyDAL(&dbConnect);
+    QList<QPair<QString, qint64> > studySizes = studyDAL.querySizeInBytesOrderByLastAccessDate(LocalDatabaseManager::LastAccessDateSelectedStudies);
+
+    setLastError(studyDAL.getLastError());
 
     if (getLastError() == LocalDatabaseManager::Ok)
     {
-        quint64 MbytesErased = 0;
-        int index = 0;
+        quint64 bytesToErase = MbytesToErase * 1024 * 1024;
+        quint64 bytesErased = 0;
+        QStringList studyInstanceUIDsToDelete;
 
-        while (index < studyListToDelete.count() && MbytesErased < MbytesToErase)
+        for (int index = 0; index < studySizes.count() && bytesErased < bytesToErase; index++)
         {
-            Study *studyToDelete = studyListToDelete.at(index);
-
-            emit studyWillBeDeleted(studyToDelete->getInstanceUID());
-            MbytesErased += HardDiskInformation::getDirectorySizeInBytes(LocalDatabaseManager::getCachePath() + studyToDelete->getInstanceUID()) / 1024 / 1024;
+            QString studyInstanceUID = studySizes.at(index).first;
+            qint64 studySizeInBytes = studySizes.at(index).second;
 
-            deleteStudy(studyToDelete->getInstanceUID());
-            if (getLastError() != LocalDatabaseManager::Ok)
+            // Only the studies saved before the size was stored in the database need to be measured on disk
+            if (studySizeInBytes < 0)
             {
-                break;
+                studySizeInBytes = HardDiskInformation::getDirectorySizeInBytes(getStudyPath(studyInstanceUID));
             }
 
-            index++;
+            studyInstanceUIDsToDelete << studyInstanceUID;
+            bytesErased += studySizeInBytes;
         }
 
-        // Esborrem els estudis de la memòria
-        foreach (Study *study, studyListToDelete)
-        {
-            delete study;
-        }
+        deleteStudies(studyInstanceUIDsToDelete);
     }
 }
 
-void LocalDatabaseManager::deleteStudyFromHardDisk(const QString &studyInstanceToDelete)
+bool LocalDatabaseManager::deleteStudyFromHardDisk(const QString &studyInstanceToDelete)
 {
     DirectoryUtilities deleteDirectory;
 
@@ -1030,6 +1196,8 @@ void LocalDatabaseManager::deleteStudyFromHardDisk(const QString &studyInstanceT
     {
         m_lastError = LocalDatabaseManager::Ok;
     }
+
+    return m_lastError == LocalDatabaseManager::Ok;
 }
 
 void LocalDatabaseManager::deleteSeriesFromHardDisk(const QString &studyInstanceUID, const QString &seriesInstanceUID)
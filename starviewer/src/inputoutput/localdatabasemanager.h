@@ -18,11 +18,13 @@
 
 #include <QList>
 #include <QObject>
+#include <QStringList>
 
 #include "image.h"
 #include "series.h"
 #include "study.h"
 #include "patient.h"
+#include "localdatabasestudydal.h"
 
 namespace udg {
 
@@ -61,7 +63,10 @@ public:
     /// Ens retorna els pacients que tenen estudis que compleixen amb els criteris de la màscara.
     /// Té en compte el patientID, patient name, data de l'estudi i l'study instance UID
     /// Retorna l'estructura omplerta fins al nivell d'study (no omple ni les sèries ni les imatges).
-    QList<Patient*> queryPatientStudy(const DicomMask &patientStudyMaskToQuery);
+    /// Si limit és >= 0 només es retornen com a molt limit estudis a partir de la posició offset en l'ordre donat, per poder-los carregar per pàgines
+    QList<Patient*> queryPatientStudy(const DicomMask &patientStudyMaskToQuery, int limit = -1, int offset = 0,
+                                      LocalDatabaseStudyDAL::StudySortField sortField = LocalDatabaseStudyDAL::SortByPatientName,
+                                      Qt::SortOrder sortOrder = Qt::AscendingOrder);
 
     /// Retorna si existeix l'estudi a la base de dades. Comprova si hi ha una estudi a la base de dades amb l'StudyInstanceUID de l'estudi passat.
     bool existsStudy(Study *study);
@@ -85,6 +90,9 @@ public:
     /// Compacta la base de dades
     void compact();
 
+    /// Crea l'índex de text complet per cercar estudis si no existeix. Si l'sqlite no el suporta les cerques es fan sense índex
+    void createSearchIndex();
+
     /// Retorna la revisió de la base de dades, sinó ha trobat de quina revisió és la base de dades retorna -1
     int getDatabaseRevision();
 
@@ -97,6 +105,11 @@ public:
     /// per tal d'alliberar suficient espai per permetre noves descàrregues
     bool thereIsAvailableSpaceOnHardDisk();
 
+    /// Si la opció de configuració d'esborrar estudis automàticament està activada i l'espai lliure és inferior al mínim més la quantitat a alliberar
+    /// configurada, esborra estudis vells fins a tenir lliure el mínim més dues vegades aquesta quantitat. Està pensat per cridar-se en segon pla després
+    /// de cada descàrrega, de manera que thereIsAvailableSpaceOnHardDisk() no hagi d'esborrar estudis abans de descarregar.
+    void freeSpaceIfCacheIsAlmostFull();
+
     /// Donat un study instance UID ens indica a quin ha de ser el directori de l'estudi
     QString getStudyPath(const QString &studyInstanceUID);
 
@@ -127,13 +140,22 @@ public:
     static QString getCachePath();
 
 signals:
-    /// Aquest signal s'emet per indicar que un estudi serà borrat de la base de dades per alliberar espai
+    /// Aquest signal s'emet per indicar que un estudi s'ha esborrat de la base de dades i se n'esborraran els fitxers. S'emet un cop s'ha fet
+    /// el commit, si l'esborrat falla no s'emet
     void studyWillBeDeleted(const QString &studyInstanceUID);
 
 public slots:
     /// Guarda el pacient a la base de dades, si no existeix insereix les dades, i si alguna de les dades ja existeix a la BD l'actualitza
     void save(Patient *newPatient);
 
+protected:
+    /// Esborra del disc els directoris dels estudis passats per paràmetre. Si algun no es pot esborrar continua amb la resta, assigna DeletingFilesError
+    /// com a últim error i retorna els UIDs dels estudis que no s'han pogut esborrar
+    QStringList deleteStudiesFromHardDisk(const QStringList &studyInstanceUIDsToDelete);
+
+    /// Esborra l'estudi del disc dur. Retorna fals si no s'ha pogut esborrar
+    virtual bool deleteStudyFromHardDisk(const QString &studyInstanceToDelete);
+
 private:
     /// Ens retorna els estudis que compleixen amb els criteris de la màscara, només es té en compte l'StudyUID ordenats per LastAccessDate de forma creixen
     QList<Study*> queryStudyOrderByLastAccessDate(const DicomMask &studyMaskToQuery);
@@ -142,10 +164,14 @@ private:
     int saveStudies(DatabaseConnection *dbConnect, QList<Study*> listStudyToSave, const QDate &currentDate, const QTime &currentTime);
 
     /// Guarda a la base de dades la llista de series passada per paràmetre, si alguna de les series ja existeix actualitza la info
-    int saveSeries(DatabaseConnection *dbConnect, QList<Series*> listSeriesToSave, const QDate &currentDate, const QTime &currentTime);
+    /// A insertedBytes s'hi suma la mida dels fitxers de les imatges noves
+    int saveSeries(DatabaseConnection *dbConnect, QList<Series*> listSeriesToSave, const QDate &currentDate, const QTime &currentTime,
+                   qint64 &insertedBytes);
 
     /// Guarda a la base de dades la llista d'imatges passada per paràmetre, si alguna de les imatges ja existeix actualitza la info
-    int saveImages(DatabaseConnection *dbConnect, QList<Image*> listImageToSave, const QDate &currentDate, const QTime &currentTime);
+    /// A insertedBytes s'hi suma la mida dels fitxers de les imatges noves
+    int saveImages(DatabaseConnection *dbConnect, QList<Image*> listImageToSave, const QDate &currentDate, const QTime &currentTime,
+                   qint64 &insertedBytes);
 
     /// Guarda a la base de dades la llista de display shutters relacionades amb la imatge passada per paràmetre
     int saveDisplayShutters(DatabaseConnection *dbConnect, QList<DisplayShutter> shuttersList, Image *relatedImage);
@@ -159,8 +185,11 @@ private:
     /// Guarda el pacient a la base de dades, si ja existeix li actualitza la informació
     int saveSeries(DatabaseConnection *dbConnect, Series *seriesToSave);
 
-    /// Guarda la imatge a la base de dades, si ja existeix li actualitza la informació
-    int saveImage(DatabaseConnection *dbConnect, Image *imageToSave);
+    /// Guarda la imatge a la base de dades, si ja existeix li actualitza la informació. Si la imatge és nova se suma la mida del seu fitxer a insertedBytes
+    int saveImage(DatabaseConnection *dbConnect, Image *imageToSave, qint64 &insertedBytes);
+
+    /// Suma els bytes donats a la mida de l'estudi guardada a la base de dades
+    int addStudySizeInBytes(DatabaseConnection *dbConnect, Study *study, qint64 bytes);
 
     /// Esborra a base la jerarquia pacient/estudi/series/imatge de l'estudi passat per paràmetre, si es passar un valor buit no esborra res.
     int deleteStudyStructureFromDatabase(DatabaseConnection *dbConnect, const QString &studyInstanceUIDToDelete);
@@ -193,10 +222,11 @@ private:
     void deleteRetrievedObjects(Series *failedSeries);
 
     /// Esborra estudis  fins alliberar l'espai passat per paràmetre, comença esborrant els estudisque fa més que no es visualitzen
+    /// Utilitza la mida dels estudis guardada a la base de dades, només mesura al disc els estudis guardats abans que es guardés la mida
     void freeSpaceDeletingStudies(quint64 MbytesToErase);
 
-    /// Esborra l'estudi del disc dur
-    void deleteStudyFromHardDisk(const QString &studyInstanceToDelete);
+    /// Esborra de la base de dades, en una sola transacció, i del disc els estudis passats per paràmetre
+    void deleteStudies(const QStringList &studyInstanceUIDsToDelete);
 
     /// Esborra la sèrie del disc dur
     void deleteSeriesFromHardDisk(const QString &studyInstanceToDelete, const QString &seriesInstanceToDelete);
@@ -15,10 +15,12 @@
 #include <sqlite3.h>
 #include <QString>
 #include <QDate>
+#include <QStringList>
 
 #include "patient.h"
 #include "localdatabasestudydal.h"
 #include "databaseconnection.h"
+#include "localdatabaseutildal.h"
 #include "logging.h"
 #include "dicommask.h"
 
@@ -116,19 +118,22 @@ QList<Study*> LocalDatabaseStudyDAL::query(const DicomMask &studyMask, QDate las
     return studyList;
 }
 
-QList<Patient*> LocalDatabaseStudyDAL::queryPatientStudy(const DicomMask &patientStudyMaskToQuery, QDate lastAccessDateMinor, QDate lastAccessDateEqualOrMajor)
+QList<Patient*> LocalDatabaseStudyDAL::queryPatientStudy(const DicomMask &patientStudyMaskToQuery, QDate lastAccessDateMinor, QDate lastAccessDateEqualOrMajor,
+                                                        int limit, int offset, StudySortField sortField, Qt::SortOrder sortOrder)
 {
     int columns, rows;
     char **reply = NULL;
     char **error = NULL;
     QList<Patient*> patientList;
 
-    m_lastSqliteError = sqlite3_get_table(m_dbConnection->getConnection(),
-                                          buildSqlSelectStudyPatient(patientStudyMaskToQuery, lastAccessDateMinor, lastAccessDateEqualOrMajor).toUtf8().constData(),
-                                          &reply, &rows, &columns, error);
+    bool useSearchIndex = LocalDatabaseUtilDAL(m_dbConnection).existsSearchIndex();
+    QString sqlSentence = buildSqlSelectStudyPatient(patientStudyMaskToQuery, lastAccessDateMinor, lastAccessDateEqualOrMajor, limit, offset,
+                                                     sortField, sortOrder, useSearchIndex);
+
+    m_lastSqliteError = sqlite3_get_table(m_dbConnection->getConnection(), sqlSentence.toUtf8().constData(), &reply, &rows, &columns, error);
     if (getLastError() != SQLITE_OK)
     {
-        logError (buildSqlSelectStudyPatient(patientStudyMaskToQuery, lastAccessDateMinor, lastAccessDateEqualOrMajor));
+        logError(sqlSentence);
         return patientList;
     }
 
@@ -263,7 +268,8 @@ QString LocalDatabaseStudyDAL::buildSqlSelect(const DicomMask &studyMaskToSelect
 }
 
 QString LocalDatabaseStudyDAL::buildSqlSelectStudyPatient(const DicomMask &studyMaskToSelect, const QDate &lastAccessDateMinor,
-                                                          const QDate &lastAccessDateEqualOrMajor)
+                                                          const QDate &lastAccessDateEqualOrMajor, int limit, int offset, StudySortField sortField,
+                                                          Qt::SortOrder sortOrder, bool useSearchIndex)
 {
     QString selectSentence = "Select InstanceUID, PatientID, Study.ID, PatientAge, PatientWeigth, PatientHeigth, Modalities, Date, Time, "
                             "AccessionNumber, Description, ReferringPhysicianName, LastAccessDate, RetrievedDate, RetrievedTime, "
@@ -278,15 +284,19 @@ QString LocalDatabaseStudyDAL::buildSqlSelectStudyPatient(const DicomMask &study
         whereSentence += QString(" and InstanceUID = '%1' ").arg(DatabaseConnection::formatTextToValidSQLSyntax(studyMaskToSelect.getStudyInstanceUID()));
     }
 
-    if (!studyMaskToSelect.getPatientID().isEmpty() && studyMaskToSelect.getPatientID() != "*")
+    // Els filtres de text es resolen amb l'índex de text complet si la BD en té
+    if (useSearchIndex)
     {
-        whereSentence += QString(" and Patient.DICOMPatientID like '%%1%' ")
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(studyMaskToSelect.getPatientID().replace("*", "")));
+        QString searchIndexMatchExpression = buildSearchIndexMatchExpression(studyMaskToSelect);
+        if (!searchIndexMatchExpression.isEmpty())
+        {
+            whereSentence += QString(" and Study.rowid in (Select docid From StudySearch Where StudySearch Match '%1') ")
+                                .arg(searchIndexMatchExpression);
+        }
     }
-    if (!studyMaskToSelect.getPatientName().isEmpty() && studyMaskToSelect.getPatientName() != "*")
+    else
     {
-        whereSentence += QString(" and Patient.Name like '%%1%' ")
-                            .arg(DatabaseConnection::formatTextToValidSQLSyntax(studyMaskToSelect.getPatientName().replace("*", "")));
+        whereSentence += buildSqlLikeTextFilters(studyMaskToSelect);
     }
 
     // Si filtrem per data
@@ -314,9 +324,114 @@ QString LocalDatabaseStudyDAL::buildSqlSelectStudyPatient(const DicomMask &study
         whereSentence += QString(" and Modalities like '%%1%' ").arg(studyMaskToSelect.getSeriesModality());
     }
 
-    QString orderBySentence = " Order by Patient.Name";
+    QString orderBySentence = buildSqlOrderBy(sortField, sortOrder);
+
+    QString limitSentence;
+    if (limit >= 0)
+    {
+        limitSentence = QString(" Limit %1 Offset %2").arg(limit).arg(offset);
+    }
+
+    return selectSentence + whereSentence + orderBySentence + limitSentence;
+}
+
+QString LocalDatabaseStudyDAL::buildSearchIndexMatchExpression(const DicomMask &studyMaskToSelect)
+{
+    QList<QPair<QString, QString> > columnsAndValues;
+    columnsAndValues << qMakePair(QString("PatientName"), studyMaskToSelect.getPatientName())
+                     << qMakePair(QString("PatientID"), studyMaskToSelect.getPatientID())
+                     << qMakePair(QString("AccessionNumber"), studyMaskToSelect.getAccessionNumber())
+                     << qMakePair(QString("Description"), studyMaskToSelect.getStudyDescription());
+
+    QStringList terms;
+    for (int i = 0; i < columnsAndValues.count(); i++)
+    {
+        // Només es conserven lletres i números perquè els valors no puguin trencar l'expressió. Cada paraula es cerca com a prefix, el tokenizer de
+        // l'índex tampoc té en compte majúscules ni accents de les paraules cercades
+        QString value = columnsAndValues.at(i).second;
+        for (int j = 0; j < value.length(); j++)
+        {
+            if (!value.at(j).isLetterOrNumber())
+            {
+                value[j] = ' ';
+            }
+        }
 
-    return selectSentence + whereSentence + orderBySentence;
+        foreach (const QString &word, value.split(' ', QString::SkipEmptyParts))
+        {
+            terms << QString("%1:%2*").arg(columnsAndValues.at(i).first, word);
+        }
+    }
+
+    return terms.join(" ");
+}
+
+QString LocalDatabaseStudyDAL::buildSqlLikeTextFilters(const DicomMask &studyMaskToSelect)
+{
+    QList<QPair<QString, QString> > columnsAndValues;
+    columnsAndValues << qMakePair(QString("Patient.Name"), studyMaskToSelect.getPatientName())
+                     << qMakePair(QString("Patient.DICOMPatientID"), studyMaskToSelect.getPatientID())
+                     << qMakePair(QString("AccessionNumber"), studyMaskToSelect.getAccessionNumber())
+                     << qMakePair(QString("Description"), studyMaskToSelect.getStudyDescription());
+
+    QString likeSentence;
+    for (int i = 0; i < columnsAndValues.count(); i++)
+    {
+        QString value = columnsAndValues.at(i).second;
+        value.remove('*');
+        if (!value.isEmpty())
+        {
+            likeSentence += QString(" and %1 like '%%2%' ").arg(columnsAndValues.at(i).first, DatabaseConnection::formatTextToValidSQLSyntax(value));
+        }
+    }
+
+    return likeSentence;
+}
+
+QString LocalDatabaseStudyDAL::buildSqlOrderBy(StudySortField sortField, Qt::SortOrder sortOrder)
+{
+    QStringList columns;
+    switch (sortField)
+    {
+        case SortByPatientID:
+            columns << "Patient.DICOMPatientID";
+            break;
+        case SortByPatientBirthDate:
+            columns << "Patient.Birthdate";
+            break;
+        case SortByPatientAge:
+            columns << "PatientAge";
+            break;
+        case SortByModalities:
+            columns << "Modalities";
+            break;
+        case SortByDescription:
+            columns << "Description";
+            break;
+        case SortByDate:
+            columns << "Date" << "Time";
+            break;
+        case SortByStudyID:
+            columns << "Study.ID";
+            break;
+        case SortByAccessionNumber:
+            columns << "AccessionNumber";
+            break;
+        case SortByInstanceUID:
+            break;
+        case SortByReferringPhysicianName:
+            columns << "ReferringPhysicianName";
+            break;
+        case SortByPatientName:
+        default:
+            columns << "Patient.Name";
+            break;
+    }
+    columns << "InstanceUID";
+
+    QString direction = sortOrder == Qt::DescendingOrder ? " Desc" : " Asc";
+
+    return " Order by " + columns.join(direction + ", ") + direction;
 }
 
 QString LocalDatabaseStudyDAL::buildSqlGetPatientIDFromStudyInstanceUID(const QString &studyInstanceUID)
@@ -329,14 +444,87 @@ QString LocalDatabaseStudyDAL::buildSqlGetPatientIDFromStudyInstanceUID(const QS
     return selectSentence;
 }
 
+void LocalDatabaseStudyDAL::addSizeInBytes(const QString &studyInstanceUID, qint64 bytes)
+{
+    // If SizeInBytes is null the result of the addition is null too
+    QString sqlSentence = QString("Update Study set SizeInBytes = SizeInBytes + %1 Where InstanceUID = '%2'")
+                                  .arg(bytes)
+                                  .arg(DatabaseConnection::formatTextToValidSQLSyntax(studyInstanceUID));
+
+    m_lastSqliteError = sqlite3_exec(m_dbConnection->getConnection(), sqlSentence.toUtf8().constData(), 0, 0, 0);
+
+    if (getLastError() != SQLITE_OK)
+    {
+        logError(sqlSentence);
+    }
+}
+
+QList<QPair<QString, qint64> > LocalDatabaseStudyDAL::querySizeInBytesOrderByLastAccessDate(const QDate &lastAccessDateEqualOrMajor)
+{
+    int columns;
+    int rows;
+    char **reply = NULL;
+    char **error = NULL;
+    QList<QPair<QString, qint64> > studySizes;
+    QString sqlSentence = "Select InstanceUID, SizeInBytes From Study ";
+
+    if (lastAccessDateEqualOrMajor.isValid())
+    {
+        sqlSentence += QString("Where '%1' <= LastAccessDate ").arg(lastAccessDateEqualOrMajor.toString("yyyyMMdd"));
+    }
+
+    sqlSentence += "Order by LastAccessDate";
+
+    m_lastSqliteError = sqlite3_get_table(m_dbConnection->getConnection(), sqlSentence.toUtf8().constData(), &reply, &rows, &columns, error);
+
+    if (getLastError() != SQLITE_OK)
+    {
+        logError(sqlSentence);
+        return studySizes;
+    }
+
+    // index = 1 ignorem les capçaleres
+    for (int index = 1; index <= rows; index++)
+    {
+        const char *sizeInBytes = reply[1 + index * columns];
+        studySizes.append(qMakePair(QString(reply[index * columns]), sizeInBytes ? QString(sizeInBytes).toLongLong() : Q_INT64_C(-1)));
+    }
+
+    sqlite3_free_table(reply);
+
+    return studySizes;
+}
+
+qint64 LocalDatabaseStudyDAL::getTotalSizeInBytes()
+{
+    int columns;
+    int rows;
+    char **reply = NULL;
+    char **error = NULL;
+    QString sqlSentence = "Select ifnull(sum(SizeInBytes), 0) From Study";
+
+    m_lastSqliteError = sqlite3_get_table(m_dbConnection->getConnection(), sqlSentence.toUtf8().constData(), &reply, &rows, &columns, error);
+
+    if (getLastError() != SQLITE_OK)
+    {
+        logError(sqlSentence);
+        return 0;
+    }
+
+    qint64 totalSizeInBytes = rows >= 1 ? QString(reply[1]).toLongLong() : 0;
+    sqlite3_free_table(reply);
+
+    return totalSizeInBytes;
+}
+
 QString LocalDatabaseStudyDAL::buildSqlInsert(Study *newStudy, const QDate &lastAcessDate)
 {
     QString insertSentence = QString ("Insert into Study   (InstanceUID, PatientID, ID, PatientAge, PatientWeigth, PatientHeigth, "
                                                            "Modalities, Date, Time, AccessionNumber, Description, "
                                                            "ReferringPhysicianName, LastAccessDate, RetrievedDate, "
-                                                           "RetrievedTime , State) "
+                                                           "RetrievedTime , State, SizeInBytes) "
                                                    "values ('%1', %2, '%3', '%4', %5, %6, '%7', '%8', '%9', '%10', '%11', "
-                                      "'%12', '%13', '%14', '%15', %16)")
+                                      "'%12', '%13', '%14', '%15', %16, 0)")
                                     .arg(DatabaseConnection::formatTextToValidSQLSyntax(newStudy->getInstanceUID()))
                                     .arg(newStudy->getParentPatient()->getDatabaseID())
                                     .arg(DatabaseConnection::formatTextToValidSQLSyntax(newStudy->getID()))
@@ -16,6 +16,7 @@
 #define UDGLOCALDATABASESTUDY_H
 
 #include <QList>
+#include <QPair>
 
 #include "localdatabasebasedal.h"
 #include "study.h"
@@ -31,6 +32,10 @@ class DICOMSource;
   */
 class LocalDatabaseStudyDAL : public LocalDatabaseBaseDAL {
 public:
+    /// Camps pels quals es poden ordenar els estudis de queryPatientStudy
+    enum StudySortField { SortByPatientName, SortByPatientID, SortByPatientBirthDate, SortByPatientAge, SortByModalities, SortByDescription,
+                          SortByDate, SortByStudyID, SortByAccessionNumber, SortByInstanceUID, SortByReferringPhysicianName };
+
     LocalDatabaseStudyDAL(DatabaseConnection *dbConnection);
 
     /// Insereix el nou estudi, i insereix com LastAccessDate la data actual
@@ -50,15 +55,35 @@ public:
     /// Cerca les estudis que compleixen amb els criteris de la màscara de cerca, només té en compte l'StudyUID
     QList<Study*> query(const DicomMask &studyMaskToQuery, QDate lastAccessDateMinor = QDate(), QDate lastAccessDateEqualOrMajor = QDate());
 
-    /// Ens retorna els pacients que tenen estudis que compleixen amb els criteris de la màscara. Té en compte el patientID, patient name, data de l'estudi
-    /// i l'study instance UID
+    /// Ens retorna els pacients que tenen estudis que compleixen amb els criteris de la màscara. Té en compte el patientID, patient name, accession number,
+    /// descripció i data de l'estudi i l'study instance UID. Els camps de text es cerquen per prefix de paraula sense tenir en compte majúscules ni accents.
+    /// Si la BD no té l'índex de text complet es cerquen com a subcadena. Els estudis s'ordenen pel camp i l'ordre donats. Si limit és >= 0 només es
+    /// retornen com a molt limit estudis a partir de la posició offset
     QList<Patient*> queryPatientStudy(const DicomMask &patientStudyMaskToQuery, QDate lastAccessDateMinor = QDate(),
-                                      QDate lastAccessDateEqualOrMajor = QDate());
+                                      QDate lastAccessDateEqualOrMajor = QDate(), int limit = -1, int offset = 0,
+                                      StudySortField sortField = SortByPatientName, Qt::SortOrder sortOrder = Qt::AscendingOrder);
 
     /// Retorna el ID amb que Starviewer indentifica un pacient (aquest és diferent del Patient ID de DICOM) a partir de l'UID d'un estudi, si no troba l'estudi
     /// retorna -1
     qlonglong getPatientIDFromStudyInstanceUID(const QString &studyInstanceUID);
 
+    /// Adds the given number of bytes (that can be negative) to the disk size stored for the study. Studies saved before the size was stored
+    /// have an unknown size, which is kept unknown.
+    void addSizeInBytes(const QString &studyInstanceUID, qint64 bytes);
+
+    /// Returns the Study Instance UID and the disk size in bytes of the studies with a LastAccessDate equal or greater than the given one, if it's valid,
+    /// ordered by LastAccessDate. The size is -1 for studies that have been saved before the size was stored.
+    QList<QPair<QString, qint64> > querySizeInBytesOrderByLastAccessDate(const QDate &lastAccessDateEqualOrMajor = QDate());
+
+    /// Returns the sum of the disk sizes of all the studies with a known size
+    qint64 getTotalSizeInBytes();
+
+    /// Construeix l'expressió MATCH per la taula StudySearch a partir dels camps de text de la màscara. Retorna un string buit si no n'hi ha cap
+    static QString buildSearchIndexMatchExpression(const DicomMask &studyMaskToSelect);
+
+    /// Construeix la clàusula Order by de queryPatientStudy. L'UID de l'estudi desempata els valors iguals perquè l'ordre sigui estable entre pàgines
+    static QString buildSqlOrderBy(StudySortField sortField, Qt::SortOrder sortOrder);
+
 private:
     /// Construeix la sentència sql per inserir el nou estudi
     QString buildSqlInsert(Study *newStudy, const QDate &lastAcessDate);
@@ -73,8 +98,13 @@ private:
     /// Construeix la setència per esborrar l'estudi a partir de la màscara, només té en compte el StudyUID
     QString buildSqlDelete(const DicomMask &studyMaskToDelete);
 
-    /// Construeix la sentència per fer select d'estudi i pacients a partir de la màscara. Té en compte studyUID, Patient Id, Patient Name, i data de l'estudi
-    QString buildSqlSelectStudyPatient(const DicomMask &studyMaskToSelect, const QDate &lastAccessDateMinor, const QDate &lastAccessDateEqualOrMajor);
+    /// Construeix la sentència per fer select d'estudi i pacients a partir de la màscara. Té en compte studyUID, Patient Id, Patient Name, accession number,
+    /// descripció i data de l'estudi. Els camps de text es cerquen amb l'índex de text complet si useSearchIndex és cert i amb like si és fals
+    QString buildSqlSelectStudyPatient(const DicomMask &studyMaskToSelect, const QDate &lastAccessDateMinor, const QDate &lastAccessDateEqualOrMajor,
+                                       int limit, int offset, StudySortField sortField, Qt::SortOrder sortOrder, bool useSearchIndex);
+
+    /// Construeix les condicions like per cercar els camps de text de la màscara com a subcadena, per les BD sense índex de text complet
+    QString buildSqlLikeTextFilters(const DicomMask &studyMaskToSelect);
 
     /// Retorna la sentència per buscar el pacient d'un estudi a partir del Study Instance UID
     QString buildSqlGetPatientIDFromStudyInstanceUID(const QString &studyInstanceUID);
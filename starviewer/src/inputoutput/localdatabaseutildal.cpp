@@ -14,6 +14,7 @@
 
 #include <sqlite3.h>
 #include <QString>
+#include <QStringList>
 #include <QRegExp>
 
 #include "localdatabaseutildal.h"
@@ -38,9 +39,115 @@ void LocalDatabaseUtilDAL::compact()
     if (getLastError() != SQLITE_OK)
     {
         logError(compactSentence);
+        return;
+    }
+
+    // Vacuum can change the rowids of the studies, so the search index, that uses them as docid, has to be rebuilt
+    if (!existsSearchIndex())
+    {
+        return;
+    }
+
+    QStringList rebuildSearchIndexSentences;
+    rebuildSearchIndexSentences << "Delete From StudySearch" << buildSqlFillSearchIndex();
+
+    QString failedSentence;
+    if (!executeInTransaction(rebuildSearchIndexSentences, failedSentence))
+    {
+        logError(failedSentence);
+    }
+}
+
+void LocalDatabaseUtilDAL::createSearchIndex()
+{
+    m_lastSqliteError = SQLITE_OK;
+
+    if (existsSearchIndex() || getLastError() != SQLITE_OK)
+    {
+        return;
+    }
+
+    // The index is created here instead of in database.sql because it needs an sqlite built with FTS4. Without it the creation fails, the whole
+    // transaction is rolled back and the queries search with like instead
+    QStringList createSearchIndexSentences;
+    createSearchIndexSentences
+        << "Create Virtual Table StudySearch Using fts4(PatientName, PatientID, AccessionNumber, Description, tokenize=unicode61)"
+        << "Create Trigger StudySearch_StudyInserted After Insert On Study "
+           "Begin "
+           "  Insert Into StudySearch (docid, PatientName, PatientID, AccessionNumber, Description) "
+           "    Select new.rowid, Name, DICOMPatientID, new.AccessionNumber, new.Description From Patient Where ID = new.PatientID; "
+           "End"
+        << "Create Trigger StudySearch_StudyUpdated After Update Of PatientID, AccessionNumber, Description On Study "
+           "Begin "
+           "  Delete From StudySearch Where docid = old.rowid; "
+           "  Insert Into StudySearch (docid, PatientName, PatientID, AccessionNumber, Description) "
+           "    Select new.rowid, Name, DICOMPatientID, new.AccessionNumber, new.Description From Patient Where ID = new.PatientID; "
+           "End"
+        << "Create Trigger StudySearch_StudyDeleted After Delete On Study "
+           "Begin "
+           "  Delete From StudySearch Where docid = old.rowid; "
+           "End"
+        << "Create Trigger StudySearch_PatientUpdated After Update Of DICOMPatientID, Name On Patient "
+           "Begin "
+           "  Update StudySearch Set PatientName = new.Name, PatientID = new.DICOMPatientID "
+           "    Where docid In (Select rowid From Study Where PatientID = new.ID); "
+           "End"
+        << buildSqlFillSearchIndex();
+
+    QString failedSentence;
+    if (!executeInTransaction(createSearchIndexSentences, failedSentence))
+    {
+        WARN_LOG("No s'ha pogut crear l'index de text complet dels estudis, les cerques es faran sense index. Error: " +
+                 QString::number(getLastError()));
     }
 }
 
+bool LocalDatabaseUtilDAL::executeInTransaction(const QStringList &sentences, QString &failedSentence)
+{
+    QStringList transactionSentences;
+    transactionSentences << "Begin Immediate" << sentences << "Commit";
+
+    foreach (const QString &sentence, transactionSentences)
+    {
+        m_lastSqliteError = sqlite3_exec(m_dbConnection->getConnection(), sentence.toUtf8().constData(), 0, 0, 0);
+
+        if (getLastError() != SQLITE_OK)
+        {
+            failedSentence = sentence;
+            // Si ha fallat el Begin no hi ha cap transacció per desfer. El resultat del Rollback no es guarda per no perdre l'error original
+            if (sentence != transactionSentences.first())
+            {
+                sqlite3_exec(m_dbConnection->getConnection(), "Rollback", 0, 0, 0);
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool LocalDatabaseUtilDAL::existsSearchIndex()
+{
+    int columns;
+    int rows;
+    char **reply = NULL;
+    char **error = NULL;
+    QString existsSearchIndexSentence = "Select name From sqlite_master Where type = 'table' and name = 'StudySearch'";
+
+    m_lastSqliteError = sqlite3_get_table(m_dbConnection->getConnection(), existsSearchIndexSentence.toUtf8().constData(), &reply, &rows, &columns,
+                                          error);
+
+    if (getLastError() != SQLITE_OK)
+    {
+        logError(existsSearchIndexSentence);
+        return false;
+    }
+
+    sqlite3_free_table(reply);
+
+    return rows > 0;
+}
+
 int LocalDatabaseUtilDAL::getDatabaseRevision()
 {
     int columns;
@@ -89,6 +196,13 @@ void LocalDatabaseUtilDAL::updateDatabaseRevision(int databaseRevision)
     }
 }
 
+QString LocalDatabaseUtilDAL::buildSqlFillSearchIndex()
+{
+    return "Insert Into StudySearch (docid, PatientName, PatientID, AccessionNumber, Description) "
+           "Select Study.rowid, Patient.Name, Patient.DICOMPatientID, Study.AccessionNumber, Study.Description "
+           "From Study, Patient Where Study.PatientID = Patient.ID";
+}
+
 QString LocalDatabaseUtilDAL::buildSqlGetDatabaseRevision()
 {
     return "select * from DatabaseRevision";
@@ -19,6 +19,7 @@
 #include "localdatabasebasedal.h"
 
 class QString;
+class QStringList;
 
 namespace udg {
 
@@ -29,9 +30,16 @@ class LocalDatabaseUtilDAL : public LocalDatabaseBaseDAL {
 public:
     LocalDatabaseUtilDAL(DatabaseConnection *dbConnection);
 
-    /// Compacta la BD
+    /// Compacta la BD i reconstrueix l'índex de text complet dels estudis si existeix
     void compact();
 
+    /// Crea l'índex de text complet dels estudis (taula StudySearch) si encara no existeix i l'omple amb els estudis de la BD. Si l'sqlite no té FTS4
+    /// no es crea i les cerques d'estudis es fan sense índex
+    void createSearchIndex();
+
+    /// Indica si la BD té l'índex de text complet dels estudis
+    bool existsSearchIndex();
+
     /// Retorna la revisió de la BD a la que està connectada, si no troba a quina revisió pertany retorna -1
     int getDatabaseRevision();
 
@@ -39,6 +47,13 @@ public:
     void updateDatabaseRevision(int databaseRevision);
 
 private:
+    /// Executa les sentències una darrera l'altra dins una transacció. Si alguna falla desfà la transacció, deixa l'error a getLastError(), posa
+    /// la sentència que ha fallat a failedSentence i retorna fals
+    bool executeInTransaction(const QStringList &sentences, QString &failedSentence);
+
+    /// Retorna la sentència que omple l'índex de text complet amb tots els estudis
+    QString buildSqlFillSearchIndex();
+
     /// Ens retorna un string amb el select a executar per retorna la revisió de la base de dades sobre la qual estem connectats
     QString buildSqlGetDatabaseRevision();
 
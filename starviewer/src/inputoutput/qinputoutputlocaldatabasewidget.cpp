@@ -14,7 +14,9 @@
 
 #include "qinputoutputlocaldatabasewidget.h"
 
+#include <QHeaderView>
 #include <QMessageBox>
+#include <QScrollBar>
 #include <QShortcut>
 
 #include "logging.h"
@@ -33,15 +35,17 @@
 
 namespace udg {
 
+const int QInputOutputLocalDatabaseWidget::StudiesPageSize = 200;
+
 QInputOutputLocalDatabaseWidget::QInputOutputLocalDatabaseWidget(QWidget *parent)
- : QWidget(parent)
+ : QWidget(parent), m_numberOfLoadedStudies(0), m_allStudiesLoaded(true)
 {
     setupUi(this);
 
     createContextMenuQStudyTreeWidget();
 
     Settings settings;
-    settings.restoreColumnsWidths(InputOutputSettings::LocalDatabaseStudyList, m_studyTreeWidget->getQTreeWidget());
+    settings.restoreColumnsWidths(InputOutputSettings::LocalDatabaseStudyList, m_studyTreeWidget->getQTreeView());
     settings.restoreGeometry(InputOutputSettings::LocalDatabaseSplitterState, m_StudyTreeSeriesListQSplitter);
 
     QStudyTreeWidget::ColumnIndex sortByColumn = (QStudyTreeWidget::ColumnIndex)
@@ -69,7 +73,7 @@ QInputOutputLocalDatabaseWidget::QInputOutputLocalDatabaseWidget(QWidget *parent
 QInputOutputLocalDatabaseWidget::~QInputOutputLocalDatabaseWidget()
 {
     Settings settings;
-    settings.saveColumnsWidths(InputOutputSettings::LocalDatabaseStudyList, m_studyTreeWidget->getQTreeWidget());
+    settings.saveColumnsWidths(InputOutputSettings::LocalDatabaseStudyList, m_studyTreeWidget->getQTreeView());
 
     // Guardem per quin columna està ordenada la llista d'estudis i en quin ordre
     settings.setValue(InputOutputSettings::LocalDatabaseStudyListSortByColumn, m_studyTreeWidget->getSortColumn());
@@ -100,6 +104,10 @@ void QInputOutputLocalDatabaseWidget::createConnections()
     /// Si movem el QSplitter capturem el signal per guardar la seva posició
     connect(m_StudyTreeSeriesListQSplitter, SIGNAL(splitterMoved (int, int)), SLOT(qSplitterPositionChanged()));
     connect(m_qwidgetSelectPacsToStoreDicomImage, SIGNAL(selectedPacsToStore()), SLOT(sendSelectedStudiesToSelectedPacs()));
+
+    // Quan s'arriba al final de la llista d'estudis es carrega la pàgina següent
+    connect(m_studyTreeWidget->getQTreeView()->verticalScrollBar(), SIGNAL(valueChanged(int)), SLOT(studyListScrolled(int)));
+    connect(m_studyTreeWidget->getQTreeView()->header(), SIGNAL(sortIndicatorChanged(int, Qt::SortOrder)), SLOT(studyListSortChanged()));
 }
 
 void QInputOutputLocalDatabaseWidget::createContextMenuQStudyTreeWidget()
@@ -137,6 +145,9 @@ void QInputOutputLocalDatabaseWidget::clear()
 {
     m_studyTreeWidget->clear();
     m_seriesThumbnailPreviewWidget->clear();
+
+    m_numberOfLoadedStudies = 0;
+    m_allStudiesLoaded = true;
 }
 
 void QInputOutputLocalDatabaseWidget::setPacsManager(PacsManager *pacsManager)
@@ -155,13 +166,19 @@ void QInputOutputLocalDatabaseWidget::queryStudy(DicomMask queryMask)
 
     clear();
 
-    patientStudyList = localDatabaseManager.queryPatientStudy(queryMask);
+    // Només es consulta la primera pàgina, la resta es carreguen a mesura que l'usuari fa scroll
+    patientStudyList = localDatabaseManager.queryPatientStudy(queryMask, StudiesPageSize, 0, getStudySortField(),
+                                                              m_studyTreeWidget->getSortOrderColumn());
 
     if (showDatabaseManagerError(localDatabaseManager.getLastError()))
     {
         return;
     }
 
+    m_lastQueryMask = queryMask;
+    m_numberOfLoadedStudies = patientStudyList.count();
+    m_allStudiesLoaded = patientStudyList.count() < StudiesPageSize;
+
     // Aquest mètode a part de ser cridada quan l'usuari fa click al botó search, també es cridada al
     // constructor d'aquesta classe, per a que al engegar l'aplicació ja es mostri la llista d'estudis
     // que hi ha a la base de dades local. Si el mètode no troba cap estudi a la base de dades local
@@ -182,6 +199,84 @@ void QInputOutputLocalDatabaseWidget::queryStudy(DicomMask queryMask)
     }
 }
 
+void QInputOutputLocalDatabaseWidget::studyListScrolled(int value)
+{
+    if (m_allStudiesLoaded || value < m_studyTreeWidget->getQTreeView()->verticalScrollBar()->maximum())
+    {
+        return;
+    }
+
+    LocalDatabaseManager localDatabaseManager;
+    QList<Patient*> patientStudyList = localDatabaseManager.queryPatientStudy(m_lastQueryMask, StudiesPageSize, m_numberOfLoadedStudies,
+                                                                              getStudySortField(), m_studyTreeWidget->getSortOrderColumn());
+
+    if (showDatabaseManagerError(localDatabaseManager.getLastError()))
+    {
+        m_allStudiesLoaded = true;
+        return;
+    }
+
+    m_numberOfLoadedStudies += patientStudyList.count();
+    m_allStudiesLoaded = patientStudyList.count() < StudiesPageSize;
+    m_studyTreeWidget->insertPatientList(patientStudyList);
+}
+
+void QInputOutputLocalDatabaseWidget::studyListSortChanged()
+{
+    if (m_allStudiesLoaded)
+    {
+        return;
+    }
+
+    // Els estudis carregats són els primers en l'ordre anterior, es tornen a consultar en el nou perquè les pàgines següents hi encaixin
+    LocalDatabaseManager localDatabaseManager;
+    QList<Patient*> patientStudyList = localDatabaseManager.queryPatientStudy(m_lastQueryMask, m_numberOfLoadedStudies, 0, getStudySortField(),
+                                                                              m_studyTreeWidget->getSortOrderColumn());
+
+    if (showDatabaseManagerError(localDatabaseManager.getLastError()))
+    {
+        m_allStudiesLoaded = true;
+        return;
+    }
+
+    m_studyTreeWidget->clear();
+    m_seriesThumbnailPreviewWidget->clear();
+
+    m_allStudiesLoaded = patientStudyList.count() < m_numberOfLoadedStudies;
+    m_numberOfLoadedStudies = patientStudyList.count();
+    m_studyTreeWidget->insertPatientList(patientStudyList);
+}
+
+LocalDatabaseStudyDAL::StudySortField QInputOutputLocalDatabaseWidget::getStudySortField()
+{
+    switch (m_studyTreeWidget->getSortColumn())
+    {
+        case QStudyTreeWidget::PatientID:
+            return LocalDatabaseStudyDAL::SortByPatientID;
+        case QStudyTreeWidget::PatientBirth:
+            return LocalDatabaseStudyDAL::SortByPatientBirthDate;
+        case QStudyTreeWidget::PatientAge:
+            return LocalDatabaseStudyDAL::SortByPatientAge;
+        case QStudyTreeWidget::Modality:
+            return LocalDatabaseStudyDAL::SortByModalities;
+        case QStudyTreeWidget::Description:
+            return LocalDatabaseStudyDAL::SortByDescription;
+        case QStudyTreeWidget::Date:
+            return LocalDatabaseStudyDAL::SortByDate;
+        case QStudyTreeWidget::StudyID:
+            return LocalDatabaseStudyDAL::SortByStudyID;
+        case QStudyTreeWidget::AccNumber:
+            return LocalDatabaseStudyDAL::SortByAccessionNumber;
+        case QStudyTreeWidget::UID:
+            return LocalDatabaseStudyDAL::SortByInstanceUID;
+        case QStudyTreeWidget::RefPhysName:
+            return LocalDatabaseStudyDAL::SortByReferringPhysicianName;
+        default:
+            // La resta de columnes no tenen valor als estudis o no es guarden a la base de dades
+            return LocalDatabaseStudyDAL::SortByPatientName;
+    }
+}
+
 void QInputOutputLocalDatabaseWidget::addStudyToQStudyTreeWidget(QString studyUID)
 {
     LocalDatabaseManager localDatabaseManager;
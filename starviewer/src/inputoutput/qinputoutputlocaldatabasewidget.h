@@ -152,13 +152,33 @@ private slots:
     /// per si s'esborren estudis de la caché poder-los treure de la QStudyTreeWidget
     void newPACSJobEnqueued(PACSJobPointer);
 
+    /// Si s'ha arribat al final de la llista d'estudis i en queden per carregar de l'última cerca, afegeix la pàgina següent
+    void studyListScrolled(int value);
+
+    /// Si la llista d'estudis s'ha reordenat i en queden per carregar, torna a consultar els estudis carregats en el nou ordre
+    void studyListSortChanged();
+
+private:
+    /// Retorna el camp de la base de dades pel qual s'han d'ordenar els estudis segons la columna per la que està ordenada la llista
+    LocalDatabaseStudyDAL::StudySortField getStudySortField();
+
 private:
+    /// Nombre d'estudis que es consulten cada vegada a la base de dades
+    static const int StudiesPageSize;
+
     QMenu m_contextMenuQStudyTreeWidget;
     QDeleteOldStudiesThread m_qdeleteOldStudiesThread;
     QCreateDicomdir *m_qcreateDicomdir;
     StatsWatcher *m_statsWatcher;
     QWidgetSelectPacsToStoreDicomImage *m_qwidgetSelectPacsToStoreDicomImage;
     PacsManager *m_pacsManager;
+
+    /// Màscara de l'última cerca, per poder consultar les pàgines següents
+    DicomMask m_lastQueryMask;
+    /// Nombre d'estudis de l'última cerca que s'han carregat
+    int m_numberOfLoadedStudies;
+    /// Indica si ja s'han carregat tots els estudis de l'última cerca
+    bool m_allStudiesLoaded;
 };
 
 };// end namespace udg
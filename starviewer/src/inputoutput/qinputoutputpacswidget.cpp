@@ -38,6 +38,8 @@
 
 namespace udg {
 
+const int QInputOutputPacsWidget::QueryResultsBatchSize = 100;
+
 QInputOutputPacsWidget::QInputOutputPacsWidget(QWidget *parent)
  : QWidget(parent)
 {
@@ -46,7 +48,7 @@ QInputOutputPacsWidget::QInputOutputPacsWidget(QWidget *parent)
     createContextMenuQStudyTreeWidget();
 
     Settings settings;
-    settings.restoreColumnsWidths(InputOutputSettings::PACSStudyListColumnsWidth, m_studyTreeWidget->getQTreeWidget());
+    settings.restoreColumnsWidths(InputOutputSettings::PACSStudyListColumnsWidth, m_studyTreeWidget->getQTreeView());
 
     QStudyTreeWidget::ColumnIndex sortByColumn = (QStudyTreeWidget::ColumnIndex) settings.getValue(InputOutputSettings::PACSStudyListSortByColumn).toInt();
     Qt::SortOrder sortOrderColumn = (Qt::SortOrder) settings.getValue(InputOutputSettings::PACSStudyListSortOrder).toInt();
@@ -70,7 +72,7 @@ QInputOutputPacsWidget::QInputOutputPacsWidget(QWidget *parent)
 QInputOutputPacsWidget::~QInputOutputPacsWidget()
 {
     Settings settings;
-    settings.saveColumnsWidths(InputOutputSettings::PACSStudyListColumnsWidth, m_studyTreeWidget->getQTreeWidget());
+    settings.saveColumnsWidths(InputOutputSettings::PACSStudyListColumnsWidth, m_studyTreeWidget->getQTreeView());
 
     // Guardem per quin columna està ordenada la llista d'estudis i en quin ordre
     settings.setValue(InputOutputSettings::PACSStudyListSortByColumn, m_studyTreeWidget->getSortColumn());
@@ -128,9 +130,18 @@ void QInputOutputPacsWidget::queryStudy(DicomMask queryMask, QList<PacsDevice> p
 
         m_studyTreeWidget->clear();
 
+        int maximumNumberOfStudies = Settings().getValue(InputOutputSettings::MaximumNumberOfStudiesPerPACSQuery).toInt();
+
         foreach (const PacsDevice &pacsDeviceToQuery, pacsToQueryList)
         {
-            enqueueQueryPACSJobToPACSManagerAndConnectSignals(PACSJobPointer(new QueryPacsJob(pacsDeviceToQuery, queryMask, QueryPacsJob::study)));
+            // Els estudis es mostren a mesura que arriben, sense esperar que el PACS hagi retornat tots els resultats
+            QueryPacsJob *queryPacsJob = new QueryPacsJob(pacsDeviceToQuery, queryMask, QueryPacsJob::study);
+            queryPacsJob->setResultsBatchSize(QueryResultsBatchSize);
+            queryPacsJob->setMaximumNumberOfResults(maximumNumberOfStudies);
+            connect(queryPacsJob, SIGNAL(PACSJobPatientStudiesFound(PACSJobPointer, QList<Patient*>)),
+                    SLOT(queryPACSJobPatientStudiesFound(PACSJobPointer, QList<Patient*>)));
+
+            enqueueQueryPACSJobToPACSManagerAndConnectSignals(PACSJobPointer(queryPacsJob));
         }
     }
 }
@@ -199,13 +210,38 @@ void QInputOutputPacsWidget::queryPACSJobFinished(PACSJobPointer pacsJob)
     }
 }
 
+void QInputOutputPacsWidget::queryPACSJobPatientStudiesFound(PACSJobPointer pacsJob, QList<Patient*> patientStudyList)
+{
+    if (pacsJob.isNull() || !m_queryPACSJobPendingExecuteOrExecuting.contains(pacsJob->getPACSJobID()))
+    {
+        // Són resultats d'una consulta que s'ha cancel·lat, no s'han de mostrar
+        foreach (Patient *patient, patientStudyList)
+        {
+            qDeleteAll(patient->getStudies());
+            delete patient;
+        }
+        return;
+    }
+
+    m_studyTreeWidget->insertPatientList(patientStudyList);
+}
+
 void QInputOutputPacsWidget::showQueryPACSJobResults(PACSJobPointer pacsJob)
 {
     QSharedPointer<QueryPacsJob> queryPACSJob = pacsJob.objectCast<QueryPacsJob>();
 
     if (queryPACSJob->getQueryLevel() == QueryPacsJob::study)
     {
+        // Els estudis ja s'han mostrat a mesura que s'han rebut, aquí només queden els que no s'hagin lliurat en blocs
         m_studyTreeWidget->insertPatientList(queryPACSJob->getPatientStudyList());
+
+        if (queryPACSJob->isMaximumNumberOfResultsReached())
+        {
+            QMessageBox::information(this, ApplicationNameString, tr("PACS %1 has returned more studies than the maximum of %2, only the first %2 are shown. "
+                                                                     "Please refine the query to get the rest.")
+                                     .arg(queryPACSJob->getPacsDevice().getAETitle())
+                                     .arg(Settings().getValue(InputOutputSettings::MaximumNumberOfStudiesPerPACSQuery).toInt()));
+        }
     }
     else if (queryPACSJob->getQueryLevel() == QueryPacsJob::series)
     {
@@ -151,7 +151,13 @@ private slots:
     /// Slot que s'activa quan un job de consulta al PACS és cancel·lat
     void queryPACSJobCancelled(PACSJobPointer pacsJob);
 
+    /// Slot que s'activa amb cada bloc d'estudis que rep un job de consulta d'estudis, els mostra sense esperar que acabi la consulta
+    void queryPACSJobPatientStudiesFound(PACSJobPointer pacsJob, QList<Patient*> patientStudyList);
+
 private:
+    /// Número de pacients dels blocs en que es reben els estudis de les consultes al PACS
+    static const int QueryResultsBatchSize;
+
     QMenu m_contextMenuQStudyTreeWidget;
     PacsManager *m_pacsManager;
     /// Per cada job de descàrrega guardem quina acció hem de fer quan ha acabat la descàrrega
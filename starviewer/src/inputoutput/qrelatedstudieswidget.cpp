@@ -261,6 +261,7 @@ void QRelatedStudiesWidget::initializeSearch()
 void QRelatedStudiesWidget::createConnections()
 {
     connect(m_relatedStudiesManager, SIGNAL(queryStudiesFinished(QList<Study*>)), SLOT(queryStudiesFinished(QList<Study*>)));
+    connect(m_relatedStudiesManager, SIGNAL(studiesFoundInPACS(QList<Study*>, PacsDevice)), SLOT(studiesFoundInPACS(QList<Study*>)));
     connect(m_signalMapper, SIGNAL(mapped(const QString&)), SLOT(retrieveAndLoadStudy(const QString&)));
     connect(m_currentStudySignalMapper, SIGNAL(mapped(const QString&)), SLOT(currentStudyRadioButtonClicked(const QString&)));
     connect(m_priorStudySignalMapper, SIGNAL(mapped(const QString&)), SLOT(priorStudyRadioButtonClicked(const QString&)));
@@ -470,6 +471,11 @@ void QRelatedStudiesWidget::queryStudiesFinished(const QList<Study *> &studiesLi
     insertStudiesToTree(studiesList);
 }
 
+void QRelatedStudiesWidget::studiesFoundInPACS(const QList<Study*> &studiesList)
+{
+    insertStudiesToTree(studiesList);
+}
+
 void QRelatedStudiesWidget::retrieveAndLoadStudy(const QString &studyInstanceUID)
 {
     StudyInfo *studyInfo = m_infomationPerStudy.value(studyInstanceUID);
@@ -110,6 +110,9 @@ private slots:
     /// Slot executed when the query is finished
     void queryStudiesFinished(const QList<Study*> &studiesList);
 
+    /// Slot executed when the queries to a PACS are finished, so that its studies are shown without waiting for the rest of PACS
+    void studiesFoundInPACS(const QList<Study*> &studiesList);
+
     /// Invoca la descàrrega i càrrega de l'estudi identificat amb l'uid proporcionat.
     void retrieveAndLoadStudy(const QString &studyInstanceUID);
 
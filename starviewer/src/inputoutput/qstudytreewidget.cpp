@@ -25,13 +25,14 @@
 
 namespace udg {
 
-const QString QStudyTreeWidget::TypeTextForDummyExpandableItems("DUMMY_EXPANDABLE_ITEM");
-
 QStudyTreeWidget::QStudyTreeWidget(QWidget *parent)
- : QWidget(parent)
+ : QWidget(parent), m_contextMenu(NULL)
 {
     setupUi(this);
 
+    m_model = new StudyTreeModel(this);
+    m_studyTreeView->setModel(m_model);
+
     m_studyTreeView->setColumnHidden(Type, true);
     m_studyTreeView->setColumnHidden(DICOMItemID, true);
     // Amaguem la columna Hora, ja que ara es mostra la data i hora en un mateix columna per poder ordenar per data i hora els estudis
@@ -48,144 +49,93 @@ QStudyTreeWidget::QStudyTreeWidget(QWidget *parent)
     m_studyTreeView->header()->moveSection(Description + 2, 3);
     m_studyTreeView->header()->moveSection(Modality + 2, 4);
 
-    // Carreguem les imatges que es mostren el QStudyTreeWidget
-    m_openFolder = QIcon(":/images/folderopen.png");
-    m_closeFolder = QIcon(":/images/folderclose.png");
-    m_iconSeries = QIcon(":/images/series.png");
-
     createConnections();
 
     m_studyTreeView->setSelectionMode(QAbstractItemView::ExtendedSelection);
 
     // Indiquem que el nivell màxim que per defecte es pot expedir l'arbre Study/Series/Image és fins a nivell d'Image
-    m_maximumExpandTreeItemsLevel = ImageLevel;
+    m_model->setMaximumExpandLevel(StudyTreeModel::ImageItem);
 
     initialize();
 
-    m_useDICOMSourceToDiscriminateStudies = true;
+    m_model->setUseDICOMSourceToDiscriminateStudies(true);
 }
 
 void QStudyTreeWidget::setUseDICOMSourceToDiscriminateStudies(bool discrimateStudiesByDicomSource)
 {
-    m_useDICOMSourceToDiscriminateStudies = discrimateStudiesByDicomSource;
+    m_model->setUseDICOMSourceToDiscriminateStudies(discrimateStudiesByDicomSource);
 }
 
 bool QStudyTreeWidget::getUseDICOMSourceToDiscriminateStudies()
 {
-    return m_useDICOMSourceToDiscriminateStudies;
+    return m_model->getUseDICOMSourceToDiscriminateStudies();
 }
 
 void QStudyTreeWidget::createConnections()
 {
-    connect(m_studyTreeView, SIGNAL(itemDoubleClicked(QTreeWidgetItem*, int)), SLOT(doubleClicked(QTreeWidgetItem*, int)));
-    connect(m_studyTreeView, SIGNAL(currentItemChanged(QTreeWidgetItem*, QTreeWidgetItem*)),
-            SLOT (currentItemChanged (QTreeWidgetItem*, QTreeWidgetItem*)));
-    connect(m_studyTreeView, SIGNAL(itemExpanded(QTreeWidgetItem*)), SLOT (itemExpanded(QTreeWidgetItem*)));
-    connect(m_studyTreeView, SIGNAL(itemCollapsed(QTreeWidgetItem*)), SLOT (itemCollapsed(QTreeWidgetItem*)));
+    connect(m_studyTreeView, SIGNAL(doubleClicked(QModelIndex)), SLOT(doubleClicked(QModelIndex)));
+    connect(m_studyTreeView->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)), SLOT(currentIndexChanged(QModelIndex, QModelIndex)));
+    connect(m_studyTreeView, SIGNAL(expanded(QModelIndex)), SLOT(itemExpanded(QModelIndex)));
+    connect(m_studyTreeView, SIGNAL(collapsed(QModelIndex)), SLOT(itemCollapsed(QModelIndex)));
 }
 
 void QStudyTreeWidget::insertPatientList(QList<Patient*> patientList)
 {
-    QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
-
-    foreach (Patient *patient, patientList)
-    {
-        insertPatient(patient);
-    }
-
-    QApplication::restoreOverrideCursor();
+    // The selection is kept, studies can be appended while the user is selecting the ones already shown
+    m_model->appendPatients(patientList);
 }
 
 void QStudyTreeWidget::insertPatient(Patient *patient)
 {
-    if (patient->getNumberOfStudies() > 0)
-    {
-        m_studyTreeView->addTopLevelItems(fillPatient(patient));
-        m_studyTreeView->clearSelection();
-
-        //Hi ha estudis que poden compartir el mateix objecte pacient, per exemple en DICOMDIR on un mateix pacient hi tingui més d'un estudi
-        m_addedPatients.append(patient);
-    }
+    insertPatientList(QList<Patient*>() << patient);
 }
 
 void QStudyTreeWidget::insertSeriesList(const QString &studyInstanceUID, QList<Series*> seriesList)
 {
-    QTreeWidgetItem *studyItem = getStudyQTreeWidgetItem(studyInstanceUID, seriesList.at(0)->getDICOMSource());
-    if (!studyItem)
+    QModelIndex studyIndex = m_model->findStudy(studyInstanceUID, seriesList.at(0)->getDICOMSource());
+    if (!studyIndex.isValid())
     {
         ERROR_LOG("No s'ha trobat l'estudi d'on s'han d'inserir les series.");
         return;
     }
 
-    foreach (Series *series, seriesList)
-    {
-        studyItem->addChild(fillSeries(series));
-        //FIXME: L'objecte Series hereda de QObject, quan se li fa un setParentStudy, com a parent del QObject de Series se li assigna l'objecte study
-        //aquesta assignació falla si series i study han estat creat en threads diferents com podria ser la cerca el PACS. Dos QObjects per ser pare i fill han
-        //de ser del mateix thread
-        series->setParentStudy(getStudyByDICOMItemID(studyItem->text(DICOMItemID).toInt()));
-    }
+    m_model->appendSeries(studyIndex, seriesList);
 }
 
 void QStudyTreeWidget::insertImageList(const QString &studyInstanceUID, const QString &seriesInstanceUID, QList<Image*> imageList)
 {
-    QTreeWidgetItem *seriesItem = getSeriesQTreeWidgetItem(studyInstanceUID, seriesInstanceUID, imageList.at(0)->getDICOMSource());
-
-    if (!seriesItem)
+    QModelIndex seriesIndex = m_model->findSeries(m_model->findStudy(studyInstanceUID, imageList.at(0)->getDICOMSource()), seriesInstanceUID);
+    if (!seriesIndex.isValid())
     {
         ERROR_LOG("No s'ha trobat la serie d'on s'han d'inserir les imatges.");
         return;
     }
 
-    foreach (Image *image, imageList)
-    {
-        m_addedImagesByDICOMItemID[m_nextDICOMItemIDOfImage] = image;
-        //FIXME: L'objecte Image hereda de QObject, quan se li fa un setParentSeries, com a parent del QObject d'Image se li assigna l'objecte series
-        //aquesta assignació falla si series i image han estat creat en threads diferents com podria ser la cerca el PACS. Dos QObjects per ser pare i fill han
-        //de ser del mateix thread
-        image->setParentSeries(getSeriesByDICOMItemID(seriesItem->text(DICOMItemID).toInt()));
-
-        QTreeWidgetItem *newImageItem = new QTreeWidgetItem();
-
-        newImageItem->setText(DICOMItemID, QString::number(m_nextDICOMItemIDOfImage++));
-        newImageItem->setIcon(ObjectName, m_iconSeries);
-        // Li fem un padding per poder ordenar la columna, ja que s'ordena per String
-        newImageItem->setText(ObjectName, tr("File %1").arg(image->getInstanceNumber().rightJustified(4, ' ')));
-        newImageItem->setText(UID, image->getSOPInstanceUID());
-        newImageItem->setText(Type, "IMAGE");
-
-        seriesItem->addChild(newImageItem);
-    }
+    m_model->appendImages(seriesIndex, imageList);
 }
 
 void QStudyTreeWidget::removeStudy(const QString &studyInstanceUIDToRemove, const DICOMSource &dicomSourceStudyToRemove)
 {
-    QTreeWidgetItem *studyItem = getStudyQTreeWidgetItem(studyInstanceUIDToRemove, dicomSourceStudyToRemove);
-
-    if (studyItem)
-    {
-        delete studyItem;
-    }
-
+    // No s'esborra l'objecte Study, s'esborrarà quan es netegi el model
+    m_model->removeItem(m_model->findStudy(studyInstanceUIDToRemove, dicomSourceStudyToRemove));
     m_studyTreeView->clearSelection();
-    //No esborrem l'estudi del HashTable ja s'esborrarà quan netegem la HashTable
 }
 
 void QStudyTreeWidget::removeSeries(const QString &studyInstanceUID, const QString &seriesInstanceUID, const DICOMSource &dicomSourceSeriesToRemove)
 {
-    QTreeWidgetItem *seriesItem = getSeriesQTreeWidgetItem(studyInstanceUID, seriesInstanceUID, dicomSourceSeriesToRemove);
+    QModelIndex studyIndex = m_model->findStudy(studyInstanceUID, dicomSourceSeriesToRemove);
+    QModelIndex seriesIndex = m_model->findSeries(studyIndex, seriesInstanceUID);
 
-    if (seriesItem)
+    if (seriesIndex.isValid())
     {
-        if (seriesItem->parent()->childCount() == 1)
+        if (m_model->rowCount(studyIndex) == 1)
         {
             //Si l'estudi només té aquesta sèrie esborrem tot l'estudi
-            Study *studyToRemove = getStudyByDICOMItemID(seriesItem->parent()->text(DICOMItemID).toInt());
-            removeStudy(studyToRemove->getInstanceUID(), studyToRemove->getDICOMSource());
+            m_model->removeItem(studyIndex);
         }
         else
         {
-            delete seriesItem;
+            m_model->removeItem(seriesIndex);
         }
     }
 
@@ -195,47 +145,52 @@ void QStudyTreeWidget::removeSeries(const QString &studyInstanceUID, const QStri
 QList<QPair<DicomMask, DICOMSource> > QStudyTreeWidget::getDicomMaskOfSelectedItems()
 {
     QList<QPair<DicomMask, DICOMSource> > dicomMaskDICOMSourceList;
+    QItemSelectionModel *selectionModel = m_studyTreeView->selectionModel();
 
-    foreach (QTreeWidgetItem *item, m_studyTreeView->selectedItems())
+    foreach (const QModelIndex &index, selectionModel->selectedRows(ObjectName))
     {
         QPair<DicomMask, DICOMSource> qpairDicomMaskDICOMSource;
         bool ok;
 
-        if (isItemStudy(item))
+        switch (m_model->getItemType(index))
         {
-            // És un estudi
-            Study *selectedStudy = getStudyByDICOMItemID(item->text(DICOMItemID).toInt());
-
-            qpairDicomMaskDICOMSource.first = DicomMask::fromStudy(selectedStudy, ok);
-            qpairDicomMaskDICOMSource.second = selectedStudy->getDICOMSource();
-
-            dicomMaskDICOMSourceList.append(qpairDicomMaskDICOMSource);
-        }
-        else if (isItemSeries(item))
-        {
-            //Si l'estudi pare no està seleccionat
-            if (!item->parent()->isSelected())
+            case StudyTreeModel::StudyItem:
             {
-                Series *selectedSeries = getSeriesByDICOMItemID(item->text(DICOMItemID).toInt());
+                Study *selectedStudy = m_model->getStudy(index);
 
-                qpairDicomMaskDICOMSource.first = DicomMask::fromSeries(selectedSeries, ok);
-                qpairDicomMaskDICOMSource.second = selectedSeries->getDICOMSource();
+                qpairDicomMaskDICOMSource.first = DicomMask::fromStudy(selectedStudy, ok);
+                qpairDicomMaskDICOMSource.second = selectedStudy->getDICOMSource();
 
                 dicomMaskDICOMSourceList.append(qpairDicomMaskDICOMSource);
+                break;
             }
-        }
-        else if (isItemImage(item))
-        {
-            //Si la sèrie pare i l'estudi pare no està seleccionat
-            if (!item->parent()->isSelected() && !item->parent()->parent()->isSelected())
-            {
-                Image *selectedImage = getImageByDICOMItemID(item->text(DICOMItemID).toInt());
 
-                qpairDicomMaskDICOMSource.first = DicomMask::fromImage(selectedImage, ok);
-                qpairDicomMaskDICOMSource.second = selectedImage->getDICOMSource();
+            case StudyTreeModel::SeriesItem:
+                //Si l'estudi pare no està seleccionat
+                if (!selectionModel->isRowSelected(index.parent().row(), index.parent().parent()))
+                {
+                    Series *selectedSeries = m_model->getSeries(index);
 
-                dicomMaskDICOMSourceList.append(qpairDicomMaskDICOMSource);
-            }
+                    qpairDicomMaskDICOMSource.first = DicomMask::fromSeries(selectedSeries, ok);
+                    qpairDicomMaskDICOMSource.second = selectedSeries->getDICOMSource();
+
+                    dicomMaskDICOMSourceList.append(qpairDicomMaskDICOMSource);
+                }
+                break;
+
+            case StudyTreeModel::ImageItem:
+                //Si la sèrie pare i l'estudi pare no està seleccionat
+                if (!selectionModel->isRowSelected(index.parent().row(), index.parent().parent()) &&
+                    !selectionModel->isRowSelected(index.parent().parent().row(), index.parent().parent().parent()))
+                {
+                    Image *selectedImage = m_model->getImage(index);
+
+                    qpairDicomMaskDICOMSource.first = DicomMask::fromImage(selectedImage, ok);
+                    qpairDicomMaskDICOMSource.second = selectedImage->getDICOMSource();
+
+                    dicomMaskDICOMSourceList.append(qpairDicomMaskDICOMSource);
+                }
+                break;
         }
     }
 
@@ -244,13 +199,13 @@ QList<QPair<DicomMask, DICOMSource> > QStudyTreeWidget::getDicomMaskOfSelectedIt
 
 void QStudyTreeWidget::setSortByColumn(QStudyTreeWidget::ColumnIndex col, Qt::SortOrder sortOrder)
 {
-    m_studyTreeView->sortItems(col, sortOrder);
+    m_studyTreeView->sortByColumn(col, sortOrder);
     m_studyTreeView->clearSelection();
 }
 
 QStudyTreeWidget::ColumnIndex QStudyTreeWidget::getSortColumn()
 {
-    return (QStudyTreeWidget::ColumnIndex) m_studyTreeView->header()->sortIndicatorSection();;
+    return (QStudyTreeWidget::ColumnIndex) m_studyTreeView->header()->sortIndicatorSection();
 }
 
 Qt::SortOrder QStudyTreeWidget::getSortOrderColumn()
@@ -260,33 +215,17 @@ Qt::SortOrder QStudyTreeWidget::getSortOrderColumn()
 
 void QStudyTreeWidget::sort()
 {
-    m_studyTreeView->sortItems(m_studyTreeView->sortColumn(), m_studyTreeView->header()->sortIndicatorOrder());
+    m_studyTreeView->sortByColumn(m_studyTreeView->header()->sortIndicatorSection(), m_studyTreeView->header()->sortIndicatorOrder());
 }
 
 Study* QStudyTreeWidget::getStudy(const QString &studyInstanceUID, const DICOMSource &dicomSourceOfStudy)
 {
-    QTreeWidgetItem *studyItem = getStudyQTreeWidgetItem(studyInstanceUID, dicomSourceOfStudy);
-    Study *study = NULL;
-
-    if (studyItem)
-    {
-        study = getStudyByDICOMItemID(studyItem->text(DICOMItemID).toInt());
-    }
-
-    return study;
+    return m_model->getStudy(m_model->findStudy(studyInstanceUID, dicomSourceOfStudy));
 }
 
 Series* QStudyTreeWidget::getSeries(const QString &studyInstanceUID, const QString &seriesInstanceUID, const DICOMSource &dicomSourceOfSeries)
 {
-    QTreeWidgetItem *seriesItem = getSeriesQTreeWidgetItem(studyInstanceUID, seriesInstanceUID, dicomSourceOfSeries);
-    Series *series = NULL;
-
-    if (seriesItem)
-    {
-        series = getSeriesByDICOMItemID(seriesItem->text(DICOMItemID).toInt());
-    }
-
-    return series;
+    return m_model->getSeries(m_model->findSeries(m_model->findStudy(studyInstanceUID, dicomSourceOfSeries), seriesInstanceUID));
 }
 
 void QStudyTreeWidget::setContextMenu(QMenu *contextMenu)
@@ -296,336 +235,58 @@ void QStudyTreeWidget::setContextMenu(QMenu *contextMenu)
 
 void QStudyTreeWidget::contextMenuEvent(QContextMenuEvent *event)
 {
-    if (!m_studyTreeView->selectedItems().isEmpty())
+    if (m_contextMenu && m_studyTreeView->selectionModel()->hasSelection())
     {
         m_contextMenu->exec(event->globalPos());
     }
 }
 
-QTreeWidget* QStudyTreeWidget::getQTreeWidget() const
+QTreeView* QStudyTreeWidget::getQTreeView() const
 {
     return m_studyTreeView;
 }
 
 void QStudyTreeWidget::setMaximumExpandTreeItemsLevel(QStudyTreeWidget::ItemTreeLevels maximumExpandTreeItemsLevel)
 {
-    m_maximumExpandTreeItemsLevel = maximumExpandTreeItemsLevel;
+    m_model->setMaximumExpandLevel((StudyTreeModel::ItemType) maximumExpandTreeItemsLevel);
 }
 
 QStudyTreeWidget::ItemTreeLevels QStudyTreeWidget::getMaximumExpandTreeItemsLevel()
 {
-    return m_maximumExpandTreeItemsLevel;
+    return (QStudyTreeWidget::ItemTreeLevels) m_model->getMaximumExpandLevel();
 }
 
 void QStudyTreeWidget::setCurrentSeries(const QString &studyInstanceUID, const QString &seriesInstanceUID, const DICOMSource &dicomSource)
 {
-    QTreeWidgetItem *seriesItem = getSeriesQTreeWidgetItem(studyInstanceUID, seriesInstanceUID, dicomSource);
-
-    if (!seriesItem)
-    {
-        return;
-    }
+    QModelIndex studyIndex = m_model->findStudy(studyInstanceUID, dicomSource);
+    QModelIndex seriesIndex = m_model->findSeries(studyIndex, seriesInstanceUID);
 
-    if (seriesItem->parent()->isExpanded())
+    if (seriesIndex.isValid() && m_studyTreeView->isExpanded(studyIndex))
     {
-        //Comprovem que l'element pare estigui desplegat perquè sinó Qt peta si assignem com a element actual un element no visible
-        m_studyTreeView->setCurrentItem (seriesItem);
+        // Només es marca com a actual si l'estudi està desplegat, no es vol desplegar l'estudi des d'aquí
+        m_studyTreeView->setCurrentIndex(seriesIndex);
     }
 }
 
 void QStudyTreeWidget::clear()
 {
-    m_studyTreeView->clear();
-
-    qDeleteAll(m_addedImagesByDICOMItemID);
-    qDeleteAll(m_adddSeriesByDICOMItemID);
-    qDeleteAll(m_addedStudiesByDICOMItemID);
-    qDeleteAll(m_addedPatients);
-
-    m_addedPatients.clear();
-    m_addedStudiesByDICOMItemID.clear();
-    m_adddSeriesByDICOMItemID.clear();
-    m_addedImagesByDICOMItemID.clear();
+    m_model->clear();
 
     initialize();
 }
 
 void QStudyTreeWidget::initialize()
 {
-    m_nextIDICOMItemIDOfStudy = 0;
-    m_nextDICOMItemIDOfSeries = 0;
-    m_nextDICOMItemIDOfImage = 0;
-
-    m_qTreeWidgetItemHasBeenDoubleClicked = false;
     m_oldCurrentStudy = NULL;
     m_oldCurrentSeries = NULL;
 }
 
-QTreeWidgetItem* QStudyTreeWidget::getStudyQTreeWidgetItem(const QString &studyUID, const DICOMSource &studyDICOMSource)
-{
-    QList<QTreeWidgetItem*> qTreeWidgetItemsStudy(m_studyTreeView->findItems(studyUID, Qt::MatchExactly, UID));
-
-    foreach(QTreeWidgetItem *studyItem, qTreeWidgetItemsStudy)
-    {
-        if (isItemStudy(studyItem) &&
-            (getStudyByDICOMItemID(studyItem->text(DICOMItemID).toInt())->getDICOMSource() == studyDICOMSource || !m_useDICOMSourceToDiscriminateStudies))
-        {
-            return studyItem;
-        }
-    }
-
-    return NULL;
-}
-
-QTreeWidgetItem* QStudyTreeWidget::getSeriesQTreeWidgetItem(const QString &studyInstanceUID, const QString &seriesInstanceUID, const DICOMSource &seriesDICOMSource)
-{
-    QTreeWidgetItem *studyItem = getStudyQTreeWidgetItem(studyInstanceUID, seriesDICOMSource);
-
-    if (!studyItem)
-    {
-        return NULL;
-    }
-
-    for (int index = 0; index < studyItem->childCount(); index++)
-    {
-        if (studyItem->child(index)->text(UID) == seriesInstanceUID)
-        {
-            return studyItem->child(index);
-        }
-    }
-
-    return NULL;
-}
-
-bool QStudyTreeWidget::isItemStudy(QTreeWidgetItem *item)
-{
-    return item->text(Type) == "STUDY";
-}
-
-bool QStudyTreeWidget::isItemSeries(QTreeWidgetItem *item)
-{
-    return item->text(Type) == "SERIES";
-}
-
-bool QStudyTreeWidget::isItemImage(QTreeWidgetItem *item)
-{
-    return item->text(Type) == "IMAGE";
-}
-
-QList<QTreeWidgetItem*> QStudyTreeWidget::fillPatient(Patient *patient)
-{
-    QList<QTreeWidgetItem*> qtreeWidgetItemList;
-
-    foreach (Study *studyToInsert, patient->getStudies())
-    {
-        // Si l'estudi ja hi existeix a StudyTreeView l'esborrem
-        removeStudy(patient->getStudies().at(0)->getInstanceUID(), patient->getStudies().at(0)->getDICOMSource());
-
-        // Inserim l'estudi a la llista d'estudis
-        m_addedStudiesByDICOMItemID[m_nextIDICOMItemIDOfStudy] = studyToInsert;
-
-        QTreeWidgetItem *item = new QTreeWidgetItem();
-
-        item->setText(DICOMItemID, QString::number(m_nextIDICOMItemIDOfStudy++));
-        item->setIcon(ObjectName, m_closeFolder);
-        item->setText(ObjectName, patient->getFullName());
-        item->setText(PatientID, patient->getID());
-        item->setText(PatientBirth, formatDateTime(patient->getBirthDate(), QTime()));
-        item->setText(PatientAge, formatAge(studyToInsert->getPatientAge()));
-        item->setText(Modality, studyToInsert->getModalitiesAsSingleString());
-        item->setText(Description, studyToInsert->getDescription());
-        // TODO:No hauria de ser l'estudi que tornés la data formatada? Problema necessitem que la data estigui en format yyyy/mm/dd per poder ordenar per data
-        item->setText(Date, formatDateTime(studyToInsert->getDate(), studyToInsert->getTime()));
-        item->setText(StudyID, tr("Study %1").arg(studyToInsert->getID()));
-        item->setText(Institution, studyToInsert->getInstitutionName());
-        item->setText(AccNumber, studyToInsert->getAccessionNumber());
-        item->setText(UID, studyToInsert->getInstanceUID());
-        // Indiquem de que es tracta d'un estudi
-        item->setText(Type, "STUDY");
-        item->setText(RefPhysName, studyToInsert->getReferringPhysiciansName());
-
-        // Comprovem si el TreeItem s'ha d'expandir en funció del nivell màxim que ens han indicat que ens podem expandir
-        if (m_maximumExpandTreeItemsLevel > StudyLevel)
-        {
-            // Degut que per cada item estudi tenim items fills que són series, i que consultar les series per cada estudi és
-            // una operació costosa (per exemple quan es consulta al pacs) només inserirem les sèries per a que les pugui
-            // consultar l'usuari quan es facin un expand d'estudi, però per a que apareixi el botó "+" de desplegar l'estudi inserim un item en blanc
-            item->addChild(createDummyQTreeWidgetItem());
-        }
-        qtreeWidgetItemList.append(item);
-    }
-
-    return qtreeWidgetItemList;
-}
-
-QTreeWidgetItem* QStudyTreeWidget::fillSeries(Series *series)
-{
-    m_adddSeriesByDICOMItemID[m_nextDICOMItemIDOfSeries]= series;
-
-    QTreeWidgetItem *seriesItem = new QTreeWidgetItem();
-
-    seriesItem->setText(DICOMItemID, QString::number(m_nextDICOMItemIDOfSeries++));
-    seriesItem->setIcon(ObjectName, m_iconSeries);
-    // Li fem un padding per poder ordenar la columna, ja que s'ordena per String
-    seriesItem->setText(ObjectName, tr("Series %1").arg(series->getSeriesNumber().rightJustified(4, ' ')));
-    seriesItem->setText(Modality, series->getModality());
-
-    // Treiem els espaics en blanc del davant i darrera
-    seriesItem->setText(Description, series->getDescription().simplified());
-
-    seriesItem->setText(Date, formatDateTime(series->getDate(), series->getTime()));
-    seriesItem->setText(UID, series->getInstanceUID());
-    // Indiquem que es tracta d'una sèrie
-    seriesItem->setText(Type, "SERIES");
-
-    seriesItem->setText(ProtocolName, series->getProtocolName());
-    seriesItem->setText(PPStartDate, series->getPerformedProcedureStepStartDate());
-    seriesItem->setText(PPStartTime, series->getPerformedProcedureStepStartTime());
-    seriesItem->setText(ReqProcID, series->getRequestedProcedureID());
-    seriesItem->setText(SchedProcStep, series->getScheduledProcedureStepID());
-
-    // Comprovem si el TreeItem s'ha d'expandir en funció del nivell màxim que ens han indicat que ens podem expandir
-    if (m_maximumExpandTreeItemsLevel > SeriesLevel)
-    {
-        // Degut que per cada item serie tenim items fills que són imatges, i que consultar les imatges per cada sèrie és
-        // una operació costosa (per exemple quan es consulta al pacs) només inserirem les sèries per a que les pugui
-        // consultar l'usuari quan es facin un expand de la sèrie, però per a que apareixi el botó "+" de desplegar la sèrie inserim un item en blanc
-        seriesItem->addChild(createDummyQTreeWidgetItem());
-    }
-    return seriesItem;
-}
-
-Study* QStudyTreeWidget::getStudyByDICOMItemID(int studyDICOMItemID)
-{
-    Study *study = NULL;
-
-    if (m_addedStudiesByDICOMItemID.contains(studyDICOMItemID))
-    {
-        study = m_addedStudiesByDICOMItemID[studyDICOMItemID];
-    }
-
-    return study;
-}
-
-Series* QStudyTreeWidget::getSeriesByDICOMItemID(int seriesDICOMItemID)
-{
-    Series *series = NULL;
-
-    if (m_adddSeriesByDICOMItemID.contains(seriesDICOMItemID))
-    {
-        series = m_adddSeriesByDICOMItemID[seriesDICOMItemID];
-    }
-
-    return series;
-}
-
-Image* QStudyTreeWidget::getImageByDICOMItemID(int imageDICOMItemID)
-{
-    Image *image = NULL;
-
-    if (m_addedImagesByDICOMItemID.contains(imageDICOMItemID))
-    {
-        image = m_addedImagesByDICOMItemID[imageDICOMItemID];
-    }
-
-    return image;
-}
-
-Study* QStudyTreeWidget::getStudyByQTreeWidgetItem(QTreeWidgetItem *qTreeWidgetItem)
-{
-    Study *study = NULL;
-
-    if (qTreeWidgetItem)
-    {
-        if (isItemStudy(qTreeWidgetItem))
-        {
-            study = getStudyByDICOMItemID(qTreeWidgetItem->text(DICOMItemID).toInt());
-        }
-        else if (isItemSeries(qTreeWidgetItem))
-        {
-            study = getStudyByDICOMItemID(qTreeWidgetItem->parent()->text(DICOMItemID).toInt());
-        }
-        else if (isItemImage(qTreeWidgetItem))
-        {
-            study = getStudyByDICOMItemID(qTreeWidgetItem->parent()->parent()->text(DICOMItemID).toInt());
-        }
-    }
-
-    return study;
-}
-
-Series* QStudyTreeWidget::getSeriesByQTreeWidgetItem(QTreeWidgetItem *qTreeWidgetItem)
+void QStudyTreeWidget::currentIndexChanged(const QModelIndex &current, const QModelIndex &)
 {
-    Series *series = NULL;
-
-    if (qTreeWidgetItem)
+    if (current.isValid())
     {
-        if (isItemSeries(qTreeWidgetItem))
-        {
-            series = getSeriesByDICOMItemID(qTreeWidgetItem->text(DICOMItemID).toInt());
-        }
-        else if (isItemImage(qTreeWidgetItem))
-        {
-            series = getSeriesByDICOMItemID(qTreeWidgetItem->parent()->text(DICOMItemID).toInt());
-        }
-    }
-
-    return series;
-}
-
-Image* QStudyTreeWidget::getImageByQTreeWidgetItem(QTreeWidgetItem *qTreeWidgetItem)
-{
-    Image *image = NULL;
-
-    if (qTreeWidgetItem)
-    {
-        if (isItemImage(qTreeWidgetItem))
-        {
-            image = getImageByDICOMItemID(qTreeWidgetItem->text(DICOMItemID).toInt());
-        }
-    }
-
-    return image;
-}
-
-QString QStudyTreeWidget::formatAge(const QString &age) const
-{
-    QString text(age);
-
-    if (text.length() > 0)
-    {
-        // Treiem el 0 de davant els anys, el PACS envia per ex: 047Y nosaltes tornem 47Y
-        if (text.at(0) == '0')
-        {
-            text.replace(0, 1, " ");
-        }
-    }
-
-    return text;
-}
-
-QString QStudyTreeWidget::formatDateTime(const QDate &date, const QTime &time) const
-{
-    QString formatedDateTimeAsQString = "";
-
-    if (!date.isNull() && !time.isNull())
-    {
-        formatedDateTimeAsQString = date.toString(Qt::ISODate) + "   " + time.toString(Qt::ISODate);
-    }
-    else if (!date.isNull())
-    {
-        formatedDateTimeAsQString = date.toString(Qt::ISODate);
-    }
-
-    return formatedDateTimeAsQString;
-}
-
-void QStudyTreeWidget::currentItemChanged(QTreeWidgetItem *currentItem, QTreeWidgetItem *)
-{
-    if (currentItem)
-    {
-        Study *currentStudy = getStudyByQTreeWidgetItem(currentItem);
-        Series *currentSeries = getSeriesByQTreeWidgetItem(currentItem);
+        Study *currentStudy = m_model->getStudy(current);
+        Series *currentSeries = m_model->getSeries(current);
 
         if (currentStudy != m_oldCurrentStudy)
         {
@@ -645,100 +306,56 @@ void QStudyTreeWidget::currentItemChanged(QTreeWidgetItem *currentItem, QTreeWid
     }
 }
 
-QTreeWidgetItem* QStudyTreeWidget::createDummyQTreeWidgetItem()
-{
-    QTreeWidgetItem *dummyItem = new QTreeWidgetItem();
-    dummyItem->setText(Type, TypeTextForDummyExpandableItems);
-
-    return dummyItem;
-}
-
-bool QStudyTreeWidget::isDummyQTreeWidgetItem(QTreeWidgetItem *dummyQTreeWidgetItem)
+void QStudyTreeWidget::itemExpanded(const QModelIndex &index)
 {
-    return dummyQTreeWidgetItem->text(Type) == TypeTextForDummyExpandableItems;
-}
+    m_model->setExpanded(index, true);
 
-void QStudyTreeWidget::itemExpanded(QTreeWidgetItem *itemExpanded)
-{
-    // En el cas de que ens arribi l'item amb el text buit, no fem res
-    // Això passa en situacions molt puntuals quan s'utilitza la tecla '*' per expandir l'item
-    if (isDummyQTreeWidgetItem(itemExpanded))
+    if (m_model->areChildrenRequested(index))
     {
         return;
     }
 
-    // El QTreeWidget després de fer doble click expandeix o col·lapsa l'item en funció del seu estat, a nosaltres no ens interessa
-    // que es faci això, per aquest motiu en cas d'un signal de collapse o expand, el que fem és comprovar si per aquell item s'acaba
-    // de fer doble click, si és així anul·lem l'acció d'expandir
-    if (!m_qTreeWidgetItemHasBeenDoubleClicked)
-    {
-        // Com que inserim un item en blanc per simular fills dels estudis i de les sèries cada vegada que ens fan un expand hem d'eliminar l'item en blanc i
-        // emetem un signal per a que qui el reculli s'encarregui de fer els passos corresponents per expandir l'estudi o imatge amb el seus fills pertinents
-        qDeleteAll(itemExpanded->takeChildren());
+    // Consultar les sèries de cada estudi o les imatges de cada sèrie és una operació costosa (per exemple quan es consulta al PACS), per això només
+    // es demanen quan l'usuari expandeix l'item per primera vegada, i qui rep el signal s'encarrega d'inserir-les
+    m_model->setChildrenRequested(index);
 
-        if (isItemStudy(itemExpanded))
-        {
-            itemExpanded->setIcon(ObjectName, m_openFolder);
-            emit (requestedSeriesOfStudy(getStudyByDICOMItemID(itemExpanded->text(DICOMItemID).toInt())));
-        }
-        else if (isItemSeries(itemExpanded))
-        {
-            emit (requestedImagesOfSeries(getSeriesByDICOMItemID(itemExpanded->text(DICOMItemID).toInt())));
-        }
+    if (m_model->getItemType(index) == StudyTreeModel::StudyItem)
+    {
+        emit (requestedSeriesOfStudy(m_model->getStudy(index)));
     }
-    else
+    else if (m_model->getItemType(index) == StudyTreeModel::SeriesItem)
     {
-        m_qTreeWidgetItemHasBeenDoubleClicked = false;
-        m_studyTreeView->collapseItem(itemExpanded);
+        emit (requestedImagesOfSeries(m_model->getSeries(index)));
     }
 }
 
-void QStudyTreeWidget::itemCollapsed(QTreeWidgetItem *itemCollapsed)
+void QStudyTreeWidget::itemCollapsed(const QModelIndex &index)
 {
-    // El QTreeWidget després de fer doble click expandeix o col·lapsa l'item en funció del seu estat, a nosaltres no ens interessa
-    // que es faci això, per aquest motiu en cas d'un signal de collapse o expand, el que fem és comprovar si per aquell item s'acaba
-    // de fer doble click, si és així anul·lem l'acció de col·lapsar
-
-    if (!m_qTreeWidgetItemHasBeenDoubleClicked)
-    {
-        if (isItemStudy(itemCollapsed))
-        {
-            itemCollapsed->setIcon(ObjectName, m_closeFolder);
-        }
-    }
-    else
-    {
-        m_qTreeWidgetItemHasBeenDoubleClicked = false;
-        m_studyTreeView->expandItem (itemCollapsed);
-    }
-
+    m_model->setExpanded(index, false);
 }
 
-void QStudyTreeWidget::doubleClicked(QTreeWidgetItem *item, int)
+void QStudyTreeWidget::doubleClicked(const QModelIndex &index)
 {
-    // Al fer doblec click al QTreeWidget ja expandeix o amaga automàticament l'objecte
-    if (item == NULL)
+    if (!index.isValid())
     {
         return;
     }
 
-    if (isItemStudy(item))
-    {
-        emit(studyDoubleClicked());
-    }
-    else if (isItemSeries(item))
-    {
-        emit(seriesDoubleClicked());
-    }
-    else if (isItemImage(item))
+    // El QTreeView té desactivat expandir amb el doble click, el doble click només indica que s'ha de visualitzar o descarregar l'element
+    switch (m_model->getItemType(index))
     {
-        emit(imageDoubleClicked());
-    }
+        case StudyTreeModel::StudyItem:
+            emit(studyDoubleClicked());
+            break;
+
+        case StudyTreeModel::SeriesItem:
+            emit(seriesDoubleClicked());
+            break;
 
-    // Pel comportament del tree widget quan es fa un un doble click es col·lapsa o expandeix l'item en funció del seu estat, com que
-    // nosaltres pel doble click no volem que s'expendeixi o es col·lapsi, guardem per quin element s'ha fet el doble click, per anul·laro quan es detecti
-    // un signal d'expand o collapse item
-    m_qTreeWidgetItemHasBeenDoubleClicked = true;
+        case StudyTreeModel::ImageItem:
+            emit(imageDoubleClicked());
+            break;
+    }
 }
 
 }
@@ -21,6 +21,7 @@
 #include <QList>
 
 #include "dicomsource.h"
+#include "studytreemodel.h"
 
 // Forward declarations
 class QString;
@@ -36,7 +37,8 @@ class DicomMask;
 
 /**
     Aquesta classe mostrar estudis i sèries d'una manera organitzada i fàcilment.
-    Aquesta classe és una modificació de la QTreeWidget que s'ha adaptat per poder visualitzar la informació de la cerca d'estudis/series/imatges.
+    Mostra la informació de la cerca d'estudis/series/imatges en un QTreeView amb un StudyTreeModel, que només formata els textos de les files visibles
+    i ordena els estudis en un thread a part, per poder mostrar desenes de milers d'estudis sense bloquejar la interfície.
     La classe manté la llista d'Study/Series/Image que se l'insereixen, i s'eliminen al invocar el mètode clean de la classe, per tant cal recordar
     que les classes que n'invoquin mètodes ue retornen punters a Study/Series/Image seran responsables de fer-ne una còpia si necessiten
     mantenir l'objecte viu una vegada fet un clean.
@@ -48,12 +50,15 @@ class DicomMask;
 class QStudyTreeWidget : public QWidget, private Ui::QStudyTreeWidgetBase {
 Q_OBJECT
 public:
-    enum ItemTreeLevels { StudyLevel = 0, SeriesLevel = 1, ImageLevel = 2 };
+    enum ItemTreeLevels { StudyLevel = StudyTreeModel::StudyItem, SeriesLevel = StudyTreeModel::SeriesItem, ImageLevel = StudyTreeModel::ImageItem };
 
     // Object Name s'utilitza per guardar El NomPacient, Serie + Identificador Sèrie i Imatge + Identificador Image
-    enum ColumnIndex { ObjectName = 0, PatientID = 1, PatientAge = 2, Description = 3, Modality = 4, Date = 5, Time = 6,
-    DICOMItemID = 7, Institution = 8, UID = 9, StudyID = 10, ProtocolName = 11, AccNumber = 12, Type = 13,
-    RefPhysName = 14, PPStartDate = 15, PPStartTime = 16, ReqProcID = 17, SchedProcStep = 18, PatientBirth = 19 };
+    enum ColumnIndex { ObjectName = StudyTreeModel::ObjectName, PatientID = StudyTreeModel::PatientID, PatientAge = StudyTreeModel::PatientAge,
+    Description = StudyTreeModel::Description, Modality = StudyTreeModel::Modality, Date = StudyTreeModel::Date, Time = StudyTreeModel::Time,
+    DICOMItemID = StudyTreeModel::DICOMItemID, Institution = StudyTreeModel::Institution, UID = StudyTreeModel::UID, StudyID = StudyTreeModel::StudyID,
+    ProtocolName = StudyTreeModel::ProtocolName, AccNumber = StudyTreeModel::AccNumber, Type = StudyTreeModel::Type, RefPhysName = StudyTreeModel::RefPhysName,
+    PPStartDate = StudyTreeModel::PPStartDate, PPStartTime = StudyTreeModel::PPStartTime, ReqProcID = StudyTreeModel::ReqProcID,
+    SchedProcStep = StudyTreeModel::SchedProcStep, PatientBirth = StudyTreeModel::PatientBirth };
 
     QStudyTreeWidget(QWidget *parent = 0);
 
@@ -63,7 +68,8 @@ public:
     bool getUseDICOMSourceToDiscriminateStudies();
 
     /// Mostrar els estudis passats per paràmetres. Si algun dels estudis ja existeix en sobreescriu la informació. En funció del valor establert per setUseDICOMSourceToDiscriminateStudies
-    /// estudis amb el mateix UID però diferent DICOMSource es podran considerar duplicats
+    /// estudis amb el mateix UID però diferent DICOMSource es podran considerar duplicats. Els estudis s'afegeixen al final de la llista i es col·loquen
+    /// al seu lloc quan acaba l'ordenació en segon pla, per tant es pot cridar per cada bloc de resultats a mesura que arriben
     void insertPatientList(QList<Patient*> patientList);
 
     /// Insereix el pacient al QStudyTreeWiget. Si el pacient amb aquell estudi ja existeix en sobreescriu la informació
@@ -109,8 +115,8 @@ public:
     /// Estableix el menú contextual del Widget
     void setContextMenu(QMenu *contextMenu);
 
-    /// Retorna el QTreeWidget que conté el widget
-    QTreeWidget* getQTreeWidget() const;
+    /// Retorna el QTreeView que conté el widget
+    QTreeView* getQTreeView() const;
 
     /// Assigna/Obté el nivell màxim fins el que es poden expandir els items que es mostren a QStudyTreeWiget, per defecte s'expandeix fins a nivell d'Image
     void setMaximumExpandTreeItemsLevel(QStudyTreeWidget::ItemTreeLevels maximumExpandTreeItemsLevel);
@@ -160,71 +166,21 @@ private:
     /// Inicialitza les variables necessàries del QWidget
     void initialize();
 
-    /// Retorna l'objecte QTreeWidgetItem que mostra a l'estudi que compleix els paràmetres passats
-    QTreeWidgetItem* getStudyQTreeWidgetItem(const QString &studyUID, const DICOMSource &studyDICOMSource);
-
-    /// Retorna l'Objecte QTtreeWidgeItem que és de l'estudi i series
-    QTreeWidgetItem* getSeriesQTreeWidgetItem(const QString &studyUID, const QString &seriesUID, const DICOMSource &seriesDICOMSource);
-
-    /// Ens indica si l'item passat és un Study/Series/Image
-    bool isItemStudy(QTreeWidgetItem *);
-    bool isItemSeries(QTreeWidgetItem *);
-    bool isItemImage(QTreeWidgetItem *);
-
-    /// Retorna llista QTreeWidgetItem resultant dels estudis que té el pacient
-    QList<QTreeWidgetItem*> fillPatient(Patient *);
-
-    /// Donada una sèrie emplena un QTreeWidgetItem per mostrar la informaciío de la sèrie
-    QTreeWidgetItem* fillSeries(Series *serie);
-
-    /// Retorna Study/Series/Image a partir del seu DICOMItemID si no el troba retorna null
-    Study* getStudyByDICOMItemID(int studyDICOMItemID);
-    Series* getSeriesByDICOMItemID(int seriesDICOMItemID);
-    Image* getImageByDICOMItemID(int imageDICOMItemID);
-
-    /// Retorna Study/Series/Image a la que pertany un QTreeWidgeITem. Si a getStudyByQTreeWidgetItem li passem un QTreeWidgetItem que és una imatge ens retornarà l'estudi al
-    /// que pertany la imatge,  si getSeriesByQTreeWidgetItem li passem un item que és un Study ens retornarà null
-    Study* getStudyByQTreeWidgetItem(QTreeWidgetItem *qTreeWidgetItem);
-    Series* getSeriesByQTreeWidgetItem(QTreeWidgetItem *qTreeWidgetItem);
-    Image* getImageByQTreeWidgetItem(QTreeWidgetItem *qTreeWidgetItem);
-
-    /// Formata l'edat per mostrar per pantalla
-    QString formatAge(const QString &age) const;
-
-    /// Formata la data i hora passada a ISO 8601 extended (YYYY-MM-DD HH:MM:SS) Amb aquest format de data es pot ordenar els estudis per data/hora
-    /// Si l'hora no té valor només retorna la data, i si ni Data i Hora tenen valor retorna string buit
-    QString formatDateTime(const QDate &date, const QTime &time) const;
-
-    /// Crea un QTreeWidgetItem buit, per a que aparegui l'icona + per poder desplegar estudi/series amb el mouse
-    QTreeWidgetItem* createDummyQTreeWidgetItem();
-
-    /// Indica si el QTreeWidgetItem és un Dummy utilitzat per poder expandir Estudis/Series quan encara no n'hem consultat els seus elements fills Series/Imatges
-    bool isDummyQTreeWidgetItem(QTreeWidgetItem *);
-
 private slots:
     /// Emet signal quan es selecciona un estudi o serie diferent a l'anterior
-    void currentItemChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous);
+    void currentIndexChanged(const QModelIndex &current, const QModelIndex &previous);
 
-    /// Emet signal quan s'expandeix un item, i no té items fills
-    void itemExpanded(QTreeWidgetItem *itemExpanded);
+    /// Emet signal quan s'expandeix un item del qual encara no s'han demanat els fills
+    void itemExpanded(const QModelIndex &index);
 
-    /// Emet signal quan es col·lapsa un item, i no té items fills
-    void itemCollapsed(QTreeWidgetItem *itemCollapsed);
+    /// Actualitza la icona de l'item col·lapsat
+    void itemCollapsed(const QModelIndex &index);
 
     /// Emet signal qua es fa doble click sobre un item
-    void doubleClicked(QTreeWidgetItem *, int);
+    void doubleClicked(const QModelIndex &index);
 
 private:
-    static const QString TypeTextForDummyExpandableItems;
-
-    int m_nextIDICOMItemIDOfStudy;
-    int m_nextDICOMItemIDOfSeries;
-    int m_nextDICOMItemIDOfImage;
-
-    QList<Patient*> m_addedPatients;
-    QHash<int, Study*> m_addedStudiesByDICOMItemID;
-    QHash<int, Series*> m_adddSeriesByDICOMItemID;
-    QHash<int, Image*> m_addedImagesByDICOMItemID;
+    StudyTreeModel *m_model;
 
     /// Menu contextual
     QMenu *m_contextMenu;
@@ -232,14 +188,6 @@ private:
     /// Strings per guardar valors de l'anterior element
     Study *m_oldCurrentStudy;
     Series *m_oldCurrentSeries;
-
-    bool m_qTreeWidgetItemHasBeenDoubleClicked;
-    bool m_useDICOMSourceToDiscriminateStudies;
-
-    /// Icones utilitzades com a root al TreeWidget
-    QIcon m_openFolder, m_closeFolder, m_iconSeries;
-
-    QStudyTreeWidget::ItemTreeLevels m_maximumExpandTreeItemsLevel;
 };
 
 } // end namespace
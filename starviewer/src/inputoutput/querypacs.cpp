@@ -46,6 +46,11 @@ QueryPacs::QueryPacs(PacsDevice pacsDevice)
     m_seriesListGot = false;
     m_imageListGot = false;
 
+    m_resultsBatchSize = 0;
+    m_maximumNumberOfResults = 0;
+    m_numberOfResultsReceived = 0;
+    m_maximumNumberOfResultsReached = false;
+
     this->setUpAsCFind();
 }
 
@@ -93,6 +98,17 @@ void QueryPacs::foundMatchCallback(void *callbackData, T_DIMSE_C_FindRQ *request
             queryPacsCaller->m_cancelRequestSent = true;
         }
     }
+    else if (queryPacsCaller->m_maximumNumberOfResults > 0 && queryPacsCaller->m_numberOfResultsReceived >= queryPacsCaller->m_maximumNumberOfResults)
+    {
+        // Ja tenim tots els resultats que ens han demanat i el PACS en té més, cancel·lem la consulta perquè no ens n'enviï més. Aquest resultat
+        // i els que el PACS ja havia enviat abans de rebre la cancel·lació s'ignoren. Si el PACS en té exactament el màxim no s'arriba mai aquí
+        INFO_LOG(QString("El PACS %1 te mes resultats que el maxim de %2").arg(queryPacsCaller->m_pacsDevice.getAETitle())
+                 .arg(queryPacsCaller->m_maximumNumberOfResults));
+        queryPacsCaller->m_maximumNumberOfResultsReached = true;
+        queryPacsCaller->m_cancelQuery = true;
+        queryPacsCaller->cancelQuery(request);
+        queryPacsCaller->m_cancelRequestSent = true;
+    }
     else
     {
         DICOMTagReader *dicomTagReader = new DICOMTagReader("", responseIdentifiers);
@@ -116,6 +132,8 @@ void QueryPacs::foundMatchCallback(void *callbackData, T_DIMSE_C_FindRQ *request
             queryPacsCaller->addSeries(dicomTagReader);
             queryPacsCaller->addImage(dicomTagReader);
         }
+
+        queryPacsCaller->m_numberOfResultsReceived++;
     }
 }
 
@@ -156,12 +174,20 @@ PACSRequestStatus::QueryRequestStatus QueryPacs::query()
 
     m_pacsConnection->disconnect();
 
+    // Lliurem els pacients que no omplien un bloc sencer
+    emitFoundPatientStudies();
+
     if (!condition.good())
     {
         ERROR_LOG(QString("Error al fer una consulta al PACS %1, descripcio error: %2").arg(m_pacsDevice.getAETitle(), condition.text()));
     }
 
     PACSRequestStatus::QueryRequestStatus queryRequestStatus = getDIMSEStatusCodeAsQueryRequestStatus(findResponse.DimseStatus);
+    if (queryRequestStatus == PACSRequestStatus::QueryCancelled && m_maximumNumberOfResultsReached)
+    {
+        // La cancel·lació l'hem feta nosaltres en arribar al màxim de resultats, per qui ha fet la consulta és una consulta correcta
+        queryRequestStatus = PACSRequestStatus::QueryOk;
+    }
     processServiceClassProviderResponseStatus(findResponse.DimseStatus, statusDetail);
     
     // Dump status detail information if there is some
@@ -179,6 +205,8 @@ PACSRequestStatus::QueryRequestStatus QueryPacs::query(const DicomMask &mask)
 {
     m_cancelQuery = false;
     m_cancelRequestSent = false;
+    m_numberOfResultsReceived = 0;
+    m_maximumNumberOfResultsReached = false;
 
     m_dicomMask = mask;
 
@@ -192,6 +220,21 @@ void QueryPacs::cancelQuery()
     m_cancelQuery = true;
 }
 
+void QueryPacs::setResultsBatchSize(int batchSize)
+{
+    m_resultsBatchSize = batchSize;
+}
+
+void QueryPacs::setMaximumNumberOfResults(int maximumNumberOfResults)
+{
+    m_maximumNumberOfResults = maximumNumberOfResults;
+}
+
+bool QueryPacs::isMaximumNumberOfResultsReached() const
+{
+    return m_maximumNumberOfResultsReached;
+}
+
 void QueryPacs::cancelQuery(T_DIMSE_C_FindRQ *request)
 {
     INFO_LOG(QString("Demanem cancel.lar al PACS %1 l'actual query").arg(m_pacsDevice.getAETitle()));
@@ -217,6 +260,22 @@ void QueryPacs::addPatientStudy(DICOMTagReader *dicomTagReader)
 
     patient->addStudy(study);
     m_patientStudyList.append(patient);
+
+    if (m_resultsBatchSize > 0 && m_patientStudyList.count() >= m_resultsBatchSize)
+    {
+        emitFoundPatientStudies();
+    }
+}
+
+void QueryPacs::emitFoundPatientStudies()
+{
+    if (m_resultsBatchSize > 0 && !m_patientStudyList.isEmpty())
+    {
+        // A partir d'aquí el responsable d'eliminar els pacients és qui rep el signal
+        QList<Patient*> patientStudyList = m_patientStudyList;
+        m_patientStudyList.clear();
+        emit patientStudiesFound(patientStudyList);
+    }
 }
 
 void QueryPacs::addSeries(DICOMTagReader *dicomTagReader)
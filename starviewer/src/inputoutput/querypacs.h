@@ -15,6 +15,7 @@
 #ifndef QUERYPACS
 #define QUERYPACS
 
+#include <QObject>
 #include <QList>
 #include <QHash>
 #include <assoc.h>
@@ -42,7 +43,8 @@ class Image;
 class DICOMTagReader;
 class PACSConnection;
 
-class QueryPacs : public DIMSECService {
+class QueryPacs : public QObject, public DIMSECService {
+Q_OBJECT
 public:
     /// Constructor de la classe
     QueryPacs(PacsDevice pacsDevice);
@@ -57,6 +59,18 @@ public:
     /// cancel·la la query
     void cancelQuery();
 
+    /// Indica que els pacients amb els estudis trobats s'han d'anar lliurant en blocs de batchSize pacients a través del signal patientStudiesFound
+    /// a mesura que el PACS els retorna, en comptes de guardar-los fins que acabi la consulta. Amb 0 (valor per defecte) no es lliuren en blocs.
+    /// Els pacients lliurats ja no es retornen a getQueryResultsAsPatientStudyList()
+    void setResultsBatchSize(int batchSize);
+
+    /// Indica el número màxim de resultats que volem rebre. Quan en arriba un més del màxim es cancel·la la consulta al PACS i la consulta
+    /// es dóna per correcta. Amb 0 (valor per defecte) no hi ha límit
+    void setMaximumNumberOfResults(int maximumNumberOfResults);
+
+    /// Retorna cert si la consulta s'ha aturat perquè el PACS tenia més resultats que el número màxim
+    bool isMaximumNumberOfResultsReached() const;
+
     ///Retornen els pacients amb els estudis trobats. La classe que demani els resultats de cerca d'estudis, és responsable d'eliminar els objects retornats aquest mètode
     QList<Patient*> getQueryResultsAsPatientStudyList();
     ///Retornen les sèries trobades. La classe que demani els resultats de cerca de sèries, és responsable d'eliminar els objects retornats aquest mètode
@@ -64,6 +78,11 @@ public:
     ///Retornen les imatges trobades. La classe que demani els resultats de cerca d'imatge, és responsable d'eliminar els objects retornats aquest mètode
     QList<Image*> getQueryResultsAsImageList();
 
+signals:
+    /// Signal que s'emet amb cada bloc de pacients trobats quan s'ha indicat una mida de bloc. S'emet des del thread que fa la consulta i
+    /// qui el rep passa a ser el responsable d'eliminar els objectes
+    void patientStudiesFound(QList<Patient*> patientStudyList);
+
 private:
     /// Fa el query al pacs
     PACSRequestStatus::QueryRequestStatus query();
@@ -82,6 +101,9 @@ private:
     /// Afegeix l'objecte dicom a la llista d'imatges si no hi existeix
     void addImage(DICOMTagReader *dicomTagReader);
 
+    /// Lliura els pacients que s'han trobat fins ara amb el signal patientStudiesFound, si n'hi ha
+    void emitFoundPatientStudies();
+
     /// Converteix la respota rebuda per partl del PACS a QueryRequestStatus
     PACSRequestStatus::QueryRequestStatus getDIMSEStatusCodeAsQueryRequestStatus(unsigned int dimseStatusCode);
 
@@ -100,6 +122,14 @@ private:
     // Indica si hem demanat la cancel·lació de la consulta actual
     bool m_cancelRequestSent;
 
+    /// Mida dels blocs en que es lliuren els pacients trobats, 0 si no es lliuren en blocs
+    int m_resultsBatchSize;
+    /// Número màxim de resultats a rebre, 0 si no hi ha límit
+    int m_maximumNumberOfResults;
+    /// Número de resultats rebuts en la consulta actual
+    int m_numberOfResultsReceived;
+    bool m_maximumNumberOfResultsReached;
+
     // Indicarà de quin PACS hem obtingut estudis, sèries, imatges
     DICOMSource m_resultsDICOMSource;
 
@@ -27,6 +27,12 @@
 
 namespace udg {
 
+namespace {
+
+int PatientListMetaTypeId = qRegisterMetaType<QList<Patient*> >("QList<Patient*>");
+
+}
+
 QueryPacsJob::QueryPacsJob(PacsDevice pacsDevice, DicomMask mask, QueryLevel queryLevel)
  : PACSJob(pacsDevice)
 {
@@ -34,6 +40,9 @@ QueryPacsJob::QueryPacsJob(PacsDevice pacsDevice, DicomMask mask, QueryLevel que
     m_queryPacs = new QueryPacs(pacsDevice);
     m_mask = mask;
     m_queryLevel = queryLevel;
+
+    // Ha de ser DirectConnection perquè el signal s'emet des del thread del job, que no té event loop
+    connect(m_queryPacs, SIGNAL(patientStudiesFound(QList<Patient*>)), SLOT(patientStudiesFound(QList<Patient*>)), Qt::DirectConnection);
 }
 
 QueryPacsJob::~QueryPacsJob()
@@ -91,6 +100,26 @@ QList<Image*> QueryPacsJob::getImageList()
     return m_queryPacs->getQueryResultsAsImageList();
 }
 
+void QueryPacsJob::setResultsBatchSize(int batchSize)
+{
+    m_queryPacs->setResultsBatchSize(batchSize);
+}
+
+void QueryPacsJob::setMaximumNumberOfResults(int maximumNumberOfResults)
+{
+    m_queryPacs->setMaximumNumberOfResults(maximumNumberOfResults);
+}
+
+bool QueryPacsJob::isMaximumNumberOfResultsReached()
+{
+    return m_queryPacs->isMaximumNumberOfResultsReached();
+}
+
+void QueryPacsJob::patientStudiesFound(QList<Patient*> patientStudyList)
+{
+    emit PACSJobPatientStudiesFound(m_selfPointer.toStrongRef(), patientStudyList);
+}
+
 void QueryPacsJob::requestCancelJob()
 {
     INFO_LOG(QString("S'ha demanat la cancel.lacio del Job de consulta al PACS %1").arg(getPacsDevice().getAETitle()));
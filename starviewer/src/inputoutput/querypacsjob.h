@@ -71,12 +71,31 @@ public:
     /// els objects retornats aquest mètode
     QList<Image*> getImageList();
 
+    /// Indica que els estudis trobats s'han d'anar lliurant amb el signal PACSJobPatientStudiesFound en blocs de batchSize pacients a mesura que
+    /// es reben del PACS. Només té sentit per consultes a nivell d'estudi. S'ha d'indicar abans d'encuar el job
+    void setResultsBatchSize(int batchSize);
+
+    /// Indica el número màxim d'estudis/sèries/imatges que volem obtenir, quan s'hi arriba es cancel·la la consulta al PACS. S'ha d'indicar abans d'encuar el job
+    void setMaximumNumberOfResults(int maximumNumberOfResults);
+
+    /// Retorna cert si la consulta s'ha aturat perquè el PACS tenia més resultats que el número màxim
+    bool isMaximumNumberOfResultsReached();
+
     /// Retorna l'estat de la consulta
     PACSRequestStatus::QueryRequestStatus getStatus();
 
     /// Retorna una descripció de l'estat retornat per la consulta al PACS
     QString getStatusDescription();
 
+signals:
+    /// Signal que s'emet amb cada bloc de pacients amb els estudis trobats quan s'ha indicat una mida de bloc. Qui el rep és responsable d'eliminar
+    /// els objectes. Els blocs es lliuren sempre abans que el signal PACSJobFinished
+    void PACSJobPatientStudiesFound(PACSJobPointer pacsJob, QList<Patient*> patientStudyList);
+
+private slots:
+    /// Reemet el bloc de pacients trobats per QueryPacs indicant de quin job és
+    void patientStudiesFound(QList<Patient*> patientStudyList);
+
 private:
     /// Demana que es cancel·li la consulta del job
     void requestCancelJob();
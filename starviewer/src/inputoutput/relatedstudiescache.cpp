@@ -0,0 +1,226 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+
+#include "relatedstudiescache.h"
+
+#include "patient.h"
+#include "study.h"
+
+#include <QDate>
+#include <QSet>
+
+namespace udg {
+
+const int RelatedStudiesCache::DefaultTimeToLive = 5 * 60 * 1000;
+const int RelatedStudiesCache::DefaultMaximumNumberOfEntries = 100;
+
+RelatedStudiesCache::RelatedStudiesCache()
+ : m_timeToLive(DefaultTimeToLive), m_maximumNumberOfEntries(DefaultMaximumNumberOfEntries), m_numberOfInsertions(0)
+{
+}
+
+RelatedStudiesCache::~RelatedStudiesCache()
+{
+    clear();
+}
+
+void RelatedStudiesCache::setTimeToLive(int timeToLive)
+{
+    m_timeToLive = timeToLive;
+}
+
+int RelatedStudiesCache::getTimeToLive() const
+{
+    return m_timeToLive;
+}
+
+void RelatedStudiesCache::setMaximumNumberOfEntries(int maximumNumberOfEntries)
+{
+    m_maximumNumberOfEntries = qMax(1, maximumNumberOfEntries);
+}
+
+int RelatedStudiesCache::getMaximumNumberOfEntries() const
+{
+    return m_maximumNumberOfEntries;
+}
+
+int RelatedStudiesCache::getNumberOfEntries() const
+{
+    return m_entries.count();
+}
+
+QString RelatedStudiesCache::getKey(Patient *patient, const QDate &untilDate, bool searchByName)
+{
+    return QString("%1\n%2\n%3").arg(patient->getID()).arg(searchByName ? patient->getFullName() : QString()).arg(untilDate.toString(Qt::ISODate));
+}
+
+void RelatedStudiesCache::insert(const QString &key, const QString &pacsID, const QList<Patient*> &patientStudyList)
+{
+    removeExpiredEntries();
+
+    Entry *entry = m_entries.value(key + "\n" + pacsID);
+    if (entry)
+    {
+        deletePatientStudyList(entry->patientStudyList);
+        entry->patientStudyList.clear();
+    }
+    else
+    {
+        while (m_entries.count() >= m_maximumNumberOfEntries)
+        {
+            removeOldestEntry();
+        }
+
+        entry = new Entry;
+        m_entries.insert(key + "\n" + pacsID, entry);
+    }
+
+    QSet<QString> studyInstanceUIDs;
+    foreach (Patient *patient, patientStudyList)
+    {
+        foreach (Study *study, patient->getStudies())
+        {
+            if (studyInstanceUIDs.contains(study->getInstanceUID()))
+            {
+                patient->removeStudy(study->getInstanceUID());
+                delete study;
+            }
+            else
+            {
+                studyInstanceUIDs.insert(study->getInstanceUID());
+            }
+        }
+
+        if (patient->getNumberOfStudies() > 0)
+        {
+            entry->patientStudyList.append(patient);
+        }
+        else
+        {
+            delete patient;
+        }
+    }
+
+    entry->age.start();
+    entry->insertionNumber = m_numberOfInsertions++;
+}
+
+bool RelatedStudiesCache::contains(const QString &key, const QString &pacsID)
+{
+    return getEntry(key, pacsID) != 0;
+}
+
+QList<Patient*> RelatedStudiesCache::getPatientStudyList(const QString &key, const QString &pacsID)
+{
+    Entry *entry = getEntry(key, pacsID);
+    if (!entry)
+    {
+        return QList<Patient*>();
+    }
+
+    return copyPatientStudyList(entry->patientStudyList);
+}
+
+void RelatedStudiesCache::clear()
+{
+    foreach (Entry *entry, m_entries)
+    {
+        deletePatientStudyList(entry->patientStudyList);
+        delete entry;
+    }
+    m_entries.clear();
+}
+
+QList<Patient*> RelatedStudiesCache::copyPatientStudyList(const QList<Patient*> &patientStudyList)
+{
+    QList<Patient*> copies;
+    foreach (Patient *patient, patientStudyList)
+    {
+        Patient *patientCopy = patient->copyWithoutStudies();
+        foreach (Study *study, patient->getStudies())
+        {
+            patientCopy->addStudy(study->copyWithoutSeries());
+        }
+
+        copies.append(patientCopy);
+    }
+
+    return copies;
+}
+
+void RelatedStudiesCache::deletePatientStudyList(const QList<Patient*> &patientStudyList)
+{
+    foreach (Patient *patient, patientStudyList)
+    {
+        qDeleteAll(patient->getStudies());
+        delete patient;
+    }
+}
+
+RelatedStudiesCache::Entry* RelatedStudiesCache::getEntry(const QString &key, const QString &pacsID)
+{
+    Entry *entry = m_entries.value(key + "\n" + pacsID);
+    if (entry && entry->age.elapsed() >= m_timeToLive)
+    {
+        removeEntry(key + "\n" + pacsID);
+        entry = 0;
+    }
+
+    return entry;
+}
+
+void RelatedStudiesCache::removeExpiredEntries()
+{
+    foreach (const QString &entryKey, m_entries.keys())
+    {
+        if (m_entries.value(entryKey)->age.elapsed() >= m_timeToLive)
+        {
+            removeEntry(entryKey);
+        }
+    }
+}
+
+void RelatedStudiesCache::removeOldestEntry()
+{
+    QString oldestEntryKey;
+    Entry *oldestEntry = 0;
+    QHashIterator<QString, Entry*> iterator(m_entries);
+    while (iterator.hasNext())
+    {
+        iterator.next();
+        if (!oldestEntry || iterator.value()->insertionNumber < oldestEntry->insertionNumber)
+        {
+            oldestEntry = iterator.value();
+            oldestEntryKey = iterator.key();
+        }
+    }
+
+    if (oldestEntry)
+    {
+        removeEntry(oldestEntryKey);
+    }
+}
+
+void RelatedStudiesCache::removeEntry(const QString &entryKey)
+{
+    Entry *entry = m_entries.take(entryKey);
+    if (entry)
+    {
+        deletePatientStudyList(entry->patientStudyList);
+        delete entry;
+    }
+}
+
+}
@@ -0,0 +1,119 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+
+#ifndef UDGRELATEDSTUDIESCACHE_H
+#define UDGRELATEDSTUDIESCACHE_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+class QDate;
+
+namespace udg {
+
+class Patient;
+
+/**
+    Keeps for a short time the studies found when searching the related studies of a patient in each PACS, so that opening again a study of the
+    same patient doesn't repeat the same queries against every PACS.
+
+    Results are stored by patient identity and PACS. Expired results are removed each time new ones are inserted, and when the maximum number of
+    entries is reached the oldest one is removed. Each entry has its own copies of the patients and studies found, with the information returned
+    by study level queries, and hands out new copies, so the results of a query can be deleted independently of the cache. Studies found more than
+    once in the same PACS, e.g. when searching by patient ID and by patient name, are only stored once.
+ */
+class RelatedStudiesCache {
+public:
+    RelatedStudiesCache();
+    ~RelatedStudiesCache();
+
+    /// Default time that the results are kept, in milliseconds
+    static const int DefaultTimeToLive;
+
+    /// Default maximum number of results of a PACS for a key that are kept
+    static const int DefaultMaximumNumberOfEntries;
+
+    /// Sets/gets the time that the results are kept, in milliseconds
+    void setTimeToLive(int timeToLive);
+    int getTimeToLive() const;
+
+    /// Sets/gets the maximum number of results of a PACS for a key that are kept
+    void setMaximumNumberOfEntries(int maximumNumberOfEntries);
+    int getMaximumNumberOfEntries() const;
+
+    /// Returns the number of results of a PACS for a key that are stored, including the expired ones that haven't been removed yet
+    int getNumberOfEntries() const;
+
+    /// Returns the key that identifies the studies of the given patient done until the given date, or all of them if the date isn't valid.
+    /// The patient name is only part of the key if studies are also searched by name
+    static QString getKey(Patient *patient, const QDate &untilDate, bool searchByName);
+
+    /// Stores the studies found in the given PACS for the given key, replacing the previous ones. The cache takes ownership of the patients and their
+    /// studies
+    void insert(const QString &key, const QString &pacsID, const QList<Patient*> &patientStudyList);
+
+    /// Returns true if there are results that haven't expired for the given key and PACS
+    bool contains(const QString &key, const QString &pacsID);
+
+    /// Returns copies of the studies found in the given PACS for the given key, or an empty list if there aren't results or they have expired.
+    /// The caller is responsible for deleting them
+    QList<Patient*> getPatientStudyList(const QString &key, const QString &pacsID);
+
+    /// Removes all the results
+    void clear();
+
+    /// Returns copies of the given patients and their studies, with the information returned by study level queries
+    static QList<Patient*> copyPatientStudyList(const QList<Patient*> &patientStudyList);
+
+    /// Deletes the given patients and their studies
+    static void deletePatientStudyList(const QList<Patient*> &patientStudyList);
+
+private:
+    /// Results of a PACS for a key
+    struct Entry {
+        QList<Patient*> patientStudyList;
+        QElapsedTimer age;
+        /// Order in which the entry was inserted, to find the oldest one
+        qint64 insertionNumber;
+    };
+
+    /// Returns the entry of the given key and PACS if it hasn't expired, removing it if it has
+    Entry* getEntry(const QString &key, const QString &pacsID);
+
+    /// Removes all the expired entries
+    void removeExpiredEntries();
+
+    /// Removes the entry that was inserted the longest time ago
+    void removeOldestEntry();
+
+    /// Deletes the entry with the given hash key
+    void removeEntry(const QString &entryKey);
+
+private:
+    /// Entries by key and PACS ID
+    QHash<QString, Entry*> m_entries;
+
+    int m_timeToLive;
+    int m_maximumNumberOfEntries;
+
+    /// Number of insertions done, used to number the entries
+    qint64 m_numberOfInsertions;
+};
+
+}
+
+#endif
@@ -24,9 +24,14 @@
 #include "logging.h"
 #include "querypacsjob.h"
 #include "inputoutputsettings.h"
+#include "relatedstudiescache.h"
 
 namespace udg {
 
+typedef Singleton<RelatedStudiesCache> RelatedStudiesCacheSingleton;
+
+const int RelatedStudiesManager::QueryResultsBatchSize = 100;
+
 RelatedStudiesManager::RelatedStudiesManager()
 {
     m_pacsManager = new PacsManager();
@@ -46,6 +51,7 @@ void RelatedStudiesManager::queryMergedStudies(Patient *patient)
 {
     INFO_LOG("Es buscaran els estudis del pacient " + patient->getFullName() + " amb ID " + patient->getID());
 
+    initializeQuery();
     this->makeAsynchronousStudiesQuery(patient);
 }
 
@@ -54,6 +60,8 @@ void RelatedStudiesManager::queryMergedPreviousStudies(Study *study)
     INFO_LOG("Es buscaran els estudis previs del pacient " + study->getParentPatient()->getFullName() + " amb ID " + study->getParentPatient()->getID() +
     " de l'estudi " + study->getInstanceUID() + " fet a la data " + study->getDate().toString());
 
+    // S'ha d'inicialitzar abans d'indicar l'estudi, perquè cancel·lar la consulta anterior l'esborra
+    initializeQuery();
     m_studyInstanceUIDOfStudyToFindRelated = study->getInstanceUID();
 
     this->makeAsynchronousStudiesQuery(study->getParentPatient(), study->getDate());
@@ -61,10 +69,7 @@ void RelatedStudiesManager::queryMergedPreviousStudies(Study *study)
 
 void RelatedStudiesManager::makeAsynchronousStudiesQuery(Patient *patient, QDate untilDate)
 {
-    initializeQuery();
-
-    QList<PacsDevice> pacsDeviceListToQuery = PacsDeviceManager().getPACSList(PacsDeviceManager::PacsWithQueryRetrieveServiceEnabled, true);
-    pacsDeviceListToQuery = PacsDeviceManager::removeDuplicateSamePACS(pacsDeviceListToQuery + getPACSRetrievedStudiesOfPatient(patient));
+    QList<PacsDevice> pacsDeviceListToQuery = getPACSListToQuery(patient);
 
     if (pacsDeviceListToQuery.count() == 0)
     {
@@ -79,26 +84,77 @@ void RelatedStudiesManager::makeAsynchronousStudiesQuery(Patient *patient, QDate
     {
         // Sinó hi ha cap cconsulta a fer donem la cerca per finalitzada
         queryFinished();
+        return;
     }
-    else
+
+    // Si ens diuen que volen els study's fins una data, hem de marcar aquesta data en els dicomMasks
+    if (untilDate.isValid())
     {
-        // Si ens diuen que volen els study's fins una data, hem de marcar aquesta data en els dicomMasks
-        if (untilDate.isValid())
+        for (int i = 0; i < queryDicomMasksList.count(); i++)
         {
-            foreach (DicomMask dicomMask, queryDicomMasksList)
-            {
-                dicomMask.setStudyDate(QDate(), untilDate);
-            }
+            queryDicomMasksList[i].setStudyDate(QDate(), untilDate);
+        }
+    }
+
+    m_cacheKey = RelatedStudiesCache::getKey(patient, untilDate, m_searchRelatedStudiesByName);
+    RelatedStudiesCache *cache = getCache();
+
+    // Es marquen totes les consultes com a pendents abans de començar-ne cap, perquè la cerca no es doni per acabada abans d'hora si alguna
+    // acaba de seguida
+    QList<PacsDevice> cachedPACSDeviceList;
+    foreach (const PacsDevice &pacsDevice, pacsDeviceListToQuery)
+    {
+        if (cache->contains(m_cacheKey, pacsDevice.getID()))
+        {
+            cachedPACSDeviceList << pacsDevice;
+            m_pacsIDsNotToCache.insert(pacsDevice.getID());
+            m_pendingQueriesPerPACS.insert(pacsDevice.getID(), 1);
+        }
+        else
+        {
+            m_pendingQueriesPerPACS.insert(pacsDevice.getID(), queryDicomMasksList.count());
         }
+    }
 
-        foreach (const PacsDevice &pacsDevice, pacsDeviceListToQuery)
+    foreach (const PacsDevice &pacsDevice, pacsDeviceListToQuery)
+    {
+        if (!cachedPACSDeviceList.contains(pacsDevice))
         {
-            foreach (DicomMask queryDicomMask, queryDicomMasksList)
+            foreach (const DicomMask &queryDicomMask, queryDicomMasksList)
             {
-                enqueueQueryPACSJobToPACSManagerAndConnectSignals(PACSJobPointer(new QueryPacsJob(pacsDevice, queryDicomMask, QueryPacsJob::study)));
+                startStudiesQuery(pacsDevice, queryDicomMask);
             }
         }
     }
+
+    foreach (const PacsDevice &pacsDevice, cachedPACSDeviceList)
+    {
+        INFO_LOG("Es fan servir els estudis trobats fa poc al PACS " + pacsDevice.getAETitle());
+        studiesQueryResultsReceived(pacsDevice, cache->getPatientStudyList(m_cacheKey, pacsDevice.getID()));
+        studiesQueryFinished(pacsDevice, StudiesQueryOk);
+    }
+}
+
+QList<PacsDevice> RelatedStudiesManager::getPACSListToQuery(Patient *patient)
+{
+    QList<PacsDevice> pacsDeviceListToQuery = PacsDeviceManager().getPACSList(PacsDeviceManager::PacsWithQueryRetrieveServiceEnabled, true);
+    return PacsDeviceManager::removeDuplicateSamePACS(pacsDeviceListToQuery + getPACSRetrievedStudiesOfPatient(patient));
+}
+
+void RelatedStudiesManager::startStudiesQuery(const PacsDevice &pacsDevice, const DicomMask &dicomMask)
+{
+    // Els estudis es van fusionant a mesura que arriben, així no cal guardar tots els resultats de cada PACS fins que acaba la consulta
+    QueryPacsJob *queryPacsJob = new QueryPacsJob(pacsDevice, dicomMask, QueryPacsJob::study);
+    queryPacsJob->setResultsBatchSize(QueryResultsBatchSize);
+    connect(queryPacsJob, SIGNAL(PACSJobPatientStudiesFound(PACSJobPointer, QList<Patient*>)),
+            SLOT(queryPACSJobPatientStudiesFound(PACSJobPointer, QList<Patient*>)));
+
+    enqueueQueryPACSJobToPACSManagerAndConnectSignals(PACSJobPointer(queryPacsJob));
+}
+
+RelatedStudiesCache* RelatedStudiesManager::getCache()
+{
+    return RelatedStudiesCacheSingleton::instance();
 }
 
 QList<Study*> RelatedStudiesManager::getStudiesFromDatabase(Patient *patient)
@@ -160,19 +216,33 @@ void RelatedStudiesManager::enqueueQueryPACSJobToPACSManagerAndConnectSignals(PA
 }
 
 void RelatedStudiesManager::cancelCurrentQuery()
+{
+    cancelStudiesQueries();
+
+    m_pendingQueriesPerPACS.clear();
+    m_mergedStudiesPerPACS.clear();
+    foreach (const QList<Patient*> &patientStudyList, m_resultsToCachePerPACS)
+    {
+        RelatedStudiesCache::deletePatientStudyList(patientStudyList);
+    }
+    m_resultsToCachePerPACS.clear();
+    m_pacsIDsNotToCache.clear();
+
+    m_studyInstanceUIDOfStudyToFindRelated = "invalid";
+}
+
+void RelatedStudiesManager::cancelStudiesQueries()
 {
     foreach (PACSJobPointer queryPACSJob, m_queryPACSJobPendingExecuteOrExecuting)
     {
         m_pacsManager->requestCancelPACSJob(queryPACSJob);
         m_queryPACSJobPendingExecuteOrExecuting.remove(queryPACSJob->getPACSJobID());
     }
-
-    m_studyInstanceUIDOfStudyToFindRelated = "invalid";
 }
 
 bool RelatedStudiesManager::isExecutingQueries()
 {
-    return !m_queryPACSJobPendingExecuteOrExecuting.isEmpty();
+    return !m_pendingQueriesPerPACS.isEmpty();
 }
 
 void RelatedStudiesManager::queryPACSJobCancelled(PACSJobPointer pacsJob)
@@ -184,14 +254,9 @@ void RelatedStudiesManager::queryPACSJobCancelled(PACSJobPointer pacsJob)
     {
         ERROR_LOG("El PACSJob que s'ha cancel·lat no es un QueryPACSJob");
     }
-    else
+    else if (m_queryPACSJobPendingExecuteOrExecuting.remove(queryPACSJob->getPACSJobID()) > 0)
     {
-        m_queryPACSJobPendingExecuteOrExecuting.remove(queryPACSJob->getPACSJobID());
-
-        if (m_queryPACSJobPendingExecuteOrExecuting.isEmpty())
-        {
-            queryFinished();
-        }
+        studiesQueryFinished(queryPACSJob->getPacsDevice(), StudiesQueryCancelled);
     }
 }
 
@@ -202,37 +267,117 @@ void RelatedStudiesManager::queryPACSJobFinished(PACSJobPointer pacsJob)
     if (queryPACSJob.isNull())
     {
         ERROR_LOG("El PACSJob que ha finalitzat no es un QueryPACSJob");
+        return;
     }
-    else
+
+    if (m_queryPACSJobPendingExecuteOrExecuting.remove(queryPACSJob->getPACSJobID()) == 0)
     {
+        // És una consulta que s'ha cancel·lat, només hi haurà els estudis que no s'hagin rebut en blocs
         if (queryPACSJob->getStatus() == PACSRequestStatus::QueryOk)
         {
-            mergeFoundStudiesInQuery(pacsJob);
-        }
-        else if (queryPACSJob->getStatus() != PACSRequestStatus::QueryCancelled)
-        {
-            errorQueringPACS(pacsJob);
+            RelatedStudiesCache::deletePatientStudyList(queryPACSJob->getPatientStudyList());
         }
+        return;
+    }
 
-        m_queryPACSJobPendingExecuteOrExecuting.remove(queryPACSJob->getPACSJobID());
+    switch (queryPACSJob->getStatus())
+    {
+        case PACSRequestStatus::QueryOk:
+            // Només hi haurà els estudis que no s'hagin rebut en blocs
+            studiesQueryResultsReceived(queryPACSJob->getPacsDevice(), queryPACSJob->getPatientStudyList());
+            studiesQueryFinished(queryPACSJob->getPacsDevice(), StudiesQueryOk);
+            break;
 
-        if (m_queryPACSJobPendingExecuteOrExecuting.isEmpty())
-        {
-            queryFinished();
-        }
+        case PACSRequestStatus::QueryCancelled:
+            studiesQueryFinished(queryPACSJob->getPacsDevice(), StudiesQueryCancelled);
+            break;
+
+        default:
+            studiesQueryFinished(queryPACSJob->getPacsDevice(), StudiesQueryFailed);
+            break;
+    }
+}
+
+void RelatedStudiesManager::queryPACSJobPatientStudiesFound(PACSJobPointer pacsJob, QList<Patient*> patientStudyList)
+{
+    if (pacsJob.isNull() || !m_queryPACSJobPendingExecuteOrExecuting.contains(pacsJob->getPACSJobID()))
+    {
+        // Són resultats d'una consulta que s'ha cancel·lat
+        RelatedStudiesCache::deletePatientStudyList(patientStudyList);
+        return;
+    }
+
+    studiesQueryResultsReceived(pacsJob->getPacsDevice(), patientStudyList);
+}
+
+void RelatedStudiesManager::studiesQueryResultsReceived(const PacsDevice &pacsDevice, const QList<Patient*> &patientStudyList)
+{
+    QString pacsID = pacsDevice.getID();
+    if (!m_pendingQueriesPerPACS.contains(pacsID))
+    {
+        // No són resultats de la consulta actual
+        RelatedStudiesCache::deletePatientStudyList(patientStudyList);
+        return;
     }
+
+    if (!m_pacsIDsNotToCache.contains(pacsID))
+    {
+        m_resultsToCachePerPACS[pacsID] += RelatedStudiesCache::copyPatientStudyList(patientStudyList);
+    }
+
+    mergeFoundStudies(pacsID, patientStudyList);
 }
 
-void RelatedStudiesManager::mergeFoundStudiesInQuery(PACSJobPointer queryPACSJob)
+void RelatedStudiesManager::studiesQueryFinished(const PacsDevice &pacsDevice, StudiesQueryStatus status)
 {
-    if (queryPACSJob.objectCast<QueryPacsJob>()->getQueryLevel() != QueryPacsJob::study)
+    QString pacsID = pacsDevice.getID();
+    if (!m_pendingQueriesPerPACS.contains(pacsID))
+    {
+        return;
+    }
+
+    if (status != StudiesQueryOk)
+    {
+        m_pacsIDsNotToCache.insert(pacsID);
+
+        if (status == StudiesQueryFailed)
+        {
+            errorQueryingPACS(pacsDevice);
+        }
+    }
+
+    if (--m_pendingQueriesPerPACS[pacsID] > 0)
     {
-        /// Si la consulta no era d'estudis no ens interessa, només cerquem estudis
         return;
     }
 
-    foreach (Patient *patient, queryPACSJob.objectCast<QueryPacsJob>()->getPatientStudyList())
+    // Han acabat totes les consultes al PACS
+    m_pendingQueriesPerPACS.remove(pacsID);
+
+    QList<Patient*> resultsToCache = m_resultsToCachePerPACS.take(pacsID);
+    if (m_pacsIDsNotToCache.contains(pacsID))
+    {
+        RelatedStudiesCache::deletePatientStudyList(resultsToCache);
+    }
+    else
+    {
+        getCache()->insert(m_cacheKey, pacsID, resultsToCache);
+    }
+
+    emit studiesFoundInPACS(m_mergedStudiesPerPACS.take(pacsID), pacsDevice);
+
+    if (m_pendingQueriesPerPACS.isEmpty())
+    {
+        queryFinished();
+    }
+}
+
+void RelatedStudiesManager::mergeFoundStudies(const QString &pacsID, const QList<Patient*> &patientStudyList)
+{
+    foreach (Patient *patient, patientStudyList)
     {
+        bool someStudyMerged = false;
+
         foreach (Study *study, patient->getStudies())
         {
             if (!isStudyInMergedStudyList(study) && !isMainStudy(study))
@@ -240,25 +385,31 @@ void RelatedStudiesManager::mergeFoundStudiesInQuery(PACSJobPointer queryPACSJob
                 // Si l'estudi no està a llista ja d'estudis afegits i no és el mateix estudi pel qua ens han demanat el
                 // previ l'afegim
                 m_mergedStudyList.append(study);
+                m_mergedStudyInstanceUIDs.insert(study->getInstanceUID());
+                m_mergedStudiesPerPACS[pacsID].append(study);
+                someStudyMerged = true;
             }
         }
+
+        if (!someStudyMerged)
+        {
+            // Cap estudi del pacient es farà servir, l'esborrem ara perquè no quedi sense propietari
+            qDeleteAll(patient->getStudies());
+            delete patient;
+        }
     }
 }
 
-void RelatedStudiesManager::errorQueringPACS(PACSJobPointer queryPACSJob)
+void RelatedStudiesManager::errorQueryingPACS(const PacsDevice &pacsDevice)
 {
-    if (queryPACSJob.objectCast<QueryPacsJob>()->getStatus() != PACSRequestStatus::QueryOk &&
-            queryPACSJob.objectCast<QueryPacsJob>()->getStatus() != PACSRequestStatus::QueryCancelled)
+    // Com que fem dos cerques al mateix pacs si una falla, l'altra segurament també fallarà per evitar enviar
+    // dos signals d'error si les dos fallen, ja que per des de fora ha de ser transparent el número de consultes
+    // que es fa al PACS, i han de rebre un sol error comprovem si tenim l'ID del PACS a la llista de signals
+    // d'errors en PACS emesos
+    if (!m_pacsDeviceIDErrorEmited.contains(pacsDevice.getID()))
     {
-        // Com que fem dos cerques al mateix pacs si una falla, l'altra segurament també fallarà per evitar enviar
-        // dos signals d'error si les dos fallen, ja que per des de fora ha de ser transparent el número de consultes
-        // que es fa al PACS, i han de rebre un sol error comprovem si tenim l'ID del PACS a la llista de signals
-        // d'errors en PACS emesos
-        if (!m_pacsDeviceIDErrorEmited.contains(queryPACSJob->getPacsDevice().getID()))
-        {
-            m_pacsDeviceIDErrorEmited.append(queryPACSJob->getPacsDevice().getID());
-            emit errorQueryingStudies(queryPACSJob->getPacsDevice());
-        }
+        m_pacsDeviceIDErrorEmited.append(pacsDevice.getID());
+        emit errorQueryingStudies(pacsDevice);
     }
 }
 
@@ -269,20 +420,9 @@ void RelatedStudiesManager::queryFinished()
     emit queryStudiesFinished(m_mergedStudyList);
 }
 
-bool RelatedStudiesManager::isStudyInMergedStudyList(Study *study)
+bool RelatedStudiesManager::isStudyInMergedStudyList(Study *study) const
 {
-    bool studyFoundInMergedList = false;
-
-    foreach (Study *studyMerged, m_mergedStudyList)
-    {
-        if (study->getInstanceUID() == studyMerged->getInstanceUID())
-        {
-            studyFoundInMergedList = true;
-            break;
-        }
-    }
-
-    return studyFoundInMergedList;
+    return m_mergedStudyInstanceUIDs.contains(study->getInstanceUID());
 }
 
 bool RelatedStudiesManager::isMainStudy(Study *study)
@@ -377,6 +517,7 @@ void RelatedStudiesManager::deleteQueryResults()
     qDeleteAll(patientsStudy);
 
     m_mergedStudyList.clear();
+    m_mergedStudyInstanceUIDs.clear();
 }
 
 QList<PacsDevice> RelatedStudiesManager::getPACSRetrievedStudiesOfPatient(Patient *patient)
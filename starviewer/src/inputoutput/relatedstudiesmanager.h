@@ -17,6 +17,7 @@
 
 #include <QObject>
 #include <QHash>
+#include <QSet>
 #include <QStringList>
 #include <QDate>
 
@@ -30,11 +31,15 @@ class Study;
 class DicomMask;
 class PacsManager;
 class QueryPacsJob;
+class RelatedStudiesCache;
 
 /**
     Aquesta classe donat un Study demana els estudis relacionats o previs en els PACS configurats per defecte, degut a que
     ara actualment en el PACS podem tenir pacients que són el mateix però amb PatientID diferents, també a part de cercar estudis
     que coincideixin amb el PatientID també es farà una altre cerca per Patient Name.
+
+    Els estudis trobats a cada PACS es guarden durant una estona a una RelatedStudiesCache compartida, de manera que tornar a obrir un estudi del
+    mateix pacient no repeteix les consultes. Els resultats es van lliurant a mesura que acaben les consultes de cada PACS amb studiesFoundInPACS().
   */
 /* TODO: En teoria amb la implantació del SAP els problemes de que un Pacient té diversos Patient ID o que té el nom
    escrit de maneres diferents haurien de desapareixer, per tant d'aquí un temps quan la majoria d'estudis del PACS
@@ -85,12 +90,39 @@ signals:
     /// Signal que s'emet quan ha finalitzat la consulta d'estudis. La llista amb els resultats s'esborrarà quan es demani una altra cerca.
     void queryStudiesFinished(QList<Study*>);
 
+    /// Signal que s'emet quan han acabat totes les consultes a un PACS, amb els estudis d'aquest PACS que s'han afegit als resultats, és a dir,
+    /// els que no s'havien trobat abans en cap altre PACS. Els estudis són els mateixos que es lliuraran amb queryStudiesFinished
+    void studiesFoundInPACS(QList<Study*> studies, PacsDevice pacs);
+
     /// Signal que s'emet per indicar que s'ha produït un error a la consulta d'estudis d'un PACS
     void errorQueryingStudies(PacsDevice pacs);
 
     /// Signal que s'emet per indicar que s'ha produït un error durant la descarrega d'un estudi (pot ser previ o no)
     void errorDownloadingStudy(QString studyUID);
 
+protected:
+    /// Resultat d'una consulta d'estudis començada amb startStudiesQuery()
+    enum StudiesQueryStatus { StudiesQueryOk, StudiesQueryFailed, StudiesQueryCancelled };
+
+    /// Retorna els PACS on s'han de cercar els estudis del pacient, els marcats per defecte i els d'on s'han descarregat els seus estudis
+    virtual QList<PacsDevice> getPACSListToQuery(Patient *patient);
+
+    /// Comença una consulta d'estudis al PACS amb la màscara donada. Els estudis trobats s'han de lliurar amb studiesQueryResultsReceived() i el final
+    /// de la consulta s'ha d'indicar amb studiesQueryFinished(). Per defecte s'encua un QueryPacsJob al PacsManager
+    virtual void startStudiesQuery(const PacsDevice &pacsDevice, const DicomMask &dicomMask);
+
+    /// Cancel·la les consultes començades amb startStudiesQuery() que encara no han acabat
+    virtual void cancelStudiesQueries();
+
+    /// Retorna la cache on es guarden els estudis trobats a cada PACS. Per defecte és la mateixa per totes les instàncies
+    virtual RelatedStudiesCache* getCache();
+
+    /// Fusiona amb els trobats fins ara els estudis rebuts d'una consulta al PACS donat. Se n'assumeix la propietat
+    void studiesQueryResultsReceived(const PacsDevice &pacsDevice, const QList<Patient*> &patientStudyList);
+
+    /// Indica que ha acabat una de les consultes al PACS donat. Quan acaben totes les d'un PACS se'n guarden els resultats a la cache si cap ha fallat
+    void studiesQueryFinished(const PacsDevice &pacsDevice, StudiesQueryStatus status);
+
 private:
     /// Realitza una consulta dels estudis del pacient "patient" als PACS marcats per defecte.
     /// Si s'especifica una data "until" només cercarà els estudis fins la data especificada (aquesta inclosa).
@@ -103,7 +135,7 @@ private:
     /// Ens indica si aquell estudi està a la llista d'estudis ja rebuts, per evitar duplicats
     /// Hem de tenir en compte que com fem la cerca per ID i un altre per Patient Name per obtenir més resultats
     /// potser que en les dos consultes ens retornin el mateix estudi, per tant hem d'evitar duplicats.
-    bool isStudyInMergedStudyList(Study *study);
+    bool isStudyInMergedStudyList(Study *study) const;
 
     /// Ens indica si aquest estudi és el mateix pel qual ens han demanat els estudis relacionts, per evitar incloure'l a la llista
     bool isMainStudy(Study *study);
@@ -115,12 +147,12 @@ private:
     /// de hash on es guarden tots els QueryPACSJobs demanats per aquesta classe que estant pendents d'executar-se o s'estan executant
     void enqueueQueryPACSJobToPACSManagerAndConnectSignals(PACSJobPointer queryPACSJob);
 
-    /// Ens afegeix els estudis trobats en una llista, si algun dels estudis ja existeix a la llista perquè s'ha trobat en algun altre PACS no
-    /// se li afegeix
-    void mergeFoundStudiesInQuery(PACSJobPointer queryPACSJob);
+    /// Afegeix els estudis dels pacients passats, trobats al PACS amb l'ID donat, a la llista d'estudis trobats. Els pacients dels quals no s'afegeix
+    /// cap estudi, perquè ja hi són o perquè és l'estudi pel qual s'han demanat els relacionats, s'esborren
+    void mergeFoundStudies(const QString &pacsID, const QList<Patient*> &patientStudyList);
 
     /// Emet signal indicant que la consulta a un PACS ha fallat
-    void errorQueringPACS(PACSJobPointer queryPACSJob);
+    void errorQueryingPACS(const PacsDevice &pacsDevice);
 
     /// Emet signal indicant la la consulta ha acabat
     void queryFinished();
@@ -149,9 +181,17 @@ private slots:
     /// Slot que s'activa quan un job de consulta al PACS és cancel·lat
     void queryPACSJobCancelled(PACSJobPointer pacsJob);
 
+    /// Slot que s'activa amb cada bloc d'estudis que rep un job de consulta, els fusiona amb els rebuts fins ara sense esperar que acabi la consulta
+    void queryPACSJobPatientStudiesFound(PACSJobPointer pacsJob, QList<Patient*> patientStudyList);
+
 private:
+    /// Número de pacients dels blocs en que es reben els estudis de les consultes al PACS
+    static const int QueryResultsBatchSize;
+
     PacsManager *m_pacsManager;
     QList<Study*> m_mergedStudyList;
+    /// Study Instance UID dels estudis de m_mergedStudyList, per comprovar ràpidament si un estudi ja hi és
+    QSet<QString> m_mergedStudyInstanceUIDs;
 
     /// Study instance UID de l'estudi a partir del qual hem de trobar estudis relacionats
     QString m_studyInstanceUIDOfStudyToFindRelated;
@@ -162,6 +202,17 @@ private:
     QStringList m_pacsDeviceIDErrorEmited;
     /// Hash que ens guarda tots els QueryPACSJob pendent d'executar o que s'estan executant llançats des d'aquesta classe
     QHash<int, PACSJobPointer> m_queryPACSJobPendingExecuteOrExecuting;
+
+    /// Número de consultes que falten per acabar de cada PACS, per ID de PACS
+    QHash<QString, int> m_pendingQueriesPerPACS;
+    /// Estudis afegits a m_mergedStudyList des de cada PACS que encara no s'han lliurat amb studiesFoundInPACS
+    QHash<QString, QList<Study*> > m_mergedStudiesPerPACS;
+    /// Còpia de tots els estudis rebuts de cada PACS, que es guardaran a la cache quan n'acabin les consultes
+    QHash<QString, QList<Patient*> > m_resultsToCachePerPACS;
+    /// ID dels PACS dels quals no s'han de guardar els resultats a la cache, perquè ja hi són o perquè alguna consulta ha fallat o s'ha cancel·lat
+    QSet<QString> m_pacsIDsNotToCache;
+    /// Clau de la cache de la consulta actual
+    QString m_cacheKey;
     /// Boolea per saber si s'ha de cercar estudis relacionats a partir del nom del pacient.
     bool m_searchRelatedStudiesByName;
 };
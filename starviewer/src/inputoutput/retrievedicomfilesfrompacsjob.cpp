@@ -148,6 +148,10 @@ void RetrieveDICOMFilesFromPACSJob::run(ThreadWeaver::JobPointer self, ThreadWea
                     m_retrieveRequestStatus = PACSRequestStatus::RetrieveDatabaseError;
                 }
             }
+            else
+            {
+                freeSpaceIfCacheIsAlmostFull();
+            }
         }
         else
         {
@@ -225,6 +229,20 @@ PACSRequestStatus::RetrieveRequestStatus RetrieveDICOMFilesFromPACSJob::thereIsA
     return PACSRequestStatus::RetrieveOk;
 }
 
+void RetrieveDICOMFilesFromPACSJob::freeSpaceIfCacheIsAlmostFull()
+{
+    LocalDatabaseManager localDatabaseManager;
+    connect(&localDatabaseManager, SIGNAL(studyWillBeDeleted(QString)), SIGNAL(studyFromCacheWillBeDeleted(QString)));
+
+    localDatabaseManager.freeSpaceIfCacheIsAlmostFull();
+
+    if (localDatabaseManager.getLastError() != LocalDatabaseManager::Ok)
+    {
+        // No afecta a la descàrrega, ja s'intentarà alliberar espai abans de la següent
+        ERROR_LOG("S'ha produit un error alliberant espai de la cache despres de la descarrega");
+    }
+}
+
 void RetrieveDICOMFilesFromPACSJob::deleteRetrievedDICOMFilesIfStudyNotExistInDatabase()
 {
     // Comprovem si l'estudi està inserit a la base de dades, si és així vol dir que anteriorment s'havia descarregat un part o tot l'estudi,
@@ -354,25 +372,10 @@ QString RetrieveDICOMFilesFromPACSJob::getStatusDescription()
 
 Study* RetrieveDICOMFilesFromPACSJob::copyBasicStudyInformation(Study *studyToCopy)
 {
-    Study *copiedStudy = new Study();
-    Patient *copiedPatient = new Patient();
-
-    copiedPatient->setID(studyToCopy->getParentPatient()->getID());
-    copiedPatient->setFullName(studyToCopy->getParentPatient()->getFullName());
+    Study *copiedStudy = studyToCopy->copyWithoutSeries();
+    Patient *copiedPatient = studyToCopy->getParentPatient()->copyWithoutStudies();
 
     copiedStudy->setParentPatient(copiedPatient);
-    copiedStudy->setInstanceUID(studyToCopy->getInstanceUID());
-    copiedStudy->setID(studyToCopy->getID());
-    copiedStudy->setDateTime(studyToCopy->getDateAsString(), studyToCopy->getTimeAsString());
-    copiedStudy->setDescription(studyToCopy->getDescription());
-    copiedStudy->setAccessionNumber(studyToCopy->getAccessionNumber());
-
-    foreach(QString modality, studyToCopy->getModalities())
-    {
-        copiedStudy->addModality(modality);
-    }
-
-    copiedStudy->setDICOMSource(studyToCopy->getDICOMSource());
 
     return copiedStudy;
 }
@@ -95,6 +95,10 @@ private:
     /// Mtode que ens indica si hi ha espai disponible per descarregar estudis
     PACSRequestStatus::RetrieveRequestStatus thereIsAvailableSpaceOnHardDisk();
 
+    /// Allibera espai de la cache si queda poc espai lliure un cop l'estudi descarregat ja és a la base de dades, perquè les properes descàrregues no
+    /// hagin d'esperar. S'executa al thread del job, no al de la interfície, ja que el job és qui avisa la interfície dels estudis esborrats
+    void freeSpaceIfCacheIsAlmostFull();
+
     /// Esborra els fitxers descarregats de la cach si l'estudi no existeix a la base de dades
     /// Aquest mtode est pensat en casos que la descrrega falla i volem esborrar els fitxers descarregats, noms s'esborran si l'estudi no est inserit
     /// a la bd, si l'estudi est inserit no l'esborrem, perqu part dels fitxers descarregats ja podien estar inserit a la base de dades per una anterior
@@ -0,0 +1,793 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#include "studytreemodel.h"
+
+#include <QCoreApplication>
+#include <QtConcurrentRun>
+#include <QtAlgorithms>
+
+#include "patient.h"
+#include "study.h"
+#include "series.h"
+#include "image.h"
+
+namespace udg {
+
+namespace {
+
+// The texts keep the translation contexts they had when they were defined in QStudyTreeWidget and its .ui, so the existing translations still apply
+const char *const HeaderTexts[StudyTreeModel::ColumnCount] = {
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Name"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Patient ID"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Age"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Description"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Modality"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Date"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Time"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "DICOMItemID"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Institution"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "UID"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Study ID"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Protocol Name"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Acc. Num."),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Type"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Ref. Physician's Name"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "PP Start Date"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "PP Start Time"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Req. Proc. ID"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Sche. Proc. Step ID"),
+    QT_TRANSLATE_NOOP("udg::QStudyTreeWidgetBase", "Birth Date")
+};
+
+}
+
+StudyTreeModel::StudyTreeModel(QObject *parent)
+ : QAbstractItemModel(parent), m_sortColumn(-1), m_sortOrder(Qt::AscendingOrder), m_studiesRevision(0), m_sortedStudiesRevision(0),
+   m_sortInProgress(false), m_sortPending(false), m_useDICOMSourceToDiscriminateStudies(true), m_maximumExpandLevel(ImageItem)
+{
+    m_openFolder = QIcon(":/images/folderopen.png");
+    m_closeFolder = QIcon(":/images/folderclose.png");
+    m_iconSeries = QIcon(":/images/series.png");
+
+    connect(&m_sortWatcher, SIGNAL(finished()), SLOT(sortFinished()));
+}
+
+StudyTreeModel::~StudyTreeModel()
+{
+    m_sortWatcher.waitForFinished();
+
+    foreach (Node *node, m_studyNodes)
+    {
+        deleteNode(node);
+    }
+}
+
+QModelIndex StudyTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!hasIndex(row, column, parent))
+    {
+        return QModelIndex();
+    }
+
+    if (parent.isValid())
+    {
+        return createIndex(row, column, getNode(parent)->children.at(row));
+    }
+    else
+    {
+        return createIndex(row, column, m_studyNodes.at(row));
+    }
+}
+
+QModelIndex StudyTreeModel::parent(const QModelIndex &child) const
+{
+    Node *node = getNode(child);
+
+    if (!node || !node->parent)
+    {
+        return QModelIndex();
+    }
+
+    return createIndexForNode(node->parent);
+}
+
+int StudyTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0)
+    {
+        return 0;
+    }
+
+    if (parent.isValid())
+    {
+        return getNode(parent)->children.count();
+    }
+    else
+    {
+        return m_studyNodes.count();
+    }
+}
+
+int StudyTreeModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+
+    return ColumnCount;
+}
+
+bool StudyTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    if (!parent.isValid())
+    {
+        return !m_studyNodes.isEmpty();
+    }
+
+    if (parent.column() > 0)
+    {
+        return false;
+    }
+
+    // Until the children are requested the item is shown as expandable, they are only queried when the user expands it
+    Node *node = getNode(parent);
+    return !node->children.isEmpty() || (!node->childrenRequested && node->type < m_maximumExpandLevel);
+}
+
+QVariant StudyTreeModel::data(const QModelIndex &index, int role) const
+{
+    Node *node = getNode(index);
+
+    if (!node)
+    {
+        return QVariant();
+    }
+
+    if (role == Qt::DisplayRole)
+    {
+        return getText(node, index.column());
+    }
+    else if (role == Qt::DecorationRole && index.column() == ObjectName)
+    {
+        if (node->type == StudyItem)
+        {
+            return node->expanded ? m_openFolder : m_closeFolder;
+        }
+        else
+        {
+            return m_iconSeries;
+        }
+    }
+
+    return QVariant();
+}
+
+QVariant StudyTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < ColumnCount)
+    {
+        return QCoreApplication::translate("udg::QStudyTreeWidgetBase", HeaderTexts[section]);
+    }
+
+    return QVariant();
+}
+
+void StudyTreeModel::sort(int column, Qt::SortOrder order)
+{
+    m_sortColumn = column;
+    m_sortOrder = order;
+
+    startSort();
+}
+
+bool StudyTreeModel::isSorting() const
+{
+    return m_sortInProgress;
+}
+
+void StudyTreeModel::setUseDICOMSourceToDiscriminateStudies(bool discriminateStudiesByDicomSource)
+{
+    m_useDICOMSourceToDiscriminateStudies = discriminateStudiesByDicomSource;
+}
+
+bool StudyTreeModel::getUseDICOMSourceToDiscriminateStudies() const
+{
+    return m_useDICOMSourceToDiscriminateStudies;
+}
+
+void StudyTreeModel::setMaximumExpandLevel(ItemType maximumExpandLevel)
+{
+    m_maximumExpandLevel = maximumExpandLevel;
+}
+
+StudyTreeModel::ItemType StudyTreeModel::getMaximumExpandLevel() const
+{
+    return m_maximumExpandLevel;
+}
+
+void StudyTreeModel::appendPatients(const QList<Patient*> &patients)
+{
+    QList<Node*> newStudyNodes;
+
+    foreach (Patient *patient, patients)
+    {
+        if (patient->getNumberOfStudies() == 0)
+        {
+            continue;
+        }
+
+        foreach (Study *study, patient->getStudies())
+        {
+            // If the study is already in the model the new one replaces it, the duplicate can also be one of the studies being appended now
+            QModelIndex existingStudyIndex = findStudy(study->getInstanceUID(), study->getDICOMSource());
+            if (existingStudyIndex.isValid())
+            {
+                removeItem(existingStudyIndex);
+            }
+            else
+            {
+                foreach (Node *newStudyNode, m_studyNodesByUID.values(study->getInstanceUID()))
+                {
+                    if (newStudyNodes.contains(newStudyNode) &&
+                        (!m_useDICOMSourceToDiscriminateStudies || newStudyNode->study->getDICOMSource() == study->getDICOMSource()))
+                    {
+                        newStudyNodes.removeOne(newStudyNode);
+                        m_studyNodesByUID.remove(study->getInstanceUID(), newStudyNode);
+                        deleteNode(newStudyNode);
+                    }
+                }
+            }
+
+            Node *node = createNode(StudyItem, 0);
+            node->patient = patient;
+            node->study = study;
+
+            newStudyNodes.append(node);
+            m_studyNodesByUID.insert(study->getInstanceUID(), node);
+            m_addedStudies.append(study);
+        }
+
+        // The same patient object can be shared by several studies, for example in DICOMDIR
+        m_addedPatients.append(patient);
+    }
+
+    if (newStudyNodes.isEmpty())
+    {
+        return;
+    }
+
+    int firstRow = m_studyNodes.count();
+    beginInsertRows(QModelIndex(), firstRow, firstRow + newStudyNodes.count() - 1);
+    m_studyNodes.append(newStudyNodes);
+    updateRows(m_studyNodes, firstRow);
+    m_studiesRevision++;
+    endInsertRows();
+
+    startSort();
+}
+
+void StudyTreeModel::appendSeries(const QModelIndex &studyIndex, const QList<Series*> &seriesList)
+{
+    Node *studyNode = getNode(studyIndex);
+
+    if (!studyNode || studyNode->type != StudyItem || seriesList.isEmpty())
+    {
+        return;
+    }
+
+    int firstRow = studyNode->children.count();
+    beginInsertRows(createIndexForNode(studyNode), firstRow, firstRow + seriesList.count() - 1);
+    foreach (Series *series, seriesList)
+    {
+        Node *node = createNode(SeriesItem, studyNode);
+        node->series = series;
+        studyNode->children.append(node);
+        m_addedSeries.append(series);
+
+        // FIXME: Series és un QObject i setParentStudy li assigna l'estudi com a parent, això falla si s'han creat en threads diferents com pot
+        // passar a la cerca al PACS. Dos QObjects per ser pare i fill han de ser del mateix thread
+        series->setParentStudy(studyNode->study);
+    }
+    updateRows(studyNode->children, firstRow);
+    studyNode->childrenRequested = true;
+    endInsertRows();
+
+    sortChildren(studyNode);
+}
+
+void StudyTreeModel::appendImages(const QModelIndex &seriesIndex, const QList<Image*> &imageList)
+{
+    Node *seriesNode = getNode(seriesIndex);
+
+    if (!seriesNode || seriesNode->type != SeriesItem || imageList.isEmpty())
+    {
+        return;
+    }
+
+    int firstRow = seriesNode->children.count();
+    beginInsertRows(createIndexForNode(seriesNode), firstRow, firstRow + imageList.count() - 1);
+    foreach (Image *image, imageList)
+    {
+        Node *node = createNode(ImageItem, seriesNode);
+        node->image = image;
+        seriesNode->children.append(node);
+        m_addedImages.append(image);
+
+        // FIXME: Image és un QObject i setParentSeries li assigna la sèrie com a parent, això falla si s'han creat en threads diferents com pot
+        // passar a la cerca al PACS. Dos QObjects per ser pare i fill han de ser del mateix thread
+        image->setParentSeries(seriesNode->series);
+    }
+    updateRows(seriesNode->children, firstRow);
+    seriesNode->childrenRequested = true;
+    endInsertRows();
+
+    sortChildren(seriesNode);
+}
+
+void StudyTreeModel::removeItem(const QModelIndex &index)
+{
+    Node *node = getNode(index);
+
+    if (!node)
+    {
+        return;
+    }
+
+    Node *parentNode = node->parent;
+    QList<Node*> &siblings = parentNode ? parentNode->children : m_studyNodes;
+    int row = node->row;
+
+    beginRemoveRows(parentNode ? createIndexForNode(parentNode) : QModelIndex(), row, row);
+    siblings.removeAt(row);
+    updateRows(siblings, row);
+    if (node->type == StudyItem)
+    {
+        m_studyNodesByUID.remove(node->study->getInstanceUID(), node);
+        m_studiesRevision++;
+    }
+    endRemoveRows();
+
+    deleteNode(node);
+}
+
+QModelIndex StudyTreeModel::findStudy(const QString &studyInstanceUID, const DICOMSource &dicomSource) const
+{
+    QMultiHash<QString, Node*>::const_iterator iterator = m_studyNodesByUID.find(studyInstanceUID);
+
+    while (iterator != m_studyNodesByUID.end() && iterator.key() == studyInstanceUID)
+    {
+        Node *node = iterator.value();
+        // Nodes being appended are already in the hash but they don't have a valid row yet
+        if (node->row >= 0 && (!m_useDICOMSourceToDiscriminateStudies || node->study->getDICOMSource() == dicomSource))
+        {
+            return createIndexForNode(node);
+        }
+        ++iterator;
+    }
+
+    return QModelIndex();
+}
+
+QModelIndex StudyTreeModel::findSeries(const QModelIndex &studyIndex, const QString &seriesInstanceUID) const
+{
+    Node *studyNode = getNode(studyIndex);
+
+    if (!studyNode || studyNode->type != StudyItem)
+    {
+        return QModelIndex();
+    }
+
+    foreach (Node *node, studyNode->children)
+    {
+        if (node->series->getInstanceUID() == seriesInstanceUID)
+        {
+            return createIndexForNode(node);
+        }
+    }
+
+    return QModelIndex();
+}
+
+StudyTreeModel::ItemType StudyTreeModel::getItemType(const QModelIndex &index) const
+{
+    return getNode(index)->type;
+}
+
+Study* StudyTreeModel::getStudy(const QModelIndex &index) const
+{
+    Node *node = getNode(index);
+
+    while (node && node->type != StudyItem)
+    {
+        node = node->parent;
+    }
+
+    return node ? node->study : NULL;
+}
+
+Series* StudyTreeModel::getSeries(const QModelIndex &index) const
+{
+    Node *node = getNode(index);
+
+    while (node && node->type == ImageItem)
+    {
+        node = node->parent;
+    }
+
+    return node && node->type == SeriesItem ? node->series : NULL;
+}
+
+Image* StudyTreeModel::getImage(const QModelIndex &index) const
+{
+    Node *node = getNode(index);
+
+    return node && node->type == ImageItem ? node->image : NULL;
+}
+
+bool StudyTreeModel::areChildrenRequested(const QModelIndex &index) const
+{
+    Node *node = getNode(index);
+
+    return node && node->childrenRequested;
+}
+
+void StudyTreeModel::setChildrenRequested(const QModelIndex &index)
+{
+    Node *node = getNode(index);
+
+    if (node)
+    {
+        node->childrenRequested = true;
+    }
+}
+
+void StudyTreeModel::setExpanded(const QModelIndex &index, bool expanded)
+{
+    Node *node = getNode(index);
+
+    if (node && node->expanded != expanded)
+    {
+        node->expanded = expanded;
+
+        QModelIndex nameIndex = createIndexForNode(node, ObjectName);
+        emit dataChanged(nameIndex, nameIndex);
+    }
+}
+
+void StudyTreeModel::clear()
+{
+    beginResetModel();
+
+    foreach (Node *node, m_studyNodes)
+    {
+        deleteNode(node);
+    }
+    m_studyNodes.clear();
+    m_studyNodesByUID.clear();
+    // A background sort in progress is discarded when it finishes because the revision has changed
+    m_studiesRevision++;
+
+    qDeleteAll(m_addedImages);
+    qDeleteAll(m_addedSeries);
+    qDeleteAll(m_addedStudies);
+    qDeleteAll(m_addedPatients);
+
+    m_addedImages.clear();
+    m_addedSeries.clear();
+    m_addedStudies.clear();
+    m_addedPatients.clear();
+
+    endResetModel();
+}
+
+StudyTreeModel::Node* StudyTreeModel::createNode(ItemType type, Node *parent)
+{
+    Node *node = new Node;
+    node->type = type;
+    node->patient = NULL;
+    node->study = NULL;
+    node->series = NULL;
+    node->image = NULL;
+    node->parent = parent;
+    node->row = -1;
+    node->childrenRequested = false;
+    node->expanded = false;
+
+    return node;
+}
+
+StudyTreeModel::Node* StudyTreeModel::getNode(const QModelIndex &index) const
+{
+    if (!index.isValid())
+    {
+        return NULL;
+    }
+
+    return static_cast<Node*>(index.internalPointer());
+}
+
+QModelIndex StudyTreeModel::createIndexForNode(Node *node, int column) const
+{
+    return createIndex(node->row, column, node);
+}
+
+QString StudyTreeModel::getText(const Node *node, int column) const
+{
+    switch (node->type)
+    {
+        case StudyItem:
+            switch (column)
+            {
+                case ObjectName:
+                    return node->patient->getFullName();
+                case PatientID:
+                    return node->patient->getID();
+                case PatientBirth:
+                    return formatDateTime(node->patient->getBirthDate(), QTime());
+                case PatientAge:
+                    return formatAge(node->study->getPatientAge());
+                case Modality:
+                    return node->study->getModalitiesAsSingleString();
+                case Description:
+                    return node->study->getDescription();
+                case Date:
+                    return formatDateTime(node->study->getDate(), node->study->getTime());
+                case StudyID:
+                    return QCoreApplication::translate("udg::QStudyTreeWidget", "Study %1").arg(node->study->getID());
+                case Institution:
+                    return node->study->getInstitutionName();
+                case AccNumber:
+                    return node->study->getAccessionNumber();
+                case UID:
+                    return node->study->getInstanceUID();
+                case Type:
+                    return "STUDY";
+                case RefPhysName:
+                    return node->study->getReferringPhysiciansName();
+            }
+            break;
+
+        case SeriesItem:
+            switch (column)
+            {
+                case ObjectName:
+                    // Padding so that the column can be sorted as text
+                    return QCoreApplication::translate("udg::QStudyTreeWidget", "Series %1").arg(node->series->getSeriesNumber().rightJustified(4, ' '));
+                case Modality:
+                    return node->series->getModality();
+                case Description:
+                    return node->series->getDescription().simplified();
+                case Date:
+                    return formatDateTime(node->series->getDate(), node->series->getTime());
+                case UID:
+                    return node->series->getInstanceUID();
+                case Type:
+                    return "SERIES";
+                case ProtocolName:
+                    return node->series->getProtocolName();
+                case PPStartDate:
+                    return node->series->getPerformedProcedureStepStartDate();
+                case PPStartTime:
+                    return node->series->getPerformedProcedureStepStartTime();
+                case ReqProcID:
+                    return node->series->getRequestedProcedureID();
+                case SchedProcStep:
+                    return node->series->getScheduledProcedureStepID();
+            }
+            break;
+
+        case ImageItem:
+            switch (column)
+            {
+                case ObjectName:
+                    // Padding so that the column can be sorted as text
+                    return QCoreApplication::translate("udg::QStudyTreeWidget", "File %1").arg(node->image->getInstanceNumber().rightJustified(4, ' '));
+                case UID:
+                    return node->image->getSOPInstanceUID();
+                case Type:
+                    return "IMAGE";
+            }
+            break;
+    }
+
+    return QString();
+}
+
+void StudyTreeModel::startSort()
+{
+    if (m_sortColumn < 0)
+    {
+        return;
+    }
+
+    if (m_sortInProgress)
+    {
+        m_sortPending = true;
+        return;
+    }
+
+    m_sortInProgress = true;
+    m_sortPending = false;
+
+    // Only the text of the sort column is copied, the thread doesn't access the DICOM objects
+    QVector<SortKey> keys(m_studyNodes.count());
+    for (int i = 0; i < m_studyNodes.count(); i++)
+    {
+        keys[i].text = getText(m_studyNodes.at(i), m_sortColumn);
+        keys[i].row = i;
+    }
+
+    m_sortedStudiesRevision = m_studiesRevision;
+    m_sortWatcher.setFuture(QtConcurrent::run(&StudyTreeModel::sortKeys, keys, m_sortOrder));
+}
+
+QVector<int> StudyTreeModel::sortKeys(QVector<SortKey> keys, Qt::SortOrder order)
+{
+    if (order == Qt::AscendingOrder)
+    {
+        qStableSort(keys.begin(), keys.end(), sortKeyLessThan);
+    }
+    else
+    {
+        qStableSort(keys.begin(), keys.end(), sortKeyGreaterThan);
+    }
+
+    QVector<int> rows(keys.count());
+    for (int i = 0; i < keys.count(); i++)
+    {
+        rows[i] = keys.at(i).row;
+    }
+
+    return rows;
+}
+
+bool StudyTreeModel::sortKeyLessThan(const SortKey &key1, const SortKey &key2)
+{
+    return key1.text < key2.text;
+}
+
+bool StudyTreeModel::sortKeyGreaterThan(const SortKey &key1, const SortKey &key2)
+{
+    return key2.text < key1.text;
+}
+
+void StudyTreeModel::sortNodes(QList<Node*> &nodes) const
+{
+    QVector<SortKey> keys(nodes.count());
+    for (int i = 0; i < nodes.count(); i++)
+    {
+        keys[i].text = getText(nodes.at(i), m_sortColumn);
+        keys[i].row = i;
+    }
+
+    QList<Node*> sortedNodes;
+    foreach (int row, sortKeys(keys, m_sortOrder))
+    {
+        sortedNodes.append(nodes.at(row));
+    }
+
+    nodes = sortedNodes;
+    updateRows(nodes);
+}
+
+void StudyTreeModel::sortChildren(Node *node)
+{
+    if (m_sortColumn < 0 || node->children.count() < 2)
+    {
+        return;
+    }
+
+    QModelIndexList persistentIndexes = persistentIndexList();
+    emit layoutAboutToBeChanged();
+    sortNodes(node->children);
+    updatePersistentIndexes(persistentIndexes);
+    emit layoutChanged();
+}
+
+void StudyTreeModel::updateRows(QList<Node*> &nodes, int firstRow)
+{
+    for (int row = firstRow; row < nodes.count(); row++)
+    {
+        nodes[row]->row = row;
+    }
+}
+
+void StudyTreeModel::updatePersistentIndexes(const QModelIndexList &persistentIndexes)
+{
+    // Each index points to its node, so the new index is built with the updated row of the node
+    QModelIndexList newIndexes;
+    foreach (const QModelIndex &index, persistentIndexes)
+    {
+        newIndexes.append(createIndexForNode(getNode(index), index.column()));
+    }
+
+    changePersistentIndexList(persistentIndexes, newIndexes);
+}
+
+void StudyTreeModel::deleteNode(Node *node)
+{
+    foreach (Node *child, node->children)
+    {
+        deleteNode(child);
+    }
+
+    delete node;
+}
+
+QString StudyTreeModel::formatAge(const QString &age)
+{
+    QString text(age);
+
+    // Treiem el 0 de davant els anys, el PACS envia per ex: 047Y nosaltes tornem 47Y
+    if (text.length() > 0 && text.at(0) == '0')
+    {
+        text.replace(0, 1, " ");
+    }
+
+    return text;
+}
+
+QString StudyTreeModel::formatDateTime(const QDate &date, const QTime &time)
+{
+    if (!date.isNull() && !time.isNull())
+    {
+        return date.toString(Qt::ISODate) + "   " + time.toString(Qt::ISODate);
+    }
+    else if (!date.isNull())
+    {
+        return date.toString(Qt::ISODate);
+    }
+
+    return QString();
+}
+
+void StudyTreeModel::sortFinished()
+{
+    m_sortInProgress = false;
+
+    // If the studies have changed or the sort column has been changed meanwhile the result is not valid anymore
+    if (m_sortPending || m_sortedStudiesRevision != m_studiesRevision)
+    {
+        startSort();
+        return;
+    }
+
+    QVector<int> rows = m_sortWatcher.result();
+
+    QModelIndexList persistentIndexes = persistentIndexList();
+    emit layoutAboutToBeChanged();
+
+    QList<Node*> sortedStudyNodes;
+    sortedStudyNodes.reserve(rows.count());
+    foreach (int row, rows)
+    {
+        sortedStudyNodes.append(m_studyNodes.at(row));
+    }
+    m_studyNodes = sortedStudyNodes;
+    updateRows(m_studyNodes);
+
+    // Series and images are only inserted when a study is expanded, there are few of them and they are sorted here
+    foreach (Node *studyNode, m_studyNodes)
+    {
+        sortNodes(studyNode->children);
+        foreach (Node *seriesNode, studyNode->children)
+        {
+            sortNodes(seriesNode->children);
+        }
+    }
+
+    updatePersistentIndexes(persistentIndexes);
+    emit layoutChanged();
+}
+
+}
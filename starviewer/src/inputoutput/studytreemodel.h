@@ -0,0 +1,210 @@
+/*************************************************************************************
+  Copyright (C) 2014 Laboratori de Gràfics i Imatge, Universitat de Girona &
+  Institut de Diagnòstic per la Imatge.
+  Girona 2014. All rights reserved.
+  http://starviewer.udg.edu
+
+  This file is part of the Starviewer (Medical Imaging Software) open source project.
+  It is subject to the license terms in the LICENSE file found in the top-level
+  directory of this distribution and at http://starviewer.udg.edu/license. No part of
+  the Starviewer (Medical Imaging Software) open source project, including this file,
+  may be copied, modified, propagated, or distributed except according to the
+  terms contained in the LICENSE file.
+ *************************************************************************************/
+
+#ifndef UDGSTUDYTREEMODEL_H
+#define UDGSTUDYTREEMODEL_H
+
+#include <QAbstractItemModel>
+#include <QFutureWatcher>
+#include <QIcon>
+#include <QMultiHash>
+#include <QVector>
+
+#include "dicomsource.h"
+
+namespace udg {
+
+class Patient;
+class Study;
+class Series;
+class Image;
+
+/**
+    Model with the studies, series and images shown by QStudyTreeWidget.
+
+    Studies are the top level rows, series are children of studies and images are children of series. The model doesn't create any text when
+    items are inserted, the text of each cell is formatted when the view asks for it, so inserting tens of thousands of studies only costs the
+    creation of a small node for each one.
+
+    Sorting is done in a background thread: the text of the sort column of each study is copied to a key array, the array is sorted in the thread
+    and the resulting order is applied when it finishes. While a sort is in progress the model can still be modified, in that case the sort is
+    started again when it finishes. Studies appended to a sorted model are placed at the end and moved to their place by a new background sort.
+
+    The model takes ownership of the inserted Patient, Study, Series and Image objects and deletes them when clear() is called. Removed items are not
+    deleted until then, because the pointers may have been handed out with the signals of QStudyTreeWidget.
+*/
+class StudyTreeModel : public QAbstractItemModel {
+Q_OBJECT
+public:
+    enum ItemType { StudyItem = 0, SeriesItem = 1, ImageItem = 2 };
+
+    enum Column { ObjectName = 0, PatientID = 1, PatientAge = 2, Description = 3, Modality = 4, Date = 5, Time = 6,
+    DICOMItemID = 7, Institution = 8, UID = 9, StudyID = 10, ProtocolName = 11, AccNumber = 12, Type = 13,
+    RefPhysName = 14, PPStartDate = 15, PPStartTime = 16, ReqProcID = 17, SchedProcStep = 18, PatientBirth = 19, ColumnCount = 20 };
+
+    explicit StudyTreeModel(QObject *parent = 0);
+    ~StudyTreeModel();
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+    QModelIndex parent(const QModelIndex &child) const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+    /// Sorts the studies, and the series and images already inserted, by the given column. The studies are sorted in a background thread,
+    /// the new order is applied when it finishes. A negative column disables sorting.
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+    /// Returns true while a background sort is in progress or its result has not been applied yet
+    bool isSorting() const;
+
+    /// Sets whether studies with the same UID but different DICOMSource are different studies or the same one. By default they are different
+    void setUseDICOMSourceToDiscriminateStudies(bool discriminateStudiesByDicomSource);
+    bool getUseDICOMSourceToDiscriminateStudies() const;
+
+    /// Sets the deepest item type that can be expanded: studies can be expanded if it's greater than StudyItem and series if it's greater than SeriesItem
+    void setMaximumExpandLevel(ItemType maximumExpandLevel);
+    ItemType getMaximumExpandLevel() const;
+
+    /// Appends the studies of the given patients. If a study is already in the model the old row is removed first
+    void appendPatients(const QList<Patient*> &patients);
+
+    /// Appends the given series to the given study / images to the given series
+    void appendSeries(const QModelIndex &studyIndex, const QList<Series*> &seriesList);
+    void appendImages(const QModelIndex &seriesIndex, const QList<Image*> &imageList);
+
+    /// Removes the row of the given index and its children
+    void removeItem(const QModelIndex &index);
+
+    /// Returns the index of the study with the given UID and DICOMSource (the DICOMSource is ignored if studies are not discriminated by it),
+    /// or an invalid index if there isn't any
+    QModelIndex findStudy(const QString &studyInstanceUID, const DICOMSource &dicomSource) const;
+    /// Returns the index of the series with the given UID in the given study, or an invalid index if there isn't any
+    QModelIndex findSeries(const QModelIndex &studyIndex, const QString &seriesInstanceUID) const;
+
+    /// Returns the type of the item of the given index. The index must be valid
+    ItemType getItemType(const QModelIndex &index) const;
+
+    /// Return the study/series/image the given index belongs to. getStudy() returns the parent study for series and images and getSeries() returns
+    /// the parent series for images. Null is returned when the index doesn't belong to an object of the requested type
+    Study* getStudy(const QModelIndex &index) const;
+    Series* getSeries(const QModelIndex &index) const;
+    Image* getImage(const QModelIndex &index) const;
+
+    /// Indicates whether the children of the given study/series have already been requested. Until they are, the item is shown as expandable
+    bool areChildrenRequested(const QModelIndex &index) const;
+    void setChildrenRequested(const QModelIndex &index);
+
+    /// Sets whether the given item is expanded in the view, to show the corresponding icon
+    void setExpanded(const QModelIndex &index, bool expanded);
+
+    /// Removes all the rows and deletes all the inserted objects
+    void clear();
+
+private:
+    struct Node {
+        ItemType type;
+        Patient *patient;
+        Study *study;
+        Series *series;
+        Image *image;
+        Node *parent;
+        QList<Node*> children;
+        int row;
+        bool childrenRequested;
+        bool expanded;
+    };
+
+    /// Key of the compact array sorted in the background thread
+    struct SortKey {
+        QString text;
+        int row;
+    };
+
+    Node* createNode(ItemType type, Node *parent);
+    Node* getNode(const QModelIndex &index) const;
+    QModelIndex createIndexForNode(Node *node, int column = 0) const;
+
+    /// Returns the text shown in the given column for the given node
+    QString getText(const Node *node, int column) const;
+
+    /// Starts the background sort of the studies, or marks it as pending if there's one in progress
+    void startSort();
+
+    /// Sorts the given keys and returns the rows in the new order. Runs in the background thread
+    static QVector<int> sortKeys(QVector<SortKey> keys, Qt::SortOrder order);
+    static bool sortKeyLessThan(const SortKey &key1, const SortKey &key2);
+    static bool sortKeyGreaterThan(const SortKey &key1, const SortKey &key2);
+
+    /// Sorts the given list by the current sort column. It doesn't emit any signal
+    void sortNodes(QList<Node*> &nodes) const;
+
+    /// Sorts the children of the given node, emitting the layout change signals
+    void sortChildren(Node *node);
+
+    /// Updates the row of the given nodes with their position in the list
+    static void updateRows(QList<Node*> &nodes, int firstRow = 0);
+
+    /// Updates the persistent indexes after the rows of the nodes have changed
+    void updatePersistentIndexes(const QModelIndexList &persistentIndexes);
+
+    /// Deletes the given node and its children, the DICOM objects are not deleted
+    void deleteNode(Node *node);
+
+    /// Returns the age formatted to be shown
+    static QString formatAge(const QString &age);
+    /// Returns the date and time in ISO 8601 extended (YYYY-MM-DD HH:MM:SS), so they can be sorted as text. If the time is not valid only the date is
+    /// returned and if the date is not valid an empty string is returned
+    static QString formatDateTime(const QDate &date, const QTime &time);
+
+private slots:
+    /// Applies the order computed by the background sort
+    void sortFinished();
+
+private:
+    /// Studies in the order they are shown
+    QList<Node*> m_studyNodes;
+    /// Study nodes by Study Instance UID, to find them without going through all the rows
+    QMultiHash<QString, Node*> m_studyNodesByUID;
+
+    /// Objects owned by the model, deleted in clear()
+    QList<Patient*> m_addedPatients;
+    QList<Study*> m_addedStudies;
+    QList<Series*> m_addedSeries;
+    QList<Image*> m_addedImages;
+
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+
+    /// Incremented each time studies are inserted or removed, to know if the result of a background sort is still valid
+    int m_studiesRevision;
+    /// Revision of the studies when the background sort in progress was started
+    int m_sortedStudiesRevision;
+    /// True from the start of a background sort until its result has been applied
+    bool m_sortInProgress;
+    /// True if a sort has been requested while another one was in progress
+    bool m_sortPending;
+    QFutureWatcher<QVector<int> > m_sortWatcher;
+
+    bool m_useDICOMSourceToDiscriminateStudies;
+    ItemType m_maximumExpandLevel;
+
+    QIcon m_openFolder, m_closeFolder, m_iconSeries;
+};
+
+} // end namespace udg
+
+#endif
@@ -19,6 +19,7 @@
 #include <QDir>
 #include <QProgressDialog>
 #include <QMessageBox>
+#include <QTimer>
 // Recursos
 #include "logging.h"
 #include "extensionworkspace.h"
@@ -32,6 +33,7 @@
 #include "interfacesettings.h"
 #include "screenmanager.h"
 #include "patientcomparer.h"
+#include "startupprofiler.h"
 
 // PACS --------------------------------------------
 #include "queryscreen.h"
@@ -49,6 +51,22 @@ ExtensionHandler::ExtensionHandler(QApplicationMainWindow *mainApp, QObject *par
 
     createConnections();
 
+    m_haveToCloseQueryScreen = false;
+    m_connectedToQueryScreen = false;
+
+    // Crear la QueryScreen és costós, es fa quan ja s'ha mostrat la finestra
+    QTimer::singleShot(0, this, SLOT(connectToQueryScreen()));
+}
+
+void ExtensionHandler::connectToQueryScreen()
+{
+    if (m_connectedToQueryScreen)
+    {
+        return;
+    }
+
+    m_connectedToQueryScreen = true;
+
     // Cada cop que creem una nova finestra tancarem qualsevol instància de QueryScreen. Així queda més clar que 
     // la finestra que la invoca és la que rep el resultat d'aquesta
     // TODO Cal millorar el disseny de la interacció amb la QueryScreen per tal de no tenir problemes com els que s'exposen als tickets
@@ -59,7 +77,10 @@ ExtensionHandler::ExtensionHandler(QApplicationMainWindow *mainApp, QObject *par
     connect(QueryScreenSingleton::instance(), SIGNAL(selectedPatients(QList<Patient*>, bool)), SLOT(processInput(QList<Patient*>, bool)));
 
     connect(QueryScreenSingleton::instance(), SIGNAL(closed()), SLOT(queryScreenIsClosed()));
-    m_haveToCloseQueryScreen = false;
+
+    // És l'últim pas de l'inici de l'aplicació
+    StartupProfiler::endPhase("QueryScreen");
+    StartupProfiler::finish();
 }
 
 ExtensionHandler::~ExtensionHandler()
@@ -97,6 +118,7 @@ void ExtensionHandler::request(int who)
             // HACK degut a que la QueryScreen és un singleton, això provoca efectes colaterals quan teníem
             // dues finestres (mirar ticket #542). Fem aquest petit hack perquè això no passi.
             // Queda pendent resoldre-ho de la forma adequada
+            connectToQueryScreen();
             disconnect(QueryScreenSingleton::instance(), SIGNAL(selectedPatients(QList<Patient*>, bool)), 0, 0);
             QueryScreenSingleton::instance()->showPACSTab();
             connect(QueryScreenSingleton::instance(), SIGNAL(selectedPatients(QList<Patient*>, bool)), SLOT(processInput(QList<Patient*>, bool)));
@@ -107,6 +129,7 @@ void ExtensionHandler::request(int who)
             // HACK degut a que la QueryScreen és un singleton, això provoca efectes colaterals quan teníem
             // dues finestres (mirar ticket #542). Fem aquest petit hack perquè això no passi.
             // Queda pendent resoldre-ho de la forma adequada
+            connectToQueryScreen();
             disconnect(QueryScreenSingleton::instance(), SIGNAL(selectedPatients(QList<Patient*>, bool)), 0, 0);
             QueryScreenSingleton::instance()->openDicomdir();
             connect(QueryScreenSingleton::instance(), SIGNAL(selectedPatients(QList<Patient*>, bool)), SLOT(processInput(QList<Patient*>, bool)));
@@ -118,6 +141,7 @@ void ExtensionHandler::request(int who)
             // HACK degut a que la QueryScreen és un singleton, això provoca efectes colaterals quan teníem
             // dues finestres (mirar ticket #542). Fem aquest petit hack perquè això no passi.
             // Queda pendent resoldre-ho de la forma adequada
+            connectToQueryScreen();
             disconnect(QueryScreenSingleton::instance(), SIGNAL(selectedPatients(QList<Patient*>, bool)), 0, 0);
             QueryScreenSingleton::instance()->showLocalExams();
             connect(QueryScreenSingleton::instance(), SIGNAL(selectedPatients(QList<Patient*>, bool)), SLOT(processInput(QList<Patient*>, bool)));
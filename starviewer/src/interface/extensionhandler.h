@@ -54,6 +54,10 @@ public slots:
     /// @return El contexte de l'extensió, es pot modificar
     ExtensionContext& getContext();
 
+    /// Crea la QueryScreen, si encara no existeix, i es connecta als seus senyals. Es crida un cop mostrada la finestra per no endarrerir-ne
+    /// l'aparició, o abans si es necessita la QueryScreen
+    void connectToQueryScreen();
+
 private slots:
     /// Processa un conjunt d'arxius d'input i els processa per decidir què fer amb aquests, com per exemple
     /// crear nous pacient, obrir finestres, afegir les dades al pacient actual, etc
@@ -101,6 +105,9 @@ private:
     /// Indica si a aquesta finestra li pertoca o no tancar la QueryScreen
     bool m_haveToCloseQueryScreen;
 
+    /// Indica si ja s'ha cridat connectToQueryScreen()
+    bool m_connectedToQueryScreen;
+
     /// Mutex to avoid concurrent access to the patient comparer singleton.
     QMutex m_patientComparerMutex;
 
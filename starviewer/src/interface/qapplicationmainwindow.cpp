@@ -26,6 +26,7 @@
 #include "extensionmediatorfactory.h"
 #include "starviewerapplication.h"
 #include "statswatcher.h"
+#include "startupprofiler.h"
 #include "databaseinstallation.h"
 #include "interfacesettings.h"
 #include "starviewerapplicationcommandline.h"
@@ -41,6 +42,7 @@
 #include "screenmanager.h"
 #include "qscreendistribution.h"
 #include "volumerepository.h"
+#include "stringpool.h"
 #include "applicationstylehelper.h"
 #include "qdiagnosistest.h"
 
@@ -98,12 +100,19 @@ QApplicationMainWindow::QApplicationMainWindow(QWidget *parent)
     m_extensionWorkspace = new ExtensionWorkspace(this);
     this->setCentralWidget(m_extensionWorkspace);
 
-    DatabaseInstallation databaseInstallation;
-    if (!databaseInstallation.checkStarviewerDatabase())
+    // La base de dades només es comprova en crear la primera finestra, la resta de finestres la comparteixen
+    static bool databaseChecked = false;
+    if (!databaseChecked)
     {
-        QString errorMessage = databaseInstallation.getErrorMessage();
-        QMessageBox::critical(0, ApplicationNameString, tr("There have been some errors:") + "\n" + errorMessage + "\n\n" + 
-                                                    tr("You can resolve this error at Tools > Configuration > Local Database."));
+        DatabaseInstallation databaseInstallation;
+        if (!databaseInstallation.checkStarviewerDatabase())
+        {
+            QString errorMessage = databaseInstallation.getErrorMessage();
+            QMessageBox::critical(0, ApplicationNameString, tr("There have been some errors:") + "\n" + errorMessage + "\n\n" + 
+                                                        tr("You can resolve this error at Tools > Configuration > Local Database."));
+        }
+        databaseChecked = true;
+        StartupProfiler::endPhase("Comprovació de la base de dades");
     }
 
     m_extensionHandler = new ExtensionHandler(this);
@@ -112,6 +121,7 @@ QApplicationMainWindow::QApplicationMainWindow(QWidget *parent)
 
     createActions();
     createMenus();
+    StartupProfiler::endPhase("Accions i menús");
 
     m_applicationVersionChecker = new ApplicationVersionChecker(this);
     m_applicationVersionChecker->checkReleaseNotes();
@@ -139,6 +149,7 @@ QApplicationMainWindow::QApplicationMainWindow(QWidget *parent)
         layoutConfigsLoader.load();
 
         repositoriesLoaded = true;
+        StartupProfiler::endPhase("Hanging protocols, window levels i layouts");
     }
 #endif
 
@@ -603,6 +614,8 @@ void QApplicationMainWindow::setPatient(Patient *patient)
         this->killBill();
         delete m_patient;
         m_patient = NULL;
+        // Alliberem les metadades compartides que només feien servir les imatges del pacient esborrat
+        StringPool::instance()->purge();
         DEBUG_LOG("Ja teníem un pacient, l'esborrem.");
     }
 
@@ -770,6 +783,8 @@ void QApplicationMainWindow::newCommandLineOptionsToRun()
                 break;
             case StarviewerApplicationCommandLine::retrieveStudyFromAccessioNumber:
                 INFO_LOG("Rebut argument de linia de comandes per descarregar un estudi a traves del seu accession number");
+                // La petició l'escolta la QueryScreen, que es crea en diferit
+                m_extensionHandler->connectToQueryScreen();
                 sendRequestRetrieveStudyWithAccessionNumberToLocalStarviewer(optionValue.second);
                 break;
             default:
@@ -12,7 +12,7 @@ CREATE TABLE DatabaseRevision
 -- IMPORTANT!!! Cal canviar el número de revisió per un de superior cada vegada que es faci un canvi a aquest fitxer i calgui
 -- que la BD s'actualitzi
 
-INSERT INTO DatabaseRevision (Revision) VALUES ('9592');
+INSERT INTO DatabaseRevision (Revision) VALUES ('9593');
 
 CREATE TABLE PACSRetrievedImages
 (
@@ -51,7 +51,8 @@ CREATE TABLE Study
   LastAccessDate                TEXT,
   RetrievedDate                 TEXT,
   RetrievedTime                 TEXT,
-  State                         INTEGER
+  State                         INTEGER,
+  SizeInBytes                   INTEGER
 );
 
 CREATE TABLE Series
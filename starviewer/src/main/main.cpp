@@ -15,6 +15,7 @@
 #include "qapplicationmainwindow.h"
 
 #include "logging.h"
+#include "queuedlogappender.h"
 #include "statswatcher.h"
 #include "extensions.h"
 #include "extensionmediatorfactory.h"
@@ -34,6 +35,7 @@
 #include "starviewerapplicationcommandline.h"
 #include "applicationcommandlineoptions.h"
 #include "loggingoutputwindow.h"
+#include "startupprofiler.h"
 #include "vtkinit.h"
 
 #ifndef NO_CRASH_REPORTER
@@ -80,6 +82,8 @@ void configureLogging()
     }
 
     LOGGER_INIT(configurationFile.toStdString());
+    // Els missatges s'escriuen als fitxers des d'un thread en segon pla per no bloquejar qui els genera
+    udg::QueuedLogAppender::install();
     DEBUG_LOG("Arxiu de configuració del log: " + configurationFile);
 
     // Redirigim els missatges de VTK cap al log.
@@ -103,23 +107,14 @@ void initializeTranslations(QApplication &app)
     initExtensionsResources();
     INFO_LOG("Locales = " + defaultLocale.name());
 
-    QStringList extensionsMediatorNames = udg::ExtensionMediatorFactory::instance()->getFactoryIdentifiersList();
-    foreach (const QString &mediatorName, extensionsMediatorNames)
+    // Els mediators es registren amb l'ID de la seva extensió (veure InstallExtension), així que no cal crear-los per saber-lo
+    QStringList extensionIDs = udg::ExtensionMediatorFactory::instance()->getFactoryIdentifiersList();
+    foreach (const QString &extensionID, extensionIDs)
     {
-        udg::ExtensionMediator *mediator = udg::ExtensionMediatorFactory::instance()->create(mediatorName);
-
-        if (mediator)
-        {
-            QString translationFilePath = ":/extensions/" + mediator->getExtensionID().getID() + "/translations_" + defaultLocale.name();
-            if (!translationsLoader.loadTranslation(translationFilePath))
-            {
-                ERROR_LOG("No s'ha pogut carregar el translator " + translationFilePath);
-            }
-            delete mediator;
-        }
-        else
+        QString translationFilePath = ":/extensions/" + extensionID + "/translations_" + defaultLocale.name();
+        if (!translationsLoader.loadTranslation(translationFilePath))
         {
-            ERROR_LOG("Error carregant el mediator de " + mediatorName);
+            ERROR_LOG("No s'ha pogut carregar el translator " + translationFilePath);
         }
     }
 }
@@ -153,6 +148,8 @@ int main(int argc, char *argv[])
     // Utilitzem QtSingleApplication en lloc de QtApplication, ja que ens permet tenir executant sempre una sola instància d'Starviewer, si l'usuari executa
     // una nova instància d'Starviewer aquesta ho detecta i envia la línia de comandes amb que l'usuari ha executat la nova instància principal.
 
+    udg::StartupProfiler::start();
+
     QtSingleApplication app(argc, argv);
 
     QPixmap splashPixmap;
@@ -171,6 +168,7 @@ int main(int argc, char *argv[])
     {
         splash.show();
     }
+    udg::StartupProfiler::endPhase("Aplicació i splash");
 
     app.setOrganizationName(udg::OrganizationNameString);
     app.setOrganizationDomain(udg::OrganizationDomainString);
@@ -191,6 +189,7 @@ int main(int argc, char *argv[])
     // Marquem l'inici de l'aplicació al log
     INFO_LOG("==================================================== BEGIN ====================================================");
     INFO_LOG(QString("%1 Version %2 BuildID %3").arg(udg::ApplicationNameString).arg(udg::StarviewerVersionString).arg(udg::StarviewerBuildID));
+    udg::StartupProfiler::endPhase("Crash handler i log");
 
     // Inicialitzem els settings
     udg::CoreSettings coreSettings;
@@ -202,9 +201,11 @@ int main(int argc, char *argv[])
     inputoutputSettings.init();
     interfaceSettings.init();
     shortcuts.init();
+    udg::StartupProfiler::endPhase("Settings");
 
     initQtPluginsDirectory();
     initializeTranslations(app);
+    udg::StartupProfiler::endPhase("Traduccions");
 
     // Registering the available sync actions
     udg::SyncActionsRegister::registerSyncActions();
@@ -215,6 +216,7 @@ int main(int argc, char *argv[])
     // registrem els codecs decompressors JPEG i RLE
     DJDecoderRegistration::registerCodecs();
     DcmRLEDecoderRegistration::registerCodecs();
+    udg::StartupProfiler::endPhase("Sync actions i codecs");
 
     // Seguint les recomanacions de la documentació de Qt, guardem la llista d'arguments en una variable, ja que aquesta operació és costosa
     // http://doc.trolltech.com/4.7/qcoreapplication.html#arguments
@@ -246,12 +248,15 @@ int main(int argc, char *argv[])
         }
     }
 
+    udg::StartupProfiler::endPhase("Línia de comandes");
+
     int returnValue;
     if (app.isRunning())
     {
         // Hi ha una altra instància del Starviewer executant-se
         INFO_LOG("Hi ha una altra instancia de l'starviewer executant-se. S'enviaran els arguments de la linia de comandes a la instancia principal.");
 
+        udg::StartupProfiler::finish();
         sendToFirstStarviewerInstanceCommandLineOptions(app);
 
         returnValue = 0;
@@ -270,6 +275,8 @@ int main(int argc, char *argv[])
         QObject::connect(&app, SIGNAL(lastWindowClosed()),
                          &app, SLOT(quit()));
         splash.close();
+        // L'inici acaba quan l'ExtensionHandler ha creat la QueryScreen, un cop ja es veu la finestra
+        udg::StartupProfiler::endPhase("Mostrar la finestra principal");
 
         // S'ha esperat a tenir-ho tot carregat per processar els aguments rebuts per línia de comandes, d'aquesta manera per exemoke si en llança algun
         // QMessageBox, ja es llança mostrant-se la MainWindow.
@@ -286,6 +293,10 @@ int main(int argc, char *argv[])
     INFO_LOG(QString("%1 Version %2 BuildID %3, returnValue %4").arg(udg::ApplicationNameString).arg(udg::StarviewerVersionString)
              .arg(udg::StarviewerBuildID).arg(returnValue));
     INFO_LOG("===================================================== END =====================================================");
+    INFO_LOG(QString("Missatges de log descartats per tenir la cua plena: %1").arg(udg::QueuedLogAppender::getNumberOfDroppedRecords()));
+
+    // Escrivim els missatges pendents abans de sortir
+    udg::QueuedLogAppender::shutdown();
 
     return returnValue;
 }
@@ -7,6 +7,8 @@
 /// A part dels paràmetres que QTest defineix de cada test, se n'han afegint més:
 ///     -saveOutputToDir <dirPath>: guarda l'output de cada testsuite a un fitxer del format <nomDelTest>.txt.
 ///                                 Requeriments: el directori NO ha d'existir o ha d'estar buit.
+///     -runBenchmarks: executa també els benchmarks (*_Benchmark), que per defecte se salten. També es poden activar amb la variable
+///                     d'entorn STARVIEWER_RUN_BENCHMARKS.
 ///     -testsToExecute string1 [string2 ... stringN]: executarà només els testos que el seu nom contingui algun dels strings especificats. És case insensitive.
 ///                                                    D'aquesta manera es permet executar un test concret o tots aquells que continguin una certa paraula, per exemple, "pacs".
 
@@ -44,6 +46,12 @@ inline int run()
 
     // Comprovem paràmetres nostres. Si ni ha, els eliminem perquè al executar el test no es queixi.
     QStringList arguments = qApp->arguments();
+    if (arguments.contains("-runBenchmarks"))
+    {
+        arguments.removeAll("-runBenchmarks");
+        benchmarksEnabled() = true;
+    }
+
     if (arguments.contains("-saveOutputToDir"))
     {
         int argumentPosition = arguments.indexOf("-saveOutputToDir");
@@ -33,6 +33,14 @@ inline bool findObject(QObject* object)
     return false;
 }
 
+/// Benchmarks are slow and allocate large volumes, so they are only run when enabled with -runBenchmarks or the STARVIEWER_RUN_BENCHMARKS
+/// environment variable
+inline bool& benchmarksEnabled()
+{
+    static bool enabled = !qgetenv("STARVIEWER_RUN_BENCHMARKS").isEmpty();
+    return enabled;
+}
+
 inline void addTest(QObject* object)
 {
     TestList& list = testList();
@@ -58,4 +66,11 @@ public:
 
 #define DECLARE_TEST(className) static Test<className> t(#className);
 
+/// Skips the current benchmark unless benchmarks are enabled. It must be the first statement of each *_Benchmark test function
+#define SKIP_BENCHMARK_UNLESS_ENABLED() \
+    if (!AutoTest::benchmarksEnabled()) \
+    { \
+        QSKIP("Benchmarks are only run with -runBenchmarks or STARVIEWER_RUN_BENCHMARKS"); \
+    }
+
 #endif // AUTOTEST_H
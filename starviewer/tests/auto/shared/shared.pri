@@ -21,9 +21,11 @@ SOURCES += $$PWD/pacsdevicetesthelper.cpp \
            $$PWD/testingdicomtagreader.cpp \
            $$PWD/testingpacsconnection.cpp \
            $$PWD/testingsenddicomfilestopacs.cpp \
+           $$PWD/testingrelatedstudiesmanager.cpp \
            $$PWD/testingsettings.cpp \
            $$PWD/testingmammographyimagehelper.cpp \
-           $$PWD/testingdecaycorrectionfactorformulacalculator.cpp
+           $$PWD/testingdecaycorrectionfactorformulacalculator.cpp \
+           $$PWD/testingconverttodicomdir.cpp
            
 HEADERS += $$PWD/autotest.h \
            $$PWD/pacsdevicetesthelper.h \
@@ -48,6 +50,8 @@ HEADERS += $$PWD/autotest.h \
            $$PWD/testingdicomtagreader.h \
            $$PWD/testingpacsconnection.h \
            $$PWD/testingsenddicomfilestopacs.h \
+           $$PWD/testingrelatedstudiesmanager.h \
            $$PWD/testingsettings.h \
            $$PWD/testingmammographyimagehelper.h \
-           $$PWD/testingdecaycorrectionfactorformulacalculator.h
+           $$PWD/testingdecaycorrectionfactorformulacalculator.h \
+           $$PWD/testingconverttodicomdir.h
@@ -0,0 +1,69 @@
+#include "testingconverttodicomdir.h"
+
+#include "image.h"
+#include "patient.h"
+#include "series.h"
+#include "study.h"
+
+namespace testing {
+
+void TestingConvertToDicomdir::addTestingStudy(const QString &patientID, const QString &studyUID, const QList<QStringList> &seriesFiles)
+{
+    TestingStudy study;
+    study.patientID = patientID;
+    study.seriesFiles = seriesFiles;
+
+    m_studies.insert(studyUID, study);
+}
+
+Patient* TestingConvertToDicomdir::queryPatientStudy(const QString &studyUID)
+{
+    return createPatient(studyUID, false);
+}
+
+Patient* TestingConvertToDicomdir::retrievePatientStudy(const QString &studyUID, Status &state)
+{
+    Patient *patient = createPatient(studyUID, true);
+    state.setStatus(patient ? "" : "Estudi no trobat", patient != NULL, -1);
+
+    return patient;
+}
+
+Patient* TestingConvertToDicomdir::createPatient(const QString &studyUID, bool withSeries) const
+{
+    if (!m_studies.contains(studyUID))
+    {
+        return NULL;
+    }
+
+    const TestingStudy &testingStudy = m_studies[studyUID];
+
+    Patient *patient = new Patient();
+    patient->setID(testingStudy.patientID);
+
+    Study *study = new Study();
+    study->setInstanceUID(studyUID);
+    patient->addStudy(study);
+
+    if (withSeries)
+    {
+        for (int seriesIndex = 0; seriesIndex < testingStudy.seriesFiles.count(); seriesIndex++)
+        {
+            Series *series = new Series();
+            series->setInstanceUID(QString("%1.%2").arg(studyUID).arg(seriesIndex + 1));
+            study->addSeries(series);
+
+            foreach (const QString &file, testingStudy.seriesFiles.at(seriesIndex))
+            {
+                Image *image = new Image();
+                image->setSOPInstanceUID(file);
+                image->setPath(file);
+                series->addImage(image);
+            }
+        }
+    }
+
+    return patient;
+}
+
+}
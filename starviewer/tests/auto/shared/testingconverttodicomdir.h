@@ -0,0 +1,42 @@
+#ifndef TESTINGCONVERTTODICOMDIR_H
+#define TESTINGCONVERTTODICOMDIR_H
+
+#include "converttodicomdir.h"
+
+#include <QHash>
+
+using namespace udg;
+
+namespace testing {
+
+/// ConvertToDicomdir que obté els estudis dels afegits amb addTestingStudy() en comptes de la base de dades local
+class TestingConvertToDicomdir : public ConvertToDicomdir {
+
+public:
+
+    /// Afegeix un estudi del pacient donat. Cada element de seriesFiles són els fitxers de les imatges d'una sèrie
+    void addTestingStudy(const QString &patientID, const QString &studyUID, const QList<QStringList> &seriesFiles);
+
+private:
+
+    virtual Patient* queryPatientStudy(const QString &studyUID);
+    virtual Patient* retrievePatientStudy(const QString &studyUID, Status &state);
+
+    /// Crea un pacient amb l'estudi donat. Si withSeries és cert també li afegeix les sèries i les imatges
+    Patient* createPatient(const QString &studyUID, bool withSeries) const;
+
+private:
+
+    /// Estudi afegit amb addTestingStudy()
+    struct TestingStudy {
+        QString patientID;
+        QList<QStringList> seriesFiles;
+    };
+
+    QHash<QString, TestingStudy> m_studies;
+
+};
+
+}
+
+#endif // TESTINGCONVERTTODICOMDIR_H
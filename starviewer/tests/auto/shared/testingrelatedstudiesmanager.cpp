@@ -0,0 +1,141 @@
+#include "testingrelatedstudiesmanager.h"
+
+#include "patient.h"
+#include "study.h"
+
+namespace testing {
+
+TestingRelatedStudiesManager::TestingRelatedStudiesManager(RelatedStudiesCache *cache) :
+    RelatedStudiesManager(), m_numberOfStartedQueries(0), m_cache(cache)
+{
+}
+
+TestingRelatedStudiesManager::~TestingRelatedStudiesManager()
+{
+    cancelCurrentQuery();
+}
+
+void TestingRelatedStudiesManager::setPACSList(const QList<PacsDevice> &pacsList)
+{
+    m_pacsList = pacsList;
+}
+
+void TestingRelatedStudiesManager::addStudyToPACS(const QString &pacsID, const QString &patientID, const QString &patientName,
+                                                  const QString &studyInstanceUID, const QDate &date)
+{
+    TestingStudy study;
+    study.patientID = patientID;
+    study.patientName = patientName;
+    study.studyInstanceUID = studyInstanceUID;
+    study.date = date;
+
+    m_studiesPerPACS[pacsID].append(study);
+}
+
+void TestingRelatedStudiesManager::answerQueries(const QString &pacsID)
+{
+    QList<QPair<PacsDevice, DicomMask> > queries = takePendingQueries(pacsID);
+    for (int i = 0; i < queries.count(); i++)
+    {
+        studiesQueryResultsReceived(queries.at(i).first, getMatchingStudies(pacsID, queries.at(i).second));
+        studiesQueryFinished(queries.at(i).first, StudiesQueryOk);
+    }
+}
+
+void TestingRelatedStudiesManager::answerQueriesInBatches(const QString &pacsID, int batchSize)
+{
+    QList<QPair<PacsDevice, DicomMask> > queries = takePendingQueries(pacsID);
+    for (int i = 0; i < queries.count(); i++)
+    {
+        QList<Patient*> patientStudyList = getMatchingStudies(pacsID, queries.at(i).second);
+        for (int first = 0; first < patientStudyList.count(); first += batchSize)
+        {
+            studiesQueryResultsReceived(queries.at(i).first, patientStudyList.mid(first, batchSize));
+        }
+        studiesQueryFinished(queries.at(i).first, StudiesQueryOk);
+    }
+}
+
+void TestingRelatedStudiesManager::failQueries(const QString &pacsID)
+{
+    QList<QPair<PacsDevice, DicomMask> > queries = takePendingQueries(pacsID);
+    for (int i = 0; i < queries.count(); i++)
+    {
+        studiesQueryFinished(queries.at(i).first, StudiesQueryFailed);
+    }
+}
+
+int TestingRelatedStudiesManager::getNumberOfStartedQueries() const
+{
+    return m_numberOfStartedQueries;
+}
+
+int TestingRelatedStudiesManager::getNumberOfPendingQueries() const
+{
+    return m_pendingQueries.count();
+}
+
+QList<PacsDevice> TestingRelatedStudiesManager::getPACSListToQuery(Patient *patient)
+{
+    Q_UNUSED(patient);
+    return m_pacsList;
+}
+
+void TestingRelatedStudiesManager::startStudiesQuery(const PacsDevice &pacsDevice, const DicomMask &dicomMask)
+{
+    m_pendingQueries.append(qMakePair(pacsDevice, dicomMask));
+    m_numberOfStartedQueries++;
+}
+
+void TestingRelatedStudiesManager::cancelStudiesQueries()
+{
+    m_pendingQueries.clear();
+}
+
+RelatedStudiesCache* TestingRelatedStudiesManager::getCache()
+{
+    return m_cache;
+}
+
+QList<QPair<PacsDevice, DicomMask> > TestingRelatedStudiesManager::takePendingQueries(const QString &pacsID)
+{
+    QList<QPair<PacsDevice, DicomMask> > queries;
+    for (int i = m_pendingQueries.count() - 1; i >= 0; i--)
+    {
+        if (m_pendingQueries.at(i).first.getID() == pacsID)
+        {
+            queries.prepend(m_pendingQueries.takeAt(i));
+        }
+    }
+
+    return queries;
+}
+
+QList<Patient*> TestingRelatedStudiesManager::getMatchingStudies(const QString &pacsID, const DicomMask &dicomMask) const
+{
+    QList<Patient*> patientStudyList;
+    foreach (const TestingStudy &testingStudy, m_studiesPerPACS.value(pacsID))
+    {
+        if ((!dicomMask.getPatientID().isEmpty() && dicomMask.getPatientID() != testingStudy.patientID)
+            || (!dicomMask.getPatientName().isEmpty() && dicomMask.getPatientName() != testingStudy.patientName)
+            || (dicomMask.getStudyDateMaximum().isValid() && testingStudy.date > dicomMask.getStudyDateMaximum()))
+        {
+            continue;
+        }
+
+        Patient *patient = new Patient();
+        patient->setID(testingStudy.patientID);
+        patient->setFullName(testingStudy.patientName);
+
+        Study *study = new Study();
+        study->setInstanceUID(testingStudy.studyInstanceUID);
+        study->setDate(testingStudy.date);
+        patient->addStudy(study);
+
+        patientStudyList.append(patient);
+    }
+
+    return patientStudyList;
+}
+
+}
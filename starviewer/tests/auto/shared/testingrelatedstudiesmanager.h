@@ -0,0 +1,81 @@
+#ifndef TESTINGRELATEDSTUDIESMANAGER_H
+#define TESTINGRELATEDSTUDIESMANAGER_H
+
+#include "relatedstudiesmanager.h"
+
+#include "dicommask.h"
+
+#include <QDate>
+#include <QPair>
+
+using namespace udg;
+
+namespace testing {
+
+/// RelatedStudiesManager que respon les consultes amb els estudis afegits a cada PACS amb addStudyToPACS(), sense consultar cap PACS real.
+/// Les consultes queden pendents fins que es crida answerQueries() o failQueries()
+class TestingRelatedStudiesManager : public RelatedStudiesManager {
+
+public:
+
+    TestingRelatedStudiesManager(RelatedStudiesCache *cache);
+    ~TestingRelatedStudiesManager();
+
+    /// Assigna els PACS que es consultaran
+    void setPACSList(const QList<PacsDevice> &pacsList);
+
+    /// Afegeix un estudi al PACS amb l'ID donat
+    void addStudyToPACS(const QString &pacsID, const QString &patientID, const QString &patientName, const QString &studyInstanceUID, const QDate &date);
+
+    /// Respon les consultes pendents al PACS amb l'ID donat amb els estudis que hi coincideixen
+    void answerQueries(const QString &pacsID);
+
+    /// Respon les consultes pendents al PACS amb l'ID donat lliurant els estudis que hi coincideixen en blocs del número de pacients donat,
+    /// com fa QueryPacsJob amb setResultsBatchSize()
+    void answerQueriesInBatches(const QString &pacsID, int batchSize);
+
+    /// Fa fallar les consultes pendents al PACS amb l'ID donat
+    void failQueries(const QString &pacsID);
+
+    /// Retorna el número de consultes començades des de la creació de l'objecte
+    int getNumberOfStartedQueries() const;
+
+    /// Retorna el número de consultes que encara no s'han respost
+    int getNumberOfPendingQueries() const;
+
+protected:
+
+    virtual QList<PacsDevice> getPACSListToQuery(Patient *patient);
+    virtual void startStudiesQuery(const PacsDevice &pacsDevice, const DicomMask &dicomMask);
+    virtual void cancelStudiesQueries();
+    virtual RelatedStudiesCache* getCache();
+
+private:
+
+    /// Estudi guardat en un PACS
+    struct TestingStudy {
+        QString patientID;
+        QString patientName;
+        QString studyInstanceUID;
+        QDate date;
+    };
+
+    /// Treu de la llista de consultes pendents les del PACS donat i les retorna
+    QList<QPair<PacsDevice, DicomMask> > takePendingQueries(const QString &pacsID);
+
+    /// Retorna els estudis del PACS donat que coincideixen amb la màscara
+    QList<Patient*> getMatchingStudies(const QString &pacsID, const DicomMask &dicomMask) const;
+
+private:
+
+    QList<PacsDevice> m_pacsList;
+    QHash<QString, QList<TestingStudy> > m_studiesPerPACS;
+    QList<QPair<PacsDevice, DicomMask> > m_pendingQueries;
+    int m_numberOfStartedQueries;
+    RelatedStudiesCache *m_cache;
+
+};
+
+}
+
+#endif // TESTINGRELATEDSTUDIESMANAGER_H
@@ -19,6 +19,11 @@ SOURCES += $$PWD/test_image.cpp \
            $$PWD/test_hangingprotocol.cpp \
            $$PWD/test_imageoverlay.cpp \
            $$PWD/test_imageoverlayreader.cpp \
+           $$PWD/test_imageoverlaycache.cpp \
+           $$PWD/test_stringpool.cpp \
+           $$PWD/test_queuedlogappender.cpp \
+           $$PWD/test_cineframepacer.cpp \
+           $$PWD/test_cineframeprefetcher.cpp \
            $$PWD/test_drawerbitmap.cpp \
            $$PWD/test_displayshutter.cpp \
            $$PWD/test_firewallaccesstest.cpp \
@@ -86,7 +91,18 @@ SOURCES += $$PWD/test_image.cpp \
            $$PWD/test_voilut.cpp \
            $$PWD/test_hangingprotocolimagesetrestriction.cpp \
            $$PWD/test_hangingprotocolimagesetrestrictionexpression.cpp \
-           $$PWD/test_externalapplication.cpp
+           $$PWD/test_externalapplication.cpp \
+           $$PWD/test_regiongrowing.cpp \
+           $$PWD/test_settingscache.cpp \
+           $$PWD/test_obliqueresliceengine.cpp \
+           $$PWD/test_syncactionmanager.cpp \
+           $$PWD/test_displayshuttermask.cpp \
+           $$PWD/test_vtkimageshuttermask.cpp \
+           $$PWD/test_fusionlayercache.cpp \
+           $$PWD/test_temporalroiengine.cpp \
+           $$PWD/test_spanmask.cpp \
+           $$PWD/test_startupprofiler.cpp \
+           $$PWD/test_referencelinesengine.cpp
 
 win32 {
     SOURCES += $$PWD/test_windowsfirewallaccess.cpp \
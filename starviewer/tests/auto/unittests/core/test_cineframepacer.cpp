@@ -0,0 +1,124 @@
+#include "autotest.h"
+#include "cineframepacer.h"
+
+using namespace udg;
+
+class test_CineFramePacer : public QObject {
+Q_OBJECT
+
+private slots:
+    void advance_ShouldReturnExpectedFramesAndStatistics_data();
+    void advance_ShouldReturnExpectedFramesAndStatistics();
+
+    void getTimeUntilNextFrame_ShouldReturnExpectedValues_data();
+    void getTimeUntilNextFrame_ShouldReturnExpectedValues();
+
+    void start_ShouldResetStatistics();
+
+    void setFramesPerSecond_ShouldKeepStatistics();
+};
+
+Q_DECLARE_METATYPE(QList<qint64>)
+Q_DECLARE_METATYPE(QList<int>)
+
+void test_CineFramePacer::advance_ShouldReturnExpectedFramesAndStatistics_data()
+{
+    QTest::addColumn<double>("framesPerSecond");
+    QTest::addColumn< QList<qint64> >("times");
+    QTest::addColumn< QList<int> >("expectedFramesToAdvance");
+    QTest::addColumn<int>("expectedPresentedFrames");
+    QTest::addColumn<int>("expectedDroppedFrames");
+    QTest::addColumn<double>("expectedMeanLatency");
+    QTest::addColumn<qint64>("expectedMaximumLatency");
+
+    QTest::newRow("on time") << 10.0 << (QList<qint64>() << 100 << 200 << 300) << (QList<int>() << 1 << 1 << 1) << 3 << 0 << 0.0 << Q_INT64_C(0);
+    QTest::newRow("too early") << 10.0 << (QList<qint64>() << 50 << 99) << (QList<int>() << 0 << 0) << 0 << 0 << 0.0 << Q_INT64_C(0);
+    QTest::newRow("late without drops") << 10.0 << (QList<qint64>() << 110 << 230) << (QList<int>() << 1 << 1) << 2 << 0 << 20.0 << Q_INT64_C(30);
+    QTest::newRow("late with drops") << 10.0 << (QList<qint64>() << 100 << 350 << 400) << (QList<int>() << 1 << 2 << 1) << 3 << 1 << 50.0 / 3.0
+                                     << Q_INT64_C(50);
+    QTest::newRow("drift doesn't accumulate") << 30.0 << (QList<qint64>() << 40 << 70 << 100) << (QList<int>() << 1 << 1 << 1) << 3 << 0 << 10.0 / 3.0
+                                              << Q_INT64_C(7);
+}
+
+void test_CineFramePacer::advance_ShouldReturnExpectedFramesAndStatistics()
+{
+    QFETCH(double, framesPerSecond);
+    QFETCH(QList<qint64>, times);
+    QFETCH(QList<int>, expectedFramesToAdvance);
+    QFETCH(int, expectedPresentedFrames);
+    QFETCH(int, expectedDroppedFrames);
+    QFETCH(double, expectedMeanLatency);
+    QFETCH(qint64, expectedMaximumLatency);
+
+    CineFramePacer pacer;
+    pacer.start(framesPerSecond, 0);
+
+    for (int i = 0; i < times.size(); i++)
+    {
+        QCOMPARE(pacer.advance(times.at(i)), expectedFramesToAdvance.at(i));
+    }
+
+    QCOMPARE(pacer.getNumberOfPresentedFrames(), expectedPresentedFrames);
+    QCOMPARE(pacer.getNumberOfDroppedFrames(), expectedDroppedFrames);
+    QCOMPARE(pacer.getMeanLatency(), expectedMeanLatency);
+    QCOMPARE(pacer.getMaximumLatency(), expectedMaximumLatency);
+}
+
+void test_CineFramePacer::getTimeUntilNextFrame_ShouldReturnExpectedValues_data()
+{
+    QTest::addColumn<double>("framesPerSecond");
+    QTest::addColumn<qint64>("startTime");
+    QTest::addColumn<qint64>("now");
+    QTest::addColumn<int>("expectedTime");
+
+    QTest::newRow("at start") << 10.0 << Q_INT64_C(1000) << Q_INT64_C(1000) << 100;
+    QTest::newRow("halfway") << 10.0 << Q_INT64_C(1000) << Q_INT64_C(1050) << 50;
+    QTest::newRow("due") << 10.0 << Q_INT64_C(1000) << Q_INT64_C(1100) << 0;
+    QTest::newRow("late") << 10.0 << Q_INT64_C(1000) << Q_INT64_C(1500) << 0;
+    QTest::newRow("fractional period") << 30.0 << Q_INT64_C(0) << Q_INT64_C(0) << 33;
+}
+
+void test_CineFramePacer::getTimeUntilNextFrame_ShouldReturnExpectedValues()
+{
+    QFETCH(double, framesPerSecond);
+    QFETCH(qint64, startTime);
+    QFETCH(qint64, now);
+    QFETCH(int, expectedTime);
+
+    CineFramePacer pacer;
+    pacer.start(framesPerSecond, startTime);
+
+    QCOMPARE(pacer.getTimeUntilNextFrame(now), expectedTime);
+}
+
+void test_CineFramePacer::start_ShouldResetStatistics()
+{
+    CineFramePacer pacer;
+    pacer.start(10.0, 0);
+    pacer.advance(500);
+
+    pacer.start(10.0, 1000);
+
+    QCOMPARE(pacer.getNumberOfPresentedFrames(), 0);
+    QCOMPARE(pacer.getNumberOfDroppedFrames(), 0);
+    QCOMPARE(pacer.getMeanLatency(), 0.0);
+    QCOMPARE(pacer.getMaximumLatency(), Q_INT64_C(0));
+    QCOMPARE(pacer.getNextFrameTime(), Q_INT64_C(1100));
+}
+
+void test_CineFramePacer::setFramesPerSecond_ShouldKeepStatistics()
+{
+    CineFramePacer pacer;
+    pacer.start(10.0, 0);
+    pacer.advance(300);
+
+    pacer.setFramesPerSecond(20.0, 300);
+
+    QCOMPARE(pacer.getNumberOfPresentedFrames(), 1);
+    QCOMPARE(pacer.getNumberOfDroppedFrames(), 2);
+    QCOMPARE(pacer.getNextFrameTime(), Q_INT64_C(350));
+}
+
+DECLARE_TEST(test_CineFramePacer)
+
+#include "test_cineframepacer.moc"
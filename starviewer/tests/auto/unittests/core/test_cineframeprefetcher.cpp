@@ -0,0 +1,189 @@
+#include "autotest.h"
+#include "cineframeprefetcher.h"
+
+#include "imagepipeline.h"
+#include "windowlevel.h"
+
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+#include <cstring>
+
+using namespace udg;
+
+class test_CineFramePrefetcher : public QObject {
+Q_OBJECT
+
+private slots:
+    void prefetch_ShouldComputeSameFramesAsImagePipeline_data();
+    void prefetch_ShouldComputeSameFramesAsImagePipeline();
+
+    void prefetch_ShouldDoNothingWithoutPipelineSettings();
+
+    void prefetch_ShouldKeepAtMostCapacityFrames();
+
+    void invalidate_ShouldDiscardFramesAndSettings();
+
+private:
+    /// Returns the settings of a thick slab of the given number of slices on a 16x12x10 volume with values that change along each axis
+    static CineFramePrefetcher::PipelineSettings createPipelineSettings(int slabThickness, AccumulatorFactory::AccumulatorType slabProjectionMode);
+};
+
+Q_DECLARE_METATYPE(AccumulatorFactory::AccumulatorType)
+
+void test_CineFramePrefetcher::prefetch_ShouldComputeSameFramesAsImagePipeline_data()
+{
+    QTest::addColumn<int>("slabThickness");
+    QTest::addColumn<AccumulatorFactory::AccumulatorType>("slabProjectionMode");
+
+    QTest::newRow("MIP of 3 slices") << 3 << AccumulatorFactory::Maximum;
+    QTest::newRow("MinIP of 4 slices") << 4 << AccumulatorFactory::Minimum;
+    QTest::newRow("average of 2 slices") << 2 << AccumulatorFactory::Average;
+}
+
+void test_CineFramePrefetcher::prefetch_ShouldComputeSameFramesAsImagePipeline()
+{
+    QFETCH(int, slabThickness);
+    QFETCH(AccumulatorFactory::AccumulatorType, slabProjectionMode);
+
+    CineFramePrefetcher::PipelineSettings settings = createPipelineSettings(slabThickness, slabProjectionMode);
+    QList<int> imageIndices;
+    imageIndices << 2 << 3 << 4 << 5;
+
+    CineFramePrefetcher prefetcher;
+    prefetcher.setPipelineSettings(settings);
+    prefetcher.prefetch(imageIndices);
+    prefetcher.waitForFrames();
+
+    ImagePipeline pipeline;
+    pipeline.setInput(settings.input);
+    pipeline.setProjectionAxis(settings.projectionAxis);
+    pipeline.setSlabThickness(settings.slabThickness);
+    pipeline.setSlabStride(settings.slabStride);
+    pipeline.setSlabProjectionMode(settings.slabProjectionMode);
+    pipeline.setVoiLut(settings.voiLut);
+
+    foreach (int imageIndex, imageIndices)
+    {
+        CineFramePrefetcher::Frame frame = prefetcher.getFrame(imageIndex);
+        QCOMPARE(frame.imageIndex, imageIndex);
+        QVERIFY(frame.output);
+        QVERIFY(frame.slabProjection);
+
+        pipeline.setSlice(imageIndex);
+        pipeline.update();
+        vtkImageData *expectedOutput = pipeline.getOutput().getVtkImageData();
+        vtkImageData *expectedSlabProjection = pipeline.getSlabProjectionOutput();
+
+        int extent[6], expectedExtent[6];
+        frame.output->GetExtent(extent);
+        expectedOutput->GetExtent(expectedExtent);
+        for (int i = 0; i < 6; i++)
+        {
+            QCOMPARE(extent[i], expectedExtent[i]);
+        }
+
+        vtkDataArray *scalars = frame.output->GetPointData()->GetScalars();
+        vtkDataArray *expectedScalars = expectedOutput->GetPointData()->GetScalars();
+        QCOMPARE(scalars->GetDataType(), expectedScalars->GetDataType());
+        QCOMPARE(scalars->GetNumberOfTuples(), expectedScalars->GetNumberOfTuples());
+        QCOMPARE(scalars->GetNumberOfComponents(), expectedScalars->GetNumberOfComponents());
+        int size = scalars->GetNumberOfTuples() * scalars->GetNumberOfComponents() * scalars->GetDataTypeSize();
+        QVERIFY(memcmp(scalars->GetVoidPointer(0), expectedScalars->GetVoidPointer(0), size) == 0);
+
+        vtkDataArray *slabScalars = frame.slabProjection->GetPointData()->GetScalars();
+        vtkDataArray *expectedSlabScalars = expectedSlabProjection->GetPointData()->GetScalars();
+        QCOMPARE(slabScalars->GetNumberOfTuples(), expectedSlabScalars->GetNumberOfTuples());
+        size = slabScalars->GetNumberOfTuples() * slabScalars->GetNumberOfComponents() * slabScalars->GetDataTypeSize();
+        QVERIFY(memcmp(slabScalars->GetVoidPointer(0), expectedSlabScalars->GetVoidPointer(0), size) == 0);
+    }
+}
+
+void test_CineFramePrefetcher::prefetch_ShouldDoNothingWithoutPipelineSettings()
+{
+    CineFramePrefetcher prefetcher;
+    prefetcher.prefetch(QList<int>() << 0 << 1);
+    prefetcher.waitForFrames();
+
+    QVERIFY(!prefetcher.hasPipelineSettings());
+    QVERIFY(!prefetcher.getFrame(0).output);
+    QVERIFY(!prefetcher.getFrame(1).output);
+}
+
+void test_CineFramePrefetcher::prefetch_ShouldKeepAtMostCapacityFrames()
+{
+    CineFramePrefetcher prefetcher(2);
+    prefetcher.setPipelineSettings(createPipelineSettings(3, AccumulatorFactory::Maximum));
+
+    // Only the first two requests are taken into account
+    prefetcher.prefetch(QList<int>() << 0 << 1 << 2);
+    prefetcher.waitForFrames();
+
+    QVERIFY(prefetcher.getFrame(0).output);
+    QVERIFY(prefetcher.getFrame(1).output);
+    QVERIFY(!prefetcher.getFrame(2).output);
+
+    // Frames that are no longer requested make room for the new ones
+    prefetcher.prefetch(QList<int>() << 1 << 2);
+    prefetcher.waitForFrames();
+
+    QVERIFY(!prefetcher.getFrame(0).output);
+    QVERIFY(prefetcher.getFrame(1).output);
+    QVERIFY(prefetcher.getFrame(2).output);
+}
+
+void test_CineFramePrefetcher::invalidate_ShouldDiscardFramesAndSettings()
+{
+    CineFramePrefetcher prefetcher;
+    prefetcher.setPipelineSettings(createPipelineSettings(3, AccumulatorFactory::Maximum));
+    prefetcher.prefetch(QList<int>() << 0 << 1);
+    prefetcher.waitForFrames();
+    QVERIFY(prefetcher.getFrame(0).output);
+
+    prefetcher.invalidate();
+
+    QVERIFY(!prefetcher.hasPipelineSettings());
+    QVERIFY(!prefetcher.getFrame(0).output);
+    QVERIFY(!prefetcher.getFrame(1).output);
+
+    // Nothing is computed until there are new settings
+    prefetcher.prefetch(QList<int>() << 0);
+    prefetcher.waitForFrames();
+    QVERIFY(!prefetcher.getFrame(0).output);
+}
+
+CineFramePrefetcher::PipelineSettings test_CineFramePrefetcher::createPipelineSettings(int slabThickness,
+                                                                                       AccumulatorFactory::AccumulatorType slabProjectionMode)
+{
+    vtkSmartPointer<vtkImageData> input = vtkSmartPointer<vtkImageData>::New();
+    input->SetExtent(0, 15, 0, 11, 0, 9);
+    input->SetSpacing(0.5, 0.5, 2.0);
+    input->SetOrigin(10.0, -20.0, 30.0);
+    input->AllocateScalars(VTK_SHORT, 1);
+
+    short *scalars = static_cast<short*>(input->GetScalarPointer());
+    for (int z = 0; z < 10; z++)
+    {
+        for (int y = 0; y < 12; y++)
+        {
+            for (int x = 0; x < 16; x++)
+            {
+                *scalars++ = x * 7 - y * 5 + (z * 37) % 11 * 13;
+            }
+        }
+    }
+
+    CineFramePrefetcher::PipelineSettings settings;
+    settings.input = input;
+    settings.projectionAxis = OrthogonalPlane::XYPlane;
+    settings.slabThickness = slabThickness;
+    settings.slabStride = 1;
+    settings.slabProjectionMode = slabProjectionMode;
+    settings.voiLut = WindowLevel(120.0, 40.0);
+
+    return settings;
+}
+
+DECLARE_TEST(test_CineFramePrefetcher)
+
+#include "test_cineframeprefetcher.moc"
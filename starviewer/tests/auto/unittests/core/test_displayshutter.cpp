@@ -7,6 +7,7 @@
 #include <QPainter>
 
 #include <vtkImageData.h>
+#include <vtkPointData.h>
 
 using namespace udg;
 
@@ -42,6 +43,8 @@ private slots:
 
     void getAsVtkImageData_ReturnsExpectedValues_data();
     void getAsVtkImageData_ReturnsExpectedValues();
+
+    void getAsVtkImageData_ShouldShareScalarsOfShuttersWithSameGeometryAndSize();
 };
 
 Q_DECLARE_METATYPE(DisplayShutter::ShapeType)
@@ -481,6 +484,25 @@ void test_DisplayShutter::getAsVtkImageData_ReturnsExpectedValues()
     }
 }
 
+void test_DisplayShutter::getAsVtkImageData_ShouldShareScalarsOfShuttersWithSameGeometryAndSize()
+{
+    DisplayShutter shutter;
+    shutter.setPoints(QPoint(20, 30), 15);
+    DisplayShutter sameShutter;
+    sameShutter.setPoints("20,30;15");
+    DisplayShutter otherShutter;
+    otherShutter.setPoints(QPoint(20, 30), 16);
+
+    vtkSmartPointer<vtkImageData> shutterData = shutter.getAsVtkImageData(64, 64, 0);
+    vtkSmartPointer<vtkImageData> sameShutterData = sameShutter.getAsVtkImageData(64, 64, 3);
+
+    QVERIFY(shutterData != sameShutterData);
+    QCOMPARE(sameShutterData->GetPointData()->GetScalars(), shutterData->GetPointData()->GetScalars());
+    QCOMPARE(sameShutterData->GetExtent()[4], 3);
+    QVERIFY(otherShutter.getAsVtkImageData(64, 64, 0)->GetPointData()->GetScalars() != shutterData->GetPointData()->GetScalars());
+    QVERIFY(shutter.getAsVtkImageData(64, 65, 0)->GetPointData()->GetScalars() != shutterData->GetPointData()->GetScalars());
+}
+
 DECLARE_TEST(test_DisplayShutter)
 
 #include "test_displayshutter.moc"
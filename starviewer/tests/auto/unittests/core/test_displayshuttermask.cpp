@@ -0,0 +1,215 @@
+#include "autotest.h"
+#include "displayshuttermask.h"
+
+#include "displayshutter.h"
+
+#include <QImage>
+
+using namespace udg;
+
+typedef QList<QPair<int, int> > SpanList;
+
+class test_DisplayShutterMask : public QObject {
+Q_OBJECT
+
+private slots:
+    void getRowSpans_ShouldReturnExpectedSpans_data();
+    void getRowSpans_ShouldReturnExpectedSpans();
+
+    void isVisible_ShouldMatchPaintedPolygon_data();
+    void isVisible_ShouldMatchPaintedPolygon();
+
+    void fill_ShouldFillExpectedValues();
+
+    void constructor_Benchmark_data();
+    void constructor_Benchmark();
+
+private:
+    static SpanList getRowSpans(const DisplayShutterMask &mask, int row);
+};
+
+Q_DECLARE_METATYPE(DisplayShutter)
+Q_DECLARE_METATYPE(SpanList)
+
+void test_DisplayShutterMask::getRowSpans_ShouldReturnExpectedSpans_data()
+{
+    QTest::addColumn<DisplayShutter>("shutter");
+    QTest::addColumn<int>("row");
+    QTest::addColumn<SpanList>("expectedSpans");
+
+    QTest::newRow("undefined shutter") << DisplayShutter() << 5 << SpanList();
+
+    DisplayShutter rectangularShutter;
+    rectangularShutter.setPoints(QPoint(2, 2), QPoint(4, 4));
+    QTest::newRow("rectangle, row above") << rectangularShutter << 1 << SpanList();
+    QTest::newRow("rectangle, first row") << rectangularShutter << 2 << (SpanList() << qMakePair(2, 5));
+    QTest::newRow("rectangle, last row") << rectangularShutter << 4 << (SpanList() << qMakePair(2, 5));
+    QTest::newRow("rectangle, row below") << rectangularShutter << 5 << SpanList();
+
+    DisplayShutter clippedRectangularShutter;
+    clippedRectangularShutter.setPoints(QPoint(-5, -5), QPoint(20, 3));
+    QTest::newRow("clipped rectangle") << clippedRectangularShutter << 0 << (SpanList() << qMakePair(0, 10));
+
+    DisplayShutter circularShutter;
+    circularShutter.setPoints(QPoint(5, 5), 3);
+    QTest::newRow("circle, top row") << circularShutter << 2 << (SpanList() << qMakePair(5, 6));
+    QTest::newRow("circle, centre row") << circularShutter << 5 << (SpanList() << qMakePair(2, 9));
+    QTest::newRow("circle, bottom row") << circularShutter << 8 << (SpanList() << qMakePair(5, 6));
+    QTest::newRow("circle, row below") << circularShutter << 9 << SpanList();
+
+    DisplayShutter concavePolygonalShutter;
+    concavePolygonalShutter.setPoints(QVector<QPoint>() << QPoint(0, 0) << QPoint(3, 4) << QPoint(6, 0) << QPoint(9, 4) << QPoint(9, 8)
+                                                        << QPoint(0, 8));
+    QTest::newRow("concave polygon, top row") << concavePolygonalShutter << 0 << (SpanList() << qMakePair(0, 1) << qMakePair(6, 7));
+    QTest::newRow("concave polygon, middle row") << concavePolygonalShutter << 6 << (SpanList() << qMakePair(0, 10));
+}
+
+void test_DisplayShutterMask::getRowSpans_ShouldReturnExpectedSpans()
+{
+    QFETCH(DisplayShutter, shutter);
+    QFETCH(int, row);
+    QFETCH(SpanList, expectedSpans);
+
+    DisplayShutterMask mask(shutter, 10, 10);
+
+    QCOMPARE(getRowSpans(mask, row), expectedSpans);
+}
+
+void test_DisplayShutterMask::isVisible_ShouldMatchPaintedPolygon_data()
+{
+    QTest::addColumn<DisplayShutter>("shutter");
+
+    DisplayShutter triangularShutter;
+    triangularShutter.setPoints(QVector<QPoint>() << QPoint(10, 5) << QPoint(90, 30) << QPoint(40, 95));
+    QTest::newRow("triangle") << triangularShutter;
+
+    DisplayShutter starShutter;
+    starShutter.setPoints(QVector<QPoint>() << QPoint(50, 2) << QPoint(62, 38) << QPoint(98, 38) << QPoint(69, 60) << QPoint(80, 96)
+                                            << QPoint(50, 74) << QPoint(20, 96) << QPoint(31, 60) << QPoint(2, 38) << QPoint(38, 38));
+    QTest::newRow("star") << starShutter;
+}
+
+void test_DisplayShutterMask::isVisible_ShouldMatchPaintedPolygon()
+{
+    QFETCH(DisplayShutter, shutter);
+
+    const int Size = 100;
+    DisplayShutterMask mask(shutter, Size, Size);
+    QImage paintedShutter = shutter.getAsQImage(Size, Size);
+
+    // The rasterization rules of the outline are not exactly the same, so only pixels whose neighbours are painted the same are compared
+    for (int y = 1; y < Size - 1; ++y)
+    {
+        for (int x = 1; x < Size - 1; ++x)
+        {
+            bool paintedVisible = qGray(paintedShutter.pixel(x, y)) == 0;
+            bool nearOutline = false;
+            for (int j = -1; j <= 1 && !nearOutline; ++j)
+            {
+                for (int i = -1; i <= 1 && !nearOutline; ++i)
+                {
+                    nearOutline = (qGray(paintedShutter.pixel(x + i, y + j)) == 0) != paintedVisible;
+                }
+            }
+
+            if (!nearOutline && mask.isVisible(x, y) != paintedVisible)
+            {
+                QFAIL(qPrintable(QString("Pixel (%1, %2) is different").arg(x).arg(y)));
+            }
+        }
+    }
+}
+
+void test_DisplayShutterMask::fill_ShouldFillExpectedValues()
+{
+    DisplayShutter shutter;
+    shutter.setPoints(QPoint(1, 1), QPoint(2, 3));
+    DisplayShutterMask mask(shutter, 4, 5);
+
+    unsigned char expectedBuffer[20] = { 7, 7, 7, 7,
+                                         7, 0, 0, 7,
+                                         7, 0, 0, 7,
+                                         7, 0, 0, 7,
+                                         7, 7, 7, 7 };
+    unsigned char buffer[20];
+    mask.fill(buffer, 7);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        QCOMPARE(buffer[i], expectedBuffer[i]);
+    }
+
+    QCOMPARE(mask.getNumberOfVisiblePixels(), 6);
+}
+
+void test_DisplayShutterMask::constructor_Benchmark_data()
+{
+    QTest::addColumn<DisplayShutter>("shutter");
+    QTest::addColumn<bool>("painted");
+
+    // Size of a mammography
+    DisplayShutter circularShutter;
+    circularShutter.setPoints(QPoint(2000, 2500), 1900);
+    QTest::newRow("circle, spans") << circularShutter << false;
+    QTest::newRow("circle, painted") << circularShutter << true;
+
+    DisplayShutter polygonalShutter;
+    polygonalShutter.setPoints(QVector<QPoint>() << QPoint(100, 300) << QPoint(3800, 100) << QPoint(3900, 4700) << QPoint(200, 4900));
+    QTest::newRow("polygon, spans") << polygonalShutter << false;
+    QTest::newRow("polygon, painted") << polygonalShutter << true;
+}
+
+void test_DisplayShutterMask::constructor_Benchmark()
+{
+    SKIP_BENCHMARK_UNLESS_ENABLED();
+
+    QFETCH(DisplayShutter, shutter);
+    QFETCH(bool, painted);
+
+    const int Width = 4000;
+    const int Height = 5000;
+    QVector<unsigned char> buffer(Width * Height);
+
+    // Mask computation as done before and after the spans rasterization
+    if (painted)
+    {
+        QBENCHMARK
+        {
+            QImage shutterImage = shutter.getAsQImage(Width, Height);
+            for (int i = 0; i < Height; ++i)
+            {
+                QRgb *currentPixel = reinterpret_cast<QRgb*>(shutterImage.scanLine(i));
+                for (int j = 0; j < Width; ++j)
+                {
+                    buffer[j + i * Width] = qGray(*currentPixel);
+                    ++currentPixel;
+                }
+            }
+        }
+    }
+    else
+    {
+        QBENCHMARK
+        {
+            DisplayShutterMask mask(shutter, Width, Height);
+            mask.fill(buffer.data());
+        }
+    }
+}
+
+SpanList test_DisplayShutterMask::getRowSpans(const DisplayShutterMask &mask, int row)
+{
+    SpanList spanList;
+    int numberOfSpans;
+    const DisplayShutterMask::Span *spans = mask.getRowSpans(row, numberOfSpans);
+    for (int i = 0; i < numberOfSpans; ++i)
+    {
+        spanList << qMakePair(spans[i].begin, spans[i].end);
+    }
+
+    return spanList;
+}
+
+DECLARE_TEST(test_DisplayShutterMask)
+
+#include "test_displayshuttermask.moc"
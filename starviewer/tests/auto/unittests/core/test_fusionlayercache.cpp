@@ -0,0 +1,258 @@
+#include "autotest.h"
+#include "fusionlayercache.h"
+
+#include "image.h"
+#include "imageorientation.h"
+#include "q2dviewer.h"
+#include "volume.h"
+#include "volumepixeldata.h"
+#include "volumetesthelper.h"
+#include "voxel.h"
+
+#include <QSignalSpy>
+#include <QThreadPool>
+
+#include <vtkImageData.h>
+
+using namespace udg;
+using namespace testing;
+
+Q_DECLARE_METATYPE(QVector<int>)
+
+class test_FusionLayerCache : public QObject {
+Q_OBJECT
+
+private slots:
+    void setVolumes_ShouldResampleSecondaryVolumeOntoPrimarySlices_data();
+    void setVolumes_ShouldResampleSecondaryVolumeOntoPrimarySlices();
+
+    void setVolumes_ShouldNotResampleUnsupportedVolumes_data();
+    void setVolumes_ShouldNotResampleUnsupportedVolumes();
+
+    void setVolumes_ShouldClearLayerWithNullVolumes();
+
+    void q2dviewer_ShouldReadSecondaryValuesFromAcquiredSlice();
+
+    void q2dviewerSetSlice_Benchmark_data();
+    void q2dviewerSetSlice_Benchmark();
+
+private:
+    /// Returns an axial volume with the given number of slices, where slice i is at z = firstPosition + i * sliceSpacing and all its pixels are 10 * i
+    static Volume* createVolume(int numberOfSlices, double firstPosition, double sliceSpacing, int size = 4);
+};
+
+void test_FusionLayerCache::setVolumes_ShouldResampleSecondaryVolumeOntoPrimarySlices_data()
+{
+    QTest::addColumn<double>("primaryFirstPosition");
+    QTest::addColumn<double>("primarySliceSpacing");
+    QTest::addColumn<int>("numberOfPrimarySlices");
+    QTest::addColumn<double>("secondaryFirstPosition");
+    QTest::addColumn<double>("secondarySliceSpacing");
+    QTest::addColumn<QVector<int> >("expectedValues");
+    QTest::addColumn<QVector<int> >("expectedNearestSlices");
+
+    QTest::newRow("interpolated slices") << 0.0 << 1.0 << 5 << 0.0 << 2.0 << (QVector<int>() << 0 << 5 << 10 << 15 << 20)
+                                         << (QVector<int>() << 0 << 1 << 1 << 2 << 2);
+    QTest::newRow("slices out of the secondary volume") << -4.0 << 2.0 << 7 << 0.0 << 2.0 << (QVector<int>() << 0 << 0 << 0 << 10 << 20 << 20 << 20)
+                                                        << (QVector<int>() << -1 << 0 << 0 << 1 << 2 << 2 << -1);
+    QTest::newRow("descending secondary volume") << 0.0 << 1.0 << 5 << 4.0 << -2.0 << (QVector<int>() << 20 << 15 << 10 << 5 << 0)
+                                                 << (QVector<int>() << 2 << 1 << 1 << 0 << 0);
+}
+
+void test_FusionLayerCache::setVolumes_ShouldResampleSecondaryVolumeOntoPrimarySlices()
+{
+    QFETCH(double, primaryFirstPosition);
+    QFETCH(double, primarySliceSpacing);
+    QFETCH(int, numberOfPrimarySlices);
+    QFETCH(double, secondaryFirstPosition);
+    QFETCH(double, secondarySliceSpacing);
+    QFETCH(QVector<int>, expectedValues);
+    QFETCH(QVector<int>, expectedNearestSlices);
+
+    Volume *primaryVolume = createVolume(numberOfPrimarySlices, primaryFirstPosition, primarySliceSpacing);
+    Volume *secondaryVolume = createVolume(3, secondaryFirstPosition, secondarySliceSpacing);
+
+    FusionLayerCache cache;
+    QSignalSpy spy(&cache, SIGNAL(layerReady()));
+    cache.setVolumes(primaryVolume, secondaryVolume);
+
+    QTRY_COMPARE(spy.count(), 1);
+    QVERIFY(cache.isReady());
+
+    vtkImageData *layer = cache.getLayer();
+    QCOMPARE(layer->GetDimensions()[0], 4);
+    QCOMPARE(layer->GetDimensions()[1], 4);
+    QCOMPARE(layer->GetDimensions()[2], numberOfPrimarySlices);
+    QCOMPARE(layer->GetOrigin()[2], primaryVolume->getOrigin()[2]);
+    QCOMPARE(layer->GetSpacing()[2], primaryVolume->getSpacing()[2]);
+    QCOMPARE(layer->GetScalarType(), VTK_UNSIGNED_CHAR);
+
+    for (int i = 0; i < numberOfPrimarySlices; i++)
+    {
+        QCOMPARE(static_cast<int>(*static_cast<unsigned char*>(layer->GetScalarPointer(1, 2, i))), expectedValues.at(i));
+        QCOMPARE(cache.getNearestSlice(i), expectedNearestSlices.at(i));
+    }
+
+    QCOMPARE(cache.getNearestSlice(-1), -1);
+    QCOMPARE(cache.getNearestSlice(numberOfPrimarySlices), -1);
+
+    VolumeTestHelper::cleanUp(primaryVolume);
+    VolumeTestHelper::cleanUp(secondaryVolume);
+}
+
+void test_FusionLayerCache::setVolumes_ShouldNotResampleUnsupportedVolumes_data()
+{
+    QTest::addColumn<bool>("differentOrientation");
+    QTest::addColumn<bool>("repeatedPositions");
+    QTest::addColumn<qint64>("maximumLayerSize");
+
+    QTest::newRow("different orientation") << true << false << qint64(1024);
+    QTest::newRow("repeated slice positions") << false << true << qint64(1024);
+    // The layer has 5 slices of 4x4 voxels
+    QTest::newRow("layer bigger than the maximum") << false << false << qint64(4 * 4 * 5 - 1);
+}
+
+void test_FusionLayerCache::setVolumes_ShouldNotResampleUnsupportedVolumes()
+{
+    QFETCH(bool, differentOrientation);
+    QFETCH(bool, repeatedPositions);
+    QFETCH(qint64, maximumLayerSize);
+
+    Volume *primaryVolume = createVolume(5, 0.0, 1.0);
+    Volume *secondaryVolume = createVolume(3, 0.0, repeatedPositions ? 0.0 : 2.0);
+
+    if (differentOrientation)
+    {
+        foreach (Image *image, secondaryVolume->getImages())
+        {
+            image->setImageOrientationPatient(ImageOrientation(QVector3D(1.0, 0.0, 0.0), QVector3D(0.0, 0.0, -1.0)));
+        }
+    }
+
+    FusionLayerCache cache;
+    cache.setMaximumLayerSize(maximumLayerSize);
+    cache.setVolumes(primaryVolume, secondaryVolume);
+    cache.waitForResampling();
+
+    QVERIFY(!cache.isReady());
+    QVERIFY(!cache.getLayer());
+    QCOMPARE(cache.getNearestSlice(0), -1);
+
+    VolumeTestHelper::cleanUp(primaryVolume);
+    VolumeTestHelper::cleanUp(secondaryVolume);
+}
+
+void test_FusionLayerCache::setVolumes_ShouldClearLayerWithNullVolumes()
+{
+    Volume *primaryVolume = createVolume(5, 0.0, 1.0);
+    Volume *secondaryVolume = createVolume(3, 0.0, 2.0);
+
+    FusionLayerCache cache;
+    cache.setVolumes(primaryVolume, secondaryVolume);
+    cache.waitForResampling();
+    QVERIFY(cache.isReady());
+
+    cache.setVolumes(0, 0);
+    QVERIFY(!cache.isReady());
+    QVERIFY(!cache.getLayer());
+
+    VolumeTestHelper::cleanUp(primaryVolume);
+    VolumeTestHelper::cleanUp(secondaryVolume);
+}
+
+void test_FusionLayerCache::q2dviewer_ShouldReadSecondaryValuesFromAcquiredSlice()
+{
+    // Secondary slices at 0.5, 2.5 and 4.5 with values 0, 10 and 20
+    Volume *primaryVolume = createVolume(5, 0.0, 1.0);
+    Volume *secondaryVolume = createVolume(3, 0.5, 2.0);
+
+    {
+        Q2DViewer viewer;
+        viewer.setInputAsynchronously(QList<Volume*>() << primaryVolume << secondaryVolume);
+        viewer.setSlice(2);
+
+        // Let the layer be resampled and published, so that the interpolated value at 2.0 (7.5) is the one displayed
+        QThreadPool::globalInstance()->waitForDone();
+        QCoreApplication::processEvents();
+
+        // The probe and the ROIs read the nearest acquired slice, at 2.5, so that the interpolation doesn't change the measured values
+        QCOMPARE(viewer.getCurrentDisplayedImageDepthOnInput(1), 2.5);
+        double position[3] = { 1.0, 2.0, viewer.getCurrentDisplayedImageDepthOnInput(1) };
+        QCOMPARE(viewer.getCurrentPixelDataFromInput(1)->getVoxelValue(position).getComponent(0), 10.0);
+    }
+
+    VolumeTestHelper::cleanUp(primaryVolume);
+    VolumeTestHelper::cleanUp(secondaryVolume);
+}
+
+void test_FusionLayerCache::q2dviewerSetSlice_Benchmark_data()
+{
+    QTest::addColumn<bool>("useFusionLayer");
+
+    QTest::newRow("image stack with slice locator") << false;
+    QTest::newRow("image stack with fusion layer") << true;
+}
+
+void test_FusionLayerCache::q2dviewerSetSlice_Benchmark()
+{
+    SKIP_BENCHMARK_UNLESS_ENABLED();
+
+    QFETCH(bool, useFusionLayer);
+
+    // Whole body CT and PET. Each iteration displays and renders all the slices of the CT, so the slices/s are NumberOfPrimarySlices divided by the
+    // time of an iteration
+    const int NumberOfPrimarySlices = 300;
+    Volume *primaryVolume = createVolume(NumberOfPrimarySlices, 0.0, 3.0, 256);
+    Volume *secondaryVolume = createVolume(150, 1.5, 6.0, 128);
+
+    {
+        Q2DViewer viewer;
+        viewer.resize(512, 512);
+        viewer.setInputAsynchronously(QList<Volume*>() << primaryVolume << secondaryVolume);
+        viewer.setSlice(1);
+
+        // The layer is published through the event loop, which is only run in the fusion layer row, so in the other one the viewer keeps locating
+        // the nearest PET slice
+        QThreadPool::globalInstance()->waitForDone();
+        if (useFusionLayer)
+        {
+            QCoreApplication::processEvents();
+        }
+
+        QBENCHMARK
+        {
+            for (int i = 0; i < NumberOfPrimarySlices; i++)
+            {
+                viewer.setSlice(i);
+            }
+        }
+    }
+
+    VolumeTestHelper::cleanUp(primaryVolume);
+    VolumeTestHelper::cleanUp(secondaryVolume);
+}
+
+Volume* test_FusionLayerCache::createVolume(int numberOfSlices, double firstPosition, double sliceSpacing, int size)
+{
+    double origin[3] = { 0.0, 0.0, firstPosition };
+    double spacing[3] = { 1.0, 1.0, qMax(1.0, qAbs(sliceSpacing)) };
+    int extent[6] = { 0, size - 1, 0, size - 1, 0, numberOfSlices - 1 };
+    Volume *volume = VolumeTestHelper::createVolumeWithParameters(numberOfSlices, 1, numberOfSlices, origin, spacing, extent, true);
+
+    vtkImageData *data = volume->getVtkData();
+    for (int i = 0; i < numberOfSlices; i++)
+    {
+        memset(data->GetScalarPointer(0, 0, i), 10 * i, size * size);
+
+        double position[3] = { 0.0, 0.0, firstPosition + i * sliceSpacing };
+        Image *image = volume->getImage(i);
+        image->setImageOrientationPatient(ImageOrientation(QVector3D(1.0, 0.0, 0.0), QVector3D(0.0, 1.0, 0.0)));
+        image->setImagePositionPatient(position);
+    }
+
+    return volume;
+}
+
+DECLARE_TEST(test_FusionLayerCache)
+
+#include "test_fusionlayercache.moc"
@@ -63,6 +63,11 @@ void test_HangingProtocolImageSetRestrictionExpression::test_Series_ShouldReturn
     QTest::newRow("and/or precedence") << HangingProtocolImageSetRestrictionExpression("3 and 4 or 1", restrictions) << series << true;
 
     QTest::newRow("complex expression") << HangingProtocolImageSetRestrictionExpression("not (1 and (2 or not 3))", restrictions) << series << false;
+
+    QTest::newRow("double not") << HangingProtocolImageSetRestrictionExpression("not not 1", restrictions) << series << true;
+    QTest::newRow("undefined restriction") << HangingProtocolImageSetRestrictionExpression("2 and 5", restrictions) << series << true;
+    QTest::newRow("unbalanced parentheses") << HangingProtocolImageSetRestrictionExpression("(2 and 3", restrictions) << series << true;
+    QTest::newRow("missing operand") << HangingProtocolImageSetRestrictionExpression("2 and", restrictions) << series << true;
 }
 
 void test_HangingProtocolImageSetRestrictionExpression::test_Series_ShouldReturnExpectedValue()
@@ -5,9 +5,16 @@
 #include "fuzzycomparetesthelper.h"
 #include "series.h"
 #include "mathtools.h"
+#include "stringpool.h"
+
+#include <QSet>
 
 #include <vtkImageData.h>
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
 using namespace udg;
 using namespace testing;
 
@@ -43,6 +50,25 @@ private slots:
 
     void distance_ReturnsExpectedValues_data();
     void distance_ReturnsExpectedValues();
+
+    void getPath_ShouldReturnPathSet_data();
+    void getPath_ShouldReturnPathSet();
+    void getPath_ShouldNotCopyThePath();
+
+    void setters_ShouldNotDuplicateMetadataRepeatedAcrossImages();
+
+    void memoryPerImage_ShouldNotIncludeMetadataRepeatedAcrossLargeSeries();
+
+private:
+    /// Returns the heap memory used by the data of the given strings, counting only once the data shared by several of them
+    int getStringsHeapBytes(const QList<QString> &strings);
+
+    /// Creates the given number of images with the metadata of a synthetic CT series, as the fillers set it. If repeatedMetadataVaries is true, the
+    /// values that are usually the same in all the images of a series (image type, transfer syntax...) are different in each image
+    static QList<Image*> createSyntheticSeriesImages(int numberOfImages, bool repeatedMetadataVaries);
+
+    /// Returns the number of bytes currently allocated in the heap, or -1 if it can't be obtained in this platform
+    static qint64 getAllocatedHeapBytes();
 };
 
 Q_DECLARE_METATYPE(QList<DisplayShutter>)
@@ -444,6 +470,153 @@ void test_Image::distance_ReturnsExpectedValues()
     QVERIFY(FuzzyCompareTestHelper::fuzzyCompare(Image::distance(image), expectedDistance, 0.0001));
 }
 
+void test_Image::getPath_ShouldReturnPathSet_data()
+{
+    QTest::addColumn<QString>("path");
+
+    QTest::newRow("empty") << QString();
+    QTest::newRow("file name only") << QString("image.dcm");
+    QTest::newRow("unix path") << QString("/home/user/.starviewer/pacs/dicom/1.2.3/4.5.6/7.8.9");
+    QTest::newRow("windows path") << QString("C:\\Users\\user\\dicom\\IMG00001");
+    QTest::newRow("directory") << QString("/home/user/dicom/");
+}
+
+void test_Image::getPath_ShouldReturnPathSet()
+{
+    QFETCH(QString, path);
+
+    Image image;
+    image.setPath(path);
+
+    QCOMPARE(image.getPath(), path);
+}
+
+void test_Image::getPath_ShouldNotCopyThePath()
+{
+    Image image;
+    image.setPath("/home/user/.starviewer/pacs/dicom/1.2.3/4.5.6/7.8.9");
+
+    QCOMPARE(image.getPath().constData(), image.getPath().constData());
+}
+
+void test_Image::setters_ShouldNotDuplicateMetadataRepeatedAcrossImages()
+{
+    const int NumberOfImages = 1000;
+
+    QList<Image*> images;
+    QList<QString> repeatedMetadata;
+    for (int i = 0; i < NumberOfImages; ++i)
+    {
+        // Each value is built again for every image, as the fillers do when they read every file
+        Image *image = new Image();
+        image->setImageType(QString::fromLatin1("ORIGINAL\\PRIMARY\\AXIAL"));
+        image->setTransferSyntaxUID(QString::fromLatin1("1.2.840.10008.1.2.1"));
+        image->setViewPosition(QString::fromLatin1("CC"));
+        image->setViewCodeMeaning(QString::fromLatin1("cranio-caudal"));
+        images << image;
+
+        repeatedMetadata << image->getImageType() << image->getTransferSyntaxUID() << image->getViewPosition() << image->getViewCodeMeaning();
+    }
+
+    int bytesOfOneImage = getStringsHeapBytes(repeatedMetadata.mid(0, 4));
+    int bytesOfAllImages = getStringsHeapBytes(repeatedMetadata);
+
+    QVERIFY(bytesOfOneImage > 0);
+    QCOMPARE(bytesOfAllImages, bytesOfOneImage);
+
+    qDeleteAll(images);
+}
+
+void test_Image::memoryPerImage_ShouldNotIncludeMetadataRepeatedAcrossLargeSeries()
+{
+    const int NumberOfImages = 20000;
+
+    if (getAllocatedHeapBytes() < 0)
+    {
+        QSKIP("The allocated heap memory can't be obtained in this platform");
+    }
+
+    // Creates the values of the pool first, so that they aren't counted
+    qDeleteAll(createSyntheticSeriesImages(1, false));
+
+    qint64 heapBefore = getAllocatedHeapBytes();
+    QList<Image*> images = createSyntheticSeriesImages(NumberOfImages, false);
+    qint64 bytesPerImage = (getAllocatedHeapBytes() - heapBefore) / NumberOfImages;
+    qDeleteAll(images);
+
+    heapBefore = getAllocatedHeapBytes();
+    QList<Image*> imagesWithVaryingMetadata = createSyntheticSeriesImages(NumberOfImages, true);
+    qint64 bytesPerImageWithVaryingMetadata = (getAllocatedHeapBytes() - heapBefore) / NumberOfImages;
+
+    // What each image would hold if the values repeated across the series weren't shared
+    Image *image = imagesWithVaryingMetadata.last();
+    int repeatedMetadataBytes = getStringsHeapBytes(QList<QString>() << image->getImageType() << image->getTransferSyntaxUID()
+                                                                      << image->getViewPosition() << image->getViewCodeMeaning());
+    qDeleteAll(imagesWithVaryingMetadata);
+    StringPool::instance()->purge();
+
+    QString measures = QString("%1 bytes per image with the metadata of a series, %2 with different values in each image, %3 of repeated metadata")
+        .arg(bytesPerImage).arg(bytesPerImageWithVaryingMetadata).arg(repeatedMetadataBytes);
+    QVERIFY2(bytesPerImage >= static_cast<qint64>(sizeof(Image)), qPrintable(measures));
+    QVERIFY2(bytesPerImageWithVaryingMetadata - bytesPerImage >= repeatedMetadataBytes, qPrintable(measures));
+}
+
+QList<Image*> test_Image::createSyntheticSeriesImages(int numberOfImages, bool repeatedMetadataVaries)
+{
+    QList<Image*> images;
+    for (int i = 0; i < numberOfImages; ++i)
+    {
+        // The varying values have the same length as the repeated ones, so that both series hold strings of the same size
+        QString variation = repeatedMetadataVaries ? QString("%1").arg(i % 100000, 5, 10, QChar('0')) : QString("00000");
+
+        Image *image = new Image();
+        image->setSOPInstanceUID(QString("1.3.46.670589.33.1.63812345678901234567.%1").arg(i));
+        image->setInstanceNumber(QString::number(i + 1));
+        image->setPath(QString("/home/user/.starviewer/pacs/dicom/1.3.46.670589.33.1.1/1.3.46.670589.33.1.2/IMG%1").arg(i, 5, 10, QChar('0')));
+        image->setImageType(QString("ORIGINAL\\PRIMARY\\AXIAL\\") + variation);
+        image->setTransferSyntaxUID(QString("1.2.840.10008.1.2.1.") + variation);
+        image->setViewPosition(QString("CC") + variation);
+        image->setViewCodeMeaning(QString("cranio-caudal ") + variation);
+        image->setImageTime(QString("101010.%1").arg(i % 1000, 3, 10, QChar('0')));
+        image->setRows(512);
+        image->setColumns(512);
+        image->setPixelSpacing(0.7, 0.7);
+        image->setSliceThickness(1.0);
+        double position[3] = { -180.0, -180.0, i * 1.0 };
+        image->setImagePositionPatient(position);
+        image->setVoiLutList(QList<VoiLut>() << WindowLevel(400.0, 40.0));
+        images << image;
+    }
+
+    return images;
+}
+
+qint64 test_Image::getAllocatedHeapBytes()
+{
+#ifdef __GLIBC__
+    struct mallinfo info = mallinfo();
+    return static_cast<qint64>(static_cast<unsigned int>(info.uordblks));
+#else
+    return -1;
+#endif
+}
+
+int test_Image::getStringsHeapBytes(const QList<QString> &strings)
+{
+    QSet<const QChar*> countedData;
+    int bytes = 0;
+    foreach (const QString &string, strings)
+    {
+        if (!string.isEmpty() && !countedData.contains(string.constData()))
+        {
+            countedData.insert(string.constData());
+            bytes += sizeof(QString::Data) + (string.capacity() + 1) * sizeof(QChar);
+        }
+    }
+
+    return bytes;
+}
+
 DECLARE_TEST(test_Image)
 
 #include "test_image.moc"
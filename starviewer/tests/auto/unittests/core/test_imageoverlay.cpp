@@ -64,9 +64,15 @@ private slots:
     void mergeOverlays_ReturnsExpectedImageOverlay_data();
     void mergeOverlays_ReturnsExpectedImageOverlay();
 
+    void mergeOverlays_ShouldMatchPixelByPixelMerge_data();
+    void mergeOverlays_ShouldMatchPixelByPixelMerge();
+
     void getAsDrawerBitmap_ReturnsExpectedValues_data();
     void getAsDrawerBitmap_ReturnsExpectedValues();
 
+private:
+    static ImageOverlay createRandomOverlay(int columns, int rows, int xOrigin, int yOrigin);
+    static ImageOverlay mergeOverlaysPixelByPixel(const QList<ImageOverlay> &overlaysList);
 };
 
 Q_DECLARE_METATYPE(gdcm::Overlay)
@@ -534,6 +540,32 @@ void test_ImageOverlay::mergeOverlays_ReturnsExpectedImageOverlay()
     QCOMPARE(mergeOk, mergeWasSuccessful);
 }
 
+void test_ImageOverlay::mergeOverlays_ShouldMatchPixelByPixelMerge_data()
+{
+    QTest::addColumn<QList<ImageOverlay> >("overlaysList");
+
+    qsrand(1234);
+
+    QTest::newRow("2 overlays, widths not multiple of 8") << (QList<ImageOverlay>() << createRandomOverlay(13, 7, 1, 1)
+                                                                                   << createRandomOverlay(21, 5, 4, 3));
+    QTest::newRow("3 overlays, negative origins") << (QList<ImageOverlay>() << createRandomOverlay(64, 64, -10, 5)
+                                                                           << createRandomOverlay(33, 17, 20, -3)
+                                                                           << createRandomOverlay(1, 40, 7, 7));
+    QTest::newRow("overlay inside another one") << (QList<ImageOverlay>() << createRandomOverlay(100, 80, 1, 1)
+                                                                         << createRandomOverlay(9, 9, 50, 40));
+    QTest::newRow("valid and invalid overlays") << (QList<ImageOverlay>() << createRandomOverlay(17, 3, 2, 2) << ImageOverlay()
+                                                                         << createRandomOverlay(8, 16, 1, 9));
+}
+
+void test_ImageOverlay::mergeOverlays_ShouldMatchPixelByPixelMerge()
+{
+    QFETCH(QList<ImageOverlay>, overlaysList);
+
+    bool mergeOk;
+    QVERIFY(ImageOverlayTestHelper::areEqual(ImageOverlay::mergeOverlays(overlaysList, mergeOk), mergeOverlaysPixelByPixel(overlaysList)));
+    QVERIFY(mergeOk);
+}
+
 void test_ImageOverlay::getAsDrawerBitmap_ReturnsExpectedValues_data()
 {
     QTest::addColumn<ImageOverlay>("overlay");
@@ -597,6 +629,80 @@ void test_ImageOverlay::getAsDrawerBitmap_ReturnsExpectedValues()
     }
 }
 
+ImageOverlay test_ImageOverlay::createRandomOverlay(int columns, int rows, int xOrigin, int yOrigin)
+{
+    unsigned char *data = new unsigned char[columns * rows];
+    for (int i = 0; i < columns * rows; ++i)
+    {
+        data[i] = qrand() % 2 ? 255 : 0;
+    }
+
+    ImageOverlay overlay;
+    overlay.setColumns(columns);
+    overlay.setRows(rows);
+    overlay.setOrigin(xOrigin, yOrigin);
+    overlay.setData(data);
+
+    return overlay;
+}
+
+ImageOverlay test_ImageOverlay::mergeOverlaysPixelByPixel(const QList<ImageOverlay> &overlaysList)
+{
+    QList<ImageOverlay> validOverlaysList;
+    foreach (const ImageOverlay &overlay, overlaysList)
+    {
+        if (overlay.isValid())
+        {
+            validOverlaysList << overlay;
+        }
+    }
+
+    int outOriginX = 1;
+    int outOriginY = 1;
+    foreach (const ImageOverlay &overlay, validOverlaysList)
+    {
+        outOriginX = qMin(outOriginX, overlay.getXOrigin());
+        outOriginY = qMin(outOriginY, overlay.getYOrigin());
+    }
+
+    int outColumns = 0;
+    int outRows = 0;
+    foreach (const ImageOverlay &overlay, validOverlaysList)
+    {
+        outColumns = qMax(outColumns, overlay.getColumns() + overlay.getXOrigin() - outOriginX);
+        outRows = qMax(outRows, overlay.getRows() + overlay.getYOrigin() - outOriginY);
+    }
+
+    // Reference merge, ORing every output pixel with the corresponding pixel of each overlay
+    unsigned char *data = new unsigned char[outColumns * outRows];
+    for (int y = 0; y < outRows; ++y)
+    {
+        for (int x = 0; x < outColumns; ++x)
+        {
+            unsigned char value = 0;
+            foreach (const ImageOverlay &overlay, validOverlaysList)
+            {
+                int overlayX = outOriginX - overlay.getXOrigin() + x;
+                int overlayY = outOriginY - overlay.getYOrigin() + y;
+                if (overlayX >= 0 && overlayY >= 0 && overlayX < overlay.getColumns() && overlayY < overlay.getRows())
+                {
+                    value |= overlay.getData()[overlayX + overlayY * overlay.getColumns()];
+                }
+            }
+
+            data[x + y * outColumns] = value;
+        }
+    }
+
+    ImageOverlay mergedOverlay;
+    mergedOverlay.setColumns(outColumns);
+    mergedOverlay.setRows(outRows);
+    mergedOverlay.setOrigin(outOriginX, outOriginY);
+    mergedOverlay.setData(data);
+
+    return mergedOverlay;
+}
+
 DECLARE_TEST(test_ImageOverlay)
 
 #include "test_imageoverlay.moc"
@@ -0,0 +1,308 @@
+#include "autotest.h"
+#include "imageoverlaycache.h"
+
+#include "image.h"
+#include "imageoverlayreader.h"
+#include "imageoverlaytesthelper.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <gdcmWriter.h>
+
+using namespace udg;
+using namespace testing;
+
+class test_ImageOverlayCache : public QObject {
+Q_OBJECT
+
+private slots:
+    void getOverlays_ShouldReturnEmptyListForNullImage();
+
+    void getOverlays_ShouldReturnEmptyListAndNotCacheImagesWithoutOverlays();
+
+    void readSplitOverlays_ShouldReturnFalseWhenFileCannotBeRead();
+
+    void prefetch_ShouldNotCacheFilesThatCannotBeRead();
+
+    void clear_ShouldBeCallableWithoutPrefetch();
+
+    void readSplitOverlays_ShouldReturnSplitOverlaysOfTheFile();
+
+    void getOverlays_ShouldReturnTheSameOverlaysFromTheCache();
+
+    void prefetch_ShouldCacheOverlaysOfAllFiles();
+
+    void getOverlays_ShouldEvictLeastRecentlyUsedOverlaysWhenTheDefaultSizeIsExceeded();
+
+private:
+    /// Writes a 16x16 image with a separate overlay of the given size at (1, 1). If filled is true all the overlay pixels are set, otherwise they
+    /// have a diagonal pattern
+    static bool writeTestFile(const QString &filename, int rows, int columns, bool filled = false);
+    static void insertElement(gdcm::DataSet &dataSet, const gdcm::Tag &tag, gdcm::VR::VRType vr, const QByteArray &value);
+    static QByteArray toUS(quint16 value);
+
+    /// Returns true if both lists have the same overlays in the same order
+    static bool areEqual(const QList<ImageOverlay> &overlays1, const QList<ImageOverlay> &overlays2);
+};
+
+void test_ImageOverlayCache::getOverlays_ShouldReturnEmptyListForNullImage()
+{
+    ImageOverlayCache cache;
+
+    QVERIFY(cache.getOverlays(0).isEmpty());
+}
+
+void test_ImageOverlayCache::getOverlays_ShouldReturnEmptyListAndNotCacheImagesWithoutOverlays()
+{
+    Image image;
+    image.setPath("/nonexistent/path/image.dcm");
+    image.setNumberOfOverlays(0);
+
+    ImageOverlayCache cache;
+
+    QVERIFY(cache.getOverlays(&image).isEmpty());
+    QVERIFY(!cache.contains(image.getPath()));
+}
+
+void test_ImageOverlayCache::readSplitOverlays_ShouldReturnFalseWhenFileCannotBeRead()
+{
+    QList<ImageOverlay> splitOverlays;
+
+    QVERIFY(!ImageOverlayCache::readSplitOverlays("/nonexistent/path/image.dcm", splitOverlays));
+    QVERIFY(splitOverlays.isEmpty());
+}
+
+void test_ImageOverlayCache::prefetch_ShouldNotCacheFilesThatCannotBeRead()
+{
+    QStringList paths;
+    paths << "/nonexistent/path/image1.dcm" << "/nonexistent/path/image2.dcm";
+
+    ImageOverlayCache cache;
+    cache.prefetch(paths);
+    // Waits for the prefetch to finish
+    cache.cancelPrefetch();
+
+    foreach (const QString &path, paths)
+    {
+        QVERIFY(!cache.contains(path));
+    }
+}
+
+void test_ImageOverlayCache::clear_ShouldBeCallableWithoutPrefetch()
+{
+    ImageOverlayCache cache;
+    cache.clear();
+
+    QVERIFY(!cache.contains("/nonexistent/path/image.dcm"));
+}
+
+void test_ImageOverlayCache::readSplitOverlays_ShouldReturnSplitOverlaysOfTheFile()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+    QString filename = temporaryDir.path() + "/overlays.dcm";
+    QVERIFY(writeTestFile(filename, 40, 30));
+
+    ImageOverlayReader reader;
+    reader.setFilename(filename);
+    QVERIFY(reader.read());
+    QCOMPARE(reader.getOverlays().count(), 1);
+
+    QList<ImageOverlay> splitOverlays;
+    QVERIFY(ImageOverlayCache::readSplitOverlays(filename, splitOverlays));
+
+    QVERIFY(!splitOverlays.isEmpty());
+    QVERIFY(areEqual(splitOverlays, reader.getOverlays().first().split()));
+}
+
+void test_ImageOverlayCache::getOverlays_ShouldReturnTheSameOverlaysFromTheCache()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+    QString filename = temporaryDir.path() + "/overlays.dcm";
+    QVERIFY(writeTestFile(filename, 40, 30));
+
+    QList<ImageOverlay> expectedOverlays;
+    QVERIFY(ImageOverlayCache::readSplitOverlays(filename, expectedOverlays));
+
+    Image image;
+    image.setPath(filename);
+    image.setNumberOfOverlays(1);
+
+    ImageOverlayCache cache;
+
+    QVERIFY(areEqual(cache.getOverlays(&image), expectedOverlays));
+    QVERIFY(cache.contains(filename));
+
+    // Once cached the file is not read again
+    QVERIFY(QFile::remove(filename));
+    QVERIFY(areEqual(cache.getOverlays(&image), expectedOverlays));
+}
+
+void test_ImageOverlayCache::prefetch_ShouldCacheOverlaysOfAllFiles()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+
+    QStringList paths;
+    for (int i = 0; i < 5; ++i)
+    {
+        QString filename = temporaryDir.path() + QString("/overlays%1.dcm").arg(i);
+        QVERIFY(writeTestFile(filename, 20 + i, 30));
+        paths << filename;
+    }
+
+    ImageOverlayCache cache;
+    cache.prefetch(paths);
+
+    foreach (const QString &path, paths)
+    {
+        QTRY_VERIFY(cache.contains(path));
+    }
+
+    // The prefetched overlays are returned without reading the files again
+    foreach (const QString &path, paths)
+    {
+        QList<ImageOverlay> expectedOverlays;
+        QVERIFY(ImageOverlayCache::readSplitOverlays(path, expectedOverlays));
+        QVERIFY(QFile::remove(path));
+
+        Image image;
+        image.setPath(path);
+        image.setNumberOfOverlays(1);
+        QVERIFY(areEqual(cache.getOverlays(&image), expectedOverlays));
+    }
+}
+
+void test_ImageOverlayCache::getOverlays_ShouldEvictLeastRecentlyUsedOverlaysWhenTheDefaultSizeIsExceeded()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+
+    // Each file has 16 MiB of overlay data once decoded, so only 8 of them fit in the 128 MiB of the cache
+    const int OverlaySize = 4096;
+    QString firstFilename = temporaryDir.path() + "/overlays0.dcm";
+    QVERIFY(writeTestFile(firstFilename, OverlaySize, OverlaySize, true));
+
+    QList<ImageOverlay> splitOverlays;
+    QVERIFY(ImageOverlayCache::readSplitOverlays(firstFilename, splitOverlays));
+    qint64 bytesPerFile = 0;
+    foreach (const ImageOverlay &overlay, splitOverlays)
+    {
+        bytesPerFile += static_cast<qint64>(overlay.getRows()) * overlay.getColumns();
+    }
+    QCOMPARE(bytesPerFile, static_cast<qint64>(OverlaySize) * OverlaySize);
+
+    const int NumberOfFiles = static_cast<int>(128 * 1024 * 1024 / bytesPerFile) + 1;
+    QStringList paths;
+    paths << firstFilename;
+    for (int i = 1; i < NumberOfFiles; ++i)
+    {
+        QString filename = temporaryDir.path() + QString("/overlays%1.dcm").arg(i);
+        QVERIFY(QFile::copy(firstFilename, filename));
+        paths << filename;
+    }
+
+    ImageOverlayCache cache;
+
+    foreach (const QString &path, paths)
+    {
+        Image image;
+        image.setPath(path);
+        image.setNumberOfOverlays(1);
+        QCOMPARE(cache.getOverlays(&image).count(), splitOverlays.count());
+    }
+
+    QVERIFY(!cache.contains(paths.first()));
+    for (int i = 1; i < NumberOfFiles; ++i)
+    {
+        QVERIFY(cache.contains(paths.at(i)));
+    }
+}
+
+bool test_ImageOverlayCache::writeTestFile(const QString &filename, int rows, int columns, bool filled)
+{
+    const int Size = 16;
+
+    gdcm::Writer writer;
+    writer.SetFileName(qPrintable(filename));
+    writer.GetFile().GetHeader().SetDataSetTransferSyntax(gdcm::TransferSyntax::ExplicitVRLittleEndian);
+    gdcm::DataSet &dataSet = writer.GetFile().GetDataSet();
+
+    insertElement(dataSet, gdcm::Tag(0x0008, 0x0016), gdcm::VR::UI, QByteArray("1.2.840.10008.5.1.4.1.1.7", 26));
+    insertElement(dataSet, gdcm::Tag(0x0008, 0x0018), gdcm::VR::UI, QByteArray("1.2.3.4.5.67"));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0002), gdcm::VR::US, toUS(1));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0004), gdcm::VR::CS, QByteArray("MONOCHROME2 "));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0010), gdcm::VR::US, toUS(Size));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0011), gdcm::VR::US, toUS(Size));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0100), gdcm::VR::US, toUS(16));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0101), gdcm::VR::US, toUS(12));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0102), gdcm::VR::US, toUS(11));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0103), gdcm::VR::US, toUS(0));
+
+    int numberOfPixels = rows * columns;
+    // Overlay Data is OW, so it must have an even length
+    QByteArray overlayData((numberOfPixels + 15) / 16 * 2, filled ? static_cast<char>(0xff) : 0);
+    if (!filled)
+    {
+        for (int pixel = 0; pixel < numberOfPixels; ++pixel)
+        {
+            if ((pixel % columns + pixel / columns) % 3 == 0)
+            {
+                overlayData[pixel / 8] = overlayData.at(pixel / 8) | (1 << (pixel % 8));
+            }
+        }
+    }
+
+    insertElement(dataSet, gdcm::Tag(0x6000, 0x0010), gdcm::VR::US, toUS(rows));
+    insertElement(dataSet, gdcm::Tag(0x6000, 0x0011), gdcm::VR::US, toUS(columns));
+    insertElement(dataSet, gdcm::Tag(0x6000, 0x0040), gdcm::VR::CS, QByteArray("G "));
+    insertElement(dataSet, gdcm::Tag(0x6000, 0x0050), gdcm::VR::SS, toUS(1) + toUS(1));
+    insertElement(dataSet, gdcm::Tag(0x6000, 0x0100), gdcm::VR::US, toUS(1));
+    insertElement(dataSet, gdcm::Tag(0x6000, 0x0102), gdcm::VR::US, toUS(0));
+    insertElement(dataSet, gdcm::Tag(0x6000, 0x3000), gdcm::VR::OW, overlayData);
+
+    insertElement(dataSet, gdcm::Tag(0x7fe0, 0x0010), gdcm::VR::OW, QByteArray(Size * Size * 2, 0));
+
+    return writer.Write();
+}
+
+void test_ImageOverlayCache::insertElement(gdcm::DataSet &dataSet, const gdcm::Tag &tag, gdcm::VR::VRType vr, const QByteArray &value)
+{
+    gdcm::DataElement dataElement(tag);
+    dataElement.SetVR(vr);
+    dataElement.SetByteValue(value.constData(), value.size());
+    dataSet.Insert(dataElement);
+}
+
+QByteArray test_ImageOverlayCache::toUS(quint16 value)
+{
+    // Little endian
+    QByteArray bytes(2, 0);
+    bytes[0] = static_cast<char>(value & 0xff);
+    bytes[1] = static_cast<char>(value >> 8);
+    return bytes;
+}
+
+bool test_ImageOverlayCache::areEqual(const QList<ImageOverlay> &overlays1, const QList<ImageOverlay> &overlays2)
+{
+    if (overlays1.count() != overlays2.count())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < overlays1.count(); ++i)
+    {
+        if (!ImageOverlayTestHelper::areEqual(overlays1.at(i), overlays2.at(i)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+DECLARE_TEST(test_ImageOverlayCache)
+
+#include "test_imageoverlaycache.moc"
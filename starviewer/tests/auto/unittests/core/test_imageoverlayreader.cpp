@@ -3,7 +3,12 @@
 
 #include "imageoverlaytesthelper.h"
 
+#include <QTemporaryDir>
+
 #include <gdcmImage.h>
+#include <gdcmImageReader.h>
+#include <gdcmOverlay.h>
+#include <gdcmWriter.h>
 
 using namespace udg;
 using namespace testing;
@@ -35,6 +40,15 @@ private slots:
 
     void getOverlays_ShouldReturnExpectedOverlays_data();
     void getOverlays_ShouldReturnExpectedOverlays();
+
+    void read_ShouldReadSameOverlaysAsImageReader_data();
+    void read_ShouldReadSameOverlaysAsImageReader();
+
+private:
+    /// Writes a 16x16 image with 16 bits allocated and 12 stored, with a separate overlay and, if overlayInPixelData is true, an overlay in bit 12
+    static bool writeTestFile(const QString &filename, bool overlayInPixelData);
+    static void insertElement(gdcm::DataSet &dataSet, const gdcm::Tag &tag, gdcm::VR::VRType vr, const QByteArray &value);
+    static QByteArray toUS(quint16 value);
 };
 
 void test_ImageOverlayReader::read_ShouldReturnExpectedValue_data()
@@ -138,6 +152,131 @@ void test_ImageOverlayReader::getOverlays_ShouldReturnExpectedOverlays()
     }
 }
 
+void test_ImageOverlayReader::read_ShouldReadSameOverlaysAsImageReader_data()
+{
+    QTest::addColumn<bool>("overlayInPixelData");
+    QTest::addColumn<int>("numberOfOverlays");
+
+    QTest::newRow("overlay data") << false << 1;
+    QTest::newRow("overlay data and overlay in pixel data") << true << 2;
+}
+
+void test_ImageOverlayReader::read_ShouldReadSameOverlaysAsImageReader()
+{
+    QFETCH(bool, overlayInPixelData);
+    QFETCH(int, numberOfOverlays);
+
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+    QString filename = temporaryDir.path() + "/overlays.dcm";
+    QVERIFY(writeTestFile(filename, overlayInPixelData));
+
+    // Overlays as obtained decoding the whole image
+    gdcm::ImageReader imageReader;
+    imageReader.SetFileName(qPrintable(filename));
+    QVERIFY(imageReader.Read());
+    const gdcm::Image &image = imageReader.GetImage();
+    QCOMPARE(static_cast<int>(image.GetNumberOfOverlays()), numberOfOverlays);
+
+    ImageOverlayReader overlayReader;
+    overlayReader.setFilename(filename);
+    QVERIFY(overlayReader.read());
+
+    QList<ImageOverlay> overlays = overlayReader.getOverlays();
+    QCOMPARE(overlays.count(), numberOfOverlays);
+
+    for (int i = 0; i < numberOfOverlays; ++i)
+    {
+        QVERIFY(overlays.at(i).isValid());
+        QVERIFY(ImageOverlayTestHelper::areEqual(overlays.at(i), ImageOverlay::fromGDCMOverlay(image.GetOverlay(i))));
+    }
+}
+
+bool test_ImageOverlayReader::writeTestFile(const QString &filename, bool overlayInPixelData)
+{
+    const int Size = 16;
+
+    gdcm::Writer writer;
+    writer.SetFileName(qPrintable(filename));
+    writer.GetFile().GetHeader().SetDataSetTransferSyntax(gdcm::TransferSyntax::ExplicitVRLittleEndian);
+    gdcm::DataSet &dataSet = writer.GetFile().GetDataSet();
+
+    insertElement(dataSet, gdcm::Tag(0x0008, 0x0016), gdcm::VR::UI, QByteArray("1.2.840.10008.5.1.4.1.1.7", 26));
+    insertElement(dataSet, gdcm::Tag(0x0008, 0x0018), gdcm::VR::UI, QByteArray("1.2.3.4.5.67"));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0002), gdcm::VR::US, toUS(1));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0004), gdcm::VR::CS, QByteArray("MONOCHROME2 "));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0010), gdcm::VR::US, toUS(Size));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0011), gdcm::VR::US, toUS(Size));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0100), gdcm::VR::US, toUS(16));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0101), gdcm::VR::US, toUS(12));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0102), gdcm::VR::US, toUS(11));
+    insertElement(dataSet, gdcm::Tag(0x0028, 0x0103), gdcm::VR::US, toUS(0));
+
+    // Separate overlay of 10x7 pixels at (3, 4) with a diagonal pattern
+    const int Columns = 10;
+    const int Rows = 7;
+    QByteArray overlayData((Columns * Rows + 7) / 8 + 1, 0);
+    for (int pixel = 0; pixel < Columns * Rows; ++pixel)
+    {
+        if ((pixel % Columns + pixel / Columns) % 3 == 0)
+        {
+            overlayData[pixel / 8] = overlayData.at(pixel / 8) | (1 << (pixel % 8));
+        }
+    }
+
+    QByteArray origin = toUS(4) + toUS(3);
+    insertElement(dataSet, gdcm::Tag(0x6000, 0x0010), gdcm::VR::US, toUS(Rows));
+    insertElement(dataSet, gdcm::Tag(0x6000, 0x0011), gdcm::VR::US, toUS(Columns));
+    insertElement(dataSet, gdcm::Tag(0x6000, 0x0040), gdcm::VR::CS, QByteArray("G "));
+    insertElement(dataSet, gdcm::Tag(0x6000, 0x0050), gdcm::VR::SS, origin);
+    insertElement(dataSet, gdcm::Tag(0x6000, 0x0100), gdcm::VR::US, toUS(1));
+    insertElement(dataSet, gdcm::Tag(0x6000, 0x0102), gdcm::VR::US, toUS(0));
+    insertElement(dataSet, gdcm::Tag(0x6000, 0x3000), gdcm::VR::OW, overlayData);
+
+    // Pixel values with bit 12 set in a checkerboard pattern when the overlay is in the pixel data
+    QByteArray pixelData;
+    for (int pixel = 0; pixel < Size * Size; ++pixel)
+    {
+        quint16 value = (pixel * 37) & 0x0fff;
+        if (overlayInPixelData && (pixel % Size / 4 + pixel / Size / 4) % 2 == 0)
+        {
+            value |= 1 << 12;
+        }
+        pixelData += toUS(value);
+    }
+
+    if (overlayInPixelData)
+    {
+        insertElement(dataSet, gdcm::Tag(0x6002, 0x0010), gdcm::VR::US, toUS(Size));
+        insertElement(dataSet, gdcm::Tag(0x6002, 0x0011), gdcm::VR::US, toUS(Size));
+        insertElement(dataSet, gdcm::Tag(0x6002, 0x0040), gdcm::VR::CS, QByteArray("G "));
+        insertElement(dataSet, gdcm::Tag(0x6002, 0x0050), gdcm::VR::SS, toUS(1) + toUS(1));
+        insertElement(dataSet, gdcm::Tag(0x6002, 0x0100), gdcm::VR::US, toUS(16));
+        insertElement(dataSet, gdcm::Tag(0x6002, 0x0102), gdcm::VR::US, toUS(12));
+    }
+
+    insertElement(dataSet, gdcm::Tag(0x7fe0, 0x0010), gdcm::VR::OW, pixelData);
+
+    return writer.Write();
+}
+
+void test_ImageOverlayReader::insertElement(gdcm::DataSet &dataSet, const gdcm::Tag &tag, gdcm::VR::VRType vr, const QByteArray &value)
+{
+    gdcm::DataElement dataElement(tag);
+    dataElement.SetVR(vr);
+    dataElement.SetByteValue(value.constData(), value.size());
+    dataSet.Insert(dataElement);
+}
+
+QByteArray test_ImageOverlayReader::toUS(quint16 value)
+{
+    // Little endian
+    QByteArray bytes(2, 0);
+    bytes[0] = static_cast<char>(value & 0xff);
+    bytes[1] = static_cast<char>(value >> 8);
+    return bytes;
+}
+
 DECLARE_TEST(test_ImageOverlayReader)
 
 #include "test_imageoverlayreader.moc"
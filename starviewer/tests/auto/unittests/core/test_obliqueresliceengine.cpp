@@ -0,0 +1,429 @@
+#include "autotest.h"
+#include "obliqueresliceengine.h"
+#include "mathtools.h"
+
+#include <QSignalSpy>
+
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkSmartPointer.h>
+
+#include <cmath>
+
+using namespace udg;
+
+// Type of the voxels of the volumes created by createVolume()
+typedef signed short VoxelType;
+
+Q_DECLARE_METATYPE(ObliqueResliceEngine::Interpolation)
+Q_DECLARE_METATYPE(ObliqueResliceEngine::Quality)
+Q_DECLARE_METATYPE(QVector<double>)
+Q_DECLARE_METATYPE(QVector<VoxelType>)
+
+class test_ObliqueResliceEngine : public QObject {
+
+    Q_OBJECT
+
+private slots:
+
+    void update_ShouldResliceExpectedValues_data();
+    void update_ShouldResliceExpectedValues();
+
+    void update_ShouldReplicateSamplesInPreview();
+
+    void requestPreview_ShouldPublishOnlyLastRequest();
+
+    void requestRefinement_ShouldReplacePreviewWithFullQuality();
+
+    void update_ShouldKeepUnsignedShortValuesOutOfSignedShortRange();
+
+    void update_ShouldNotRoundFloatValues();
+
+    void update_ShouldResliceAllComponents();
+
+    void update_Benchmark_data();
+    void update_Benchmark();
+
+private:
+    /// Returns a volume of the given size where each voxel has value x + 10 * y + 100 * z
+    static vtkSmartPointer<vtkImageData> createVolume(int size);
+    /// Returns a matrix with the given elements in row order
+    static vtkSmartPointer<vtkMatrix4x4> createMatrix(const QVector<double> &elements);
+    /// Returns the values of the output of the given engine
+    static QVector<VoxelType> getOutputValues(ObliqueResliceEngine &engine);
+    /// Returns all the components of the output of the given engine, ordered by voxel and then by component
+    static QVector<double> getOutputComponents(ObliqueResliceEngine &engine);
+    /// Returns the expected output of a volume created with createVolume() when the output pixel (i, j) is at the input index
+    /// (offsetX + i * stepXX + j * stepXY, offsetY + i * stepYX + j * stepYY, offsetZ + i * stepZX + j * stepZY)
+    static QVector<VoxelType> expectedValues(int dimensionX, int dimensionY, double offsetX, double stepXX, double stepXY, double offsetY, double stepYX,
+                                             double stepYY, double offsetZ, double stepZX, double stepZY);
+};
+
+vtkSmartPointer<vtkImageData> test_ObliqueResliceEngine::createVolume(int size)
+{
+    vtkSmartPointer<vtkImageData> volume = vtkSmartPointer<vtkImageData>::New();
+    volume->SetExtent(0, size - 1, 0, size - 1, 0, size - 1);
+    volume->AllocateScalars(VTK_SHORT, 1);
+
+    VoxelType *data = static_cast<VoxelType*>(volume->GetScalarPointer());
+    for (int z = 0; z < size; z++)
+    {
+        for (int y = 0; y < size; y++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                *data++ = static_cast<VoxelType>(x + 10 * y + 100 * z);
+            }
+        }
+    }
+
+    return volume;
+}
+
+vtkSmartPointer<vtkMatrix4x4> test_ObliqueResliceEngine::createMatrix(const QVector<double> &elements)
+{
+    vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    for (int i = 0; i < 16; i++)
+    {
+        matrix->SetElement(i / 4, i % 4, elements.at(i));
+    }
+
+    return matrix;
+}
+
+QVector<VoxelType> test_ObliqueResliceEngine::getOutputValues(ObliqueResliceEngine &engine)
+{
+    vtkImageData *output = engine.getOutput();
+    int dimensions[3];
+    output->GetDimensions(dimensions);
+
+    const VoxelType *data = static_cast<const VoxelType*>(output->GetScalarPointer());
+    QVector<VoxelType> values;
+    for (int i = 0; i < dimensions[0] * dimensions[1] * dimensions[2]; i++)
+    {
+        values << data[i];
+    }
+
+    return values;
+}
+
+QVector<double> test_ObliqueResliceEngine::getOutputComponents(ObliqueResliceEngine &engine)
+{
+    vtkImageData *output = engine.getOutput();
+    int extent[6];
+    output->GetExtent(extent);
+
+    QVector<double> components;
+    for (int z = extent[4]; z <= extent[5]; z++)
+    {
+        for (int y = extent[2]; y <= extent[3]; y++)
+        {
+            for (int x = extent[0]; x <= extent[1]; x++)
+            {
+                for (int component = 0; component < output->GetNumberOfScalarComponents(); component++)
+                {
+                    components << output->GetScalarComponentAsDouble(x, y, z, component);
+                }
+            }
+        }
+    }
+
+    return components;
+}
+
+QVector<VoxelType> test_ObliqueResliceEngine::expectedValues(int dimensionX, int dimensionY, double offsetX, double stepXX, double stepXY,
+                                                             double offsetY, double stepYX, double stepYY, double offsetZ, double stepZX, double stepZY)
+{
+    QVector<VoxelType> values;
+    for (int j = 0; j < dimensionY; j++)
+    {
+        for (int i = 0; i < dimensionX; i++)
+        {
+            double x = offsetX + i * stepXX + j * stepXY;
+            double y = offsetY + i * stepYX + j * stepYY;
+            double z = offsetZ + i * stepZX + j * stepZY;
+            values << static_cast<VoxelType>(std::floor(x + 10 * y + 100 * z + 0.5));
+        }
+    }
+
+    return values;
+}
+
+void test_ObliqueResliceEngine::update_ShouldResliceExpectedValues_data()
+{
+    QTest::addColumn<QVector<double> >("resliceAxes");
+    QTest::addColumn<int>("dimensionX");
+    QTest::addColumn<int>("dimensionY");
+    QTest::addColumn<ObliqueResliceEngine::Interpolation>("previewInterpolation");
+    QTest::addColumn<ObliqueResliceEngine::Quality>("quality");
+    QTest::addColumn<QVector<VoxelType> >("expectedValues");
+
+    QVector<double> identity;
+    identity << 1 << 0 << 0 << 0  <<  0 << 1 << 0 << 0  <<  0 << 0 << 1 << 0  <<  0 << 0 << 0 << 1;
+    QVector<VoxelType> axialValues = expectedValues(4, 4, 0, 1, 0, 0, 0, 1, 0, 0, 0);
+
+    QTest::newRow("axial, nearest") << identity << 4 << 4 << ObliqueResliceEngine::NearestNeighbor << ObliqueResliceEngine::PreviewQuality
+                                    << axialValues;
+    QTest::newRow("axial, linear") << identity << 4 << 4 << ObliqueResliceEngine::Linear << ObliqueResliceEngine::PreviewQuality << axialValues;
+    QTest::newRow("axial, cubic") << identity << 4 << 4 << ObliqueResliceEngine::Linear << ObliqueResliceEngine::FullQuality << axialValues;
+
+    // Output x -> input y, output y -> input z, at input x = 2
+    QVector<double> sagital;
+    sagital << 0 << 0 << 1 << 2  <<  1 << 0 << 0 << 0  <<  0 << 1 << 0 << 0  <<  0 << 0 << 0 << 1;
+    QVector<VoxelType> sagitalValues = expectedValues(4, 4, 2, 0, 0, 0, 1, 0, 0, 0, 1);
+
+    QTest::newRow("sagital, nearest") << sagital << 4 << 4 << ObliqueResliceEngine::NearestNeighbor << ObliqueResliceEngine::PreviewQuality
+                                      << sagitalValues;
+    QTest::newRow("sagital, cubic") << sagital << 4 << 4 << ObliqueResliceEngine::Linear << ObliqueResliceEngine::FullQuality << sagitalValues;
+
+    // Half a voxel displaced in x
+    QVector<double> displaced = identity;
+    displaced[3] = 0.5;
+    QTest::newRow("displaced, linear") << displaced << 3 << 4 << ObliqueResliceEngine::Linear << ObliqueResliceEngine::PreviewQuality
+                                       << expectedValues(3, 4, 0.5, 1, 0, 0, 0, 1, 0, 0, 0);
+
+    // Out of the volume
+    QVector<double> outside = identity;
+    outside[3] = -5.0;
+    QTest::newRow("outside, cubic") << outside << 4 << 4 << ObliqueResliceEngine::Linear << ObliqueResliceEngine::FullQuality
+                                    << QVector<VoxelType>(16, 0);
+}
+
+void test_ObliqueResliceEngine::update_ShouldResliceExpectedValues()
+{
+    QFETCH(QVector<double>, resliceAxes);
+    QFETCH(int, dimensionX);
+    QFETCH(int, dimensionY);
+    QFETCH(ObliqueResliceEngine::Interpolation, previewInterpolation);
+    QFETCH(ObliqueResliceEngine::Quality, quality);
+    QFETCH(QVector<VoxelType>, expectedValues);
+
+    ObliqueResliceEngine engine;
+    engine.setInput(createVolume(4));
+    engine.setResliceAxes(createMatrix(resliceAxes));
+    engine.setOutputSpacing(1.0, 1.0, 1.0);
+    engine.setOutputDimensions(dimensionX, dimensionY, 1);
+    engine.setPreviewInterpolation(previewInterpolation);
+    engine.setPreviewDecimation(1);
+
+    engine.update(quality);
+
+    QCOMPARE(getOutputValues(engine), expectedValues);
+}
+
+void test_ObliqueResliceEngine::update_ShouldReplicateSamplesInPreview()
+{
+    ObliqueResliceEngine engine;
+    engine.setInput(createVolume(5));
+    engine.setOutputDimensions(5, 5, 1);
+    engine.setPreviewInterpolation(ObliqueResliceEngine::NearestNeighbor);
+    engine.setPreviewDecimation(2);
+
+    engine.update(ObliqueResliceEngine::PreviewQuality);
+
+    QVector<VoxelType> expectedValues;
+    for (int y = 0; y < 5; y++)
+    {
+        for (int x = 0; x < 5; x++)
+        {
+            expectedValues << static_cast<VoxelType>(x - x % 2 + 10 * (y - y % 2));
+        }
+    }
+
+    QCOMPARE(getOutputValues(engine), expectedValues);
+}
+
+void test_ObliqueResliceEngine::requestPreview_ShouldPublishOnlyLastRequest()
+{
+    ObliqueResliceEngine engine;
+    engine.setInput(createVolume(4));
+    engine.setOutputDimensions(4, 4, 1);
+    engine.setPreviewDecimation(1);
+    QSignalSpy spy(&engine, SIGNAL(outputUpdated()));
+
+    QVector<double> axes;
+    axes << 1 << 0 << 0 << 0  <<  0 << 1 << 0 << 0  <<  0 << 0 << 1 << 0  <<  0 << 0 << 0 << 1;
+    for (int z = 0; z < 4; z++)
+    {
+        axes[11] = z;
+        engine.setResliceAxes(createMatrix(axes));
+        engine.requestPreview();
+    }
+
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(getOutputValues(engine), expectedValues(4, 4, 0, 1, 0, 0, 0, 1, 3, 0, 0));
+}
+
+void test_ObliqueResliceEngine::requestRefinement_ShouldReplacePreviewWithFullQuality()
+{
+    ObliqueResliceEngine engine;
+    engine.setInput(createVolume(4));
+    engine.setOutputDimensions(4, 4, 1);
+    engine.setPreviewInterpolation(ObliqueResliceEngine::NearestNeighbor);
+    engine.setPreviewDecimation(2);
+    QSignalSpy spy(&engine, SIGNAL(outputUpdated()));
+
+    engine.update(ObliqueResliceEngine::PreviewQuality);
+    QVERIFY(getOutputValues(engine) != expectedValues(4, 4, 0, 1, 0, 0, 0, 1, 0, 0, 0));
+
+    engine.requestRefinement();
+
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(getOutputValues(engine), expectedValues(4, 4, 0, 1, 0, 0, 0, 1, 0, 0, 0));
+
+    // Already refined
+    engine.requestRefinement();
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 1);
+}
+
+void test_ObliqueResliceEngine::update_ShouldKeepUnsignedShortValuesOutOfSignedShortRange()
+{
+    vtkSmartPointer<vtkImageData> volume = vtkSmartPointer<vtkImageData>::New();
+    volume->SetExtent(0, 3, 0, 3, 0, 0);
+    volume->AllocateScalars(VTK_UNSIGNED_SHORT, 1);
+
+    QVector<double> expectedValues;
+    unsigned short *data = static_cast<unsigned short*>(volume->GetScalarPointer());
+    for (int i = 0; i < 16; i++)
+    {
+        data[i] = static_cast<unsigned short>(40000 + 1000 * i);
+        expectedValues << data[i];
+    }
+
+    ObliqueResliceEngine engine;
+    engine.setInput(volume);
+    engine.setOutputDimensions(4, 4, 1);
+    engine.update(ObliqueResliceEngine::FullQuality);
+
+    QCOMPARE(engine.getOutput()->GetScalarType(), VTK_UNSIGNED_SHORT);
+    QCOMPARE(getOutputComponents(engine), expectedValues);
+}
+
+void test_ObliqueResliceEngine::update_ShouldNotRoundFloatValues()
+{
+    vtkSmartPointer<vtkImageData> volume = vtkSmartPointer<vtkImageData>::New();
+    volume->SetExtent(0, 3, 0, 0, 0, 0);
+    volume->AllocateScalars(VTK_FLOAT, 1);
+
+    float *data = static_cast<float*>(volume->GetScalarPointer());
+    for (int x = 0; x < 4; x++)
+    {
+        data[x] = 0.25f + 0.5f * x;
+    }
+
+    // Half a voxel displaced in x, so each output value is the mean of two neighbours
+    QVector<double> axes;
+    axes << 1 << 0 << 0 << 0.5  <<  0 << 1 << 0 << 0  <<  0 << 0 << 1 << 0  <<  0 << 0 << 0 << 1;
+
+    ObliqueResliceEngine engine;
+    engine.setInput(volume);
+    engine.setResliceAxes(createMatrix(axes));
+    engine.setOutputDimensions(3, 1, 1);
+    engine.setPreviewInterpolation(ObliqueResliceEngine::Linear);
+    engine.setPreviewDecimation(1);
+    engine.update(ObliqueResliceEngine::PreviewQuality);
+
+    QVector<double> expectedValues;
+    expectedValues << 0.5 << 1.0 << 1.5;
+
+    QCOMPARE(engine.getOutput()->GetScalarType(), VTK_FLOAT);
+    QCOMPARE(getOutputComponents(engine), expectedValues);
+}
+
+void test_ObliqueResliceEngine::update_ShouldResliceAllComponents()
+{
+    vtkSmartPointer<vtkImageData> volume = vtkSmartPointer<vtkImageData>::New();
+    volume->SetExtent(0, 3, 0, 3, 0, 3);
+    volume->AllocateScalars(VTK_UNSIGNED_CHAR, 3);
+
+    unsigned char *data = static_cast<unsigned char*>(volume->GetScalarPointer());
+    for (int z = 0; z < 4; z++)
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            for (int x = 0; x < 4; x++)
+            {
+                for (int component = 0; component < 3; component++)
+                {
+                    *data++ = static_cast<unsigned char>(x + 4 * y + 16 * z + 64 * component);
+                }
+            }
+        }
+    }
+
+    // Sagital plane at x = 2: output x -> input y, output y -> input z
+    QVector<double> axes;
+    axes << 0 << 0 << 1 << 2  <<  1 << 0 << 0 << 0  <<  0 << 1 << 0 << 0  <<  0 << 0 << 0 << 1;
+
+    ObliqueResliceEngine engine;
+    engine.setInput(volume);
+    engine.setResliceAxes(createMatrix(axes));
+    engine.setOutputDimensions(4, 4, 1);
+    engine.update(ObliqueResliceEngine::FullQuality);
+
+    QVector<double> expectedComponents;
+    for (int z = 0; z < 4; z++)
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            for (int component = 0; component < 3; component++)
+            {
+                expectedComponents << 2 + 4 * y + 16 * z + 64 * component;
+            }
+        }
+    }
+
+    QCOMPARE(engine.getOutput()->GetScalarType(), VTK_UNSIGNED_CHAR);
+    QCOMPARE(engine.getOutput()->GetNumberOfScalarComponents(), 3);
+    QCOMPARE(getOutputComponents(engine), expectedComponents);
+}
+
+void test_ObliqueResliceEngine::update_Benchmark_data()
+{
+    QTest::addColumn<ObliqueResliceEngine::Quality>("quality");
+    QTest::addColumn<ObliqueResliceEngine::Interpolation>("previewInterpolation");
+
+    QTest::newRow("nearest preview") << ObliqueResliceEngine::PreviewQuality << ObliqueResliceEngine::NearestNeighbor;
+    QTest::newRow("linear preview") << ObliqueResliceEngine::PreviewQuality << ObliqueResliceEngine::Linear;
+    QTest::newRow("full quality") << ObliqueResliceEngine::FullQuality << ObliqueResliceEngine::Linear;
+}
+
+void test_ObliqueResliceEngine::update_Benchmark()
+{
+    SKIP_BENCHMARK_UNLESS_ENABLED();
+
+    QFETCH(ObliqueResliceEngine::Quality, quality);
+    QFETCH(ObliqueResliceEngine::Interpolation, previewInterpolation);
+
+    const int Size = 256;
+    // Each iteration renders a full turn of the plane around the center of the volume in steps of 10 degrees, so the frames per second while rotating
+    // are NumberOfFrames / time per iteration
+    const int NumberOfFrames = 36;
+
+    ObliqueResliceEngine engine;
+    engine.setInput(createVolume(Size));
+    engine.setOutputDimensions(Size, Size, 1);
+    engine.setPreviewInterpolation(previewInterpolation);
+
+    QBENCHMARK
+    {
+        for (int frame = 0; frame < NumberOfFrames; frame++)
+        {
+            double angle = frame * 10.0 * MathTools::DegreesToRadiansAsDouble;
+            double center = Size / 2.0;
+            // Output x along (cos, sin, 0), output y along z, through the center of the volume
+            QVector<double> axes;
+            axes << std::cos(angle) << 0 << 0 << center - center * std::cos(angle)
+                 << std::sin(angle) << 0 << 0 << center - center * std::sin(angle)
+                 << 0 << 1 << 0 << 0
+                 << 0 << 0 << 0 << 1;
+            engine.setResliceAxes(createMatrix(axes));
+            engine.update(quality);
+        }
+    }
+}
+
+DECLARE_TEST(test_ObliqueResliceEngine)
+
+#include "test_obliqueresliceengine.moc"
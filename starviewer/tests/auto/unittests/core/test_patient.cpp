@@ -21,6 +21,8 @@ private slots:
 
     void getModalities_ShouldReturnExpectedValues_data();
     void getModalities_ShouldReturnExpectedValues();
+
+    void copyWithoutStudies_ShouldCopyAllPatientInformation();
 };
 
 Q_DECLARE_METATYPE(Patient::PatientsSimilarity)
@@ -237,6 +239,30 @@ void test_Patient::getModalities_ShouldReturnExpectedValues()
     QCOMPARE(patient->getModalities(), expectedModalities);
 }
 
+void test_Patient::copyWithoutStudies_ShouldCopyAllPatientInformation()
+{
+    Patient *patient = PatientTestHelper::create(2);
+    patient->setFullName("NAME^PATIENT");
+    patient->setID("ID");
+    patient->setDatabaseID(7);
+    patient->setBirthDate(2, 3, 1970);
+    patient->setSex("F");
+
+    Patient *copy = patient->copyWithoutStudies();
+
+    QVERIFY(copy != patient);
+    QCOMPARE(copy->getFullName(), patient->getFullName());
+    QCOMPARE(copy->getID(), patient->getID());
+    QCOMPARE(copy->getDatabaseID(), patient->getDatabaseID());
+    QCOMPARE(copy->getBirthDate(), patient->getBirthDate());
+    QCOMPARE(copy->getSex(), patient->getSex());
+    QCOMPARE(copy->getNumberOfStudies(), 0);
+    QCOMPARE(patient->getNumberOfStudies(), 2);
+
+    delete copy;
+    delete patient;
+}
+
 DECLARE_TEST(test_Patient)
 
 #include "test_patient.moc"
@@ -0,0 +1,281 @@
+#include "autotest.h"
+#include "queuedlogappender.h"
+
+#include <log4cxx/level.h>
+#include <log4cxx/logger.h>
+#include <log4cxx/helpers/transcoder.h>
+
+#include <QSemaphore>
+
+using namespace udg;
+
+namespace {
+
+/// Appender that keeps the messages of the events written to it and can make the writer wait on an event
+class RecordingAppender : public log4cxx::AppenderSkeleton {
+public:
+    DECLARE_LOG4CXX_OBJECT(RecordingAppender)
+    BEGIN_LOG4CXX_CAST_MAP()
+        LOG4CXX_CAST_ENTRY(RecordingAppender)
+        LOG4CXX_CAST_ENTRY_CHAIN(log4cxx::AppenderSkeleton)
+    END_LOG4CXX_CAST_MAP()
+
+    RecordingAppender()
+        : m_blockNextEvent(false)
+    {
+    }
+
+    virtual void close()
+    {
+        closed = true;
+    }
+
+    virtual bool requiresLayout() const
+    {
+        return false;
+    }
+
+    bool isClosed() const
+    {
+        return closed;
+    }
+
+    QStringList getMessages()
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_messages;
+    }
+
+    /// The next event written will not return until releaseBlockedEvent() is called
+    void blockNextEvent()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_blockNextEvent = true;
+    }
+
+    /// Waits until the blocked event is being written
+    bool waitForBlockedEvent()
+    {
+        return m_blocked.tryAcquire(1, 5000);
+    }
+
+    void releaseBlockedEvent()
+    {
+        m_released.release();
+    }
+
+protected:
+    virtual void append(const log4cxx::spi::LoggingEventPtr &event, log4cxx::helpers::Pool &pool)
+    {
+        Q_UNUSED(pool);
+
+        std::string message;
+        log4cxx::helpers::Transcoder::encode(event->getMessage(), message);
+
+        bool block;
+        {
+            QMutexLocker locker(&m_mutex);
+            m_messages << QString::fromUtf8(message.c_str());
+            block = m_blockNextEvent;
+            m_blockNextEvent = false;
+        }
+
+        if (block)
+        {
+            m_blocked.release();
+            m_released.acquire();
+        }
+    }
+
+private:
+    QMutex m_mutex;
+    QStringList m_messages;
+    bool m_blockNextEvent;
+    QSemaphore m_blocked;
+    QSemaphore m_released;
+};
+
+IMPLEMENT_LOG4CXX_OBJECT(RecordingAppender)
+
+}
+
+class test_QueuedLogAppender : public QObject {
+Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void append_ShouldWriteEventsInTheOrderTheyWereLogged_data();
+    void append_ShouldWriteEventsInTheOrderTheyWereLogged();
+
+    void append_ShouldWriteWarningsAndErrorsBeforeReturning_data();
+    void append_ShouldWriteWarningsAndErrorsBeforeReturning();
+
+    void append_ShouldDropDebugAndInfoEventsWhenQueueIsFull();
+
+    void shutdown_ShouldWriteQueuedEventsAndCloseAppenders();
+
+private:
+    /// Adds the recording appender to the loggers, as log.conf does with the appenders of info.release and errors.release, and installs the
+    /// queued appenders with the given capacity
+    void install(int capacity);
+
+    /// Logs the message with the given level to the errors logger for ERROR and FATAL and to the info logger for the others, as logging.h does
+    void log(const QString &level, const QString &message);
+
+private:
+    log4cxx::LoggerPtr m_infoLogger;
+    log4cxx::LoggerPtr m_errorsLogger;
+    RecordingAppender *m_recordingAppender;
+    log4cxx::AppenderPtr m_recordingAppenderPointer;
+};
+
+void test_QueuedLogAppender::init()
+{
+    m_infoLogger = log4cxx::Logger::getLogger("test_queuedlogappender.info");
+    m_errorsLogger = log4cxx::Logger::getLogger("test_queuedlogappender.errors");
+    m_infoLogger->setLevel(log4cxx::Level::getAll());
+    m_errorsLogger->setLevel(log4cxx::Level::getAll());
+    m_infoLogger->setAdditivity(false);
+    m_errorsLogger->setAdditivity(false);
+
+    m_recordingAppender = new RecordingAppender();
+    m_recordingAppenderPointer = m_recordingAppender;
+}
+
+void test_QueuedLogAppender::cleanup()
+{
+    QueuedLogAppender::shutdown();
+    m_infoLogger->removeAllAppenders();
+    m_errorsLogger->removeAllAppenders();
+    m_recordingAppenderPointer = 0;
+}
+
+void test_QueuedLogAppender::append_ShouldWriteEventsInTheOrderTheyWereLogged_data()
+{
+    QTest::addColumn<QStringList>("levels");
+
+    QTest::newRow("only info") << (QStringList() << "INFO" << "INFO" << "DEBUG" << "INFO");
+    QTest::newRow("info and warnings") << (QStringList() << "INFO" << "WARN" << "INFO" << "DEBUG" << "WARN" << "INFO");
+    QTest::newRow("info and errors") << (QStringList() << "INFO" << "INFO" << "ERROR" << "INFO" << "FATAL" << "DEBUG" << "INFO");
+    QTest::newRow("only errors") << (QStringList() << "ERROR" << "ERROR" << "FATAL");
+}
+
+void test_QueuedLogAppender::append_ShouldWriteEventsInTheOrderTheyWereLogged()
+{
+    QFETCH(QStringList, levels);
+
+    install(100);
+
+    QStringList expectedMessages;
+    for (int i = 0; i < levels.size(); ++i)
+    {
+        QString message = QString("%1 %2").arg(levels.at(i)).arg(i);
+        log(levels.at(i), message);
+        expectedMessages << message;
+    }
+
+    QueuedLogAppender::shutdown();
+
+    QCOMPARE(m_recordingAppender->getMessages(), expectedMessages);
+}
+
+void test_QueuedLogAppender::append_ShouldWriteWarningsAndErrorsBeforeReturning_data()
+{
+    QTest::addColumn<QString>("level");
+
+    QTest::newRow("warn") << "WARN";
+    QTest::newRow("error") << "ERROR";
+    QTest::newRow("fatal") << "FATAL";
+}
+
+void test_QueuedLogAppender::append_ShouldWriteWarningsAndErrorsBeforeReturning()
+{
+    QFETCH(QString, level);
+
+    install(100);
+
+    log("INFO", "info 1");
+    log("DEBUG", "debug");
+    log("INFO", "info 2");
+    log(level, "last");
+
+    // Written without waiting for the writer thread, including the events logged before
+    QCOMPARE(m_recordingAppender->getMessages(), QStringList() << "info 1" << "debug" << "info 2" << "last");
+    QCOMPARE(QueuedLogAppender::getNumberOfQueuedRecords(), 0);
+}
+
+void test_QueuedLogAppender::append_ShouldDropDebugAndInfoEventsWhenQueueIsFull()
+{
+    const int Capacity = 4;
+    const int NumberOfEventsToDrop = 3;
+
+    install(Capacity);
+    int droppedBefore = QueuedLogAppender::getNumberOfDroppedRecords();
+
+    // The writer thread waits while writing this event, so the following ones stay in the queue
+    m_recordingAppender->blockNextEvent();
+    log("INFO", "blocking");
+    QVERIFY(m_recordingAppender->waitForBlockedEvent());
+
+    QStringList expectedMessages;
+    expectedMessages << "blocking";
+    for (int i = 0; i < Capacity; ++i)
+    {
+        QString message = QString("queued %1").arg(i);
+        log("INFO", message);
+        expectedMessages << message;
+    }
+    for (int i = 0; i < NumberOfEventsToDrop; ++i)
+    {
+        log(i % 2 == 0 ? "DEBUG" : "INFO", QString("dropped %1").arg(i));
+    }
+
+    QCOMPARE(QueuedLogAppender::getNumberOfQueuedRecords(), Capacity);
+    QCOMPARE(QueuedLogAppender::getNumberOfDroppedRecords() - droppedBefore, NumberOfEventsToDrop);
+
+    m_recordingAppender->releaseBlockedEvent();
+    QueuedLogAppender::shutdown();
+
+    QCOMPARE(m_recordingAppender->getMessages(), expectedMessages);
+}
+
+void test_QueuedLogAppender::shutdown_ShouldWriteQueuedEventsAndCloseAppenders()
+{
+    const int NumberOfEvents = 1000;
+
+    install(NumberOfEvents);
+    int droppedBefore = QueuedLogAppender::getNumberOfDroppedRecords();
+
+    for (int i = 0; i < NumberOfEvents; ++i)
+    {
+        log("INFO", QString("info %1").arg(i));
+    }
+
+    QueuedLogAppender::shutdown();
+
+    QCOMPARE(m_recordingAppender->getMessages().size(), NumberOfEvents);
+    QCOMPARE(m_recordingAppender->getMessages().last(), QString("info %1").arg(NumberOfEvents - 1));
+    QCOMPARE(QueuedLogAppender::getNumberOfQueuedRecords(), 0);
+    QCOMPARE(QueuedLogAppender::getNumberOfDroppedRecords(), droppedBefore);
+    QVERIFY(m_recordingAppender->isClosed());
+}
+
+void test_QueuedLogAppender::install(int capacity)
+{
+    m_infoLogger->addAppender(m_recordingAppenderPointer);
+    m_errorsLogger->addAppender(m_recordingAppenderPointer);
+    QueuedLogAppender::install(capacity);
+}
+
+void test_QueuedLogAppender::log(const QString &level, const QString &message)
+{
+    log4cxx::LevelPtr logLevel = log4cxx::Level::toLevel(level.toStdString());
+    log4cxx::LoggerPtr logger = logLevel->isGreaterOrEqual(log4cxx::Level::getError()) ? m_errorsLogger : m_infoLogger;
+    logger->log(logLevel, message.toUtf8().constData(), LOG4CXX_LOCATION);
+}
+
+DECLARE_TEST(test_QueuedLogAppender)
+
+#include "test_queuedlogappender.moc"
@@ -0,0 +1,351 @@
+#include "autotest.h"
+#include "referencelinesengine.h"
+
+#include "imageplane.h"
+#include "mathtools.h"
+
+#include <QVector3D>
+
+#include <cmath>
+
+using namespace udg;
+
+Q_DECLARE_METATYPE(ImagePlane*)
+Q_DECLARE_METATYPE(QList<int>)
+Q_DECLARE_METATYPE(OrthogonalPlane)
+Q_DECLARE_METATYPE(ReferenceLinesEngine::ProjectionResult)
+
+class test_ReferenceLinesEngine : public QObject {
+Q_OBJECT
+
+private slots:
+    void projectIntersections_ShouldMatchImagePlaneIntersections_data();
+    void projectIntersections_ShouldMatchImagePlaneIntersections();
+
+    void projectIntersections_ShouldNotProjectPlanesOutOfAngleRange_data();
+    void projectIntersections_ShouldNotProjectPlanesOutOfAngleRange();
+
+    void projectIntersections_ShouldUseCurrentLocalizer();
+
+    void projectIntersections_Benchmark_data();
+    void projectIntersections_Benchmark();
+
+private:
+    /// Returns a plane with the given geometry
+    static ImagePlane* createPlane(const QVector3D &origin, const QVector3D &rowVector, const QVector3D &columnVector, int size = 256,
+                                   double spacing = 1.0, double thickness = 5.0);
+
+    /// Returns an axial localizer of 256 x 256 mm at z = 0
+    static ImagePlane* createLocalizer();
+
+    /// Returns a sagittal plane at the given x crossing the localizer
+    static ImagePlane* createSagittalPlane(double x);
+
+    /// Projects the reference plane as ReferenceLinesTool did before using ReferenceLinesEngine, with ImagePlane::getIntersections() and
+    /// ImagePlane::projectPoint(). Returns false if some bounds don't intersect
+    static bool projectWithImagePlanes(ImagePlane *referencePlane, ImagePlane *localizerPlane, const QList<int> &bounds, const OrthogonalPlane &view,
+                                       const double displayedImageOrigin[3], QVector<ReferenceLinesEngine::Line> &lines);
+
+    static void compareLines(const QVector<ReferenceLinesEngine::Line> &lines, const QVector<ReferenceLinesEngine::Line> &expectedLines);
+};
+
+void test_ReferenceLinesEngine::projectIntersections_ShouldMatchImagePlaneIntersections_data()
+{
+    QTest::addColumn<ImagePlane*>("referencePlane");
+    QTest::addColumn<QList<int> >("bounds");
+    QTest::addColumn<OrthogonalPlane>("view");
+    QTest::addColumn<ReferenceLinesEngine::ProjectionResult>("expectedResult");
+
+    QList<int> thickBounds;
+    thickBounds << ReferenceLinesEngine::UpperBounds << ReferenceLinesEngine::LowerBounds;
+    QList<int> centralBounds;
+    centralBounds << ReferenceLinesEngine::CentralBounds;
+
+    QTest::newRow("sagittal") << createSagittalPlane(100.0) << thickBounds << OrthogonalPlane(OrthogonalPlane::XYPlane)
+                              << ReferenceLinesEngine::AllBoundsIntersect;
+    QTest::newRow("sagittal, central bounds") << createSagittalPlane(100.0) << centralBounds << OrthogonalPlane(OrthogonalPlane::XYPlane)
+                                              << ReferenceLinesEngine::AllBoundsIntersect;
+    QTest::newRow("sagittal, YZ view") << createSagittalPlane(100.0) << thickBounds << OrthogonalPlane(OrthogonalPlane::YZPlane)
+                                       << ReferenceLinesEngine::AllBoundsIntersect;
+    QTest::newRow("coronal") << createPlane(QVector3D(-20.0, 80.0, 100.0), QVector3D(1.0, 0.0, 0.0), QVector3D(0.0, 0.0, -1.0))
+                             << thickBounds << OrthogonalPlane(OrthogonalPlane::XZPlane) << ReferenceLinesEngine::AllBoundsIntersect;
+
+    double angle = 30.0 * MathTools::DegreesToRadiansAsDouble;
+    QTest::newRow("oblique") << createPlane(QVector3D(60.0, 10.0, 120.0), QVector3D(std::sin(angle), std::cos(angle), 0.0), QVector3D(0.0, 0.0, -1.0),
+                                            300, 0.7, 3.0)
+                             << thickBounds << OrthogonalPlane(OrthogonalPlane::XYPlane) << ReferenceLinesEngine::AllBoundsIntersect;
+
+    QTest::newRow("tilted by 60 degrees") << createPlane(QVector3D(100.0, 0.0, 100.0), QVector3D(0.0, 1.0, 0.0),
+                                                         QVector3D(-std::sin(angle), 0.0, -std::cos(angle)))
+                                          << thickBounds << OrthogonalPlane(OrthogonalPlane::XYPlane) << ReferenceLinesEngine::AllBoundsIntersect;
+
+    // The bottom edge of the central bounds is 0.3 mm above the localizer, so only the lower bounds reach it
+    QTest::newRow("partially above the localizer") << createPlane(QVector3D(200.0, 0.0, 222.0), QVector3D(0.0, 1.0, 0.0),
+                                                                  QVector3D(-std::sin(angle), 0.0, -std::cos(angle)), 256, 1.0, 10.0)
+                                                   << thickBounds << OrthogonalPlane(OrthogonalPlane::XYPlane)
+                                                   << ReferenceLinesEngine::NotAllBoundsIntersect;
+    QTest::newRow("above the localizer") << createPlane(QVector3D(100.0, 0.0, 500.0), QVector3D(0.0, 1.0, 0.0), QVector3D(0.0, 0.0, -1.0))
+                                         << thickBounds << OrthogonalPlane(OrthogonalPlane::XYPlane) << ReferenceLinesEngine::NotAllBoundsIntersect;
+}
+
+void test_ReferenceLinesEngine::projectIntersections_ShouldMatchImagePlaneIntersections()
+{
+    QFETCH(ImagePlane*, referencePlane);
+    QFETCH(QList<int>, bounds);
+    QFETCH(OrthogonalPlane, view);
+    QFETCH(ReferenceLinesEngine::ProjectionResult, expectedResult);
+
+    ImagePlane *localizerPlane = createLocalizer();
+    double displayedImageOrigin[3] = { -10.0, 20.0, 3.0 };
+
+    QVector<ReferenceLinesEngine::Line> expectedLines;
+    bool allBoundsIntersect = projectWithImagePlanes(referencePlane, localizerPlane, bounds, view, displayedImageOrigin, expectedLines);
+    QCOMPARE(allBoundsIntersect, expectedResult == ReferenceLinesEngine::AllBoundsIntersect);
+
+    ReferenceLinesEngine engine;
+    engine.setLocalizer(*localizerPlane, view, displayedImageOrigin);
+
+    // The second time the last projection is reused
+    for (int i = 0; i < 2; i++)
+    {
+        QVector<ReferenceLinesEngine::Line> lines;
+        QVector<ReferenceLinesEngine::ProjectionResult> results = engine.projectIntersections(QList<ImagePlane*>() << referencePlane, bounds, lines);
+
+        QCOMPARE(results, QVector<ReferenceLinesEngine::ProjectionResult>() << expectedResult);
+        compareLines(lines, expectedLines);
+    }
+
+    delete localizerPlane;
+    delete referencePlane;
+}
+
+void test_ReferenceLinesEngine::projectIntersections_ShouldNotProjectPlanesOutOfAngleRange_data()
+{
+    QTest::addColumn<ImagePlane*>("referencePlane");
+
+    double angle = 30.0 * MathTools::DegreesToRadiansAsDouble;
+    QTest::newRow("same plane") << createLocalizer();
+    QTest::newRow("parallel plane") << createPlane(QVector3D(0.0, 0.0, 10.0), QVector3D(1.0, 0.0, 0.0), QVector3D(0.0, 1.0, 0.0));
+    QTest::newRow("tilted by 30 degrees") << createPlane(QVector3D(0.0, 0.0, 10.0), QVector3D(1.0, 0.0, 0.0),
+                                                         QVector3D(0.0, std::cos(angle), std::sin(angle)));
+    QTest::newRow("tilted by 150 degrees") << createPlane(QVector3D(0.0, 0.0, 10.0), QVector3D(1.0, 0.0, 0.0),
+                                                          QVector3D(0.0, -std::cos(angle), std::sin(angle)));
+}
+
+void test_ReferenceLinesEngine::projectIntersections_ShouldNotProjectPlanesOutOfAngleRange()
+{
+    QFETCH(ImagePlane*, referencePlane);
+
+    ImagePlane *localizerPlane = createLocalizer();
+    double displayedImageOrigin[3] = { 0.0, 0.0, 0.0 };
+    ReferenceLinesEngine engine;
+    engine.setLocalizer(*localizerPlane, OrthogonalPlane::XYPlane, displayedImageOrigin);
+
+    // The lines of the planes that aren't projected keep their values
+    ReferenceLinesEngine::Line line = { { 1.0, 2.0, 3.0 }, { 4.0, 5.0, 6.0 } };
+    QVector<ReferenceLinesEngine::Line> lines;
+    lines << line << line;
+
+    QList<int> bounds;
+    bounds << ReferenceLinesEngine::UpperBounds << ReferenceLinesEngine::LowerBounds;
+    QVector<ReferenceLinesEngine::ProjectionResult> results = engine.projectIntersections(QList<ImagePlane*>() << referencePlane, bounds, lines);
+
+    QCOMPARE(results, QVector<ReferenceLinesEngine::ProjectionResult>() << ReferenceLinesEngine::NotProjected);
+    compareLines(lines, QVector<ReferenceLinesEngine::Line>() << line << line);
+
+    delete localizerPlane;
+    delete referencePlane;
+}
+
+void test_ReferenceLinesEngine::projectIntersections_ShouldUseCurrentLocalizer()
+{
+    QList<ImagePlane*> referencePlanes;
+    referencePlanes << createSagittalPlane(100.0) << createSagittalPlane(150.0);
+    QList<int> bounds;
+    bounds << ReferenceLinesEngine::UpperBounds << ReferenceLinesEngine::LowerBounds;
+    double displayedImageOrigin[3] = { 0.0, 0.0, 0.0 };
+
+    ReferenceLinesEngine engine;
+    QVector<ReferenceLinesEngine::Line> lines;
+
+    // Without localizer nothing is projected
+    QCOMPARE(engine.projectIntersections(referencePlanes, bounds, lines),
+             QVector<ReferenceLinesEngine::ProjectionResult>() << ReferenceLinesEngine::NotProjected << ReferenceLinesEngine::NotProjected);
+    QCOMPARE(lines.count(), 4);
+
+    ImagePlane *localizerPlane = createLocalizer();
+    for (int i = 0; i < 3; i++)
+    {
+        // The same reference planes on a localizer that moves
+        localizerPlane->setOrigin(0.0, 0.0, 40.0 * i);
+        engine.setLocalizer(*localizerPlane, OrthogonalPlane::XYPlane, displayedImageOrigin);
+
+        QVector<ReferenceLinesEngine::Line> expectedLines;
+        foreach (ImagePlane *referencePlane, referencePlanes)
+        {
+            QVector<ReferenceLinesEngine::Line> planeLines;
+            QVERIFY(projectWithImagePlanes(referencePlane, localizerPlane, bounds, OrthogonalPlane::XYPlane, displayedImageOrigin, planeLines));
+            expectedLines << planeLines;
+        }
+
+        QCOMPARE(engine.projectIntersections(referencePlanes, bounds, lines), QVector<ReferenceLinesEngine::ProjectionResult>()
+                 << ReferenceLinesEngine::AllBoundsIntersect << ReferenceLinesEngine::AllBoundsIntersect);
+        compareLines(lines, expectedLines);
+    }
+
+    engine.clearLocalizer();
+    QVERIFY(!engine.hasLocalizer());
+
+    delete localizerPlane;
+    qDeleteAll(referencePlanes);
+}
+
+void test_ReferenceLinesEngine::projectIntersections_Benchmark_data()
+{
+    QTest::addColumn<bool>("useEngine");
+
+    QTest::newRow("image planes") << false;
+    QTest::newRow("engine") << true;
+}
+
+void test_ReferenceLinesEngine::projectIntersections_Benchmark()
+{
+    SKIP_BENCHMARK_UNLESS_ENABLED();
+
+    QFETCH(bool, useEngine);
+
+    // Scrolling through a sagittal series of 200 slices with an axial localizer in another viewer, with the thickness lines
+    const int NumberOfSlices = 200;
+    QList<ImagePlane*> referencePlanes;
+    for (int i = 0; i < NumberOfSlices; i++)
+    {
+        referencePlanes << createSagittalPlane(28.0 + i);
+    }
+    ImagePlane *localizerPlane = createLocalizer();
+    double displayedImageOrigin[3] = { 0.0, 0.0, 0.0 };
+    QList<int> bounds;
+    bounds << ReferenceLinesEngine::UpperBounds << ReferenceLinesEngine::LowerBounds;
+    int numberOfProjectedPlanes = 0;
+
+    if (useEngine)
+    {
+        ReferenceLinesEngine engine;
+        engine.setLocalizer(*localizerPlane, OrthogonalPlane::XYPlane, displayedImageOrigin);
+        QVector<ReferenceLinesEngine::Line> lines;
+        QBENCHMARK
+        {
+            foreach (ImagePlane *referencePlane, referencePlanes)
+            {
+                QVector<ReferenceLinesEngine::ProjectionResult> results = engine.projectIntersections(QList<ImagePlane*>() << referencePlane, bounds,
+                                                                                                      lines);
+                numberOfProjectedPlanes += results.first() == ReferenceLinesEngine::AllBoundsIntersect;
+            }
+        }
+    }
+    else
+    {
+        QBENCHMARK
+        {
+            foreach (ImagePlane *referencePlane, referencePlanes)
+            {
+                // As the tool did, the localizer plane is created again for each reference plane
+                ImagePlane *currentLocalizerPlane = new ImagePlane(localizerPlane);
+                double angle = MathTools::angleInDegrees(currentLocalizerPlane->getImageOrientation().getNormalVector(),
+                                                         referencePlane->getImageOrientation().getNormalVector());
+                if (std::fabs(angle) >= 45.0 && std::fabs(angle) <= 135.0 && *currentLocalizerPlane != *referencePlane)
+                {
+                    QVector<ReferenceLinesEngine::Line> lines;
+                    numberOfProjectedPlanes += projectWithImagePlanes(referencePlane, currentLocalizerPlane, bounds, OrthogonalPlane::XYPlane,
+                                                                      displayedImageOrigin, lines);
+                }
+                delete currentLocalizerPlane;
+            }
+        }
+    }
+
+    QVERIFY(numberOfProjectedPlanes > 0);
+
+    delete localizerPlane;
+    qDeleteAll(referencePlanes);
+}
+
+ImagePlane* test_ReferenceLinesEngine::createPlane(const QVector3D &origin, const QVector3D &rowVector, const QVector3D &columnVector, int size,
+                                                   double spacing, double thickness)
+{
+    ImagePlane *plane = new ImagePlane();
+    plane->setImageOrientation(ImageOrientation(rowVector, columnVector));
+    plane->setSpacing(PixelSpacing2D(spacing, spacing));
+    plane->setRows(size);
+    plane->setColumns(size);
+    plane->setThickness(thickness);
+    plane->setOrigin(origin.x(), origin.y(), origin.z());
+
+    return plane;
+}
+
+ImagePlane* test_ReferenceLinesEngine::createLocalizer()
+{
+    return createPlane(QVector3D(0.0, 0.0, 0.0), QVector3D(1.0, 0.0, 0.0), QVector3D(0.0, 1.0, 0.0), 512, 0.5, 1.0);
+}
+
+ImagePlane* test_ReferenceLinesEngine::createSagittalPlane(double x)
+{
+    return createPlane(QVector3D(x, -10.0, 100.0), QVector3D(0.0, 1.0, 0.0), QVector3D(0.0, 0.0, -1.0));
+}
+
+bool test_ReferenceLinesEngine::projectWithImagePlanes(ImagePlane *referencePlane, ImagePlane *localizerPlane, const QList<int> &bounds,
+                                                       const OrthogonalPlane &view, const double displayedImageOrigin[3],
+                                                       QVector<ReferenceLinesEngine::Line> &lines)
+{
+    int xIndex, yIndex, zIndex;
+    view.getXYZIndexes(xIndex, yIndex, zIndex);
+
+    bool allBoundsIntersect = true;
+    lines.clear();
+    foreach (int boundsIndex, bounds)
+    {
+        ReferenceLinesEngine::Line line = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+        double firstIntersectionPoint[3], secondIntersectionPoint[3];
+        if (referencePlane->getIntersections(localizerPlane, firstIntersectionPoint, secondIntersectionPoint, boundsIndex) > 0)
+        {
+            // As Q2DViewer::projectDICOMPointToCurrentDisplayedImage(), which creates the plane of the current image for each point
+            double *points[2] = { firstIntersectionPoint, secondIntersectionPoint };
+            double *projectedPoints[2] = { line.firstPoint, line.secondPoint };
+            for (int i = 0; i < 2; i++)
+            {
+                ImagePlane currentPlane(localizerPlane);
+                double planeProjectedPoint[3];
+                currentPlane.projectPoint(points[i], planeProjectedPoint);
+                projectedPoints[i][xIndex] = planeProjectedPoint[0] + displayedImageOrigin[xIndex];
+                projectedPoints[i][yIndex] = planeProjectedPoint[1] + displayedImageOrigin[yIndex];
+                projectedPoints[i][zIndex] = planeProjectedPoint[2] + displayedImageOrigin[zIndex];
+            }
+        }
+        else
+        {
+            allBoundsIntersect = false;
+        }
+        lines << line;
+    }
+
+    return allBoundsIntersect;
+}
+
+void test_ReferenceLinesEngine::compareLines(const QVector<ReferenceLinesEngine::Line> &lines,
+                                             const QVector<ReferenceLinesEngine::Line> &expectedLines)
+{
+    QCOMPARE(lines.count(), expectedLines.count());
+
+    for (int i = 0; i < lines.count(); i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            QCOMPARE(lines.at(i).firstPoint[j], expectedLines.at(i).firstPoint[j]);
+            QCOMPARE(lines.at(i).secondPoint[j], expectedLines.at(i).secondPoint[j]);
+        }
+    }
+}
+
+DECLARE_TEST(test_ReferenceLinesEngine)
+
+#include "test_referencelinesengine.moc"
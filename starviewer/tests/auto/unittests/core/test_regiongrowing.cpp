@@ -0,0 +1,358 @@
+#include "autotest.h"
+#include "regiongrowing.h"
+
+#include <QVector>
+
+using namespace udg;
+
+class test_RegionGrowing : public QObject {
+
+    Q_OBJECT
+
+private slots:
+
+    void growFromSeed_ShouldFillConnectedVoxels_data();
+    void growFromSeed_ShouldFillConnectedVoxels();
+
+    void growFromSeed_ShouldNotFillAnythingWithInvalidParameters_data();
+    void growFromSeed_ShouldNotFillAnythingWithInvalidParameters();
+
+    void labelConnectedComponents_ShouldFindExpectedRegions_data();
+    void labelConnectedComponents_ShouldFindExpectedRegions();
+
+    void labelConnectedComponents_ShouldWriteLabels();
+
+    void labelConnectedComponents_ShouldJoinRegionsAcrossAllSlices();
+
+    void countVoxels_ShouldReturnNumberOfVoxelsInRange_data();
+    void countVoxels_ShouldReturnNumberOfVoxelsInRange();
+
+    void growFromSeed_Benchmark();
+    void labelConnectedComponents_Benchmark();
+
+private:
+    /// Returns a buffer of the given dimensions with value 1 in the given voxels and 0 in the rest
+    static QVector<RegionGrowing::VoxelType> createVolume(const int dimensions[3], const QList<QVector<int> > &foregroundVoxels);
+    /// Returns a buffer of size^3 voxels with a sphere of value 1 and radius size / 4 at the center and one of radius size / 8 at a corner
+    static QVector<RegionGrowing::VoxelType> createSpheresVolume(int size);
+    /// Returns a voxel index
+    static QVector<int> voxel(int x, int y, int z);
+};
+
+Q_DECLARE_METATYPE(RegionGrowing::Connectivity)
+Q_DECLARE_METATYPE(QVector<int>)
+Q_DECLARE_METATYPE(QList<QVector<int> >)
+Q_DECLARE_METATYPE(QVector<RegionGrowing::VoxelType>)
+
+QVector<int> test_RegionGrowing::voxel(int x, int y, int z)
+{
+    QVector<int> index(3);
+    index[0] = x;
+    index[1] = y;
+    index[2] = z;
+    return index;
+}
+
+QVector<RegionGrowing::VoxelType> test_RegionGrowing::createVolume(const int dimensions[3], const QList<QVector<int> > &foregroundVoxels)
+{
+    QVector<RegionGrowing::VoxelType> volume(dimensions[0] * dimensions[1] * dimensions[2], 0);
+
+    foreach (const QVector<int> &index, foregroundVoxels)
+    {
+        volume[(index[2] * dimensions[1] + index[1]) * dimensions[0] + index[0]] = 1;
+    }
+
+    return volume;
+}
+
+QVector<RegionGrowing::VoxelType> test_RegionGrowing::createSpheresVolume(int size)
+{
+    QVector<RegionGrowing::VoxelType> volume(size * size * size, 0);
+    RegionGrowing::VoxelType *data = volume.data();
+
+    int bigRadius = size / 4;
+    int smallRadius = size / 8;
+    int center = size / 2;
+
+    for (int z = 0; z < size; z++)
+    {
+        for (int y = 0; y < size; y++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                int bigDistance = (x - center) * (x - center) + (y - center) * (y - center) + (z - center) * (z - center);
+                int smallDistance = (x - smallRadius) * (x - smallRadius) + (y - smallRadius) * (y - smallRadius) + (z - smallRadius) * (z - smallRadius);
+
+                if (bigDistance <= bigRadius * bigRadius || smallDistance <= smallRadius * smallRadius)
+                {
+                    data[(static_cast<qint64>(z) * size + y) * size + x] = 1;
+                }
+            }
+        }
+    }
+
+    return volume;
+}
+
+void test_RegionGrowing::growFromSeed_ShouldFillConnectedVoxels_data()
+{
+    QTest::addColumn<QList<QVector<int> > >("foregroundVoxels");
+    QTest::addColumn<RegionGrowing::Connectivity>("connectivity");
+    QTest::addColumn<QVector<int> >("seed");
+    QTest::addColumn<qint64>("expectedNumberOfVoxels");
+    QTest::addColumn<QVector<int> >("expectedMinimumIndex");
+    QTest::addColumn<QVector<int> >("expectedMaximumIndex");
+
+    // U shape in a slice: the two arms are only joined by the bottom row
+    QList<QVector<int> > uShape;
+    uShape << voxel(0, 0, 0) << voxel(0, 1, 0) << voxel(0, 2, 0) << voxel(0, 3, 0) << voxel(1, 3, 0) << voxel(2, 3, 0) << voxel(3, 3, 0)
+           << voxel(3, 2, 0) << voxel(3, 1, 0) << voxel(3, 0, 0);
+    QTest::newRow("U shape") << uShape << RegionGrowing::FaceConnectivity << voxel(3, 0, 0) << qint64(10) << voxel(0, 0, 0) << voxel(3, 3, 0);
+
+    QList<QVector<int> > edgeNeighbours;
+    edgeNeighbours << voxel(1, 1, 1) << voxel(2, 2, 1) << voxel(2, 3, 2);
+    QTest::newRow("edge neighbours, 6") << edgeNeighbours << RegionGrowing::FaceConnectivity << voxel(1, 1, 1) << qint64(1) << voxel(1, 1, 1)
+                                        << voxel(1, 1, 1);
+    QTest::newRow("edge neighbours, 18") << edgeNeighbours << RegionGrowing::EdgeConnectivity << voxel(1, 1, 1) << qint64(3) << voxel(1, 1, 1)
+                                         << voxel(2, 3, 2);
+
+    QList<QVector<int> > vertexNeighbours;
+    vertexNeighbours << voxel(1, 1, 1) << voxel(2, 2, 2) << voxel(3, 3, 3);
+    QTest::newRow("vertex neighbours, 18") << vertexNeighbours << RegionGrowing::EdgeConnectivity << voxel(2, 2, 2) << qint64(1) << voxel(2, 2, 2)
+                                           << voxel(2, 2, 2);
+    QTest::newRow("vertex neighbours, 26") << vertexNeighbours << RegionGrowing::VertexConnectivity << voxel(2, 2, 2) << qint64(3) << voxel(1, 1, 1)
+                                           << voxel(3, 3, 3);
+}
+
+void test_RegionGrowing::growFromSeed_ShouldFillConnectedVoxels()
+{
+    QFETCH(QList<QVector<int> >, foregroundVoxels);
+    QFETCH(RegionGrowing::Connectivity, connectivity);
+    QFETCH(QVector<int>, seed);
+    QFETCH(qint64, expectedNumberOfVoxels);
+    QFETCH(QVector<int>, expectedMinimumIndex);
+    QFETCH(QVector<int>, expectedMaximumIndex);
+
+    int dimensions[3] = { 5, 5, 5 };
+    QVector<RegionGrowing::VoxelType> volume = createVolume(dimensions, foregroundVoxels);
+
+    RegionGrowing regionGrowing(volume.data(), dimensions);
+    regionGrowing.setConnectivity(connectivity);
+    regionGrowing.setValueRange(1, 1);
+    RegionGrowing::Region region = regionGrowing.growFromSeed(seed.constData(), 2);
+
+    QCOMPARE(region.numberOfVoxels, expectedNumberOfVoxels);
+    for (int i = 0; i < 3; i++)
+    {
+        QCOMPARE(region.minimumIndex[i], expectedMinimumIndex[i]);
+        QCOMPARE(region.maximumIndex[i], expectedMaximumIndex[i]);
+    }
+
+    QCOMPARE(static_cast<qint64>(volume.count(2)), expectedNumberOfVoxels);
+    QCOMPARE(volume.count(1), foregroundVoxels.count() - static_cast<int>(expectedNumberOfVoxels));
+}
+
+void test_RegionGrowing::growFromSeed_ShouldNotFillAnythingWithInvalidParameters_data()
+{
+    QTest::addColumn<QVector<int> >("seed");
+    QTest::addColumn<int>("fillValue");
+
+    QTest::newRow("seed out of the volume") << voxel(1, 5, 1) << 2;
+    QTest::newRow("background seed") << voxel(0, 0, 0) << 2;
+    QTest::newRow("fill value in range") << voxel(1, 1, 1) << 1;
+}
+
+void test_RegionGrowing::growFromSeed_ShouldNotFillAnythingWithInvalidParameters()
+{
+    QFETCH(QVector<int>, seed);
+    QFETCH(int, fillValue);
+
+    int dimensions[3] = { 5, 5, 5 };
+    QVector<RegionGrowing::VoxelType> volume = createVolume(dimensions, QList<QVector<int> >() << voxel(1, 1, 1) << voxel(1, 2, 1));
+    QVector<RegionGrowing::VoxelType> originalVolume = volume;
+
+    RegionGrowing regionGrowing(volume.data(), dimensions);
+    regionGrowing.setValueRange(1, 1);
+    RegionGrowing::Region region = regionGrowing.growFromSeed(seed.constData(), fillValue);
+
+    QCOMPARE(region.numberOfVoxels, qint64(0));
+    QCOMPARE(volume, originalVolume);
+}
+
+void test_RegionGrowing::labelConnectedComponents_ShouldFindExpectedRegions_data()
+{
+    QTest::addColumn<QList<QVector<int> > >("foregroundVoxels");
+    QTest::addColumn<RegionGrowing::Connectivity>("connectivity");
+    QTest::addColumn<QList<qint64> >("expectedNumberOfVoxels");
+
+    QTest::newRow("empty") << QList<QVector<int> >() << RegionGrowing::FaceConnectivity << QList<qint64>();
+
+    // The two arms of the U are found as different runs and joined later
+    QList<QVector<int> > uShape;
+    uShape << voxel(0, 0, 0) << voxel(0, 1, 0) << voxel(0, 2, 0) << voxel(1, 2, 0) << voxel(2, 2, 0) << voxel(2, 1, 0) << voxel(2, 0, 0)
+           << voxel(4, 4, 4);
+    QTest::newRow("U shape and a voxel") << uShape << RegionGrowing::FaceConnectivity << (QList<qint64>() << 7 << 1);
+
+    QList<QVector<int> > edgeNeighboursInSlice;
+    edgeNeighboursInSlice << voxel(0, 0, 0) << voxel(1, 1, 0);
+    QTest::newRow("edge neighbours in slice, 6") << edgeNeighboursInSlice << RegionGrowing::FaceConnectivity << (QList<qint64>() << 1 << 1);
+    QTest::newRow("edge neighbours in slice, 18") << edgeNeighboursInSlice << RegionGrowing::EdgeConnectivity << (QList<qint64>() << 2);
+
+    QList<QVector<int> > edgeNeighboursBetweenSlices;
+    edgeNeighboursBetweenSlices << voxel(2, 2, 0) << voxel(2, 3, 1) << voxel(3, 3, 2);
+    QTest::newRow("edge neighbours between slices, 6") << edgeNeighboursBetweenSlices << RegionGrowing::FaceConnectivity
+                                                       << (QList<qint64>() << 1 << 1 << 1);
+    QTest::newRow("edge neighbours between slices, 18") << edgeNeighboursBetweenSlices << RegionGrowing::EdgeConnectivity << (QList<qint64>() << 3);
+
+    QList<QVector<int> > vertexNeighbours;
+    vertexNeighbours << voxel(3, 3, 3) << voxel(2, 2, 2) << voxel(4, 2, 4);
+    QTest::newRow("vertex neighbours, 18") << vertexNeighbours << RegionGrowing::EdgeConnectivity << (QList<qint64>() << 1 << 1 << 1);
+    QTest::newRow("vertex neighbours, 26") << vertexNeighbours << RegionGrowing::VertexConnectivity << (QList<qint64>() << 3);
+}
+
+void test_RegionGrowing::labelConnectedComponents_ShouldFindExpectedRegions()
+{
+    QFETCH(QList<QVector<int> >, foregroundVoxels);
+    QFETCH(RegionGrowing::Connectivity, connectivity);
+    QFETCH(QList<qint64>, expectedNumberOfVoxels);
+
+    int dimensions[3] = { 5, 5, 5 };
+    QVector<RegionGrowing::VoxelType> volume = createVolume(dimensions, foregroundVoxels);
+
+    RegionGrowing regionGrowing(volume.data(), dimensions);
+    regionGrowing.setConnectivity(connectivity);
+    QList<RegionGrowing::Region> regions = regionGrowing.labelConnectedComponents();
+
+    QList<qint64> numberOfVoxels;
+    foreach (const RegionGrowing::Region &region, regions)
+    {
+        numberOfVoxels << region.numberOfVoxels;
+    }
+
+    QCOMPARE(numberOfVoxels, expectedNumberOfVoxels);
+}
+
+void test_RegionGrowing::labelConnectedComponents_ShouldWriteLabels()
+{
+    int dimensions[3] = { 4, 3, 2 };
+    QList<QVector<int> > foregroundVoxels;
+    foregroundVoxels << voxel(0, 0, 0) << voxel(1, 0, 0) << voxel(3, 2, 0) << voxel(3, 2, 1) << voxel(0, 2, 1);
+    QVector<RegionGrowing::VoxelType> volume = createVolume(dimensions, foregroundVoxels);
+
+    RegionGrowing regionGrowing(volume.data(), dimensions);
+    QVector<int> labels(volume.size(), -1);
+    QList<RegionGrowing::Region> regions = regionGrowing.labelConnectedComponents(labels.data());
+
+    QVector<int> expectedLabels(volume.size(), 0);
+    expectedLabels[0] = 1;
+    expectedLabels[1] = 1;
+    expectedLabels[11] = 2;
+    expectedLabels[23] = 2;
+    expectedLabels[20] = 3;
+
+    QCOMPARE(labels, expectedLabels);
+    QCOMPARE(regions.count(), 3);
+    QCOMPARE(regions[1].numberOfVoxels, qint64(2));
+    QCOMPARE(regions[1].minimumIndex[2], 0);
+    QCOMPARE(regions[1].maximumIndex[2], 1);
+    QCOMPARE(regions[1].minimumIndex[0], 3);
+    QCOMPARE(regions[1].maximumIndex[0], 3);
+}
+
+void test_RegionGrowing::labelConnectedComponents_ShouldJoinRegionsAcrossAllSlices()
+{
+    // A column that crosses the slabs processed by each thread and a second region at the last slice
+    int dimensions[3] = { 4, 4, 64 };
+    QList<QVector<int> > foregroundVoxels;
+    for (int z = 0; z < dimensions[2]; z++)
+    {
+        foregroundVoxels << voxel(z % 2, 1, z);
+    }
+    foregroundVoxels << voxel(3, 3, 63);
+    QVector<RegionGrowing::VoxelType> volume = createVolume(dimensions, foregroundVoxels);
+
+    RegionGrowing regionGrowing(volume.data(), dimensions);
+    regionGrowing.setConnectivity(RegionGrowing::EdgeConnectivity);
+    QList<RegionGrowing::Region> regions = regionGrowing.labelConnectedComponents();
+
+    QCOMPARE(regions.count(), 2);
+    QCOMPARE(regions[0].numberOfVoxels, qint64(64));
+    QCOMPARE(regions[0].minimumIndex[2], 0);
+    QCOMPARE(regions[0].maximumIndex[2], 63);
+    QCOMPARE(regions[1].numberOfVoxels, qint64(1));
+}
+
+void test_RegionGrowing::countVoxels_ShouldReturnNumberOfVoxelsInRange_data()
+{
+    QTest::addColumn<QVector<RegionGrowing::VoxelType> >("data");
+    QTest::addColumn<int>("lowerValue");
+    QTest::addColumn<int>("upperValue");
+    QTest::addColumn<qint64>("expectedCount");
+
+    QVector<RegionGrowing::VoxelType> data;
+    for (int i = -50; i < 50; i++)
+    {
+        data << i;
+    }
+
+    QTest::newRow("empty") << QVector<RegionGrowing::VoxelType>() << 0 << 10 << qint64(0);
+    QTest::newRow("single value") << data << 7 << 7 << qint64(1);
+    QTest::newRow("range") << data << -10 << 9 << qint64(20);
+    QTest::newRow("all") << data << -100 << 100 << qint64(100);
+    QTest::newRow("none") << data << 60 << 100 << qint64(0);
+}
+
+void test_RegionGrowing::countVoxels_ShouldReturnNumberOfVoxelsInRange()
+{
+    QFETCH(QVector<RegionGrowing::VoxelType>, data);
+    QFETCH(int, lowerValue);
+    QFETCH(int, upperValue);
+    QFETCH(qint64, expectedCount);
+
+    QCOMPARE(RegionGrowing::countVoxels(data.constData(), data.size(), lowerValue, upperValue), expectedCount);
+}
+
+void test_RegionGrowing::growFromSeed_Benchmark()
+{
+    SKIP_BENCHMARK_UNLESS_ENABLED();
+
+    int size = 512;
+    int dimensions[3] = { size, size, size };
+    QVector<RegionGrowing::VoxelType> volume = createSpheresVolume(size);
+    int seed[3] = { size / 2, size / 2, size / 2 };
+    qint64 numberOfVoxels = 0;
+
+    QBENCHMARK
+    {
+        // Fill alternating values so that each iteration fills the whole sphere
+        RegionGrowing regionGrowing(volume.data(), dimensions);
+        RegionGrowing::VoxelType currentValue = volume[(seed[2] * size + seed[1]) * size + seed[0]];
+        regionGrowing.setValueRange(currentValue, currentValue);
+        numberOfVoxels = regionGrowing.growFromSeed(seed, currentValue == 1 ? 2 : 1).numberOfVoxels;
+    }
+
+    QVERIFY(numberOfVoxels > 0);
+}
+
+void test_RegionGrowing::labelConnectedComponents_Benchmark()
+{
+    SKIP_BENCHMARK_UNLESS_ENABLED();
+
+    int size = 512;
+    int dimensions[3] = { size, size, size };
+    QVector<RegionGrowing::VoxelType> volume = createSpheresVolume(size);
+    QList<RegionGrowing::Region> regions;
+
+    QBENCHMARK
+    {
+        RegionGrowing regionGrowing(volume.data(), dimensions);
+        regionGrowing.setConnectivity(RegionGrowing::VertexConnectivity);
+        regions = regionGrowing.labelConnectedComponents();
+    }
+
+    QCOMPARE(regions.count(), 2);
+}
+
+DECLARE_TEST(test_RegionGrowing)
+
+#include "test_regiongrowing.moc"
@@ -0,0 +1,169 @@
+#include "autotest.h"
+#include "settingscache.h"
+#include "settings.h"
+#include "settingsregistry.h"
+
+#include <QSignalSpy>
+
+using namespace udg;
+
+class test_SettingsCache : public QObject {
+
+    Q_OBJECT
+
+private slots:
+
+    void cleanup();
+
+    void insert_ShouldCacheValue();
+
+    void insert_ShouldIgnoreValueReadBeforeInvalidation();
+
+    void invalidate_ShouldRemoveKeyAndSubkeys_data();
+    void invalidate_ShouldRemoveKeyAndSubkeys();
+
+    void invalidate_ShouldEmitSettingChanged();
+
+    void getValue_ShouldReturnNewDefaultValueAfterRegisteringIt();
+
+    void getValue_Benchmark_data();
+    void getValue_Benchmark();
+
+private:
+    /// Key registered only by these tests, that is never written
+    static const QString TestingKey;
+};
+
+const QString test_SettingsCache::TestingKey("Testing/SettingsCache/key");
+
+void test_SettingsCache::cleanup()
+{
+    SettingsCache::instance()->clear();
+}
+
+void test_SettingsCache::insert_ShouldCacheValue()
+{
+    SettingsCache *cache = SettingsCache::instance();
+    QVariant value;
+
+    QVERIFY(!cache->value("a", value));
+
+    cache->insert("a", 5, cache->getGeneration());
+
+    QVERIFY(cache->value("a", value));
+    QCOMPARE(value, QVariant(5));
+    QCOMPARE(cache->size(), 1);
+}
+
+void test_SettingsCache::insert_ShouldIgnoreValueReadBeforeInvalidation()
+{
+    SettingsCache *cache = SettingsCache::instance();
+    int generation = cache->getGeneration();
+
+    cache->invalidate("b");
+    cache->insert("a", 5, generation);
+
+    QVariant value;
+    QVERIFY(!cache->value("a", value));
+}
+
+void test_SettingsCache::invalidate_ShouldRemoveKeyAndSubkeys_data()
+{
+    QTest::addColumn<QStringList>("keys");
+    QTest::addColumn<QString>("invalidatedKey");
+    QTest::addColumn<QStringList>("expectedRemainingKeys");
+
+    QStringList keys;
+    keys << "group/key" << "group/key/columnWidth0" << "group/key/columnWidth1" << "group/keyName" << "other/key";
+
+    QTest::newRow("key and subkeys") << keys << "group/key" << (QStringList() << "group/keyName" << "other/key");
+    QTest::newRow("group") << keys << "group" << (QStringList() << "other/key");
+    QTest::newRow("subkey") << keys << "group/key/columnWidth1"
+                            << (QStringList() << "group/key" << "group/key/columnWidth0" << "group/keyName" << "other/key");
+    QTest::newRow("non cached key") << keys << "gro" << keys;
+}
+
+void test_SettingsCache::invalidate_ShouldRemoveKeyAndSubkeys()
+{
+    QFETCH(QStringList, keys);
+    QFETCH(QString, invalidatedKey);
+    QFETCH(QStringList, expectedRemainingKeys);
+
+    SettingsCache *cache = SettingsCache::instance();
+    foreach (const QString &key, keys)
+    {
+        cache->insert(key, key, cache->getGeneration());
+    }
+
+    cache->invalidate(invalidatedKey);
+
+    QCOMPARE(cache->size(), expectedRemainingKeys.size());
+    foreach (const QString &key, expectedRemainingKeys)
+    {
+        QVariant value;
+        QVERIFY(cache->value(key, value));
+        QCOMPARE(value.toString(), key);
+    }
+}
+
+void test_SettingsCache::invalidate_ShouldEmitSettingChanged()
+{
+    QSignalSpy spy(SettingsCache::instance(), SIGNAL(settingChanged(QString)));
+
+    SettingsCache::instance()->invalidate("group/key");
+
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().first().toString(), QString("group/key"));
+}
+
+void test_SettingsCache::getValue_ShouldReturnNewDefaultValueAfterRegisteringIt()
+{
+    SettingsRegistry::instance()->addSetting(TestingKey, "first");
+    QCOMPARE(Settings().getValue(TestingKey).toString(), QString("first"));
+
+    SettingsRegistry::instance()->addSetting(TestingKey, "second");
+    QCOMPARE(Settings().getValue(TestingKey).toString(), QString("second"));
+}
+
+void test_SettingsCache::getValue_Benchmark_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("cached") << true;
+    QTest::newRow("not cached") << false;
+}
+
+void test_SettingsCache::getValue_Benchmark()
+{
+    SKIP_BENCHMARK_UNLESS_ENABLED();
+
+    QFETCH(bool, cached);
+
+    // Parseable, as most of the settings that are read often (paths, AE titles...)
+    SettingsRegistry::instance()->addSetting(TestingKey, "%HOMEPATH%/starviewer", Settings::Parseable);
+    QString expectedValue = Settings().getValue(TestingKey).toString();
+    QString value;
+
+    if (cached)
+    {
+        QBENCHMARK
+        {
+            value = Settings().getValue(TestingKey).toString();
+        }
+    }
+    else
+    {
+        // Invalidating the key before each read goes through QSettings, the registry and the parser every time, as without the cache
+        QBENCHMARK
+        {
+            SettingsCache::instance()->invalidate(TestingKey);
+            value = Settings().getValue(TestingKey).toString();
+        }
+    }
+
+    QCOMPARE(value, expectedValue);
+}
+
+DECLARE_TEST(test_SettingsCache)
+
+#include "test_settingscache.moc"
@@ -0,0 +1,112 @@
+#include "autotest.h"
+#include "spanmask.h"
+
+using namespace udg;
+
+typedef QList<QPair<int, int> > SpanList;
+
+Q_DECLARE_METATYPE(SpanList)
+
+class test_SpanMask : public QObject {
+Q_OBJECT
+
+private slots:
+    void addSpan_ShouldClipAndMergeSpans_data();
+    void addSpan_ShouldClipAndMergeSpans();
+
+    void addPolygon_ShouldRasterizeExpectedSpans_data();
+    void addPolygon_ShouldRasterizeExpectedSpans();
+
+private:
+    static SpanList getRowSpans(const SpanMask &mask, int row);
+};
+
+void test_SpanMask::addSpan_ShouldClipAndMergeSpans_data()
+{
+    QTest::addColumn<SpanList>("addedSpans");
+    QTest::addColumn<SpanList>("expectedSpans");
+
+    // The added spans are pairs of first and last pixels, the expected ones are pairs of begin and end
+    QTest::newRow("no spans") << SpanList() << SpanList();
+    QTest::newRow("separated spans") << (SpanList() << qMakePair(1, 2) << qMakePair(5, 6)) << (SpanList() << qMakePair(1, 3) << qMakePair(5, 7));
+    QTest::newRow("touching spans") << (SpanList() << qMakePair(1, 2) << qMakePair(3, 4)) << (SpanList() << qMakePair(1, 5));
+    QTest::newRow("overlapping spans") << (SpanList() << qMakePair(1, 5) << qMakePair(2, 3)) << (SpanList() << qMakePair(1, 6));
+    QTest::newRow("clipped span") << (SpanList() << qMakePair(-3, 12)) << (SpanList() << qMakePair(0, 8));
+    QTest::newRow("span out of the image") << (SpanList() << qMakePair(8, 10)) << SpanList();
+}
+
+void test_SpanMask::addSpan_ShouldClipAndMergeSpans()
+{
+    QFETCH(SpanList, addedSpans);
+    QFETCH(SpanList, expectedSpans);
+
+    SpanMask mask;
+    mask.reset(8, 6);
+    mask.addSpan(1, 0, 7);
+
+    typedef QPair<int, int> PixelInterval;
+    foreach (const PixelInterval &span, addedSpans)
+    {
+        mask.addSpan(3, span.first, span.second);
+    }
+
+    // The rows before, between and after the rows with spans are empty
+    QCOMPARE(getRowSpans(mask, 0), SpanList());
+    QCOMPARE(getRowSpans(mask, 1), SpanList() << qMakePair(0, 8));
+    QCOMPARE(getRowSpans(mask, 2), SpanList());
+    QCOMPARE(getRowSpans(mask, 3), expectedSpans);
+    QCOMPARE(getRowSpans(mask, 5), SpanList());
+}
+
+void test_SpanMask::addPolygon_ShouldRasterizeExpectedSpans_data()
+{
+    QTest::addColumn<QPolygonF>("polygon");
+    QTest::addColumn<bool>("includeOutline");
+    QTest::addColumn<int>("row");
+    QTest::addColumn<SpanList>("expectedSpans");
+
+    QPolygonF square = QPolygonF() << QPointF(0.5, 0.5) << QPointF(2.5, 0.5) << QPointF(2.5, 2.5) << QPointF(0.5, 2.5);
+    QTest::newRow("square, row above") << square << false << 0 << SpanList();
+    QTest::newRow("square, first row") << square << false << 1 << (SpanList() << qMakePair(1, 3));
+
+    // The pixels of the bottom edge are only added with the outline
+    QPolygonF integerSquare = QPolygonF() << QPointF(1.0, 1.0) << QPointF(3.0, 1.0) << QPointF(3.0, 3.0) << QPointF(1.0, 3.0);
+    QTest::newRow("integer square, last row") << integerSquare << false << 3 << SpanList();
+    QTest::newRow("integer square with outline, last row") << integerSquare << true << 3 << (SpanList() << qMakePair(1, 4));
+
+    QPolygonF concavePolygon = QPolygonF() << QPointF(0.0, 0.0) << QPointF(3.0, 4.0) << QPointF(6.0, 0.0) << QPointF(7.0, 6.0) << QPointF(0.0, 6.0);
+    QTest::newRow("concave polygon, top row") << concavePolygon << false << 1 << (SpanList() << qMakePair(0, 1) << qMakePair(6, 7));
+    QTest::newRow("concave polygon, vertex row") << concavePolygon << false << 4 << (SpanList() << qMakePair(0, 7));
+    QTest::newRow("concave polygon with outline, top row") << concavePolygon << true << 0 << (SpanList() << qMakePair(0, 1) << qMakePair(6, 7));
+}
+
+void test_SpanMask::addPolygon_ShouldRasterizeExpectedSpans()
+{
+    QFETCH(QPolygonF, polygon);
+    QFETCH(bool, includeOutline);
+    QFETCH(int, row);
+    QFETCH(SpanList, expectedSpans);
+
+    SpanMask mask;
+    mask.reset(8, 8);
+    mask.addPolygon(polygon, includeOutline);
+
+    QCOMPARE(getRowSpans(mask, row), expectedSpans);
+}
+
+SpanList test_SpanMask::getRowSpans(const SpanMask &mask, int row)
+{
+    SpanList spanList;
+    int numberOfSpans;
+    const SpanMask::Span *spans = mask.getRowSpans(row, numberOfSpans);
+    for (int i = 0; i < numberOfSpans; ++i)
+    {
+        spanList << qMakePair(spans[i].begin, spans[i].end);
+    }
+
+    return spanList;
+}
+
+DECLARE_TEST(test_SpanMask)
+
+#include "test_spanmask.moc"
@@ -0,0 +1,67 @@
+#include "autotest.h"
+#include "startupprofiler.h"
+
+using namespace udg;
+
+class test_StartupProfiler : public QObject {
+Q_OBJECT
+
+private slots:
+    void endPhase_ShouldMeasureConsecutivePhases();
+
+    void endPhase_ShouldBeIgnoredOutsideTheStartup();
+
+    void start_ShouldForgetThePhasesOfThePreviousStartup();
+};
+
+void test_StartupProfiler::endPhase_ShouldMeasureConsecutivePhases()
+{
+    StartupProfiler::start();
+    QVERIFY(StartupProfiler::isRunning());
+
+    QTest::qSleep(20);
+    StartupProfiler::endPhase("first");
+    QTest::qSleep(10);
+    StartupProfiler::endPhase("second");
+    StartupProfiler::finish();
+
+    QVERIFY(!StartupProfiler::isRunning());
+
+    QList<QPair<QString, qint64> > phases = StartupProfiler::getPhases();
+    QCOMPARE(phases.count(), 2);
+    QCOMPARE(phases.at(0).first, QString("first"));
+    QCOMPARE(phases.at(1).first, QString("second"));
+    QVERIFY(phases.at(0).second >= 20);
+    QVERIFY(phases.at(1).second >= 10);
+}
+
+void test_StartupProfiler::endPhase_ShouldBeIgnoredOutsideTheStartup()
+{
+    StartupProfiler::start();
+    StartupProfiler::endPhase("startup");
+    StartupProfiler::finish();
+
+    StartupProfiler::endPhase("after finish");
+    StartupProfiler::finish();
+
+    QCOMPARE(StartupProfiler::getPhases().count(), 1);
+    QCOMPARE(StartupProfiler::getPhases().first().first, QString("startup"));
+}
+
+void test_StartupProfiler::start_ShouldForgetThePhasesOfThePreviousStartup()
+{
+    StartupProfiler::start();
+    StartupProfiler::endPhase("previous");
+    StartupProfiler::finish();
+
+    StartupProfiler::start();
+    StartupProfiler::endPhase("current");
+    StartupProfiler::finish();
+
+    QCOMPARE(StartupProfiler::getPhases().count(), 1);
+    QCOMPARE(StartupProfiler::getPhases().first().first, QString("current"));
+}
+
+DECLARE_TEST(test_StartupProfiler)
+
+#include "test_startupprofiler.moc"
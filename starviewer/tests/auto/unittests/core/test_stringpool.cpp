@@ -0,0 +1,85 @@
+#include "autotest.h"
+#include "stringpool.h"
+
+using namespace udg;
+
+class test_StringPool : public QObject {
+Q_OBJECT
+
+private slots:
+    void intern_ShouldReturnEqualString_data();
+    void intern_ShouldReturnEqualString();
+
+    void intern_ShouldShareDataBetweenEqualStrings();
+
+    void intern_ShouldNotShareDataBetweenDifferentStrings();
+
+    void purge_ShouldRemoveOnlyStringsNotUsedOutsideThePool();
+};
+
+void test_StringPool::intern_ShouldReturnEqualString_data()
+{
+    QTest::addColumn<QString>("string");
+
+    QTest::newRow("null") << QString();
+    QTest::newRow("empty") << QString("");
+    QTest::newRow("transfer syntax") << QString("1.2.840.10008.1.2.1");
+    QTest::newRow("directory") << QString("/home/user/.starviewer/pacs/dicom/1.2.3/4.5.6/");
+}
+
+void test_StringPool::intern_ShouldReturnEqualString()
+{
+    QFETCH(QString, string);
+
+    QString interned = StringPool::instance()->intern(string);
+
+    QCOMPARE(interned, string);
+    QCOMPARE(interned.isNull(), string.isNull());
+}
+
+void test_StringPool::intern_ShouldShareDataBetweenEqualStrings()
+{
+    // Built separately so that they don't share data before interning
+    QString string1 = QString("ORIGINAL\\PRIMARY\\") + "AXIAL";
+    QString string2 = QString("ORIGINAL\\PRIMARY\\") + "AXIAL";
+    QVERIFY(string1.constData() != string2.constData());
+
+    QString interned1 = StringPool::instance()->intern(string1);
+    QString interned2 = StringPool::instance()->intern(string2);
+
+    QCOMPARE(interned1.constData(), interned2.constData());
+}
+
+void test_StringPool::intern_ShouldNotShareDataBetweenDifferentStrings()
+{
+    QString interned1 = StringPool::instance()->intern("DERIVED\\SECONDARY");
+    QString interned2 = StringPool::instance()->intern("DERIVED\\PRIMARY");
+
+    QVERIFY(interned1.constData() != interned2.constData());
+    QCOMPARE(interned1, QString("DERIVED\\SECONDARY"));
+    QCOMPARE(interned2, QString("DERIVED\\PRIMARY"));
+}
+
+void test_StringPool::purge_ShouldRemoveOnlyStringsNotUsedOutsideThePool()
+{
+    StringPool *pool = StringPool::instance();
+    pool->purge();
+    int initialSize = pool->size();
+
+    // The interned copy of the first one is dropped, as when the images that used it are destroyed
+    pool->intern(QString("DERIVED\\SECONDARY\\UNUSED"));
+    QString used = pool->intern(QString("DERIVED\\SECONDARY\\USED"));
+    QCOMPARE(pool->size(), initialSize + 2);
+
+    QCOMPARE(pool->purge(), 1);
+    QCOMPARE(pool->size(), initialSize + 1);
+
+    // The string still in use is kept and shared
+    QString usedAgain = pool->intern(QString("DERIVED\\SECONDARY\\USED"));
+    QCOMPARE(usedAgain.constData(), used.constData());
+    QCOMPARE(pool->size(), initialSize + 1);
+}
+
+DECLARE_TEST(test_StringPool)
+
+#include "test_stringpool.moc"
@@ -71,6 +71,8 @@ private slots:
     void getPatientAge_ReturnExpectedValues_data();
     void getPatientAge_ReturnExpectedValues();
 
+    void copyWithoutSeries_ShouldCopyAllStudyInformation();
+
 private:
     /// Prepara les dades comunes de testing per els operadors > i <.
     void setupUpOperatorsLessThanGreaterThanData();
@@ -616,6 +618,56 @@ void test_Study::getPatientAge_ReturnExpectedValues()
     StudyTestHelper::cleanUp(study);
 }
 
+void test_Study::copyWithoutSeries_ShouldCopyAllStudyInformation()
+{
+    DICOMSource studyDICOMSource;
+    studyDICOMSource.addRetrievePACS(PACSDeviceTestHelper::createPACSDeviceByID("1"));
+    DICOMSource seriesDICOMSource;
+    seriesDICOMSource.addRetrievePACS(PACSDeviceTestHelper::createPACSDeviceByID("2"));
+
+    Study *study = StudyTestHelper::createStudyByUID("1.2.3", 1, 1);
+    study->setID("ID");
+    study->setAccessionNumber("ACCESSION");
+    study->setDescription("DESCRIPTION");
+    study->setPatientAge("042Y");
+    study->setWeight(70.5);
+    study->setHeight(1.75);
+    study->addModality("CT");
+    study->addModality("SR");
+    study->setReferringPhysiciansName("REFERRING^PHYSICIAN");
+    study->setDate(QDate(2014, 3, 2));
+    study->setTime(QTime(10, 20, 30));
+    study->setRetrievedDate(QDate(2014, 3, 3));
+    study->setRetrievedTime(QTime(11, 22, 33));
+    study->setInstitutionName("INSTITUTION");
+    study->setDICOMSource(studyDICOMSource);
+    study->getSeries().first()->setDICOMSource(seriesDICOMSource);
+
+    Study *copy = study->copyWithoutSeries();
+
+    QVERIFY(copy != study);
+    QCOMPARE(copy->getInstanceUID(), study->getInstanceUID());
+    QCOMPARE(copy->getID(), study->getID());
+    QCOMPARE(copy->getAccessionNumber(), study->getAccessionNumber());
+    QCOMPARE(copy->getDescription(), study->getDescription());
+    QCOMPARE(copy->getPatientAge(), study->getPatientAge());
+    QCOMPARE(copy->getWeight(), study->getWeight());
+    QCOMPARE(copy->getHeight(), study->getHeight());
+    QCOMPARE(copy->getModalities(), study->getModalities());
+    QCOMPARE(copy->getReferringPhysiciansName(), study->getReferringPhysiciansName());
+    QCOMPARE(copy->getDate(), study->getDate());
+    QCOMPARE(copy->getTime(), study->getTime());
+    QCOMPARE(copy->getRetrievedDate(), study->getRetrievedDate());
+    QCOMPARE(copy->getRetrievedTime(), study->getRetrievedTime());
+    QCOMPARE(copy->getInstitutionName(), study->getInstitutionName());
+    QCOMPARE(copy->getDICOMSource() == study->getDICOMSource(), true);
+    QCOMPARE(copy->getNumberOfSeries(), 0);
+    QVERIFY(!copy->getParentPatient());
+
+    delete copy;
+    StudyTestHelper::cleanUp(study);
+}
+
 DECLARE_TEST(test_Study)
 
 #include "test_study.moc"
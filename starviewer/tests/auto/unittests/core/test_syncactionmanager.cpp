@@ -0,0 +1,255 @@
+#include "autotest.h"
+#include "syncactionmanager.h"
+
+#include "q2dviewer.h"
+#include "syncaction.h"
+#include "syncactionsconfiguration.h"
+#include "synccriterion.h"
+#include "volume.h"
+#include "volumetesthelper.h"
+
+#include <vtkCallbackCommand.h>
+#include <vtkRenderWindow.h>
+#include <vtkSmartPointer.h>
+
+using namespace udg;
+using namespace testing;
+
+namespace {
+
+// Viewers of a 4x4 layout
+const int NumberOfViewers = 16;
+
+/// Criterion that is always met and counts how many times it has been evaluated
+class CountingSyncCriterion : public SyncCriterion {
+public:
+    CountingSyncCriterion(int *evaluations)
+        : m_evaluations(evaluations)
+    {
+    }
+
+protected:
+    virtual bool criterionIsMet(QViewer *viewer1, QViewer *viewer2)
+    {
+        Q_UNUSED(viewer1);
+        Q_UNUSED(viewer2);
+        ++(*m_evaluations);
+        return true;
+    }
+
+private:
+    int *m_evaluations;
+};
+
+/// Action that renders the viewer, as the real ones do, and counts how many times it has been run on each viewer
+class CountingSyncAction : public SyncAction {
+public:
+    CountingSyncAction(const QString &name, int *criterionEvaluations)
+        : m_name(name), m_criterionEvaluations(criterionEvaluations)
+    {
+    }
+
+    virtual void run(QViewer *viewer)
+    {
+        ++m_runs[viewer];
+        viewer->render();
+    }
+
+    int getRuns(QViewer *viewer) const
+    {
+        return m_runs.value(viewer);
+    }
+
+protected:
+    virtual void setupMetaData()
+    {
+        m_metaData = SyncActionMetaData(m_name, m_name, m_name);
+    }
+
+    virtual void setupDefaultSyncCriteria()
+    {
+        m_defaultSyncCriteria << new CountingSyncCriterion(m_criterionEvaluations);
+    }
+
+private:
+    QString m_name;
+    int *m_criterionEvaluations;
+    QHash<QViewer*, int> m_runs;
+};
+
+void countRender(vtkObject *caller, unsigned long eventId, void *clientData, void *callData)
+{
+    Q_UNUSED(caller);
+    Q_UNUSED(eventId);
+    Q_UNUSED(callData);
+    ++(*static_cast<int*>(clientData));
+}
+
+}
+
+class test_SyncActionManager : public QObject {
+Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void applySyncAction_ShouldRenderEachViewerOncePerFrame();
+    void applySyncAction_ShouldApplyOnlyLastActionOfEachType();
+    void applySyncAction_ShouldNotApplyActionsWhenDisabled();
+
+private:
+    /// Applies the given action as if it had been mapped from a signal of the master viewer
+    void mapSyncAction(SyncAction *syncAction);
+
+    /// Waits until the pending frame has been processed
+    void waitForFrame();
+
+private:
+    SyncActionManager *m_manager;
+    QList<Q2DViewer*> m_viewers;
+    QList<Volume*> m_volumes;
+    QVector<int> m_renders;
+    QList<vtkSmartPointer<vtkCallbackCommand> > m_renderCallbacks;
+    int m_criterionEvaluations;
+    CountingSyncAction *m_firstAction;
+    CountingSyncAction *m_secondAction;
+};
+
+void test_SyncActionManager::init()
+{
+    m_criterionEvaluations = 0;
+    m_firstAction = new CountingSyncAction("FirstSyncAction", &m_criterionEvaluations);
+    m_secondAction = new CountingSyncAction("SecondSyncAction", &m_criterionEvaluations);
+
+    SyncActionsConfiguration *configuration = new SyncActionsConfiguration();
+    configuration->enableSyncAction(m_firstAction->getMetaData(), true);
+    configuration->enableSyncAction(m_secondAction->getMetaData(), true);
+    m_manager = new SyncActionManager(configuration);
+
+    double origin[3] = { 0.0, 0.0, 0.0 };
+    double spacing[3] = { 1.0, 1.0, 1.0 };
+    int extent[6] = { 0, 7, 0, 7, 0, 1 };
+    m_renders.fill(0, NumberOfViewers);
+
+    for (int i = 0; i < NumberOfViewers; i++)
+    {
+        Volume *volume = VolumeTestHelper::createVolumeWithParameters(2, 1, 1, origin, spacing, extent, true);
+        Q2DViewer *viewer = new Q2DViewer();
+        viewer->setInput(volume);
+
+        vtkSmartPointer<vtkCallbackCommand> renderCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+        renderCallback->SetCallback(countRender);
+        renderCallback->SetClientData(&m_renders[i]);
+        viewer->getRenderWindow()->AddObserver(vtkCommand::StartEvent, renderCallback);
+
+        m_manager->addSyncedViewer(viewer);
+        m_volumes << volume;
+        m_viewers << viewer;
+        m_renderCallbacks << renderCallback;
+    }
+
+    m_manager->setMasterViewer(m_viewers.first());
+    m_manager->enable(true);
+
+    // Start counting after everything done by the initial synchronization
+    waitForFrame();
+    m_renders.fill(0);
+    m_criterionEvaluations = 0;
+}
+
+void test_SyncActionManager::cleanup()
+{
+    delete m_manager;
+    delete m_firstAction;
+    delete m_secondAction;
+
+    for (int i = 0; i < m_viewers.count(); i++)
+    {
+        m_viewers.at(i)->getRenderWindow()->RemoveObserver(m_renderCallbacks.at(i));
+        delete m_viewers.at(i);
+        VolumeTestHelper::cleanUp(m_volumes.at(i));
+    }
+
+    m_viewers.clear();
+    m_volumes.clear();
+    m_renderCallbacks.clear();
+}
+
+void test_SyncActionManager::applySyncAction_ShouldRenderEachViewerOncePerFrame()
+{
+    // Many events from a drag of the master viewer within a single frame
+    for (int i = 0; i < 10; i++)
+    {
+        mapSyncAction(m_firstAction);
+        mapSyncAction(m_secondAction);
+    }
+
+    // Nothing is done until the next frame
+    QCOMPARE(m_renders.count(0), NumberOfViewers);
+
+    waitForFrame();
+
+    QCOMPARE(m_renders.at(0), 0);
+    for (int i = 1; i < NumberOfViewers; i++)
+    {
+        QCOMPARE(m_renders.at(i), 1);
+    }
+
+    // The criteria are evaluated once per viewer pair and action type, not once per event
+    QCOMPARE(m_criterionEvaluations, 2 * (NumberOfViewers - 1));
+
+    // The next events are rendered on the next frame
+    mapSyncAction(m_firstAction);
+    waitForFrame();
+
+    for (int i = 1; i < NumberOfViewers; i++)
+    {
+        QCOMPARE(m_renders.at(i), 2);
+    }
+}
+
+void test_SyncActionManager::applySyncAction_ShouldApplyOnlyLastActionOfEachType()
+{
+    for (int i = 0; i < 10; i++)
+    {
+        mapSyncAction(m_firstAction);
+    }
+    mapSyncAction(m_secondAction);
+
+    waitForFrame();
+
+    QCOMPARE(m_firstAction->getRuns(m_viewers.first()), 0);
+    QCOMPARE(m_secondAction->getRuns(m_viewers.first()), 0);
+    for (int i = 1; i < NumberOfViewers; i++)
+    {
+        QCOMPARE(m_firstAction->getRuns(m_viewers.at(i)), 1);
+        QCOMPARE(m_secondAction->getRuns(m_viewers.at(i)), 1);
+    }
+}
+
+void test_SyncActionManager::applySyncAction_ShouldNotApplyActionsWhenDisabled()
+{
+    mapSyncAction(m_firstAction);
+    m_manager->enable(false);
+
+    waitForFrame();
+
+    QCOMPARE(m_renders.count(0), NumberOfViewers);
+    QCOMPARE(m_firstAction->getRuns(m_viewers.last()), 0);
+}
+
+void test_SyncActionManager::mapSyncAction(SyncAction *syncAction)
+{
+    QVERIFY(QMetaObject::invokeMethod(m_manager, "applySyncAction", Qt::DirectConnection, Q_ARG(SyncAction*, syncAction)));
+}
+
+void test_SyncActionManager::waitForFrame()
+{
+    // A frame lasts less than 50 ms at any usual refresh rate
+    QTest::qWait(50);
+}
+
+DECLARE_TEST(test_SyncActionManager)
+
+#include "test_syncactionmanager.moc"
@@ -0,0 +1,351 @@
+#include "autotest.h"
+#include "temporalroiengine.h"
+
+#include "mathtools.h"
+
+#include <cmath>
+
+using namespace udg;
+
+typedef QList<QPair<int, int> > SpanList;
+
+Q_DECLARE_METATYPE(QVector<QPointF>)
+Q_DECLARE_METATYPE(OrthogonalPlane)
+Q_DECLARE_METATYPE(SpanList)
+
+class test_TemporalROIEngine : public QObject {
+Q_OBJECT
+
+private slots:
+    void setROI_ShouldRasterizeExpectedSpans_data();
+    void setROI_ShouldRasterizeExpectedSpans();
+
+    void computeStatistics_ShouldComputeExpectedValues();
+
+    void computeStatistics_ShouldMatchVoxelByVoxelComputation_data();
+    void computeStatistics_ShouldMatchVoxelByVoxelComputation();
+
+    void computeStatistics_ShouldReturnZerosWithEmptyROI_data();
+    void computeStatistics_ShouldReturnZerosWithEmptyROI();
+
+    void computeStatistics_Benchmark_data();
+    void computeStatistics_Benchmark();
+
+private:
+    /// Returns a temporal image of the given size where the value of phase t of voxel (x, y, z) is x + 10 * y + 100 * t + 1000 * z, or a random
+    /// value if random is true
+    static TemporalROIEngine::TemporalImageType::Pointer createImage(int numberOfPhases, int width, int height, int depth, bool random = false);
+
+    static SpanList getRowSpans(const TemporalROIEngine &engine, int row);
+
+    /// Returns a polygon with the given number of vertices that approximates a circle
+    static QVector<QPointF> createCircle(double centreX, double centreY, double radius, int numberOfVertices);
+};
+
+void test_TemporalROIEngine::setROI_ShouldRasterizeExpectedSpans_data()
+{
+    QTest::addColumn<QVector<QPointF> >("polygon");
+    QTest::addColumn<int>("slice");
+    QTest::addColumn<int>("row");
+    QTest::addColumn<SpanList>("expectedSpans");
+
+    QVector<QPointF> square = QVector<QPointF>() << QPointF(0.5, 0.5) << QPointF(2.5, 0.5) << QPointF(2.5, 2.5) << QPointF(0.5, 2.5);
+    QTest::newRow("square, row above") << square << 0 << 0 << SpanList();
+    QTest::newRow("square, first row") << square << 0 << 1 << (SpanList() << qMakePair(1, 3));
+    QTest::newRow("square, last row") << square << 0 << 2 << (SpanList() << qMakePair(1, 3));
+    QTest::newRow("square, row below") << square << 0 << 3 << SpanList();
+    QTest::newRow("square, slice out of the image") << square << 4 << 1 << SpanList();
+
+    QVector<QPointF> closedSquare = square;
+    closedSquare << square.first();
+    QTest::newRow("closed square") << closedSquare << 0 << 1 << (SpanList() << qMakePair(1, 3));
+
+    QVector<QPointF> clippedSquare = QVector<QPointF>() << QPointF(-3.0, -3.0) << QPointF(12.0, -3.0) << QPointF(12.0, 2.0) << QPointF(-3.0, 2.0);
+    QTest::newRow("clipped square") << clippedSquare << 0 << 0 << (SpanList() << qMakePair(0, 8));
+
+    QVector<QPointF> concavePolygon = QVector<QPointF>() << QPointF(0.0, 0.0) << QPointF(3.0, 4.0) << QPointF(6.0, 0.0) << QPointF(7.0, 6.0)
+                                                         << QPointF(0.0, 6.0);
+    QTest::newRow("concave polygon, top row") << concavePolygon << 0 << 1 << (SpanList() << qMakePair(0, 1) << qMakePair(6, 7));
+    QTest::newRow("concave polygon, vertex row") << concavePolygon << 0 << 4 << (SpanList() << qMakePair(0, 7));
+    QTest::newRow("concave polygon, bottom row") << concavePolygon << 0 << 6 << SpanList();
+}
+
+void test_TemporalROIEngine::setROI_ShouldRasterizeExpectedSpans()
+{
+    QFETCH(QVector<QPointF>, polygon);
+    QFETCH(int, slice);
+    QFETCH(int, row);
+    QFETCH(SpanList, expectedSpans);
+
+    TemporalROIEngine engine;
+    engine.setTemporalImage(createImage(2, 8, 8, 2));
+    engine.setROI(polygon, OrthogonalPlane::XYPlane, slice);
+
+    QCOMPARE(engine.getNumberOfRows(), 8);
+    QCOMPARE(getRowSpans(engine, row), expectedSpans);
+}
+
+void test_TemporalROIEngine::computeStatistics_ShouldComputeExpectedValues()
+{
+    TemporalROIEngine engine;
+    engine.setTemporalImage(createImage(2, 4, 4, 2));
+    engine.setROI(QVector<QPointF>() << QPointF(0.5, 0.5) << QPointF(2.5, 0.5) << QPointF(2.5, 2.5) << QPointF(0.5, 2.5), OrthogonalPlane::XYPlane, 1);
+
+    // Voxels (1, 1), (2, 1), (1, 2) and (2, 2) of slice 1
+    TemporalROIEngine::Statistics statistics = engine.computeStatistics();
+
+    QCOMPARE(statistics.numberOfVoxels, 4);
+    QCOMPARE(statistics.mean, QVector<double>() << 1016.5 << 1116.5);
+    QCOMPARE(statistics.standardDeviation, QVector<double>() << std::sqrt(25.25) << std::sqrt(25.25));
+    QCOMPARE(statistics.minimum, QVector<double>() << 1011.0 << 1111.0);
+    QCOMPARE(statistics.maximum, QVector<double>() << 1022.0 << 1122.0);
+    QCOMPARE(statistics.timeToPeak, QVector<int>() << 0 << 4);
+}
+
+void test_TemporalROIEngine::computeStatistics_ShouldMatchVoxelByVoxelComputation_data()
+{
+    QTest::addColumn<OrthogonalPlane>("plane");
+
+    QTest::newRow("XY plane") << OrthogonalPlane(OrthogonalPlane::XYPlane);
+    QTest::newRow("YZ plane") << OrthogonalPlane(OrthogonalPlane::YZPlane);
+    QTest::newRow("XZ plane") << OrthogonalPlane(OrthogonalPlane::XZPlane);
+}
+
+void test_TemporalROIEngine::computeStatistics_ShouldMatchVoxelByVoxelComputation()
+{
+    QFETCH(OrthogonalPlane, plane);
+
+    const int NumberOfPhases = 7;
+    TemporalROIEngine::TemporalImageType::Pointer image = createImage(NumberOfPhases, 40, 30, 20, true);
+
+    TemporalROIEngine engine;
+    engine.setTemporalImage(image);
+    engine.setROI(QVector<QPointF>() << QPointF(2.3, 1.7) << QPointF(17.8, 4.2) << QPointF(9.1, 9.6) << QPointF(15.4, 18.9) << QPointF(1.2, 16.5),
+                  plane, 5);
+    TemporalROIEngine::Statistics statistics = engine.computeStatistics();
+
+    // Reference computation reading one pixel at a time
+    int xIndex, yIndex, zIndex;
+    plane.getXYZIndexes(xIndex, yIndex, zIndex);
+    QVector<double> sum(NumberOfPhases, 0.0);
+    QVector<double> minimum(NumberOfPhases, 1e300);
+    QVector<double> maximum(NumberOfPhases, -1e300);
+    QVector<int> timeToPeak(NumberOfPhases, 0);
+    QList<QVector<double> > series;
+
+    for (int row = 0; row < engine.getNumberOfRows(); row++)
+    {
+        SpanList spans = getRowSpans(engine, row);
+        for (int i = 0; i < spans.count(); i++)
+        {
+            for (int x = spans.at(i).first; x < spans.at(i).second; x++)
+            {
+                itk::Index<4> index;
+                index[xIndex + 1] = x;
+                index[yIndex + 1] = row;
+                index[zIndex + 1] = 5;
+
+                QVector<double> voxelSeries(NumberOfPhases);
+                int peak = 0;
+                for (int t = 0; t < NumberOfPhases; t++)
+                {
+                    index[0] = t;
+                    voxelSeries[t] = image->GetPixel(index);
+                    sum[t] += voxelSeries[t];
+                    minimum[t] = qMin(minimum[t], voxelSeries[t]);
+                    maximum[t] = qMax(maximum[t], voxelSeries[t]);
+                    if (voxelSeries[t] > voxelSeries[peak])
+                    {
+                        peak = t;
+                    }
+                }
+                timeToPeak[peak]++;
+                series << voxelSeries;
+            }
+        }
+    }
+
+    QVERIFY(series.count() > 50);
+    QCOMPARE(statistics.numberOfVoxels, series.count());
+    QCOMPARE(engine.getNumberOfVoxels(), series.count());
+    QCOMPARE(statistics.minimum, minimum);
+    QCOMPARE(statistics.maximum, maximum);
+    QCOMPARE(statistics.timeToPeak, timeToPeak);
+
+    for (int t = 0; t < NumberOfPhases; t++)
+    {
+        double mean = sum[t] / series.count();
+        double sumOfSquaredDeviations = 0.0;
+        foreach (const QVector<double> &voxelSeries, series)
+        {
+            sumOfSquaredDeviations += (voxelSeries[t] - mean) * (voxelSeries[t] - mean);
+        }
+
+        QVERIFY(qAbs(statistics.mean[t] - mean) < 1e-9);
+        QVERIFY(qAbs(statistics.standardDeviation[t] - std::sqrt(sumOfSquaredDeviations / series.count())) < 1e-6);
+    }
+}
+
+void test_TemporalROIEngine::computeStatistics_ShouldReturnZerosWithEmptyROI_data()
+{
+    QTest::addColumn<bool>("withImage");
+    QTest::addColumn<QVector<QPointF> >("polygon");
+
+    QVector<QPointF> square = QVector<QPointF>() << QPointF(0.5, 0.5) << QPointF(2.5, 0.5) << QPointF(2.5, 2.5) << QPointF(0.5, 2.5);
+    QTest::newRow("no image") << false << square;
+    QTest::newRow("empty polygon") << true << QVector<QPointF>();
+    QTest::newRow("polygon out of the image") << true << (QVector<QPointF>() << QPointF(10.0, 10.0) << QPointF(12.0, 10.0) << QPointF(12.0, 12.0));
+    QTest::newRow("polygon between voxel centres") << true << (QVector<QPointF>() << QPointF(1.2, 1.2) << QPointF(1.8, 1.2) << QPointF(1.8, 1.8));
+}
+
+void test_TemporalROIEngine::computeStatistics_ShouldReturnZerosWithEmptyROI()
+{
+    QFETCH(bool, withImage);
+    QFETCH(QVector<QPointF>, polygon);
+
+    TemporalROIEngine engine;
+    if (withImage)
+    {
+        engine.setTemporalImage(createImage(3, 4, 4, 2));
+    }
+    engine.setROI(polygon, OrthogonalPlane::XYPlane, 0);
+
+    TemporalROIEngine::Statistics statistics = engine.computeStatistics();
+    int numberOfPhases = withImage ? 3 : 0;
+
+    QCOMPARE(engine.getNumberOfVoxels(), 0);
+    QCOMPARE(statistics.numberOfVoxels, 0);
+    QCOMPARE(statistics.mean, QVector<double>(numberOfPhases, 0.0));
+    QCOMPARE(statistics.standardDeviation, QVector<double>(numberOfPhases, 0.0));
+    QCOMPARE(statistics.minimum, QVector<double>(numberOfPhases, 0.0));
+    QCOMPARE(statistics.maximum, QVector<double>(numberOfPhases, 0.0));
+    QCOMPARE(statistics.timeToPeak, QVector<int>(numberOfPhases, 0));
+}
+
+void test_TemporalROIEngine::computeStatistics_Benchmark_data()
+{
+    QTest::addColumn<bool>("voxelByVoxel");
+
+    QTest::newRow("voxel by voxel") << true;
+    QTest::newRow("engine") << false;
+}
+
+void test_TemporalROIEngine::computeStatistics_Benchmark()
+{
+    SKIP_BENCHMARK_UNLESS_ENABLED();
+
+    QFETCH(bool, voxelByVoxel);
+
+    // Perfusion series with 60 phases and a ROI covering a large part of the slice
+    const int NumberOfPhases = 60;
+    TemporalROIEngine::TemporalImageType::Pointer image = createImage(NumberOfPhases, 256, 256, 4);
+    QVector<QPointF> circle = createCircle(128.0, 128.0, 100.0, 64);
+    double total = 0.0;
+
+    if (voxelByVoxel)
+    {
+        // Mean computation as done before the engine, reading each voxel one phase at a time
+        TemporalROIEngine mask;
+        mask.setTemporalImage(image);
+        mask.setROI(circle, OrthogonalPlane::XYPlane, 2);
+
+        QBENCHMARK
+        {
+            QVector<double> mean(NumberOfPhases, 0.0);
+            for (int row = 0; row < mask.getNumberOfRows(); row++)
+            {
+                SpanList spans = getRowSpans(mask, row);
+                for (int i = 0; i < spans.count(); i++)
+                {
+                    for (int x = spans.at(i).first; x < spans.at(i).second; x++)
+                    {
+                        itk::Index<4> index;
+                        index[1] = x;
+                        index[2] = row;
+                        index[3] = 2;
+                        for (int t = 0; t < NumberOfPhases; t++)
+                        {
+                            index[0] = t;
+                            mean[t] += image->GetPixel(index);
+                        }
+                    }
+                }
+            }
+            total += mean[0];
+        }
+    }
+    else
+    {
+        QBENCHMARK
+        {
+            TemporalROIEngine engine;
+            engine.setTemporalImage(image);
+            engine.setROI(circle, OrthogonalPlane::XYPlane, 2);
+            total += engine.computeStatistics().mean[0];
+        }
+    }
+
+    QVERIFY(total > 0.0);
+}
+
+TemporalROIEngine::TemporalImageType::Pointer test_TemporalROIEngine::createImage(int numberOfPhases, int width, int height, int depth, bool random)
+{
+    TemporalROIEngine::TemporalImageType::SizeType size;
+    size[0] = numberOfPhases;
+    size[1] = width;
+    size[2] = height;
+    size[3] = depth;
+    TemporalROIEngine::TemporalImageType::IndexType start;
+    start.Fill(0);
+
+    TemporalROIEngine::TemporalImageType::Pointer image = TemporalROIEngine::TemporalImageType::New();
+    image->SetRegions(TemporalROIEngine::TemporalImageType::RegionType(start, size));
+    image->Allocate();
+
+    qsrand(1);
+    double *value = image->GetBufferPointer();
+    for (int z = 0; z < depth; z++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                for (int t = 0; t < numberOfPhases; t++)
+                {
+                    *value++ = random ? qrand() % 1000 : x + 10 * y + 100 * t + 1000 * z;
+                }
+            }
+        }
+    }
+
+    return image;
+}
+
+SpanList test_TemporalROIEngine::getRowSpans(const TemporalROIEngine &engine, int row)
+{
+    SpanList spanList;
+    int numberOfSpans;
+    const TemporalROIEngine::Span *spans = engine.getRowSpans(row, numberOfSpans);
+    for (int i = 0; i < numberOfSpans; ++i)
+    {
+        spanList << qMakePair(spans[i].begin, spans[i].end);
+    }
+
+    return spanList;
+}
+
+QVector<QPointF> test_TemporalROIEngine::createCircle(double centreX, double centreY, double radius, int numberOfVertices)
+{
+    QVector<QPointF> circle;
+    for (int i = 0; i < numberOfVertices; i++)
+    {
+        double angle = 2.0 * MathTools::PiNumber * i / numberOfVertices;
+        circle << QPointF(centreX + radius * std::cos(angle), centreY + radius * std::sin(angle));
+    }
+
+    return circle;
+}
+
+DECLARE_TEST(test_TemporalROIEngine)
+
+#include "test_temporalroiengine.moc"
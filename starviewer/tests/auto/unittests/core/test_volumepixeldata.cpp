@@ -8,6 +8,13 @@
 #include "fuzzycomparetesthelper.h"
 
 #include "vtkImageData.h"
+#include <vtkPointData.h>
+
+#include <itkBinaryThresholdImageFilter.h>
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
+#include <sys/resource.h>
+#endif
 
 using namespace udg;
 using namespace testing;
@@ -23,6 +30,16 @@ private slots:
     void setData_vtk_ShouldSetDataCorrectly_data();
     void setData_vtk_ShouldSetDataCorrectly();
 
+    void setData_itk_ShouldShareBufferWithVtkData();
+    void setData_itk_ShouldKeepItkPixelContainerAliveWhileVtkDataExists();
+    void setData_itk_ShouldKeepVtkDataValidWhenSourceFilterIsUpdatedAgain();
+
+    void getItkData_ShouldShareBufferWithVtkData();
+    void getItkData_ShouldReturnEmptyImageWithUnsupportedScalarType();
+
+    void getItkData_setData_itk_RoundTripShouldKeepVtkArray();
+    void getItkData_setData_itk_RoundTrip_Benchmark();
+
     void setData_WrongParametersFromArrayShouldReturn_data();
     void setData_WrongParametersFromArrayShouldReturn();
     
@@ -37,6 +54,10 @@ private slots:
 
     void getVoxelValue_IndexVariant_ShouldReturnExpectedSingleComponentValue_data();
     void getVoxelValue_IndexVariant_ShouldReturnExpectedSingleComponentValue();
+
+private:
+    /// Returns the peak resident set size of the process in bytes, or -1 if it can't be obtained in this platform
+    static qint64 getPeakResidentSetSize();
 };
 
 Q_DECLARE_METATYPE(unsigned char*)
@@ -140,6 +161,209 @@ void test_VolumePixelData::setData_vtk_ShouldSetDataCorrectly()
     QCOMPARE(volumePixelData.getVtkData(), vtkData.GetPointer());
 }
 
+void test_VolumePixelData::setData_itk_ShouldShareBufferWithVtkData()
+{
+    int dimensions[3] = { 33, 124, 6 };
+    int startIndex[3] = { 200, 169, 156 };
+    double spacing[3] = { 2.2, 0.74, 1.44 };
+    double origin[3] = { 48.0, 41.0, -68.0 };
+    VolumePixelData::ItkImageTypePointer itkData = ItkAndVtkImageTestHelper::createItkImage(dimensions, startIndex, spacing, origin);
+
+    VolumePixelData volumePixelData;
+    volumePixelData.setData(itkData);
+
+    QCOMPARE(volumePixelData.getVtkData()->GetScalarPointer(), static_cast<void*>(itkData->GetBufferPointer()));
+
+    // Changes made through ITK are seen through VTK
+    itkData->GetBufferPointer()[5] = -7;
+    QCOMPARE(static_cast<VolumePixelData::ItkPixelType*>(volumePixelData.getVtkData()->GetScalarPointer())[5], VolumePixelData::ItkPixelType(-7));
+}
+
+void test_VolumePixelData::setData_itk_ShouldKeepItkPixelContainerAliveWhileVtkDataExists()
+{
+    int dimensions[3] = { 10, 10, 10 };
+    int startIndex[3] = { 0, 0, 0 };
+    double spacing[3] = { 1.0, 1.0, 1.0 };
+    double origin[3] = { 0.0, 0.0, 0.0 };
+    VolumePixelData::ItkImageTypePointer itkData = ItkAndVtkImageTestHelper::createItkImage(dimensions, startIndex, spacing, origin);
+    VolumePixelData::ItkImageType::PixelContainer *pixelContainer = itkData->GetPixelContainer();
+    int referenceCount = pixelContainer->GetReferenceCount();
+
+    VolumePixelData *volumePixelData = new VolumePixelData;
+    volumePixelData->setData(itkData);
+    QVERIFY(pixelContainer->GetReferenceCount() > referenceCount);
+
+    // Some other object keeps the VTK data after the pixel data has been destroyed
+    vtkSmartPointer<vtkImageData> vtkData = volumePixelData->getVtkData();
+    delete volumePixelData;
+    QVERIFY(pixelContainer->GetReferenceCount() > referenceCount);
+
+    vtkData = 0;
+    QCOMPARE(pixelContainer->GetReferenceCount(), referenceCount);
+}
+
+void test_VolumePixelData::setData_itk_ShouldKeepVtkDataValidWhenSourceFilterIsUpdatedAgain()
+{
+    typedef itk::BinaryThresholdImageFilter<VolumePixelData::ItkImageType, VolumePixelData::ItkImageType> ThresholdFilterType;
+
+    int dimensions[3] = { 16, 16, 8 };
+    int startIndex[3] = { 0, 0, 0 };
+    double spacing[3] = { 1.0, 1.0, 1.0 };
+    double origin[3] = { 0.0, 0.0, 0.0 };
+    VolumePixelData::ItkImageTypePointer itkData = ItkAndVtkImageTestHelper::createItkImage(dimensions, startIndex, spacing, origin);
+    vtkIdType numberOfPixels = dimensions[0] * dimensions[1] * dimensions[2];
+    const VolumePixelData::ItkPixelType *input = itkData->GetBufferPointer();
+    VolumePixelData::ItkPixelType threshold = input[numberOfPixels / 2];
+
+    ThresholdFilterType::Pointer thresholdFilter = ThresholdFilterType::New();
+    thresholdFilter->SetInput(itkData);
+    thresholdFilter->SetLowerThreshold(threshold);
+    thresholdFilter->SetInsideValue(100);
+    thresholdFilter->SetOutsideValue(0);
+    thresholdFilter->Update();
+
+    VolumePixelData volumePixelData;
+    volumePixelData.setData(thresholdFilter->GetOutput());
+
+    // The filter runs again with other parameters: its output image is initialized and gets a new pixel container
+    thresholdFilter->SetInsideValue(50);
+    thresholdFilter->SetOutsideValue(-50);
+    thresholdFilter->Update();
+
+    const VolumePixelData::ItkPixelType *vtkScalars = static_cast<VolumePixelData::ItkPixelType*>(volumePixelData.getVtkData()->GetScalarPointer());
+    QVERIFY(vtkScalars != thresholdFilter->GetOutput()->GetBufferPointer());
+    for (vtkIdType i = 0; i < numberOfPixels; i++)
+    {
+        QCOMPARE(vtkScalars[i], VolumePixelData::ItkPixelType(input[i] >= threshold ? 100 : 0));
+    }
+}
+
+void test_VolumePixelData::getItkData_ShouldShareBufferWithVtkData()
+{
+    int dimensions[3] = { 33, 124, 6 };
+    int startIndex[3] = { 200, 169, 156 };
+    double spacing[3] = { 2.2, 0.74, 1.44 };
+    double origin[3] = { 48.0, 41.0, -68.0 };
+    VolumePixelData::ItkImageTypePointer expectedItkData;
+    vtkSmartPointer<vtkImageData> vtkData;
+    ItkAndVtkImageTestHelper::createItkAndVtkImages(dimensions, startIndex, spacing, origin, expectedItkData, vtkData);
+
+    VolumePixelData volumePixelData;
+    volumePixelData.setData(vtkData);
+    VolumePixelData::ItkImageTypePointer itkData = volumePixelData.getItkData();
+
+    QCOMPARE(static_cast<void*>(itkData->GetBufferPointer()), vtkData->GetScalarPointer());
+    QCOMPARE(itkData->GetBufferedRegion(), expectedItkData->GetBufferedRegion());
+    QCOMPARE(itkData->GetLargestPossibleRegion(), expectedItkData->GetLargestPossibleRegion());
+    for (int i = 0; i < 3; i++)
+    {
+        QCOMPARE(itkData->GetSpacing()[i], expectedItkData->GetSpacing()[i]);
+        QCOMPARE(itkData->GetOrigin()[i], expectedItkData->GetOrigin()[i]);
+    }
+
+    // The ITK image keeps the VTK array alive after the VTK data has been replaced
+    vtkDataArray *scalars = vtkData->GetPointData()->GetScalars();
+    int referenceCount = scalars->GetReferenceCount();
+    volumePixelData.setData(vtkSmartPointer<vtkImageData>::New());
+    vtkData = 0;
+    QCOMPARE(scalars->GetReferenceCount(), referenceCount - 1);
+    QCOMPARE(itkData->GetPixel(expectedItkData->GetBufferedRegion().GetIndex()), VolumePixelData::ItkPixelType(0));
+}
+
+void test_VolumePixelData::getItkData_ShouldReturnEmptyImageWithUnsupportedScalarType()
+{
+    vtkSmartPointer<vtkImageData> vtkData = vtkSmartPointer<vtkImageData>::New();
+    vtkData->SetExtent(0, 9, 0, 9, 0, 9);
+    vtkData->AllocateScalars(VTK_FLOAT, 1);
+
+    VolumePixelData volumePixelData;
+    volumePixelData.setData(vtkData);
+    VolumePixelData::ItkImageTypePointer itkData = volumePixelData.getItkData();
+
+    QVERIFY(itkData.IsNotNull());
+    QVERIFY(!itkData->GetBufferPointer());
+}
+
+void test_VolumePixelData::getItkData_setData_itk_RoundTripShouldKeepVtkArray()
+{
+    int dimensions[3] = { 20, 30, 40 };
+    int startIndex[3] = { 0, 0, 0 };
+    double spacing[3] = { 1.0, 1.0, 2.0 };
+    double origin[3] = { 10.0, 0.0, -5.0 };
+    VolumePixelData::ItkImageTypePointer itkData;
+    vtkSmartPointer<vtkImageData> vtkData;
+    ItkAndVtkImageTestHelper::createItkAndVtkImages(dimensions, startIndex, spacing, origin, itkData, vtkData);
+
+    VolumePixelData volumePixelData;
+    volumePixelData.setData(vtkData);
+    volumePixelData.setData(volumePixelData.getItkData());
+
+    QVERIFY(volumePixelData.getVtkData() != vtkData.GetPointer());
+    QCOMPARE(volumePixelData.getVtkData()->GetPointData()->GetScalars(), vtkData->GetPointData()->GetScalars());
+    bool equal;
+    ItkAndVtkImageTestHelper::compareVtkImageData(volumePixelData.getVtkData(), vtkData, equal);
+    QVERIFY(equal);
+}
+
+void test_VolumePixelData::getItkData_setData_itk_RoundTrip_Benchmark()
+{
+    SKIP_BENCHMARK_UNLESS_ENABLED();
+
+    // 100 MB of voxels
+    const int Size = 512;
+    const int NumberOfSlices = 200;
+    const qint64 VolumeSize = static_cast<qint64>(Size) * Size * NumberOfSlices * sizeof(VolumePixelData::ItkPixelType);
+
+    vtkSmartPointer<vtkImageData> vtkData = vtkSmartPointer<vtkImageData>::New();
+    vtkData->SetExtent(0, Size - 1, 0, Size - 1, 0, NumberOfSlices - 1);
+    vtkData->AllocateScalars(VTK_SHORT, 1);
+    // The pages are written so that they are resident
+    memset(vtkData->GetScalarPointer(), 1, VolumeSize);
+
+    VolumePixelData volumePixelData;
+    volumePixelData.setData(vtkData);
+
+    qint64 peakBefore = getPeakResidentSetSize();
+
+    QBENCHMARK
+    {
+        VolumePixelData::ItkImageTypePointer itkData = volumePixelData.getItkData();
+        volumePixelData.setData(itkData);
+        itkData = volumePixelData.getItkData();
+        itkData->GetBufferPointer()[0] = 2;
+    }
+
+    QCOMPARE(static_cast<VolumePixelData::ItkPixelType*>(vtkData->GetScalarPointer())[0], VolumePixelData::ItkPixelType(2));
+
+    // Without copies the round trip doesn't need memory for another volume
+    qint64 peakAfter = getPeakResidentSetSize();
+    if (peakBefore < 0)
+    {
+        QSKIP("The peak resident set size can't be obtained in this platform");
+    }
+    QVERIFY2(peakAfter - peakBefore < VolumeSize / 2, qPrintable(QString("Peak RSS increased by %1 bytes").arg(peakAfter - peakBefore)));
+}
+
+qint64 test_VolumePixelData::getPeakResidentSetSize()
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return -1;
+    }
+#ifdef Q_OS_MAC
+    // En bytes
+    return usage.ru_maxrss;
+#else
+    // En kilobytes
+    return static_cast<qint64>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return -1;
+#endif
+}
+
 void test_VolumePixelData::setData_WrongParametersFromArrayShouldReturn_data()
 {
     QTest::addColumn<unsigned char*>("data");
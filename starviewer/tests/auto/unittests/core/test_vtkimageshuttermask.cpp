@@ -0,0 +1,90 @@
+#include "autotest.h"
+#include "vtkimageshuttermask.h"
+
+#include "displayshutter.h"
+
+#include <vtkImageData.h>
+#include <vtkImageMask.h>
+#include <vtkSmartPointer.h>
+
+using namespace udg;
+
+class test_VtkImageShutterMask : public QObject {
+Q_OBJECT
+
+private slots:
+    void update_ShouldGiveSameResultAsVtkImageMask_data();
+    void update_ShouldGiveSameResultAsVtkImageMask();
+};
+
+Q_DECLARE_METATYPE(DisplayShutter)
+
+void test_VtkImageShutterMask::update_ShouldGiveSameResultAsVtkImageMask_data()
+{
+    QTest::addColumn<DisplayShutter>("shutter");
+    QTest::addColumn<int>("scalarType");
+    QTest::addColumn<int>("numberOfComponents");
+
+    DisplayShutter circularShutter;
+    circularShutter.setPoints(QPoint(30, 25), 20);
+    QTest::newRow("circle, RGB") << circularShutter << static_cast<int>(VTK_UNSIGNED_CHAR) << 3;
+    QTest::newRow("circle, short") << circularShutter << static_cast<int>(VTK_SHORT) << 1;
+
+    DisplayShutter polygonalShutter;
+    polygonalShutter.setPoints(QVector<QPoint>() << QPoint(-10, 5) << QPoint(70, 0) << QPoint(40, 60));
+    QTest::newRow("polygon, RGBA") << polygonalShutter << static_cast<int>(VTK_UNSIGNED_CHAR) << 4;
+
+    QTest::newRow("undefined shutter") << DisplayShutter() << static_cast<int>(VTK_UNSIGNED_CHAR) << 3;
+}
+
+void test_VtkImageShutterMask::update_ShouldGiveSameResultAsVtkImageMask()
+{
+    QFETCH(DisplayShutter, shutter);
+    QFETCH(int, scalarType);
+    QFETCH(int, numberOfComponents);
+
+    const int Width = 64;
+    const int Height = 48;
+    const int Slice = 3;
+
+    vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+    image->SetExtent(0, Width - 1, 0, Height - 1, Slice, Slice);
+    image->AllocateScalars(scalarType, numberOfComponents);
+    unsigned char *imageBytes = static_cast<unsigned char*>(image->GetScalarPointer());
+    int numberOfBytes = Width * Height * numberOfComponents * image->GetScalarSize();
+    for (int i = 0; i < numberOfBytes; ++i)
+    {
+        imageBytes[i] = static_cast<unsigned char>(i * 7 + 1);
+    }
+
+    vtkSmartPointer<vtkImageData> mask = shutter.getAsVtkImageData(Width, Height, Slice);
+
+    vtkSmartPointer<vtkImageMask> imageMask = vtkSmartPointer<vtkImageMask>::New();
+    imageMask->SetImageInputData(image);
+    imageMask->SetMaskInputData(mask);
+    imageMask->SetMaskAlpha(1.0);
+    imageMask->SetMaskedOutputValue(0);
+    imageMask->NotMaskOn();
+    imageMask->Update();
+
+    vtkSmartPointer<VtkImageShutterMask> shutterMask = vtkSmartPointer<VtkImageShutterMask>::New();
+    shutterMask->SetImageInputData(image);
+    shutterMask->SetMaskInputData(mask);
+    shutterMask->Update();
+
+    vtkImageData *expectedOutput = imageMask->GetOutput();
+    vtkImageData *output = shutterMask->GetOutput();
+
+    QCOMPARE(output->GetScalarType(), expectedOutput->GetScalarType());
+    QCOMPARE(output->GetNumberOfScalarComponents(), expectedOutput->GetNumberOfScalarComponents());
+    for (int i = 0; i < 6; ++i)
+    {
+        QCOMPARE(output->GetExtent()[i], expectedOutput->GetExtent()[i]);
+    }
+
+    QVERIFY(memcmp(output->GetScalarPointer(), expectedOutput->GetScalarPointer(), numberOfBytes) == 0);
+}
+
+DECLARE_TEST(test_VtkImageShutterMask)
+
+#include "test_vtkimageshuttermask.moc"
@@ -1,5 +1,6 @@
 SOURCES += $$PWD/test_dicommask.cpp \
            $$PWD/test_qstudytreewidget.cpp \
+           $$PWD/test_studytreemodel.cpp \
            $$PWD/test_upgradedatabasexmlparser.cpp \
            $$PWD/test_pacsdevicemanager.cpp \
            $$PWD/test_portinuse.cpp \
@@ -9,4 +10,12 @@ SOURCES += $$PWD/test_dicommask.cpp \
            $$PWD/test_dicomdirburningapplicationtest.cpp \
            $$PWD//test_pacsdevice.cpp \
            $$PWD/test_cachetest.cpp \
-           $$PWD/test_senddicomfilestopacs.cpp
+           $$PWD/test_senddicomfilestopacs.cpp \
+           $$PWD/test_relatedstudiescache.cpp \
+           $$PWD/test_relatedstudiesmanager.cpp \
+           $$PWD/test_convertdicomtolittleendian.cpp \
+           $$PWD/test_dicomanonymizer.cpp \
+           $$PWD/test_localdatabasemanager.cpp \
+           $$PWD/test_localdatabasestudydal.cpp \
+           $$PWD/test_localdatabaseimagedal.cpp \
+           $$PWD/test_converttodicomdir.cpp
@@ -0,0 +1,346 @@
+#include "autotest.h"
+#include "convertdicomtolittleendian.h"
+
+#include "status.h"
+
+#include <QAtomicInt>
+#include <QDir>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtConcurrentRun>
+
+// Make sure OS specific configuration is included first
+#include <osconfig.h>
+#include <dctk.h>
+#include <djdecode.h>
+#include <djencode.h>
+#include <djrplol.h>
+
+#include <algorithm>
+
+using namespace udg;
+
+Q_DECLARE_METATYPE(E_TransferSyntax)
+
+class test_ConvertDicomToLittleEndian : public QObject {
+Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void convert_ShouldWriteExplicitLittleEndianWithSamePixelData_data();
+    void convert_ShouldWriteExplicitLittleEndianWithSamePixelData();
+
+    void convert_ShouldCopyFilesInExplicitLittleEndianOnlyIfRequested_data();
+    void convert_ShouldCopyFilesInExplicitLittleEndianOnlyIfRequested();
+
+    void convert_ShouldReplaceExistingOutputFile();
+
+    void convert_ShouldNotLeaveAnyFileWhenItFails_data();
+    void convert_ShouldNotLeaveAnyFileWhenItFails();
+
+    void convert_Benchmark_data();
+    void convert_Benchmark();
+
+private:
+    /// Writes a size x size 12 bit image with the given transfer syntax. The pixel data depends on the seed. If withSequence is true, a sequence with
+    /// undefined length is added
+    static bool writeTestFile(const QString &filename, E_TransferSyntax transferSyntax, int size = 64, int seed = 0, bool withSequence = false);
+
+    /// Returns the pixel data of the test files
+    static QVector<Uint16> createPixelData(int size, int seed);
+
+    /// Returns the transfer syntax of the given file and its pixel data in pixelData. Returns an empty string if it can't be read
+    static QString readTestFile(const QString &filename, QVector<Uint16> &pixelData);
+
+    static QByteArray readFileContents(const QString &filename);
+
+    /// Converts the files of the list with the given number of threads, each one taking the next file until there aren't more
+    static void convertFiles(const QStringList &inputFiles, const QString &outputDirectory, int numberOfThreads);
+    static void convertFilesThread(const QStringList *inputFiles, const QString &outputDirectory, QAtomicInt *nextFile);
+};
+
+void test_ConvertDicomToLittleEndian::initTestCase()
+{
+    DJDecoderRegistration::registerCodecs();
+    DJEncoderRegistration::registerCodecs();
+}
+
+void test_ConvertDicomToLittleEndian::cleanupTestCase()
+{
+    DJEncoderRegistration::cleanup();
+}
+
+void test_ConvertDicomToLittleEndian::convert_ShouldWriteExplicitLittleEndianWithSamePixelData_data()
+{
+    QTest::addColumn<E_TransferSyntax>("sourceTransferSyntax");
+    QTest::addColumn<bool>("copyFilesInLittleEndian");
+
+    QTest::newRow("implicit little endian") << EXS_LittleEndianImplicit << false;
+    QTest::newRow("explicit big endian") << EXS_BigEndianExplicit << false;
+    QTest::newRow("explicit little endian") << EXS_LittleEndianExplicit << false;
+    QTest::newRow("explicit little endian, copy") << EXS_LittleEndianExplicit << true;
+    QTest::newRow("JPEG lossless") << EXS_JPEGProcess14SV1 << false;
+    QTest::newRow("JPEG lossless, copy") << EXS_JPEGProcess14SV1 << true;
+}
+
+void test_ConvertDicomToLittleEndian::convert_ShouldWriteExplicitLittleEndianWithSamePixelData()
+{
+    QFETCH(E_TransferSyntax, sourceTransferSyntax);
+    QFETCH(bool, copyFilesInLittleEndian);
+
+    QTemporaryDir directory;
+    QString inputFile = directory.path() + "/input";
+    QString outputFile = directory.path() + "/output";
+    QVERIFY(writeTestFile(inputFile, sourceTransferSyntax));
+
+    ConvertDicomToLittleEndian converter;
+    converter.setCopyFilesInLittleEndian(copyFilesInLittleEndian);
+    QVERIFY(converter.convert(inputFile, outputFile).good());
+
+    QVector<Uint16> pixelData;
+    QCOMPARE(readTestFile(outputFile, pixelData), QString(UID_LittleEndianExplicitTransferSyntax));
+    QCOMPARE(pixelData, createPixelData(64, 0));
+    QCOMPARE(QDir(directory.path()).entryList(QDir::Files), QStringList() << "input" << "output");
+}
+
+void test_ConvertDicomToLittleEndian::convert_ShouldCopyFilesInExplicitLittleEndianOnlyIfRequested_data()
+{
+    QTest::addColumn<bool>("copyFilesInLittleEndian");
+
+    QTest::newRow("copy") << true;
+    QTest::newRow("don't copy") << false;
+}
+
+void test_ConvertDicomToLittleEndian::convert_ShouldCopyFilesInExplicitLittleEndianOnlyIfRequested()
+{
+    QFETCH(bool, copyFilesInLittleEndian);
+
+    // The sequence of the input file has undefined length, the converted file has it with explicit length, so it's only the same if it's copied
+    QTemporaryDir directory;
+    QString inputFile = directory.path() + "/input";
+    QString outputFile = directory.path() + "/output";
+    QVERIFY(writeTestFile(inputFile, EXS_LittleEndianExplicit, 64, 0, true));
+
+    ConvertDicomToLittleEndian converter;
+    converter.setCopyFilesInLittleEndian(copyFilesInLittleEndian);
+    QVERIFY(converter.convert(inputFile, outputFile).good());
+
+    QCOMPARE(readFileContents(outputFile) == readFileContents(inputFile), copyFilesInLittleEndian);
+
+    QVector<Uint16> pixelData;
+    QCOMPARE(readTestFile(outputFile, pixelData), QString(UID_LittleEndianExplicitTransferSyntax));
+    QCOMPARE(pixelData, createPixelData(64, 0));
+}
+
+void test_ConvertDicomToLittleEndian::convert_ShouldReplaceExistingOutputFile()
+{
+    QTemporaryDir directory;
+    QString inputFile = directory.path() + "/input";
+    QString outputFile = directory.path() + "/output";
+    QVERIFY(writeTestFile(inputFile, EXS_JPEGProcess14SV1, 64, 1));
+    QVERIFY(writeTestFile(outputFile, EXS_LittleEndianExplicit, 64, 2));
+
+    QVERIFY(ConvertDicomToLittleEndian().convert(inputFile, outputFile).good());
+
+    QVector<Uint16> pixelData;
+    QCOMPARE(readTestFile(outputFile, pixelData), QString(UID_LittleEndianExplicitTransferSyntax));
+    QCOMPARE(pixelData, createPixelData(64, 1));
+}
+
+void test_ConvertDicomToLittleEndian::convert_ShouldNotLeaveAnyFileWhenItFails_data()
+{
+    QTest::addColumn<bool>("inputExists");
+    QTest::addColumn<bool>("copyFilesInLittleEndian");
+
+    QTest::newRow("input doesn't exist") << false << false;
+    QTest::newRow("input isn't DICOM") << true << false;
+    QTest::newRow("input isn't DICOM, copy") << true << true;
+}
+
+void test_ConvertDicomToLittleEndian::convert_ShouldNotLeaveAnyFileWhenItFails()
+{
+    QFETCH(bool, inputExists);
+    QFETCH(bool, copyFilesInLittleEndian);
+
+    QTemporaryDir directory;
+    QString inputFile = directory.path() + "/input";
+    QString outputFile = directory.path() + "/output";
+
+    if (inputExists)
+    {
+        QFile file(inputFile);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("This is not a DICOM file");
+    }
+
+    ConvertDicomToLittleEndian converter;
+    converter.setCopyFilesInLittleEndian(copyFilesInLittleEndian);
+    QVERIFY(!converter.convert(inputFile, outputFile).good());
+
+    QStringList expectedFiles;
+    if (inputExists)
+    {
+        expectedFiles << "input";
+    }
+    QCOMPARE(QDir(directory.path()).entryList(QDir::Files), expectedFiles);
+}
+
+void test_ConvertDicomToLittleEndian::convert_Benchmark_data()
+{
+    QTest::addColumn<int>("numberOfThreads");
+
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("one thread per core") << QThread::idealThreadCount();
+}
+
+void test_ConvertDicomToLittleEndian::convert_Benchmark()
+{
+    SKIP_BENCHMARK_UNLESS_ENABLED();
+
+    QFETCH(int, numberOfThreads);
+
+    // A series of JPEG lossless images, as the ones that take longer to burn to a CD
+    const int NumberOfFiles = 48;
+    const int Size = 512;
+
+    QTemporaryDir directory;
+    QDir(directory.path()).mkdir("output");
+    QStringList inputFiles;
+    for (int i = 0; i < NumberOfFiles; i++)
+    {
+        inputFiles << directory.path() + QString("/IMG%1").arg(i, 5, 10, QChar('0'));
+        QVERIFY(writeTestFile(inputFiles.last(), EXS_JPEGProcess14SV1, Size, i));
+    }
+
+    QBENCHMARK
+    {
+        convertFiles(inputFiles, directory.path() + "/output", numberOfThreads);
+    }
+
+    QCOMPARE(QDir(directory.path() + "/output").entryList(QDir::Files).count(), NumberOfFiles);
+
+    QVector<Uint16> pixelData;
+    QCOMPARE(readTestFile(directory.path() + "/output/IMG00007", pixelData), QString(UID_LittleEndianExplicitTransferSyntax));
+    QCOMPARE(pixelData, createPixelData(Size, 7));
+}
+
+bool test_ConvertDicomToLittleEndian::writeTestFile(const QString &filename, E_TransferSyntax transferSyntax, int size, int seed, bool withSequence)
+{
+    DcmFileFormat fileformat;
+    DcmDataset *dataset = fileformat.getDataset();
+    char uid[100];
+
+    dataset->putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage);
+    dataset->putAndInsertString(DCM_SOPInstanceUID, dcmGenerateUniqueIdentifier(uid, SITE_INSTANCE_UID_ROOT));
+    dataset->putAndInsertString(DCM_PatientName, "TEST^PATIENT");
+    dataset->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+    dataset->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+    dataset->putAndInsertUint16(DCM_Rows, size);
+    dataset->putAndInsertUint16(DCM_Columns, size);
+    dataset->putAndInsertUint16(DCM_BitsAllocated, 16);
+    dataset->putAndInsertUint16(DCM_BitsStored, 12);
+    dataset->putAndInsertUint16(DCM_HighBit, 11);
+    dataset->putAndInsertUint16(DCM_PixelRepresentation, 0);
+
+    if (withSequence)
+    {
+        DcmItem *item = 0;
+        dataset->findOrCreateSequenceItem(DCM_ReferencedImageSequence, item);
+        item->putAndInsertString(DCM_ReferencedSOPClassUID, UID_SecondaryCaptureImageStorage);
+        item->putAndInsertString(DCM_ReferencedSOPInstanceUID, dcmGenerateUniqueIdentifier(uid, SITE_INSTANCE_UID_ROOT));
+    }
+
+    QVector<Uint16> pixelData = createPixelData(size, seed);
+    dataset->putAndInsertUint16Array(DCM_PixelData, pixelData.constData(), pixelData.count());
+
+    if (DcmXfer(transferSyntax).isEncapsulated())
+    {
+        DJ_RPLossless parameters;
+        if (dataset->chooseRepresentation(transferSyntax, &parameters).bad() || !dataset->canWriteXfer(transferSyntax))
+        {
+            return false;
+        }
+    }
+
+    return fileformat.saveFile(qPrintable(filename), transferSyntax, EET_UndefinedLength).good();
+}
+
+QVector<Uint16> test_ConvertDicomToLittleEndian::createPixelData(int size, int seed)
+{
+    // A smooth gradient with some noise, so that the JPEG compression has some work to do
+    QVector<Uint16> pixelData(size * size);
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            pixelData[y * size + x] = static_cast<Uint16>((x * 7 + y * 13 + seed * 31 + (x * y + seed) % 17) & 0x0FFF);
+        }
+    }
+
+    return pixelData;
+}
+
+QString test_ConvertDicomToLittleEndian::readTestFile(const QString &filename, QVector<Uint16> &pixelData)
+{
+    DcmFileFormat fileformat;
+    if (fileformat.loadFile(qPrintable(filename)).bad())
+    {
+        return QString();
+    }
+
+    OFString transferSyntaxUID;
+    fileformat.getMetaInfo()->findAndGetOFString(DCM_TransferSyntaxUID, transferSyntaxUID);
+
+    const Uint16 *values = 0;
+    unsigned long count = 0;
+    if (fileformat.getDataset()->findAndGetUint16Array(DCM_PixelData, values, &count).bad())
+    {
+        return QString();
+    }
+
+    pixelData.resize(count);
+    std::copy(values, values + count, pixelData.begin());
+
+    return QString(transferSyntaxUID.c_str());
+}
+
+QByteArray test_ConvertDicomToLittleEndian::readFileContents(const QString &filename)
+{
+    QFile file(filename);
+    file.open(QIODevice::ReadOnly);
+
+    return file.readAll();
+}
+
+void test_ConvertDicomToLittleEndian::convertFiles(const QStringList &inputFiles, const QString &outputDirectory, int numberOfThreads)
+{
+    QAtomicInt nextFile(0);
+    QList<QFuture<void> > threads;
+    for (int i = 0; i < numberOfThreads; i++)
+    {
+        threads << QtConcurrent::run(convertFilesThread, &inputFiles, outputDirectory, &nextFile);
+    }
+
+    foreach (QFuture<void> thread, threads)
+    {
+        thread.waitForFinished();
+    }
+}
+
+void test_ConvertDicomToLittleEndian::convertFilesThread(const QStringList *inputFiles, const QString &outputDirectory, QAtomicInt *nextFile)
+{
+    int index = nextFile->fetchAndAddOrdered(1);
+    while (index < inputFiles->count())
+    {
+        const QString &inputFile = inputFiles->at(index);
+        ConvertDicomToLittleEndian().convert(inputFile, outputDirectory + "/" + QFileInfo(inputFile).fileName());
+        index = nextFile->fetchAndAddOrdered(1);
+    }
+}
+
+DECLARE_TEST(test_ConvertDicomToLittleEndian)
+
+#include "test_convertdicomtolittleendian.moc"
@@ -0,0 +1,244 @@
+#include "autotest.h"
+#include "converttodicomdir.h"
+
+#include "testingconverttodicomdir.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QTemporaryDir>
+
+// Make sure OS specific configuration is included first
+#include <osconfig.h>
+#include <dctk.h>
+#include <djdecode.h>
+#include <djencode.h>
+#include <djrplol.h>
+
+using namespace udg;
+using namespace testing;
+
+Q_DECLARE_METATYPE(E_TransferSyntax)
+
+class test_ConvertToDicomdir : public QObject {
+Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void convert_ShouldCopyImagesWithDicomdirNamesAndCreateDicomdir_data();
+    void convert_ShouldCopyImagesWithDicomdirNamesAndCreateDicomdir();
+
+private:
+    /// Writes a small image of the given patient, study and series with the given transfer syntax
+    static bool writeTestFile(const QString &filename, E_TransferSyntax transferSyntax, const QString &patientID, const QString &studyUID,
+                              const QString &seriesUID, int instanceNumber);
+
+    /// Returns the SOP Instance UID and the transfer syntax of the given file. Returns an empty UID if it can't be read
+    static QString readTestFile(const QString &filename, E_TransferSyntax &transferSyntax);
+
+    static QByteArray readFileContents(const QString &filename);
+};
+
+void test_ConvertToDicomdir::initTestCase()
+{
+    DJDecoderRegistration::registerCodecs();
+    DJEncoderRegistration::registerCodecs();
+}
+
+void test_ConvertToDicomdir::cleanupTestCase()
+{
+    DJEncoderRegistration::cleanup();
+}
+
+void test_ConvertToDicomdir::convert_ShouldCopyImagesWithDicomdirNamesAndCreateDicomdir_data()
+{
+    QTest::addColumn<E_TransferSyntax>("sourceTransferSyntax");
+    QTest::addColumn<bool>("convertToLittleEndian");
+
+    QTest::newRow("copy") << EXS_LittleEndianExplicit << false;
+    QTest::newRow("copy of compressed images") << EXS_JPEGProcess14SV1 << false;
+    QTest::newRow("conversion to little endian") << EXS_JPEGProcess14SV1 << true;
+}
+
+void test_ConvertToDicomdir::convert_ShouldCopyImagesWithDicomdirNamesAndCreateDicomdir()
+{
+    QFETCH(E_TransferSyntax, sourceTransferSyntax);
+    QFETCH(bool, convertToLittleEndian);
+
+    QTemporaryDir sourceDirectory;
+    QTemporaryDir dicomdirDirectory;
+    QVERIFY(sourceDirectory.isValid());
+    QVERIFY(dicomdirDirectory.isValid());
+
+    // Patient B is added first but patient A has to be in PAT00000, and its studies keep the order in which they are added.
+    // There are enough images to keep all the copy threads busy
+    QStringList patientIDs;
+    patientIDs << "B" << "A" << "A";
+    QList<QList<int> > imagesPerSeriesPerStudy;
+    imagesPerSeriesPerStudy << (QList<int>() << 5 << 5 << 5) << (QList<int>() << 4 << 4) << (QList<int>() << 3);
+
+    TestingConvertToDicomdir convertToDicomdir;
+    convertToDicomdir.setConvertDicomdirImagesToLittleEndian(convertToLittleEndian);
+
+    QMap<QString, QList<QList<QStringList> > > sourceFilesPerPatient;
+    char uid[100];
+
+    for (int studyIndex = 0; studyIndex < patientIDs.count(); studyIndex++)
+    {
+        QString studyUID = dcmGenerateUniqueIdentifier(uid, SITE_STUDY_UID_ROOT);
+        QList<QStringList> seriesFiles;
+
+        for (int seriesIndex = 0; seriesIndex < imagesPerSeriesPerStudy.at(studyIndex).count(); seriesIndex++)
+        {
+            QString seriesUID = dcmGenerateUniqueIdentifier(uid, SITE_SERIES_UID_ROOT);
+            QStringList files;
+
+            for (int imageIndex = 0; imageIndex < imagesPerSeriesPerStudy.at(studyIndex).at(seriesIndex); imageIndex++)
+            {
+                QString file = sourceDirectory.path() + QString("/%1_%2_%3.dcm").arg(studyIndex).arg(seriesIndex).arg(imageIndex);
+                QVERIFY(writeTestFile(file, sourceTransferSyntax, patientIDs.at(studyIndex), studyUID, seriesUID, imageIndex + 1));
+                files << file;
+            }
+
+            seriesFiles << files;
+        }
+
+        convertToDicomdir.addTestingStudy(patientIDs.at(studyIndex), studyUID, seriesFiles);
+        convertToDicomdir.addStudy(studyUID);
+        sourceFilesPerPatient[patientIDs.at(studyIndex)] << seriesFiles;
+    }
+
+    Status state = convertToDicomdir.convert(dicomdirDirectory.path(), CreateDicomdir::HardDisk, false);
+
+    // 4001 means that the DICOMDIR has been created in non strict mode, but it can be used
+    QVERIFY2(state.good() || state.code() == 4001, qPrintable(state.text()));
+    QVERIFY(QFile::exists(dicomdirDirectory.path() + "/DICOMDIR"));
+
+    int numberOfSourceFiles = 0;
+    QStringList sortedPatientIDs = sourceFilesPerPatient.keys();
+    for (int patientIndex = 0; patientIndex < sortedPatientIDs.count(); patientIndex++)
+    {
+        const QList<QList<QStringList> > &studies = sourceFilesPerPatient[sortedPatientIDs.at(patientIndex)];
+        for (int studyIndex = 0; studyIndex < studies.count(); studyIndex++)
+        {
+            for (int seriesIndex = 0; seriesIndex < studies.at(studyIndex).count(); seriesIndex++)
+            {
+                const QStringList &files = studies.at(studyIndex).at(seriesIndex);
+                for (int imageIndex = 0; imageIndex < files.count(); imageIndex++)
+                {
+                    QString copiedFile = dicomdirDirectory.path() + QString("/DICOM/PAT%1/STU%2/SER%3/IMG%4").arg(patientIndex, 5, 10, QChar('0'))
+                        .arg(studyIndex, 5, 10, QChar('0')).arg(seriesIndex, 5, 10, QChar('0')).arg(imageIndex + 1, 5, 10, QChar('0'));
+                    QVERIFY2(QFile::exists(copiedFile), qPrintable(copiedFile));
+
+                    if (convertToLittleEndian)
+                    {
+                        E_TransferSyntax sourceFileTransferSyntax, copiedFileTransferSyntax;
+                        QCOMPARE(readTestFile(copiedFile, copiedFileTransferSyntax), readTestFile(files.at(imageIndex), sourceFileTransferSyntax));
+                        QVERIFY(copiedFileTransferSyntax == EXS_LittleEndianExplicit);
+                    }
+                    else
+                    {
+                        QVERIFY(readFileContents(copiedFile) == readFileContents(files.at(imageIndex)));
+                    }
+
+                    numberOfSourceFiles++;
+                }
+            }
+        }
+    }
+
+    int numberOfCopiedFiles = 0;
+    QDirIterator iterator(dicomdirDirectory.path() + "/DICOM", QDir::Files, QDirIterator::Subdirectories);
+    while (iterator.hasNext())
+    {
+        iterator.next();
+        numberOfCopiedFiles++;
+    }
+
+    QCOMPARE(numberOfCopiedFiles, numberOfSourceFiles);
+}
+
+bool test_ConvertToDicomdir::writeTestFile(const QString &filename, E_TransferSyntax transferSyntax, const QString &patientID,
+                                           const QString &studyUID, const QString &seriesUID, int instanceNumber)
+{
+    const int Size = 16;
+
+    DcmFileFormat fileformat;
+    DcmDataset *dataset = fileformat.getDataset();
+    char uid[100];
+
+    dataset->putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage);
+    dataset->putAndInsertString(DCM_SOPInstanceUID, dcmGenerateUniqueIdentifier(uid, SITE_INSTANCE_UID_ROOT));
+    dataset->putAndInsertString(DCM_PatientID, qPrintable(patientID));
+    dataset->putAndInsertString(DCM_PatientName, qPrintable("TEST^" + patientID));
+    dataset->putAndInsertString(DCM_StudyInstanceUID, qPrintable(studyUID));
+    dataset->putAndInsertString(DCM_StudyID, "1");
+    dataset->putAndInsertString(DCM_StudyDate, "20140101");
+    dataset->putAndInsertString(DCM_StudyTime, "120000");
+    dataset->putAndInsertString(DCM_StudyDescription, "TEST");
+    dataset->putAndInsertString(DCM_AccessionNumber, "");
+    dataset->putAndInsertString(DCM_SeriesInstanceUID, qPrintable(seriesUID));
+    dataset->putAndInsertString(DCM_SeriesNumber, "1");
+    dataset->putAndInsertString(DCM_Modality, "OT");
+    dataset->putAndInsertString(DCM_ConversionType, "WSD");
+    dataset->putAndInsertString(DCM_InstanceNumber, qPrintable(QString::number(instanceNumber)));
+    dataset->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+    dataset->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+    dataset->putAndInsertUint16(DCM_Rows, Size);
+    dataset->putAndInsertUint16(DCM_Columns, Size);
+    dataset->putAndInsertUint16(DCM_BitsAllocated, 16);
+    dataset->putAndInsertUint16(DCM_BitsStored, 12);
+    dataset->putAndInsertUint16(DCM_HighBit, 11);
+    dataset->putAndInsertUint16(DCM_PixelRepresentation, 0);
+
+    QVector<Uint16> pixelData(Size * Size);
+    for (int i = 0; i < pixelData.count(); i++)
+    {
+        pixelData[i] = (i * 7 + instanceNumber * 13) % 4096;
+    }
+    dataset->putAndInsertUint16Array(DCM_PixelData, pixelData.constData(), pixelData.count());
+
+    if (DcmXfer(transferSyntax).isEncapsulated())
+    {
+        DJ_RPLossless parameters;
+        if (dataset->chooseRepresentation(transferSyntax, &parameters).bad() || !dataset->canWriteXfer(transferSyntax))
+        {
+            return false;
+        }
+    }
+
+    return fileformat.saveFile(qPrintable(filename), transferSyntax).good();
+}
+
+QString test_ConvertToDicomdir::readTestFile(const QString &filename, E_TransferSyntax &transferSyntax)
+{
+    DcmFileFormat fileformat;
+    if (fileformat.loadFile(qPrintable(filename)).bad())
+    {
+        return QString();
+    }
+
+    transferSyntax = fileformat.getDataset()->getOriginalXfer();
+
+    OFString sopInstanceUID;
+    fileformat.getDataset()->findAndGetOFString(DCM_SOPInstanceUID, sopInstanceUID);
+
+    return QString(sopInstanceUID.c_str());
+}
+
+QByteArray test_ConvertToDicomdir::readFileContents(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QByteArray();
+    }
+
+    return file.readAll();
+}
+
+DECLARE_TEST(test_ConvertToDicomdir)
+
+#include "test_converttodicomdir.moc"
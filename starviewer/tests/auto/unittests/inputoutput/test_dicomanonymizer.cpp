@@ -0,0 +1,395 @@
+#include "autotest.h"
+#include "dicomanonymizer.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <gdcmReader.h>
+
+// Make sure OS specific configuration is included first
+#include <osconfig.h>
+#include <dctk.h>
+#include <djdecode.h>
+#include <djencode.h>
+#include <djrplol.h>
+
+using namespace udg;
+
+Q_DECLARE_METATYPE(E_TransferSyntax)
+
+class TestingDICOMAnonymizer : public DICOMAnonymizer {
+public:
+    using DICOMAnonymizer::StreamingResult;
+    using DICOMAnonymizer::StreamingOk;
+    using DICOMAnonymizer::StreamingFailed;
+    using DICOMAnonymizer::StreamingNotPossible;
+
+    using DICOMAnonymizer::anonymizeDICOMFileStreaming;
+    using DICOMAnonymizer::findPixelDataEnd;
+    using DICOMAnonymizer::appendFileBytes;
+};
+
+class test_DICOMAnonymizer : public QObject {
+Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void findPixelDataEnd_ShouldReturnEndOfFile_data();
+    void findPixelDataEnd_ShouldReturnEndOfFile();
+
+    void findPixelDataEnd_ShouldReturnFalseWithTruncatedFile_data();
+    void findPixelDataEnd_ShouldReturnFalseWithTruncatedFile();
+
+    void appendFileBytes_ShouldAppendGivenBytesToOutput_data();
+    void appendFileBytes_ShouldAppendGivenBytesToOutput();
+
+    void anonymizeDICOMFileStreaming_ShouldAnonymizeHeaderAndCopyPixelData_data();
+    void anonymizeDICOMFileStreaming_ShouldAnonymizeHeaderAndCopyPixelData();
+
+    void anonymizeDICOMFileStreaming_ShouldNotWriteAnythingWithTruncatedFile_data();
+    void anonymizeDICOMFileStreaming_ShouldNotWriteAnythingWithTruncatedFile();
+
+    void anonymyzeDICOMFilesDirectory_ShouldAnonymizeAllFilesConsistently();
+
+    void anonymizeDICOMFile_Benchmark_data();
+    void anonymizeDICOMFile_Benchmark();
+
+private:
+    /// Writes a size x size 16 bit image of the given study with the given transfer syntax. Pixel Data has defined length unless the transfer syntax
+    /// is encapsulated
+    static bool writeTestFile(const QString &filename, E_TransferSyntax transferSyntax, int size = 64, const QString &studyInstanceUID = "1.2.3.4");
+
+    /// Returns the position of the Pixel Data element of the given file as read by gdcm, or -1 if it can't be read
+    static qint64 getPixelDataStart(const QString &filename, gdcm::TransferSyntax &transferSyntax);
+
+    /// Returns the value of the given tag of the given file, or an empty string if it can't be read
+    static QString readTagValue(const QString &filename, const DcmTagKey &tag);
+
+    static QByteArray readFileContents(const QString &filename);
+    static bool truncateFile(const QString &filename, qint64 bytes);
+};
+
+void test_DICOMAnonymizer::initTestCase()
+{
+    DJDecoderRegistration::registerCodecs();
+    DJEncoderRegistration::registerCodecs();
+}
+
+void test_DICOMAnonymizer::cleanupTestCase()
+{
+    DJEncoderRegistration::cleanup();
+    DJDecoderRegistration::cleanup();
+}
+
+void test_DICOMAnonymizer::findPixelDataEnd_ShouldReturnEndOfFile_data()
+{
+    QTest::addColumn<E_TransferSyntax>("transferSyntax");
+
+    QTest::newRow("defined length, explicit little endian") << EXS_LittleEndianExplicit;
+    QTest::newRow("defined length, implicit little endian") << EXS_LittleEndianImplicit;
+    QTest::newRow("defined length, explicit big endian") << EXS_BigEndianExplicit;
+    QTest::newRow("undefined length, JPEG lossless") << EXS_JPEGProcess14SV1;
+}
+
+void test_DICOMAnonymizer::findPixelDataEnd_ShouldReturnEndOfFile()
+{
+    QFETCH(E_TransferSyntax, transferSyntax);
+
+    QTemporaryDir directory;
+    QString filename = directory.path() + "/image";
+    QVERIFY(writeTestFile(filename, transferSyntax));
+
+    gdcm::TransferSyntax gdcmTransferSyntax;
+    qint64 pixelDataStart = getPixelDataStart(filename, gdcmTransferSyntax);
+    QVERIFY(pixelDataStart > 0);
+
+    qint64 pixelDataEnd = -1;
+    QVERIFY(TestingDICOMAnonymizer::findPixelDataEnd(filename, gdcmTransferSyntax, pixelDataStart, pixelDataEnd));
+    QCOMPARE(pixelDataEnd, QFileInfo(filename).size());
+}
+
+void test_DICOMAnonymizer::findPixelDataEnd_ShouldReturnFalseWithTruncatedFile_data()
+{
+    findPixelDataEnd_ShouldReturnEndOfFile_data();
+}
+
+void test_DICOMAnonymizer::findPixelDataEnd_ShouldReturnFalseWithTruncatedFile()
+{
+    QFETCH(E_TransferSyntax, transferSyntax);
+
+    QTemporaryDir directory;
+    QString filename = directory.path() + "/image";
+    QVERIFY(writeTestFile(filename, transferSyntax));
+
+    gdcm::TransferSyntax gdcmTransferSyntax;
+    qint64 pixelDataStart = getPixelDataStart(filename, gdcmTransferSyntax);
+    QVERIFY(pixelDataStart > 0);
+
+    // The last bytes of Pixel Data, and the sequence delimiter if it has undefined length, are lost
+    QVERIFY(truncateFile(filename, 10));
+
+    qint64 pixelDataEnd;
+    QVERIFY(!TestingDICOMAnonymizer::findPixelDataEnd(filename, gdcmTransferSyntax, pixelDataStart, pixelDataEnd));
+}
+
+void test_DICOMAnonymizer::appendFileBytes_ShouldAppendGivenBytesToOutput_data()
+{
+    QTest::addColumn<int>("start");
+    QTest::addColumn<int>("end");
+
+    QTest::newRow("nothing") << 100 << 100;
+    QTest::newRow("less than a block") << 100 << 5000;
+    QTest::newRow("several blocks") << 3 << 3 * 1024 * 1024 + 17;
+}
+
+void test_DICOMAnonymizer::appendFileBytes_ShouldAppendGivenBytesToOutput()
+{
+    QFETCH(int, start);
+    QFETCH(int, end);
+
+    QTemporaryDir directory;
+    QString inputFile = directory.path() + "/input";
+    QString outputFile = directory.path() + "/output";
+
+    QByteArray inputContents(4 * 1024 * 1024, 0);
+    for (int i = 0; i < inputContents.size(); i++)
+    {
+        inputContents[i] = static_cast<char>(i * 31 + i / 251);
+    }
+
+    QFile input(inputFile);
+    QVERIFY(input.open(QIODevice::WriteOnly));
+    QCOMPARE(input.write(inputContents), static_cast<qint64>(inputContents.size()));
+    input.close();
+
+    QFile output(outputFile);
+    QVERIFY(output.open(QIODevice::WriteOnly));
+    output.write("header");
+    output.close();
+
+    QVERIFY(TestingDICOMAnonymizer::appendFileBytes(inputFile, start, end, outputFile));
+
+    QCOMPARE(readFileContents(outputFile), QByteArray("header") + inputContents.mid(start, end - start));
+}
+
+void test_DICOMAnonymizer::anonymizeDICOMFileStreaming_ShouldAnonymizeHeaderAndCopyPixelData_data()
+{
+    QTest::addColumn<E_TransferSyntax>("transferSyntax");
+    QTest::addColumn<bool>("inPlace");
+
+    QTest::newRow("defined length") << EXS_LittleEndianExplicit << false;
+    QTest::newRow("defined length, in place") << EXS_LittleEndianExplicit << true;
+    QTest::newRow("defined length, big endian") << EXS_BigEndianExplicit << false;
+    QTest::newRow("undefined length") << EXS_JPEGProcess14SV1 << false;
+    QTest::newRow("undefined length, in place") << EXS_JPEGProcess14SV1 << true;
+}
+
+void test_DICOMAnonymizer::anonymizeDICOMFileStreaming_ShouldAnonymizeHeaderAndCopyPixelData()
+{
+    QFETCH(E_TransferSyntax, transferSyntax);
+    QFETCH(bool, inPlace);
+
+    QTemporaryDir directory;
+    QString inputFile = directory.path() + "/input";
+    QString outputFile = inPlace ? inputFile : directory.path() + "/output";
+    QVERIFY(writeTestFile(inputFile, transferSyntax));
+
+    gdcm::TransferSyntax gdcmTransferSyntax;
+    qint64 pixelDataStart = getPixelDataStart(inputFile, gdcmTransferSyntax);
+    QVERIFY(pixelDataStart > 0);
+    QByteArray pixelDataElement = readFileContents(inputFile).mid(pixelDataStart);
+
+    TestingDICOMAnonymizer anonymizer;
+    anonymizer.setPatientNameAnonymized("ANONYMIZED");
+    QCOMPARE(anonymizer.anonymizeDICOMFileStreaming(inputFile, outputFile), TestingDICOMAnonymizer::StreamingOk);
+
+    QCOMPARE(readTagValue(outputFile, DCM_PatientName), QString("ANONYMIZED"));
+    QVERIFY(readTagValue(outputFile, DCM_StudyInstanceUID) != "1.2.3.4");
+    QVERIFY(readFileContents(outputFile).endsWith(pixelDataElement));
+    QCOMPARE(QDir(directory.path()).entryList(QDir::Files).count(), inPlace ? 1 : 2);
+}
+
+void test_DICOMAnonymizer::anonymizeDICOMFileStreaming_ShouldNotWriteAnythingWithTruncatedFile_data()
+{
+    QTest::addColumn<E_TransferSyntax>("transferSyntax");
+
+    QTest::newRow("defined length") << EXS_LittleEndianExplicit;
+    QTest::newRow("undefined length") << EXS_JPEGProcess14SV1;
+}
+
+void test_DICOMAnonymizer::anonymizeDICOMFileStreaming_ShouldNotWriteAnythingWithTruncatedFile()
+{
+    QFETCH(E_TransferSyntax, transferSyntax);
+
+    QTemporaryDir directory;
+    QString inputFile = directory.path() + "/input";
+    QString outputFile = directory.path() + "/output";
+    QVERIFY(writeTestFile(inputFile, transferSyntax));
+    QVERIFY(truncateFile(inputFile, 10));
+
+    TestingDICOMAnonymizer anonymizer;
+    QCOMPARE(anonymizer.anonymizeDICOMFileStreaming(inputFile, outputFile), TestingDICOMAnonymizer::StreamingNotPossible);
+    QVERIFY(!QFile::exists(outputFile));
+}
+
+void test_DICOMAnonymizer::anonymyzeDICOMFilesDirectory_ShouldAnonymizeAllFilesConsistently()
+{
+    // Enough files for all the threads to anonymize several of them at the same time, from two studies
+    const int NumberOfFiles = 64;
+
+    QTemporaryDir directory;
+    QStringList files;
+    for (int i = 0; i < NumberOfFiles; i++)
+    {
+        files << directory.path() + QString("/IMG%1").arg(i, 5, 10, QChar('0'));
+        QVERIFY(writeTestFile(files.last(), i % 3 == 0 ? EXS_JPEGProcess14SV1 : EXS_LittleEndianExplicit, 64, i % 2 == 0 ? "1.2.3.4" : "1.2.3.5"));
+    }
+
+    DICOMAnonymizer anonymizer;
+    anonymizer.setPatientNameAnonymized("ANONYMIZED");
+    anonymizer.setReplaceStudyIDInsteadOfRemove(true);
+    QVERIFY(anonymizer.anonymyzeDICOMFilesDirectory(directory.path()));
+
+    QCOMPARE(QDir(directory.path()).entryList(QDir::Files).count(), NumberOfFiles);
+
+    QString firstStudyInstanceUID = readTagValue(files.at(0), DCM_StudyInstanceUID);
+    QString secondStudyInstanceUID = readTagValue(files.at(1), DCM_StudyInstanceUID);
+    QVERIFY(!firstStudyInstanceUID.isEmpty());
+    QVERIFY(firstStudyInstanceUID != "1.2.3.4");
+    QVERIFY(firstStudyInstanceUID != secondStudyInstanceUID);
+
+    for (int i = 0; i < NumberOfFiles; i++)
+    {
+        QCOMPARE(readTagValue(files.at(i), DCM_PatientName), QString("ANONYMIZED"));
+        QCOMPARE(readTagValue(files.at(i), DCM_StudyInstanceUID), i % 2 == 0 ? firstStudyInstanceUID : secondStudyInstanceUID);
+    }
+}
+
+void test_DICOMAnonymizer::anonymizeDICOMFile_Benchmark_data()
+{
+    QTest::addColumn<bool>("streamingModeEnabled");
+
+    QTest::newRow("in memory") << false;
+    QTest::newRow("streaming") << true;
+}
+
+void test_DICOMAnonymizer::anonymizeDICOMFile_Benchmark()
+{
+    SKIP_BENCHMARK_UNLESS_ENABLED();
+
+    QFETCH(bool, streamingModeEnabled);
+
+    // Each iteration anonymizes all the files of a 512x512 series
+    const int NumberOfFiles = 48;
+    const int Size = 512;
+
+    QTemporaryDir directory;
+    QDir(directory.path()).mkdir("output");
+    QStringList inputFiles;
+    for (int i = 0; i < NumberOfFiles; i++)
+    {
+        inputFiles << directory.path() + QString("/IMG%1").arg(i, 5, 10, QChar('0'));
+        QVERIFY(writeTestFile(inputFiles.last(), EXS_LittleEndianExplicit, Size));
+    }
+
+    DICOMAnonymizer anonymizer;
+    anonymizer.setStreamingModeEnabled(streamingModeEnabled);
+
+    QBENCHMARK
+    {
+        foreach (const QString &inputFile, inputFiles)
+        {
+            anonymizer.anonymizeDICOMFile(inputFile, directory.path() + "/output/" + QFileInfo(inputFile).fileName());
+        }
+    }
+
+    QCOMPARE(QDir(directory.path() + "/output").entryList(QDir::Files).count(), NumberOfFiles);
+}
+
+bool test_DICOMAnonymizer::writeTestFile(const QString &filename, E_TransferSyntax transferSyntax, int size, const QString &studyInstanceUID)
+{
+    DcmFileFormat fileformat;
+    DcmDataset *dataset = fileformat.getDataset();
+    char uid[100];
+
+    dataset->putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage);
+    dataset->putAndInsertString(DCM_SOPInstanceUID, dcmGenerateUniqueIdentifier(uid, SITE_INSTANCE_UID_ROOT));
+    dataset->putAndInsertString(DCM_StudyInstanceUID, qPrintable(studyInstanceUID));
+    dataset->putAndInsertString(DCM_SeriesInstanceUID, qPrintable(studyInstanceUID + ".1"));
+    dataset->putAndInsertString(DCM_PatientName, "TEST^PATIENT");
+    dataset->putAndInsertString(DCM_PatientID, "12345");
+    dataset->putAndInsertString(DCM_Modality, "OT");
+    dataset->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+    dataset->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+    dataset->putAndInsertUint16(DCM_Rows, size);
+    dataset->putAndInsertUint16(DCM_Columns, size);
+    dataset->putAndInsertUint16(DCM_BitsAllocated, 16);
+    dataset->putAndInsertUint16(DCM_BitsStored, 12);
+    dataset->putAndInsertUint16(DCM_HighBit, 11);
+    dataset->putAndInsertUint16(DCM_PixelRepresentation, 0);
+
+    QVector<Uint16> pixelData(size * size);
+    for (int i = 0; i < pixelData.count(); i++)
+    {
+        pixelData[i] = static_cast<Uint16>((i * 7 + i / size * 13) & 0x0FFF);
+    }
+    dataset->putAndInsertUint16Array(DCM_PixelData, pixelData.constData(), pixelData.count());
+
+    if (DcmXfer(transferSyntax).isEncapsulated())
+    {
+        DJ_RPLossless parameters;
+        if (dataset->chooseRepresentation(transferSyntax, &parameters).bad() || !dataset->canWriteXfer(transferSyntax))
+        {
+            return false;
+        }
+    }
+
+    return fileformat.saveFile(qPrintable(filename), transferSyntax).good();
+}
+
+qint64 test_DICOMAnonymizer::getPixelDataStart(const QString &filename, gdcm::TransferSyntax &transferSyntax)
+{
+    gdcm::Reader reader;
+    reader.SetFileName(qPrintable(filename));
+    if (!reader.ReadUpToTag(gdcm::Tag(0x7fe0, 0x0010)))
+    {
+        return -1;
+    }
+
+    transferSyntax = reader.GetFile().GetHeader().GetDataSetTransferSyntax();
+    return reader.GetStreamCurrentPosition();
+}
+
+QString test_DICOMAnonymizer::readTagValue(const QString &filename, const DcmTagKey &tag)
+{
+    DcmFileFormat fileformat;
+    OFString value;
+    if (fileformat.loadFile(qPrintable(filename)).bad() || fileformat.getDataset()->findAndGetOFString(tag, value).bad())
+    {
+        return QString();
+    }
+
+    return QString(value.c_str());
+}
+
+QByteArray test_DICOMAnonymizer::readFileContents(const QString &filename)
+{
+    QFile file(filename);
+    file.open(QIODevice::ReadOnly);
+
+    return file.readAll();
+}
+
+bool test_DICOMAnonymizer::truncateFile(const QString &filename, qint64 bytes)
+{
+    QFile file(filename);
+    return file.resize(file.size() - bytes);
+}
+
+DECLARE_TEST(test_DICOMAnonymizer)
+
+#include "test_dicomanonymizer.moc"
@@ -0,0 +1,205 @@
+#include "autotest.h"
+#include "localdatabaseimagedal.h"
+
+#include "databaseconnection.h"
+#include "dicommask.h"
+#include "localdatabasepatientdal.h"
+#include "localdatabaseseriesdal.h"
+#include "localdatabasestudydal.h"
+#include "patient.h"
+#include "patienttesthelper.h"
+#include "series.h"
+#include "study.h"
+
+#include <QFile>
+#include <QHash>
+#include <QTemporaryDir>
+
+#include <sqlite3.h>
+
+using namespace udg;
+using namespace testing;
+
+class test_LocalDatabaseImageDAL : public QObject {
+Q_OBJECT
+
+private slots:
+    void insert_ShouldSaveStudyThatCanBeReadBack();
+
+    void insert_ShouldFailWithConstraintErrorWhenImageIsAlreadyInserted();
+
+private:
+    /// Creates the database tables with the same script used by DatabaseInstallation
+    static bool createDatabase(DatabaseConnection *databaseConnection);
+
+    /// Inserts the patient and all its studies, series and images in a single transaction like LocalDatabaseManager does
+    static int insertPatient(DatabaseConnection *databaseConnection, Patient *patient);
+};
+
+void test_LocalDatabaseImageDAL::insert_ShouldSaveStudyThatCanBeReadBack()
+{
+    QTemporaryDir directory;
+    DatabaseConnection databaseConnection;
+    databaseConnection.setDatabasePath(directory.path() + "/database.sdb");
+    QVERIFY(createDatabase(&databaseConnection));
+
+    Patient *patient = PatientTestHelper::create(1, 1, 5);
+    patient->setFullName("GARCIA^JOAN");
+    Study *study = patient->getStudies().first();
+    study->setInstanceUID("1.2.3");
+    study->setDescription("TC abdomen");
+    Series *series = study->getSeries().first();
+    series->setInstanceUID("1.2.3.4");
+    series->setModality("CT");
+
+    for (int i = 0; i < series->getImages().count(); i++)
+    {
+        Image *image = series->getImageByIndex(i);
+        image->setSOPInstanceUID(QString("1.2.3.4.%1").arg(i));
+        image->setInstanceNumber(QString::number(i + 1));
+        image->setRows(512);
+        image->setColumns(256 + i);
+        image->setPixelSpacing(0.5, 0.75);
+        image->setSliceThickness(2.5);
+        double position[3] = { 10.0, -20.0, 2.5 * i };
+        image->setImagePositionPatient(position);
+    }
+
+    QCOMPARE(insertPatient(&databaseConnection, patient), SQLITE_OK);
+
+    DicomMask studyMask;
+    studyMask.setStudyInstanceUID("1.2.3");
+    QList<Study*> studies = LocalDatabaseStudyDAL(&databaseConnection).query(studyMask);
+    QCOMPARE(studies.count(), 1);
+    QCOMPARE(studies.first()->getDescription(), study->getDescription());
+
+    DicomMask imageMask;
+    imageMask.setStudyInstanceUID("1.2.3");
+    imageMask.setSeriesInstanceUID("1.2.3.4");
+    LocalDatabaseImageDAL imageDAL(&databaseConnection);
+    QList<Image*> images = imageDAL.query(imageMask);
+    QCOMPARE(imageDAL.getLastError(), SQLITE_OK);
+    QCOMPARE(images.count(), series->getImages().count());
+
+    QHash<QString, Image*> insertedImages;
+    foreach (Image *image, series->getImages())
+    {
+        insertedImages.insert(image->getSOPInstanceUID(), image);
+    }
+
+    foreach (Image *image, images)
+    {
+        Image *insertedImage = insertedImages.value(image->getSOPInstanceUID());
+        QVERIFY2(insertedImage, qPrintable(image->getSOPInstanceUID()));
+        QCOMPARE(image->getInstanceNumber(), insertedImage->getInstanceNumber());
+        QCOMPARE(image->getRows(), insertedImage->getRows());
+        QCOMPARE(image->getColumns(), insertedImage->getColumns());
+        QVERIFY(image->getPixelSpacing().isEqual(insertedImage->getPixelSpacing()));
+        QCOMPARE(image->getSliceThickness(), insertedImage->getSliceThickness());
+        QCOMPARE(image->getImagePositionPatient()[2], insertedImage->getImagePositionPatient()[2]);
+    }
+
+    qDeleteAll(images);
+    qDeleteAll(studies);
+    delete patient;
+}
+
+void test_LocalDatabaseImageDAL::insert_ShouldFailWithConstraintErrorWhenImageIsAlreadyInserted()
+{
+    // LocalDatabaseManager relies on this error to update the images that are already in the database
+    QTemporaryDir directory;
+    DatabaseConnection databaseConnection;
+    databaseConnection.setDatabasePath(directory.path() + "/database.sdb");
+    QVERIFY(createDatabase(&databaseConnection));
+
+    Patient *patient = PatientTestHelper::create(1, 1, 2);
+    QCOMPARE(insertPatient(&databaseConnection, patient), SQLITE_OK);
+
+    LocalDatabaseImageDAL imageDAL(&databaseConnection);
+    Series *series = patient->getStudies().first()->getSeries().first();
+
+    imageDAL.insert(series->getImageByIndex(0));
+    QCOMPARE(imageDAL.getLastError(), SQLITE_CONSTRAINT);
+
+    // The prepared statement must be reusable after the failed insert
+    series->getImageByIndex(1)->setSOPInstanceUID("2");
+    imageDAL.insert(series->getImageByIndex(1));
+    QCOMPARE(imageDAL.getLastError(), SQLITE_OK);
+
+    DicomMask imageMask;
+    imageMask.setStudyInstanceUID(series->getParentStudy()->getInstanceUID());
+    QCOMPARE(imageDAL.count(imageMask), 3);
+
+    delete patient;
+}
+
+bool test_LocalDatabaseImageDAL::createDatabase(DatabaseConnection *databaseConnection)
+{
+    QFile sqlTablesScriptFile(":cache/database.sql");
+
+    if (!sqlTablesScriptFile.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    return sqlite3_exec(databaseConnection->getConnection(), sqlTablesScriptFile.readAll().constData(), 0, 0, 0) == SQLITE_OK;
+}
+
+int test_LocalDatabaseImageDAL::insertPatient(DatabaseConnection *databaseConnection, Patient *patient)
+{
+    LocalDatabasePatientDAL patientDAL(databaseConnection);
+    LocalDatabaseStudyDAL studyDAL(databaseConnection);
+    LocalDatabaseSeriesDAL seriesDAL(databaseConnection);
+    LocalDatabaseImageDAL imageDAL(databaseConnection);
+
+    databaseConnection->beginTransaction();
+
+    patientDAL.insert(patient);
+
+    if (patientDAL.getLastError() != SQLITE_OK)
+    {
+        databaseConnection->rollbackTransaction();
+        return patientDAL.getLastError();
+    }
+
+    foreach (Study *study, patient->getStudies())
+    {
+        studyDAL.insert(study, QDate::currentDate());
+
+        if (studyDAL.getLastError() != SQLITE_OK)
+        {
+            databaseConnection->rollbackTransaction();
+            return studyDAL.getLastError();
+        }
+
+        foreach (Series *series, study->getSeries())
+        {
+            seriesDAL.insert(series);
+
+            if (seriesDAL.getLastError() != SQLITE_OK)
+            {
+                databaseConnection->rollbackTransaction();
+                return seriesDAL.getLastError();
+            }
+
+            foreach (Image *image, series->getImages())
+            {
+                imageDAL.insert(image);
+
+                if (imageDAL.getLastError() != SQLITE_OK)
+                {
+                    databaseConnection->rollbackTransaction();
+                    return imageDAL.getLastError();
+                }
+            }
+        }
+    }
+
+    databaseConnection->commitTransaction();
+
+    return SQLITE_OK;
+}
+
+DECLARE_TEST(test_LocalDatabaseImageDAL)
+
+#include "test_localdatabaseimagedal.moc"
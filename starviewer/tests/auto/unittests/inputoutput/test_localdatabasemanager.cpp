@@ -0,0 +1,66 @@
+#include "autotest.h"
+#include "localdatabasemanager.h"
+
+using namespace udg;
+
+/// LocalDatabaseManager that doesn't delete anything from disk. It records the studies it's asked to delete and fails for the undeletable ones
+class TestingLocalDatabaseManager : public LocalDatabaseManager {
+public:
+    using LocalDatabaseManager::deleteStudiesFromHardDisk;
+
+    QStringList undeletableStudies;
+    QStringList studiesToDelete;
+
+protected:
+    virtual bool deleteStudyFromHardDisk(const QString &studyInstanceToDelete)
+    {
+        studiesToDelete << studyInstanceToDelete;
+        return !undeletableStudies.contains(studyInstanceToDelete);
+    }
+};
+
+Q_DECLARE_METATYPE(LocalDatabaseManager::LastError)
+
+class test_LocalDatabaseManager : public QObject {
+Q_OBJECT
+
+private slots:
+    void deleteStudiesFromHardDisk_ShouldDeleteAllStudiesAndReturnTheOnesNotDeleted_data();
+    void deleteStudiesFromHardDisk_ShouldDeleteAllStudiesAndReturnTheOnesNotDeleted();
+};
+
+void test_LocalDatabaseManager::deleteStudiesFromHardDisk_ShouldDeleteAllStudiesAndReturnTheOnesNotDeleted_data()
+{
+    QTest::addColumn<QStringList>("studies");
+    QTest::addColumn<QStringList>("undeletableStudies");
+    QTest::addColumn<LocalDatabaseManager::LastError>("expectedLastError");
+
+    QStringList studies;
+    studies << "1.2.3.1" << "1.2.3.2" << "1.2.3.3" << "1.2.3.4";
+
+    QTest::newRow("no studies") << QStringList() << QStringList() << LocalDatabaseManager::Ok;
+    QTest::newRow("all deleted") << studies << QStringList() << LocalDatabaseManager::Ok;
+    QTest::newRow("first not deleted") << studies << (QStringList() << "1.2.3.1") << LocalDatabaseManager::DeletingFilesError;
+    QTest::newRow("one in the middle not deleted") << studies << (QStringList() << "1.2.3.2") << LocalDatabaseManager::DeletingFilesError;
+    QTest::newRow("several not deleted") << studies << (QStringList() << "1.2.3.2" << "1.2.3.4") << LocalDatabaseManager::DeletingFilesError;
+    QTest::newRow("none deleted") << studies << studies << LocalDatabaseManager::DeletingFilesError;
+}
+
+void test_LocalDatabaseManager::deleteStudiesFromHardDisk_ShouldDeleteAllStudiesAndReturnTheOnesNotDeleted()
+{
+    QFETCH(QStringList, studies);
+    QFETCH(QStringList, undeletableStudies);
+    QFETCH(LocalDatabaseManager::LastError, expectedLastError);
+
+    TestingLocalDatabaseManager manager;
+    manager.undeletableStudies = undeletableStudies;
+
+    QCOMPARE(manager.deleteStudiesFromHardDisk(studies), undeletableStudies);
+    // The studies after the ones that can't be deleted are deleted too
+    QCOMPARE(manager.studiesToDelete, studies);
+    QCOMPARE(manager.getLastError(), expectedLastError);
+}
+
+DECLARE_TEST(test_LocalDatabaseManager)
+
+#include "test_localdatabasemanager.moc"
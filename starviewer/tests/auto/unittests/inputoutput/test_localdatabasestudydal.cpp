@@ -0,0 +1,97 @@
+#include "autotest.h"
+#include "localdatabasestudydal.h"
+
+#include "dicommask.h"
+
+using namespace udg;
+
+Q_DECLARE_METATYPE(DicomMask)
+Q_DECLARE_METATYPE(LocalDatabaseStudyDAL::StudySortField)
+Q_DECLARE_METATYPE(Qt::SortOrder)
+
+class test_LocalDatabaseStudyDAL : public QObject {
+Q_OBJECT
+
+private slots:
+    void buildSearchIndexMatchExpression_ShouldReturnExpectedExpression_data();
+    void buildSearchIndexMatchExpression_ShouldReturnExpectedExpression();
+
+    void buildSqlOrderBy_ShouldReturnExpectedClause_data();
+    void buildSqlOrderBy_ShouldReturnExpectedClause();
+};
+
+void test_LocalDatabaseStudyDAL::buildSearchIndexMatchExpression_ShouldReturnExpectedExpression_data()
+{
+    QTest::addColumn<DicomMask>("mask");
+    QTest::addColumn<QString>("expectedExpression");
+
+    QTest::newRow("empty mask") << DicomMask() << QString();
+
+    DicomMask emptyValuesMask;
+    emptyValuesMask.setPatientName("");
+    emptyValuesMask.setPatientID("");
+    emptyValuesMask.setAccessionNumber("");
+    emptyValuesMask.setStudyDescription("");
+    QTest::newRow("empty values") << emptyValuesMask << QString();
+
+    DicomMask wildcardsOnlyMask;
+    wildcardsOnlyMask.setPatientName("*");
+    wildcardsOnlyMask.setPatientID("**");
+    QTest::newRow("only wildcards") << wildcardsOnlyMask << QString();
+
+    DicomMask wildcardsMask;
+    wildcardsMask.setPatientName("*GARCIA*");
+    wildcardsMask.setPatientID("12*34");
+    QTest::newRow("wildcards") << wildcardsMask << QString("PatientName:GARCIA* PatientID:12* PatientID:34*");
+
+    DicomMask severalWordsMask;
+    severalWordsMask.setPatientName("GARCIA^JOAN");
+    severalWordsMask.setStudyDescription("TC  abdomen");
+    QTest::newRow("several words") << severalWordsMask << QString("PatientName:GARCIA* PatientName:JOAN* Description:TC* Description:abdomen*");
+
+    DicomMask quotesMask;
+    quotesMask.setPatientName("O'BRIEN");
+    quotesMask.setAccessionNumber("\"A1\" OR x:y");
+    QTest::newRow("quotes and operators") << quotesMask << QString("PatientName:O* PatientName:BRIEN* AccessionNumber:A1* AccessionNumber:OR* "
+                                                                   "AccessionNumber:x* AccessionNumber:y*");
+
+    DicomMask accentsMask;
+    accentsMask.setPatientName(QString::fromUtf8("MARTÍNEZ-PUJOL"));
+    QTest::newRow("accents") << accentsMask << QString::fromUtf8("PatientName:MARTÍNEZ* PatientName:PUJOL*");
+}
+
+void test_LocalDatabaseStudyDAL::buildSearchIndexMatchExpression_ShouldReturnExpectedExpression()
+{
+    QFETCH(DicomMask, mask);
+    QFETCH(QString, expectedExpression);
+
+    QCOMPARE(LocalDatabaseStudyDAL::buildSearchIndexMatchExpression(mask), expectedExpression);
+}
+
+void test_LocalDatabaseStudyDAL::buildSqlOrderBy_ShouldReturnExpectedClause_data()
+{
+    QTest::addColumn<LocalDatabaseStudyDAL::StudySortField>("sortField");
+    QTest::addColumn<Qt::SortOrder>("sortOrder");
+    QTest::addColumn<QString>("expectedClause");
+
+    QTest::newRow("patient name") << LocalDatabaseStudyDAL::SortByPatientName << Qt::AscendingOrder
+                                  << QString(" Order by Patient.Name Asc, InstanceUID Asc");
+    QTest::newRow("patient name, descending") << LocalDatabaseStudyDAL::SortByPatientName << Qt::DescendingOrder
+                                              << QString(" Order by Patient.Name Desc, InstanceUID Desc");
+    QTest::newRow("date") << LocalDatabaseStudyDAL::SortByDate << Qt::DescendingOrder << QString(" Order by Date Desc, Time Desc, InstanceUID Desc");
+    QTest::newRow("modalities") << LocalDatabaseStudyDAL::SortByModalities << Qt::AscendingOrder << QString(" Order by Modalities Asc, InstanceUID Asc");
+    QTest::newRow("instance UID") << LocalDatabaseStudyDAL::SortByInstanceUID << Qt::AscendingOrder << QString(" Order by InstanceUID Asc");
+}
+
+void test_LocalDatabaseStudyDAL::buildSqlOrderBy_ShouldReturnExpectedClause()
+{
+    QFETCH(LocalDatabaseStudyDAL::StudySortField, sortField);
+    QFETCH(Qt::SortOrder, sortOrder);
+    QFETCH(QString, expectedClause);
+
+    QCOMPARE(LocalDatabaseStudyDAL::buildSqlOrderBy(sortField, sortOrder), expectedClause);
+}
+
+DECLARE_TEST(test_LocalDatabaseStudyDAL)
+
+#include "test_localdatabasestudydal.moc"
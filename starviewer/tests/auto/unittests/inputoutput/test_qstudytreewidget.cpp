@@ -1,7 +1,7 @@
 #include "autotest.h"
 
 #include <QList>
-#include <QTreeWidgetItem>
+#include <QTreeView>
 
 #include "qstudytreewidget.h"
 #include "patient.h"
@@ -98,7 +98,7 @@ void test_QStudyTreeWidget::insertPatient_ShouldConsiderStudiesWithSameInstanceU
     m_qstudyTreeWidget->setUseDICOMSourceToDiscriminateStudies(false);
 
     m_qstudyTreeWidget->insertPatientList(inputPatients);
-    QCOMPARE(m_qstudyTreeWidget->getQTreeWidget()->topLevelItemCount(), numberOfExpectedStudiesInserted);
+    QCOMPARE(m_qstudyTreeWidget->getQTreeView()->model()->rowCount(), numberOfExpectedStudiesInserted);
 }
 
 void test_QStudyTreeWidget::insertPatient_ShouldConsiderStudiesWithSameInstanceUIDButDifferentDICOMSourceAsDifferentStudy_data()
@@ -127,7 +127,7 @@ void test_QStudyTreeWidget::insertPatient_ShouldConsiderStudiesWithSameInstanceU
     m_qstudyTreeWidget->setUseDICOMSourceToDiscriminateStudies(true);
 
     m_qstudyTreeWidget->insertPatientList(inputPatients);
-    QCOMPARE(m_qstudyTreeWidget->getQTreeWidget()->topLevelItemCount(), numberOfExpectedStudiesInserted);
+    QCOMPARE(m_qstudyTreeWidget->getQTreeView()->model()->rowCount(), numberOfExpectedStudiesInserted);
 }
 
 void test_QStudyTreeWidget::getStudy_ShouldReturnNull_data()
@@ -171,7 +171,7 @@ void test_QStudyTreeWidget::getStudy_ShouldReturnStudy()
 
     m_qstudyTreeWidget->insertPatientList(inputPatients);
 
-    QCOMPARE(m_qstudyTreeWidget->getQTreeWidget()->topLevelItemCount(), inputPatients.count());
+    QCOMPARE(m_qstudyTreeWidget->getQTreeView()->model()->rowCount(), inputPatients.count());
 
     foreach(Patient* patient, inputPatients)
     {
@@ -228,13 +228,10 @@ void test_QStudyTreeWidget::getSeries_ShouldReturnSeries()
 
     Study *parentStudySeries = inputPatient->getStudies().at(0);
     m_qstudyTreeWidget->insertPatient(inputPatient);
-    //Hack: Quan inserim un pacient/estudi, en el QTreeWidget se li insereix un fill, perquè l'estudi es pugui desplegar i emetre signal requestedSeriesOfStudy
-    //hem d'eliminar aquest fill, ja que sinó quan eliminem la sèrie l'estudi continua tenint un fill.
-    delete m_qstudyTreeWidget->getQTreeWidget()->topLevelItem(0)->child(0);
-
     m_qstudyTreeWidget->insertSeriesList(parentStudySeries->getInstanceUID(), inputSeries);
 
-    QCOMPARE(m_qstudyTreeWidget->getQTreeWidget()->topLevelItem(0)->childCount(), inputSeries.count());
+    QAbstractItemModel *model = m_qstudyTreeWidget->getQTreeView()->model();
+    QCOMPARE(model->rowCount(model->index(0, 0)), inputSeries.count());
 
     foreach(Series* seriesToCompare, inputSeries)
     {
@@ -330,10 +327,6 @@ void test_QStudyTreeWidget::removeSeries_ShouldRemoveStudy()
     QFETCH(Series*, inputSeries);
 
     m_qstudyTreeWidget->insertPatient(inputPatient);
-    //Hack: Quan inserim un pacient/estudi, en el QTreeWidget se li insereix un fill, perquè l'estudi es pugui desplegar i emetre signal requestedSeriesOfStudy
-    //hem d'eliminar aquest fill, ja que sinó quan eliminem la sèrie l'estudi continua tenint un fill.
-    delete m_qstudyTreeWidget->getQTreeWidget()->topLevelItem(0)->child(0);
-
     Study *parentStudySeries = inputPatient->getStudies().at(0);
     m_qstudyTreeWidget->insertSeriesList(parentStudySeries->getInstanceUID(), QList<Series*>() << inputSeries);
 
@@ -0,0 +1,206 @@
+#include "autotest.h"
+#include "relatedstudiescache.h"
+
+#include "patient.h"
+#include "study.h"
+
+using namespace udg;
+
+class test_RelatedStudiesCache : public QObject {
+Q_OBJECT
+
+private slots:
+    void getKey_ShouldIncludeNameOnlyWhenSearchingByName_data();
+    void getKey_ShouldIncludeNameOnlyWhenSearchingByName();
+
+    void insert_ShouldStoreEachStudyOnce();
+    void insert_ShouldRemoveExpiredEntries();
+    void insert_ShouldRemoveOldestEntryWhenFull();
+
+    void getPatientStudyList_ShouldReturnIndependentCopies();
+
+    void contains_ShouldReturnFalseWhenExpiredOrOtherPACS();
+
+private:
+    static Patient* createPatient(const QString &patientID, const QStringList &studyInstanceUIDs);
+
+    static QStringList getSortedUIDs(const QList<Patient*> &patientStudyList);
+};
+
+void test_RelatedStudiesCache::getKey_ShouldIncludeNameOnlyWhenSearchingByName_data()
+{
+    QTest::addColumn<QString>("otherPatientName");
+    QTest::addColumn<QDate>("otherUntilDate");
+    QTest::addColumn<bool>("searchByName");
+    QTest::addColumn<bool>("expectedSameKey");
+
+    QTest::newRow("other name, not searching by name") << "OTHER^NAME" << QDate() << false << true;
+    QTest::newRow("other name, searching by name") << "OTHER^NAME" << QDate() << true << false;
+    QTest::newRow("same name, searching by name") << "NAME^P1" << QDate() << true << true;
+    QTest::newRow("other date") << "NAME^P1" << QDate(2012, 1, 1) << false << false;
+}
+
+void test_RelatedStudiesCache::getKey_ShouldIncludeNameOnlyWhenSearchingByName()
+{
+    QFETCH(QString, otherPatientName);
+    QFETCH(QDate, otherUntilDate);
+    QFETCH(bool, searchByName);
+    QFETCH(bool, expectedSameKey);
+
+    Patient patient;
+    patient.setID("P1");
+    patient.setFullName("NAME^P1");
+
+    Patient otherPatient;
+    otherPatient.setID("P1");
+    otherPatient.setFullName(otherPatientName);
+
+    QString key = RelatedStudiesCache::getKey(&patient, QDate(), searchByName);
+    QString otherKey = RelatedStudiesCache::getKey(&otherPatient, otherUntilDate, searchByName);
+
+    QCOMPARE(key == otherKey, expectedSameKey);
+}
+
+void test_RelatedStudiesCache::insert_ShouldStoreEachStudyOnce()
+{
+    RelatedStudiesCache cache;
+    QString key = "key";
+
+    // The same studies found by patient ID and by patient name
+    cache.insert(key, "A", QList<Patient*>() << createPatient("P1", QStringList() << "1" << "2") << createPatient("P1", QStringList() << "2" << "3"));
+
+    QList<Patient*> patientStudyList = cache.getPatientStudyList(key, "A");
+    QCOMPARE(getSortedUIDs(patientStudyList), QStringList() << "1" << "2" << "3");
+    RelatedStudiesCache::deletePatientStudyList(patientStudyList);
+
+    // New results replace the old ones
+    cache.insert(key, "A", QList<Patient*>() << createPatient("P1", QStringList() << "4"));
+
+    patientStudyList = cache.getPatientStudyList(key, "A");
+    QCOMPARE(getSortedUIDs(patientStudyList), QStringList() << "4");
+    RelatedStudiesCache::deletePatientStudyList(patientStudyList);
+}
+
+void test_RelatedStudiesCache::insert_ShouldRemoveExpiredEntries()
+{
+    RelatedStudiesCache cache;
+    cache.insert("key1", "A", QList<Patient*>() << createPatient("P1", QStringList() << "1"));
+    cache.insert("key1", "B", QList<Patient*>() << createPatient("P1", QStringList() << "2"));
+    QCOMPARE(cache.getNumberOfEntries(), 2);
+
+    // The expired entries are removed without being looked up again
+    cache.setTimeToLive(0);
+    cache.insert("key2", "A", QList<Patient*>() << createPatient("P2", QStringList() << "3"));
+    QCOMPARE(cache.getNumberOfEntries(), 1);
+}
+
+void test_RelatedStudiesCache::insert_ShouldRemoveOldestEntryWhenFull()
+{
+    RelatedStudiesCache cache;
+    cache.setMaximumNumberOfEntries(2);
+
+    cache.insert("key1", "A", QList<Patient*>() << createPatient("P1", QStringList() << "1"));
+    cache.insert("key2", "A", QList<Patient*>() << createPatient("P2", QStringList() << "2"));
+    cache.insert("key3", "A", QList<Patient*>() << createPatient("P3", QStringList() << "3"));
+
+    QCOMPARE(cache.getNumberOfEntries(), 2);
+    QVERIFY(!cache.contains("key1", "A"));
+    QVERIFY(cache.contains("key2", "A"));
+    QVERIFY(cache.contains("key3", "A"));
+
+    // Replacing the results of a stored entry doesn't remove any other
+    cache.insert("key2", "A", QList<Patient*>() << createPatient("P2", QStringList() << "4"));
+
+    QCOMPARE(cache.getNumberOfEntries(), 2);
+    QVERIFY(cache.contains("key2", "A"));
+    QVERIFY(cache.contains("key3", "A"));
+
+    // The replaced entry is now the newest one
+    cache.insert("key4", "A", QList<Patient*>() << createPatient("P4", QStringList() << "5"));
+
+    QCOMPARE(cache.getNumberOfEntries(), 2);
+    QVERIFY(cache.contains("key2", "A"));
+    QVERIFY(!cache.contains("key3", "A"));
+    QVERIFY(cache.contains("key4", "A"));
+}
+
+void test_RelatedStudiesCache::getPatientStudyList_ShouldReturnIndependentCopies()
+{
+    RelatedStudiesCache cache;
+    Patient *patient = createPatient("P1", QStringList() << "1");
+    Study *study = patient->getStudies().first();
+    study->setDescription("DESCRIPTION");
+    study->setDate(QDate(2014, 3, 2));
+    study->addModality("CT");
+    cache.insert("key", "A", QList<Patient*>() << patient);
+
+    QList<Patient*> firstCopy = cache.getPatientStudyList("key", "A");
+    QList<Patient*> secondCopy = cache.getPatientStudyList("key", "A");
+
+    QCOMPARE(firstCopy.count(), 1);
+    QCOMPARE(secondCopy.count(), 1);
+    QVERIFY(firstCopy.first() != secondCopy.first());
+    QVERIFY(firstCopy.first() != patient);
+
+    Study *copiedStudy = firstCopy.first()->getStudies().first();
+    QCOMPARE(firstCopy.first()->getID(), QString("P1"));
+    QCOMPARE(firstCopy.first()->getFullName(), QString("NAME^P1"));
+    QCOMPARE(copiedStudy->getInstanceUID(), QString("1"));
+    QCOMPARE(copiedStudy->getDescription(), QString("DESCRIPTION"));
+    QCOMPARE(copiedStudy->getDate(), QDate(2014, 3, 2));
+    QCOMPARE(copiedStudy->getModalities(), QStringList() << "CT");
+
+    RelatedStudiesCache::deletePatientStudyList(firstCopy);
+
+    QCOMPARE(getSortedUIDs(secondCopy), QStringList() << "1");
+    RelatedStudiesCache::deletePatientStudyList(secondCopy);
+}
+
+void test_RelatedStudiesCache::contains_ShouldReturnFalseWhenExpiredOrOtherPACS()
+{
+    RelatedStudiesCache cache;
+    cache.insert("key", "A", QList<Patient*>() << createPatient("P1", QStringList() << "1"));
+
+    QVERIFY(cache.contains("key", "A"));
+    QVERIFY(!cache.contains("key", "B"));
+    QVERIFY(!cache.contains("otherKey", "A"));
+
+    cache.setTimeToLive(0);
+    QVERIFY(!cache.contains("key", "A"));
+    QVERIFY(cache.getPatientStudyList("key", "A").isEmpty());
+}
+
+Patient* test_RelatedStudiesCache::createPatient(const QString &patientID, const QStringList &studyInstanceUIDs)
+{
+    Patient *patient = new Patient();
+    patient->setID(patientID);
+    patient->setFullName("NAME^" + patientID);
+
+    foreach (const QString &studyInstanceUID, studyInstanceUIDs)
+    {
+        Study *study = new Study();
+        study->setInstanceUID(studyInstanceUID);
+        patient->addStudy(study);
+    }
+
+    return patient;
+}
+
+QStringList test_RelatedStudiesCache::getSortedUIDs(const QList<Patient*> &patientStudyList)
+{
+    QStringList uids;
+    foreach (Patient *patient, patientStudyList)
+    {
+        foreach (Study *study, patient->getStudies())
+        {
+            uids << study->getInstanceUID();
+        }
+    }
+    uids.sort();
+
+    return uids;
+}
+
+DECLARE_TEST(test_RelatedStudiesCache)
+
+#include "test_relatedstudiescache.moc"
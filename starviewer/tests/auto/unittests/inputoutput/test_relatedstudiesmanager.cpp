@@ -0,0 +1,268 @@
+#include "autotest.h"
+#include "testingrelatedstudiesmanager.h"
+
+#include "pacsdevicetesthelper.h"
+#include "patient.h"
+#include "relatedstudiescache.h"
+#include "study.h"
+
+using namespace udg;
+using namespace testing;
+
+/// Guarda els Study Instance UID dels estudis lliurats pels signals de RelatedStudiesManager
+class RelatedStudiesReceiver : public QObject {
+Q_OBJECT
+public:
+    /// PACS i estudis de cada studiesFoundInPACS rebut, en ordre
+    QStringList m_pacsIDs;
+    QList<QStringList> m_studiesFoundInPACS;
+
+    /// Estudis de cada queryStudiesFinished rebut
+    QList<QStringList> m_queryStudiesFinished;
+
+    int m_numberOfErrors;
+
+    RelatedStudiesReceiver(RelatedStudiesManager *manager) : m_numberOfErrors(0)
+    {
+        connect(manager, SIGNAL(studiesFoundInPACS(QList<Study*>, PacsDevice)), SLOT(studiesFoundInPACS(QList<Study*>, PacsDevice)));
+        connect(manager, SIGNAL(queryStudiesFinished(QList<Study*>)), SLOT(queryStudiesFinished(QList<Study*>)));
+        connect(manager, SIGNAL(errorQueryingStudies(PacsDevice)), SLOT(errorQueryingStudies()));
+    }
+
+    static QStringList getSortedUIDs(const QList<Study*> &studies)
+    {
+        QStringList uids;
+        foreach (Study *study, studies)
+        {
+            uids << study->getInstanceUID();
+        }
+        uids.sort();
+        return uids;
+    }
+
+public slots:
+    void studiesFoundInPACS(QList<Study*> studies, PacsDevice pacs)
+    {
+        m_pacsIDs << pacs.getID();
+        m_studiesFoundInPACS << getSortedUIDs(studies);
+    }
+
+    void queryStudiesFinished(QList<Study*> studies)
+    {
+        m_queryStudiesFinished << getSortedUIDs(studies);
+    }
+
+    void errorQueryingStudies()
+    {
+        m_numberOfErrors++;
+    }
+};
+
+class test_RelatedStudiesManager : public QObject {
+Q_OBJECT
+
+private slots:
+    void queryMergedStudies_ShouldEmitMergedStudiesOfEachPACSWithoutDuplicates();
+
+    void queryMergedStudies_ShouldMergeStudiesReceivedInBatchesWithoutDuplicates_data();
+    void queryMergedStudies_ShouldMergeStudiesReceivedInBatchesWithoutDuplicates();
+
+    void queryMergedStudies_ShouldReuseCachedResultsOfSucceededPACS();
+
+    void queryMergedStudies_ShouldQueryAgain_data();
+    void queryMergedStudies_ShouldQueryAgain();
+
+    void queryMergedPreviousStudies_ShouldExcludeMainStudyAndLaterStudies();
+
+private:
+    /// Crea un gestor amb dos PACS, "A" amb els estudis 1 i 2 i "B" amb els estudis 2 i 3 del pacient "P1"
+    static TestingRelatedStudiesManager* createManager(RelatedStudiesCache *cache);
+
+    static Patient* createPatient(const QString &patientID);
+};
+
+void test_RelatedStudiesManager::queryMergedStudies_ShouldEmitMergedStudiesOfEachPACSWithoutDuplicates()
+{
+    RelatedStudiesCache cache;
+    TestingRelatedStudiesManager *manager = createManager(&cache);
+    RelatedStudiesReceiver receiver(manager);
+    Patient *patient = createPatient("P1");
+
+    manager->queryMergedStudies(patient);
+    QVERIFY(manager->isExecutingQueries());
+    QVERIFY(manager->getNumberOfPendingQueries() >= 2);
+
+    manager->answerQueries("B");
+    QCOMPARE(receiver.m_pacsIDs, QStringList() << "B");
+    QCOMPARE(receiver.m_studiesFoundInPACS.last(), QStringList() << "2" << "3");
+    QVERIFY(receiver.m_queryStudiesFinished.isEmpty());
+
+    manager->answerQueries("A");
+    QCOMPARE(receiver.m_pacsIDs, QStringList() << "B" << "A");
+    QCOMPARE(receiver.m_studiesFoundInPACS.last(), QStringList() << "1");
+    QCOMPARE(receiver.m_queryStudiesFinished, QList<QStringList>() << (QStringList() << "1" << "2" << "3"));
+    QVERIFY(!manager->isExecutingQueries());
+
+    delete manager;
+    delete patient;
+}
+
+void test_RelatedStudiesManager::queryMergedStudies_ShouldMergeStudiesReceivedInBatchesWithoutDuplicates_data()
+{
+    QTest::addColumn<int>("batchSize");
+
+    QTest::newRow("one patient per batch") << 1;
+    QTest::newRow("two patients per batch") << 2;
+    QTest::newRow("one batch") << 100;
+}
+
+void test_RelatedStudiesManager::queryMergedStudies_ShouldMergeStudiesReceivedInBatchesWithoutDuplicates()
+{
+    QFETCH(int, batchSize);
+
+    RelatedStudiesCache cache;
+    TestingRelatedStudiesManager *manager = createManager(&cache);
+    RelatedStudiesReceiver receiver(manager);
+    Patient *patient = createPatient("P1");
+
+    // Study 4 is returned twice by PACS A, in different batches when they have less than 4 patients, and also by PACS B
+    manager->addStudyToPACS("A", "P1", "NAME^P1", "4", QDate(2015, 1, 1));
+    manager->addStudyToPACS("A", "P1", "NAME^P1", "4", QDate(2015, 1, 1));
+    manager->addStudyToPACS("A", "P1", "NAME^P1", "5", QDate(2016, 1, 1));
+    manager->addStudyToPACS("B", "P1", "NAME^P1", "4", QDate(2015, 1, 1));
+
+    manager->queryMergedStudies(patient);
+
+    manager->answerQueriesInBatches("A", batchSize);
+    QCOMPARE(receiver.m_pacsIDs, QStringList() << "A");
+    QCOMPARE(receiver.m_studiesFoundInPACS.last(), QStringList() << "1" << "2" << "4" << "5");
+    QVERIFY(receiver.m_queryStudiesFinished.isEmpty());
+
+    manager->answerQueriesInBatches("B", batchSize);
+    QCOMPARE(receiver.m_pacsIDs, QStringList() << "A" << "B");
+    QCOMPARE(receiver.m_studiesFoundInPACS.last(), QStringList() << "3");
+    QCOMPARE(receiver.m_queryStudiesFinished, QList<QStringList>() << (QStringList() << "1" << "2" << "3" << "4" << "5"));
+
+    delete manager;
+    delete patient;
+}
+
+void test_RelatedStudiesManager::queryMergedStudies_ShouldReuseCachedResultsOfSucceededPACS()
+{
+    RelatedStudiesCache cache;
+    Patient *patient = createPatient("P1");
+
+    TestingRelatedStudiesManager *manager = createManager(&cache);
+    RelatedStudiesReceiver receiver(manager);
+    manager->queryMergedStudies(patient);
+    int numberOfQueriesPerPACS = manager->getNumberOfStartedQueries() / 2;
+    manager->answerQueries("A");
+    manager->failQueries("B");
+
+    QCOMPARE(receiver.m_numberOfErrors, 1);
+    QCOMPARE(receiver.m_queryStudiesFinished, QList<QStringList>() << (QStringList() << "1" << "2"));
+    delete manager;
+
+    // Another manager, as when opening again a study of the patient. Only the PACS that failed is queried, the other one is answered from the cache
+    TestingRelatedStudiesManager *otherManager = createManager(&cache);
+    RelatedStudiesReceiver otherReceiver(otherManager);
+    otherManager->queryMergedStudies(patient);
+
+    QCOMPARE(otherManager->getNumberOfStartedQueries(), numberOfQueriesPerPACS);
+    QCOMPARE(otherReceiver.m_pacsIDs, QStringList() << "A");
+    QCOMPARE(otherReceiver.m_studiesFoundInPACS.last(), QStringList() << "1" << "2");
+    QVERIFY(otherManager->isExecutingQueries());
+
+    otherManager->answerQueries("B");
+    QCOMPARE(otherReceiver.m_queryStudiesFinished, QList<QStringList>() << (QStringList() << "1" << "2" << "3"));
+
+    // Now both PACS are cached
+    otherManager->queryMergedStudies(patient);
+    QCOMPARE(otherManager->getNumberOfStartedQueries(), numberOfQueriesPerPACS);
+    QCOMPARE(otherReceiver.m_queryStudiesFinished.last(), QStringList() << "1" << "2" << "3");
+    QVERIFY(!otherManager->isExecutingQueries());
+
+    delete otherManager;
+    delete patient;
+}
+
+void test_RelatedStudiesManager::queryMergedStudies_ShouldQueryAgain_data()
+{
+    QTest::addColumn<int>("timeToLive");
+    QTest::addColumn<QString>("otherPatientID");
+
+    QTest::newRow("expired results") << 0 << "P1";
+    QTest::newRow("another patient") << RelatedStudiesCache::DefaultTimeToLive << "P2";
+}
+
+void test_RelatedStudiesManager::queryMergedStudies_ShouldQueryAgain()
+{
+    QFETCH(int, timeToLive);
+    QFETCH(QString, otherPatientID);
+
+    RelatedStudiesCache cache;
+    cache.setTimeToLive(timeToLive);
+    TestingRelatedStudiesManager *manager = createManager(&cache);
+    Patient *patient = createPatient("P1");
+    Patient *otherPatient = createPatient(otherPatientID);
+
+    manager->queryMergedStudies(patient);
+    int numberOfQueries = manager->getNumberOfStartedQueries();
+    manager->answerQueries("A");
+    manager->answerQueries("B");
+
+    manager->queryMergedStudies(otherPatient);
+    QCOMPARE(manager->getNumberOfStartedQueries(), 2 * numberOfQueries);
+    QVERIFY(manager->isExecutingQueries());
+
+    delete manager;
+    delete patient;
+    delete otherPatient;
+}
+
+void test_RelatedStudiesManager::queryMergedPreviousStudies_ShouldExcludeMainStudyAndLaterStudies()
+{
+    RelatedStudiesCache cache;
+    TestingRelatedStudiesManager *manager = createManager(&cache);
+    RelatedStudiesReceiver receiver(manager);
+    Patient *patient = createPatient("P1");
+    Study *mainStudy = new Study();
+    mainStudy->setInstanceUID("2");
+    mainStudy->setDate(QDate(2012, 1, 1));
+    patient->addStudy(mainStudy);
+
+    manager->queryMergedPreviousStudies(mainStudy);
+    manager->answerQueries("A");
+    manager->answerQueries("B");
+
+    QCOMPARE(receiver.m_queryStudiesFinished, QList<QStringList>() << (QStringList() << "1"));
+
+    delete manager;
+    delete mainStudy;
+    delete patient;
+}
+
+TestingRelatedStudiesManager* test_RelatedStudiesManager::createManager(RelatedStudiesCache *cache)
+{
+    TestingRelatedStudiesManager *manager = new TestingRelatedStudiesManager(cache);
+    manager->setPACSList(QList<PacsDevice>() << PACSDeviceTestHelper::createPACSDeviceByID("A") << PACSDeviceTestHelper::createPACSDeviceByID("B"));
+    manager->addStudyToPACS("A", "P1", "NAME^P1", "1", QDate(2010, 1, 1));
+    manager->addStudyToPACS("A", "P1", "NAME^P1", "2", QDate(2012, 1, 1));
+    manager->addStudyToPACS("B", "P1", "NAME^P1", "2", QDate(2012, 1, 1));
+    manager->addStudyToPACS("B", "P1", "NAME^P1", "3", QDate(2014, 1, 1));
+
+    return manager;
+}
+
+Patient* test_RelatedStudiesManager::createPatient(const QString &patientID)
+{
+    Patient *patient = new Patient();
+    patient->setID(patientID);
+    patient->setFullName("NAME^" + patientID);
+
+    return patient;
+}
+
+DECLARE_TEST(test_RelatedStudiesManager)
+
+#include "test_relatedstudiesmanager.moc"
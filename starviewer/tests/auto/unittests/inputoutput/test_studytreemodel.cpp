@@ -0,0 +1,199 @@
+#include "autotest.h"
+
+#include "studytreemodel.h"
+#include "patient.h"
+#include "study.h"
+#include "series.h"
+#include "patienttesthelper.h"
+#include "studytesthelper.h"
+#include "seriestesthelper.h"
+#include "dicomsourcetesthelper.h"
+
+using namespace udg;
+using namespace testing;
+
+class test_StudyTreeModel : public QObject {
+Q_OBJECT
+
+private slots:
+    void sort_ShouldSortStudiesInBackground_data();
+    void sort_ShouldSortStudiesInBackground();
+
+    void appendPatients_ShouldReplaceDuplicatedStudies_data();
+    void appendPatients_ShouldReplaceDuplicatedStudies();
+
+    void hasChildren_ShouldReturnExpectedValue_data();
+    void hasChildren_ShouldReturnExpectedValue();
+
+private:
+    /// Creates a patient with the given name and one study for each given UID
+    static Patient* createPatient(const QString &name, const QStringList &studyInstanceUIDs, const QString &pacsID = "1");
+};
+
+Q_DECLARE_METATYPE(Qt::SortOrder)
+Q_DECLARE_METATYPE(StudyTreeModel::ItemType)
+
+Patient* test_StudyTreeModel::createPatient(const QString &name, const QStringList &studyInstanceUIDs, const QString &pacsID)
+{
+    Patient *patient = PatientTestHelper::createPatientWithIDAndName(name, name);
+
+    foreach (const QString &studyInstanceUID, studyInstanceUIDs)
+    {
+        Study *study = StudyTestHelper::createStudyByUID(studyInstanceUID);
+        study->setDICOMSource(DICOMSourceTestHelper::createAndAddPACSByID(pacsID));
+        patient->addStudy(study);
+    }
+
+    return patient;
+}
+
+void test_StudyTreeModel::sort_ShouldSortStudiesInBackground_data()
+{
+    QTest::addColumn<QStringList>("patientNames");
+    QTest::addColumn<bool>("appendAfterSort");
+    QTest::addColumn<Qt::SortOrder>("sortOrder");
+    QTest::addColumn<QStringList>("expectedNames");
+
+    QStringList names;
+    names << "MARTI" << "ALBA" << "PERE" << "JOAN";
+
+    QTest::newRow("ascending, sorted after appending") << names << false << Qt::AscendingOrder
+                                                       << (QStringList() << "ALBA" << "JOAN" << "MARTI" << "PERE");
+    QTest::newRow("descending, sorted after appending") << names << false << Qt::DescendingOrder
+                                                        << (QStringList() << "PERE" << "MARTI" << "JOAN" << "ALBA");
+    QTest::newRow("ascending, appended to sorted model") << names << true << Qt::AscendingOrder
+                                                         << (QStringList() << "ALBA" << "JOAN" << "MARTI" << "PERE");
+}
+
+void test_StudyTreeModel::sort_ShouldSortStudiesInBackground()
+{
+    QFETCH(QStringList, patientNames);
+    QFETCH(bool, appendAfterSort);
+    QFETCH(Qt::SortOrder, sortOrder);
+    QFETCH(QStringList, expectedNames);
+
+    QList<Patient*> patients;
+    for (int i = 0; i < patientNames.count(); i++)
+    {
+        patients << createPatient(patientNames.at(i), QStringList() << QString::number(i));
+    }
+
+    StudyTreeModel model;
+
+    if (appendAfterSort)
+    {
+        model.sort(StudyTreeModel::ObjectName, sortOrder);
+        // Each patient is appended separately, as results arrive from a query
+        foreach (Patient *patient, patients)
+        {
+            model.appendPatients(QList<Patient*>() << patient);
+        }
+    }
+    else
+    {
+        model.appendPatients(patients);
+        model.sort(StudyTreeModel::ObjectName, sortOrder);
+    }
+
+    QTRY_VERIFY(!model.isSorting());
+
+    QStringList names;
+    for (int row = 0; row < model.rowCount(); row++)
+    {
+        names << model.data(model.index(row, StudyTreeModel::ObjectName)).toString();
+    }
+
+    QCOMPARE(names, expectedNames);
+
+    model.clear();
+}
+
+void test_StudyTreeModel::appendPatients_ShouldReplaceDuplicatedStudies_data()
+{
+    QTest::addColumn<bool>("useDICOMSourceToDiscriminateStudies");
+    QTest::addColumn<bool>("appendSeparately");
+    QTest::addColumn<int>("expectedNumberOfStudies");
+
+    QTest::newRow("discriminate by DICOMSource, same list") << true << false << 3;
+    QTest::newRow("discriminate by DICOMSource, separate lists") << true << true << 3;
+    QTest::newRow("don't discriminate by DICOMSource, same list") << false << false << 2;
+    QTest::newRow("don't discriminate by DICOMSource, separate lists") << false << true << 2;
+}
+
+void test_StudyTreeModel::appendPatients_ShouldReplaceDuplicatedStudies()
+{
+    QFETCH(bool, useDICOMSourceToDiscriminateStudies);
+    QFETCH(bool, appendSeparately);
+    QFETCH(int, expectedNumberOfStudies);
+
+    // Study "2" is in two PACS
+    Patient *patientOne = createPatient("ONE", QStringList() << "1" << "2", "1");
+    Patient *patientTwo = createPatient("TWO", QStringList() << "2", "2");
+
+    StudyTreeModel model;
+    model.setUseDICOMSourceToDiscriminateStudies(useDICOMSourceToDiscriminateStudies);
+
+    if (appendSeparately)
+    {
+        model.appendPatients(QList<Patient*>() << patientOne);
+        model.appendPatients(QList<Patient*>() << patientTwo);
+    }
+    else
+    {
+        model.appendPatients(QList<Patient*>() << patientOne << patientTwo);
+    }
+
+    QCOMPARE(model.rowCount(), expectedNumberOfStudies);
+
+    QModelIndex studyIndex = model.findStudy("2", DICOMSourceTestHelper::createAndAddPACSByID("2"));
+    QVERIFY(studyIndex.isValid());
+    QCOMPARE(model.getStudy(studyIndex), patientTwo->getStudies().first());
+
+    model.clear();
+}
+
+void test_StudyTreeModel::hasChildren_ShouldReturnExpectedValue_data()
+{
+    QTest::addColumn<StudyTreeModel::ItemType>("maximumExpandLevel");
+    QTest::addColumn<bool>("requestChildren");
+    QTest::addColumn<bool>("expectedStudyHasChildren");
+
+    QTest::newRow("study level") << StudyTreeModel::StudyItem << false << false;
+    QTest::newRow("series level, not requested") << StudyTreeModel::SeriesItem << false << true;
+    QTest::newRow("series level, requested without series") << StudyTreeModel::SeriesItem << true << false;
+}
+
+void test_StudyTreeModel::hasChildren_ShouldReturnExpectedValue()
+{
+    QFETCH(StudyTreeModel::ItemType, maximumExpandLevel);
+    QFETCH(bool, requestChildren);
+    QFETCH(bool, expectedStudyHasChildren);
+
+    StudyTreeModel model;
+    model.setMaximumExpandLevel(maximumExpandLevel);
+    model.appendPatients(QList<Patient*>() << createPatient("ONE", QStringList() << "1"));
+
+    QModelIndex studyIndex = model.index(0, 0);
+    if (requestChildren)
+    {
+        model.setChildrenRequested(studyIndex);
+    }
+
+    QCOMPARE(model.hasChildren(studyIndex), expectedStudyHasChildren);
+
+    // Once series are inserted the study always has children
+    Series *series = SeriesTestHelper::createSeriesByUID("1");
+    series->setDICOMSource(DICOMSourceTestHelper::createAndAddPACSByID("1"));
+    model.appendSeries(studyIndex, QList<Series*>() << series);
+
+    QVERIFY(model.hasChildren(studyIndex));
+    QCOMPARE(model.rowCount(studyIndex), 1);
+    QCOMPARE(model.getSeries(model.index(0, 0, studyIndex)), series);
+    QCOMPARE(model.getStudy(model.index(0, 0, studyIndex)), model.getStudy(studyIndex));
+
+    model.clear();
+}
+
+DECLARE_TEST(test_StudyTreeModel)
+
+#include "test_studytreemodel.moc"